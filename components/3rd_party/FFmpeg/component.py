@@ -67,3 +67,4 @@ def add_file_downloads(confs : dict) -> list:
             }
         ]
 
+    return []
@@ -15,6 +15,8 @@
 #include "xalloc.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
 
 #define USER_DEBUG                                     (0)
 // #define USE_MALLOC
@@ -99,6 +101,30 @@ void fb_free(void *ptr) {
 void fb_free_all() {
     // do nothing
 }
+
+void fb_alloc_set_default_size(uint32_t size) {
+    // do nothing
+}
+
+uint32_t fb_alloc_get_default_size() {
+    return OMV_FB_ALLOC_SIZE;
+}
+
+void fb_realloc_init1(uint32_t size) {
+    // do nothing
+}
+
+void fb_alloc_set_arena(void *buff, uint32_t size) {
+    // do nothing
+}
+
+void fb_alloc_get_stats(fb_alloc_stats_t *stats) {
+    memset(stats, 0, sizeof(fb_alloc_stats_t));
+}
+
+void fb_alloc_reset_peak() {
+    // do nothing
+}
 #else
 #ifndef __DCACHE_PRESENT
 #define FB_ALLOC_ALIGNMENT 32 // Use 32-byte alignment on MCUs with no cache for DMA buffer alignment.
@@ -106,17 +132,32 @@ void fb_free_all() {
 #define FB_ALLOC_ALIGNMENT __SCB_DCACHE_LINE_SIZE
 #endif
 
-static char* _fballoc_start = NULL;
-static char* _fballoc = NULL;
-static char* pointer = NULL;
+/*
+ * Every thread owns one arena(stack), so imlib algorithms running in different threads
+ * never share the stack pointer. Arena is created on first use with default size,
+ * and freed when thread exit.
+ */
+typedef struct {
+    char *start;        // arena start address
+    char *end;          // stack bottom, stack grows down from here
+    char *pointer;      // stack top
+    uint32_t size;
+    uint32_t peak;      // high water mark of used bytes
+    bool owned;         // start is allocated by fb_alloc, not set by fb_alloc_set_arena
+} fb_arena_t;
+
+static __thread fb_arena_t _arena;
+static uint32_t _default_size = OMV_FB_ALLOC_SIZE;
+static pthread_key_t _arena_key;
+static pthread_once_t _arena_key_once = PTHREAD_ONCE_INIT;
 
 #if USER_DEBUG
-static int alloc_num = 0;
+static __thread int alloc_num = 0;
 #endif
 
 #if defined(FB_ALLOC_STATS)
-static uint32_t alloc_bytes;
-static uint32_t alloc_bytes_peak;
+static __thread uint32_t alloc_bytes;
+static __thread uint32_t alloc_bytes_peak;
 #endif
 
 // #if defined(OMV_FB_OVERLAY_MEMORY)
@@ -129,9 +170,61 @@ static uint32_t alloc_bytes_peak;
 // Use fb_alloc_free_till_mark_permanent() instead.
 #define FB_PERMANENT_FLAG 0x2
 
+static void fb_arena_release(fb_arena_t *arena)
+{
+    if (arena->owned && arena->start)
+        xfree(arena->start);
+    memset(arena, 0, sizeof(fb_arena_t));
+}
+
+static void fb_arena_thread_exit(void *arg)
+{
+    DEBUG_PRINT("[omv] fb alloc thread exit\r\n");
+    fb_arena_release((fb_arena_t *)arg);
+}
+
+static void fb_arena_key_create()
+{
+    pthread_key_create(&_arena_key, fb_arena_thread_exit);
+}
+
+static void fb_arena_set(fb_arena_t *arena, char *buff, uint32_t size, bool owned)
+{
+    arena->start = buff;
+    arena->size = buff ? size : 0;
+    arena->end = buff ? buff + size - sizeof(uint32_t) : NULL;
+    arena->pointer = arena->end;
+    arena->peak = 0;
+    arena->owned = owned;
+}
+
+static fb_arena_t *fb_arena_get()
+{
+    fb_arena_t *arena = &_arena;
+    if (!arena->start) {
+        DEBUG_PRINT("[omv] fb alloc init, size: %u\r\n", _default_size);
+        fb_arena_set(arena, (char *)xalloc(_default_size), _default_size, true);
+        if (!arena->start) {
+            fb_alloc_fail();
+            return arena;
+        }
+        // free arena when thread exit, main thread is freed by fb_alloc_close0
+        pthread_once(&_arena_key_once, fb_arena_key_create);
+        pthread_setspecific(_arena_key, arena);
+    }
+    return arena;
+}
+
+static inline void fb_arena_update_peak(fb_arena_t *arena)
+{
+    uint32_t used = arena->end - arena->pointer;
+    if (used > arena->peak)
+        arena->peak = used;
+}
+
 char *fb_alloc_stack_pointer()
 {
-    return pointer;
+    return fb_arena_get()->pointer;
 }
 
 void fb_alloc_fail()
@@ -142,62 +235,81 @@ void fb_alloc_fail()
 
 __attribute__((constructor)) void fb_alloc_init0()
 {
-    if (_fballoc_start)
-        return;
-    DEBUG_PRINT("[omv] fb alloc init\r\n");
-    _fballoc_start = (char*)xalloc(OMV_FB_ALLOC_SIZE);
-    _fballoc = _fballoc_start + OMV_FB_ALLOC_SIZE - sizeof(uint32_t);
-    pointer = _fballoc;
+    fb_arena_get();
 }
+
+void fb_alloc_set_default_size(uint32_t size)
+{
+    _default_size = size;
+}
+
+uint32_t fb_alloc_get_default_size()
+{
+    return _default_size;
+}
+
 /**
  * @brief fb_realloc_init1
  * Functional description:
- *  Reprogram the memory used by the fb_alloc module .
+ *  Reprogram the memory used by the fb_alloc module of current thread.
  *  Previously used data is not saved !
  * @param size
  *  will be alloc memory!
  */
 void fb_realloc_init1(uint32_t size)
 {
-    if(NULL == _fballoc_start)
-    {
-        _fballoc_start = (char*)xalloc(size);
-        _fballoc = _fballoc_start + size - sizeof(uint32_t);
-        pointer = _fballoc;
-    }
+    fb_arena_t *arena = fb_arena_get();
+    fb_arena_release(arena);
+    fb_arena_set(arena, (char *)xalloc(size), size, true);
+}
+
+void fb_alloc_set_arena(void *buff, uint32_t size)
+{
+    fb_arena_t *arena = fb_arena_get();
+    fb_arena_release(arena);
+    if (buff)
+        fb_arena_set(arena, (char *)buff, size, false);
     else
-    {
-        xfree(_fballoc_start);
-        _fballoc_start = (char*)xalloc(size);
-        _fballoc = _fballoc_start + size - sizeof(uint32_t);
-        pointer = _fballoc;
-    }
+        fb_arena_get(); // back to own arena with default size
+}
+
+void fb_alloc_get_stats(fb_alloc_stats_t *stats)
+{
+    fb_arena_t *arena = fb_arena_get();
+    stats->size = arena->size;
+    stats->used = arena->start ? arena->end - arena->pointer : 0;
+    stats->peak = arena->peak;
+}
+
+void fb_alloc_reset_peak()
+{
+    fb_arena_t *arena = fb_arena_get();
+    arena->peak = arena->start ? arena->end - arena->pointer : 0;
 }
 
 __attribute__((destructor)) void fb_alloc_close0()
 {
-    if (!_fballoc_start)
+    if (!_arena.start)
         return;
     DEBUG_PRINT("[omv] fb alloc deinit\r\n");
-    xfree(_fballoc_start);
-    _fballoc_start = NULL;
-    _fballoc = NULL;
-    pointer = NULL;
+    fb_arena_release(&_arena);
 }
 
 
 uint32_t fb_avail()
 {
-    uint32_t temp = pointer - _fballoc_start - sizeof(uint32_t);
+    fb_arena_t *arena = fb_arena_get();
+    uint32_t temp = arena->pointer - arena->start - sizeof(uint32_t);
     return (temp < sizeof(uint32_t)) ? 0 : temp;
 }
 
 void fb_alloc_mark()
 {
-    char *new_pointer = pointer - sizeof(uint32_t);
+    fb_arena_t *arena = fb_arena_get();
+    char *new_pointer = arena->pointer - sizeof(uint32_t);
 
     // Check if allocation overwrites the framebuffer pixels
-    if (new_pointer < _fballoc_start) {
+    if (new_pointer < arena->start) {
         fb_alloc_fail();
         // nlr_raise_for_fb_alloc_mark(mp_obj_new_exception_msg(&mp_type_MemoryError,
         //     MP_ERROR_TEXT("Out of fast Frame Buffer Stack Memory!"
@@ -208,7 +320,8 @@ void fb_alloc_mark()
     // meaning that the value below is always 8 or more but never 4. So,
     // we will use a size value of 4 as a marker in the alloc stack.
     *((uint32_t *) new_pointer) = sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    arena->pointer = new_pointer;
+    fb_arena_update_peak(arena);
     #if defined(FB_ALLOC_STATS)
     alloc_bytes = 0;
     alloc_bytes_peak = 0;
@@ -225,8 +338,9 @@ static void int_fb_alloc_free_till_mark(bool free_permanent)
     // This does not really help you in complex memory allocation operations where you want to be
     // able to unwind things until after a certain point. It also did not handle preventing
     // fb_alloc_free_till_mark() from running in recursive call situations (see find_blobs()).
-    while (pointer < _fballoc) {
-        uint32_t size = *((uint32_t *) pointer);
+    fb_arena_t *arena = fb_arena_get();
+    while (arena->pointer < arena->end) {
+        uint32_t size = *((uint32_t *) arena->pointer);
         if ((!free_permanent) && (size & FB_PERMANENT_FLAG)) return;
         size &= ~FB_PERMANENT_FLAG;
         // #if defined(OMV_FB_OVERLAY_MEMORY)
@@ -235,7 +349,7 @@ static void int_fb_alloc_free_till_mark(bool free_permanent)
         //     pointer_overlay += size - sizeof(uint32_t);
         // }
         // #endif
-        pointer += size; // Get size and pop.
+        arena->pointer += size; // Get size and pop.
         if (size == sizeof(uint32_t)) break; // Break on first marker.
     }
     #if defined(FB_ALLOC_STATS)
@@ -251,7 +365,8 @@ void fb_alloc_free_till_mark()
 
 void fb_alloc_mark_permanent()
 {
-    if (pointer < _fballoc) *((uint32_t *) pointer) |= FB_PERMANENT_FLAG;
+    fb_arena_t *arena = fb_arena_get();
+    if (arena->pointer < arena->end) *((uint32_t *) arena->pointer) |= FB_PERMANENT_FLAG;
 }
 
 void fb_alloc_free_till_mark_past_mark_permanent()
@@ -266,6 +381,7 @@ void *fb_alloc(uint32_t size, int hints)
         return NULL;
     }
 
+    fb_arena_t *arena = fb_arena_get();
     size = ((size + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t); // Round Up
 
     if (hints & FB_ALLOC_CACHE_ALIGN) {
@@ -273,17 +389,18 @@ void *fb_alloc(uint32_t size, int hints)
         size += FB_ALLOC_ALIGNMENT - sizeof(uint32_t);
     }
 
-    char *result = pointer - size;
+    char *result = arena->pointer - size;
     char *new_pointer = result - sizeof(uint32_t);
 
     // Check if allocation overwrites the framebuffer pixels
-    if (new_pointer < _fballoc_start) {
+    if (new_pointer < arena->start) {
         fb_alloc_fail();
     }
 
     // size is always 4/8/12/etc. so the value below must be 8 or more.
     *((uint32_t *) new_pointer) = size + sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    arena->pointer = new_pointer;
+    fb_arena_update_peak(arena);
 
     #if defined(FB_ALLOC_STATS)
     alloc_bytes += size;
@@ -310,7 +427,7 @@ void *fb_alloc(uint32_t size, int hints)
         }
     }
 #if USER_DEBUG
-    DEBUG_PRINT("mem num:%d pointer:%p size:%d\r\n", ++ alloc_num, pointer, size);
+    DEBUG_PRINT("mem num:%d pointer:%p size:%d\r\n", ++ alloc_num, arena->pointer, size);
 #endif
     return result;
 }
@@ -325,7 +442,8 @@ void *fb_alloc0(uint32_t size, int hints)
 
 void *fb_alloc_all(uint32_t *size, int hints)
 {
-    uint32_t temp = pointer - _fballoc_start - sizeof(uint32_t);
+    fb_arena_t *arena = fb_arena_get();
+    uint32_t temp = arena->pointer - arena->start - sizeof(uint32_t);
 
     if (temp < sizeof(uint32_t)) {
         *size = 0;
@@ -341,12 +459,13 @@ void *fb_alloc_all(uint32_t *size, int hints)
 
     *size = (temp / sizeof(uint32_t)) * sizeof(uint32_t); // Round Down
 
-    char *result = pointer - *size;
+    char *result = arena->pointer - *size;
     char *new_pointer = result - sizeof(uint32_t);
 
     // size is always 4/8/12/etc. so the value below must be 8 or more.
     *((uint32_t *) new_pointer) = *size + sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    arena->pointer = new_pointer;
+    fb_arena_update_peak(arena);
 
     #if defined(FB_ALLOC_STATS)
     alloc_bytes += *size;
@@ -388,8 +507,9 @@ void *fb_alloc0_all(uint32_t *size, int hints)
 
 void fb_free(void *ptr)
 {
-    if (pointer < _fballoc) {
-        uint32_t size = *((uint32_t *) pointer);
+    fb_arena_t *arena = fb_arena_get();
+    if (arena->pointer < arena->end) {
+        uint32_t size = *((uint32_t *) arena->pointer);
         size &= ~FB_PERMANENT_FLAG;
         // #if defined(OMV_FB_OVERLAY_MEMORY)
         // if (size & FB_OVERLAY_MEMORY_FLAG) { // Check for fast flag.
@@ -400,15 +520,16 @@ void fb_free(void *ptr)
         #if defined(FB_ALLOC_STATS)
         alloc_bytes -= size;
         #endif
-        pointer += size; // Get size and pop.
-        DEBUG_PRINT("free num:%d pointer:%p size:%d\r\n", -- alloc_num, pointer, size);
+        arena->pointer += size; // Get size and pop.
+        DEBUG_PRINT("free num:%d pointer:%p size:%d\r\n", -- alloc_num, arena->pointer, size);
     }
 }
 
 void fb_free_all()
 {
-    while (pointer < _fballoc) {
-        uint32_t size = *((uint32_t *) pointer);
+    fb_arena_t *arena = fb_arena_get();
+    while (arena->pointer < arena->end) {
+        uint32_t size = *((uint32_t *) arena->pointer);
         size &= ~FB_PERMANENT_FLAG;
         // #if defined(OMV_FB_OVERLAY_MEMORY)
         // if (size & FB_OVERLAY_MEMORY_FLAG) { // Check for fast flag.
@@ -419,9 +540,9 @@ void fb_free_all()
         #if defined(FB_ALLOC_STATS)
         alloc_bytes -= size;
         #endif
-        pointer += size; // Get size and pop.
+        arena->pointer += size; // Get size and pop.
     }
     DEBUG_PRINT("free all mem!");
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -60,6 +60,23 @@ extern "C" {
 #define FB_ALLOC_PREFER_SPEED    1
 #define FB_ALLOC_PREFER_SIZE     2
 #define FB_ALLOC_CACHE_ALIGN     4
+
+/*
+ * MaixCDK: every thread has its own fb_alloc stack(arena), created on first use with default size,
+ * so imlib algorithms can run in multiple threads at the same time.
+ * Functions below only affect the arena of the calling thread, except fb_alloc_set_default_size.
+ */
+typedef struct {
+    uint32_t size;  // arena size in bytes
+    uint32_t used;  // bytes in use now
+    uint32_t peak;  // high water mark since arena created or fb_alloc_reset_peak called
+} fb_alloc_stats_t;
+void fb_alloc_set_default_size(uint32_t size); // size of arenas created later
+uint32_t fb_alloc_get_default_size();
+void fb_realloc_init1(uint32_t size); // realloc arena of current thread, data is not kept
+void fb_alloc_set_arena(void *buff, uint32_t size); // use caller's buffer as arena of current thread, NULL to restore
+void fb_alloc_get_stats(fb_alloc_stats_t *stats);
+void fb_alloc_reset_peak();
 char *fb_alloc_stack_pointer();
 void fb_alloc_fail();
 void fb_alloc_init0();
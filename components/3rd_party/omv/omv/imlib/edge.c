@@ -27,6 +27,7 @@ void imlib_edge_simple(image_t *src, rectangle_t *roi, int low_thresh, int high_
     color_thresholds_list_lnk_data_t lnk_data;
     lnk_data.LMin = low_thresh;
     lnk_data.LMax = high_thresh;
+    lnk_data.lut = NULL;
     list_push_back(&thresholds, &lnk_data);
     imlib_binary(src, src, &thresholds, false, false, NULL);
     list_free(&thresholds);
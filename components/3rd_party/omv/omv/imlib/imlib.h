@@ -156,9 +156,12 @@ typedef struct color_thresholds_list_lnk_data {
     uint8_t LMin, LMax; // or grayscale
     int8_t AMin, AMax;
     int8_t BMin, BMax;
+    const uint8_t *lut; // optional membership bitmap of all 65536 RGB565 colors, NULL to compare LAB bounds
 }
 color_thresholds_list_lnk_data_t;
 
+#define COLOR_THRESHOLD_LUT_GET(lut, rgb565) (((lut)[(rgb565) >> 3] >> ((rgb565) & 7)) & 1)
+
 #define COLOR_THRESHOLD_BINARY(pixel, threshold, invert)                          \
     ({                                                                            \
         __typeof__ (pixel) _pixel = (pixel);                                      \
@@ -175,28 +178,35 @@ color_thresholds_list_lnk_data_t;
         ((_threshold->LMin <= _pixel) && (_pixel <= _threshold->LMax)) ^ _invert; \
     })
 
-#define COLOR_THRESHOLD_RGB565(pixel, threshold, invert)                  \
-    ({                                                                    \
-        __typeof__ (pixel) _pixel = (pixel);                              \
-        __typeof__ (threshold) _threshold = (threshold);                  \
-        __typeof__ (invert) _invert = (invert);                           \
-        uint8_t _l = COLOR_RGB565_TO_L(_pixel);                           \
-        int8_t _a = COLOR_RGB565_TO_A(_pixel);                            \
-        int8_t _b = COLOR_RGB565_TO_B(_pixel);                            \
-        ((_threshold->LMin <= _l) && (_l <= _threshold->LMax) &&          \
-         (_threshold->AMin <= _a) && (_a <= _threshold->AMax) &&          \
-         (_threshold->BMin <= _b) && (_b <= _threshold->BMax)) ^ _invert; \
+#define COLOR_THRESHOLD_RGB565(pixel, threshold, invert)                      \
+    ({                                                                        \
+        __typeof__ (pixel) _pixel = (pixel);                                  \
+        __typeof__ (threshold) _threshold = (threshold);                      \
+        __typeof__ (invert) _invert = (invert);                               \
+        (_threshold->lut ? COLOR_THRESHOLD_LUT_GET(_threshold->lut, (uint16_t) _pixel) : ({ \
+            uint8_t _l = COLOR_RGB565_TO_L(_pixel);                           \
+            int8_t _a = COLOR_RGB565_TO_A(_pixel);                            \
+            int8_t _b = COLOR_RGB565_TO_B(_pixel);                            \
+            (_threshold->LMin <= _l) && (_l <= _threshold->LMax) &&           \
+            (_threshold->AMin <= _a) && (_a <= _threshold->AMax) &&           \
+            (_threshold->BMin <= _b) && (_b <= _threshold->BMax);             \
+        })) ^ _invert;                                                        \
     })
 #define COLOR_THRESHOLD_RGB888(pixel, threshold, invert)                \
 ({                                                                      \
     __typeof__(pixel) _pixel = (pixel);                                 \
     __typeof__(threshold) _threshold = (threshold);                     \
     __typeof__(invert) _invert = (invert);                              \
-    int8_t _l, _a, _b;                                                  \
-    COLOR_RGB888_TO_LAB(_pixel, &_l, &_a, &_b);                         \
-    ((_threshold->LMin <= _l) && (_l <= _threshold->LMax) &&            \
-    (_threshold->AMin <= _a) && (_a <= _threshold->AMax) &&             \
-    (_threshold->BMin <= _b) && (_b <= _threshold->BMax)) ^ _invert;    \
+    (_threshold->lut ? COLOR_THRESHOLD_LUT_GET(_threshold->lut,         \
+        COLOR_R8_G8_B8_TO_RGB565(COLOR_RGB888_TO_R8(_pixel),            \
+                                 COLOR_RGB888_TO_G8(_pixel),            \
+                                 COLOR_RGB888_TO_B8(_pixel))) : ({      \
+        int8_t _l, _a, _b;                                              \
+        COLOR_RGB888_TO_LAB(_pixel, &_l, &_a, &_b);                     \
+        (_threshold->LMin <= _l) && (_l <= _threshold->LMax) &&         \
+        (_threshold->AMin <= _a) && (_a <= _threshold->AMax) &&         \
+        (_threshold->BMin <= _b) && (_b <= _threshold->BMax);           \
+    })) ^ _invert;                                                      \
 })
 #define COLOR_BOUND_BINARY(pixel0, pixel1, threshold)    \
     ({                                                   \
@@ -417,6 +417,7 @@ void py_helper_arg_to_thresholds(const mp_obj_t arg, list_t *thresholds) {
             lnk_data.AMax = IM_MAX(lnk_data_tmp.AMin, lnk_data_tmp.AMax);
             lnk_data.BMin = IM_MIN(lnk_data_tmp.BMin, lnk_data_tmp.BMax);
             lnk_data.BMax = IM_MAX(lnk_data_tmp.BMin, lnk_data_tmp.BMax);
+            lnk_data.lut = NULL;
             list_push_back(thresholds, &lnk_data);
         }
     }
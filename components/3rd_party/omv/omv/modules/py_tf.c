@@ -694,6 +694,7 @@ STATIC mp_obj_t int_py_tf_segment(bool detecting_mode, uint n_args, const mp_obj
         lnk_data.AMax = COLOR_A_MAX;
         lnk_data.BMin = COLOR_B_MIN;
         lnk_data.BMax = COLOR_B_MAX;
+        lnk_data.lut = NULL;
         list_push_back(&thresholds, &lnk_data);
     }
 
@@ -3,6 +3,9 @@ def add_file_downloads(confs : dict) -> list:
         @param confs kconfig vars, dict type
         @return list type, items is dict type
     '''
+    if confs.get("PLATFORM_LINUX", None):
+        # use local libraries, see CMakeLists.txt
+        return []
     version = f"1.20.1"
     url = f"https://github.com/sipeed/MaixCDK/releases/download/v0.0.0/sg2002_onnxruntime_v{version}.tar.xz"
     if version == "1.20.1":
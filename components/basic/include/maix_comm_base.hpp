@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add peer interface for transports with several peers.
  */
 
 #pragma once
@@ -92,5 +93,44 @@ namespace maix::comm
          * @maixcdk maix.comm.CommBase.read
          */
         virtual Bytes *read(int len, int timeout) = 0;
+
+        /**
+         * Wait until one peer has data to read, for transports with several peers like TCP server.
+         * Data of different peers are not mixed, read them with read_peer separately.
+         * @param timeout unit ms, 0 means return immediately, -1 means block until have data.
+         * @return peer id, >= 0, -1 means timeout.
+         *         Single peer transports always return 0 immediately, and read_peer waits for data.
+         * @maixcdk maix.comm.CommBase.wait_peer
+         */
+        virtual int wait_peer(int timeout) { (void)timeout; return 0; }
+
+        /**
+         * Receive data of one peer
+         * @param peer peer id returned by wait_peer
+         * @param buff data buffer to store received data
+         * @param buff_len data buffer length
+         * @param timeout unit ms, same as read
+         * @return received data length, < 0 means error, value is -err.Err.
+         * @maixcdk maix.comm.CommBase.read_peer
+         */
+        virtual int read_peer(int peer, uint8_t *buff, int buff_len, int timeout) { (void)peer; return read(buff, buff_len, -1, timeout); }
+
+        /**
+         * Send data to one peer, write() sends to all peers.
+         * @param peer peer id returned by wait_peer
+         * @param buff data buffer
+         * @param len data length
+         * @return sent data length, < 0 means error, value is -err.Err.
+         * @maixcdk maix.comm.CommBase.write_peer
+         */
+        virtual int write_peer(int peer, const uint8_t *buff, int len) { (void)peer; return write(buff, len); }
+
+        /**
+         * Check if peer is still connected
+         * @param peer peer id
+         * @return false if peer disconnected or expired.
+         * @maixcdk maix.comm.CommBase.peer_alive
+         */
+        virtual bool peer_alive(int peer) { (void)peer; return true; }
     };
 }
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add async logger with per-thread lock-free rings, sinks, levels and rate limiting.
  */
 
 #ifndef __MAIX_LOG_H
@@ -11,9 +12,196 @@
 #include <stdio.h>
 #include "global_config.h"
 #include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// compile time log level, logs above it are compiled out, 0: none, 1: error, 2: warn, 3: info, 4: debug
+#ifndef CONFIG_LOG_LEVEL
+    #define CONFIG_LOG_LEVEL 4
+#endif
 
 namespace maix::log
 {
+    /**
+     * Log level
+     * @maixcdk maix.log.LogLevel
+    */
+    enum LogLevel
+    {
+        LEVEL_NONE = 0,     // no log, or raw output of print
+        LEVEL_ERROR,
+        LEVEL_WARN,
+        LEVEL_INFO,
+        LEVEL_DEBUG,
+    };
+
+    /**
+     * One log message given to sinks, msg is valid only in Sink::write.
+     * @maixcdk maix.log.Record
+    */
+    struct Record
+    {
+        LogLevel level;         // LEVEL_NONE for print
+        uint64_t time_us;       // monotonic time, unit: us
+        int tid;                // thread id of caller
+        bool newline;           // false for error0, warn0, info0, debug0 and print
+        const char *msg;        // formatted message, no prefix, not end with '\0'
+        int len;
+    };
+
+    /**
+     * Log output, write is called by logger thread in async mode, or by caller thread in sync mode,
+     * never called at the same time, implementation not need lock, and must not call log functions.
+     * @maixcdk maix.log.Sink
+    */
+    class Sink
+    {
+    public:
+        virtual ~Sink() {}
+
+        /**
+         * Write one record
+         * @maixcdk maix.log.Sink.write
+        */
+        virtual void write(const Record &record) = 0;
+
+        /**
+         * Flush output, called after a batch of records written.
+         * @maixcdk maix.log.Sink.flush
+        */
+        virtual void flush() {}
+    };
+
+    /**
+     * Write logs to stdout with "-- [E] " like prefix, default sink.
+     * @maixcdk maix.log.StdoutSink
+    */
+    class StdoutSink : public Sink
+    {
+    public:
+        /**
+         * Construct
+         * @param detail add monotonic time and thread id after level prefix.
+         * @maixcdk maix.log.StdoutSink.StdoutSink
+        */
+        StdoutSink(bool detail = false) : _detail(detail) {}
+        void write(const Record &record) override;
+        void flush() override;
+    private:
+        bool _detail;
+    };
+
+    /**
+     * Write logs to file with time and thread id, rotate when file size exceeds max_size,
+     * path is renamed to path.1, path.1 to path.2 and so on, keep max_files files at most.
+     * @maixcdk maix.log.FileSink
+    */
+    class FileSink : public Sink
+    {
+    public:
+        /**
+         * Construct, throw err::Exception if open file failed.
+         * @param path log file path
+         * @param max_size max bytes of one file, 0 means not rotate.
+         * @param max_files max file number include path.
+         * @maixcdk maix.log.FileSink.FileSink
+        */
+        FileSink(const std::string &path, size_t max_size = 1024 * 1024, int max_files = 3);
+        ~FileSink();
+        void write(const Record &record) override;
+        void flush() override;
+    private:
+        void _rotate();
+        std::string _path;
+        size_t _max_size;
+        int _max_files;
+        size_t _size;
+        FILE *_fp;
+    };
+
+    /**
+     * Write logs to syslog, level maps to LOG_ERR, LOG_WARNING, LOG_INFO and LOG_DEBUG.
+     * @maixcdk maix.log.SyslogSink
+    */
+    class SyslogSink : public Sink
+    {
+    public:
+        /**
+         * Construct
+         * @param ident syslog ident, usually program name.
+         * @maixcdk maix.log.SyslogSink.SyslogSink
+        */
+        SyslogSink(const std::string &ident = "maix");
+        ~SyslogSink();
+        void write(const Record &record) override;
+    private:
+        std::string _ident;
+        std::string _line;      // error0 like logs joined to one line
+    };
+
+    /**
+     * Set runtime log level, logs above level are ignored, default LEVEL_DEBUG(debug logs need DEBUG build too).
+     * @maixcdk maix.log.set_level
+    */
+    void set_level(log::LogLevel level);
+
+    /**
+     * Get runtime log level
+     * @maixcdk maix.log.get_level
+    */
+    log::LogLevel get_level();
+
+    /**
+     * Set async mode, async is the default since 2026.10.18(sync if CONFIG_LOG_SYNC is set), before that logs were written in caller thread.\n
+     * In async mode caller only formats message to a lock-free ring of its thread, one background thread writes sinks,
+     * so a log appears a little later than the call, and may be out of order with direct printf output.
+     * Error logs flush all pending logs in caller thread, and pending logs are flushed at normal exit,
+     * but info, warn and debug logs called right before a crash(e.g. segmentation fault) or _exit may never appear,
+     * call log::flush() or use sync mode when debugging such crash.\n
+     * In sync mode caller writes sinks directly.
+     * @maixcdk maix.log.set_async
+    */
+    void set_async(bool async);
+
+    /**
+     * Limit log number of one call site(same format string) per second in one thread, more logs are dropped
+     * and a summary is logged when the call site logs next second.
+     * Dropped error logs are still recorded as last error by err::set_error.
+     * @param max_per_second 0 means no limit, default 100.
+     * @maixcdk maix.log.set_rate_limit
+    */
+    void set_rate_limit(int max_per_second);
+
+    /**
+     * Add sink, sink object is not owned by logger, must be valid until removed.
+     * @maixcdk maix.log.add_sink
+    */
+    void add_sink(log::Sink *sink);
+
+    /**
+     * Remove sink, it will not be used after this function return.
+     * @maixcdk maix.log.remove_sink
+    */
+    void remove_sink(log::Sink *sink);
+
+    /**
+     * Default stdout sink, remove it by remove_sink(log::default_sink()) to disable stdout output.
+     * @maixcdk maix.log.default_sink
+    */
+    log::Sink *default_sink();
+
+    /**
+     * Write all pending logs to sinks and flush sinks.
+     * @maixcdk maix.log.flush
+    */
+    void flush();
+
+    /**
+     * Number of logs dropped because ring of thread is full.
+     * @maixcdk maix.log.dropped
+    */
+    uint64_t dropped();
     /**
      * print error log
      * @param fmt format string
@@ -3,6 +3,8 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add streaming Decoder, scatter encoder encodev and table CRC16.
+ *                     Error response data length counts error code now(body + 5, was body + 4), see docs/doc/convention/protocol.md.
  */
 
 #pragma once
@@ -11,6 +13,7 @@
 #include <tuple>
 #include <valarray>
 #include <string>
+#include <sys/uio.h>
 #include "maix_err.hpp"
 #include "maix_type.hpp"
 
@@ -69,6 +72,18 @@ namespace maix
             FLAG_VERSION_MASK = 0x03
         };
 
+        /**
+         * @brief max frame head length encoded by encodev, header(4) + data length(4) + flags(1) + cmd(1) + error code(1)
+         * @maixcdk maix.protocol.HEAD_MAX_LEN
+        */
+        const int HEAD_MAX_LEN = 11;
+
+        /**
+         * @brief frame tail length, CRC16(2)
+         * @maixcdk maix.protocol.TAIL_LEN
+        */
+        const int TAIL_LEN = 2;
+
         /**
          * @brief protocol msg
          * @maixpy maix.protocol.MSG
@@ -243,6 +258,125 @@ namespace maix
             int _body_buff_len;
         };
 
+        /**
+         * @brief Decoded message, body points to Decoder's buffer, no copy.
+         * @maixcdk maix.protocol.MsgView
+        */
+        struct MsgView
+        {
+            uint8_t version;
+            uint8_t resp_ok;
+            uint8_t cmd;
+            bool is_resp;
+            bool is_req;
+            bool is_report;
+            const uint8_t *body;    // for error response, body[0] is error code
+            int body_len;
+        };
+
+        /**
+         * @brief Streaming protocol decoder.\n
+         * Received data is stored in a ring buffer, decoder keeps parse state between calls, so every byte is only scanned once,
+         * header is searched with memchr and KMP, CRC is checked with slicing-by-8 table,
+         * message body is returned as view of ring buffer, a frame crossing ring end is made continuous by copying the wrapped part
+         * to the spare area after ring end.\n
+         * Read data to prepare() buffer and commit() it to avoid copy, or use feed() to copy data.
+         * Not thread safe.
+         * @maixcdk maix.protocol.Decoder
+        */
+        class Decoder
+        {
+        public:
+            /**
+             * @brief Construct a new Decoder object
+             * @param buff_size ring buffer size, round up to power of 2, max frame length is buff_size.
+             * @param header protocol header
+             * @maixcdk maix.protocol.Decoder.Decoder
+            */
+            Decoder(int buff_size = 1024, uint32_t header = maix::protocol::HEADER);
+            ~Decoder();
+            Decoder(const Decoder &) = delete;
+            Decoder &operator=(const Decoder &) = delete;
+
+            /**
+             * @brief Get continuous free buffer to write received data
+             * @param size [out] free buffer size, 0 means buffer full, call next() to consume data first.
+             * @return free buffer pointer
+             * @maixcdk maix.protocol.Decoder.prepare
+            */
+            uint8_t *prepare(int *size);
+
+            /**
+             * @brief Commit data written to prepare() buffer
+             * @param len data length, must <= size of prepare()
+             * @maixcdk maix.protocol.Decoder.commit
+            */
+            void commit(int len);
+
+            /**
+             * @brief Copy data to ring buffer
+             * @param data new data
+             * @param len new data length
+             * @return copied length, less than len if buffer full.
+             * @maixcdk maix.protocol.Decoder.feed
+            */
+            int feed(const uint8_t *data, int len);
+
+            /**
+             * @brief Decode next message
+             * @param msg [out] decoded message, body is valid until next call of prepare(), feed() or next().
+             * @return true if decoded one message, false means need more data.
+             * @maixcdk maix.protocol.Decoder.next
+            */
+            bool next(protocol::MsgView &msg);
+
+            /**
+             * @brief Data length in buffer not decoded yet
+             * @maixcdk maix.protocol.Decoder.data_len
+            */
+            int data_len() const { return (int)(_head - _tail); }
+
+            /**
+             * @brief Free length of buffer
+             * @maixcdk maix.protocol.Decoder.free_len
+            */
+            int free_len() const { return (int)(_size - (_head - _tail)); }
+
+            /**
+             * @brief Drop all data and parse state
+             * @maixcdk maix.protocol.Decoder.reset
+            */
+            void reset();
+
+            /**
+             * @brief Number of frames dropped because of CRC error
+             * @maixcdk maix.protocol.Decoder.crc_errors
+            */
+            uint64_t crc_errors() const { return _crc_errors; }
+
+            /**
+             * @brief Number of bytes skipped when searching header
+             * @maixcdk maix.protocol.Decoder.skipped
+            */
+            uint64_t skipped() const { return _skipped; }
+
+        private:
+            void _resync();
+            uint8_t _at(uint64_t pos) const { return _buff[pos & _mask]; }
+
+            uint8_t *_buff;         // _size ring and _size spare area
+            uint32_t _size;
+            uint32_t _mask;
+            uint64_t _head;         // write position
+            uint64_t _tail;         // start of frame candidate, data before it is released
+            int _matched;           // header bytes matched from _tail
+            uint32_t _frame_len;    // whole frame length, 0 if not parsed yet
+            uint8_t _header[4];
+            int _fail[4];           // KMP failure table of header
+            uint64_t _crc_errors;
+            uint64_t _skipped;
+        };
+
         /**
          * @brief Communicate protocol
          * @maixpy maix.protocol.Protocol
@@ -383,11 +517,16 @@ namespace maix
             */
             Bytes *encode_resp_err(uint8_t cmd, err::Err code, const std::string &msg);
 
+            /**
+             * Get streaming decoder, read data to its buffer directly to avoid copy.
+             * @maixcdk maix.protocol.Protocol.decoder
+            */
+            protocol::Decoder &decoder() { return _decoder; }
+
         private:
             int _buff_size;
-            uint8_t *_buff;
-            int _data_len;
             uint32_t _header;
+            protocol::Decoder _decoder;
         };
 
         /**
@@ -407,6 +546,16 @@ namespace maix
         */
         uint16_t crc16_IBM(const Bytes *data);
 
+        /**
+         * @brief Update CRC16-IBM with more data, crc16_IBM(data, len) equals crc16_IBM_update(0, data, len).
+         * @param crc CRC value of previous data, 0 for the first data.
+         * @param data data
+         * @param len data length
+         * @return CRC16-IBM value
+         * @maixcdk maix.protocol.crc16_IBM_update
+        */
+        uint16_t crc16_IBM_update(uint16_t crc, const uint8_t *data, size_t len);
+
         /**
          * @brief Encode message to buffer
          * @param out_buff output buffer
@@ -422,5 +571,21 @@ namespace maix
         */
         int encode(uint8_t *out_buff, int out_buff_len, uint8_t cmd, uint8_t flags, uint8_t *body, int body_len, uint8_t code = 0xFF, const uint8_t version = VERSION);
 
+        /**
+         * @brief Encode message head and tail only, body is not copied,
+         *        send head, body pieces and tail in order, e.g. by writev.
+         * @param head [out] head buffer, at least HEAD_MAX_LEN bytes.
+         * @param tail [out] tail buffer, TAIL_LEN bytes.
+         * @param cmd CMD value
+         * @param flags FLAGS value, @see maix.protocol.FLAGS
+         * @param body message body pieces, can be null
+         * @param body_cnt message body pieces count, can be 0
+         * @param code error code, only for error message
+         * @param version protocol version
+         * @return head length, if < 0, means error, and the error code is -err.Err
+         * @maixcdk maix.protocol.encodev
+        */
+        int encodev(uint8_t *head, uint8_t *tail, uint8_t cmd, uint8_t flags, const struct iovec *body, int body_cnt, uint8_t code = 0xFF, const uint8_t version = VERSION);
+
     } // namespace protocol
 } // namespace maix
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add Arena, transpose, slice, TensorView and TensorRef.
  */
 
 #pragma once
@@ -18,6 +19,7 @@
 #include <tuple>
 #include <map>
 #include <valarray>
+#include <atomic>
 #include "maix_log.hpp"
 #include "maix_err.hpp"
 
@@ -89,6 +91,74 @@ namespace maix
             "invalid"
         };
 
+        /**
+         * Memory arena for tensors, allocate by moving a pointer, free all at once by reset.\n
+         * A growable arena merges its blocks into one on reset, so after the first round the same memory is reused without malloc.
+         * A fixed arena uses caller provided buffer and never grows, alloc returns nullptr when it's full.
+         * @maixcdk maix.tensor.Arena
+         */
+        class Arena
+        {
+        public:
+            /**
+             * Growable arena
+             * @param capacity initial capacity in bytes, 0 means alloc when first used.
+             * @maixcdk maix.tensor.Arena.Arena
+             */
+            Arena(size_t capacity = 0);
+
+            /**
+             * Fixed arena on caller's buffer(buffer pool), the buffer must be valid until this object destroyed.
+             * @param buff buffer pointer
+             * @param size buffer size in bytes
+             * @maixcdk maix.tensor.Arena.Arena
+             */
+            Arena(void *buff, size_t size);
+
+            ~Arena();
+
+            Arena(const Arena &) = delete;
+            Arena &operator=(const Arena &) = delete;
+
+            /**
+             * Alloc memory from arena, not need to free.
+             * @param bytes size in bytes
+             * @param align alignment, must be power of 2, default 64 for SIMD and cache line.
+             * @return memory pointer, nullptr if fixed arena is full.
+             * @maixcdk maix.tensor.Arena.alloc
+             */
+            void *alloc(size_t bytes, size_t align = 64);
+
+            /**
+             * Free all memory alloced, all pointers alloced before become invalid.
+             * @maixcdk maix.tensor.Arena.reset
+             */
+            void reset();
+
+            /**
+             * Bytes used since last reset, include alignment padding.
+             * @maixcdk maix.tensor.Arena.used
+             */
+            size_t used() const { return _used; }
+
+            /**
+             * Total bytes of memory blocks.
+             * @maixcdk maix.tensor.Arena.capacity
+             */
+            size_t capacity() const;
+
+        private:
+            struct Block
+            {
+                uint8_t *data;
+                size_t size;
+            };
+            std::vector<Block> _blocks;
+            size_t _pos;
+            size_t _used;
+            bool _fixed;
+        };
+
         /**
          * Tensor class
          * @maixpy maix.tensor.Tensor
@@ -162,6 +232,53 @@ namespace maix
                 // log::info("new tensor: %p", this);
             }
 
+            /**
+             * Tensor constructor, borrow memory from arena, memory is not freed by tensor but by arena reset.
+             * @param shape tensor shape, a int list
+             * @param dtype tensor element data type, see DType of this module
+             * @param arena arena to alloc from, throw err::Exception with ERR_NO_MEM if fixed arena is full.
+             * @maixcdk maix.tensor.Tensor.Tensor
+             */
+            Tensor(std::vector<int> shape, tensor::DType dtype, tensor::Arena &arena)
+            {
+                _shape = shape;
+                _dtype = dtype;
+                _is_alloc = false;
+                _data = arena.alloc(_bytes(shape, dtype));
+                if (!_data)
+                {
+                    throw err::Exception(err::ERR_NO_MEM, "tensor arena full");
+                }
+            }
+
+            /**
+             * Copy constructor, alloc new memory and copy data.
+             * @maixcdk maix.tensor.Tensor.Tensor
+             */
+            Tensor(const Tensor &t)
+            {
+                _shape = t._shape;
+                _dtype = t._dtype;
+                _data = malloc(_bytes(_shape, _dtype));
+                _is_alloc = true;
+                memcpy(_data, t._data, _bytes(_shape, _dtype));
+            }
+
+            /**
+             * Move constructor, take over data of t, no copy.
+             * @maixcdk maix.tensor.Tensor.Tensor
+             */
+            Tensor(Tensor &&t)
+            {
+                _shape = std::move(t._shape);
+                _dtype = t._dtype;
+                _data = t._data;
+                _is_alloc = t._is_alloc;
+                t._data = nullptr;
+                t._is_alloc = false;
+                t._shape.clear();
+            }
+
             ~Tensor()
             {
                 // log::info("free tensor: %p", this);
@@ -259,6 +376,27 @@ namespace maix
                 _shape = {size_int()};
             }
 
+            /**
+             * Permute axes in place, data is rearranged into a new buffer.
+             * Use TensorView::transpose to permute without copy.
+             * @param axes new order of axes, empty means reverse all axes, invalid axes will throw an err::Exception
+             * @maixcdk maix.tensor.Tensor.transpose
+            */
+            void transpose(std::vector<int> axes = {});
+
+            /**
+             * Slice along one axis.\n
+             * If the slice is one contiguous range of memory(all axes before axis are 1, or axis is 0, e.g. batch slice of outputs),
+             * return a view share data with this tensor, not copy data, the view is valid only while this tensor's data is valid.
+             * Or data is copied to the returned tensor, use TensorView::slice to slice any axis without copy.
+             * @param axis axis to slice, negative value means count from last axis
+             * @param start start index, negative value means count from end
+             * @param end end index(not included), negative value means count from end
+             * @return view tensor
+             * @maixcdk maix.tensor.Tensor.slice
+            */
+            tensor::Tensor slice(int axis, int start, int end);
+
             int size_int()
             {
                 if(_shape.size() == 0)
@@ -315,6 +453,30 @@ namespace maix
                 memcpy(_data, t.data(), t.size_int() * dtype_size[t.dtype()]);
             }
 
+            /**
+             * Move assignment, take over data of t, no copy.
+             * @maixcdk maix.tensor.Tensor.operator=
+            */
+            Tensor &operator=(Tensor &&t)
+            {
+                if (this == &t)
+                {
+                    return *this;
+                }
+                if (_is_alloc)
+                {
+                    free(_data);
+                }
+                _shape = std::move(t._shape);
+                _dtype = t._dtype;
+                _data = t._data;
+                _is_alloc = t._is_alloc;
+                t._data = nullptr;
+                t._is_alloc = false;
+                t._shape.clear();
+                return *this;
+            }
+
 
             /**
              * argmax of tensor
@@ -410,12 +572,23 @@ namespace maix
             }
 
         private:
+            // members layout is shared with prebuilt libs(e.g. libmaixcam_lib.so), don't add or reorder members
             std::vector<int> _shape;
             DType _dtype;
             void *_data;
             bool _is_alloc;
 
         private:
+            static size_t _bytes(const std::vector<int> &shape, tensor::DType dtype)
+            {
+                size_t size = 1;
+                for (auto d : shape)
+                {
+                    size *= d;
+                }
+                return size * dtype_size[dtype];
+            }
+
             template <typename T>
             static int _get_argmax(T dtype, void *data, size_t size)
             {
@@ -473,8 +646,129 @@ namespace maix
             }
         };
 
+        /**
+         * Strided view of tensor data, not own data and never copy.\n
+         * transpose, slice and reshape only change shape, strides and data pointer,
+         * use copy_to or to_tensor to get contiguous data when needed.
+         * A view is valid only while the data it points to is valid.\n
+         * Tensor members layout is shared with prebuilt libs and has no strides, so views are a separate type.
+         * @maixcdk maix.tensor.TensorView
+         */
+        class TensorView
+        {
+        public:
+            /**
+             * View of whole tensor, row major.
+             * @param t tensor, view is invalid after t's data freed or changed by Tensor::transpose
+             * @maixcdk maix.tensor.TensorView.TensorView
+             */
+            TensorView(tensor::Tensor &t);
+
+            /**
+             * View of data
+             * @param data pointer to first element
+             * @param shape view shape
+             * @param dtype element data type
+             * @param strides strides of each axis, unit is element, not byte, empty means contiguous row major.
+             *                size not match shape will throw an err::Exception
+             * @maixcdk maix.tensor.TensorView.TensorView
+             */
+            TensorView(void *data, const std::vector<int> &shape, tensor::DType dtype, const std::vector<int> &strides = {});
+
+            /**
+             * Get view shape
+             * @maixcdk maix.tensor.TensorView.shape
+             */
+            const std::vector<int> &shape() const { return _shape; }
+
+            /**
+             * Get view strides, unit is element, not byte.
+             * @maixcdk maix.tensor.TensorView.strides
+             */
+            const std::vector<int> &strides() const { return _strides; }
+
+            /**
+             * Get data type
+             * @maixcdk maix.tensor.TensorView.dtype
+             */
+            tensor::DType dtype() const { return _dtype; }
+
+            /**
+             * Pointer to first element
+             * @maixcdk maix.tensor.TensorView.data
+             */
+            void *data() const { return _data; }
+
+            /**
+             * Elements number, 0 if shape is empty, the same as Tensor::size_int.
+             * @maixcdk maix.tensor.TensorView.size_int
+             */
+            int size_int() const;
+
+            /**
+             * Is data contiguous in memory(row major), axes of size 1 are ignored.
+             * @maixcdk maix.tensor.TensorView.is_contiguous
+             */
+            bool is_contiguous() const;
+
+            /**
+             * Permute axes, only shape and strides are changed.
+             * @param axes new order of axes, empty means reverse all axes, invalid axes will throw an err::Exception
+             * @return new view share the same data
+             * @maixcdk maix.tensor.TensorView.transpose
+             */
+            tensor::TensorView transpose(std::vector<int> axes = {}) const;
+
+            /**
+             * Slice along one axis, only data pointer and shape are changed.
+             * @param axis axis to slice, negative value means count from last axis, out of range will throw an err::Exception
+             * @param start start index, negative value means count from end
+             * @param end end index(not included), negative value means count from end
+             * @return new view share the same data
+             * @maixcdk maix.tensor.TensorView.slice
+             */
+            tensor::TensorView slice(int axis, int start, int end) const;
+
+            /**
+             * Reshape a contiguous view, size not match or view not contiguous will throw an err::Exception,
+             * use to_tensor first for a not contiguous view.
+             * @param shape new shape
+             * @return new view share the same data
+             * @maixcdk maix.tensor.TensorView.reshape
+             */
+            tensor::TensorView reshape(const std::vector<int> &shape) const;
+
+            /**
+             * Pointer to one element
+             * @param idx index of each axis, size must be the same as shape, out of range will throw an err::Exception
+             * @maixcdk maix.tensor.TensorView.ptr
+             */
+            void *ptr(const std::vector<int> &idx) const;
+
+            /**
+             * Copy elements to contiguous memory in row major order, inner axes keep order are copied by rows.
+             * @param dst destination, at least size_int() * dtype_size[dtype()] bytes
+             * @maixcdk maix.tensor.TensorView.copy_to
+             */
+            void copy_to(void *dst) const;
+
+            /**
+             * Copy to a new contiguous tensor
+             * @return new tensor, you need to delete it after use in C++.
+             * @maixcdk maix.tensor.TensorView.to_tensor
+             */
+            tensor::Tensor *to_tensor() const;
+
+        private:
+            void *_data;
+            std::vector<int> _shape;
+            std::vector<int> _strides;  // unit: element
+            tensor::DType _dtype;
+        };
+
         /**
          * Tensors
+         * Tensors are stored in tensors map by name, use TensorRef to keep a resolved tensor instead of finding name every time.
          * @maixpy maix.tensor.Tensors
         */
         class Tensors
@@ -492,6 +786,7 @@ namespace maix
             ~Tensors()
             {
                 // log::info("free tensors: %p", this);
+                ++_erase_epoch;
                 for(auto &item : tensors)
                 {
                     if(_auto_delete[item.first])
@@ -502,23 +797,27 @@ namespace maix
                 }
             }
 
+            Tensors(const Tensors &) = delete;
+            Tensors &operator=(const Tensors &) = delete;
+
             /**
-             * Add tensor
+             * Add tensor, replace the old one if key already exists.
              * @maixpy maix.tensor.Tensors.add_tensor
             */
             void add_tensor(const std::string &key, tensor::Tensor *tensor, bool copy, bool auto_delete)
             {
                 if(copy)
                 {
-                    tensor::Tensor *t = new tensor::Tensor(tensor->shape(), tensor->dtype(), tensor->data(), true);
-                    tensors[key] = t;
-                    _auto_delete[key] = true;
+                    tensor = new tensor::Tensor(*tensor);
+                    auto_delete = true;
                 }
-                else
+                auto it = tensors.find(key);
+                if(it != tensors.end() && it->second != tensor && _auto_delete[key])
                 {
-                    tensors[key] = tensor;
-                    _auto_delete[key] = auto_delete;
+                    delete it->second;
                 }
+                tensors[key] = tensor;
+                _auto_delete[key] = auto_delete;
             }
 
             /**
@@ -527,11 +826,18 @@ namespace maix
             */
             void rm_tensor(const std::string &key)
             {
+                auto it = tensors.find(key);
+                if(it == tensors.end())
+                {
+                    return;
+                }
+                ++_erase_epoch;
                 if(_auto_delete[key])
                 {
-                    delete tensors[key];
+                    delete it->second;
                 }
-                tensors.erase(key);
+                tensors.erase(it);
+                _auto_delete.erase(key);
             }
 
             /**
@@ -540,11 +846,16 @@ namespace maix
             */
             void clear()
             {
-                auto _keys = keys();
-                for(const auto &k : _keys)
+                ++_erase_epoch;
+                for(auto &item : tensors)
                 {
-                    rm_tensor(k);
+                    if(_auto_delete[item.first])
+                    {
+                        delete item.second;
+                    }
                 }
+                tensors.clear();
+                _auto_delete.clear();
             }
 
             /**
@@ -575,13 +886,18 @@ namespace maix
             }
 
             /**
-             * Get tensor by key
+             * Get tensor by key, key not found will throw an err::Exception
              * @maixpy maix.tensor.Tensors.get_tensor
              * @maixcdk maix.tensor.Tensors.get_tensor
             */
             tensor::Tensor &get_tensor(const std::string &key)
             {
-                return *tensors[key];
+                auto it = tensors.find(key);
+                if(it == tensors.end())
+                {
+                    throw err::Exception(err::ERR_ARGS, "tensor " + key + " not found");
+                }
+                return *it->second;
             }
 
             /**
@@ -591,7 +907,7 @@ namespace maix
             */
             tensor::Tensor &operator[](const std::string &key)
             {
-                return *tensors[key];
+                return get_tensor(key);
             }
 
             /**
@@ -620,14 +936,89 @@ namespace maix
 
         public:
             /**
-             * Tensors data, dict type
+             * Tensors data, dict type, use add_tensor and rm_tensor to modify.
              * @maixpy maix.tensor.Tensors.tensors
             */
             std::map<std::string, tensor::Tensor*> tensors;
         private:
+            // members layout is shared with prebuilt libs(e.g. libmaixcam_lib.so), don't add or reorder members,
+            // tensors is the only storage, _auto_delete only has the same keys.
             std::map<std::string, bool> _auto_delete;
+
+            // increased when any Tensors erases tensors or is destroyed, iterators cached by TensorRef are valid only while it not change,
+            // static member so not change layout, inline add_tensor of prebuilt libs only inserts, that not invalidate iterators.
+            static std::atomic<uint64_t> _erase_epoch;
+
+            friend class TensorRef;
         };
 
+        /**
+         * Reference to a tensor of Tensors by name, decoders resolve output names once at model load and keep it.
+         * The found tensor is cached, getting from the same Tensors again(e.g. outputs reused by forward) not find name,
+         * cache is dropped when tensors removed from any Tensors or a Tensors destroyed, then found again.
+         * Not thread safe, use one TensorRef for each thread.
+         * @maixcdk maix.tensor.TensorRef
+        */
+        class TensorRef
+        {
+        public:
+            /**
+             * Constructor of TensorRef
+             * @param name tensor name, empty means not set.
+             * @maixcdk maix.tensor.TensorRef.TensorRef
+            */
+            TensorRef(const std::string &name = "")
+                : _name(name), _owner(nullptr), _epoch(0)
+            {
+            }
+
+            /**
+             * Tensor name
+             * @maixcdk maix.tensor.TensorRef.name
+            */
+            const std::string &name() const { return _name; }
+
+            /**
+             * Is name set
+             * @maixcdk maix.tensor.TensorRef.valid
+            */
+            bool valid() const { return !_name.empty(); }
+
+            /**
+             * Get tensor from tensors
+             * @return tensor pointer, nullptr if name not set or not found.
+             * @maixcdk maix.tensor.TensorRef.get
+            */
+            tensor::Tensor *get(tensor::Tensors &tensors)
+            {
+                if(_name.empty())
+                {
+                    return nullptr;
+                }
+                uint64_t epoch = Tensors::_erase_epoch.load();
+                if(_owner == &tensors && _epoch == epoch)
+                {
+                    // value is read every time, add_tensor replace tensor of a key in place
+                    return _it->second;
+                }
+                auto it = tensors.tensors.find(_name);
+                if(it == tensors.tensors.end())
+                {
+                    _owner = nullptr;
+                    return nullptr;
+                }
+                _owner = &tensors;
+                _it = it;
+                _epoch = epoch;
+                return it->second;
+            }
+
+        private:
+            std::string _name;
+            tensor::Tensors *_owner;
+            std::map<std::string, tensor::Tensor*>::iterator _it;
+            uint64_t _epoch;
+        };
 
     } // namespace tensor
 }; // namespace maix
@@ -3,91 +3,721 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Async logger, caller formats message to lock-free ring of its thread, logger thread writes sinks.
  */
 
 
 #include "maix_log.hpp"
 #include "maix_err.hpp"
 #include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <new>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <sys/syscall.h>
 
 namespace maix::log
 {
+    #define LOG_RING_SIZE       (64 * 1024)     // bytes of every thread's ring, must be power of 2
+    #define LOG_MSG_BUFF        1024            // thread buffer, longer message is formatted to heap
+    #define LOG_MSG_MAX         (16 * 1024)     // max bytes of one message, longer is truncated
+    #define LOG_RATE_SLOTS      32              // rate limit call sites tracked every thread
+    #define LOG_WAIT_MS         20              // logger thread max sleep time
+    #define LOG_RATE_DEFAULT    100
 
-    static char log_buf[512];
+    // record in ring: head, message, padding to 8 bytes
+    struct _RecordHead
+    {
+        uint32_t size;      // head and message with padding
+        uint16_t len;
+        uint8_t level;
+        uint8_t newline;
+        int32_t tid;
+        uint64_t time_us;
+    };
+
+    /**
+     * Single producer(owner thread) single consumer(who holds _Logger::drain_lock) byte ring.
+    */
+    class _Ring
+    {
+    public:
+        _Ring() : buff(LOG_RING_SIZE) {}
+
+        bool push(const _RecordHead &head, const char *msg)
+        {
+            uint64_t h = _head.load(std::memory_order_relaxed);
+            uint64_t t = _tail.load(std::memory_order_acquire);
+            if (head.size > LOG_RING_SIZE - (h - t))
+                return false;
+            _copy_in(h, &head, sizeof(head));
+            _copy_in(h + sizeof(head), msg, head.len);
+            _head.store(h + head.size, std::memory_order_release);
+            return true;
+        }
+
+        // append message to out, return false if empty
+        bool pop(_RecordHead &head, std::string &out)
+        {
+            uint64_t t = _tail.load(std::memory_order_relaxed);
+            if (t == _head.load(std::memory_order_acquire))
+                return false;
+            _copy_out(t, &head, sizeof(head));
+            size_t pos = out.size();
+            out.resize(pos + head.len);
+            _copy_out(t + sizeof(head), &out[pos], head.len);
+            _tail.store(t + head.size, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+        }
+
+        std::atomic<bool> dead{false};  // owner thread exited, removed after drained
+
+    private:
+        void _copy_in(uint64_t pos, const void *src, size_t n)
+        {
+            size_t off = pos & (LOG_RING_SIZE - 1);
+            size_t first = std::min(n, (size_t)LOG_RING_SIZE - off);
+            memcpy(&buff[off], src, first);
+            memcpy(&buff[0], (const uint8_t *)src + first, n - first);
+        }
+
+        void _copy_out(uint64_t pos, void *dst, size_t n)
+        {
+            size_t off = pos & (LOG_RING_SIZE - 1);
+            size_t first = std::min(n, (size_t)LOG_RING_SIZE - off);
+            memcpy(dst, &buff[off], first);
+            memcpy((uint8_t *)dst + first, &buff[0], n - first);
+        }
+
+        std::vector<uint8_t> buff;
+        std::atomic<uint64_t> _head{0};
+        std::atomic<uint64_t> _tail{0};
+    };
+
+    struct _RateSlot
+    {
+        const char *fmt;
+        uint64_t start_us;
+        uint32_t count;
+        uint32_t suppressed;
+    };
+
+    struct _ThreadLog
+    {
+        std::shared_ptr<_Ring> ring;
+        int tid;
+        char buff[LOG_MSG_BUFF];
+        std::string long_buff;
+        std::string error_str;
+        _RateSlot slots[LOG_RATE_SLOTS];
+
+        _ThreadLog()
+        {
+            tid = (int)syscall(SYS_gettid);
+            memset(slots, 0, sizeof(slots));
+        }
+
+        ~_ThreadLog()
+        {
+            if (ring)
+                ring->dead.store(true, std::memory_order_release);
+        }
+    };
+
+    class _Logger
+    {
+    public:
+        _Logger()
+        {
+            sinks.push_back(&stdout_sink);
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> guard(thread_lock);
+            if (started.load(std::memory_order_acquire) || exited)
+                return;
+            std::thread t(&_Logger::_run, this);
+            t.detach();
+            started.store(true, std::memory_order_release);
+        }
+
+        // only called once by atexit, logs after this are written in caller thread
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> guard(thread_lock);
+                exited = true;
+                async.store(false, std::memory_order_release);
+                if (started.load(std::memory_order_acquire))
+                {
+                    std::unique_lock<std::mutex> lock(wait_lock);
+                    exit_req = true;
+                    wait_cond.notify_one();
+                    // wait at most 1s in case logger thread blocks in sink
+                    exit_cond.wait_for(lock, std::chrono::seconds(1), [this] { return !started.load(); });
+                }
+            }
+            drain();
+        }
+
+        void notify()
+        {
+            if (sleeping.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lock(wait_lock);
+                wait_cond.notify_one();
+            }
+        }
+
+        std::shared_ptr<_Ring> new_ring()
+        {
+            auto ring = std::make_shared<_Ring>();
+            std::lock_guard<std::mutex> guard(rings_lock);
+            rings.push_back(ring);
+            return ring;
+        }
+
+        // write pending records of all rings to sinks ordered by time, return record number
+        int drain()
+        {
+            std::lock_guard<std::mutex> guard(drain_lock);
+            {
+                std::lock_guard<std::mutex> rguard(rings_lock);
+                snapshot = rings;
+            }
+            batch.clear();
+            batch_msg.clear();
+            _RecordHead head;
+            for (auto &ring : snapshot)
+            {
+                bool dead = ring->dead.load(std::memory_order_acquire);
+                size_t offset = batch_msg.size();
+                while (ring->pop(head, batch_msg))
+                {
+                    batch.push_back({head, offset});
+                    offset = batch_msg.size();
+                }
+                if (dead)
+                {
+                    std::lock_guard<std::mutex> rguard(rings_lock);
+                    rings.erase(std::remove(rings.begin(), rings.end(), ring), rings.end());
+                }
+            }
+            snapshot.clear();
+            if (batch.empty())
+                return 0;
+            // records of one thread are already ordered, stable sort keeps it when times are same
+            std::stable_sort(batch.begin(), batch.end(), [](const _Item &a, const _Item &b) {
+                return a.head.time_us < b.head.time_us;
+            });
+            std::lock_guard<std::mutex> sguard(sinks_lock);
+            for (auto &item : batch)
+            {
+                Record record;
+                record.level = (LogLevel)item.head.level;
+                record.time_us = item.head.time_us;
+                record.tid = item.head.tid;
+                record.newline = item.head.newline;
+                record.msg = batch_msg.data() + item.offset;
+                record.len = item.head.len;
+                for (auto sink : sinks)
+                    sink->write(record);
+            }
+            for (auto sink : sinks)
+                sink->flush();
+            return (int)batch.size();
+        }
+
+        // called in child process after fork, only the forking thread exists in child,
+        // locks may be held by threads not exist any more, so construct them again.
+        void after_fork(const std::shared_ptr<_Ring> &self_ring)
+        {
+            new (&sinks_lock) std::mutex();
+            new (&rings_lock) std::mutex();
+            new (&drain_lock) std::mutex();
+            new (&thread_lock) std::mutex();
+            new (&wait_lock) std::mutex();
+            new (&wait_cond) std::condition_variable();
+            new (&exit_cond) std::condition_variable();
+            sleeping.store(false);
+            exit_req = false;
+            // logger thread not exists in child process, started again by next log
+            started.store(false);
+            // rings of other threads are never written again, remove them after drained
+            for (auto &ring : rings)
+            {
+                if (ring != self_ring)
+                    ring->dead.store(true);
+            }
+        }
+
+        void write_sync(const Record &record)
+        {
+            std::lock_guard<std::mutex> guard(sinks_lock);
+            for (auto sink : sinks)
+                sink->write(record);
+        }
+
+        StdoutSink stdout_sink;
+        std::mutex sinks_lock;
+        std::vector<Sink *> sinks;
+        std::atomic<int> level{LEVEL_DEBUG};
+#ifdef CONFIG_LOG_SYNC
+        std::atomic<bool> async{false};
+#else
+        std::atomic<bool> async{true};
+#endif
+        std::atomic<int> rate_limit{LOG_RATE_DEFAULT};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> started{false};
+
+    private:
+        struct _Item
+        {
+            _RecordHead head;
+            size_t offset;
+        };
+
+        void _run()
+        {
+            pthread_setname_np(pthread_self(), "maix_log");
+            while (1)
+            {
+                if (drain() > 0)
+                    continue;
+                std::unique_lock<std::mutex> lock(wait_lock);
+                if (exit_req)
+                    break;
+                sleeping.store(true, std::memory_order_release);
+                wait_cond.wait_for(lock, std::chrono::milliseconds(LOG_WAIT_MS));
+                sleeping.store(false, std::memory_order_release);
+            }
+            std::lock_guard<std::mutex> lock(wait_lock);
+            started.store(false);
+            exit_cond.notify_all();
+        }
+
+        std::mutex rings_lock;
+        std::vector<std::shared_ptr<_Ring>> rings;
+        std::mutex drain_lock;
+        std::vector<std::shared_ptr<_Ring>> snapshot;
+        std::vector<_Item> batch;
+        std::string batch_msg;
+        std::mutex thread_lock;
+        bool exited = false;
+        std::mutex wait_lock;
+        std::condition_variable wait_cond;
+        std::condition_variable exit_cond;
+        std::atomic<bool> sleeping{false};
+        bool exit_req = false;
+    };
+
+    static void _at_exit();
+    static void _after_fork();
+
+    // never destructed, logs in static destructors of other modules still work
+    static _Logger &_logger()
+    {
+        static _Logger *logger = [] {
+            _Logger *l = new _Logger();
+            atexit(_at_exit);
+            pthread_atfork(NULL, NULL, _after_fork);
+            return l;
+        }();
+        return *logger;
+    }
+
+    static void _at_exit()
+    {
+        _logger().stop();
+    }
+
+    static _ThreadLog &_thread_log();
+
+    static void _after_fork()
+    {
+        _logger().after_fork(_thread_log().ring);
+    }
+
+    static _ThreadLog &_thread_log()
+    {
+        thread_local _ThreadLog t;
+        return t;
+    }
+
+    static inline uint64_t _time_us()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    static void _emit(_ThreadLog &t, LogLevel level, bool newline, uint64_t time_us, const char *msg, int len)
+    {
+        _Logger &logger = _logger();
+        if (!logger.async.load(std::memory_order_acquire))
+        {
+            Record record = {level, time_us, t.tid, newline, msg, len};
+            logger.write_sync(record);
+            return;
+        }
+        if (!logger.started.load(std::memory_order_acquire))
+            logger.start();
+        if (!t.ring)
+            t.ring = logger.new_ring();
+        _RecordHead head;
+        head.size = (uint32_t)((sizeof(head) + len + 7) & ~(size_t)7);
+        head.len = (uint16_t)len;
+        head.level = (uint8_t)level;
+        head.newline = newline;
+        head.tid = t.tid;
+        head.time_us = time_us;
+        if (!t.ring->push(head, msg))
+        {
+            logger.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        logger.notify();
+    }
+
+    // return false if call site exceeds rate limit
+    static bool _rate_check(_ThreadLog &t, const char *fmt, uint64_t now_us)
+    {
+        int limit = _logger().rate_limit.load(std::memory_order_relaxed);
+        if (limit <= 0)
+            return true;
+        _RateSlot &slot = t.slots[((uintptr_t)fmt >> 3) % LOG_RATE_SLOTS];
+        if (slot.fmt != fmt || now_us - slot.start_us >= 1000000)
+        {
+            if (slot.suppressed > 0)
+            {
+                int len = snprintf(t.buff, sizeof(t.buff), "%u logs suppressed by rate limit: %s", slot.suppressed, slot.fmt);
+                _emit(t, LEVEL_WARN, true, now_us, t.buff, std::min(len, (int)sizeof(t.buff) - 1));
+            }
+            slot.fmt = fmt;
+            slot.start_us = now_us;
+            slot.count = 0;
+            slot.suppressed = 0;
+        }
+        if (++slot.count > (uint32_t)limit)
+        {
+            ++slot.suppressed;
+            return false;
+        }
+        return true;
+    }
+
+    static int _format(_ThreadLog &t, const char *fmt, va_list args, const char **msg)
+    {
+        va_list args2;
+        va_copy(args2, args);
+        int len = vsnprintf(t.buff, sizeof(t.buff), fmt, args);
+        *msg = t.buff;
+        if (len >= (int)sizeof(t.buff))
+        {
+            len = std::min(len, LOG_MSG_MAX - 1);
+            t.long_buff.resize(len + 1);
+            vsnprintf(&t.long_buff[0], len + 1, fmt, args2);
+            *msg = t.long_buff.data();
+        }
+        va_end(args2);
+        return len;
+    }
+
+    static void _log(LogLevel level, bool newline, const char *fmt, va_list args)
+    {
+        _Logger &logger = _logger();
+        if ((int)level > logger.level.load(std::memory_order_relaxed))
+            return;
+        _ThreadLog &t = _thread_log();
+        uint64_t now = _time_us();
+        const char *msg;
+        int len;
+        if (level == LEVEL_ERROR)
+        {
+            // last error is always recorded even the log is suppressed by rate limit
+            len = _format(t, fmt, args, &msg);
+            if (len < 0)
+                return;
+            t.error_str.assign("-- [E] ");
+            t.error_str.append(msg, len);
+            err::set_error(t.error_str);
+            // rate limit summary uses t.buff, so write message from error_str
+            if (!_rate_check(t, fmt, now))
+                return;
+            _emit(t, level, newline, now, t.error_str.data() + 7, len);
+            // errors are rare, write them out now in case program crashes next
+            if (logger.async.load(std::memory_order_relaxed))
+                logger.drain();
+            return;
+        }
+        if (!_rate_check(t, fmt, now))
+            return;
+        len = _format(t, fmt, args, &msg);
+        if (len < 0)
+            return;
+        _emit(t, level, newline, now, msg, len);
+    }
+
+    static const char *_prefix[] = {"", "-- [E] ", "-- [W] ", "-- [I] ", "-- [D] "};
+
+    void StdoutSink::write(const Record &record)
+    {
+        if (record.level != LEVEL_NONE)
+        {
+            fputs(_prefix[record.level], stdout);
+            if (_detail)
+                fprintf(stdout, "[%llu.%06llu][%d] ", (unsigned long long)(record.time_us / 1000000),
+                        (unsigned long long)(record.time_us % 1000000), record.tid);
+        }
+        fwrite(record.msg, 1, record.len, stdout);
+        if (record.newline)
+            fputc('\n', stdout);
+    }
+
+    void StdoutSink::flush()
+    {
+        fflush(stdout);
+    }
+
+    FileSink::FileSink(const std::string &path, size_t max_size, int max_files)
+        : _path(path), _max_size(max_size), _max_files(std::max(max_files, 1)), _size(0)
+    {
+        _fp = fopen(path.c_str(), "a");
+        if (!_fp)
+            throw err::Exception(err::ERR_IO, "open log file " + path + " failed");
+        _size = ftell(_fp);
+    }
+
+    FileSink::~FileSink()
+    {
+        remove_sink(this);
+        if (_fp)
+            fclose(_fp);
+    }
+
+    void FileSink::_rotate()
+    {
+        fclose(_fp);
+        _fp = NULL;
+        std::string last = _path + "." + std::to_string(_max_files - 1);
+        ::remove(last.c_str());
+        for (int i = _max_files - 2; i >= 0; --i)
+        {
+            std::string from = i == 0 ? _path : _path + "." + std::to_string(i);
+            std::string to = _path + "." + std::to_string(i + 1);
+            rename(from.c_str(), to.c_str());
+        }
+        _fp = fopen(_path.c_str(), "w");
+        _size = 0;
+    }
+
+    void FileSink::write(const Record &record)
+    {
+        if (!_fp)
+            return;
+        if (_max_size > 0 && _size >= _max_size)
+        {
+            _rotate();
+            if (!_fp)
+                return;
+        }
+        int n = 0;
+        if (record.level != LEVEL_NONE)
+            n = fprintf(_fp, "%s[%llu.%06llu][%d] ", _prefix[record.level], (unsigned long long)(record.time_us / 1000000),
+                        (unsigned long long)(record.time_us % 1000000), record.tid);
+        n += fwrite(record.msg, 1, record.len, _fp);
+        if (record.newline)
+            n += fputc('\n', _fp) == EOF ? 0 : 1;
+        _size += std::max(n, 0);
+    }
+
+    void FileSink::flush()
+    {
+        if (_fp)
+            fflush(_fp);
+    }
+
+    SyslogSink::SyslogSink(const std::string &ident)
+        : _ident(ident)
+    {
+        // openlog keeps the pointer, so ident is a member
+        openlog(_ident.c_str(), LOG_PID, LOG_USER);
+    }
+
+    SyslogSink::~SyslogSink()
+    {
+        remove_sink(this);
+        closelog();
+    }
+
+    void SyslogSink::write(const Record &record)
+    {
+        static const int priority[] = {LOG_INFO, LOG_ERR, LOG_WARNING, LOG_INFO, LOG_DEBUG};
+        _line.append(record.msg, record.len);
+        if (!record.newline)
+        {
+            // print and error0 like logs may end line themselves
+            if (_line.empty() || _line.back() != '\n')
+                return;
+            _line.pop_back();
+        }
+        syslog(priority[record.level], "%s", _line.c_str());
+        _line.clear();
+    }
+
+    void set_level(log::LogLevel level)
+    {
+        _logger().level.store(level);
+    }
+
+    log::LogLevel get_level()
+    {
+        return (LogLevel)_logger().level.load();
+    }
+
+    void set_async(bool async)
+    {
+        _Logger &logger = _logger();
+        if (!async)
+            logger.drain();
+        logger.async.store(async);
+    }
+
+    void set_rate_limit(int max_per_second)
+    {
+        _logger().rate_limit.store(max_per_second);
+    }
+
+    void add_sink(log::Sink *sink)
+    {
+        _Logger &logger = _logger();
+        std::lock_guard<std::mutex> guard(logger.sinks_lock);
+        if (std::find(logger.sinks.begin(), logger.sinks.end(), sink) == logger.sinks.end())
+            logger.sinks.push_back(sink);
+    }
+
+    void remove_sink(log::Sink *sink)
+    {
+        _Logger &logger = _logger();
+        logger.drain();
+        std::lock_guard<std::mutex> guard(logger.sinks_lock);
+        logger.sinks.erase(std::remove(logger.sinks.begin(), logger.sinks.end(), sink), logger.sinks.end());
+    }
+
+    log::Sink *default_sink()
+    {
+        return &_logger().stdout_sink;
+    }
+
+    void flush()
+    {
+        _Logger &logger = _logger();
+        logger.drain();
+        std::lock_guard<std::mutex> guard(logger.sinks_lock);
+        for (auto sink : logger.sinks)
+            sink->flush();
+    }
+
+    uint64_t dropped()
+    {
+        return _logger().dropped.load();
+    }
 
     void error(const char *fmt, ...)
     {
-        static const char *err_start = "-- [E] ";
-        // print error and call err::set_error
+#if CONFIG_LOG_LEVEL >= 1
         va_list args;
         va_start(args, fmt);
-        printf("%s", err_start);
-        vsnprintf(log_buf, sizeof(log_buf), fmt, args);
-        printf("%s\n", log_buf);
+        _log(LEVEL_ERROR, true, fmt, args);
         va_end(args);
-        err::set_error(err_start + std::string(log_buf));
+#else
+        (void)fmt;
+#endif
     }
 
     void error0(const char *fmt, ...)
     {
-        static const char *err_start = "-- [E] ";
-        // print error and call err::set_error
+#if CONFIG_LOG_LEVEL >= 1
         va_list args;
         va_start(args, fmt);
-        printf("%s", err_start);
-        vsnprintf(log_buf, sizeof(log_buf), fmt, args);
-        printf("%s", log_buf);
+        _log(LEVEL_ERROR, false, fmt, args);
         va_end(args);
-        err::set_error(err_start + std::string(log_buf));
+#else
+        (void)fmt;
+#endif
     }
 
     void warn(const char *fmt, ...)
     {
+#if CONFIG_LOG_LEVEL >= 2
         va_list args;
         va_start(args, fmt);
-        printf("-- [W] ");
-        vprintf(fmt, args);
+        _log(LEVEL_WARN, true, fmt, args);
         va_end(args);
-        printf("\n");
+#else
+        (void)fmt;
+#endif
     }
 
     void warn0(const char *fmt, ...)
     {
+#if CONFIG_LOG_LEVEL >= 2
         va_list args;
         va_start(args, fmt);
-        printf("-- [W] ");
-        vprintf(fmt, args);
+        _log(LEVEL_WARN, false, fmt, args);
         va_end(args);
+#else
+        (void)fmt;
+#endif
     }
 
     void info(const char *fmt, ...)
     {
+#if CONFIG_LOG_LEVEL >= 3
         va_list args;
         va_start(args, fmt);
-        printf("-- [I] ");
-        vprintf(fmt, args);
+        _log(LEVEL_INFO, true, fmt, args);
         va_end(args);
-        printf("\n");
+#else
+        (void)fmt;
+#endif
     }
 
     void info0(const char *fmt, ...)
     {
+#if CONFIG_LOG_LEVEL >= 3
         va_list args;
         va_start(args, fmt);
-        printf("-- [I] ");
-        vprintf(fmt, args);
+        _log(LEVEL_INFO, false, fmt, args);
         va_end(args);
+#else
+        (void)fmt;
+#endif
     }
 
     void debug(const char *fmt, ...)
     {
-#if DEBUG
+#if DEBUG && CONFIG_LOG_LEVEL >= 4
         va_list args;
         va_start(args, fmt);
-        printf("-- [D] ");
-        vprintf(fmt, args);
+        _log(LEVEL_DEBUG, true, fmt, args);
         va_end(args);
-        printf("\n");
 #else
         (void)fmt;
 #endif
@@ -95,11 +725,10 @@ namespace maix::log
 
     void debug0(const char *fmt, ...)
     {
-#if DEBUG
+#if DEBUG && CONFIG_LOG_LEVEL >= 4
         va_list args;
         va_start(args, fmt);
-        printf("-- [D] ");
-        vprintf(fmt, args);
+        _log(LEVEL_DEBUG, false, fmt, args);
         va_end(args);
 #else
         (void)fmt;
@@ -108,10 +737,16 @@ namespace maix::log
 
     void print(const char *fmt, ...)
     {
+        // print is not rate limited, it's used to output data
         va_list args;
         va_start(args, fmt);
-        vprintf(fmt, args);
+        _ThreadLog &t = _thread_log();
+        const char *msg;
+        int len = _format(t, fmt, args, &msg);
         va_end(args);
+        if (len < 0)
+            return;
+        _emit(t, LEVEL_NONE, false, _time_us(), msg, len);
     }
 
 } // namespace maix::log
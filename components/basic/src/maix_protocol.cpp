@@ -3,102 +3,170 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Streaming Decoder on ring buffer, slicing-by-8 CRC16, scatter encoder.
  */
 
 
 #include "maix_protocol.hpp"
 #include <string.h>
-#include <assert.h>
+#include <algorithm>
 
 namespace maix::protocol
 {
     uint32_t HEADER = 0xBBACCAAA;
-    uint16_t crc16_IBM(uint8_t *ptr, size_t len)
+
+    // slicing-by-8 tables of reflected polynomial 0xA001, t[0] is the byte-wise table
+    struct _Crc16Table
     {
-        unsigned int i;
-        uint16_t crc = 0x0000;
+        uint16_t t[8][256];
 
-        while (len--)
+        constexpr _Crc16Table() : t()
         {
-            crc ^= *ptr++;
-            for (i = 0; i < 8; ++i)
+            for (int i = 0; i < 256; ++i)
             {
-                if (crc & 1)
-                    crc = (crc >> 1) ^ 0xA001;
-                else
-                    crc = (crc >> 1);
+                uint16_t crc = i;
+                for (int j = 0; j < 8; ++j)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+                t[0][i] = crc;
+            }
+            for (int k = 1; k < 8; ++k)
+            {
+                for (int i = 0; i < 256; ++i)
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
             }
         }
+    };
 
+    static constexpr _Crc16Table _crc16_table;
+
+    uint16_t crc16_IBM_update(uint16_t crc, const uint8_t *ptr, size_t len)
+    {
+        const uint16_t (*t)[256] = _crc16_table.t;
+        while (len >= 8)
+        {
+            crc = t[7][(ptr[0] ^ crc) & 0xFF] ^ t[6][ptr[1] ^ (crc >> 8)] ^
+                  t[5][ptr[2]] ^ t[4][ptr[3]] ^ t[3][ptr[4]] ^ t[2][ptr[5]] ^ t[1][ptr[6]] ^ t[0][ptr[7]];
+            ptr += 8;
+            len -= 8;
+        }
+        while (len--)
+            crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
         return crc;
     }
 
+    uint16_t crc16_IBM(uint8_t *ptr, size_t len)
+    {
+        return crc16_IBM_update(0, ptr, len);
+    }
+
     uint16_t crc16_IBM(const Bytes *bytes)
     {
         return crc16_IBM(bytes->data, bytes->size());
     }
 
+    static inline void _put_u32(uint8_t *p, uint32_t v)
+    {
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+        p[2] = (v >> 16) & 0xFF;
+        p[3] = (v >> 24) & 0xFF;
+    }
+
+    static inline int _frame_len(int body_len, uint8_t code)
+    {
+        return body_len + 10 + (code != 0xFF ? 1 : 0) + TAIL_LEN;
+    }
+
+    // write head, return head length, data length field counts error code in as body
+    static int _encode_head(uint8_t *head, uint8_t cmd, uint8_t flags, size_t body_len, uint8_t code, uint8_t version)
+    {
+        _put_u32(head, HEADER);
+        _put_u32(head + 4, body_len + (code != 0xFF ? 5 : 4));
+        head[8] = flags | version;
+        head[9] = cmd;
+        if (code == 0xFF)
+            return 10;
+        head[10] = code;
+        return 11;
+    }
+
+    int encodev(uint8_t *head, uint8_t *tail, uint8_t cmd, uint8_t flags, const struct iovec *body, int body_cnt, uint8_t code, const uint8_t version)
+    {
+        if (version != VERSION || body_cnt < 0 || (body_cnt > 0 && !body))
+            return -err::ERR_ARGS;
+        size_t body_len = 0;
+        for (int i = 0; i < body_cnt; ++i)
+            body_len += body[i].iov_len;
+        int head_len = _encode_head(head, cmd, flags, body_len, code, version);
+        uint16_t crc16 = crc16_IBM_update(0, head, head_len);
+        for (int i = 0; i < body_cnt; ++i)
+            crc16 = crc16_IBM_update(crc16, (const uint8_t *)body[i].iov_base, body[i].iov_len);
+        tail[0] = crc16 & 0xFF;
+        tail[1] = crc16 >> 8 & 0xFF;
+        return head_len;
+    }
+
     int encode(uint8_t *out_buff, int out_buff_len,
                uint8_t cmd, uint8_t flags, uint8_t *body, int body_len,
                uint8_t code,
                const uint8_t version)
     {
-        assert((uint64_t)out_buff % 4 == 0);
-
-        if (version != VERSION)
+        if (version != VERSION || body_len < 0)
             return -err::ERR_ARGS;
-        if (out_buff_len < body_len + 12)
+        if (out_buff_len < _frame_len(body_len, code))
             return -err::ERR_ARGS;
-        ((uint32_t *)out_buff)[0] = HEADER;
-        ((uint32_t *)out_buff)[1] = body_len + 4;
-        out_buff[8] = flags | version;
-        out_buff[9] = cmd;
-        if (code != 0xFF)
-        {
-            out_buff[10] = code;
-            memcpy(out_buff + 11, body, body_len);
-            uint16_t crc16 = crc16_IBM(out_buff, body_len + 11);
-            out_buff[11 + body_len] = crc16 & 0xFF;
-            out_buff[12 + body_len] = crc16 >> 8 & 0xFF;
-            return body_len + 13;
-        }
-        memcpy(out_buff + 10, body, body_len);
-        uint16_t crc16 = crc16_IBM(out_buff, body_len + 10);
-        out_buff[10 + body_len] = crc16 & 0xFF;
-        out_buff[11 + body_len] = crc16 >> 8 & 0xFF;
-        return body_len + 12;
+        int head_len = _encode_head(out_buff, cmd, flags, body_len, code, version);
+        if (body_len > 0)
+            memcpy(out_buff + head_len, body, body_len);
+        uint16_t crc16 = crc16_IBM_update(0, out_buff, head_len + body_len);
+        out_buff[head_len + body_len] = crc16 & 0xFF;
+        out_buff[head_len + body_len + 1] = crc16 >> 8 & 0xFF;
+        return head_len + body_len + TAIL_LEN;
     }
 
-    Bytes *encode_resp_ok(uint8_t cmd, uint8_t *body, int body_len)
+    // encode to a new Bytes object, only one allocation of the exact frame size
+    static Bytes *_encode_bytes(uint8_t cmd, uint8_t flags, uint8_t *body, int body_len, uint8_t code = 0xFF)
     {
-        uint8_t *buff = new uint8_t[12 + body_len];
-        int len = encode(buff, 12 + body_len, cmd, FLAG_RESP | FLAG_RESP_OK, body, body_len);
+        if (body_len < 0)
+            return nullptr;
+        int size = _frame_len(body_len, code);
+        uint8_t *buff = new uint8_t[size];
+        int len = encode(buff, size, cmd, flags, body, body_len, code);
         if (len < 0)
         {
             delete[] buff;
             return nullptr;
         }
-        Bytes *ret = new Bytes(buff, len, true, false);
-        return ret;
+        return new Bytes(buff, len, true, false);
+    }
+
+    Bytes *encode_resp_ok(uint8_t cmd, uint8_t *body, int body_len)
+    {
+        return _encode_bytes(cmd, FLAG_RESP | FLAG_RESP_OK, body, body_len);
     }
 
     Bytes *encode_resp_ok(uint8_t cmd, Bytes *body)
     {
-        int body_len = body->size();
-        return protocol::encode_resp_ok(cmd, body->data, body_len);
+        if (!body)
+            return protocol::encode_resp_ok(cmd, nullptr, 0);
+        return protocol::encode_resp_ok(cmd, body->data, body->size());
+    }
+
+    Bytes *encode_report(uint8_t cmd, uint8_t *body, int body_len)
+    {
+        return _encode_bytes(cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
+    }
+
+    Bytes *encode_report(uint8_t cmd, Bytes *body)
+    {
+        if (!body)
+            return protocol::encode_report(cmd, nullptr, 0);
+        return protocol::encode_report(cmd, body->data, body->size());
     }
 
     Bytes *encode_resp_err(uint8_t cmd, err::Err code, const std::string &msg)
     {
-        uint8_t *buff = new uint8_t[13 + msg.length()];
-        int len = encode(buff, 13 + msg.length(), cmd, FLAG_RESP | FLAG_RESP_ERR, (uint8_t *)msg.c_str(), msg.length(), code);
-        if (len < 0)
-        {
-            delete[] buff;
-            return nullptr;
-        }
-        Bytes *ret = new Bytes(buff, len, true, false);
-        return ret;
+        return _encode_bytes(cmd, FLAG_RESP | FLAG_RESP_ERR, (uint8_t *)msg.c_str(), msg.length(), code);
     }
 
     int encode_resp_ok(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
@@ -106,75 +174,14 @@ namespace maix::protocol
         return encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_OK, body, body_len);
     }
 
-    int encode_resp_err(uint8_t *buff, int buff_len, uint8_t cmd, err::Err code, const std::string &msg)
+    int encode_report(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
     {
-        return encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_ERR, (uint8_t *)msg.c_str(), msg.length(), code);
+        return encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
     }
 
-    bool get_msg(uint8_t *data, int len, MSG *frame, int *idx, const uint32_t header=HEADER)
+    int encode_resp_err(uint8_t *buff, int buff_len, uint8_t cmd, err::Err code, const std::string &msg)
     {
-        size_t data_len = 0;
-
-        *idx = 0;
-        if (len < 12)
-            return false;
-        // find header
-        uint32_t i = 0;
-        bool found = false;
-        for (; i < (uint32_t)len - 4; i++)
-        {
-            if (data[i] == (header & 0xFF) &&
-                data[i + 1] == ((header >> 8) & 0xFF) &&
-                data[i + 2] == ((header >> 16) & 0xFF) &&
-                data[i + 3] == ((header >> 24) & 0xFF))
-            {
-                found = true;
-                break;
-            }
-        }
-        // len >= 12
-        if (!found)
-        {
-            *idx = i;
-            return false;
-        }
-        if (len - i < 12)
-            return false;
-
-        // get data_len, and check data length
-        data_len = data[i + 4] | (data[i + 5] << 8) | (data[i + 6] << 16) | (data[i + 7] << 24);
-        if (data_len > len - i - 8)
-            return false;
-        *idx = i + 8 + data_len;
-        // check crc
-        uint16_t crc16 = crc16_IBM(data + i, data_len + 6);
-        if (data[i + 6 + data_len] != (crc16 & 0xFF) || data[i + 7 + data_len] != (crc16 >> 8 & 0xFF))
-        {
-            return false;
-        }
-        // parse data
-        frame->version = data[i + 8] & FLAG_VERSION_MASK;
-        frame->is_resp = data[i + 8] & FLAG_IS_RESP_MASK;
-        frame->is_req = !frame->is_resp;
-        frame->is_report = data[i + 8] & FLAG_REPORT_MASK;
-        frame->resp_ok = data[i + 8] & FLAG_RESP_OK_MASK;
-        frame->cmd = data[i + 9];
-        frame->set_body(data + i + 10, data_len - 4);
-        frame->body_len = data_len - 4;
-        return true;
-    }
-
-    std::tuple<MSG *, int> get_msg(uint8_t *data, int len)
-    {
-        MSG *frame = new MSG();
-        int idx = 0;
-        if (get_msg(data, len, frame, &idx))
-            return std::make_tuple(frame, idx);
-        else
-        {
-            delete frame;
-            return std::make_tuple(nullptr, idx);
-        }
+        return encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_ERR, (uint8_t *)msg.c_str(), msg.length(), code);
     }
 
     MSG::MSG()
@@ -215,33 +222,17 @@ namespace maix::protocol
 
     int MSG::encode_report(uint8_t *buff, int buff_len, uint8_t *body, int body_len)
     {
-        return protocol::encode(buff, buff_len, this->cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
+        return protocol::encode_report(buff, buff_len, this->cmd, body, body_len);
     }
 
     Bytes *MSG::encode_report(uint8_t *body, int body_len)
     {
-        uint8_t *buff = new uint8_t[12 + body_len];
-        int len = protocol::encode(buff, 12 + body_len, this->cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
-        if (len < 0)
-        {
-            delete[] buff;
-            return nullptr;
-        }
-        Bytes *ret = new Bytes(buff, len, true, false);
-        return ret;
+        return protocol::encode_report(this->cmd, body, body_len);
     }
 
     Bytes *MSG::encode_report(Bytes *body)
     {
-        uint8_t *buff = new uint8_t[12 + body_len];
-        int len = protocol::encode(buff, 12 + body_len, this->cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body->data, (int)body->size());
-        if (len < 0)
-        {
-            delete[] buff;
-            return nullptr;
-        }
-        Bytes *ret = new Bytes(buff, len, true, false);
-        return ret;
+        return protocol::encode_report(this->cmd, body);
     }
 
     int MSG::encode_resp_err(uint8_t *buff, int buff_len, err::Err code, const std::string &msg)
@@ -267,10 +258,171 @@ namespace maix::protocol
             body = new uint8_t[body_len];
             _body_buff_len = body_len;
         }
-        memcpy(body, body_new, body_len);
+        if (body_len > 0)
+            memcpy(body, body_new, body_len);
         this->body_len = body_len;
     }
 
+    Decoder::Decoder(int buff_size, uint32_t header)
+    {
+        // header(4) + data length(4) + flags(1) + cmd(1) + crc(2)
+        _size = 16;
+        while (_size < (uint32_t)buff_size)
+            _size <<= 1;
+        _mask = _size - 1;
+        // spare area after ring keeps the wrapped part of one frame
+        _buff = new uint8_t[_size * 2];
+        for (int i = 0; i < 4; ++i)
+            _header[i] = (header >> (i * 8)) & 0xFF;
+        _fail[0] = 0;
+        for (int i = 1, k = 0; i < 4; ++i)
+        {
+            while (k > 0 && _header[i] != _header[k])
+                k = _fail[k - 1];
+            if (_header[i] == _header[k])
+                ++k;
+            _fail[i] = k;
+        }
+        _crc_errors = 0;
+        _skipped = 0;
+        reset();
+    }
+
+    Decoder::~Decoder()
+    {
+        delete[] _buff;
+    }
+
+    void Decoder::reset()
+    {
+        _head = 0;
+        _tail = 0;
+        _matched = 0;
+        _frame_len = 0;
+    }
+
+    uint8_t *Decoder::prepare(int *size)
+    {
+        uint32_t off = _head & _mask;
+        *size = (int)std::min((uint64_t)(_size - off), _size - (_head - _tail));
+        return _buff + off;
+    }
+
+    void Decoder::commit(int len)
+    {
+        _head += len;
+    }
+
+    int Decoder::feed(const uint8_t *data, int len)
+    {
+        int total = 0;
+        while (total < len)
+        {
+            int size;
+            uint8_t *p = prepare(&size);
+            if (size == 0)
+                break;
+            size = std::min(size, len - total);
+            memcpy(p, data + total, size);
+            commit(size);
+            total += size;
+        }
+        return total;
+    }
+
+    // current candidate is not a valid frame, search header again from the next byte
+    void Decoder::_resync()
+    {
+        ++_tail;
+        ++_skipped;
+        _matched = 0;
+        _frame_len = 0;
+    }
+
+    bool Decoder::next(protocol::MsgView &msg)
+    {
+        while (1)
+        {
+            // search header, bytes of [_tail, _tail + _matched) match header
+            while (_matched < 4)
+            {
+                uint64_t pos = _tail + _matched;
+                if (pos >= _head)
+                    return false;
+                if (_matched == 0)
+                {
+                    // fast skip to the first header byte in continuous part
+                    uint32_t off = pos & _mask;
+                    size_t n = std::min((uint64_t)(_size - off), _head - pos);
+                    const uint8_t *p = (const uint8_t *)memchr(_buff + off, _header[0], n);
+                    if (!p)
+                    {
+                        _tail += n;
+                        _skipped += n;
+                        continue;
+                    }
+                    _skipped += p - (_buff + off);
+                    _tail += p - (_buff + off);
+                    _matched = 1;
+                    continue;
+                }
+                uint8_t c = _at(pos);
+                while (_matched > 0 && c != _header[_matched])
+                {
+                    int keep = _fail[_matched - 1];
+                    _skipped += _matched - keep;
+                    _tail += _matched - keep;
+                    _matched = keep;
+                }
+                if (c == _header[_matched])
+                    ++_matched;
+                else
+                {
+                    ++_tail;
+                    ++_skipped;
+                }
+            }
+            if (_frame_len == 0)
+            {
+                if (_head - _tail < 8)
+                    return false;
+                uint32_t data_len = _at(_tail + 4) | (_at(_tail + 5) << 8) | (_at(_tail + 6) << 16) | ((uint32_t)_at(_tail + 7) << 24);
+                if (data_len < 4 || data_len > _size - 8)
+                {
+                    _resync();
+                    continue;
+                }
+                _frame_len = data_len + 8;
+            }
+            if (_head - _tail < _frame_len)
+                return false;
+            // make frame continuous
+            uint32_t off = _tail & _mask;
+            if (off + _frame_len > _size)
+                memcpy(_buff + _size, _buff, off + _frame_len - _size);
+            const uint8_t *frame = _buff + off;
+            uint16_t crc16 = crc16_IBM_update(0, frame, _frame_len - 2);
+            if (frame[_frame_len - 2] != (crc16 & 0xFF) || frame[_frame_len - 1] != (crc16 >> 8 & 0xFF))
+            {
+                ++_crc_errors;
+                _resync();
+                continue;
+            }
+            msg.version = frame[8] & FLAG_VERSION_MASK;
+            msg.is_resp = frame[8] & FLAG_IS_RESP_MASK;
+            msg.is_req = !msg.is_resp;
+            msg.is_report = frame[8] & FLAG_REPORT_MASK;
+            msg.resp_ok = frame[8] & FLAG_RESP_OK_MASK;
+            msg.cmd = frame[9];
+            msg.body = frame + 10;
+            msg.body_len = _frame_len - 12;
+            _tail += _frame_len;
+            _matched = 0;
+            _frame_len = 0;
+            return true;
+        }
+    }
+
     int Protocol::encode_resp_ok(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
     {
         return protocol::encode_resp_ok(buff, buff_len, cmd, body, body_len);
@@ -288,25 +440,17 @@ namespace maix::protocol
 
     int Protocol::encode_report(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
     {
-        return protocol::encode(buff, buff_len, cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
+        return protocol::encode_report(buff, buff_len, cmd, body, body_len);
     }
 
     Bytes *Protocol::encode_report(uint8_t cmd, uint8_t *body, int body_len)
     {
-        uint8_t *buff = new uint8_t[12 + body_len];
-        int len = protocol::encode(buff, 12 + body_len, cmd, FLAG_RESP | FLAG_RESP_OK | FLAG_REPORT, body, body_len);
-        if (len < 0)
-        {
-            delete[] buff;
-            return nullptr;
-        }
-        Bytes *ret = new Bytes(buff, len, true, false);
-        return ret;
+        return protocol::encode_report(cmd, body, body_len);
     }
 
     Bytes *Protocol::encode_report(uint8_t cmd, Bytes *body)
     {
-        return Protocol::encode_report(cmd, body->data, body->size());
+        return protocol::encode_report(cmd, body);
     }
 
     int Protocol::encode_resp_err(uint8_t *buff, int buff_len, uint8_t cmd, err::Err code, const std::string &msg)
@@ -320,59 +464,63 @@ namespace maix::protocol
     }
 
     Protocol::Protocol(int buff_size, uint32_t header)
+        : _decoder(buff_size, header)
     {
         _buff_size = buff_size;
-        _buff = new uint8_t[buff_size];
-        _data_len = 0;
         _header = header;
         HEADER = header;
     }
 
     Protocol::~Protocol()
     {
-        delete[] _buff;
     }
 
     err::Err Protocol::push_data(uint8_t *new_data, int len)
     {
-        if (_data_len + len > _buff_size)
+        if (_decoder.free_len() < len)
             return err::ERR_BUFF_FULL;
-        memcpy(_buff + _data_len, new_data, len);
-        _data_len += len;
+        _decoder.feed(new_data, len);
         return err::ERR_NONE;
     }
 
     err::Err Protocol::push_data(const Bytes *new_data)
     {
-        return push_data((uint8_t *)&new_data[0], new_data->size());
+        return push_data(new_data->data, new_data->size());
     }
 
     MSG *Protocol::decode(uint8_t *new_data, size_t len)
     {
-        if (len > 0)
+        MSG *frame = nullptr;
+        MsgView view;
+        while (1)
         {
-            push_data(new_data, len);
-        }
-        MSG *frame = new MSG();
-        int idx = 0;
-        if (get_msg(_buff, _data_len, frame, &idx, _header))
-        {
-            memmove(_buff, _buff + idx, _data_len - idx);
-            _data_len -= idx;
-            return frame;
-        }
-        if (idx > 0)
-        {
-            memmove(_buff, _buff + idx, _data_len - idx);
-            _data_len -= idx;
+            int n = new_data ? _decoder.feed(new_data, len) : 0;
+            new_data += n;
+            len -= n;
+            // decode to release buffer, then feed the rest, only one message is returned
+            if (!frame && _decoder.next(view))
+            {
+                frame = new MSG();
+                frame->version = view.version;
+                frame->is_resp = view.is_resp;
+                frame->is_req = view.is_req;
+                frame->is_report = view.is_report;
+                frame->resp_ok = view.resp_ok;
+                frame->cmd = view.cmd;
+                frame->set_body((uint8_t *)view.body, view.body_len);
+                continue;
+            }
+            if (len == 0 || n == 0)
+                break;
         }
-        delete frame;
-        return nullptr;
+        return frame;
     }
 
     MSG *Protocol::decode(const Bytes *new_data)
     {
-        return decode((uint8_t *)&new_data[0], new_data->size());
+        if (!new_data)
+            return decode(nullptr, 0);
+        return decode(new_data->data, new_data->size());
     }
 
 } // namespace maix::protocol
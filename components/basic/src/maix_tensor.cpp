@@ -0,0 +1,309 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add Arena, transpose, slice and TensorView, create this file.
+ */
+
+#include "maix_tensor.hpp"
+
+namespace maix::tensor
+{
+    #define ARENA_BLOCK_MIN 4096
+
+    std::atomic<uint64_t> Tensors::_erase_epoch(0);
+
+    Arena::Arena(size_t capacity)
+    {
+        _pos = 0;
+        _used = 0;
+        _fixed = false;
+        if (capacity > 0)
+        {
+            uint8_t *data = (uint8_t *)malloc(capacity);
+            if (!data)
+                throw err::Exception(err::ERR_NO_MEM, "alloc arena failed");
+            _blocks.push_back({data, capacity});
+        }
+    }
+
+    Arena::Arena(void *buff, size_t size)
+    {
+        _pos = 0;
+        _used = 0;
+        _fixed = true;
+        _blocks.push_back({(uint8_t *)buff, size});
+    }
+
+    Arena::~Arena()
+    {
+        if (_fixed)
+            return;
+        for (auto &b : _blocks)
+            free(b.data);
+    }
+
+    void *Arena::alloc(size_t bytes, size_t align)
+    {
+        if (!_blocks.empty())
+        {
+            Block &b = _blocks.back();
+            uintptr_t base = (uintptr_t)b.data;
+            size_t start = ((base + _pos + align - 1) & ~(uintptr_t)(align - 1)) - base;
+            if (start + bytes <= b.size)
+            {
+                _used += start + bytes - _pos;
+                _pos = start + bytes;
+                return b.data + start;
+            }
+        }
+        if (_fixed)
+            return nullptr;
+        // new block at least double of the last one, reset() merges them, so it only happens in the first rounds
+        size_t size = std::max(bytes + align, (size_t)ARENA_BLOCK_MIN);
+        if (!_blocks.empty())
+            size = std::max(size, _blocks.back().size * 2);
+        uint8_t *data = (uint8_t *)malloc(size);
+        if (!data)
+            return nullptr;
+        _blocks.push_back({data, size});
+        _pos = 0;
+        return alloc(bytes, align);
+    }
+
+    void Arena::reset()
+    {
+        if (!_fixed && _blocks.size() > 1)
+        {
+            size_t total = capacity();
+            for (auto &b : _blocks)
+                free(b.data);
+            _blocks.clear();
+            uint8_t *data = (uint8_t *)malloc(total);
+            if (data)
+                _blocks.push_back({data, total});
+        }
+        _pos = 0;
+        _used = 0;
+    }
+
+    size_t Arena::capacity() const
+    {
+        size_t total = 0;
+        for (auto &b : _blocks)
+            total += b.size;
+        return total;
+    }
+
+    static std::vector<int> _contiguous_strides(const std::vector<int> &shape)
+    {
+        std::vector<int> strides(shape.size());
+        int stride = 1;
+        for (int i = (int)shape.size() - 1; i >= 0; --i)
+        {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+        return strides;
+    }
+
+    void Tensor::transpose(std::vector<int> axes)
+    {
+        tensor::TensorView view = tensor::TensorView(*this).transpose(axes);
+        void *data = malloc(_bytes(view.shape(), _dtype));
+        if (!data)
+            throw err::Exception(err::ERR_NO_MEM, "alloc tensor failed");
+        view.copy_to(data);
+        if (_is_alloc)
+            free(_data);
+        _data = data;
+        _is_alloc = true;
+        _shape = view.shape();
+    }
+
+    tensor::Tensor Tensor::slice(int axis, int start, int end)
+    {
+        tensor::TensorView view = tensor::TensorView(*this).slice(axis, start, end);
+        if (view.is_contiguous())
+        {
+            // one contiguous range, view only
+            return tensor::Tensor(view.shape(), _dtype, view.data(), false);
+        }
+        tensor::Tensor out(view.shape(), _dtype);
+        view.copy_to(out.data());
+        return out;
+    }
+
+    TensorView::TensorView(tensor::Tensor &t)
+    {
+        _data = t.data();
+        _shape = t.shape();
+        _strides = _contiguous_strides(_shape);
+        _dtype = t.dtype();
+    }
+
+    TensorView::TensorView(void *data, const std::vector<int> &shape, tensor::DType dtype, const std::vector<int> &strides)
+    {
+        if (!strides.empty() && strides.size() != shape.size())
+        {
+            log::error("strides size not match shape\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        _data = data;
+        _shape = shape;
+        _strides = strides.empty() ? _contiguous_strides(shape) : strides;
+        _dtype = dtype;
+    }
+
+    int TensorView::size_int() const
+    {
+        if (_shape.empty())
+            return 0;
+        int size = 1;
+        for (auto d : _shape)
+            size *= d;
+        return size;
+    }
+
+    bool TensorView::is_contiguous() const
+    {
+        int stride = 1;
+        for (int i = (int)_shape.size() - 1; i >= 0; --i)
+        {
+            if (_shape[i] != 1 && _strides[i] != stride)
+                return false;
+            stride *= _shape[i];
+        }
+        return true;
+    }
+
+    tensor::TensorView TensorView::transpose(std::vector<int> axes) const
+    {
+        int dims = (int)_shape.size();
+        if (axes.empty())
+        {
+            for (int i = dims - 1; i >= 0; --i)
+                axes.push_back(i);
+        }
+        if ((int)axes.size() != dims)
+        {
+            log::error("transpose axes size not match\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        std::vector<int> shape(dims), strides(dims);
+        std::vector<bool> used(dims, false);
+        for (int i = 0; i < dims; ++i)
+        {
+            int axis = axes[i] < 0 ? axes[i] + dims : axes[i];
+            if (axis < 0 || axis >= dims || used[axis])
+            {
+                log::error("transpose axes not valid\n");
+                throw err::Exception(err::ERR_ARGS);
+            }
+            used[axis] = true;
+            shape[i] = _shape[axis];
+            strides[i] = _strides[axis];
+        }
+        return tensor::TensorView(_data, shape, _dtype, strides);
+    }
+
+    tensor::TensorView TensorView::slice(int axis, int start, int end) const
+    {
+        int dims = (int)_shape.size();
+        if (axis < 0)
+            axis += dims;
+        if (axis < 0 || axis >= dims)
+        {
+            log::error("axis out of range\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        int n = _shape[axis];
+        if (start < 0)
+            start += n;
+        if (end < 0)
+            end += n;
+        start = std::max(0, std::min(start, n));
+        end = std::max(start, std::min(end, n));
+        std::vector<int> shape = _shape;
+        shape[axis] = end - start;
+        uint8_t *data = (uint8_t *)_data + (size_t)start * _strides[axis] * dtype_size[_dtype];
+        return tensor::TensorView(data, shape, _dtype, _strides);
+    }
+
+    tensor::TensorView TensorView::reshape(const std::vector<int> &shape) const
+    {
+        int size = 1;
+        for (auto d : shape)
+            size *= d;
+        if (shape.empty() || size != size_int())
+        {
+            log::error("reshape size not match\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        if (!is_contiguous())
+        {
+            log::error("reshape view not contiguous, use to_tensor first\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        return tensor::TensorView(_data, shape, _dtype);
+    }
+
+    void *TensorView::ptr(const std::vector<int> &idx) const
+    {
+        if (idx.size() != _shape.size())
+        {
+            log::error("index size not match shape\n");
+            throw err::Exception(err::ERR_ARGS);
+        }
+        size_t offset = 0;
+        for (size_t i = 0; i < idx.size(); ++i)
+        {
+            if (idx[i] < 0 || idx[i] >= _shape[i])
+            {
+                log::error("index out of range\n");
+                throw err::Exception(err::ERR_ARGS);
+            }
+            offset += (size_t)idx[i] * _strides[i];
+        }
+        return (uint8_t *)_data + offset * dtype_size[_dtype];
+    }
+
+    void TensorView::copy_to(void *dst) const
+    {
+        int dims = (int)_shape.size();
+        if (size_int() == 0)
+            return;
+        size_t esize = dtype_size[_dtype];
+        // merge inner axes that keep order to copy rows with memcpy
+        size_t row = 1;
+        int inner = dims;
+        while (inner > 0 && (_shape[inner - 1] == 1 || _strides[inner - 1] == (int)row))
+            row *= _shape[--inner];
+        size_t rows = 1;
+        for (int i = 0; i < inner; ++i)
+            rows *= _shape[i];
+        std::vector<int> idx(inner, 0);
+        uint8_t *out = (uint8_t *)dst;
+        for (size_t r = 0; r < rows; ++r)
+        {
+            size_t offset = 0;
+            for (int i = 0; i < inner; ++i)
+                offset += (size_t)idx[i] * _strides[i];
+            memcpy(out, (const uint8_t *)_data + offset * esize, row * esize);
+            out += row * esize;
+            for (int i = inner - 1; i >= 0; --i)
+            {
+                if (++idx[i] < _shape[i])
+                    break;
+                idx[i] = 0;
+            }
+        }
+    }
+
+    tensor::Tensor *TensorView::to_tensor() const
+    {
+        tensor::Tensor *t = new tensor::Tensor(_shape, _dtype);
+        copy_to(t->data());
+        return t;
+    }
+} // namespace maix::tensor
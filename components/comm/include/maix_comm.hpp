@@ -3,6 +3,8 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Remove temporary read buffer, read to protocol decoder directly.
+ * @update 2026.10.18: Support tcp, tcp_client, udp and unix methods, decode every peer separately.
  */
 
 
@@ -11,6 +13,8 @@
 #include <stdint.h>
 #include <tuple>
 #include <string>
+#include <memory>
+#include <unordered_map>
 #include "maix_type.hpp"
 #include "maix_err.hpp"
 #include "maix_protocol.hpp"
@@ -172,29 +176,50 @@ namespace maix
 
             /**
              * Set CommProtocol method
-             * @param method Can be "uart" or "none", "none" means not use CommProtocol.
+             * @param method Can be "uart", "tcp", "tcp_client", "udp", "unix" or "none", "none" means not use CommProtocol.
+             *               "tcp" is TCP server, "unix" is Unix domain socket server, they and "udp" can have several peers,
+             *               responses are sent to the peer of request, reports are sent to all peers.
              * @maixpy maix.comm.CommProtocol.set_method
              */
             static err::Err set_method(const std::string &method);
 
             /**
              * Get CommProtocol method
-             * @return method Can be "uart" or "none", "none" means not use CommProtocol.
+             * @return method Can be "uart", "tcp", "tcp_client", "udp", "unix" or "none", "none" means not use CommProtocol.
              * @maixpy maix.comm.CommProtocol.get_method
              */
             static std::string get_method();
 
+            /**
+             * Set address of socket methods
+             * @param addr "host:port" for "tcp", "tcp_client" and "udp", e.g. "0.0.0.0:5555", file path for "unix".
+             *             Empty string means default, ":5555" for servers and "/tmp/maix_comm.sock" for "unix", "tcp_client" must set it.
+             * @maixpy maix.comm.CommProtocol.set_addr
+             */
+            static err::Err set_addr(const std::string &addr);
+
+            /**
+             * Get address of socket methods
+             * @return address, empty string means default.
+             * @maixpy maix.comm.CommProtocol.get_addr
+             */
+            static std::string get_addr();
+
         private:
             void execute_cmd(protocol::MSG* msg);
+            protocol::Decoder &_peer_decoder(int peer);
+            protocol::MSG *_decode(int peer);
+            err::Err _send(const uint8_t *data, int len, bool reply);
 
         private:
             protocol::Protocol *_p;
             std::string _comm_method;
             CommBase *_comm;
             CommBase *_get_comm_obj(const std::string &method, err::Err &error);
-            uint8_t  *_tmp_buff;
-            int       _tmp_buff_len;
             bool      _valid;
+            int       _buff_size;
+            int       _reply_peer;      // peer of last message, responses are sent to it
+            std::unordered_map<int, std::unique_ptr<protocol::Decoder>> _decoders; // peers except 0, which uses _p's decoder
         };
     } // namespace comm
 } // namespace maix
@@ -0,0 +1,145 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add TCP, UDP and Unix socket transports, create this file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include "maix_type.hpp"
+#include "maix_err.hpp"
+#include "maix_comm_base.hpp"
+
+namespace maix::comm
+{
+    /**
+     * Socket transport type
+     * @maixcdk maix.comm.SocketType
+     */
+    enum SocketType
+    {
+        SOCKET_TCP_SERVER = 0,  // listen and accept several clients
+        SOCKET_TCP_CLIENT,      // connect to server, reconnect automatically
+        SOCKET_UDP,             // bind address, peers are senders of datagrams
+        SOCKET_UNIX,            // Unix domain stream socket server
+    };
+
+    /**
+     * Socket transport of CommBase.\n
+     * One I/O thread multiplexes listen socket and all peers with epoll,
+     * every peer has its own receive and send queue:
+     * - When receive queue of a peer is full, the peer is not read any more until data is consumed,
+     *   so the TCP window stops the sender instead of losing data. UDP datagrams are dropped in this case.
+     * - write() sends to all peers, a peer whose send queue is full skips this data.
+     * - write_peer() waits for space of the peer's send queue at most send_timeout ms.
+     * Data of one write is queued as a whole, so messages are never cut between peers.
+     * @maixcdk maix.comm.SocketComm
+     */
+    class SocketComm : public CommBase
+    {
+    public:
+        /**
+         * Construct a new SocketComm object, not open until open() called.
+         * @param type socket type, @see SocketType
+         * @param addr "host:port" for TCP and UDP, e.g. "0.0.0.0:5555", host can be omitted as ":5555",
+         *             file path for Unix socket, e.g. "/tmp/maix_comm.sock".
+         * @param queue_size max bytes of receive queue and send queue of every peer.
+         * @param send_timeout max wait time of write_peer when send queue is full, unit ms.
+         * @maixcdk maix.comm.SocketComm.SocketComm
+         */
+        SocketComm(comm::SocketType type, const std::string &addr, int queue_size = 256 * 1024, int send_timeout = 1000);
+        ~SocketComm();
+        SocketComm(const SocketComm &) = delete;
+        SocketComm &operator=(const SocketComm &) = delete;
+
+        /**
+         * Create socket and start I/O thread
+         * @maixcdk maix.comm.SocketComm.open
+         */
+        err::Err open() override;
+
+        /**
+         * Stop I/O thread and close all sockets
+         * @maixcdk maix.comm.SocketComm.close
+         */
+        err::Err close() override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.is_open
+         */
+        bool is_open() override;
+
+        /**
+         * Send data to all peers
+         * @return len if queued or sent, < 0 means error, -err::ERR_NOT_READY if no peer.
+         * @maixcdk maix.comm.SocketComm.write
+         */
+        int write(const uint8_t *buff, int len) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.write
+         */
+        int write(Bytes &data) override;
+
+        /**
+         * Receive data of any peers, data of different peers may be mixed, use wait_peer and read_peer to separate them.
+         * @maixcdk maix.comm.SocketComm.read
+         */
+        int read(uint8_t *buff, int buff_len, int recv_len = -1, int timeout = 0) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.read
+         */
+        Bytes *read(int len = -1, int timeout = 0) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.wait_peer
+         */
+        int wait_peer(int timeout) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.read_peer
+         */
+        int read_peer(int peer, uint8_t *buff, int buff_len, int timeout) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.write_peer
+         */
+        int write_peer(int peer, const uint8_t *buff, int len) override;
+
+        /**
+         * @maixcdk maix.comm.SocketComm.peer_alive
+         */
+        bool peer_alive(int peer) override;
+
+        /**
+         * Get ids of connected peers
+         * @maixcdk maix.comm.SocketComm.peers
+         */
+        std::vector<int> peers();
+
+        /**
+         * Get peer address, "ip:port" for TCP and UDP, empty string if peer not found.
+         * @maixcdk maix.comm.SocketComm.peer_addr
+         */
+        std::string peer_addr(int peer);
+
+        /**
+         * Number of bytes dropped because of full queues
+         * @maixcdk maix.comm.SocketComm.dropped
+         */
+        uint64_t dropped();
+
+    private:
+        comm::SocketType _type;
+        std::string _addr;
+        int _queue_size;
+        int _send_timeout;
+        std::shared_ptr<void> _data;        // loaded by std::atomic_load, close() may run in another thread
+    };
+}
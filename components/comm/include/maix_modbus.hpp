@@ -6,6 +6,8 @@
 #include <memory>
 #include <thread>
 #include <functional>
+#include <atomic>
+#include <mutex>
 
 #include "maix_err.hpp"
 #include "modbus/modbus.h"
@@ -110,7 +112,11 @@ namespace maix::comm::modbus {
     };
 
     /**
-     * Class for modbus Slave
+     * Class for modbus Slave.
+     * In TCP mode, several masters can connect at the same time, receive() waits requests of all of them with epoll,
+     * and reply() sends response to the master of the last received request.
+     * Register getters and setters can be called in other threads while requests are handled,
+     * registers are protected by a sequence lock, so handling requests never waits for readers.
      * @maixpy maix.comm.modbus.Slave
      */
     class Slave {
@@ -342,10 +348,79 @@ namespace maix::comm::modbus {
          */
         std::vector<uint16_t> holding_registers(const std::vector<uint16_t>& data = std::vector<uint16_t>{}, const uint32_t index = 0);
 
+        /**
+         * @brief Read coils to buffer, no memory allocated.
+         *
+         * @param data Buffer to store coils, at least count elements.
+         * @param index The starting index(not address) of coils.
+         * @param count Number of coils to read.
+         *
+         * @return Read count, < 0 means error, value is -err::Err.
+         *
+         * @maixcdk maix.comm.modbus.Slave.read_coils
+         */
+        int read_coils(uint8_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Write coils from buffer.
+         *
+         * @param data Coils data, count elements.
+         * @param index The starting index(not address) of coils.
+         * @param count Number of coils to write.
+         *
+         * @return Written count, < 0 means error, value is -err::Err.
+         *
+         * @maixcdk maix.comm.modbus.Slave.write_coils
+         */
+        int write_coils(const uint8_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Read discrete input to buffer, no memory allocated.
+         * @see read_coils
+         * @maixcdk maix.comm.modbus.Slave.read_discrete_input
+         */
+        int read_discrete_input(uint8_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Write discrete input from buffer.
+         * @see write_coils
+         * @maixcdk maix.comm.modbus.Slave.write_discrete_input
+         */
+        int write_discrete_input(const uint8_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Read input registers to buffer, no memory allocated.
+         * @see read_coils
+         * @maixcdk maix.comm.modbus.Slave.read_input_registers
+         */
+        int read_input_registers(uint16_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Write input registers from buffer.
+         * @see write_coils
+         * @maixcdk maix.comm.modbus.Slave.write_input_registers
+         */
+        int write_input_registers(const uint16_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Read holding registers to buffer, no memory allocated.
+         * @see read_coils
+         * @maixcdk maix.comm.modbus.Slave.read_holding_registers
+         */
+        int read_holding_registers(uint16_t *data, uint32_t index, uint32_t count);
+
+        /**
+         * @brief Write holding registers from buffer.
+         * @see write_coils
+         * @maixcdk maix.comm.modbus.Slave.write_holding_registers
+         */
+        int write_holding_registers(const uint16_t *data, uint32_t index, uint32_t count);
+
         /**
          * @brief Returns the raw pointer to the modbus_mapping_t, allowing direct manipulation of registers to avoid copy overhead.
          *
          * @note: The returned pointer must not be deleted or freed.
+         *        Access by this pointer is not protected, use it only in the thread handling requests.
          *
          * @return ::modbus_mapping_t* type
          */
@@ -369,22 +444,33 @@ namespace maix::comm::modbus {
         void mapping_init();
         ::maix::err::Err __receive__();
         ::maix::err::Err set_timeout(uint32_t sec, uint32_t usec);
+        ::maix::err::Err tcp_receive(const int timeout_ms);
+        void tcp_accept();
+        void tcp_close_client(int fd);
+        int map_read(int table, void *data, uint32_t index, uint32_t count);
+        int map_write(int table, const void *data, uint32_t index, uint32_t count);
 
     private:
         std::unique_ptr<modbus_t, decltype(&modbus_free)>
             ctx_{nullptr, &modbus_free};
         std::unique_ptr<modbus_mapping_t, decltype(&modbus_mapping_free)>
             mb_mapping_{nullptr, &modbus_mapping_free};
+        std::unique_ptr<modbus_mapping_t, decltype(&modbus_mapping_free)>
+            mb_snapshot_{nullptr, &modbus_mapping_free};    // registers of request being handled
+        std::atomic<uint32_t> mapping_seq_{0};
+        std::mutex mapping_write_lock_;
         Registers registers_info_;
         bool debug_;
         int rc_{0};
         int header_len_;
         int socket_tcp_{-1};
-        uint8_t query_[128]{0};
+        uint8_t query_[MODBUS_MAX_ADU_LENGTH]{0};
         uint32_t curr_timeout_sec_{165};
         uint32_t curr_timeout_usec_{528};
-        std::unique_ptr<std::thread> tcp_listener_{nullptr};
-        bool tcp_listener_need_exit_{false};
+        int epoll_fd_{-1};
+        std::vector<int> tcp_clients_;
+        std::vector<int> tcp_ready_;
+        int tcp_client_{-1};
     };
 
     /**
@@ -3,6 +3,8 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Read data to protocol decoder's buffer directly.
+ * @update 2026.10.18: Add socket methods, decode every peer separately, reply to the peer of request.
  */
 
 #include <string.h>
@@ -11,6 +13,7 @@
 #include "maix_basic.hpp"
 #include "maix_uart.hpp"
 #include "maix_comm.hpp"
+#include "maix_comm_socket.hpp"
 
 using namespace maix::peripheral;
 
@@ -90,6 +93,34 @@ namespace maix::comm
             log::info("[Maix Comm Protocol] listening on uart port: %s", ports[ports.size() - 1].c_str());
             return obj;
         }
+        else if (method == "tcp" || method == "tcp_client" || method == "udp" || method == "unix")
+        {
+            std::string addr = CommProtocol::get_addr();
+            SocketType type = method == "tcp" ? SOCKET_TCP_SERVER : method == "tcp_client" ? SOCKET_TCP_CLIENT :
+                              method == "udp" ? SOCKET_UDP : SOCKET_UNIX;
+            if (addr.empty())
+            {
+                if (type == SOCKET_TCP_CLIENT)
+                {
+                    error = err::Err::ERR_ARGS;
+                    log::error("[Maix Comm Protocol] tcp_client need server address, set by set_addr");
+                    return nullptr;
+                }
+                addr = type == SOCKET_UNIX ? "/tmp/maix_comm.sock" : ":5555";
+            }
+            try
+            {
+                SocketComm *obj = new SocketComm(type, addr);
+                log::info("[Maix Comm Protocol] %s on %s", method.c_str(), addr.c_str());
+                return obj;
+            }
+            catch (const std::exception &e)
+            {
+                error = err::Err::ERR_ARGS;
+                log::error("[Maix Comm Protocol] create %s obj failed: %s", method.c_str(), e.what());
+                return nullptr;
+            }
+        }
         else if (method == "none")
         {
             return nullptr;
@@ -101,13 +132,9 @@ namespace maix::comm
 
     CommProtocol::CommProtocol(int buff_size, uint32_t header, bool method_none_raise)
     {
-        _tmp_buff_len = 128;
-        _tmp_buff = new uint8_t[_tmp_buff_len];
-        if (!_tmp_buff)
-        {
-            throw err::Exception(err::ERR_NO_MEM);
-        }
         _p = new protocol::Protocol(buff_size, header);
+        _buff_size = buff_size;
+        _reply_peer = 0;
         _comm_method = CommProtocol::get_method();
         _valid = false;
         err::Err e;
@@ -143,16 +170,13 @@ namespace maix::comm
             delete _comm;
             _comm = nullptr;
         }
-        if (_tmp_buff)
-        {
-            delete _tmp_buff;
-            _tmp_buff = nullptr;
-        }
+        _decoders.clear();
+        delete _p;
     }
 
     err::Err CommProtocol::set_method(const std::string &method)
     {
-        if(method != "uart" && method != "none")
+        if(method != "uart" && method != "none" && method != "tcp" && method != "tcp_client" && method != "udp" && method != "unix")
             return err::ERR_ARGS;
         return app::set_sys_config_kv("comm", "method", method);
     }
@@ -162,6 +186,16 @@ namespace maix::comm
         return app::get_sys_config_kv("comm", "method", "uart");
     }
 
+    err::Err CommProtocol::set_addr(const std::string &addr)
+    {
+        return app::set_sys_config_kv("comm", "addr", addr);
+    }
+
+    std::string CommProtocol::get_addr()
+    {
+        return app::get_sys_config_kv("comm", "addr", "");
+    }
+
     static std::vector<std::string> find_string(char *data, uint32_t data_len, uint32_t try_find_cnt = 0)
     {
         if (data_len <= 1)
@@ -465,31 +499,89 @@ namespace maix::comm
         // log::info("[%s:%d] Finish...", __PRETTY_FUNCTION__, __LINE__);
     }
 
+    protocol::Decoder &CommProtocol::_peer_decoder(int peer)
+    {
+        if (peer == 0)
+            return _p->decoder();
+        auto it = _decoders.find(peer);
+        if (it != _decoders.end())
+            return *it->second;
+        // new peer, remove decoders of disconnected peers
+        for (auto i = _decoders.begin(); i != _decoders.end();)
+        {
+            if (!_comm->peer_alive(i->first))
+                i = _decoders.erase(i);
+            else
+                ++i;
+        }
+        protocol::Decoder *decoder = new protocol::Decoder(_buff_size);
+        _decoders[peer].reset(decoder);
+        return *decoder;
+    }
+
+    protocol::MSG *CommProtocol::_decode(int peer)
+    {
+        protocol::MsgView view;
+        if (!_peer_decoder(peer).next(view))
+            return nullptr;
+        protocol::MSG *msg = new protocol::MSG();
+        msg->version = view.version;
+        msg->is_resp = view.is_resp;
+        msg->is_req = view.is_req;
+        msg->is_report = view.is_report;
+        msg->resp_ok = view.resp_ok;
+        msg->cmd = view.cmd;
+        msg->set_body((uint8_t *)view.body, view.body_len);
+        _reply_peer = peer;
+        return msg;
+    }
+
     protocol::MSG *CommProtocol::get_msg(int timeout)
     {
         protocol::MSG *msg = nullptr;
         if(!_valid)
             return msg;
+        // messages left in buffers by last call
+        msg = _decode(0);
+        for (auto it = _decoders.begin(); !msg && it != _decoders.end(); ++it)
+            msg = _decode(it->first);
         uint64_t t = time::ticks_ms();
-        while (1)
-        {
-            int rx_len = 0;
-            while (1)
+        while (!msg)
+        {
+            int remain = timeout;
+            if (timeout > 0)
+                remain = std::max(0, timeout - (int)(time::ticks_ms() - t));
+            // single peer transports return 0 immediately, and read waits
+            int peer = _comm->wait_peer(remain);
+            if (peer >= 0)
             {
-                rx_len = _comm->read(_tmp_buff, _tmp_buff_len, -1, timeout);
-                if (rx_len == 0)
+                int rx_len = 0;
+                int read_timeout = remain; // only first read waits, then read what already received
+                protocol::Decoder &decoder = _peer_decoder(peer);
+                while (!msg)
                 {
-                    break;
-                }
-                else if (rx_len < 0)
-                {
-                    log::error("read error: %d, %s\n", -rx_len, err::to_str((err::Err)-rx_len).c_str());
-                    time::sleep_ms(10);
-                    break;
+                    int size = 0;
+                    uint8_t *buff = decoder.prepare(&size);
+                    if (size == 0) // buffer full, decode first
+                        break;
+                    rx_len = _comm->read_peer(peer, buff, size, read_timeout);
+                    read_timeout = 0;
+                    if (rx_len == 0)
+                    {
+                        break;
+                    }
+                    else if (rx_len < 0)
+                    {
+                        log::error("read error: %d, %s\n", -rx_len, err::to_str((err::Err)-rx_len).c_str());
+                        time::sleep_ms(10);
+                        break;
+                    }
+                    decoder.commit(rx_len);
+                    msg = _decode(peer);
                 }
-                _p->push_data(_tmp_buff, rx_len);
+                if (!msg)
+                    msg = _decode(peer);
             }
-            msg = _p->decode(nullptr, 0);
             if (msg || timeout == 0)
                 break;
             if (timeout > 0 && (time::ticks_ms() - t > (uint64_t)timeout))
@@ -500,21 +592,27 @@ namespace maix::comm
         return msg;
     }
 
-    err::Err CommProtocol::resp_ok(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
+    err::Err CommProtocol::_send(const uint8_t *data, int len, bool reply)
     {
-        if(!_valid)
-            return err::ERR_NOT_PERMIT;
-        int len = _p->encode_resp_ok(buff, buff_len, cmd, body, body_len);
+        // responses go to the peer of request, reports go to all peers
+        len = reply ? _comm->write_peer(_reply_peer, data, len) : _comm->write(data, len);
         if (len < 0)
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
+        return err::ERR_NONE;
+    }
+
+    err::Err CommProtocol::resp_ok(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
+    {
+        if(!_valid)
+            return err::ERR_NOT_PERMIT;
+        int len = _p->encode_resp_ok(buff, buff_len, cmd, body, body_len);
         if (len < 0)
         {
             return (err::Err)-len;
         }
-        return err::ERR_NONE;
+        return _send(buff, len, true);
     }
 
     err::Err CommProtocol::resp_ok(uint8_t cmd, uint8_t *body, int body_len)
@@ -526,13 +624,9 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        err::Err e = _send(buff->data, buff->size(), true);
         delete buff;
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return e;
     }
 
     err::Err CommProtocol::resp_ok(uint8_t cmd, Bytes *body)
@@ -544,13 +638,9 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        err::Err e = _send(buff->data, buff->size(), true);
         delete buff;
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return e;
     }
 
     err::Err CommProtocol::report(uint8_t *buff, int buff_len, uint8_t cmd, uint8_t *body, int body_len)
@@ -562,12 +652,7 @@ namespace maix::comm
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return _send(buff, len, false);
     }
 
     err::Err CommProtocol::report(uint8_t cmd, uint8_t *body, int body_len)
@@ -579,13 +664,9 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        err::Err e = _send(buff->data, buff->size(), false);
         delete buff;
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return e;
     }
 
     err::Err CommProtocol::report(uint8_t cmd, Bytes *body)
@@ -597,13 +678,9 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        err::Err e = _send(buff->data, buff->size(), false);
         delete buff;
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return e;
     }
 
     err::Err CommProtocol::resp_err(uint8_t *buff, int buff_len, uint8_t cmd, err::Err code, const std::string &msg)
@@ -615,12 +692,7 @@ namespace maix::comm
         {
             return (err::Err)-len;
         }
-        len = _comm->write(buff, len);
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return _send(buff, len, true);
     }
 
     err::Err CommProtocol::resp_err(uint8_t cmd, err::Err code, const std::string &msg)
@@ -632,13 +704,9 @@ namespace maix::comm
         {
             return err::ERR_RUNTIME;
         }
-        int len = _comm->write(buff->data, buff->size());
+        err::Err e = _send(buff->data, buff->size(), true);
         delete buff;
-        if (len < 0)
-        {
-            return (err::Err)-len;
-        }
-        return err::ERR_NONE;
+        return e;
     }
 
     void _comm_loop()
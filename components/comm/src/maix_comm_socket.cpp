@@ -0,0 +1,812 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add TCP, UDP and Unix socket transports, create this file.
+ */
+
+#include "maix_comm_socket.hpp"
+#include "maix_basic.hpp"
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace maix::comm
+{
+    #define SOCKET_EVENTS_MAX       32
+    #define SOCKET_READ_SIZE        4096
+    #define SOCKET_UDP_EXPIRE_MS    60000
+    #define SOCKET_RECONNECT_MS     1000
+
+    struct _Peer
+    {
+        int id;
+        int fd;                             // shared socket for UDP, -1 after closed
+        struct sockaddr_storage addr;
+        socklen_t addr_len;
+        std::string rx;
+        size_t rx_pos;
+        std::string tx;
+        size_t tx_pos;
+        bool rx_paused;                     // not read because rx is full
+        bool connecting;                    // TCP client connect in progress
+        bool closed;                        // kept until rx consumed
+        uint64_t active_ms;
+
+        size_t rx_len() const { return rx.size() - rx_pos; }
+        size_t tx_len() const { return tx.size() - tx_pos; }
+    };
+
+    struct _Socket
+    {
+        SocketType type;
+        std::string addr;
+        size_t queue_size;
+        int send_timeout;
+        int fd = -1;                        // listen socket, UDP socket, -1 for TCP client
+        int epoll_fd = -1;
+        int event_fd = -1;
+        std::thread *thread = nullptr;
+        std::atomic<bool> exit{false};
+        std::mutex lock;
+        std::condition_variable rx_cond;
+        std::condition_variable tx_cond;
+        std::map<int, std::unique_ptr<_Peer>> peers;
+        std::unordered_map<int, _Peer *> fd_peers;
+        int next_id = 1;
+        int last_read = 0;                  // round robin start of wait_peer
+        uint64_t dropped = 0;
+        uint64_t connect_ms = 0;            // next connect time of TCP client
+        uint64_t expire_ms = 0;             // next check time of UDP peers
+
+        // event_fd may be written by readers still holding this object after close
+        ~_Socket()
+        {
+            if (fd >= 0)
+                ::close(fd);
+            if (epoll_fd >= 0)
+                ::close(epoll_fd);
+            if (event_fd >= 0)
+                ::close(event_fd);
+        }
+    };
+
+    // keep socket alive until caller returns, even close() is called by other thread
+    static std::shared_ptr<_Socket> _get_socket(std::shared_ptr<void> &data)
+    {
+        return std::static_pointer_cast<_Socket>(std::atomic_load(&data));
+    }
+
+    static int _set_nonblock(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    static bool _parse_addr(const std::string &addr, struct sockaddr_in *out)
+    {
+        size_t pos = addr.rfind(':');
+        if (pos == std::string::npos)
+            return false;
+        std::string host = addr.substr(0, pos);
+        int port = atoi(addr.c_str() + pos + 1);
+        if (port <= 0 || port > 65535)
+            return false;
+        if (host.empty())
+            host = "0.0.0.0";
+        memset(out, 0, sizeof(*out));
+        out->sin_family = AF_INET;
+        out->sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &out->sin_addr) == 1)
+            return true;
+        struct addrinfo hints, *res = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || !res)
+            return false;
+        out->sin_addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+        freeaddrinfo(res);
+        return true;
+    }
+
+    static std::string _addr_str(const struct sockaddr_storage &addr)
+    {
+        if (addr.ss_family != AF_INET)
+            return "";
+        const struct sockaddr_in *in = (const struct sockaddr_in *)&addr;
+        char ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(ntohs(in->sin_port));
+    }
+
+    static _Peer *_add_peer(_Socket *s, int fd)
+    {
+        std::unique_ptr<_Peer> p(new _Peer());
+        p->id = s->next_id++;
+        p->fd = fd;
+        p->addr_len = 0;
+        p->rx_pos = 0;
+        p->tx_pos = 0;
+        p->rx_paused = false;
+        p->connecting = false;
+        p->closed = false;
+        p->active_ms = time::ticks_ms();
+        _Peer *peer = p.get();
+        s->peers[peer->id] = std::move(p);
+        if (s->type != SOCKET_UDP)
+            s->fd_peers[fd] = peer;
+        return peer;
+    }
+
+    static _Peer *_find_peer(_Socket *s, int id)
+    {
+        auto it = s->peers.find(id);
+        return it == s->peers.end() ? nullptr : it->second.get();
+    }
+
+    static void _erase_peer(_Socket *s, _Peer *peer)
+    {
+        s->peers.erase(peer->id);
+    }
+
+    // close connection, received data can still be read
+    static void _close_peer(_Socket *s, _Peer *peer)
+    {
+        if (!peer->closed && s->type != SOCKET_UDP)
+        {
+            epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, peer->fd, NULL);
+            s->fd_peers.erase(peer->fd);
+            ::close(peer->fd);
+        }
+        peer->fd = -1;
+        peer->closed = true;
+        peer->tx.clear();
+        peer->tx_pos = 0;
+        s->tx_cond.notify_all();
+        if (peer->rx_len() == 0)
+            _erase_peer(s, peer);
+        if (s->type == SOCKET_TCP_CLIENT)
+            s->connect_ms = time::ticks_ms() + SOCKET_RECONNECT_MS;
+    }
+
+    // read until EAGAIN or rx full, return false if connection closed
+    static bool _on_read(_Socket *s, _Peer *peer, bool *got)
+    {
+        peer->rx_paused = false;
+        while (1)
+        {
+            size_t used = peer->rx_len();
+            if (used >= s->queue_size)
+            {
+                peer->rx_paused = true;
+                return true;
+            }
+            if (peer->rx_pos > 0 && peer->rx_pos >= peer->rx.size() / 2)
+            {
+                peer->rx.erase(0, peer->rx_pos);
+                peer->rx_pos = 0;
+            }
+            size_t room = std::min(s->queue_size - used, (size_t)SOCKET_READ_SIZE);
+            size_t old = peer->rx.size();
+            peer->rx.resize(old + room);
+            ssize_t n = recv(peer->fd, &peer->rx[old], room, 0);
+            peer->rx.resize(old + (n > 0 ? n : 0));
+            if (n > 0)
+            {
+                *got = true;
+                peer->active_ms = time::ticks_ms();
+                continue;
+            }
+            if (n == 0)
+                return false;
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+
+    // send queued data until EAGAIN, return false if connection broken
+    static bool _flush(_Socket *s, _Peer *peer)
+    {
+        while (peer->tx_len() > 0)
+        {
+            ssize_t n = send(peer->fd, peer->tx.data() + peer->tx_pos, peer->tx_len(), MSG_NOSIGNAL);
+            if (n > 0)
+            {
+                peer->tx_pos += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            return false;
+        }
+        if (peer->tx_len() == 0)
+        {
+            peer->tx.clear();
+            peer->tx_pos = 0;
+        }
+        else if (peer->tx_pos >= peer->tx.size() / 2)
+        {
+            peer->tx.erase(0, peer->tx_pos);
+            peer->tx_pos = 0;
+        }
+        s->tx_cond.notify_all();
+        return true;
+    }
+
+    // queue data of one write as a whole, send directly if nothing queued
+    static int _queue(_Socket *s, _Peer *peer, const uint8_t *buff, int len)
+    {
+        if (s->type == SOCKET_UDP)
+        {
+            ssize_t n = sendto(peer->fd, buff, len, MSG_NOSIGNAL, (struct sockaddr *)&peer->addr, peer->addr_len);
+            if (n < 0)
+            {
+                s->dropped += len;
+                return errno == EAGAIN || errno == EWOULDBLOCK ? -err::ERR_BUSY : -err::ERR_IO;
+            }
+            return len;
+        }
+        int sent = 0;
+        if (peer->tx_len() == 0 && !peer->connecting)
+        {
+            while (sent < len)
+            {
+                ssize_t n = send(peer->fd, buff + sent, len - sent, MSG_NOSIGNAL);
+                if (n > 0)
+                    sent += n;
+                else if (n < 0 && errno == EINTR)
+                    continue;
+                else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    break;
+                else
+                {
+                    _close_peer(s, peer);
+                    return -err::ERR_IO;
+                }
+            }
+        }
+        // the rest is sent by I/O thread when socket writable
+        if (sent < len)
+            peer->tx.append((const char *)buff + sent, len - sent);
+        return len;
+    }
+
+    static void _accept(_Socket *s)
+    {
+        while (1)
+        {
+            int fd = accept(s->fd, NULL, NULL);
+            if (fd < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    log::warn("[comm socket] accept failed: %s", strerror(errno));
+                return;
+            }
+            _set_nonblock(fd);
+            if (s->type == SOCKET_TCP_SERVER)
+            {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            _Peer *peer = _add_peer(s, fd);
+            peer->addr_len = sizeof(peer->addr);
+            getpeername(fd, (struct sockaddr *)&peer->addr, &peer->addr_len);
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = fd;
+            epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            log::info("[comm socket] peer %d connected %s", peer->id, _addr_str(peer->addr).c_str());
+        }
+    }
+
+    static void _connect(_Socket *s)
+    {
+        s->connect_ms = time::ticks_ms() + SOCKET_RECONNECT_MS;
+        struct sockaddr_in addr;
+        if (!_parse_addr(s->addr, &addr))
+            return;
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int ret = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+        if (ret < 0 && errno != EINPROGRESS)
+        {
+            ::close(fd);
+            return;
+        }
+        _Peer *peer = _add_peer(s, fd);
+        memcpy(&peer->addr, &addr, sizeof(addr));
+        peer->addr_len = sizeof(addr);
+        peer->connecting = ret < 0;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    static void _recv_udp(_Socket *s, bool *got)
+    {
+        uint8_t buff[65536];
+        while (1)
+        {
+            struct sockaddr_storage addr;
+            socklen_t addr_len = sizeof(addr);
+            ssize_t n = recvfrom(s->fd, buff, sizeof(buff), 0, (struct sockaddr *)&addr, &addr_len);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            _Peer *peer = nullptr;
+            for (auto &it : s->peers)
+            {
+                _Peer *p = it.second.get();
+                if (!p->closed && p->addr_len == addr_len && memcmp(&p->addr, &addr, addr_len) == 0)
+                {
+                    peer = p;
+                    break;
+                }
+            }
+            if (!peer)
+            {
+                peer = _add_peer(s, s->fd);
+                memcpy(&peer->addr, &addr, addr_len);
+                peer->addr_len = addr_len;
+            }
+            peer->active_ms = time::ticks_ms();
+            // datagram can not wait, drop it if queue full
+            if (peer->rx_len() + n > s->queue_size)
+            {
+                s->dropped += n;
+                continue;
+            }
+            if (peer->rx_pos > 0 && peer->rx_pos >= peer->rx.size() / 2)
+            {
+                peer->rx.erase(0, peer->rx_pos);
+                peer->rx_pos = 0;
+            }
+            peer->rx.append((const char *)buff, n);
+            *got = true;
+        }
+    }
+
+    static void _loop(_Socket *s)
+    {
+        struct epoll_event events[SOCKET_EVENTS_MAX];
+        while (!s->exit)
+        {
+            int timeout = 1000;
+            if (s->type == SOCKET_TCP_CLIENT)
+            {
+                std::lock_guard<std::mutex> guard(s->lock);
+                if (s->fd_peers.empty())
+                    timeout = (int)std::min<int64_t>(std::max<int64_t>((int64_t)s->connect_ms - (int64_t)time::ticks_ms(), 0), 1000);
+            }
+            int n = epoll_wait(s->epoll_fd, events, SOCKET_EVENTS_MAX, timeout);
+            if (n < 0 && errno != EINTR)
+            {
+                log::error("[comm socket] epoll_wait failed: %s", strerror(errno));
+                break;
+            }
+            std::lock_guard<std::mutex> guard(s->lock);
+            bool got = false;
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                uint32_t ev = events[i].events;
+                if (fd == s->event_fd)
+                {
+                    uint64_t v;
+                    (void)!::read(s->event_fd, &v, sizeof(v));
+                    // consumer made room, read paused peers again
+                    for (auto it = s->peers.begin(); it != s->peers.end();)
+                    {
+                        _Peer *p = (it++)->second.get();
+                        if (p->rx_paused && !p->closed && !_on_read(s, p, &got))
+                            _close_peer(s, p);
+                    }
+                    continue;
+                }
+                if (fd == s->fd)
+                {
+                    if (s->type == SOCKET_UDP)
+                        _recv_udp(s, &got);
+                    else
+                        _accept(s);
+                    continue;
+                }
+                auto it = s->fd_peers.find(fd);
+                if (it == s->fd_peers.end())
+                    continue;
+                _Peer *peer = it->second;
+                if (peer->connecting)
+                {
+                    int e = 0;
+                    socklen_t len = sizeof(e);
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &e, &len);
+                    if (e != 0 || (ev & (EPOLLERR | EPOLLHUP)))
+                    {
+                        _close_peer(s, peer);
+                        continue;
+                    }
+                    if (!(ev & EPOLLOUT))
+                        continue;
+                    peer->connecting = false;
+                    log::info("[comm socket] connected to %s", s->addr.c_str());
+                }
+                bool ok = true;
+                if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                    ok = _on_read(s, peer, &got);
+                if (ok && (ev & EPOLLOUT))
+                    ok = _flush(s, peer);
+                if (!ok || (ev & (EPOLLHUP | EPOLLERR)))
+                {
+                    log::info("[comm socket] peer %d disconnected", peer->id);
+                    _close_peer(s, peer);
+                }
+            }
+            uint64_t now = time::ticks_ms();
+            if (s->type == SOCKET_TCP_CLIENT && s->fd_peers.empty() && now >= s->connect_ms)
+                _connect(s);
+            if (s->type == SOCKET_UDP && now >= s->expire_ms)
+            {
+                s->expire_ms = now + 1000;
+                for (auto it = s->peers.begin(); it != s->peers.end();)
+                {
+                    _Peer *p = (it++)->second.get();
+                    if (!p->closed && now - p->active_ms > SOCKET_UDP_EXPIRE_MS)
+                        _close_peer(s, p);
+                }
+            }
+            if (got)
+                s->rx_cond.notify_all();
+        }
+    }
+
+    SocketComm::SocketComm(comm::SocketType type, const std::string &addr, int queue_size, int send_timeout)
+    {
+        _type = type;
+        _addr = addr;
+        _queue_size = queue_size;
+        _send_timeout = send_timeout;
+        if (queue_size <= 0)
+            throw err::Exception(err::ERR_ARGS, "queue_size must > 0");
+        struct sockaddr_in in;
+        if (type != SOCKET_UNIX && !_parse_addr(addr, &in))
+            throw err::Exception(err::ERR_ARGS, "invalid address " + addr);
+    }
+
+    SocketComm::~SocketComm()
+    {
+        close();
+    }
+
+    err::Err SocketComm::open()
+    {
+        if (std::atomic_load(&_data))
+            return err::ERR_NONE;
+        std::shared_ptr<_Socket> s = std::make_shared<_Socket>();
+        s->type = _type;
+        s->addr = _addr;
+        s->queue_size = _queue_size;
+        s->send_timeout = _send_timeout;
+        s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        s->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        err::Err e = err::ERR_NONE;
+        if (s->epoll_fd < 0 || s->event_fd < 0)
+            e = err::ERR_RUNTIME;
+        if (e == err::ERR_NONE && _type != SOCKET_TCP_CLIENT)
+        {
+            int fd = -1;
+            int ret = -1;
+            if (_type == SOCKET_UNIX)
+            {
+                struct sockaddr_un addr;
+                memset(&addr, 0, sizeof(addr));
+                addr.sun_family = AF_UNIX;
+                strncpy(addr.sun_path, _addr.c_str(), sizeof(addr.sun_path) - 1);
+                unlink(addr.sun_path);
+                fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd >= 0)
+                    ret = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+            }
+            else
+            {
+                struct sockaddr_in addr;
+                _parse_addr(_addr, &addr);
+                fd = socket(AF_INET, (_type == SOCKET_UDP ? SOCK_DGRAM : SOCK_STREAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd >= 0)
+                {
+                    int one = 1;
+                    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                    ret = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+                }
+            }
+            if (ret == 0 && _type != SOCKET_UDP)
+                ret = listen(fd, 16);
+            if (ret != 0)
+            {
+                log::error("[comm socket] bind %s failed: %s", _addr.c_str(), strerror(errno));
+                if (fd >= 0)
+                    ::close(fd);
+                e = err::ERR_IO;
+            }
+            else
+            {
+                s->fd = fd;
+                struct epoll_event ev;
+                ev.events = EPOLLIN | EPOLLET;
+                ev.data.fd = fd;
+                epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            }
+        }
+        if (e != err::ERR_NONE)
+            return e;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = s->event_fd;
+        epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->event_fd, &ev);
+        s->thread = new std::thread(_loop, s.get());
+        std::atomic_store(&_data, std::shared_ptr<void>(s));
+        return err::ERR_NONE;
+    }
+
+    err::Err SocketComm::close()
+    {
+        std::shared_ptr<_Socket> s = std::static_pointer_cast<_Socket>(std::atomic_exchange(&_data, std::shared_ptr<void>()));
+        if (!s)
+            return err::ERR_NONE;
+        s->exit = true;
+        uint64_t v = 1;
+        (void)!::write(s->event_fd, &v, sizeof(v));
+        s->thread->join();
+        delete s->thread;
+        {
+            std::lock_guard<std::mutex> guard(s->lock);
+            for (auto &it : s->fd_peers)
+                ::close(it.first);
+            s->fd_peers.clear();
+            s->peers.clear();
+            // release address now, other fds are closed when last caller returns
+            if (s->fd >= 0)
+                ::close(s->fd);
+            s->fd = -1;
+        }
+        s->rx_cond.notify_all();
+        s->tx_cond.notify_all();
+        if (_type == SOCKET_UNIX)
+            unlink(_addr.c_str());
+        return err::ERR_NONE;
+    }
+
+    bool SocketComm::is_open()
+    {
+        return std::atomic_load(&_data) != nullptr;
+    }
+
+    int SocketComm::write(const uint8_t *buff, int len)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return -err::ERR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(s->lock);
+        int alive = 0;
+        for (auto it = s->peers.begin(); it != s->peers.end();)
+        {
+            _Peer *peer = (it++)->second.get();
+            if (peer->closed)
+                continue;
+            ++alive;
+            // slow peer skips this data, others are not blocked
+            if (peer->tx_len() > 0 && peer->tx_len() + len > s->queue_size)
+            {
+                s->dropped += len;
+                continue;
+            }
+            _queue(s.get(), peer, buff, len);
+        }
+        return alive > 0 ? len : -err::ERR_NOT_READY;
+    }
+
+    int SocketComm::write(Bytes &data)
+    {
+        return write(data.data, data.data_len);
+    }
+
+    int SocketComm::write_peer(int peer, const uint8_t *buff, int len)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return -err::ERR_NOT_OPEN;
+        std::unique_lock<std::mutex> lock(s->lock);
+        auto ready = [&] {
+            _Peer *p = _find_peer(s.get(), peer);
+            return !p || p->closed || p->tx_len() == 0 || p->tx_len() + len <= s->queue_size;
+        };
+        if (!ready() && !s->tx_cond.wait_for(lock, std::chrono::milliseconds(s->send_timeout), ready))
+        {
+            s->dropped += len;
+            return -err::ERR_BUSY;
+        }
+        _Peer *p = _find_peer(s.get(), peer);
+        if (!p || p->closed)
+            return -err::ERR_NOT_FOUND;
+        return _queue(s.get(), p, buff, len);
+    }
+
+    int SocketComm::wait_peer(int timeout)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return -1;
+        int found = -1;
+        auto has_data = [&] {
+            if (s->peers.empty())
+                return false;
+            // round robin, start after the peer read last time so one busy peer can't starve others
+            auto it = s->peers.upper_bound(s->last_read);
+            for (size_t i = 0; i < s->peers.size(); ++i, ++it)
+            {
+                if (it == s->peers.end())
+                    it = s->peers.begin();
+                if (it->second->rx_len() > 0)
+                {
+                    found = it->first;
+                    return true;
+                }
+            }
+            return false;
+        };
+        std::unique_lock<std::mutex> lock(s->lock);
+        if (timeout < 0)
+            s->rx_cond.wait(lock, [&] { return has_data() || s->exit; });
+        else
+            s->rx_cond.wait_for(lock, std::chrono::milliseconds(timeout), [&] { return has_data() || s->exit; });
+        return found;
+    }
+
+    int SocketComm::read_peer(int peer, uint8_t *buff, int buff_len, int timeout)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return -err::ERR_NOT_OPEN;
+        std::unique_lock<std::mutex> lock(s->lock);
+        auto has_data = [&] {
+            _Peer *p = _find_peer(s.get(), peer);
+            return !p || p->rx_len() > 0 || s->exit;
+        };
+        if (timeout < 0)
+            s->rx_cond.wait(lock, has_data);
+        else if (timeout > 0)
+            s->rx_cond.wait_for(lock, std::chrono::milliseconds(timeout), has_data);
+        _Peer *p = _find_peer(s.get(), peer);
+        if (!p)
+            return 0;
+        int n = (int)std::min((size_t)buff_len, p->rx_len());
+        memcpy(buff, p->rx.data() + p->rx_pos, n);
+        p->rx_pos += n;
+        if (p->rx_len() == 0)
+        {
+            p->rx.clear();
+            p->rx_pos = 0;
+        }
+        s->last_read = peer;
+        if (p->closed && p->rx_len() == 0)
+            _erase_peer(s.get(), p);
+        else if (p->rx_paused && p->rx_len() <= s->queue_size / 2)
+        {
+            // I/O thread reads paused peers again
+            uint64_t v = 1;
+            (void)!::write(s->event_fd, &v, sizeof(v));
+        }
+        return n;
+    }
+
+    int SocketComm::read(uint8_t *buff, int buff_len, int recv_len, int timeout)
+    {
+        int want = recv_len > 0 ? std::min(recv_len, buff_len) : buff_len;
+        int total = 0;
+        uint64_t t = time::ticks_ms();
+        while (total < want)
+        {
+            int remain = -1;
+            if (timeout >= 0)
+                remain = std::max(0, timeout - (int)(time::ticks_ms() - t));
+            // recv_len -1 only waits for the first data
+            int peer = wait_peer(recv_len <= 0 && total > 0 ? 0 : remain);
+            if (peer < 0)
+                break;
+            int n = read_peer(peer, buff + total, want - total, 0);
+            if (n < 0)
+                return total > 0 ? total : n;
+            total += n;
+        }
+        return total;
+    }
+
+    Bytes *SocketComm::read(int len, int timeout)
+    {
+        int buff_len = len > 0 ? len : 4096;
+        Bytes *data = new Bytes(NULL, buff_len);
+        int n = read(data->data, buff_len, len, timeout);
+        if (n < 0)
+        {
+            delete data;
+            throw err::Exception(err::Err(-n), "read failed");
+        }
+        data->data_len = n;
+        return data;
+    }
+
+    bool SocketComm::peer_alive(int peer)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return false;
+        std::lock_guard<std::mutex> guard(s->lock);
+        _Peer *p = _find_peer(s.get(), peer);
+        return p && !p->closed;
+    }
+
+    std::vector<int> SocketComm::peers()
+    {
+        std::vector<int> ids;
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return ids;
+        std::lock_guard<std::mutex> guard(s->lock);
+        for (auto &it : s->peers)
+        {
+            if (!it.second->closed && !it.second->connecting)
+                ids.push_back(it.first);
+        }
+        return ids;
+    }
+
+    std::string SocketComm::peer_addr(int peer)
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return "";
+        std::lock_guard<std::mutex> guard(s->lock);
+        _Peer *p = _find_peer(s.get(), peer);
+        if (!p)
+            return "";
+        if (_type == SOCKET_UNIX)
+            return _addr;
+        return _addr_str(p->addr);
+    }
+
+    uint64_t SocketComm::dropped()
+    {
+        std::shared_ptr<_Socket> s = _get_socket(_data);
+        if (!s)
+            return 0;
+        std::lock_guard<std::mutex> guard(s->lock);
+        return s->dropped;
+    }
+} // namespace maix::comm
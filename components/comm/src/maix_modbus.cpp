@@ -6,7 +6,14 @@
 #include <unistd.h>         // close
 #include <limits>           // std::numeric_limits
 #include <sys/select.h>     // select
+#include <sys/epoll.h>      // epoll
+#include <sys/socket.h>     // accept4
+#include <netinet/in.h>     // IPPROTO_TCP
+#include <netinet/tcp.h>    // TCP_NODELAY
+#include <sched.h>          // sched_yield
 #include <sstream>          // std::stringstream
+#include <algorithm>        // std::remove
+#include <chrono>           // std::chrono::steady_clock
 
 namespace maix::comm::modbus {
 
@@ -68,6 +75,20 @@ void Slave::mapping_init()
         __error_and_throw__(msg);
     }
 
+    this->mb_snapshot_.reset(
+        ::modbus_mapping_new_start_address(
+            this->registers_info_.coils.start_address,              this->registers_info_.coils.size,
+            this->registers_info_.discrete_inputs.start_address,    this->registers_info_.discrete_inputs.size,
+            this->registers_info_.holding_registers.start_address,  this->registers_info_.holding_registers.size,
+            this->registers_info_.input_registers.start_address,    this->registers_info_.input_registers.size
+        )
+    );
+
+    if (this->mb_snapshot_.get() == nullptr) {
+        const std::string msg(this->TAG()+" Failed to allocate the mapping!"+std::string(::modbus_strerror(errno)));
+        __error_and_throw__(msg);
+    }
+
     std::memset(this->mb_mapping_.get()->tab_bits,              0x00, this->registers_info_.coils.size);
     std::memset(this->mb_mapping_.get()->tab_input_bits,        0x00, this->registers_info_.discrete_inputs.size);
     std::memset(this->mb_mapping_.get()->tab_registers,         0x00, this->registers_info_.holding_registers.size);
@@ -251,48 +272,140 @@ void Slave::tcp_init(const std::string& ip, int port)
 
     this->mapping_init();
 
-    this->socket_tcp_ = ::modbus_tcp_listen(this->ctx_.get(), 1);
-
-    this->tcp_listener_ = std::make_unique<std::thread>([this](){
-        while (!this->tcp_listener_need_exit_) {
-            fd_set read_fds;
-            FD_ZERO(&read_fds);
-            FD_SET(this->socket_tcp_, &read_fds);
-
-            struct timeval timeout;
-            timeout.tv_sec = 1; // timeout 1 sec
-            timeout.tv_usec = 0;
-
-            int select_result = ::select(this->socket_tcp_ + 1, &read_fds, nullptr, nullptr, &timeout);
-            if (select_result > 0) {
-                int new_socket = ::modbus_tcp_accept(this->ctx_.get(), &socket_tcp_);
-                if (new_socket < 0 && this->debug_) {
-                    const std::string msg(this->TAG() + " tcp accept failed! " + std::string(::modbus_strerror(errno)));
-                    log::warn(msg.c_str());
-                } else if (this->debug_) {
-                    const std::string msg(this->TAG() + " new tcp connected!");
-                    log::info(msg.c_str());
-                }
-            } else if (select_result < 0 && this->debug_) {
-                const std::string msg(this->TAG() + " select failed! " + std::string(::modbus_strerror(errno)));
-                log::warn(msg.c_str());
-            }
-        }
-    });
+    this->socket_tcp_ = ::modbus_tcp_listen(this->ctx_.get(), 16);
+    if (this->socket_tcp_ < 0) {
+        const std::string msg(this->TAG()+" Listen failed!"+std::string(::modbus_strerror(errno)));
+        __error_and_throw__(msg);
+    }
+
+    this->epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (this->epoll_fd_ < 0) {
+        const std::string msg(this->TAG()+" Create epoll failed!"+std::string(::modbus_strerror(errno)));
+        __error_and_throw__(msg);
+    }
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = this->socket_tcp_;
+    if (::epoll_ctl(this->epoll_fd_, EPOLL_CTL_ADD, this->socket_tcp_, &ev) < 0) {
+        const std::string msg(this->TAG()+" Add listen socket to epoll failed!"+std::string(::modbus_strerror(errno)));
+        __error_and_throw__(msg);
+    }
 }
 
 Slave::~Slave()
 {
-    if (this->tcp_listener_ != nullptr) {
-        this->tcp_listener_need_exit_ = true;
-        log::info("%s waiting for tcp listener exit...", this->TAG().c_str());
-        this->tcp_listener_->join();
-        this->tcp_listener_need_exit_ = false;
-    }
+    for (int fd : this->tcp_clients_)
+        ::close(fd);
+    this->tcp_clients_.clear();
+    if (this->epoll_fd_ >= 0)
+        ::close(this->epoll_fd_);
     if (this->socket_tcp_ > 0)
         ::close(this->socket_tcp_);
-    if (this->ctx_.get() != nullptr)
+    if (this->ctx_.get() != nullptr) {
+        // client sockets are closed above, don't close again
+        if (this->socket_tcp_ > 0)
+            ::modbus_set_socket(this->ctx_.get(), -1);
         ::modbus_close(this->ctx_.get());
+    }
+}
+
+/* Max number of masters connected at the same time */
+static constexpr size_t __TCP_MAX_CLIENTS__ = 32;
+
+void Slave::tcp_accept()
+{
+    // listen socket is level triggered, accept one connection every time
+    int fd = ::accept4(this->socket_tcp_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        if (this->debug_)
+            log::warn("%s tcp accept failed! %s", this->TAG().c_str(), ::modbus_strerror(errno));
+        return;
+    }
+    if (this->tcp_clients_.size() >= __TCP_MAX_CLIENTS__) {
+        log::warn("%s too many tcp masters, max %d", this->TAG().c_str(), (int)__TCP_MAX_CLIENTS__);
+        ::close(fd);
+        return;
+    }
+    // keep socket blocking, libmodbus waits data with select and sends response at once
+    int flags = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flags, sizeof(flags));
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (::epoll_ctl(this->epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        log::warn("%s add tcp master to epoll failed! %s", this->TAG().c_str(), ::modbus_strerror(errno));
+        ::close(fd);
+        return;
+    }
+    this->tcp_clients_.push_back(fd);
+    if (this->debug_)
+        log::info("%s new tcp connected, fd: %d, masters: %d", this->TAG().c_str(), fd, (int)this->tcp_clients_.size());
+}
+
+void Slave::tcp_close_client(int fd)
+{
+    ::epoll_ctl(this->epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    this->tcp_clients_.erase(std::remove(this->tcp_clients_.begin(), this->tcp_clients_.end(), fd), this->tcp_clients_.end());
+    this->tcp_ready_.erase(std::remove(this->tcp_ready_.begin(), this->tcp_ready_.end(), fd), this->tcp_ready_.end());
+    if (this->tcp_client_ == fd)
+        this->tcp_client_ = -1;
+    if (this->debug_)
+        log::info("%s tcp disconnected, fd: %d, masters: %d", this->TAG().c_str(), fd, (int)this->tcp_clients_.size());
+}
+
+::maix::err::Err Slave::tcp_receive(const int timeout_ms)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    while (true) {
+        // serve masters ready in last epoll_wait one by one, so a busy master can not starve others
+        while (!this->tcp_ready_.empty()) {
+            int fd = this->tcp_ready_.front();
+            this->tcp_ready_.erase(this->tcp_ready_.begin());
+            ::modbus_set_socket(this->ctx_.get(), fd);
+            this->rc_ = ::modbus_receive(this->ctx_.get(), this->query_);
+            if (this->rc_ > 0) {
+                this->tcp_client_ = fd;
+                if (this->debug_) {
+                    log::info("%s receive from fd %d, len: %d", this->TAG().c_str(), fd, this->rc_);
+                }
+                return ::maix::err::Err::ERR_NONE;
+            }
+            if (this->rc_ < 0) {
+                // closed by master or broken frame, stream can not be synchronized again
+                this->tcp_close_client(fd);
+            }
+        }
+
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+            wait_ms = timeout_ms > elapsed ? timeout_ms - elapsed : 0;
+        }
+        struct epoll_event evs[__TCP_MAX_CLIENTS__ + 1];
+        int n = ::epoll_wait(this->epoll_fd_, evs, __TCP_MAX_CLIENTS__ + 1, wait_ms);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            log::warn("%s epoll_wait failed! %s", this->TAG().c_str(), ::modbus_strerror(errno));
+            return ::maix::err::Err::ERR_IO;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (evs[i].data.fd == this->socket_tcp_)
+                this->tcp_accept();
+            else
+                this->tcp_ready_.push_back(evs[i].data.fd);
+        }
+        if (this->tcp_ready_.empty() && wait_ms >= 0) {
+            int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+            if (elapsed >= timeout_ms) {
+                if (this->debug_) {
+                    log::warn("%s receive timeout", this->TAG().c_str());
+                }
+                return ::maix::err::Err::ERR_IO;
+            }
+        }
+    }
 }
 
 ::maix::err::Err Slave::__receive__()
@@ -314,6 +427,9 @@ Slave::~Slave()
 
 ::maix::err::Err Slave::receive(const int timeout_ms)
 {
+    if (this->socket_tcp_ > 0) {
+        return this->tcp_receive(timeout_ms);
+    }
     if (timeout_ms == 0) {
         this->set_timeout(0, 0);
     }else if (timeout_ms < 0) {
@@ -331,12 +447,153 @@ RequestType Slave::request_type()
     return static_cast<RequestType>(this->query_[this->header_len_]);
 }
 
+/*
+ * Registers are protected by a sequence lock:
+ * writers(setters and write requests) hold mapping_write_lock_ and make mapping_seq_ odd while copying,
+ * readers(getters and requests) copy without lock and retry if mapping_seq_ changed.
+ * Requests are handled with mb_snapshot_, only registers in the request are copied in and out,
+ * so modbus_reply and sending response never block register access of other threads.
+ */
+enum {
+    __TAB_BITS__ = 0,
+    __TAB_INPUT_BITS__,
+    __TAB_REGISTERS__,
+    __TAB_INPUT_REGISTERS__,
+};
+
+static inline uint8_t* __table__(const ::modbus_mapping_t* m, int table, int& start, int& nb, int& elem_size)
+{
+    switch (table) {
+    case __TAB_BITS__:
+        start = m->start_bits; nb = m->nb_bits; elem_size = 1;
+        return m->tab_bits;
+    case __TAB_INPUT_BITS__:
+        start = m->start_input_bits; nb = m->nb_input_bits; elem_size = 1;
+        return m->tab_input_bits;
+    case __TAB_REGISTERS__:
+        start = m->start_registers; nb = m->nb_registers; elem_size = 2;
+        return reinterpret_cast<uint8_t*>(m->tab_registers);
+    default:
+        start = m->start_input_registers; nb = m->nb_input_registers; elem_size = 2;
+        return reinterpret_cast<uint8_t*>(m->tab_input_registers);
+    }
+}
+
+struct __Range__ {
+    int table;
+    int addr;
+    int nb;
+    bool write;
+};
+
+/* Registers accessed by request, return number of ranges */
+static int __request_ranges__(const uint8_t* pdu, int len, __Range__ ranges[2])
+{
+    if (len < 5)
+        return 0;
+    const int func = pdu[0];
+    const int addr = (pdu[1] << 8) | pdu[2];
+    const int nb = (pdu[3] << 8) | pdu[4];
+    switch (func) {
+    case 0x01: ranges[0] = {__TAB_BITS__, addr, nb, false}; return 1;
+    case 0x02: ranges[0] = {__TAB_INPUT_BITS__, addr, nb, false}; return 1;
+    case 0x03: ranges[0] = {__TAB_REGISTERS__, addr, nb, false}; return 1;
+    case 0x04: ranges[0] = {__TAB_INPUT_REGISTERS__, addr, nb, false}; return 1;
+    case 0x05: ranges[0] = {__TAB_BITS__, addr, 1, true}; return 1;
+    case 0x06: ranges[0] = {__TAB_REGISTERS__, addr, 1, true}; return 1;
+    case 0x0F: ranges[0] = {__TAB_BITS__, addr, nb, true}; return 1;
+    case 0x10: ranges[0] = {__TAB_REGISTERS__, addr, nb, true}; return 1;
+    case 0x16: ranges[0] = {__TAB_REGISTERS__, addr, 1, true}; return 1;
+    case 0x17:
+        if (len < 9)
+            return 0;
+        ranges[0] = {__TAB_REGISTERS__, addr, nb, false};
+        ranges[1] = {__TAB_REGISTERS__, (pdu[5] << 8) | pdu[6], (pdu[7] << 8) | pdu[8], true};
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+/* Copy range of table, address out of mapping is skipped */
+static void __copy_range__(::modbus_mapping_t* dst, const ::modbus_mapping_t* src, const __Range__& r)
+{
+    int start, nb, elem_size;
+    uint8_t* d = __table__(dst, r.table, start, nb, elem_size);
+    const uint8_t* s = __table__(src, r.table, start, nb, elem_size);
+    int from = std::max(r.addr - start, 0);
+    int to = std::min(r.addr - start + r.nb, nb);
+    if (from < to)
+        std::memcpy(d + from * elem_size, s + from * elem_size, (to - from) * elem_size);
+}
+
+static inline void __seq_write_begin__(std::atomic<uint32_t>& seq)
+{
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void __seq_write_end__(std::atomic<uint32_t>& seq)
+{
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename F>
+static inline void __seq_read__(const std::atomic<uint32_t>& seq, F&& read)
+{
+    for (int retry = 0; ; ++retry) {
+        uint32_t s1 = seq.load(std::memory_order_acquire);
+        if ((s1 & 1) == 0) {
+            read();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1)
+                return;
+        }
+        if (retry > 16)
+            sched_yield();
+    }
+}
+
 ::maix::err::Err Slave::reply()
 {
-    if (::modbus_reply(this->ctx_.get(), this->query_, this->rc_, this->mb_mapping_.get()) < 0) {
+    __Range__ ranges[2];
+    int nb_ranges = __request_ranges__(this->query_ + this->header_len_, this->rc_ - this->header_len_, ranges);
+    ::modbus_mapping_t* live = this->mb_mapping_.get();
+    ::modbus_mapping_t* snap = this->mb_snapshot_.get();
+    __seq_read__(this->mapping_seq_, [&]() {
+        for (int i = 0; i < nb_ranges; ++i)
+            __copy_range__(snap, live, ranges[i]);
+    });
+
+    if (this->socket_tcp_ > 0) {
+        if (this->tcp_client_ < 0) {
+            log::warn("%s reply failed! master disconnected", this->TAG().c_str());
+            return ::maix::err::Err::ERR_IO;
+        }
+        ::modbus_set_socket(this->ctx_.get(), this->tcp_client_);
+    }
+    int rc = ::modbus_reply(this->ctx_.get(), this->query_, this->rc_, snap);
+    if (rc < 0) {
         log::warn("%s reply failed!%s", this->TAG().c_str(), ::modbus_strerror(errno));
+        if (this->socket_tcp_ > 0)
+            this->tcp_close_client(this->tcp_client_);
         return ::maix::err::Err::ERR_RUNTIME;
     }
+
+    // exception response(header + function + code + checksum) means registers not written
+    const int exception_len = this->header_len_ + 2 + (this->socket_tcp_ > 0 ? 0 : 2);
+    bool written = false;
+    for (int i = 0; i < nb_ranges; ++i)
+        written |= ranges[i].write;
+    if (written && rc != exception_len) {
+        std::lock_guard<std::mutex> lock(this->mapping_write_lock_);
+        __seq_write_begin__(this->mapping_seq_);
+        for (int i = 0; i < nb_ranges; ++i) {
+            if (ranges[i].write)
+                __copy_range__(live, snap, ranges[i]);
+        }
+        __seq_write_end__(this->mapping_seq_);
+    }
     return ::maix::err::Err::ERR_NONE;
 }
 
@@ -350,131 +607,127 @@ RequestType Slave::receive_and_reply(const int timeout_ms)
     return __type__;
 }
 
-std::vector<uint8_t> Slave::coils(const std::vector<uint8_t>& data, const uint32_t index)
+int Slave::map_read(int table, void* data, uint32_t index, uint32_t count)
 {
-    const auto __get_reg_list = [this](){
-        std::vector<uint8_t> __res__(this->mb_mapping_->nb_bits);
-        // std::copy(this->mb_mapping_->tab_bits,
-        //             this->mb_mapping_->tab_bits+this->mb_mapping_->nb_bits,
-        //             __res__);
-        for (int i = 0; i < this->mb_mapping_->nb_bits; ++i) {
-            __res__[i] = this->mb_mapping_->tab_bits[i];
-        }
-        return __res__;
-    };
-    // read
-    if (data.empty()) {
-        return __get_reg_list();
+    if (count == 0)
+        return 0;
+    int start, nb, elem_size;
+    const uint8_t* tab = __table__(this->mb_mapping_.get(), table, start, nb, elem_size);
+    if (static_cast<uint64_t>(index) + count > static_cast<uint64_t>(nb)) {
+        if (this->debug_)
+            log::warn("%s read out of index", this->TAG().c_str());
+        return -::maix::err::Err::ERR_ARGS;
     }
+    __seq_read__(this->mapping_seq_, [&]() {
+        std::memcpy(data, tab + index * elem_size, count * elem_size);
+    });
+    return static_cast<int>(count);
+}
 
-    if (static_cast<int>(data.size() + index) > this->mb_mapping_->nb_bits) {
+int Slave::map_write(int table, const void* data, uint32_t index, uint32_t count)
+{
+    if (count == 0)
+        return 0;
+    int start, nb, elem_size;
+    uint8_t* tab = __table__(this->mb_mapping_.get(), table, start, nb, elem_size);
+    if (static_cast<uint64_t>(index) + count > static_cast<uint64_t>(nb)) {
         if (this->debug_)
             log::warn("%s input data out of index", this->TAG().c_str());
-        return {};
+        return -::maix::err::Err::ERR_ARGS;
     }
+    std::lock_guard<std::mutex> lock(this->mapping_write_lock_);
+    __seq_write_begin__(this->mapping_seq_);
+    std::memcpy(tab + index * elem_size, data, count * elem_size);
+    __seq_write_end__(this->mapping_seq_);
+    return static_cast<int>(count);
+}
+
+int Slave::read_coils(uint8_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_read(__TAB_BITS__, data, index, count);
+}
+
+int Slave::write_coils(const uint8_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_write(__TAB_BITS__, data, index, count);
+}
 
-    // std::copy(data.begin(), data.end(), this->mb_mapping_->tab_bits+index);
-    auto j = index;
-    for (auto i : data) {
-        this->mb_mapping_->tab_bits[j++] = i;
+int Slave::read_discrete_input(uint8_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_read(__TAB_INPUT_BITS__, data, index, count);
+}
+
+int Slave::write_discrete_input(const uint8_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_write(__TAB_INPUT_BITS__, data, index, count);
+}
+
+int Slave::read_input_registers(uint16_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_read(__TAB_INPUT_REGISTERS__, data, index, count);
+}
+
+int Slave::write_input_registers(const uint16_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_write(__TAB_INPUT_REGISTERS__, data, index, count);
+}
+
+int Slave::read_holding_registers(uint16_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_read(__TAB_REGISTERS__, data, index, count);
+}
+
+int Slave::write_holding_registers(const uint16_t* data, uint32_t index, uint32_t count)
+{
+    return this->map_write(__TAB_REGISTERS__, data, index, count);
+}
+
+std::vector<uint8_t> Slave::coils(const std::vector<uint8_t>& data, const uint32_t index)
+{
+    // read
+    if (data.empty()) {
+        std::vector<uint8_t> __res__(this->mb_mapping_->nb_bits);
+        this->map_read(__TAB_BITS__, __res__.data(), 0, __res__.size());
+        return __res__;
     }
-    // return __get_reg_list();
+    if (this->map_write(__TAB_BITS__, data.data(), index, data.size()) < 0)
+        return {};
     return {0x00};
 }
 
 std::vector<uint8_t> Slave::discrete_input(const std::vector<uint8_t>& data, const uint32_t index)
 {
-    const auto __get_reg_list = [this](){
+    if (data.empty()) {
         std::vector<uint8_t> __res__(this->mb_mapping_->nb_input_bits);
-        // std::copy(this->mb_mapping_->tab_input_bits,
-        //     this->mb_mapping_->tab_input_bits+this->mb_mapping_->nb_input_bits,
-        //     __res__);
-        for (int i = 0; i < this->mb_mapping_->nb_input_bits; ++i) {
-            __res__[i] = this->mb_mapping_->tab_input_bits[i];
-        }
+        this->map_read(__TAB_INPUT_BITS__, __res__.data(), 0, __res__.size());
         return __res__;
-    };
-
-    if (data.empty()) {
-        return __get_reg_list();
     }
-
-    if (static_cast<int>(data.size() + index) > this->mb_mapping_->nb_input_bits) {
-        if (this->debug_)
-            log::warn("%s input data out of index", this->TAG().c_str());
+    if (this->map_write(__TAB_INPUT_BITS__, data.data(), index, data.size()) < 0)
         return {};
-    }
-
-    // std::copy(data.begin(), data.end(), this->mb_mapping_->tab_input_bits+index);
-    auto j = index;
-    for (auto i : data) {
-        this->mb_mapping_->tab_input_bits[j++] = i;
-    }
-    // return __get_reg_list();
     return {0x00};
 }
 
 std::vector<uint16_t> Slave::input_registers(const std::vector<uint16_t>& data, const uint32_t index)
 {
-    const auto __get_reg_list = [this](){
+    if (data.empty()) {
         std::vector<uint16_t> __res__(this->mb_mapping_->nb_input_registers);
-        // std::copy(this->mb_mapping_->tab_input_registers,
-        //     this->mb_mapping_->tab_input_registers+this->mb_mapping_->nb_input_registers,
-        //     __res__);
-        for (int i = 0; i < this->mb_mapping_->nb_input_registers; ++i) {
-            __res__[i] = this->mb_mapping_->tab_input_registers[i];
-        }
+        this->map_read(__TAB_INPUT_REGISTERS__, __res__.data(), 0, __res__.size());
         return __res__;
-    };
-
-    if (data.empty()) {
-        return __get_reg_list();
     }
-
-    if (static_cast<int>(data.size()+index) > this->mb_mapping_->nb_input_registers) {
-        if (this->debug_)
-            log::warn("%s input data out of index", this->TAG().c_str());
+    if (this->map_write(__TAB_INPUT_REGISTERS__, data.data(), index, data.size()) < 0)
         return {};
-    }
-
-    // std::copy(data.begin(), data.end(), this->mb_mapping_->tab_input_registers+index);
-    auto j = index;
-    for (auto i : data) {
-        this->mb_mapping_->tab_input_registers[j++] = i;
-    }
-    // return __get_reg_list();
     return {0x00};
 }
 
 std::vector<uint16_t> Slave::holding_registers(const std::vector<uint16_t>& data, const uint32_t index)
 {
-    const auto __get_reg_list = [this]() {
+    if (data.empty()) {
         std::vector<uint16_t> __res__(this->mb_mapping_->nb_registers);
-        // std::copy(this->mb_mapping_.get()->tab_registers,
-        //     this->mb_mapping_->tab_registers+this->mb_mapping_->nb_registers,
-        //     __res__);
-        for (int i = 0; i < this->mb_mapping_->nb_registers; ++i) {
-            __res__[i] = this->mb_mapping_->tab_registers[i];
-        }
+        this->map_read(__TAB_REGISTERS__, __res__.data(), 0, __res__.size());
         return __res__;
-    };
-
-    if (data.empty()) {
-        return __get_reg_list();
     }
-
-    if (static_cast<int>(data.size()+index) > this->mb_mapping_->nb_registers) {
-        if (this->debug_)
-            log::warn("%s input data out of index", this->TAG().c_str());
+    if (this->map_write(__TAB_REGISTERS__, data.data(), index, data.size()) < 0)
         return {};
-    }
-
-    // std::copy(data.begin(), data.end(), this->mb_mapping_->tab_registers+index);
-    auto j = index;
-    for (auto i : data) {
-        this->mb_mapping_->tab_registers[j++] = i;
-    }
-    // return __get_reg_list();
     return {0x00};
 }
 
@@ -37,6 +37,87 @@ enum class Cmap {
  */
 const CmapArray* get(Cmap cmap);
 
+/**
+ * @brief Get 256 entries lookup table of cmap
+ * Entry i is the colour of normalized value i/255, cmaps with more or less entries are resampled,
+ * RGB888, 256*3 bytes, built once and shared.
+ *
+ * @param cmap @see Cmap
+ * @return const uint8_t*
+ *
+ * @maixcdk maix.ext_dev.cmap.lut
+ */
+const uint8_t* lut(Cmap cmap);
+
+/**
+ * @brief Min and max value of a w x h frame, NaN is ignored.
+ *
+ * @param stride elements per row, >= w.
+ *
+ * @maixcdk maix.ext_dev.cmap.minmax
+ */
+void minmax(const float* data, int w, int h, int stride, float& min, float& max);
+
+/**
+ * @brief Min and max value of a w x h frame.
+ *
+ * @param stride elements per row, >= w.
+ *
+ * @maixcdk maix.ext_dev.cmap.minmax
+ */
+void minmax(const uint16_t* data, int w, int h, int stride, uint16_t& min, uint16_t& max);
+
+/**
+ * @brief Normalize a w x h frame to cmap lut index
+ * out = floor(clamp((v - min) / (max - min), 0, 1) * 255), 255 - out if reverse,
+ * NaN is 0 before reverse, all 0 if max <= min.
+ *
+ * @param stride elements per row of data.
+ * @param out_stride bytes per row of out.
+ *
+ * @maixcdk maix.ext_dev.cmap.normalize
+ */
+void normalize(const float* data, int w, int h, int stride, float min, float max, uint8_t* out, int out_stride, bool reverse=false);
+
+/**
+ * @brief Normalize a w x h frame to cmap lut index, @see normalize
+ *
+ * @maixcdk maix.ext_dev.cmap.normalize
+ */
+void normalize(const uint16_t* data, int w, int h, int stride, float min, float max, uint8_t* out, int out_stride, bool reverse=false);
+
+/**
+ * @brief Render a w x h frame to RGB888 with cmap
+ * Values are normalized as normalize() does, then bilinear resized to dst_w x dst_h
+ * (pixel centers aligned, same as image resize) and mapped by lut(cmap).
+ *
+ * @param stride elements per row of data.
+ * @param rgb output buffer, dst_w * dst_h * 3 bytes, e.g. data of a FMT_RGB888 image.
+ *
+ * @maixcdk maix.ext_dev.cmap.render
+ */
+void render(const float* data, int w, int h, int stride, float min, float max, Cmap cmap,
+            uint8_t* rgb, int dst_w, int dst_h, bool reverse=false);
+
+/**
+ * @brief Render a w x h frame to RGB888 with cmap, @see render
+ *
+ * @maixcdk maix.ext_dev.cmap.render
+ */
+void render(const uint16_t* data, int w, int h, int stride, float min, float max, Cmap cmap,
+            uint8_t* rgb, int dst_w, int dst_h, bool reverse=false);
+
+/**
+ * @brief Bilinear resize 8 bit lut index plane and map it to RGB888
+ *
+ * @param index w x h index, index_stride bytes per row.
+ * @param rgb output buffer, dst_w * dst_h * 3 bytes.
+ *
+ * @maixcdk maix.ext_dev.cmap.render_index
+ */
+void render_index(const uint8_t* index, int w, int h, int index_stride, Cmap cmap,
+                  uint8_t* rgb, int dst_w, int dst_h);
+
 
 }
 
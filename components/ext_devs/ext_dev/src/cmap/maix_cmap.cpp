@@ -1,5 +1,6 @@
 #include "maix_cmap.hpp"
 #include <stdexcept>
+#include <iterator>
 
 /* cmap include */
 #include "cmap_black_hot_yp0203.hpp"
@@ -50,5 +51,43 @@ const CmapArray* get(Cmap cmap)
     }
 }
 
+struct Lut {
+    uint8_t rgb[256*3];
+};
+
+static Lut build_lut(Cmap cmap)
+{
+    const CmapArray* array = get(cmap);
+    Lut lut;
+    size_t last = array->size() - 1;
+    for (size_t i = 0; i < 256; ++i) {
+        const RGB& c = (*array)[i * last / 255];
+        lut.rgb[i*3]   = c[0];
+        lut.rgb[i*3+1] = c[1];
+        lut.rgb[i*3+2] = c[2];
+    }
+    return lut;
+}
+
+const uint8_t* lut(Cmap cmap)
+{
+    /* same order as Cmap */
+    static const Lut luts[] = {
+        build_lut(Cmap::WHITE_HOT),
+        build_lut(Cmap::BLACK_HOT),
+        build_lut(Cmap::IRONBOW),
+        build_lut(Cmap::NIGHT),
+        build_lut(Cmap::RED_HOT),
+        build_lut(Cmap::WHITE_HOT_SD),
+        build_lut(Cmap::BLACK_HOT_SD),
+        build_lut(Cmap::RED_HOT_SD),
+        build_lut(Cmap::JET),
+    };
+    size_t idx = static_cast<size_t>(cmap);
+    if (idx >= std::size(luts))
+        throw std::runtime_error("Unknown cmap!");
+    return luts[idx].rgb;
+}
+
 
 }
\ No newline at end of file
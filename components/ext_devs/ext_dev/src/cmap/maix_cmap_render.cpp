@@ -0,0 +1,434 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add min/max, normalize and bilinear cmap render kernels, create this file.
+ */
+
+#include "maix_cmap.hpp"
+#include <vector>
+#include <limits>
+#include <utility>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define CMAP_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define CMAP_RVV 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define CMAP_SSE 1
+#endif
+
+namespace maix::ext_dev::cmap {
+
+/* bilinear weights are 7 bits, horizontal result is index * 128, fits uint16 */
+#define CMAP_W_BITS 7
+#define CMAP_W_ONE (1 << CMAP_W_BITS)
+
+void minmax(const float* data, int w, int h, int stride, float& min, float& max)
+{
+    float vmin = std::numeric_limits<float>::infinity();
+    float vmax = -std::numeric_limits<float>::infinity();
+#if CMAP_NEON
+    float32x4_t mn = vdupq_n_f32(vmin);
+    float32x4_t mx = vdupq_n_f32(vmax);
+#elif CMAP_RVV
+    vfloat32m1_t mn = __riscv_vfmv_s_f_f32m1(vmin, 1);
+    vfloat32m1_t mx = __riscv_vfmv_s_f_f32m1(vmax, 1);
+#elif CMAP_SSE
+    __m128 mn = _mm_set1_ps(vmin);
+    __m128 mx = _mm_set1_ps(vmax);
+#endif
+    for (int y = 0; y < h; ++y) {
+        const float* row = data + (size_t)y * stride;
+        int x = 0;
+#if CMAP_NEON
+        for (; x + 4 <= w; x += 4) {
+            float32x4_t v = vld1q_f32(row + x);
+            // compare is false for NaN, keep old value
+            mn = vbslq_f32(vcltq_f32(v, mn), v, mn);
+            mx = vbslq_f32(vcgtq_f32(v, mx), v, mx);
+        }
+#elif CMAP_RVV
+        for (size_t vl; x < w; x += vl) {
+            vl = __riscv_vsetvl_e32m4(w - x);
+            vfloat32m4_t v = __riscv_vle32_v_f32m4(row + x, vl);
+            mn = __riscv_vfredmin_vs_f32m4_f32m1(v, mn, vl);
+            mx = __riscv_vfredmax_vs_f32m4_f32m1(v, mx, vl);
+        }
+#elif CMAP_SSE
+        for (; x + 4 <= w; x += 4) {
+            __m128 v = _mm_loadu_ps(row + x);
+            // return second operand if v is NaN
+            mn = _mm_min_ps(v, mn);
+            mx = _mm_max_ps(v, mx);
+        }
+#endif
+        for (; x < w; ++x) {
+            float v = row[x];
+            if (v < vmin) vmin = v;
+            if (v > vmax) vmax = v;
+        }
+    }
+#if CMAP_NEON || CMAP_SSE
+    float tmp[8];
+#if CMAP_NEON
+    vst1q_f32(tmp, mn);
+    vst1q_f32(tmp + 4, mx);
+#else
+    _mm_storeu_ps(tmp, mn);
+    _mm_storeu_ps(tmp + 4, mx);
+#endif
+    for (int i = 0; i < 4; ++i) {
+        if (tmp[i] < vmin) vmin = tmp[i];
+        if (tmp[i + 4] > vmax) vmax = tmp[i + 4];
+    }
+#elif CMAP_RVV
+    float rmin = __riscv_vfmv_f_s_f32m1_f32(mn);
+    float rmax = __riscv_vfmv_f_s_f32m1_f32(mx);
+    if (rmin < vmin) vmin = rmin;
+    if (rmax > vmax) vmax = rmax;
+#endif
+    min = vmin;
+    max = vmax;
+}
+
+void minmax(const uint16_t* data, int w, int h, int stride, uint16_t& min, uint16_t& max)
+{
+    uint16_t vmin = 0xffff;
+    uint16_t vmax = 0;
+#if CMAP_NEON
+    uint16x8_t mn = vdupq_n_u16(vmin);
+    uint16x8_t mx = vdupq_n_u16(vmax);
+#elif CMAP_RVV
+    vuint16m1_t mn = __riscv_vmv_s_x_u16m1(vmin, 1);
+    vuint16m1_t mx = __riscv_vmv_s_x_u16m1(vmax, 1);
+#elif CMAP_SSE
+    // SSE2 only has signed 16 bits min max, flip sign bit
+    const __m128i sign = _mm_set1_epi16((short)0x8000);
+    __m128i mn = _mm_set1_epi16(0x7fff);
+    __m128i mx = _mm_set1_epi16((short)0x8000);
+#endif
+    for (int y = 0; y < h; ++y) {
+        const uint16_t* row = data + (size_t)y * stride;
+        int x = 0;
+#if CMAP_NEON
+        for (; x + 8 <= w; x += 8) {
+            uint16x8_t v = vld1q_u16(row + x);
+            mn = vminq_u16(mn, v);
+            mx = vmaxq_u16(mx, v);
+        }
+#elif CMAP_RVV
+        for (size_t vl; x < w; x += vl) {
+            vl = __riscv_vsetvl_e16m4(w - x);
+            vuint16m4_t v = __riscv_vle16_v_u16m4(row + x, vl);
+            mn = __riscv_vredminu_vs_u16m4_u16m1(v, mn, vl);
+            mx = __riscv_vredmaxu_vs_u16m4_u16m1(v, mx, vl);
+        }
+#elif CMAP_SSE
+        for (; x + 8 <= w; x += 8) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(row + x)), sign);
+            mn = _mm_min_epi16(mn, v);
+            mx = _mm_max_epi16(mx, v);
+        }
+#endif
+        for (; x < w; ++x) {
+            uint16_t v = row[x];
+            if (v < vmin) vmin = v;
+            if (v > vmax) vmax = v;
+        }
+    }
+#if CMAP_NEON || CMAP_SSE
+    uint16_t tmp[16];
+#if CMAP_NEON
+    vst1q_u16(tmp, mn);
+    vst1q_u16(tmp + 8, mx);
+#else
+    _mm_storeu_si128((__m128i*)tmp, _mm_xor_si128(mn, sign));
+    _mm_storeu_si128((__m128i*)(tmp + 8), _mm_xor_si128(mx, sign));
+#endif
+    for (int i = 0; i < 8; ++i) {
+        if (tmp[i] < vmin) vmin = tmp[i];
+        if (tmp[i + 8] > vmax) vmax = tmp[i + 8];
+    }
+#elif CMAP_RVV
+    uint16_t rmin = __riscv_vmv_x_s_u16m1_u16(mn);
+    uint16_t rmax = __riscv_vmv_x_s_u16m1_u16(mx);
+    if (rmin < vmin) vmin = rmin;
+    if (rmax > vmax) vmax = rmax;
+#endif
+    min = vmin;
+    max = vmax;
+}
+
+static inline uint8_t normalize_one(float v, float min, float scale)
+{
+    float t = (v - min) * scale;
+    if (!(t > 0)) // NaN too
+        return 0;
+    if (t >= 255)
+        return 255;
+    return static_cast<uint8_t>(t);
+}
+
+#if CMAP_NEON
+static inline uint16x4_t normalize4(float32x4_t v, float32x4_t vmin, float32x4_t vscale)
+{
+    float32x4_t t = vmulq_f32(vsubq_f32(v, vmin), vscale);
+    t = vminq_f32(vmaxq_f32(t, vdupq_n_f32(0)), vdupq_n_f32(255));
+    return vmovn_u32(vcvtq_u32_f32(t)); // NaN convert to 0
+}
+#elif CMAP_SSE
+static inline __m128i normalize4(__m128 v, __m128 vmin, __m128 vscale)
+{
+    __m128 t = _mm_mul_ps(_mm_sub_ps(v, vmin), vscale);
+    t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(255)); // max return 0 for NaN
+    return _mm_cvttps_epi32(t);
+}
+#endif
+
+static void normalize_row(const float* row, int w, float min, float scale, uint8_t* out, uint8_t flip)
+{
+    int x = 0;
+#if CMAP_NEON
+    float32x4_t vmin = vdupq_n_f32(min);
+    float32x4_t vscale = vdupq_n_f32(scale);
+    uint8x8_t vflip = vdup_n_u8(flip);
+    for (; x + 8 <= w; x += 8) {
+        uint16x8_t v = vcombine_u16(normalize4(vld1q_f32(row + x), vmin, vscale),
+                                    normalize4(vld1q_f32(row + x + 4), vmin, vscale));
+        vst1_u8(out + x, veor_u8(vmovn_u16(v), vflip));
+    }
+#elif CMAP_RVV
+    for (size_t vl; x < w; x += vl) {
+        vl = __riscv_vsetvl_e32m4(w - x);
+        vfloat32m4_t t = __riscv_vfmul_vf_f32m4(__riscv_vfsub_vf_f32m4(__riscv_vle32_v_f32m4(row + x, vl), min, vl), scale, vl);
+        t = __riscv_vfmin_vf_f32m4(__riscv_vfmax_vf_f32m4(t, 0.0f, vl), 255.0f, vl); // max return 0 for NaN
+        vuint16m2_t v = __riscv_vnsrl_wx_u16m2(__riscv_vfcvt_rtz_xu_f_v_u32m4(t, vl), 0, vl);
+        vuint8m1_t u = __riscv_vnsrl_wx_u8m1(v, 0, vl);
+        __riscv_vse8_v_u8m1(out + x, __riscv_vxor_vx_u8m1(u, flip, vl), vl);
+    }
+#elif CMAP_SSE
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128i vflip = _mm_set1_epi8((char)flip);
+    for (; x + 8 <= w; x += 8) {
+        __m128i v = _mm_packs_epi32(normalize4(_mm_loadu_ps(row + x), vmin, vscale),
+                                    normalize4(_mm_loadu_ps(row + x + 4), vmin, vscale));
+        _mm_storel_epi64((__m128i*)(out + x), _mm_xor_si128(_mm_packus_epi16(v, v), vflip));
+    }
+#endif
+    for (; x < w; ++x)
+        out[x] = normalize_one(row[x], min, scale) ^ flip;
+}
+
+static void normalize_row(const uint16_t* row, int w, float min, float scale, uint8_t* out, uint8_t flip)
+{
+    int x = 0;
+#if CMAP_NEON
+    float32x4_t vmin = vdupq_n_f32(min);
+    float32x4_t vscale = vdupq_n_f32(scale);
+    uint8x8_t vflip = vdup_n_u8(flip);
+    for (; x + 8 <= w; x += 8) {
+        uint16x8_t d = vld1q_u16(row + x);
+        float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(d)));
+        float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(d)));
+        uint16x8_t v = vcombine_u16(normalize4(lo, vmin, vscale), normalize4(hi, vmin, vscale));
+        vst1_u8(out + x, veor_u8(vmovn_u16(v), vflip));
+    }
+#elif CMAP_RVV
+    for (size_t vl; x < w; x += vl) {
+        vl = __riscv_vsetvl_e16m2(w - x);
+        vfloat32m4_t t = __riscv_vfwcvt_f_xu_v_f32m4(__riscv_vle16_v_u16m2(row + x, vl), vl);
+        t = __riscv_vfmul_vf_f32m4(__riscv_vfsub_vf_f32m4(t, min, vl), scale, vl);
+        t = __riscv_vfmin_vf_f32m4(__riscv_vfmax_vf_f32m4(t, 0.0f, vl), 255.0f, vl);
+        vuint16m2_t v = __riscv_vnsrl_wx_u16m2(__riscv_vfcvt_rtz_xu_f_v_u32m4(t, vl), 0, vl);
+        vuint8m1_t u = __riscv_vnsrl_wx_u8m1(v, 0, vl);
+        __riscv_vse8_v_u8m1(out + x, __riscv_vxor_vx_u8m1(u, flip, vl), vl);
+    }
+#elif CMAP_SSE
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128i vflip = _mm_set1_epi8((char)flip);
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= w; x += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(row + x));
+        __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(d, zero));
+        __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(d, zero));
+        __m128i v = _mm_packs_epi32(normalize4(lo, vmin, vscale), normalize4(hi, vmin, vscale));
+        _mm_storel_epi64((__m128i*)(out + x), _mm_xor_si128(_mm_packus_epi16(v, v), vflip));
+    }
+#endif
+    for (; x < w; ++x)
+        out[x] = normalize_one(row[x], min, scale) ^ flip;
+}
+
+template<typename T>
+static void normalize_frame(const T* data, int w, int h, int stride, float min, float max, uint8_t* out, int out_stride, bool reverse)
+{
+    float scale = max > min ? 255.0f / (max - min) : 0.0f;
+    uint8_t flip = reverse ? 0xff : 0;
+    for (int y = 0; y < h; ++y)
+        normalize_row(data + (size_t)y * stride, w, min, scale, out + (size_t)y * out_stride, flip);
+}
+
+void normalize(const float* data, int w, int h, int stride, float min, float max, uint8_t* out, int out_stride, bool reverse)
+{
+    normalize_frame(data, w, h, stride, min, max, out, out_stride, reverse);
+}
+
+void normalize(const uint16_t* data, int w, int h, int stride, float min, float max, uint8_t* out, int out_stride, bool reverse)
+{
+    normalize_frame(data, w, h, stride, min, max, out, out_stride, reverse);
+}
+
+/**
+ * source position of dst pixel, pixel centers aligned, clamped to edge.
+ * weight of (*i1) is *f in [0, CMAP_W_ONE].
+ */
+static void bilinear_pos(int d, int src_len, int dst_len, int* i0, int* i1, int* f)
+{
+    float s = (d + 0.5f) * src_len / dst_len - 0.5f;
+    if (s < 0)
+        s = 0;
+    int i = static_cast<int>(s);
+    if (i >= src_len - 1) {
+        *i0 = *i1 = src_len - 1;
+        *f = 0;
+        return;
+    }
+    *i0 = i;
+    *i1 = i + 1;
+    *f = static_cast<int>((s - i) * CMAP_W_ONE + 0.5f);
+}
+
+/**
+ * out[i] = (r0[i] * w0 + r1[i] * w1) / CMAP_W_ONE^2, rounded, w0 + w1 == CMAP_W_ONE.
+ */
+static void blend_rows(const uint16_t* r0, const uint16_t* r1, uint16_t w0, uint16_t w1, uint8_t* out, int n)
+{
+    int i = 0;
+#if CMAP_NEON
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t a = vld1q_u16(r0 + i);
+        uint16x8_t b = vld1q_u16(r1 + i);
+        uint32x4_t lo = vmlal_n_u16(vmull_n_u16(vget_low_u16(a), w0), vget_low_u16(b), w1);
+        uint32x4_t hi = vmlal_n_u16(vmull_n_u16(vget_high_u16(a), w0), vget_high_u16(b), w1);
+        uint16x8_t v = vcombine_u16(vrshrn_n_u32(lo, CMAP_W_BITS * 2), vrshrn_n_u32(hi, CMAP_W_BITS * 2));
+        vst1_u8(out + i, vmovn_u16(v));
+    }
+#elif CMAP_RVV
+    for (size_t vl; i < n; i += vl) {
+        vl = __riscv_vsetvl_e16m2(n - i);
+        vuint32m4_t s = __riscv_vwmulu_vx_u32m4(__riscv_vle16_v_u16m2(r0 + i, vl), w0, vl);
+        s = __riscv_vwmaccu_vx_u32m4(s, w1, __riscv_vle16_v_u16m2(r1 + i, vl), vl);
+        s = __riscv_vadd_vx_u32m4(s, 1 << (CMAP_W_BITS * 2 - 1), vl);
+        vuint16m2_t v = __riscv_vnsrl_wx_u16m2(s, CMAP_W_BITS * 2, vl);
+        __riscv_vse8_v_u8m1(out + i, __riscv_vnsrl_wx_u8m1(v, 0, vl), vl);
+    }
+#elif CMAP_SSE
+    const __m128i vw0 = _mm_set1_epi16(w0);
+    const __m128i vw1 = _mm_set1_epi16(w1);
+    const __m128i round = _mm_set1_epi32(1 << (CMAP_W_BITS * 2 - 1));
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(r0 + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(r1 + i));
+        // 16 x 16 -> 32 bits products
+        __m128i al = _mm_mullo_epi16(a, vw0), ah = _mm_mulhi_epu16(a, vw0);
+        __m128i bl = _mm_mullo_epi16(b, vw1), bh = _mm_mulhi_epu16(b, vw1);
+        __m128i lo = _mm_add_epi32(_mm_unpacklo_epi16(al, ah), _mm_unpacklo_epi16(bl, bh));
+        __m128i hi = _mm_add_epi32(_mm_unpackhi_epi16(al, ah), _mm_unpackhi_epi16(bl, bh));
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, round), CMAP_W_BITS * 2);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, round), CMAP_W_BITS * 2);
+        __m128i v = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(v, v));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = static_cast<uint8_t>((r0[i] * w0 + r1[i] * w1 + (1 << (CMAP_W_BITS * 2 - 1))) >> (CMAP_W_BITS * 2));
+}
+
+static inline void map_row(const uint8_t* index, int n, const uint8_t* table, uint8_t* rgb)
+{
+    for (int i = 0; i < n; ++i) {
+        const uint8_t* c = table + index[i] * 3;
+        rgb[0] = c[0];
+        rgb[1] = c[1];
+        rgb[2] = c[2];
+        rgb += 3;
+    }
+}
+
+void render_index(const uint8_t* index, int w, int h, int index_stride, Cmap cmap,
+                  uint8_t* rgb, int dst_w, int dst_h)
+{
+    if (!index || !rgb || w <= 0 || h <= 0 || dst_w <= 0 || dst_h <= 0)
+        return;
+    const uint8_t* table = lut(cmap);
+    if (dst_w == w && dst_h == h) {
+        for (int y = 0; y < h; ++y)
+            map_row(index + (size_t)y * index_stride, w, table, rgb + (size_t)y * w * 3);
+        return;
+    }
+
+    // horizontal pass of source rows are cached, every source row is resized once
+    std::vector<int> x0(dst_w), x1(dst_w), fx(dst_w);
+    for (int x = 0; x < dst_w; ++x)
+        bilinear_pos(x, w, dst_w, &x0[x], &x1[x], &fx[x]);
+    std::vector<uint16_t> rows(dst_w * 2);
+    std::vector<uint8_t> line(dst_w);
+    uint16_t* cache[2] = {rows.data(), rows.data() + dst_w};
+    int cache_y[2] = {-1, -1};
+    auto hresize = [&](int sy, int slot) {
+        const uint8_t* src = index + (size_t)sy * index_stride;
+        uint16_t* out = cache[slot];
+        for (int x = 0; x < dst_w; ++x)
+            out[x] = static_cast<uint16_t>(src[x0[x]] * (CMAP_W_ONE - fx[x]) + src[x1[x]] * fx[x]);
+        cache_y[slot] = sy;
+    };
+
+    for (int y = 0; y < dst_h; ++y) {
+        int y0, y1, fy;
+        bilinear_pos(y, h, dst_h, &y0, &y1, &fy);
+        if (cache_y[0] != y0) {
+            if (cache_y[1] == y0) {
+                std::swap(cache[0], cache[1]);
+                std::swap(cache_y[0], cache_y[1]);
+            } else {
+                hresize(y0, 0);
+            }
+        }
+        if (cache_y[1] != y1)
+            hresize(y1, 1);
+        blend_rows(cache[0], cache[1], static_cast<uint16_t>(CMAP_W_ONE - fy), static_cast<uint16_t>(fy), line.data(), dst_w);
+        map_row(line.data(), dst_w, table, rgb + (size_t)y * dst_w * 3);
+    }
+}
+
+template<typename T>
+static void render_frame(const T* data, int w, int h, int stride, float min, float max, Cmap cmap,
+                         uint8_t* rgb, int dst_w, int dst_h, bool reverse)
+{
+    if (!data || !rgb || w <= 0 || h <= 0 || dst_w <= 0 || dst_h <= 0)
+        return;
+    std::vector<uint8_t> index((size_t)w * h);
+    normalize_frame(data, w, h, stride, min, max, index.data(), w, reverse);
+    render_index(index.data(), w, h, w, cmap, rgb, dst_w, dst_h);
+}
+
+void render(const float* data, int w, int h, int stride, float min, float max, Cmap cmap,
+            uint8_t* rgb, int dst_w, int dst_h, bool reverse)
+{
+    render_frame(data, w, h, stride, min, max, cmap, rgb, dst_w, dst_h, reverse);
+}
+
+void render(const uint16_t* data, int w, int h, int stride, float min, float max, Cmap cmap,
+            uint8_t* rgb, int dst_w, int dst_h, bool reverse)
+{
+    render_frame(data, w, h, stride, min, max, cmap, rgb, dst_w, dst_h, reverse);
+}
+
+}
@@ -4,6 +4,10 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "maix_image.hpp"
 
@@ -13,6 +17,8 @@ struct paramsMLX90640;
 
 namespace maix::ext_dev::mlx90640 {
 
+class Calibration;
+
 /**
  * @brief MLX90640 FPS
  * @maixpy maix.ext_dev.mlx90640.FPS
@@ -117,6 +123,9 @@ public:
      * The matrix structure is represented as list[MLX_H][MLX_W],
      * where MLX_H is the number of rows (24) and MLX_W is the number of columns (32).
      *
+     * The sensor is read and temperatures are calculated in a background thread,
+     * this returns the latest full frame and only waits if no new sub page arrived since the last call.
+     *
      * @return CMatrix containing the temperature data, or an empty matrix ([]) if the operation fails.
      *
      * @maixpy maix.ext_dev.mlx90640.MLX90640Celsius.matrix
@@ -137,6 +146,21 @@ public:
      */
     ::maix::image::Image* image();
 
+    /**
+     * @brief Obtains sensor data and converts it into a pseudo-color image of width x height
+     *
+     * Temperatures are bilinear interpolated before color mapping,
+     * faster and smoother than resizing the MLX_W x MLX_H image.
+     *
+     * @param width Image width.
+     * @param height Image height.
+     * @return maix::image::Image* A raw pointer to a maix image object, nullptr if failed.
+     *         It is the responsibility of the caller to free this memory.
+     *
+     * @maixcdk maix.ext_dev.mlx90640.MLX90640Celsius.image
+     */
+    ::maix::image::Image* image(int width, int height);
+
     /**
      * @brief Finds the pixel with the minimum temperature from the most recent reading
      *
@@ -195,6 +219,19 @@ public:
      */
     ::maix::image::Image* image_from(const CMatrix& matrix);
 
+    /**
+     * @brief Converts a given matrix of temperature data into an image of width x height
+     *
+     * @param matrix The temperature matrix to be converted.
+     * @param width Image width.
+     * @param height Image height.
+     * @return maix::image::Image* A pointer to the generated image, nullptr if failed.
+     *         It is the responsibility of the caller to free this memory.
+     *
+     * @maixcdk maix.ext_dev.mlx90640.MLX90640Celsius.image_from
+     */
+    ::maix::image::Image* image_from(const CMatrix& matrix, int width, int height);
+
     /**
      * @brief Finds the pixel with the maximum temperature from the given matrix
      *
@@ -247,12 +284,28 @@ private:
     float _emissivity;
     uint16_t _eeMLX90640[832];
     uint16_t _frame[834];
-    float _mlx90640To[768];
+    float _mlx90640To[768];             // both sub pages, only used by acquisition thread
     // paramsMLX90640 _mlx90640;
     std::unique_ptr<paramsMLX90640> _mlx90640;
+    std::unique_ptr<Calibration> _calib;
     Point _temp_min;
     Point _temp_max;
     Point _center;
+
+    float _latest[MLX_H * MLX_W];       // latest full frame, same layout as matrix()
+    uint64_t _latest_seq{0};
+    uint64_t _read_seq{0};
+    int _sub_page_ms;                   // measure time of one sub page, depends on refresh rate
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::atomic<bool> _exit{false};
+    std::thread _thread;
+
+    void _acquire_loop();
+    bool _wait_data_ready();
+    bool _read_latest(float* data);
+    void _update_points(const float* data);
+    ::maix::image::Image* _render(const float* data, int width, int height);
 };
 
 /**
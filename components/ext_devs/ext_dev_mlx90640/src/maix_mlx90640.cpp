@@ -1,12 +1,13 @@
 #include "maix_mlx90640.hpp"
 #include "MLX90640_I2C_Driver.h"
 #include "MLX90640_API.h"
+#include "maix_mlx90640_calc.hpp"
 #include "maix_basic.hpp"
+#include <chrono>
 
 namespace maix::ext_dev::mlx90640 {
 
 using maix::ext_dev::cmap::Cmap;
-using maix::ext_dev::cmap::get;
 
 constexpr Point empty_point = {-1,-1,0.0};
 constexpr uint8_t MLX_ADDR = 0x33;
@@ -79,37 +80,6 @@ CMatrix to_cmatrix(const KMatrix& matrix)
     return cmatrix;
 }
 
-void make_maix_image_pixel(float min, float max, float value, uint8_t* buffer, const cmap::CmapArray* array)
-{
-    float vrange = max - min;
-    size_t index = 0;
-    if (std::isnan(value)) {
-        index = 0;
-    } else if (std::isinf(value)) {
-        index = array->size()-1;
-    } else {
-        value -= min;
-        value /= vrange;
-        if (value <= 0)
-            index = 0;
-        else if (value >= 1)
-            index = array->size()-1;
-        else {
-            value *= (array->size()-1);
-            index = ::floor(value);
-        }
-    }
-
-    auto ir = (*array)[index][0];
-    auto ig = (*array)[index][1];
-    auto ib = (*array)[index][2];
-
-    buffer[0] = ir;
-    buffer[1] = ig;
-    buffer[2] = ib;
-}
-
-
 MLX90640Kelvin::MLX90640Kelvin(int i2c_bus_num, FPS fps, Cmap cmap, float temp_min, float temp_max, float emissivity)
 {
     float ctemp_min = temp_min - KC;
@@ -171,11 +141,14 @@ MLX90640Celsius::MLX90640Celsius(int i2c_bus_num, FPS fps, Cmap cmap, float temp
     this->_max = temp_max;
     this->_min = temp_min;
     this->_emissivity = emissivity;
+    /* refresh rate code n is 2^(n-1) Hz, one sub page per refresh */
+    this->_sub_page_ms = 2000 >> static_cast<int>(fps);
     this->_mlx90640 = std::make_unique<paramsMLX90640>();
 
     ::memset(this->_eeMLX90640, 0x00, std::size(this->_eeMLX90640)*sizeof(uint16_t));
     ::memset(this->_frame, 0x00, std::size(this->_frame)*sizeof(uint16_t));
     ::memset(this->_mlx90640To, 0x00, std::size(this->_mlx90640To)*sizeof(float));
+    ::memset(this->_latest, 0x00, std::size(this->_latest)*sizeof(float));
 
     MLX90640_I2CInit(i2c_bus_num);
     MLX90640_SetResolution(MLX_ADDR, 0x03);
@@ -185,58 +158,136 @@ MLX90640Celsius::MLX90640Celsius(int i2c_bus_num, FPS fps, Cmap cmap, float temp
     MLX90640_DumpEE(MLX_ADDR, this->_eeMLX90640);
     MLX90640_ExtractParameters(this->_eeMLX90640, this->_mlx90640.get());
 
+    /* per pixel constants are calculated once here instead of every frame */
+    this->_calib = std::make_unique<Calibration>(*this->_mlx90640);
+    this->_thread = std::thread(&MLX90640Celsius::_acquire_loop, this);
 }
 
-MLX90640Celsius::~MLX90640Celsius() {}
-
-CMatrix MLX90640Celsius::matrix()
+MLX90640Celsius::~MLX90640Celsius()
 {
+    this->_exit = true;
+    if (this->_thread.joinable())
+        this->_thread.join();
+}
 
-    MLX90640_GetFrameData(MLX_ADDR, this->_frame);
-
-    auto eTa = MLX90640_GetTa(this->_frame, this->_mlx90640.get());
-    auto eTr = eTa-8.0;
-
-    MLX90640_CalculateTo(this->_frame, this->_mlx90640.get(), this->_emissivity, eTr, this->_mlx90640To);
+bool MLX90640Celsius::_wait_data_ready()
+{
+    /* poll status register with sleep, MLX90640_GetFrameData busy polls I2C */
+    uint16_t status = 0;
+    while (!this->_exit) {
+        if (MLX90640_I2CRead(MLX_ADDR, 0x8000, 1, &status) != 0)
+            return false;
+        if (status & 0x0008)
+            return true;
+        time::sleep_ms(1);
+    }
+    return false;
+}
 
-    CMatrix m(MLX_H, std::vector<float>(MLX_W));
+void MLX90640Celsius::_acquire_loop()
+{
+    int sub_pages = 0;
+    while (!this->_exit) {
+        if (!this->_wait_data_ready()) {
+            if (!this->_exit)
+                time::sleep_ms(10);
+            continue;
+        }
+        int sub_page = MLX90640_GetFrameData(MLX_ADDR, this->_frame);
+        if (sub_page < 0) {
+            log::warn("%s read frame failed: %d", TAG(), sub_page);
+            time::sleep_ms(10);
+            continue;
+        }
 
-    float temp_min = std::numeric_limits<float>::max();
-    int temp_min_x{};
-    int temp_min_y{};
+        auto eTa = MLX90640_GetTa(this->_frame, this->_mlx90640.get());
+        auto eTr = eTa-8.0f;
+        this->_calib->calculate_to(this->_frame, this->_emissivity, eTr, this->_mlx90640To);
+
+        /* a full frame needs both sub pages, then publish after every sub page */
+        sub_pages |= 1 << (sub_page & 1);
+        if (sub_pages != 3)
+            continue;
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            for (uint32_t y = 0; y < MLX_H; ++y) {
+                const float* src = this->_mlx90640To + y * MLX_W;
+                float* dst = this->_latest + y * MLX_W;
+                for (uint32_t x = 0; x < MLX_W; ++x)
+                    dst[MLX_W-1-x] = src[x];
+            }
+            ++this->_latest_seq;
+        }
+        this->_cond.notify_all();
+    }
+}
 
-    float temp_max = std::numeric_limits<float>::min();
-    int temp_max_x{};
-    int temp_max_y{};
+bool MLX90640Celsius::_read_latest(float* data)
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    /* a full frame needs two sub pages, margin for the sub page in progress when started and I2C reading */
+    int timeout_ms = this->_sub_page_ms * 3 + 500;
+    this->_cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]{
+        return this->_latest_seq != this->_read_seq;
+    });
+    if (this->_latest_seq == 0) {
+        log::error("%s no frame from sensor!", TAG());
+        return false;
+    }
+    ::memcpy(data, this->_latest, sizeof(this->_latest));
+    this->_read_seq = this->_latest_seq;
+    return true;
+}
 
-    for_each_in_matrix([&](int x, int y){
-        auto xx = MLX_W-1-x;
-        auto yy = y;
-        m[yy][xx] = this->_mlx90640To[(y*MLX_W)+x];
-        if (m[yy][xx] < temp_min) {
-            temp_min_x = xx;
-            temp_min_y = yy;
-            temp_min = m[yy][xx];
+void MLX90640Celsius::_update_points(const float* data)
+{
+    float temp_min, temp_max;
+    cmap::minmax(data, MLX_W, MLX_H, MLX_W, temp_min, temp_max);
+    int min_idx = 0, max_idx = 0;
+    for (int i = 0; i < static_cast<int>(MLX_W * MLX_H); ++i) {
+        if (data[i] == temp_min) {
+            min_idx = i;
+            break;
         }
-        if (m[yy][xx] > temp_max) {
-            temp_max_x = xx;
-            temp_max_y = yy;
-            temp_max = m[yy][xx];
+    }
+    for (int i = 0; i < static_cast<int>(MLX_W * MLX_H); ++i) {
+        if (data[i] == temp_max) {
+            max_idx = i;
+            break;
         }
-    });
+    }
 
     /* make points */
-    this->_temp_min = std::make_tuple(temp_min_x, temp_min_y, temp_min);
-    this->_temp_max = std::make_tuple(temp_max_x, temp_max_y, temp_max);
-    this->_center   = std::make_tuple(MLX_W/2, MLX_H/2, m[MLX_H/2][MLX_W/2]);
+    this->_temp_min = std::make_tuple(min_idx % MLX_W, min_idx / MLX_W, temp_min);
+    this->_temp_max = std::make_tuple(max_idx % MLX_W, max_idx / MLX_W, temp_max);
+    this->_center   = std::make_tuple(MLX_W/2, MLX_H/2, data[MLX_H/2*MLX_W + MLX_W/2]);
+}
+
+CMatrix MLX90640Celsius::matrix()
+{
+    float data[MLX_H * MLX_W];
+    if (!this->_read_latest(data))
+        return {};
+    this->_update_points(data);
 
+    CMatrix m(MLX_H);
+    for (uint32_t y = 0; y < MLX_H; ++y)
+        m[y].assign(data + y * MLX_W, data + (y + 1) * MLX_W);
     return m;
 }
 
 maix::image::Image* MLX90640Celsius::image()
 {
-    CMatrix m = this->matrix();
-    return image_from(m);
+    return this->image(MLX_W, MLX_H);
+}
+
+maix::image::Image* MLX90640Celsius::image(int width, int height)
+{
+    float data[MLX_H * MLX_W];
+    if (!this->_read_latest(data))
+        return nullptr;
+    this->_update_points(data);
+    return this->_render(data, width, height);
 }
 
 Point MLX90640Celsius::max_temp_point()
@@ -254,40 +305,12 @@ Point MLX90640Celsius::center_point()
     return this->_center;
 }
 
-maix::image::Image* MLX90640Celsius::image_from(const CMatrix& matrix)
+maix::image::Image* MLX90640Celsius::_render(const float* data, int width, int height)
 {
-    const cmap::CmapArray* array = get(this->_cmap);
-
-    // switch (this->_cmap) {
-    // case Cmap::WHITE_HOT:
-    //     array = &cmap::white_hot_yp0103;
-    //     break;
-    // case Cmap::WHITE_HOT_SD:
-    //     array = &cmap::whitehotsd_yp0100;
-    //     break;
-    // case Cmap::BLACK_HOT:
-    //     array = &cmap::black_hot_yp0203;
-    //     break;
-    // case Cmap::BLACK_HOT_SD:
-    //     array = &cmap::blackhotsd_yp0204;
-    //     break;
-    // case Cmap::RED_HOT:
-    //     array = &cmap::red_hot_yp1303;
-    //     break;
-    // case Cmap::RED_HOT_SD:
-    //     array = &cmap::redhotsd_yp1304;
-    //     break;
-    // case Cmap::NIGHT:
-    //     array = &cmap::night_yp0901;
-    //     break;
-    // case Cmap::IRONBOW:
-    //     array = &cmap::ironbow_yp0301;
-    //     break;
-    // default:
-    //     maix::log::error("%s Unknown CMAP!", TAG());
-    //     return {};
-    // }
-    uint8_t img_buffer[MLX_H][MLX_W][3];
+    if (width <= 0 || height <= 0) {
+        log::error("%s image size %dx%d error!", TAG(), width, height);
+        return nullptr;
+    }
 
     auto tmin = this->_min;
     auto tmax = this->_max;
@@ -296,11 +319,28 @@ maix::image::Image* MLX90640Celsius::image_from(const CMatrix& matrix)
         tmax = std::get<2>(this->_temp_max);
     }
 
-    for_each_in_matrix([&](int x, int y){
-        make_maix_image_pixel(tmin, tmax, matrix[y][x], img_buffer[y][x], array);
-    });
+    auto img = new maix::image::Image(width, height, image::FMT_RGB888);
+    cmap::render(data, MLX_W, MLX_H, MLX_W, tmin, tmax, this->_cmap,
+                 reinterpret_cast<uint8_t*>(img->data()), width, height);
+    return img;
+}
+
+maix::image::Image* MLX90640Celsius::image_from(const CMatrix& matrix)
+{
+    return this->image_from(matrix, MLX_W, MLX_H);
+}
+
+maix::image::Image* MLX90640Celsius::image_from(const CMatrix& matrix, int width, int height)
+{
+    if (!check_matrix(matrix)) {
+        log::error("%s matrix <format != 24x32> !", TAG());
+        return nullptr;
+    }
 
-    return new maix::image::Image(MLX_W, MLX_H, image::FMT_RGB888, reinterpret_cast<uint8_t*>(img_buffer), MLX_W*MLX_H*3, true);
+    float data[MLX_H * MLX_W];
+    for (uint32_t y = 0; y < MLX_H; ++y)
+        ::memcpy(data + y * MLX_W, matrix[y].data(), MLX_W * sizeof(float));
+    return this->_render(data, width, height);
 }
 
 Point MLX90640Celsius::max_temp_point_from(const CMatrix& matrix)
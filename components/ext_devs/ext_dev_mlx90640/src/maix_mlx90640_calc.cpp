@@ -0,0 +1,209 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Precomputed MLX90640 calibration and vectorized To calculation, create this file.
+ */
+
+#include "maix_mlx90640_calc.hpp"
+#include <math.h>
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define MLX_NEON 1 // vsqrtq_f32 and vdivq_f32 are aarch64 only
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define MLX_RVV 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define MLX_SSE 1
+#endif
+
+namespace maix::ext_dev::mlx90640 {
+
+#define MLX_KC 273.15f
+
+Calibration::Calibration(const paramsMLX90640& params)
+    : _params(params)
+{
+    const float kta_scale = powf(2, params.ktaScale);
+    const float kv_scale = powf(2, params.kvScale);
+    const double alpha_scale = pow(2, (double)params.alphaScale);
+
+    for (int m = 0; m < 2; ++m) {
+        /* mode value in control register is 0x80 for chess mode */
+        bool correct = (m ? 0x80 : 0) != params.calibrationModeEE;
+        int count[2] = {0, 0};
+        for (int i = 0; i < MLX90640_PIXEL_NUM; ++i) {
+            int il_pattern = i / 32 - (i / 64) * 2;
+            int chess_pattern = il_pattern ^ (i - (i / 2) * 2);
+            int conversion_pattern = ((i + 2) / 4 - (i + 3) / 4 + (i + 1) / 4 - i / 4) * (1 - 2 * il_pattern);
+            int sub_page = m ? chess_pattern : il_pattern;
+            Group& g = this->_groups[m][sub_page];
+            int k = count[sub_page]++;
+            g.index[k] = static_cast<uint16_t>(i);
+            g.offset[k] = params.offset[i];
+            g.kta[k] = params.kta[i] / kta_scale;
+            g.kv[k] = params.kv[i] / kv_scale;
+            g.alpha[k] = static_cast<float>(SCALEALPHA * alpha_scale / params.alpha[i]);
+            g.bias[k] = correct ? params.ilChessC[2] * (2 * il_pattern - 1) - params.ilChessC[1] * conversion_pattern : 0;
+        }
+    }
+
+    this->_alpha_corr[0] = 1 / (1 + params.ksTo[0] * 40);
+    this->_alpha_corr[1] = 1;
+    this->_alpha_corr[2] = (1 + params.ksTo[1] * params.ct[2]);
+    this->_alpha_corr[3] = this->_alpha_corr[2] * (1 + params.ksTo[2] * (params.ct[3] - params.ct[2]));
+}
+
+void Calibration::calculate_to(uint16_t* frame, float emissivity, float tr, float* result)
+{
+    const paramsMLX90640& p = this->_params;
+    int sub_page = frame[833] ? 1 : 0;
+    float vdd = MLX90640_GetVdd(frame, &p);
+    float ta = MLX90640_GetTa(frame, &p);
+
+    float ta4 = ta + MLX_KC;
+    ta4 = ta4 * ta4;
+    ta4 = ta4 * ta4;
+    float tr4 = tr + MLX_KC;
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    const float ta_tr = tr4 - (tr4 - ta4) / emissivity;
+
+    const float gain = p.gainEE / static_cast<float>(static_cast<int16_t>(frame[778]));
+    const uint8_t mode = (frame[832] & 0x1000) >> 5;
+
+    /* compensation pixel of this sub page */
+    const float a = ta - 25;
+    const float b = vdd - 3.3f;
+    float cp_offset = p.cpOffset[sub_page];
+    if (sub_page == 1 && mode != p.calibrationModeEE)
+        cp_offset += p.ilChessC[0];
+    float ir_cp = static_cast<int16_t>(frame[sub_page ? 808 : 776]) * gain;
+    ir_cp -= cp_offset * (1 + p.cpKta * a) * (1 + p.cpKv * b);
+    const float cp = p.tgc * ir_cp;
+
+    const float inv_e = 1 / emissivity;
+    const float ac_scale = 1 + p.KsTa * a;
+    const float ks1 = p.ksTo[1];
+    const float k0 = 1 - ks1 * MLX_KC;
+    const float ct1 = p.ct[1], ct2 = p.ct[2], ct3 = p.ct[3];
+    const float* acr = this->_alpha_corr;
+    const float* ks = p.ksTo;
+    const float ct[4] = {(float)p.ct[0], ct1, ct2, ct3};
+
+    const Group& g = this->_groups[mode ? 1 : 0][sub_page];
+    float* ir = this->_ir;
+    float* to = this->_to;
+    for (int k = 0; k < GROUP_SIZE; ++k)
+        ir[k] = static_cast<int16_t>(frame[g.index[k]]);
+
+    int i = 0;
+#if MLX_NEON
+    const float32x4_t one = vdupq_n_f32(1);
+    const float32x4_t kc = vdupq_n_f32(MLX_KC);
+    const float32x4_t vta_tr = vdupq_n_f32(ta_tr);
+    const float32x4_t vcp = vdupq_n_f32(cp);
+    for (; i + 4 <= GROUP_SIZE; i += 4) {
+        float32x4_t off = vmulq_f32(vld1q_f32(g.offset + i), vmlaq_n_f32(one, vld1q_f32(g.kta + i), a));
+        off = vmulq_f32(off, vmlaq_n_f32(one, vld1q_f32(g.kv + i), b));
+        float32x4_t v = vsubq_f32(vmulq_n_f32(vld1q_f32(ir + i), gain), off);
+        v = vmulq_n_f32(vsubq_f32(vaddq_f32(v, vld1q_f32(g.bias + i)), vcp), inv_e);
+        float32x4_t ac = vmulq_n_f32(vld1q_f32(g.alpha + i), ac_scale);
+        float32x4_t sx = vmulq_f32(vmulq_f32(vmulq_f32(ac, ac), ac), vmlaq_n_f32(v, ac, ta_tr));
+        sx = vmulq_n_f32(vsqrtq_f32(vsqrtq_f32(sx)), ks1);
+        float32x4_t t = vaddq_f32(vdivq_f32(v, vmlaq_n_f32(sx, ac, k0)), vta_tr);
+        t = vsubq_f32(vsqrtq_f32(vsqrtq_f32(t)), kc);
+        uint32x4_t m1 = vcgeq_f32(t, vdupq_n_f32(ct1));
+        uint32x4_t m2 = vcgeq_f32(t, vdupq_n_f32(ct2));
+        uint32x4_t m3 = vcgeq_f32(t, vdupq_n_f32(ct3));
+#define MLX_SELECT(arr) vbslq_f32(m3, vdupq_n_f32(arr[3]), vbslq_f32(m2, vdupq_n_f32(arr[2]), vbslq_f32(m1, vdupq_n_f32(arr[1]), vdupq_n_f32(arr[0]))))
+        float32x4_t r_acr = MLX_SELECT(acr);
+        float32x4_t r_ks = MLX_SELECT(ks);
+        float32x4_t r_ct = MLX_SELECT(ct);
+#undef MLX_SELECT
+        float32x4_t den = vmulq_f32(vmulq_f32(ac, r_acr), vmlaq_f32(one, r_ks, vsubq_f32(t, r_ct)));
+        t = vaddq_f32(vdivq_f32(v, den), vta_tr);
+        vst1q_f32(to + i, vsubq_f32(vsqrtq_f32(vsqrtq_f32(t)), kc));
+    }
+#elif MLX_RVV
+    for (size_t vl; i < GROUP_SIZE; i += vl) {
+        vl = __riscv_vsetvl_e32m2(GROUP_SIZE - i);
+        vfloat32m2_t off = __riscv_vfmul_vv_f32m2(__riscv_vle32_v_f32m2(g.offset + i, vl),
+                                                  __riscv_vfadd_vf_f32m2(__riscv_vfmul_vf_f32m2(__riscv_vle32_v_f32m2(g.kta + i, vl), a, vl), 1, vl), vl);
+        off = __riscv_vfmul_vv_f32m2(off, __riscv_vfadd_vf_f32m2(__riscv_vfmul_vf_f32m2(__riscv_vle32_v_f32m2(g.kv + i, vl), b, vl), 1, vl), vl);
+        vfloat32m2_t v = __riscv_vfsub_vv_f32m2(__riscv_vfmul_vf_f32m2(__riscv_vle32_v_f32m2(ir + i, vl), gain, vl), off, vl);
+        v = __riscv_vfadd_vv_f32m2(v, __riscv_vle32_v_f32m2(g.bias + i, vl), vl);
+        v = __riscv_vfmul_vf_f32m2(__riscv_vfsub_vf_f32m2(v, cp, vl), inv_e, vl);
+        vfloat32m2_t ac = __riscv_vfmul_vf_f32m2(__riscv_vle32_v_f32m2(g.alpha + i, vl), ac_scale, vl);
+        vfloat32m2_t sx = __riscv_vfmul_vv_f32m2(__riscv_vfmul_vv_f32m2(ac, ac, vl), ac, vl);
+        sx = __riscv_vfmul_vv_f32m2(sx, __riscv_vfmacc_vf_f32m2(v, ta_tr, ac, vl), vl);
+        sx = __riscv_vfmul_vf_f32m2(__riscv_vfsqrt_v_f32m2(__riscv_vfsqrt_v_f32m2(sx, vl), vl), ks1, vl);
+        vfloat32m2_t t = __riscv_vfdiv_vv_f32m2(v, __riscv_vfmacc_vf_f32m2(sx, k0, ac, vl), vl);
+        t = __riscv_vfsqrt_v_f32m2(__riscv_vfsqrt_v_f32m2(__riscv_vfadd_vf_f32m2(t, ta_tr, vl), vl), vl);
+        t = __riscv_vfsub_vf_f32m2(t, MLX_KC, vl);
+        vbool16_t m1 = __riscv_vmfge_vf_f32m2_b16(t, ct1, vl);
+        vbool16_t m2 = __riscv_vmfge_vf_f32m2_b16(t, ct2, vl);
+        vbool16_t m3 = __riscv_vmfge_vf_f32m2_b16(t, ct3, vl);
+#define MLX_SELECT(arr) __riscv_vfmerge_vfm_f32m2(__riscv_vfmerge_vfm_f32m2(__riscv_vfmerge_vfm_f32m2( \
+                            __riscv_vfmv_v_f_f32m2(arr[0], vl), arr[1], m1, vl), arr[2], m2, vl), arr[3], m3, vl)
+        vfloat32m2_t r_acr = MLX_SELECT(acr);
+        vfloat32m2_t r_ks = MLX_SELECT(ks);
+        vfloat32m2_t r_ct = MLX_SELECT(ct);
+#undef MLX_SELECT
+        vfloat32m2_t den = __riscv_vfmul_vv_f32m2(ac, r_acr, vl);
+        den = __riscv_vfmul_vv_f32m2(den, __riscv_vfmacc_vv_f32m2(__riscv_vfmv_v_f_f32m2(1, vl), r_ks, __riscv_vfsub_vv_f32m2(t, r_ct, vl), vl), vl);
+        t = __riscv_vfadd_vf_f32m2(__riscv_vfdiv_vv_f32m2(v, den, vl), ta_tr, vl);
+        t = __riscv_vfsub_vf_f32m2(__riscv_vfsqrt_v_f32m2(__riscv_vfsqrt_v_f32m2(t, vl), vl), MLX_KC, vl);
+        __riscv_vse32_v_f32m2(to + i, t, vl);
+    }
+#elif MLX_SSE
+    const __m128 one = _mm_set1_ps(1);
+    const __m128 kc = _mm_set1_ps(MLX_KC);
+    const __m128 va = _mm_set1_ps(a), vb = _mm_set1_ps(b);
+    const __m128 vgain = _mm_set1_ps(gain), vcp = _mm_set1_ps(cp), vinv_e = _mm_set1_ps(inv_e);
+    const __m128 vac_scale = _mm_set1_ps(ac_scale), vta_tr = _mm_set1_ps(ta_tr);
+    const __m128 vks1 = _mm_set1_ps(ks1), vk0 = _mm_set1_ps(k0);
+    for (; i + 4 <= GROUP_SIZE; i += 4) {
+        __m128 off = _mm_mul_ps(_mm_loadu_ps(g.offset + i), _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(g.kta + i), va)));
+        off = _mm_mul_ps(off, _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(g.kv + i), vb)));
+        __m128 v = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(ir + i), vgain), off);
+        v = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(v, _mm_loadu_ps(g.bias + i)), vcp), vinv_e);
+        __m128 ac = _mm_mul_ps(_mm_loadu_ps(g.alpha + i), vac_scale);
+        __m128 sx = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(ac, ac), ac), _mm_add_ps(v, _mm_mul_ps(ac, vta_tr)));
+        sx = _mm_mul_ps(_mm_sqrt_ps(_mm_sqrt_ps(sx)), vks1);
+        __m128 t = _mm_add_ps(_mm_div_ps(v, _mm_add_ps(sx, _mm_mul_ps(ac, vk0))), vta_tr);
+        t = _mm_sub_ps(_mm_sqrt_ps(_mm_sqrt_ps(t)), kc);
+        __m128 m1 = _mm_cmpge_ps(t, _mm_set1_ps(ct1));
+        __m128 m2 = _mm_cmpge_ps(t, _mm_set1_ps(ct2));
+        __m128 m3 = _mm_cmpge_ps(t, _mm_set1_ps(ct3));
+#define MLX_BLEND(m, x, y) _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y))
+#define MLX_SELECT(arr) MLX_BLEND(m3, _mm_set1_ps(arr[3]), MLX_BLEND(m2, _mm_set1_ps(arr[2]), MLX_BLEND(m1, _mm_set1_ps(arr[1]), _mm_set1_ps(arr[0]))))
+        __m128 r_acr = MLX_SELECT(acr);
+        __m128 r_ks = MLX_SELECT(ks);
+        __m128 r_ct = MLX_SELECT(ct);
+#undef MLX_SELECT
+#undef MLX_BLEND
+        __m128 den = _mm_mul_ps(_mm_mul_ps(ac, r_acr), _mm_add_ps(one, _mm_mul_ps(r_ks, _mm_sub_ps(t, r_ct))));
+        t = _mm_add_ps(_mm_div_ps(v, den), vta_tr);
+        _mm_storeu_ps(to + i, _mm_sub_ps(_mm_sqrt_ps(_mm_sqrt_ps(t)), kc));
+    }
+#endif
+    for (; i < GROUP_SIZE; ++i) {
+        float v = ir[i] * gain - g.offset[i] * (1 + g.kta[i] * a) * (1 + g.kv[i] * b);
+        v = (v + g.bias[i] - cp) * inv_e;
+        float ac = g.alpha[i] * ac_scale;
+        float sx = ac * ac * ac * (v + ac * ta_tr);
+        sx = sqrtf(sqrtf(sx)) * ks1;
+        float t = sqrtf(sqrtf(v / (ac * k0 + sx) + ta_tr)) - MLX_KC;
+        int r = t < ct1 ? 0 : (t < ct2 ? 1 : (t < ct3 ? 2 : 3));
+        t = sqrtf(sqrtf(v / (ac * acr[r] * (1 + ks[r] * (t - ct[r]))) + ta_tr)) - MLX_KC;
+        to[i] = t;
+    }
+
+    for (int k = 0; k < GROUP_SIZE; ++k)
+        result[g.index[k]] = to[k];
+}
+
+} // namespace maix::ext_dev::mlx90640
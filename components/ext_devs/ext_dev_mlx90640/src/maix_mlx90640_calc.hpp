@@ -0,0 +1,51 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Precomputed MLX90640 calibration and vectorized To calculation, create this file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "MLX90640_API.h"
+
+namespace maix::ext_dev::mlx90640 {
+
+/**
+ * MLX90640 per pixel calibration constants, converted from paramsMLX90640 once.
+ * Pixels measured in the same (mode, sub page) are packed together,
+ * so To of one sub page is calculated on contiguous arrays.
+ */
+class Calibration final {
+public:
+    explicit Calibration(const paramsMLX90640& params);
+
+    /**
+     * Same as MLX90640_CalculateTo, only pixels of frame's sub page in result are updated.
+     * @param frame frame data read by MLX90640_GetFrameData, 834 words.
+     * @param tr reflected temperature in Celsius.
+     * @param result 768 temperatures in Celsius, sensor order.
+     */
+    void calculate_to(uint16_t* frame, float emissivity, float tr, float* result);
+
+private:
+    static constexpr int GROUP_SIZE = 384;
+
+    struct Group {
+        uint16_t index[GROUP_SIZE];     // pixel index in sensor order
+        float offset[GROUP_SIZE];
+        float kta[GROUP_SIZE];          // kta / 2^ktaScale
+        float kv[GROUP_SIZE];           // kv / 2^kvScale
+        float alpha[GROUP_SIZE];        // SCALEALPHA * 2^alphaScale / alpha
+        float bias[GROUP_SIZE];         // interleave / chess correction if mode is not calibration mode, else 0
+    };
+
+    const paramsMLX90640& _params;
+    Group _groups[2][2];                // [interleaved 0, chess 1][sub page]
+    float _alpha_corr[4];
+    float _ir[GROUP_SIZE];
+    float _to[GROUP_SIZE];
+};
+
+} // namespace maix::ext_dev::mlx90640
@@ -7,6 +7,7 @@
 
 #include "maix_cmap.hpp"
 #include "maix_image.hpp"
+#include "maix_err.hpp"
 
 namespace maix::ext_dev::tof100 {
 
@@ -28,6 +29,32 @@ enum class Resolution : uint32_t {
     RES_25x25 = 25,
 };
 
+/**
+ * @brief Tof100 temporal filter
+ * @maixcdk maix.ext_dev.tof100.Filter
+ */
+enum class Filter {
+    NONE = 0,
+    MEDIAN,     // median of last 3 frames, remove flying pixels
+    EMA,        // exponential moving average, out += alpha * (in - out)
+};
+
+/**
+ * @brief Flat depth frame, distance in mm, pixel (x, y) is data()[y * stride + x].
+ * @maixcdk maix.ext_dev.tof100.DepthFrame
+ */
+struct DepthFrame {
+    int width{0};
+    int height{0};
+    int stride{0};              // elements per row
+    const uint16_t* borrowed{nullptr};  // borrowed from Tof100, valid until next read of the same object
+    std::vector<uint16_t> buffer;       // owned data, used if borrowed is nullptr
+
+    const uint16_t* data() const { return borrowed ? borrowed : buffer.data(); }
+    uint16_t at(int x, int y) const { return data()[y * stride + x]; }
+    bool empty() const { return width <= 0 || height <= 0 || (!borrowed && buffer.empty()); }
+};
+
 /**
  * @brief Tof100 TOF
  * @maixpy maix.ext_dev.tof100.Tof100
@@ -119,6 +146,42 @@ public:
      */
     ::maix::image::Image* image_from(const TOFMatrix& matrix);
 
+    /**
+     * @brief Retrieves sensor data to a flat depth frame, faster than matrix().
+     *        min, max and center points are updated.
+     *
+     * @param frame Output frame.
+     * @param borrow If true, frame.borrowed points to the internal buffer, no copy,
+     *               valid until next read of this object, else data is copied to frame.buffer.
+     * @return err::ERR_NONE if success, else frame is not changed.
+     *
+     * @maixcdk maix.ext_dev.tof100.Tof100.frame
+     */
+    ::maix::err::Err frame(::maix::ext_dev::tof100::DepthFrame& frame, bool borrow=false);
+
+    /**
+     * @brief Set temporal filter applied to every read frame.
+     *
+     * @param filter @see Filter, default Filter::NONE.
+     * @param alpha Factor of Filter::EMA in (0, 1], smaller is smoother but slower to follow motion.
+     *
+     * @maixcdk maix.ext_dev.tof100.Tof100.set_filter
+     */
+    void set_filter(::maix::ext_dev::tof100::Filter filter, float alpha=0.5f);
+
+    /**
+     * @brief Converts a depth frame into a pseudo color image, bilinear resized to width x height.
+     *
+     * @param frame The depth frame to be converted.
+     * @param width Image width, -1 means frame width, 50 for 25x25 frame.
+     * @param height Image height, -1 means the same scale as width.
+     * @return ::maix::image::Image* A pointer to the generated image, nullptr if frame is empty.
+     *         It is the responsibility of the caller to free this memory.
+     *
+     * @maixcdk maix.ext_dev.tof100.Tof100.image_from
+     */
+    ::maix::image::Image* image_from(const ::maix::ext_dev::tof100::DepthFrame& frame, int width=-1, int height=-1);
+
     /**
      * @brief Finds the pixel with the maximum distance from the given matrix
      *
@@ -167,7 +230,16 @@ private:
     uint32_t _mode;
     uint32_t _data_size;
     std::unique_ptr<uint8_t[]> _frame_buffer;
-    uint8_t _quantization_step{0};
+    Filter _filter{Filter::NONE};
+    float _ema_alpha{0.5f};
+    std::vector<uint16_t> _history;     // last 3 frames for Filter::MEDIAN
+    int _history_num{0};
+    int _history_idx{0};
+    std::vector<float> _ema;
+    std::vector<uint16_t> _filtered;
+
+    const uint16_t* _apply_filter(const uint16_t* raw);
+    void _update_points(const uint16_t* data);
 };
 
 
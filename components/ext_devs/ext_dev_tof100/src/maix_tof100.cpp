@@ -6,6 +6,8 @@
 #include "dragonfly.h"
 
 #include <functional>
+#include <algorithm>
+#include <string.h>
 
 #pragma GCC diagnostic ignored "-Wsign-compare"
 
@@ -115,7 +117,7 @@ Tof100::Tof100(int spi_bus_num, Resolution resolution, ::maix::ext_dev::cmap::Cm
 
 }
 
-TOFMatrix Tof100::matrix()
+err::Err Tof100::frame(DepthFrame& frame, bool borrow)
 {
     uint8_t* FrameBuf = this->_frame_buffer.get();
     int ret = SPII2CBurstDataRead(DATA_BASE_ADDRESS + DATA_OFFSET_ADDRESS,
@@ -123,98 +125,127 @@ TOFMatrix Tof100::matrix()
                                   DATA_HEAD_LENGTH + this->_data_size * 2);
     if (ret) {
         eprintln("tof read frame head failed!");
-        return {};
+        return err::ERR_IO;
     }
 
     if (((uint16_t *)FrameBuf)[0] != 0xA0CC) {
         eprintln("tof Head[%02x %02x] is missmatch\r\n", FrameBuf[0], FrameBuf[1]);
-        return {};
+        return err::ERR_IO;
     }
 
-
-    ((uint16_t *)FrameBuf)[0] = 0xFF00;
     if ((this->_data_size * 2 + DATA_HEAD_INFO_LENGTH) != ((uint16_t *)FrameBuf)[1]) {
         eprintln("ERROR: Lenth[%d] is missmatch\r\n", ((uint16_t *)FrameBuf)[1]);
-        return {};
+        return err::ERR_IO;
     }
 
+    /* depth data is row major uint16 mm, use it in place */
+    const uint16_t* data = this->_apply_filter((const uint16_t *)(FrameBuf + DATA_HEAD_LENGTH));
+    this->_update_points(data);
+
+    frame.width = frame.height = frame.stride = static_cast<int>(this->_wh);
+    if (borrow) {
+        frame.borrowed = data;
+        frame.buffer.clear();
+    } else {
+        frame.borrowed = nullptr;
+        frame.buffer.assign(data, data + this->_data_size);
+    }
+    return err::ERR_NONE;
+}
 
-    uint8_t checksum = 0;
-    TOFMatrix res(this->_wh, std::vector<uint32_t>(this->_wh));
-    int min_x, min_y, max_x, max_y;
-    uint32_t min = std::numeric_limits<decltype(min)>::max();
-    uint32_t max = std::numeric_limits<uint32_t>::min();
-    int center_x, center_y;
-    uint32_t center;
-    center_x = center_y = this->_wh/2;
-
-
-    for (int i = 0; i < this->_data_size; i++) {
-		size_t src_idx = (this->_data_size - 1) - i;
-		uint16_t tmp = ((uint16_t *)(FrameBuf + DATA_HEAD_LENGTH))[src_idx];
-
-        // this->_dis[src_idx/this->_wh][src_idx%this->_wh] = tmp;
-        int _x = static_cast<int>(src_idx%this->_wh);
-        int _y = static_cast<int>(src_idx/this->_wh);
-
-        res[_y][_x] = tmp;
+void Tof100::set_filter(Filter filter, float alpha)
+{
+    if (alpha <= 0 || alpha > 1) {
+        eprintln("filter alpha should be in (0, 1], got %f", alpha);
+        alpha = 0.5f;
+    }
+    this->_filter = filter;
+    this->_ema_alpha = alpha;
+    /* restart filter */
+    this->_history_num = 0;
+    this->_history_idx = 0;
+    this->_ema.clear();
+}
 
-        if (tmp < min) {
-            min = tmp;
-            min_x = _x;
-            min_y = _y;
+const uint16_t* Tof100::_apply_filter(const uint16_t* raw)
+{
+    const size_t n = this->_data_size;
+    if (this->_filter == Filter::MEDIAN) {
+        this->_history.resize(n * 3);
+        ::memcpy(this->_history.data() + n * this->_history_idx, raw, n * sizeof(uint16_t));
+        this->_history_idx = (this->_history_idx + 1) % 3;
+        if (this->_history_num < 3)
+            ++this->_history_num;
+        if (this->_history_num < 3)
+            return raw;
+        this->_filtered.resize(n);
+        const uint16_t* a = this->_history.data();
+        const uint16_t* b = a + n;
+        const uint16_t* c = b + n;
+        uint16_t* out = this->_filtered.data();
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t lo = std::min(a[i], b[i]);
+            uint16_t hi = std::max(a[i], b[i]);
+            out[i] = std::max(lo, std::min(hi, c[i]));
         }
-
-        if (tmp > max) {
-            max = tmp;
-            max_x = _x;
-            max_y = _y;
+        return out;
+    } else if (this->_filter == Filter::EMA) {
+        this->_filtered.resize(n);
+        uint16_t* out = this->_filtered.data();
+        if (this->_ema.size() != n) {
+            this->_ema.assign(raw, raw + n);
+            ::memcpy(out, raw, n * sizeof(uint16_t));
+            return out;
         }
-
-        if (_y == center_y && _x == center_x) {
-            center = tmp;
+        float* ema = this->_ema.data();
+        const float alpha = this->_ema_alpha;
+        for (size_t i = 0; i < n; ++i) {
+            ema[i] += alpha * (raw[i] - ema[i]);
+            out[i] = static_cast<uint16_t>(ema[i] + 0.5f);
         }
+        return out;
+    }
+    return raw;
+}
 
-		float res;
-		if (this->_quantization_step) {
-		    res = tmp;
-		    res /= this->_quantization_step;
-		} else {
-		    if (tmp > 2500) tmp = 2500;
-		    res = 5.1f * sqrtf(tmp);
-		}
-		tmp = (uint16_t)res;
-		(FrameBuf + DATA_HEAD_LENGTH + 2 * this->_data_size - 1)[-i] =
-			tmp & 0xff00 ? 0xff : (tmp & 0xff);
-		checksum +=
-			(FrameBuf + DATA_HEAD_LENGTH + 2 * this->_data_size - 1)[-i];
-	}
-
-
-	for (int i = 0; i < this->_data_size; i++) {
-		(FrameBuf + DATA_HEAD_LENGTH)[i] =
-			(FrameBuf + DATA_HEAD_LENGTH + 2 * this->_data_size - 1)[-i];
-	}
-
-
-	((uint16_t *)FrameBuf)[1] = DATA_HEAD_INFO_LENGTH + this->_data_size;
-	for (int i = 0; i < DATA_HEAD_LENGTH; i++) {
-		checksum += FrameBuf[i];
-	}
-	(FrameBuf + DATA_HEAD_LENGTH + this->_data_size)[0] = checksum;
-	(FrameBuf + DATA_HEAD_LENGTH + this->_data_size)[1] = 0xDD;
-
-
-    /* All succ, update points */
-    this->_dis_max = std::make_tuple(max_x, max_y, max);
-    this->_dis_min = std::make_tuple(min_x, min_y, min);
-    this->_dis_center = std::make_tuple(center_x, center_y, center);
+void Tof100::_update_points(const uint16_t* data)
+{
+    const int wh = static_cast<int>(this->_wh);
+    uint16_t min, max;
+    cmap::minmax(data, wh, wh, wh, min, max);
+    int min_idx = -1, max_idx = -1;
+    for (int i = 0; i < wh * wh && (min_idx < 0 || max_idx < 0); ++i) {
+        if (min_idx < 0 && data[i] == min)
+            min_idx = i;
+        if (max_idx < 0 && data[i] == max)
+            max_idx = i;
+    }
+    int center = wh / 2;
+    this->_dis_min = std::make_tuple(min_idx % wh, min_idx / wh, static_cast<uint32_t>(min));
+    this->_dis_max = std::make_tuple(max_idx % wh, max_idx / wh, static_cast<uint32_t>(max));
+    this->_dis_center = std::make_tuple(center, center, static_cast<uint32_t>(data[center * wh + center]));
+}
+
+TOFMatrix Tof100::matrix()
+{
+    DepthFrame frame;
+    if (this->frame(frame, true) != err::ERR_NONE)
+        return {};
+
+    TOFMatrix res(frame.height);
+    for (int y = 0; y < frame.height; ++y) {
+        const uint16_t* row = frame.data() + y * frame.stride;
+        res[y].assign(row, row + frame.width);
+    }
     return res;
 }
 
 ::maix::image::Image* Tof100::image()
 {
-    return this->image_from(this->matrix());
+    DepthFrame frame;
+    if (this->frame(frame, true) != err::ERR_NONE)
+        return nullptr;
+    return this->image_from(frame);
 }
 
 TOFPoint Tof100::max_dis_point()
@@ -232,13 +263,9 @@ TOFPoint Tof100::center_point()
     return this->_dis_center;
 }
 
-::maix::image::Image* Tof100::image_from(const TOFMatrix& matrix)
+::maix::image::Image* Tof100::image_from(const DepthFrame& frame, int width, int height)
 {
-    if (matrix.empty()) return nullptr;
-
-    const cmap::CmapArray* array = cmap::get(this->_cmap);
-
-    uint8_t buffer[100*100*3];
+    if (frame.empty()) return nullptr;
 
     int max = this->_max;
     int min = this->_min;
@@ -246,51 +273,35 @@ TOFPoint Tof100::center_point()
         max = 1200; //std::get<2>(this->max_dis_point());
         min = std::get<2>(this->min_dis_point());
     }
-    int range = max - min;
 
-    int pixel_cnt = 0;
-
-    for (const auto& line : matrix) {
-        for (auto dis : line) {
-            dis -= min;
-            if (dis < 0) dis = 0;
-            if (dis > range) dis = range;
-
-            uint32_t index = static_cast<uint32_t>(
-                array->size()-1-static_cast<int>(
-                    floor(static_cast<float>(dis)/range*(array->size()-1))
-                )
-            );
-            buffer[pixel_cnt*3]   = std::get<0>((*array)[index]);
-            buffer[pixel_cnt*3+1] = std::get<1>((*array)[index]);
-            buffer[pixel_cnt*3+2] = std::get<2>((*array)[index]);
-
-            pixel_cnt++;
-        }
+    if (width <= 0) {
+        /* 25x25 is too small to show, upscale to 50x50 */
+        width = frame.width == 25 ? 50 : frame.width;
     }
+    if (height <= 0)
+        height = std::max(1, width * frame.height / frame.width);
+
+    auto img = new ::maix::image::Image(width, height, image::FMT_RGB888);
+    /* near is the last colour of cmap */
+    cmap::render(frame.data(), frame.width, frame.height, frame.stride, static_cast<float>(min), static_cast<float>(max),
+                 this->_cmap, reinterpret_cast<uint8_t*>(img->data()), width, height, true);
+    return img;
+}
 
-    if (this->_wh == 25) {
-        std::vector<uint8_t> new_buffer(50 * 50 * 3);
-        for (int y = 0; y < 25; ++y) {
-            for (int x = 0; x < 25; ++x) {
-                int src_index = (y * 25 + x) * 3;
-                for (int dy = 0; dy < 2; ++dy) {
-                    for (int dx = 0; dx < 2; ++dx) {
-                        int new_y = y * 2 + dy;
-                        int new_x = x * 2 + dx;
-                        int dst_index = (new_y * 50 + new_x) * 3;
-
-                        new_buffer[dst_index]     = buffer[src_index];
-                        new_buffer[dst_index + 1] = buffer[src_index + 1];
-                        new_buffer[dst_index + 2] = buffer[src_index + 2];
-                    }
-                }
-            }
-        }
-        return new ::maix::image::Image(50, 50, image::FMT_RGB888, new_buffer.data(), 50*50*3, true);
-    }
+::maix::image::Image* Tof100::image_from(const TOFMatrix& matrix)
+{
+    if (matrix.empty() || matrix[0].empty()) return nullptr;
 
-    return new ::maix::image::Image(this->_wh, this->_wh, image::FMT_RGB888, buffer, this->_data_size*3, true);
+    DepthFrame frame;
+    frame.width = frame.stride = static_cast<int>(matrix[0].size());
+    frame.height = static_cast<int>(matrix.size());
+    frame.buffer.resize(frame.width * frame.height);
+    uint16_t* p = frame.buffer.data();
+    for (const auto& line : matrix) {
+        for (int x = 0; x < frame.width; ++x)
+            *p++ = static_cast<uint16_t>(std::min<uint32_t>(line[x], 0xffff));
+    }
+    return this->image_from(frame);
 }
 
 TOFPoint Tof100::max_dis_point_from(const TOFMatrix& matrix)
@@ -383,9 +383,49 @@ namespace maix::nn
          */
         tensor::Tensors *forward_image(image::Image &img, std::vector<float> mean = std::vector<float>(), std::vector<float> scale = std::vector<float>(), image::Fit fit = image::Fit::FIT_FILL, bool copy_result = true, bool dual_buff_wait = false, bool chw = true);
 
+        /**
+         * forward model with a batch of images.
+         * If batch > 1, images are preprocessed into one input tensor of batch images and forwarded together,
+         * every output tensor is split along the first dimension, the last incomplete batch is padded with zero.
+         * If batch is 1, images are forwarded one by one with forward_image.
+         * @param imgs input images
+         * @param mean mean value, a list type, e.g. [0.485, 0.456, 0.406], default is empty list means not normalize.
+         * @param scale scale value, a list type, e.g. [1/0.229, 1/0.224, 1/0.225], default is empty list means not normalize.
+         * @param fit fit mode, if the image size of input not equal to model's input, it will auto resize use this fit method.
+         * @param chw chw channel format, forward model with hwc format image input if set to false, default true(chw).
+         * @param batch images forwarded together, default 0 means use batch size(first dimension) of model input,
+         *              set value > 1 for model with dynamic batch size.
+         * @return output tensors of every image, same order as imgs. In C++, you should delete every element after use.
+         * @throw If error occurs, like arg error, model output can not split by batch or forward failed, will raise err.Exception.
+         * @maixpy maix.nn.NN.forward_batch
+         */
+        std::vector<tensor::Tensors *> forward_batch(std::vector<image::Image *> imgs, std::vector<float> mean = std::vector<float>(), std::vector<float> scale = std::vector<float>(), image::Fit fit = image::Fit::FIT_FILL, bool chw = true, int batch = 0);
+
+        /**
+         * Preprocess one image to data of model's first input, resize with fit, convert format, normalize and cast to input dtype.
+         * Only read layer info cached when load, so can run in another thread while forwarding.
+         * @param img input image
+         * @param dst memory of one image, at least input_image_bytes() bytes.
+         * @param mean mean value, empty means not normalize.
+         * @param scale scale value, empty means not normalize.
+         * @param fit fit mode.
+         * @param chw chw channel format, hwc if set to false.
+         * @return err::ERR_NONE if success, err::ERR_ARGS if args error, err::ERR_NOT_IMPL if input dtype not support.
+         * @maixcdk maix.nn.NN.preprocess_image
+         */
+        err::Err preprocess_image(image::Image &img, void *dst, const std::vector<float> &mean, const std::vector<float> &scale, image::Fit fit = image::Fit::FIT_FILL, bool chw = true);
+
+        /**
+         * Bytes of one image(one batch) of model's first input, used with preprocess_image.
+         * @return bytes, 0 if model not loaded.
+         * @maixcdk maix.nn.NN.input_image_bytes
+         */
+        int input_image_bytes();
+
     private:
         MUD _mud;
         NNBase *_impl;
+        std::vector<nn::LayerInfo> _inputs;
     };
 
 }; // namespace maix::nn
@@ -3,11 +3,19 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add SIMD kernels: fast exp, softmax, log_softmax, sigmoid, argmax, topk, dequantize, l2_normalize, iou.
  */
 
 #pragma once
 
 #include "maix_basic.hpp"
+#include "maix_nn_object.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace maix::nn::F
 {
@@ -23,5 +31,145 @@ namespace maix::nn::F
     */
     tensor::Tensor *softmax(tensor::Tensor *tensor, bool replace);
 
-} // namespace maix::nn::F
+    /**
+     * Name of SIMD instruction set kernels compiled with, "neon", "rvv", "sse2" or "none".
+     * "rvv" needs RVV v1.0, MaixCAM(C906, RVV 0.7.1) uses "none".
+     * @maixcdk maix.nn.F.simd
+     */
+    const char *simd();
 
+    /**
+     * exp(x) by range reduction and polynomial, relative error < 2e-7 in [-87, 88],
+     * inputs out of range are clamped, so never return inf.
+     * @maixcdk maix.nn.F.fast_exp
+     */
+    inline float fast_exp(float x)
+    {
+        x = x < -87.3f ? -87.3f : (x > 88.3f ? 88.3f : x);
+        float fn = floorf(x * 1.44269504088896341f + 0.5f);
+        float r = x - fn * 0.693359375f + fn * 2.12194440e-4f;
+        float p = 1.9875691500e-4f;
+        p = p * r + 1.3981999507e-3f;
+        p = p * r + 8.3334519073e-3f;
+        p = p * r + 4.1665795894e-2f;
+        p = p * r + 1.6666665459e-1f;
+        p = p * r + 5.0000001201e-1f;
+        p = p * r * r + r + 1.0f;
+        int32_t e = ((int32_t)fn + 127) << 23;
+        float scale;
+        memcpy(&scale, &e, sizeof(scale));
+        return p * scale;
+    }
+
+    /**
+     * out[i] = exp(in[i]), in and out can be the same buffer.
+     * @maixcdk maix.nn.F.fast_exp
+     */
+    void fast_exp(const float *in, float *out, int n);
+
+    /**
+     * Sigmoid of one value
+     * @maixcdk maix.nn.F.sigmoid
+     */
+    inline float sigmoid(float x)
+    {
+        return 1.0f / (1.0f + fast_exp(-x));
+    }
+
+    /**
+     * out[i] = sigmoid(in[i]), in and out can be the same buffer.
+     * @maixcdk maix.nn.F.sigmoid
+     */
+    void sigmoid(const float *in, float *out, int n);
+
+    /**
+     * Softmax of n values in place, element i is data[i * stride].
+     * @maixcdk maix.nn.F.softmax
+     */
+    void softmax(float *data, int n, int stride = 1);
+
+    /**
+     * Log softmax of n values in place, element i is data[i * stride].
+     * @maixcdk maix.nn.F.log_softmax
+     */
+    void log_softmax(float *data, int n, int stride = 1);
+
+    /**
+     * Index of the first max value of n values, element i is data[i * stride].
+     * @return index in [0, n), not offset, 0 if n <= 0.
+     * @maixcdk maix.nn.F.argmax
+     */
+    int argmax(const float *data, int n, int stride = 1);
+
+    /**
+     * Index of the first max value of n values of any type, element i is data[i * stride].
+     * @maixcdk maix.nn.F.argmax
+     */
+    template <typename T>
+    int argmax(const T *data, int n, int stride = 1)
+    {
+        int max_idx = 0;
+        for (int i = 1; i < n; ++i)
+        {
+            if (data[max_idx * stride] < data[i * stride])
+                max_idx = i;
+        }
+        return max_idx;
+    }
+
+    /**
+     * k largest values of n values, element i is data[i * stride].
+     * Values are selected by a k size heap and only k results are sorted, much faster than sort all when k << n.
+     * @param k number of results, <= 0 or >= n means all values.
+     * @param result (index, value) pairs, sorted by value from large to small, equal values keep smaller index first.
+     * @maixcdk maix.nn.F.topk
+     */
+    void topk(const float *data, int n, int k, std::vector<std::pair<int, float>> &result, int stride = 1);
+
+    /**
+     * out[i] = (in[i] - zero_point) * scale
+     * @maixcdk maix.nn.F.dequantize
+     */
+    void dequantize(const int8_t *in, float *out, int n, float scale, int zero_point = 0);
+
+    /**
+     * out[i] = (in[i] - zero_point) * scale
+     * @maixcdk maix.nn.F.dequantize
+     */
+    void dequantize(const uint8_t *in, float *out, int n, float scale, int zero_point = 0);
+
+    /**
+     * Convert bfloat16(high 16 bits of float32) to float32.
+     * @maixcdk maix.nn.F.bf16_to_float
+     */
+    void bf16_to_float(const uint16_t *in, float *out, int n);
+
+    /**
+     * Divide n values by their L2 norm in place, do nothing if norm is smaller than eps.
+     * @return L2 norm before normalize.
+     * @maixcdk maix.nn.F.l2_normalize
+     */
+    float l2_normalize(float *data, int n, float eps = 1e-12f);
+
+    /**
+     * IoU(intersection over union) of two boxes.
+     * @maixcdk maix.nn.F.iou
+     */
+    inline float iou(const nn::Object &a, const nn::Object &b)
+    {
+        float wi = (float)(std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x));
+        float hi = (float)(std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y));
+        float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
+        float area_u = (float)a.w * a.h + (float)b.w * b.h - area_i;
+        return area_u > 0 ? area_i / area_u : 0;
+    }
+
+    /**
+     * IoU of one box with n boxes, boxes are stored as x, y, w, h arrays.
+     * @param box x, y, w, h of the box.
+     * @param out IoU of box and every boxes, n values.
+     * @maixcdk maix.nn.F.iou
+     */
+    void iou(const float box[4], const float *x, const float *y, const float *w, const float *h, int n, float *out);
+
+} // namespace maix::nn::F
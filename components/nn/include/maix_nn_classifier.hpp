@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add topk arg, select results with nn::F::topk instead of sorting all classes.
  */
 
 #pragma once
@@ -215,11 +216,12 @@ namespace maix::nn
          * @param img image, format should match model input_type， or will raise err.Exception
          * @param softmax if true, will do softmax to result, or will return raw value
          * @param fit image resize fit mode, default Fit.FIT_COVER, see image.Fit.
+         * @param topk only return k results with largest score, select k results is much faster than sort all when there are many classes, default -1 means all.
          * @throw If error occurred, will raise err::Exception, you can find reason in log, mostly caused by args error or hardware error.
          * @return result, a list of (label, score). If in dual_buff mode, value can be one element list and score is zero when not ready. In C++, you need to delete it after use.
          * @maixpy maix.nn.Classifier.classify
          */
-        std::vector<std::pair<int, float>> *classify(image::Image &img, bool softmax = true, image::Fit fit = image::FIT_COVER)
+        std::vector<std::pair<int, float>> *classify(image::Image &img, bool softmax = true, image::Fit fit = image::FIT_COVER, int topk = -1)
         {
             if (img.format() != _input_img_fmt)
             {
@@ -234,26 +236,59 @@ namespace maix::nn
                 res->at(0).second = 0;
                 return res;
             }
-            tensor::Tensor *tensor = outputs->begin()->second;
-            if (tensor->dtype() != tensor::DType::FLOAT32)
+            std::vector<std::pair<int, float>> *result = nullptr;
+            try
             {
-                throw err::Exception("output tensor dtype only support float32 now");
+                result = _post_process(outputs, softmax, topk);
             }
-            if (softmax)
-                maix::nn::F::softmax(tensor, true);
-            std::vector<std::pair<int, float>> *result = new std::vector<std::pair<int, float>>(tensor->size_int());
-            float *data = (float *)tensor->data();
-            for (int i = 0; i < tensor->size_int(); i++)
+            catch (...)
             {
-                result->at(i).first = i;
-                result->at(i).second = data[i];
+                delete outputs;
+                throw;
             }
-            std::sort(result->begin(), result->end(), [](const std::pair<int, float> &a, const std::pair<int, float> &b)
-                      { return a.second > b.second; });
             delete outputs;
             return result;
         }
 
+        /**
+         * Classify a batch of images, images are forwarded together if model input batch size > 1, see NN::forward_batch.
+         * @param imgs images, format should match model input_type， or will raise err.Exception
+         * @param softmax if true, will do softmax to result, or will return raw value
+         * @param fit image resize fit mode, default Fit.FIT_COVER, see image.Fit.
+         * @param topk only return k results with largest score of every image, default -1 means all.
+         * @throw If error occurred, will raise err::Exception, you can find reason in log, mostly caused by args error or hardware error.
+         * @return result of every image, same order as imgs, a list of (label, score). In C++, you need to delete every element after use.
+         * @maixpy maix.nn.Classifier.classify_batch
+         */
+        std::vector<std::vector<std::pair<int, float>> *> classify_batch(std::vector<image::Image *> imgs, bool softmax = true, image::Fit fit = image::FIT_COVER, int topk = -1)
+        {
+            for (auto img : imgs)
+            {
+                if (img->format() != _input_img_fmt)
+                {
+                    throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img->format()]);
+                }
+            }
+            std::vector<tensor::Tensors *> outputs = _model->forward_batch(imgs, this->mean, this->scale, fit, _chw);
+            std::vector<std::vector<std::pair<int, float>> *> results;
+            try
+            {
+                for (auto out : outputs)
+                    results.push_back(_post_process(out, softmax, topk));
+            }
+            catch (...)
+            {
+                for (auto r : results)
+                    delete r;
+                for (auto out : outputs)
+                    delete out;
+                throw;
+            }
+            for (auto out : outputs)
+                delete out;
+            return results;
+        }
+
         /**
          * Forward tensor data to model, get result
          * @param data tensor data, format should match model input_type， or will raise err.Excetion
@@ -354,6 +389,21 @@ namespace maix::nn
         image::Size _input_size;
         std::vector<nn::LayerInfo> _inputs;
 
+        std::vector<std::pair<int, float>> *_post_process(tensor::Tensors *outputs, bool softmax, int topk)
+        {
+            tensor::Tensor *tensor = outputs->begin()->second;
+            if (tensor->dtype() != tensor::DType::FLOAT32)
+            {
+                throw err::Exception("output tensor dtype only support float32 now");
+            }
+            float *data = (float *)tensor->data();
+            if (softmax)
+                maix::nn::F::softmax(data, tensor->size_int());
+            std::vector<std::pair<int, float>> *result = new std::vector<std::pair<int, float>>();
+            maix::nn::F::topk(data, tensor->size_int(), topk, *result);
+            return result;
+        }
+
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -462,7 +462,7 @@ namespace maix::nn
             {
                 throw err::Exception(err::ERR_ARGS, "wrong model");
             }
-            obj.score = _sigmoid(*(float*)score_out->data());
+            obj.score = F::sigmoid(*(float*)score_out->data());
             float *points = (float*)points_out->data();
             if(obj.score < conf_th)
             {
@@ -517,8 +517,6 @@ namespace maix::nn
             }
         }
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
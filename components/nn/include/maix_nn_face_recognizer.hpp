@@ -15,11 +15,14 @@
 #include "maix_nn_face_detector.hpp"
 #include "maix_nn_retinaface.hpp"
 #include "maix_nn_yolov8.hpp"
+#include "maix_nn_feature_index.hpp"
 
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <memory>
+#include <cmath>
 
 static std::string _get_detect_model(const std::string &path)
 {
@@ -512,62 +515,104 @@ namespace maix::nn
         {
             this->_conf_th = conf_th;
             this->_iou_th = iou_th;
-            std::vector<nn::Object> *objs;
-            nn::Objects *objs2 = nullptr;
+            _check_features();
+            std::unique_ptr<std::vector<nn::Object>> objs;
+            std::unique_ptr<nn::Objects> objs2;
             if(_facedetector)
-                objs = _facedetector->detect(img, _conf_th, _iou_th, fit);
+                objs.reset(_facedetector->detect(img, _conf_th, _iou_th, fit));
             else if (_facedetector_retina)
-                objs = _facedetector_retina->detect(img, _conf_th, _iou_th, fit);
+                objs.reset(_facedetector_retina->detect(img, _conf_th, _iou_th, fit));
             else if (_facedetector_yolov8)
-                objs2 = _facedetector_yolov8->detect(img, _conf_th, _iou_th, fit);
-            FaceObjects *faces = new nn::FaceObjects();
-            size_t size = objs2 ? objs2->size() : objs->size();
+                objs2.reset(_facedetector_yolov8->detect(img, _conf_th, _iou_th, fit));
+            std::unique_ptr<nn::FaceObjects> faces(new nn::FaceObjects());
+            size_t size = objs2 ? objs2->size() : (objs ? objs->size() : 0);
             for (size_t i = 0; i < size; ++i)
             {
                 nn::Object *obj = objs2 ? &objs2->at(i) : &objs->at(i);
                 // get std face
-                image::Image *std_img = img.affine(obj->points, _std_points, _feature_input_size, _feature_input_size);
+                std::unique_ptr<image::Image> std_img(img.affine(obj->points, _std_points, _feature_input_size, _feature_input_size));
                 // img.save("/root/test0.jpg");
                 // std_img->save("/root/test.jpg");
-                tensor::Tensors *outputs = _model_feature->forward_image(*std_img, this->mean_feature, this->scale_feature, fit, false, true);
+                std::unique_ptr<tensor::Tensors> outputs(_model_feature->forward_image(*std_img, this->mean_feature, this->scale_feature, fit, false, true));
                 if (!outputs) // not ready for dual_buff mode
-                {
-                    delete std_img;
                     return new FaceObjects();
+                tensor::Tensor *out = outputs->begin()->second;
+                _add_face(*faces, *obj, (float *)out->data(), out->size_int(), compare_th, get_feature, get_face ? std_img.get() : nullptr);
+            }
+            return faces.release();
+        }
+
+        /**
+         * Recognize faces of a batch of images, faces of all images are aligned first,
+         * then features are extracted together with NN::forward_batch(batched if feature model input batch size > 1).
+         * @param imgs Images want to recognize, if image's size not match model input's, will auto resize with fit method.
+         * @param conf_th Detect confidence threshold, default 0.5.
+         * @param iou_th Detect IoU threshold, default 0.45.
+         * @param compare_th Compare two face score threshold, default 0.8, if two faces' score < this value, will see this face fas unknown.
+         * @param get_feature return feature or not, if true will copy features to result.
+         * @param get_face return face image or not, if true result object's face attribute will valid.
+         * @param fit Resize method, default image.Fit.FIT_CONTAIN.
+         * @throw If image format not match model input format or forward failed, will throw err::Exception.
+         * @return FaceObjects of every image, same order as imgs. In C++, you should delete every element after use.
+         * @maixpy maix.nn.FaceRecognizer.recognize_batch
+         */
+        std::vector<nn::FaceObjects *> recognize_batch(std::vector<image::Image *> imgs, float conf_th = 0.5, float iou_th = 0.45, float compare_th = 0.8, bool get_feature = false, bool get_face = false, maix::image::Fit fit = maix::image::FIT_CONTAIN)
+        {
+            this->_conf_th = conf_th;
+            this->_iou_th = iou_th;
+            _check_features();
+            std::vector<nn::FaceObjects *> results;
+            std::vector<image::Image *> std_imgs;
+            std::vector<std::pair<size_t, nn::Object>> face_objs; // image index and face
+            std::vector<tensor::Tensors *> outputs;
+            try
+            {
+                std::vector<std::unique_ptr<nn::Objects>> yolo_objs;
+                if (_facedetector_yolov8)
+                {
+                    for (auto objs : _facedetector_yolov8->detect_batch(imgs, _conf_th, _iou_th, fit))
+                        yolo_objs.emplace_back(objs);
                 }
-                tensor::Tensor *out = outputs->tensors[outputs->keys()[0]];
-                int fea_len = out->size_int();
-                float *feature = (float *)out->data();
-                // compare feature from DB
-                float max_score = 0;
-                int max_i = -1;
-                for (size_t i = 0; i < features.size(); ++i)
+                for (size_t i = 0; i < imgs.size(); ++i)
                 {
-                    float score = _feature_compare(feature, features[i].data(), fea_len);
-                    if (score > max_score)
+                    results.push_back(new nn::FaceObjects());
+                    std::unique_ptr<std::vector<nn::Object>> objs;
+                    if (_facedetector)
+                        objs.reset(_facedetector->detect(*imgs[i], _conf_th, _iou_th, fit));
+                    else if (_facedetector_retina)
+                        objs.reset(_facedetector_retina->detect(*imgs[i], _conf_th, _iou_th, fit));
+                    size_t size = objs ? objs->size() : (i < yolo_objs.size() ? yolo_objs[i]->size() : 0);
+                    for (size_t j = 0; j < size; ++j)
                     {
-                        max_score = score;
-                        if(score > compare_th)
-                            max_i = i;
+                        nn::Object &obj = objs ? objs->at(j) : yolo_objs[i]->at(j);
+                        std_imgs.push_back(imgs[i]->affine(obj.points, _std_points, _feature_input_size, _feature_input_size));
+                        face_objs.push_back(std::make_pair(i, obj));
                     }
                 }
+                yolo_objs.clear();
+                if (!std_imgs.empty())
+                    outputs = _model_feature->forward_batch(std_imgs, this->mean_feature, this->scale_feature, fit);
+                for (size_t k = 0; k < outputs.size(); ++k)
                 {
-                    faces->add(obj->x, obj->y, obj->w, obj->h, max_i + 1, max_score);
-                }
-                nn::FaceObject &face1 = faces->at(faces->size() - 1);
-                face1.points = obj->points;
-                if(get_feature)
-                {
-                    face1.feature = std::vector<float>(feature, feature + fea_len);
-                }
-                if(get_face)
-                {
-                    face1.face = *std_img;
+                    tensor::Tensor *out = outputs[k]->begin()->second;
+                    _add_face(*results[face_objs[k].first], face_objs[k].second, (float *)out->data(), out->size_int(), compare_th, get_feature, get_face ? std_imgs[k] : nullptr);
                 }
-                delete std_img;
-                delete outputs;
             }
-            return faces;
+            catch (...)
+            {
+                for (auto r : results)
+                    delete r;
+                for (auto img : std_imgs)
+                    delete img;
+                for (auto out : outputs)
+                    delete out;
+                throw;
+            }
+            for (auto img : std_imgs)
+                delete img;
+            for (auto out : outputs)
+                delete out;
+            return results;
         }
 
         /**
@@ -583,8 +628,14 @@ namespace maix::nn
                 log::error("face no feature");
                 return err::ERR_ARGS;
             }
+            _check_features();
+            _features_from_index();
+            err::Err e = _index.add(face->feature.data(), (int)face->feature.size());
+            if (e != err::ERR_NONE)
+                return e;
             labels.push_back(label);
             features.push_back(face->feature);
+            _index_version = ++_version; // index updated above
             return err::ERR_NONE;
         }
 
@@ -614,10 +665,14 @@ namespace maix::nn
                     }
                 }
             }
-            if (idx >= 0 && (size_t)idx < features.size())
+            _check_features();
+            if (idx >= 0 && idx < _index.size())
             {
+                _features_from_index();
+                _index.remove(idx);
                 features.erase(features.begin() + idx);
                 labels.erase(labels.begin() + idx + 1);
+                _index_version = ++_version; // index updated above
                 return err::ERR_NONE;
             }
             log::error("idx value error: %d", idx);
@@ -626,12 +681,21 @@ namespace maix::nn
 
         /**
          * Save faces info to a file
+         * If faces lib is loaded by load_index, features are read from index(normalized, and with precision of index dtype).
          * @param path where to save, string type.
          * @return err.Err type
          * @maixpy maix.nn.FaceRecognizer.save_faces
          */
         err::Err save_faces(const std::string &path)
         {
+            _check_features();
+            int num = _index_loaded ? _index.size() : (int)features.size();
+            if ((int)labels.size() != num + 1)
+            {
+                log::error("labels size %d not match faces number %d", (int)labels.size() - 1, num);
+                return err::ERR_ARGS;
+            }
+            std::vector<float> fea;
             std::string dir = fs::dirname(path);
             err::Err e = fs::mkdir(dir);
             if (e != err::ERR_NONE)
@@ -643,14 +707,25 @@ namespace maix::nn
             {
                 return err::ERR_IO;
             }
-            for (size_t i = 0; i < features.size(); ++i)
+            for (int i = 0; i < num; ++i)
             {
+                const std::vector<float> *p = &fea;
+                if (_index_loaded)
+                {
+                    // features not kept when load from index file
+                    fea.resize(_index.dim());
+                    _index.feature(i, fea.data());
+                }
+                else
+                {
+                    p = &features[i];
+                }
                 // name + \0 + fea_len(2B) + feature
                 f->write(labels[i + 1].c_str(), (int)labels[i + 1].size());
                 f->write("\0", 1);
-                uint16_t len = (uint16_t)features[i].size();
+                uint16_t len = (uint16_t)p->size();
                 f->write(&len, 2);
-                f->write(features[i].data(), features[i].size() * sizeof(float));
+                f->write(p->data(), p->size() * sizeof(float));
             }
             f->flush();
             f->close();
@@ -677,6 +752,9 @@ namespace maix::nn
             features.clear();
             labels.clear();
             labels.push_back("unknown");
+            _index_loaded = false;
+            _index.reset(0, _index.dtype());
+            ++_version;
 
             // Read from the file
             while (!f->eof())
@@ -696,6 +774,7 @@ namespace maix::nn
                     // Error handling if we cannot read length
                     f->close();
                     delete f;
+                    _sync_index();
                     return err::ERR_IO;
                 }
 
@@ -706,6 +785,7 @@ namespace maix::nn
                     // Error handling if we cannot read feature data
                     f->close();
                     delete f;
+                    _sync_index();
                     return err::ERR_IO;
                 }
 
@@ -717,6 +797,101 @@ namespace maix::nn
             // Close the file and clean up
             f->close();
             delete f;
+            _sync_index();
+            return err::ERR_NONE;
+        }
+
+        /**
+         * Build index of faces lib, recognize compares feature with all faces in lib by default,
+         * for large lib(thousands of faces), use IVF index or smaller dtype to speed up.
+         * Index is rebuilt from features attribute, recognize rebuilds it when number of features changed,
+         * call this after features modified in place with the same number of faces.
+         * @param nlist IVF cluster number, -1 means not use IVF(compare with all faces), 0 means sqrt(face number).
+         * @param nprobe clusters compared in every recognize when use IVF, larger is more accurate and slower.
+         * @param dtype feature storage type, tensor.DType.FLOAT32, FLOAT16 or INT8, smaller type use less memory and faster, but a little less accurate.
+         * @return err::Err type
+         * @maixpy maix.nn.FaceRecognizer.build_index
+         */
+        err::Err build_index(int nlist = -1, int nprobe = 8, tensor::DType dtype = tensor::DType::FLOAT32)
+        {
+            _check_features();
+            if (dtype != _index.dtype())
+            {
+                if (dtype != tensor::DType::FLOAT32 && dtype != tensor::DType::FLOAT16 && dtype != tensor::DType::INT8)
+                {
+                    log::error("index dtype only support FLOAT32, FLOAT16 and INT8");
+                    return err::ERR_ARGS;
+                }
+                _features_from_index();
+                _index.reset(0, dtype);
+            }
+            // kept to build IVF again when index rebuilt from features
+            _ivf_nlist = nlist;
+            _ivf_nprobe = nprobe;
+            if (!_index_loaded)
+            {
+                // features may be modified in place, IVF is built again below
+                _index.clear_ivf();
+                ++_version;
+                _sync_index();
+            }
+            if (nlist < 0)
+            {
+                _index.clear_ivf();
+                return err::ERR_NONE;
+            }
+            if (_index.size() == 0)
+                return err::ERR_NONE; // built when faces added
+            return _index.build_ivf(nlist, nprobe);
+        }
+
+        /**
+         * Save faces lib as index file, can be loaded by load_index fast(memory map, no parse), for large faces lib.
+         * @param path where to save, string type.
+         * @return err::Err type
+         * @maixpy maix.nn.FaceRecognizer.save_index
+         */
+        err::Err save_index(const std::string &path)
+        {
+            std::string dir = fs::dirname(path);
+            err::Err e = fs::mkdir(dir);
+            if (e != err::ERR_NONE)
+            {
+                return e;
+            }
+            _check_features();
+            _sync_index();
+            return _index.save(path, std::vector<std::string>(labels.begin() + 1, labels.end()));
+        }
+
+        /**
+         * Load faces lib from index file saved by save_index.
+         * features attribute will be empty after load to save memory and time, labels is loaded,
+         * add_face, remove_face and build_index with other dtype read features back from index first.
+         * Assign features attribute after load to use them instead of index.
+         * @param path from where to load, string type.
+         * @param use_mmap map file to memory, load time not depend on face number, else read whole file to memory.
+         * @return err::Err type
+         * @maixpy maix.nn.FaceRecognizer.load_index
+         */
+        err::Err load_index(const std::string &path, bool use_mmap = true)
+        {
+            std::vector<std::string> names;
+            err::Err e = _index.load(path, &names, use_mmap);
+            if (e != err::ERR_NONE)
+            {
+                return e;
+            }
+            if ((int)names.size() != _index.size())
+                names.resize(_index.size());
+            features.clear();
+            labels.clear();
+            labels.push_back("unknown");
+            labels.insert(labels.end(), names.begin(), names.end());
+            _index_loaded = true;
+            _index_version = ++_version;
+            _ivf_nlist = _index.nlist() > 0 ? _index.nlist() : -1;
+            _ivf_nprobe = _index.nprobe();
             return err::ERR_NONE;
         }
 
@@ -792,7 +967,8 @@ namespace maix::nn
         std::vector<std::string> labels;
 
         /**
-         * features
+         * features, modify with add_face, remove_face and load_faces, or assign a new list,
+         * index is rebuilt in next recognize when number of features changed, call build_index after modify it in place.
          * @maixpy maix.nn.FaceRecognizer.features
          */
         std::vector<std::vector<float>> features;
@@ -813,21 +989,87 @@ namespace maix::nn
         int _feature_input_size;
         bool _dual_buff;
         std::vector<int> _std_points;
+        nn::FeatureIndex _index;     // normalized copy of features for fast compare
+        bool _index_loaded = false;  // index loaded from file, features is empty
+        uint32_t _version = 0;       // features version, every method modify features increase it
+        uint32_t _index_version = 0; // features version index built from
+        int _ivf_nlist = -1;         // IVF clusters set by build_index, -1 means no IVF, 0 means auto
+        int _ivf_nprobe = 8;
+        std::vector<std::pair<int, float>> _search_result;
 
     private:
-        float _feature_compare(float *ftr0, float *ftr1, int len)
+        // features attribute can be assigned directly(e.g. in MaixPy), rebuild index when number of features changed,
+        // features assigned after load_index are used instead of index file.
+        void _check_features()
         {
-            double sumcorr = 0;
-            double sumftr0 = 0;
-            double sumftr1 = 0;
+            if (_index_loaded)
+            {
+                if (features.empty()) // features not kept when load from index file
+                    return;
+                _index_loaded = false;
+            }
+            else if ((int)features.size() == _index.size())
+            {
+                return;
+            }
+            ++_version;
+            _sync_index();
+        }
 
-            for (int i = 0; i < len; i++)
+        // features not kept when load from index file, read them back from index before modify faces lib
+        void _features_from_index()
+        {
+            if (!_index_loaded)
+                return;
+            features.assign(_index.size(), std::vector<float>(_index.dim()));
+            for (int i = 0; i < _index.size(); ++i)
+                _index.feature(i, features[i].data());
+            _index_loaded = false;
+        }
+
+        // rebuild index from features if features changed
+        void _sync_index()
+        {
+            if (_index_loaded || _index_version == _version)
+                return;
+            _index_version = _version;
+            _index.reset(0, _index.dtype());
+            for (auto &fea : features)
+                _index.add(fea.data(), (int)fea.size());
+            if (_ivf_nlist < 0)
+                return;
+            // skip IVF when faces not enough for clusters, search all features
+            int nlist = _ivf_nlist > 0 ? std::min(_ivf_nlist, _index.size()) : (int)sqrtf((float)_index.size());
+            if (nlist >= 2)
+                _index.build_ivf(nlist, _ivf_nprobe);
+        }
+
+        // compare feature with DB and add face to result
+        void _add_face(nn::FaceObjects &faces, const nn::Object &obj, float *feature, int fea_len, float compare_th, bool get_feature, image::Image *face)
+        {
+            float max_score = 0;
+            int max_i = -1;
+            if (_index.size() > 0 && _index.search(feature, fea_len, 1, _search_result) == err::ERR_NONE && !_search_result.empty())
+            {
+                float score = 0.5f + 0.5f * _search_result[0].second;
+                if (score > max_score)
+                {
+                    max_score = score;
+                    if(score > compare_th)
+                        max_i = _search_result[0].first;
+                }
+            }
+            faces.add(obj.x, obj.y, obj.w, obj.h, max_i + 1, max_score);
+            nn::FaceObject &face1 = faces.at(faces.size() - 1);
+            face1.points = obj.points;
+            if(get_feature)
+            {
+                face1.feature = std::vector<float>(feature, feature + fea_len);
+            }
+            if(face)
             {
-                sumftr0 += ftr0[i] * ftr0[i];
-                sumftr1 += ftr1[i] * ftr1[i];
-                sumcorr += ftr0[i] * ftr1[i];
+                face1.face = *face;
             }
-            return (0.5 + 0.5 * sumcorr / sqrt(sumftr0 * sumftr1));
         }
 
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
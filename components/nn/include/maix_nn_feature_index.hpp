@@ -0,0 +1,199 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add feature vector index for large face galleries.
+ */
+
+#pragma once
+
+#include "maix_err.hpp"
+#include "maix_tensor.hpp"
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdint.h>
+
+namespace maix::nn
+{
+    /**
+     * Cosine similarity index of feature vectors.
+     * Features are L2 normalized when added and stored in one contiguous row major matrix,
+     * as float32, float16 or int8(symmetric per row scale), search is SIMD dot product with top-k selection.
+     * Optional IVF(inverted file) index clusters features with k-means, search only scans nprobe nearest clusters.
+     * Index can be saved to file and loaded with mmap, load time not depend on feature number.
+     * @maixcdk maix.nn.FeatureIndex
+     */
+    class FeatureIndex
+    {
+    public:
+        /**
+         * FeatureIndex constructor
+         * @param dim feature dimension, 0 means decided by first added feature.
+         * @param dtype storage dtype, tensor::DType::FLOAT32, FLOAT16 or INT8.
+         * @maixcdk maix.nn.FeatureIndex.FeatureIndex
+         */
+        FeatureIndex(int dim = 0, tensor::DType dtype = tensor::DType::FLOAT32);
+        ~FeatureIndex();
+
+        FeatureIndex(const FeatureIndex &) = delete;
+        FeatureIndex &operator=(const FeatureIndex &) = delete;
+
+        /**
+         * Clear all features and IVF index, set dimension and storage dtype.
+         * @return err::ERR_ARGS if dtype not support.
+         * @maixcdk maix.nn.FeatureIndex.reset
+         */
+        err::Err reset(int dim = 0, tensor::DType dtype = tensor::DType::FLOAT32);
+
+        /**
+         * Feature dimension
+         * @maixcdk maix.nn.FeatureIndex.dim
+         */
+        int dim() const { return _dim; }
+
+        /**
+         * Feature number
+         * @maixcdk maix.nn.FeatureIndex.size
+         */
+        int size() const { return _count; }
+
+        /**
+         * Storage dtype
+         * @maixcdk maix.nn.FeatureIndex.dtype
+         */
+        tensor::DType dtype() const { return _dtype; }
+
+        /**
+         * Is index memory mapped from file, modify a mapped index copies it to memory first.
+         * @maixcdk maix.nn.FeatureIndex.mapped
+         */
+        bool mapped() const { return _map != nullptr; }
+
+        /**
+         * Add one feature at the end, index of it is size() - 1.
+         * If IVF built, feature is assigned to nearest cluster, centroids not updated.
+         * @param feature feature data, will be normalized.
+         * @param dim feature dimension, must equal dim() if dim() is not 0.
+         * @return err::ERR_ARGS if dimension not match.
+         * @maixcdk maix.nn.FeatureIndex.add
+         */
+        err::Err add(const float *feature, int dim);
+
+        /**
+         * Remove feature, features after it move forward one position.
+         * @maixcdk maix.nn.FeatureIndex.remove
+         */
+        err::Err remove(int idx);
+
+        /**
+         * Get normalized(and dequantized) feature.
+         * @param idx feature index.
+         * @param out output buffer, dim() floats.
+         * @maixcdk maix.nn.FeatureIndex.feature
+         */
+        err::Err feature(int idx, float *out) const;
+
+        /**
+         * Search most similar features, not modify index, so can search in several threads at the same time if index not modified.
+         * @param query query feature, not need normalized.
+         * @param dim query dimension, must equal dim().
+         * @param k max result number.
+         * @param result [out] (index, cosine similarity in [-1, 1]) list, similarity descending.
+         * @return err::ERR_ARGS if dimension not match.
+         * @maixcdk maix.nn.FeatureIndex.search
+         */
+        err::Err search(const float *query, int dim, int k, std::vector<std::pair<int, float>> &result) const;
+
+        /**
+         * Build IVF index with k-means, features added later are assigned to existing clusters.
+         * @param nlist cluster number, 0 means sqrt(size()), a common choice.
+         * @param nprobe clusters scanned in every search, larger is more accurate and slower.
+         * @param iters k-means iterations.
+         * @return err::ERR_NOT_READY if features not enough.
+         * @maixcdk maix.nn.FeatureIndex.build_ivf
+         */
+        err::Err build_ivf(int nlist = 0, int nprobe = 8, int iters = 10);
+
+        /**
+         * Remove IVF index, search scans all features.
+         * @maixcdk maix.nn.FeatureIndex.clear_ivf
+         */
+        void clear_ivf();
+
+        /**
+         * IVF cluster number, 0 means no IVF index.
+         * @maixcdk maix.nn.FeatureIndex.nlist
+         */
+        int nlist() const { return _nlist; }
+
+        /**
+         * Set IVF clusters scanned in every search.
+         * @maixcdk maix.nn.FeatureIndex.set_nprobe
+         */
+        void set_nprobe(int nprobe) { _nprobe = nprobe < 1 ? 1 : nprobe; }
+
+        /**
+         * IVF clusters scanned in every search.
+         * @maixcdk maix.nn.FeatureIndex.nprobe
+         */
+        int nprobe() const { return _nprobe; }
+
+        /**
+         * Save index to file.
+         * @param path file path.
+         * @param labels label of every feature, empty or size() strings, saved with index.
+         * @maixcdk maix.nn.FeatureIndex.save
+         */
+        err::Err save(const std::string &path, const std::vector<std::string> &labels = std::vector<std::string>());
+
+        /**
+         * Load index from file saved by save.
+         * @param path file path.
+         * @param labels [out] if not nullptr, labels saved with index.
+         * @param use_mmap map file to memory read only, features are paged in when searching, else read whole file.
+         * @maixcdk maix.nn.FeatureIndex.load
+         */
+        err::Err load(const std::string &path, std::vector<std::string> *labels = nullptr, bool use_mmap = true);
+
+        /**
+         * Name of SIMD kernels compiled in
+         * @return "neon", "rvv", "avx2", "sse2" or "scalar"
+         * @maixcdk maix.nn.FeatureIndex.simd
+         */
+        static const char *simd();
+
+    private:
+        int _dim;
+        int _count;
+        tensor::DType _dtype;
+        int _row_bytes;
+        // rows and int8 scales point to _data/_scales_buff or mapped file
+        const uint8_t *_rows;
+        const float *_scales;
+        std::vector<uint8_t> _data;
+        std::vector<float> _scales_buff;
+        // IVF
+        int _nlist;
+        int _nprobe;
+        std::vector<float> _centroids;
+        std::vector<int32_t> _assign;               // cluster of every feature
+        std::vector<uint32_t> _list_offset;         // CSR of clusters, nlist + 1
+        std::vector<int32_t> _list_ids;
+        const float *_centroids_p;
+        const int32_t *_assign_p;
+        const uint32_t *_list_offset_p;
+        const int32_t *_list_ids_p;
+        // mapped file
+        void *_map;
+        size_t _map_size;
+
+        void _unmap();
+        void _materialize();
+        void _encode(const float *normed, uint8_t *row, float *scale) const;
+        float _dot(const float *q, const int8_t *q8, float q_scale, int idx) const;
+        int _nearest_centroid(const float *normed) const;
+        void _build_lists();
+    };
+
+} // namespace maix::nn
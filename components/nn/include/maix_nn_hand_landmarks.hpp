@@ -3,18 +3,17 @@
  * @copyright Sipeed Ltd 2024-
  * @license Apache 2.0
  * @update 2024.12.27: Add hand keypoints support.
+ * @update 2026.10.18: Warp hands into landmarks model input directly, batch forward, track hands by landmarks.
  */
 
 #pragma once
 #include "maix_basic.hpp"
 #include "maix_nn.hpp"
 #include "maix_image.hpp"
-#include "maix_image_cv.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
 #include <math.h>
-
-#define DRAW_STD_IMG 0
+#include <limits.h>
 
 namespace maix::nn
 {
@@ -36,6 +35,7 @@ namespace maix::nn
         {
             _model = nullptr;
             _model_detect = nullptr;
+            _input = nullptr;
             if (!model.empty())
             {
                 err::Err e = load(model);
@@ -58,6 +58,11 @@ namespace maix::nn
                 delete _model;
                 _model = nullptr;
             }
+            if (_input)
+            {
+                delete _input;
+                _input = nullptr;
+            }
         }
 
         /**
@@ -73,6 +78,8 @@ namespace maix::nn
                 delete _model;
                 _model = nullptr;
             }
+            _tracked.clear();
+            _frames_since_detect = 0;
             _model = new nn::NN(model, false);
             if (!_model)
             {
@@ -243,6 +250,9 @@ namespace maix::nn
          * @param landmarks_rel outputs the relative coordinates of 21 points with respect to the top-left vertex of the hand.
          *                      In obj.points, the last 21x2 values are arranged as x0y0x1y1...x20y20.
          *                      Value from 0 to obj.w.
+         * @param track_interval Track hands by landmarks of last frame and skip palm detection, default 0 means not track, detect palm every frame.
+         *                       Value N > 0 means detect palm every N frames or when no hand tracked, other frames hands region is calculated from last landmarks.
+         *                       Palm detect is the most time consuming part, tracking is much faster, but new hands only found on palm detect frames.
          * @throw If image format not match model input format, will throw err::Exception.
          * @return Object list. In C++, you should delete it after use.
          *         Object's points value format: box_topleft_x, box_topleft_y, box_topright_x, box_topright_y, box_bottomright_x, box_bottomright_y， box_bottomleft_x, box_bottomleft_y,
@@ -251,7 +261,7 @@ namespace maix::nn
          *         Z is depth, the larger the value, the farther away from the palm, and the positive value means closer to the camera.
          * @maixpy maix.nn.HandLandmarks.detect
          */
-        nn::Objects *detect(image::Image &img, float conf_th = 0.7, float iou_th = 0.45, float conf_th2 = 0.8, bool landmarks_rel = false)
+        nn::Objects *detect(image::Image &img, float conf_th = 0.7, float iou_th = 0.45, float conf_th2 = 0.8, bool landmarks_rel = false, int track_interval = 0)
         {
             maix::image::Fit fit = maix::image::FIT_CONTAIN;
             this->_conf_th = conf_th;
@@ -261,51 +271,56 @@ namespace maix::nn
             {
                 throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img.format()]);
             }
-            image::Image *detect_img_input = &img;
-            bool resized = false;
-            if (img.width() != _input_size_detect.width() || img.height() != _input_size_detect.height())
+            bool tracking = track_interval > 0 && !_tracked.empty() && _frames_since_detect < track_interval;
+            if (track_interval <= 0)
+                _tracked.clear();
+            ++_frames_since_detect;
+            nn::Objects *objs;
+            if (tracking)
             {
-                detect_img_input = img.resize(_input_size_detect.width(), _input_size_detect.height(), fit);
-                resized = true;
-            }
-            nn::Objects *objs = new nn::Objects();
-            tensor::Tensors *outputs;
-            outputs = _model_detect->forward_image(*detect_img_input, this->mean, this->scale, fit, false, true, false);
-            if (resized)
-                delete detect_img_input;
-            if (!outputs) // not ready, return empty result.
-            {
-                return objs;
+                // hands region from last landmarks, no palm detect
+                objs = new nn::Objects();
+                _rois = _tracked;
+                for (size_t i = 0; i < _rois.size(); ++i)
+                    objs->add(0, 0, 0, 0, 0, 0, std::vector<int>(), 0);
             }
-            _decode_objs(*objs, outputs, conf_th, _input_size_detect.width(), _input_size_detect.height(), resized, img.width(), img.height());
-            delete outputs;
-            if (objs->size() > 0)
+            else
             {
-                nn::Objects *objects_total = objs;
-                objs = _nms(*objs);
-                delete objects_total;
-            }
-            std::vector<cv::Mat> M_inverse;
-            std::vector<image::Image *> landmarks_input = _crop_reize_hand(*objs, img, _input_size.width(), _input_size.height(), M_inverse, landmarks_rel);
-            #if DRAW_STD_IMG
-                int y=0;
-            #endif
-            bool have_invalid = false;
-            for(size_t i=0; i<landmarks_input.size(); ++i)
-            {
-                #if DRAW_STD_IMG
-                    img.draw_image(0, y, *landmarks_input[i]);
-                    y += landmarks_input[i]->height();
-                #endif
-                outputs = _model->forward_image(*landmarks_input[i], this->mean, this->scale, fit, false, true, false);
-                delete landmarks_input[i];
+                _frames_since_detect = 1;
+                image::Image *detect_img_input = &img;
+                bool resized = false;
+                if (img.width() != _input_size_detect.width() || img.height() != _input_size_detect.height())
+                {
+                    detect_img_input = img.resize(_input_size_detect.width(), _input_size_detect.height(), fit);
+                    resized = true;
+                }
+                objs = new nn::Objects();
+                tensor::Tensors *outputs;
+                outputs = _model_detect->forward_image(*detect_img_input, this->mean, this->scale, fit, false, true, false);
+                if (resized)
+                    delete detect_img_input;
                 if (!outputs) // not ready, return empty result.
                 {
                     return objs;
                 }
-                have_invalid |= _decode_landmarks(*objs, i, outputs, conf_th2, M_inverse, _input_size.width(), _input_size.height(), img.width(), img.height(), landmarks_rel);
+                _decode_objs(*objs, outputs, conf_th, _input_size_detect.width(), _input_size_detect.height(), resized, img.width(), img.height());
                 delete outputs;
+                if (objs->size() > 0)
+                {
+                    nn::Objects *objects_total = objs;
+                    objs = _nms(*objs);
+                    delete objects_total;
+                }
+                _rois.resize(objs->size());
+                for (size_t i = 0; i < objs->size(); ++i)
+                    _palm_roi(objs->at(i), _rois[i]);
+            }
+            if (objs->size() == 0)
+            {
+                _tracked.clear();
+                return objs;
             }
+            bool have_invalid = _forward_landmarks(img, *objs, conf_th2, landmarks_rel);
             if(have_invalid)
             {
                 nn::Objects *res = new nn::Objects();
@@ -316,7 +331,24 @@ namespace maix::nn
                         res->add(obj);
                 }
                 delete objs;
-                return res;
+                objs = res;
+            }
+            if (track_interval > 0)
+            {
+                // tracked regions may drift onto the same hand
+                if (tracking && objs->size() > 1)
+                {
+                    nn::Objects *objects_total = objs;
+                    objs = _nms(*objs);
+                    delete objects_total;
+                }
+                _tracked.clear();
+                for (nn::Object *obj : *objs)
+                {
+                    HandROI roi;
+                    if (_landmarks_roi(*obj, img.width(), img.height(), roi))
+                        _tracked.push_back(roi);
+                }
             }
             return objs;
         }
@@ -493,6 +525,17 @@ namespace maix::nn
         float _conf_th2 = 0.8;
         std::vector<std::vector<float>> _anchors;
 
+        // rotated square region of one hand, theta is rotation of landmarks model input
+        struct HandROI
+        {
+            float cx, cy, size, theta;
+        };
+        std::vector<HandROI> _rois;    // hands of this frame
+        std::vector<HandROI> _tracked; // hands from last frame's landmarks
+        int _frames_since_detect = 0;
+        std::vector<float> _affines;   // 6 values of every hand, landmarks model input pixel to image pixel, kept between frames
+        tensor::Tensor *_input;        // batch input of landmarks model, kept between frames
+
     private:
         bool _parse_anchor_line(std::string &line, std::vector<std::vector<float>> &anchors)
         {
@@ -528,9 +571,9 @@ namespace maix::nn
             }
             float *scores = (float*)score_out->data();
             float *bboxes = (float*)box_out->data();
+            F::sigmoid(scores, scores, bbox_size);
             for (int i = 0; i < bbox_size; ++i)
             {
-                scores[i] = _sigmoid(scores[i]);
                 if(scores[i] >= conf_th)
                 {
                     float *p = bboxes + i*18;
@@ -555,63 +598,216 @@ namespace maix::nn
             }
         }
 
-        std::vector<image::Image *> _crop_reize_hand(nn::Objects &objs, image::Image &img, int input_w, int input_h, std::vector<cv::Mat> &M_inverse, bool landmarks_rel)
+        void _palm_roi(const nn::Object &obj, HandROI &roi)
         {
-            std::vector<image::Image *> res;
             float dscale = 2.6;
+            float dy = -0.5 * sin(obj.angle);
+            roi.cx = (int)((obj.x + obj.w * 0.5 + obj.points[0]) * 0.5);
+            roi.cy = (int)((obj.y + obj.h * 0.5 + obj.w * dy + obj.points[1]) * 0.5);
+            roi.size = (int)(obj.w * dscale);
+            roi.theta = obj.angle - M_PI * 0.5;
+        }
+
+        /**
+         * Next frame's hand region from landmarks like MediaPipe, box of palm landmarks in hand direction(wrist to middle finger),
+         * shift to fingers by 0.1 height, square and scale 2 times.
+         * @return false if hand out of image, should detect again.
+         */
+        bool _landmarks_roi(const nn::Object &obj, int img_w, int img_h, HandROI &roi)
+        {
+            static const int palm_idx[] = {0, 1, 2, 3, 5, 6, 9, 10, 13, 14, 17, 18};
+            const int *pts = obj.points.data() + 8; // x, y, z of 21 points
+            float theta = atan2f(pts[9 * 3 + 1] - pts[1], pts[9 * 3] - pts[0]) + M_PI * 0.5;
+            float c = cosf(theta), s = sinf(theta);
+            float u_min = INFINITY, u_max = -INFINITY, v_min = INFINITY, v_max = -INFINITY;
+            for (int i : palm_idx)
+            {
+                float x = pts[i * 3], y = pts[i * 3 + 1];
+                float u = x * c + y * s;  // along model input x axis
+                float v = -x * s + y * c; // along model input y axis, fingers to wrist
+                u_min = std::min(u_min, u);
+                u_max = std::max(u_max, u);
+                v_min = std::min(v_min, v);
+                v_max = std::max(v_max, v);
+            }
+            float u = (u_min + u_max) * 0.5;
+            float v = (v_min + v_max) * 0.5 - (v_max - v_min) * 0.1;
+            roi.cx = u * c - v * s;
+            roi.cy = u * s + v * c;
+            roi.size = std::max(u_max - u_min, v_max - v_min) * 2.0;
+            roi.theta = theta;
+            return roi.size >= 1 && roi.cx >= 0 && roi.cy >= 0 && roi.cx < img_w && roi.cy < img_h;
+        }
+
+        // set obj's box points and size from roi, affine is landmarks model input pixel to image pixel
+        void _set_hand_roi(nn::Object &obj, const HandROI &roi, bool landmarks_rel, int input_w, int input_h, float affine[6])
+        {
+            static const float A[4][2] = {{-1, -1}, {-1, 1}, {1, 1}, {1, -1}};
+            obj.points.resize(71 + (landmarks_rel ? 21 * 2 : 0), 0);
+            float half_w = roi.size * 0.5;
+            float c = cos(roi.theta), s = sin(roi.theta);
+            float C[4][2];
+            for (int i = 0; i < 4; ++i)
+            {
+                C[i][0] = (A[i][0] * c - A[i][1] * s) * half_w + roi.cx;
+                C[i][1] = (A[i][0] * s + A[i][1] * c) * half_w + roi.cy;
+                obj.points[i * 2] = C[i][0];
+                obj.points[i * 2 + 1] = C[i][1];
+            }
+            obj.x = roi.cx - half_w;
+            obj.y = roi.cy - half_w;
+            obj.w = roi.size;
+            obj.h = roi.size;
+            obj.angle = roi.theta + M_PI * 0.5;
+            // corner 0, 1, 2 map to (0, 0), (0, input_h), (input_w, input_h)
+            affine[0] = (C[2][0] - C[1][0]) / input_w;
+            affine[1] = (C[1][0] - C[0][0]) / input_h;
+            affine[2] = C[0][0];
+            affine[3] = (C[2][1] - C[1][1]) / input_w;
+            affine[4] = (C[1][1] - C[0][1]) / input_h;
+            affine[5] = C[0][1];
+        }
+
+        // range of u in [0, w) where floor(b + k * u + 0.5) in [0, limit), same expression as sampling
+        static void _affine_span(float b, float k, int limit, int w, int &lo, int &hi)
+        {
+            auto inside = [&](int u) {
+                float x = floorf(b + k * u + 0.5f);
+                return x >= 0 && x < limit;
+            };
+            if (k == 0)
+            {
+                if (inside(0))
+                    return;
+                lo = w;
+                hi = -1;
+                return;
+            }
+            float u0 = (-0.5f - b) / k, u1 = (limit - 0.5f - b) / k;
+            if (u0 > u1)
+                std::swap(u0, u1);
+            int l = (int)std::min(std::max(std::ceil(u0) - 1.0f, (float)lo), (float)hi + 1);
+            int h = (int)std::max(std::min(std::floor(u1) + 1.0f, (float)hi), (float)lo - 1);
+            while (l <= h && !inside(l))
+                ++l;
+            while (h >= l && !inside(h))
+                --h;
+            lo = l;
+            hi = h;
+        }
+
+        // nearest sample image into hwc input of landmarks model with affine, same as cv::warpAffine INTER_NEAREST,
+        // out of image is black
+        template <typename T>
+        static void _warp_hand(const uint8_t *src, int src_w, int src_h, const float affine[6], T *dst, int w, int h, const float *mean, const float *scale)
+        {
+            T pad[3];
+            for (int k = 0; k < 3; ++k)
+                pad[k] = mean ? (T)((0 - mean[k]) * scale[k]) : 0;
+            for (int v = 0; v < h; ++v)
+            {
+                float bx = affine[1] * v + affine[2];
+                float by = affine[4] * v + affine[5];
+                int lo = 0, hi = w - 1;
+                _affine_span(bx, affine[0], src_w, w, lo, hi);
+                _affine_span(by, affine[3], src_h, w, lo, hi);
+                T *d = dst + v * w * 3;
+                int u = 0;
+                for (; u < lo && u < w; ++u, d += 3)
+                {
+                    d[0] = pad[0];
+                    d[1] = pad[1];
+                    d[2] = pad[2];
+                }
+                for (; u <= hi; ++u, d += 3)
+                {
+                    int x = (int)floorf(bx + affine[0] * u + 0.5f);
+                    int y = (int)floorf(by + affine[3] * u + 0.5f);
+                    const uint8_t *p = src + (y * src_w + x) * 3;
+                    if (mean)
+                    {
+                        d[0] = (T)((p[0] - mean[0]) * scale[0]);
+                        d[1] = (T)((p[1] - mean[1]) * scale[1]);
+                        d[2] = (T)((p[2] - mean[2]) * scale[2]);
+                    }
+                    else
+                    {
+                        d[0] = p[0];
+                        d[1] = p[1];
+                        d[2] = p[2];
+                    }
+                }
+                for (; u < w; ++u, d += 3)
+                {
+                    d[0] = pad[0];
+                    d[1] = pad[1];
+                    d[2] = pad[2];
+                }
+            }
+        }
+
+        /**
+         * Warp all hands of _rois into landmarks model input tensor and forward batch size hands every time.
+         * @return true if have invalid hand(score set to 0).
+         */
+        bool _forward_landmarks(image::Image &img, nn::Objects &objs, float conf_th2, bool landmarks_rel)
+        {
+            nn::LayerInfo layer = _model->inputs_info()[0];
+            int batch = std::max(layer.shape[0], 1);
+            layer.shape[0] = batch;
+            if (layer.dtype != tensor::DType::FLOAT32 && layer.dtype != tensor::DType::UINT8)
+            {
+                throw err::Exception(err::ERR_NOT_IMPL, "landmarks model input dtype " + tensor::dtype_name[layer.dtype] + " not support");
+            }
+            if (!_input || _input->shape() != layer.shape || _input->dtype() != layer.dtype)
+            {
+                delete _input;
+                _input = nullptr;
+                _input = new tensor::Tensor(layer.shape, layer.dtype);
+            }
+            int input_w = _input_size.width();
+            int input_h = _input_size.height();
+            size_t hand_size = (size_t)input_w * input_h * 3;
+            size_t hand_bytes = hand_size * tensor::dtype_size[layer.dtype];
+            uint8_t *input_data = (uint8_t *)_input->data();
+            const uint8_t *src = (const uint8_t *)img.data();
+            _affines.resize(objs.size() * 6);
             for (size_t i = 0; i < objs.size(); ++i)
+                _set_hand_roi(objs.at(i), _rois[i], landmarks_rel, input_w, input_h, &_affines[i * 6]);
+
+            bool have_invalid = false;
+            for (size_t start = 0; start < objs.size(); start += batch)
             {
-                nn::Object &obj = objs.at(i);
-                float dy = -0.5 * sin(obj.angle);
-                int cx = (int)((obj.x + obj.w * 0.5 + obj.points[0]) * 0.5);
-                int cy = (int)((obj.y + obj.h * 0.5 + obj.w * dy + obj.points[1]) * 0.5);
-                // img.draw_circle(cx, cy, 5, image::COLOR_RED, -1);
-                // img.draw_circle(obj.points[0], obj.points[1], 5, image::COLOR_YELLOW, -1);
-                obj.points.resize(71 + (landmarks_rel ? 21 * 2 : 0), 0);
-                int hand_size = (int)(obj.w * dscale);
-                float theta = obj.angle - M_PI * 0.5;
-                cv::Mat A = (cv::Mat_<float>(4, 2) << -1, -1, -1, 1, 1, 1, 1, -1);
-                cv::Mat R = (cv::Mat_<float>(2, 2) << cos(theta), sin(theta), -sin(theta), cos(theta));
-                cv::Mat C;
-                float half_w = hand_size * 0.5;
-                cv::gemm(A, R, half_w, cv::Mat(), 0.0, C);
-                for (int i = 0; i < C.rows; ++i) {
-                    C.at<float>(i, 0) += cx;
-                    C.at<float>(i, 1) += cy;
-                    obj.points[i*2] = C.at<float>(i, 0);
-                    obj.points[1 + i*2] = C.at<float>(i, 1);
+                int n = std::min((int)(objs.size() - start), batch);
+                for (int i = 0; i < n; ++i)
+                {
+                    const float *affine = &_affines[(start + i) * 6];
+                    if (layer.dtype == tensor::DType::FLOAT32)
+                        _warp_hand<float>(src, img.width(), img.height(), affine, (float *)input_data + i * hand_size, input_w, input_h, this->mean.data(), this->scale.data());
+                    else
+                        _warp_hand<uint8_t>(src, img.width(), img.height(), affine, input_data + i * hand_size, input_w, input_h, nullptr, nullptr);
                 }
-                obj.x = cx - half_w;
-                obj.y = cy - half_w;
-                obj.w = hand_size;
-                obj.h = hand_size;
-                cv::Mat element = C(cv::Range(0, 3), cv::Range(0, 2));
-                cv::Mat dst = (cv::Mat_<float>(3, 2) << 0, 0, 0, input_h, input_w, input_h);
-                auto M = cv::getAffineTransform(element, dst);
-                image::Image *img_dst = new image::Image(input_w, input_h, image::FMT_RGB888);
-                if(!img_dst)
+                if (n < batch)
+                    memset(input_data + n * hand_bytes, 0, (batch - n) * hand_bytes);
+                tensor::Tensors inputs;
+                inputs.add_tensor(layer.name, _input, false, false);
+                tensor::Tensors outputs;
+                err::Err e = _model->forward(inputs, outputs, false, true);
+                if (e != err::ERR_NONE)
                 {
-                    log::error("no memory");
-                    break;
+                    throw err::Exception(e, "landmarks model forward failed");
                 }
-                cv::Mat img_dst2(input_h, input_w, CV_8UC3, img_dst->data());
-                cv::Mat img_src;
-                image::image2cv(img, img_src, false, false);
-                cv::warpAffine(img_src, img_dst2, M, cv::Size(input_w, input_h), cv::INTER_NEAREST);
-                assert(img_dst2.data() == img_dst->data());
-                res.push_back(img_dst);
-                cv::Mat iM;
-                cv::invertAffineTransform(M, iM);
-                M_inverse.push_back(iM);
-            }
-            return res;
+                for (int i = 0; i < n; ++i)
+                    have_invalid |= _decode_landmarks(objs, start + i, i, &outputs, conf_th2, &_affines[(start + i) * 6], landmarks_rel);
+            }
+            return have_invalid;
         }
 
-        bool _decode_landmarks(nn::Objects &objs, int idx, tensor::Tensors *outputs, float conf_th2, std::vector<cv::Mat> &M_inverse, int input_w, int input_h, int img_w, int img_h, bool landmarks_rel)
+        bool _decode_landmarks(nn::Objects &objs, int idx, int batch_idx, tensor::Tensors *outputs, float conf_th2, const float affine[6], bool landmarks_rel)
         {
-            tensor::Tensor *leftright_out = NULL;   // shape 1,  1, 1, 1
-            tensor::Tensor *score_out = NULL; // shape 1, 1, 1, 1
-            tensor::Tensor *points_out = NULL;   // shape 1,  63, 1, 1
+            tensor::Tensor *leftright_out = NULL;   // shape batch,  1, 1, 1
+            tensor::Tensor *score_out = NULL; // shape batch, 1, 1, 1
+            tensor::Tensor *points_out = NULL;   // shape batch,  63, 1, 1
             for (auto i : *outputs)
             {
                 if (i.second->shape()[1] == 63)
@@ -631,10 +827,14 @@ namespace maix::nn
             {
                 throw err::Exception(err::ERR_ARGS, "wrong model");
             }
+            if (points_out->shape()[0] <= batch_idx)
+            {
+                throw err::Exception(err::ERR_NOT_IMPL, "landmarks model output first dimension not batch size");
+            }
             auto &obj = objs.at(idx);
-            float score = _sigmoid(*(float*)score_out->data());
-            float leftright = _sigmoid(*(float*)leftright_out->data());
-            float *points = (float*)points_out->data();
+            float score = F::sigmoid(((float*)score_out->data())[batch_idx]);
+            float leftright = F::sigmoid(((float*)leftright_out->data())[batch_idx]);
+            float *points = (float*)points_out->data() + batch_idx * 63;
             if(score < conf_th2)
             {
                 obj.score = 0;
@@ -642,21 +842,12 @@ namespace maix::nn
             }
             obj.score = score;
             obj.class_id = leftright > 0.5 ? 1 : 0;
-            cv::Mat iM;
-            cv::transpose(M_inverse[idx], iM);
-            cv::Mat A = cv::Mat_<double>(21, 3);
-            for (int i = 0; i < A.rows; ++i) {
-                A.at<double>(i, 0) = points[i*3];
-                A.at<double>(i, 1) = points[i*3 + 1];
-                A.at<double>(i, 2) = 1;
+            for (int i = 0; i < 21; ++i) {
+                float x = points[i*3], y = points[i*3 + 1];
+                obj.points[8 + 3*i] = affine[0] * x + affine[1] * y + affine[2];
+                obj.points[9 + 3*i] = affine[3] * x + affine[4] * y + affine[5];
                 obj.points[8 + i*3 + 2] = (int)(-points[i*3 + 2] * obj.w);
             }
-            cv::Mat C;
-            cv::gemm(A, iM, 1.0, cv::Mat(), 0.0, C);
-            for (int i = 0; i < C.rows; ++i) {
-                obj.points[8 + 3*i] = C.at<double>(i, 0);
-                obj.points[9 + 3*i] = C.at<double>(i, 1);
-            }
             if(landmarks_rel)
             {
                 for (int i = 0; i < 21; ++i)
@@ -684,7 +875,7 @@ namespace maix::nn
                 {
                     nn::Object &b = objs.at(j);
                     {
-                        if (b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
+                        if (b.score != 0 && a.class_id == b.class_id && F::iou(a, b) > this->_iou_th)
                         {
                             b.score = 0;
                         }
@@ -701,49 +892,6 @@ namespace maix::nn
             return result;
         }
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
-        template <typename T>
-        static int _argmax(const T *data, size_t len, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = 1; i < len; i++)
-            {
-                int idx = i * stride;
-                if (data[maxIndex * stride] < data[idx])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
-        template <typename T>
-        static int _argmax2(const T *data, size_t end, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = stride; i < end; i += stride)
-            {
-                if (data[maxIndex] < data[i])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -660,21 +660,14 @@ namespace maix::nn
 
         static void _softmax_2xn(float *data, int size)
         {
+            // softmax of two values: p1 = sigmoid(p1 - p2), p2 = 1 - p1
             float *p1 = data;
             float *p2 = data + size;
-            float large;
-            float sum;
-            for(int i=0; i< size; ++i)
-            {
-                large = *p1 > *p2 ? *p1 : *p2;
-                *p1 = expf(*p1 - large);
-                *p2 = expf(*p2 - large);
-                sum = *p1 + *p2;
-                *p1 /= sum;
-                *p2 /= sum;
-                ++p1;
-                ++p2;
-            }
+            for (int i = 0; i < size; ++i)
+                p1[i] -= p2[i];
+            F::sigmoid(p1, p1, size);
+            for (int i = 0; i < size; ++i)
+                p2[i] = 1.0f - p1[i];
         }
     };
 
@@ -0,0 +1,398 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add asynchronous preprocess, forward, postprocess pipeline.
+ */
+
+#pragma once
+
+#include "maix_basic.hpp"
+#include "maix_nn.hpp"
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace maix::nn
+{
+    /**
+     * Time of one pipeline job, unit: us.
+     * @maixcdk maix.nn.PipelineTiming
+     */
+    class PipelineTiming
+    {
+    public:
+        uint64_t wait_us = 0;         // time waiting in queues for free stage
+        uint64_t preprocess_us = 0;   // resize, convert and normalize image
+        uint64_t forward_us = 0;      // model forward
+        uint64_t postprocess_us = 0;  // decode outputs
+        uint64_t total_us = 0;        // from submit to result ready
+    };
+
+    /**
+     * Three stages inference pipeline, preprocess, forward and postprocess run in their own threads,
+     * so preprocess of next image and postprocess of previous image overlap with forward of current image.
+     * At most depth jobs are in flight, submit blocks(or fails if not block) when pipeline is full,
+     * input buffers are allocated once for every in flight job, no alloc for input in steady state.
+     * Results are returned by std::future or callback(called in postprocess thread), in submit order.
+     *
+     * Usage:
+     *   nn::Pipeline<nn::Objects *> pipe(&model, [&](tensor::Tensors &outputs, int img_w, int img_h) {
+     *       return my_decode(outputs, img_w, img_h);
+     *   }, mean, scale, image::FIT_CONTAIN, true, 3);
+     *   std::future<nn::Objects *> res = pipe.submit(cam.read());
+     *   // ... submit more images, then res.get()
+     *
+     * Model and postprocess function should not be used by other threads while jobs are pending.
+     * @maixcdk maix.nn.Pipeline
+     */
+    template <typename R>
+    class Pipeline
+    {
+    public:
+        /**
+         * Decode model outputs of one image.
+         * outputs valid only in this call, img_w and img_h are size of submitted image.
+         */
+        typedef std::function<R(tensor::Tensors &outputs, int img_w, int img_h)> PostProcess;
+
+        /**
+         * Result callback, id is value returned by last_id() after submit.
+         * Callback and future get the same result, if R is pointer, only one of them should delete it.
+         */
+        typedef std::function<void(uint64_t id, R &result, const PipelineTiming &timing)> Callback;
+
+        /**
+         * Pipeline constructor, start stage threads.
+         * @param model loaded model, should be valid until pipeline destroyed.
+         * @param post postprocess function.
+         * @param mean mean value, empty means not normalize, see NN::forward_image.
+         * @param scale scale value, empty means not normalize.
+         * @param fit fit mode when image size not equal to model input size.
+         * @param chw input channel format, false means hwc.
+         * @param depth max jobs in flight, >= 1, 2 or 3 is enough to keep model busy.
+         * @maixcdk maix.nn.Pipeline.Pipeline
+         */
+        Pipeline(nn::NN *model, PostProcess post, const std::vector<float> &mean = std::vector<float>(), const std::vector<float> &scale = std::vector<float>(),
+                 image::Fit fit = image::Fit::FIT_CONTAIN, bool chw = true, int depth = 2)
+            : _model(model), _post(post), _mean(mean), _scale(scale), _fit(fit), _chw(chw)
+        {
+            if (!model || !model->loaded())
+                throw err::Exception(err::ERR_ARGS, "model not loaded");
+            _depth = depth < 1 ? 1 : depth;
+            _input = model->inputs_info()[0];
+            if (!_input.shape.empty())
+                _input.shape[0] = 1;
+            int bytes = model->input_image_bytes();
+            _slots.resize(_depth);
+            for (int i = 0; i < _depth; ++i)
+            {
+                _slots[i].resize(bytes);
+                _free_slots.push_back(i);
+            }
+            _threads[0] = std::thread(&Pipeline::_preprocess_loop, this);
+            _threads[1] = std::thread(&Pipeline::_forward_loop, this);
+            _threads[2] = std::thread(&Pipeline::_postprocess_loop, this);
+        }
+
+        /**
+         * Wait pending jobs and stop threads.
+         */
+        ~Pipeline()
+        {
+            wait();
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _exit = true;
+            }
+            _cond.notify_all();
+            for (auto &t : _threads)
+                t.join();
+        }
+
+        /**
+         * Submit one image.
+         * @param img image, if auto_delete is false, should be valid until its preprocess finished(result ready is safe).
+         * @param auto_delete delete img after preprocess(or when rejected because pipeline is full), useful for images read from camera.
+         * @param callback called with result in postprocess thread, nullptr means only use returned future.
+         * @param block true to wait when depth jobs in flight, false to return invalid future immediately.
+         * @return future of result, valid() is false if not block and pipeline is full,
+         *         get() raises the exception if preprocess, forward or postprocess failed.
+         * @maixcdk maix.nn.Pipeline.submit
+         */
+        std::future<R> submit(image::Image *img, bool auto_delete = true, Callback callback = nullptr, bool block = true)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            if (_in_flight >= _depth)
+            {
+                if (!block)
+                {
+                    if (auto_delete)
+                        delete img;
+                    return std::future<R>();
+                }
+                _cond.wait(lock, [this] { return _in_flight < _depth; });
+            }
+            _Job *job = new _Job();
+            job->id = ++_last_id;
+            job->img = img;
+            job->auto_delete = auto_delete;
+            job->img_w = img->width();
+            job->img_h = img->height();
+            job->callback = callback;
+            job->t_submit = time::ticks_us();
+            std::future<R> f = job->promise.get_future();
+            ++_in_flight;
+            _queues[0].push_back(job);
+            lock.unlock();
+            _cond.notify_all();
+            return f;
+        }
+
+        /**
+         * Id of last submitted job, passed to callback to match result.
+         * @maixcdk maix.nn.Pipeline.last_id
+         */
+        uint64_t last_id()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _last_id;
+        }
+
+        /**
+         * Jobs submitted but result not ready.
+         * @maixcdk maix.nn.Pipeline.pending
+         */
+        int pending()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _in_flight;
+        }
+
+        /**
+         * Wait all submitted jobs finish.
+         * @maixcdk maix.nn.Pipeline.wait
+         */
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _cond.wait(lock, [this] { return _in_flight == 0; });
+        }
+
+        /**
+         * Average time of finished jobs since created or reset_timing called.
+         * @maixcdk maix.nn.Pipeline.timing
+         */
+        PipelineTiming timing()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            PipelineTiming t;
+            if (_done == 0)
+                return t;
+            t.wait_us = _sum.wait_us / _done;
+            t.preprocess_us = _sum.preprocess_us / _done;
+            t.forward_us = _sum.forward_us / _done;
+            t.postprocess_us = _sum.postprocess_us / _done;
+            t.total_us = _sum.total_us / _done;
+            return t;
+        }
+
+        /**
+         * Clear timing statistics.
+         * @maixcdk maix.nn.Pipeline.reset_timing
+         */
+        void reset_timing()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _sum = PipelineTiming();
+            _done = 0;
+        }
+
+    private:
+        class _Job
+        {
+        public:
+            uint64_t id;
+            image::Image *img;
+            bool auto_delete;
+            int img_w;
+            int img_h;
+            int slot = -1;
+            Callback callback;
+            std::promise<R> promise;
+            tensor::Tensors *outputs = nullptr;
+            PipelineTiming timing;
+            uint64_t t_submit;
+            uint64_t t_stage;  // time entered current queue
+        };
+
+        // pop job of stage queue, nullptr when exit
+        _Job *_pop(int stage)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _cond.wait(lock, [this, stage] { return _exit || !_queues[stage].empty(); });
+            if (_queues[stage].empty())
+                return nullptr;
+            _Job *job = _queues[stage].front();
+            _queues[stage].pop_front();
+            return job;
+        }
+
+        void _push(int stage, _Job *job)
+        {
+            job->t_stage = time::ticks_us();
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _queues[stage].push_back(job);
+            }
+            _cond.notify_all();
+        }
+
+        void _release_slot(_Job *job)
+        {
+            if (job->slot < 0)
+                return;
+            std::lock_guard<std::mutex> lock(_lock);
+            _free_slots.push_back(job->slot);
+            job->slot = -1;
+        }
+
+        void _finish(_Job *job)
+        {
+            _release_slot(job);
+            delete job->outputs;
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                --_in_flight;
+            }
+            _cond.notify_all();
+            delete job;
+        }
+
+        void _fail(_Job *job)
+        {
+            if (job->img && job->auto_delete)
+                delete job->img;
+            job->img = nullptr;
+            job->promise.set_exception(std::current_exception());
+            _finish(job);
+        }
+
+        void _preprocess_loop()
+        {
+            while (_Job *job = _pop(0))
+            {
+                uint64_t t = time::ticks_us();
+                job->timing.wait_us += t - job->t_submit;
+                try
+                {
+                    {
+                        // in flight jobs <= depth, so always have a free slot
+                        std::lock_guard<std::mutex> lock(_lock);
+                        job->slot = _free_slots.front();
+                        _free_slots.pop_front();
+                    }
+                    err::Err e = _model->preprocess_image(*job->img, _slots[job->slot].data(), _mean, _scale, _fit, _chw);
+                    if (e != err::ERR_NONE)
+                        throw err::Exception(e, "preprocess image failed");
+                }
+                catch (...)
+                {
+                    _fail(job);
+                    continue;
+                }
+                if (job->auto_delete)
+                    delete job->img;
+                job->img = nullptr;
+                job->timing.preprocess_us = time::ticks_us() - t;
+                _push(1, job);
+            }
+        }
+
+        void _forward_loop()
+        {
+            while (_Job *job = _pop(1))
+            {
+                uint64_t t = time::ticks_us();
+                job->timing.wait_us += t - job->t_stage;
+                try
+                {
+                    tensor::Tensor input(_input.shape, _input.dtype, _slots[job->slot].data(), false);
+                    tensor::Tensors inputs;
+                    inputs.add_tensor(_input.name, &input, false, false);
+                    job->outputs = new tensor::Tensors();
+                    // copy result, postprocess runs while next forward
+                    err::Err e = _model->forward(inputs, *job->outputs, true, true);
+                    if (e != err::ERR_NONE)
+                        throw err::Exception(e, "forward failed");
+                }
+                catch (...)
+                {
+                    _fail(job);
+                    continue;
+                }
+                _release_slot(job);
+                job->timing.forward_us = time::ticks_us() - t;
+                _push(2, job);
+            }
+        }
+
+        void _postprocess_loop()
+        {
+            while (_Job *job = _pop(2))
+            {
+                uint64_t t = time::ticks_us();
+                job->timing.wait_us += t - job->t_stage;
+                try
+                {
+                    R result = _post(*job->outputs, job->img_w, job->img_h);
+                    uint64_t now = time::ticks_us();
+                    job->timing.postprocess_us = now - t;
+                    job->timing.total_us = now - job->t_submit;
+                    {
+                        std::lock_guard<std::mutex> lock(_lock);
+                        _sum.wait_us += job->timing.wait_us;
+                        _sum.preprocess_us += job->timing.preprocess_us;
+                        _sum.forward_us += job->timing.forward_us;
+                        _sum.postprocess_us += job->timing.postprocess_us;
+                        _sum.total_us += job->timing.total_us;
+                        ++_done;
+                    }
+                    if (job->callback)
+                        job->callback(job->id, result, job->timing);
+                    job->promise.set_value(result);
+                }
+                catch (...)
+                {
+                    _fail(job);
+                    continue;
+                }
+                _finish(job);
+            }
+        }
+
+        nn::NN *_model;
+        PostProcess _post;
+        std::vector<float> _mean;
+        std::vector<float> _scale;
+        image::Fit _fit;
+        bool _chw;
+        int _depth;
+        nn::LayerInfo _input;
+        std::vector<std::vector<uint8_t>> _slots;
+        std::deque<int> _free_slots;
+        std::deque<_Job *> _queues[3];
+        std::thread _threads[3];
+        std::mutex _lock;
+        std::condition_variable _cond;
+        int _in_flight = 0;
+        uint64_t _last_id = 0;
+        uint64_t _done = 0;
+        PipelineTiming _sum;
+        bool _exit = false;
+    };
+
+} // namespace maix::nn
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2024.9.19: Add PP OCR support
+ * @update 2026.10.18: Recognize text lines in batch, warp lines into model input directly.
  */
 
 #pragma once
@@ -33,6 +34,7 @@ namespace maix::nn
         {
             _model = nullptr;
             _rec_model = nullptr;
+            _priv = nullptr;
             this->det = false;
             this->rec = false;
             if (!model.empty())
@@ -57,6 +59,7 @@ namespace maix::nn
                 delete _rec_model;
                 _rec_model = nullptr;
             }
+            _free_priv();
         }
 
         /**
@@ -319,11 +322,13 @@ namespace maix::nn
          * @param box_thresh Box threshold, the box prob higher than this value will be valid, default 0.6.
          * @param fit Resize method, default image.Fit.FIT_CONTAIN.
          * @param char_box Calculate every charactor's box, default false, if true then you can get charactor's box by nn.OCR_Object's char_boxes attribute.
+         * @param rec_batch Text lines recognized together by one forward, default 0 means use batch size(first dimension) of rec model input,
+         *                  set value > 1 for rec model with dynamic batch size. Lines wider than rec model input are splitted to several lines.
          * @throw If image format not match model input format or no memory, will throw err::Exception.
          * @return nn.OCR_Objects type. In C++, you should delete it after use.
          * @maixpy maix.nn.PP_OCR.detect
         */
-        nn::OCR_Objects *detect(image::Image &img, float thresh = 0.3, float box_thresh = 0.6, maix::image::Fit fit = maix::image::FIT_CONTAIN, bool char_box = false)
+        nn::OCR_Objects *detect(image::Image &img, float thresh = 0.3, float box_thresh = 0.6, maix::image::Fit fit = maix::image::FIT_CONTAIN, bool char_box = false, int rec_batch = 0)
         {
             if(!this->det)
             {
@@ -341,7 +346,7 @@ namespace maix::nn
             {
                 return new nn::OCR_Objects();
             }
-            nn::OCR_Objects *res = _post_process(img, outputs, img.width(), img.height(), fit);
+            nn::OCR_Objects *res = _post_process(img, outputs, img.width(), img.height(), fit, rec_batch);
             delete outputs;
             if(res == NULL)
             {
@@ -385,8 +390,15 @@ namespace maix::nn
             {
                 throw err::Exception(err::ERR_NO_MEM);
             }
-            _recognize(img, box, obj->idx_list, char_list, obj->char_pos, crop);
-            obj->update_chars(char_list);
+            try
+            {
+                _recognize_lines(img, &obj, 1, crop, 0);
+            }
+            catch (...)
+            {
+                delete obj;
+                throw;
+            }
             return obj;
         }
 
@@ -527,6 +539,7 @@ namespace maix::nn
         std::string _score_mode = "fast";
         int _max_ch_num;
         int _prob_num;
+        void *_priv; // scratch memory of post process and recognize, see maix_nn_pp_ocr.cpp
 
     private:
         err::Err _load_labels_from_file(std::vector<std::string> &labels, const std::string &label_path)
@@ -552,9 +565,13 @@ namespace maix::nn
             return err::ERR_NONE;
         }
 
-        nn::OCR_Objects *_post_process(image::Image &img, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit);
+        nn::OCR_Objects *_post_process(image::Image &img, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit, int rec_batch);
 
-        void _recognize(image::Image &img, const nn::OCR_Box &box, std::vector<int> &idx_list, std::vector<std::string> &char_list, std::vector<int> &char_pos, bool crop);
+        // recognize charactors of text boxes, all lines are warped into batch input tensor and forwarded together,
+        // results are set to objs' idx_list, char_pos and chars.
+        void _recognize_lines(image::Image &img, nn::OCR_Object **objs, int num, bool crop, int batch);
+
+        void _free_priv();
 
         // void _get_layer_objs(std::vector<nn::Object> &objs, tensor::Tensor &output, int layer_i, int layer_num)
         // {
@@ -650,35 +667,6 @@ namespace maix::nn
 
         void _correct_bbox(nn::OCR_Objects &objs, int img_w, int img_h, maix::image::Fit fit);
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
-        template <typename T>
-        static int _argmax(const T *data, size_t len, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = 1; i < len; i++)
-            {
-                int idx = i * stride;
-                if (data[maxIndex * stride] < data[idx])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -343,7 +343,7 @@ namespace maix::nn
                 for (int j = i + 1; j < num; ++j)
                 {
                     nn::Object &b = objs.at(j);
-                    if (b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
+                    if (b.score != 0 && a.class_id == b.class_id && F::iou(a, b) > this->_iou_th)
                     {
                         b.score = 0;
                     }
@@ -427,35 +427,6 @@ namespace maix::nn
             }
         }
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
-        template <typename T>
-        static int _argmax(const T *data, size_t len, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = 1; i < len; i++)
-            {
-                int idx = i * stride;
-                if (data[maxIndex * stride] < data[idx])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -0,0 +1,97 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add shared YOLOv8/YOLO11 decode and NMS engine.
+ */
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+namespace maix::nn
+{
+    /**
+     * Candidate box decoded from YOLOv8/YOLO11 outputs, in model input coordinate.
+     * Also used as Object::temp to decode keypoints and seg mask after NMS, owned by YOLOv8Decoder.
+     */
+    class YOLOCandidate
+    {
+    public:
+        float x;
+        float y;
+        float w;
+        float h;
+        float score;
+        float angle;
+        int class_id;
+        int idx;      // anchor index in model outputs
+        int anchor_x;
+        int anchor_y;
+        float stride;
+    };
+
+    /**
+     * Decode and NMS engine shared by YOLOv8 and YOLO11.
+     * All buffers are kept across calls so steady state post process not alloc memory.
+     */
+    class YOLOv8Decoder
+    {
+    public:
+        /**
+         * Find max score class of every anchor from class plane major scores(shape [class_num, anchor_num]),
+         * planes are scanned contiguously with SIMD, scores <= conf_th are rejected while scanning.
+         * @param scores scores data, class_num planes, every plane has anchor_num elements.
+         * @param class_num class number.
+         * @param anchor_num anchor number.
+         * @param conf_th confidence threshold.
+         */
+        void max_scores(const float *scores, int class_num, int anchor_num, float conf_th);
+
+        /**
+         * Max score of anchor, valid after max_scores called.
+         */
+        float score(int anchor) const { return _max_scores[anchor]; }
+
+        /**
+         * Max score class id of anchor, valid after max_scores called.
+         * @return class id, -1 means all class scores of this anchor <= conf_th.
+         */
+        int class_id(int anchor) const { return _class_ids[anchor]; }
+
+        /**
+         * Clear candidates, keep memory.
+         */
+        void clear() { candidates.clear(); }
+
+        /**
+         * Add one candidate, returned reference valid until next add or clear.
+         */
+        YOLOCandidate &add(float x, float y, float w, float h, int class_id, float score, int idx, int anchor_x, int anchor_y, float stride, float angle = -1)
+        {
+            candidates.push_back(YOLOCandidate{x, y, w, h, score, angle, class_id, idx, anchor_x, anchor_y, stride});
+            return candidates.back();
+        }
+
+        /**
+         * Per class NMS, candidates are bucketed by class id and swept in score descending order.
+         * @param iou_th IoU threshold.
+         * @return kept candidates indices in score descending order, valid until next nms call.
+         */
+        const std::vector<int> &nms(float iou_th);
+
+        /**
+         * Decoded candidates.
+         */
+        std::vector<YOLOCandidate> candidates;
+
+    private:
+        std::vector<float> _max_scores;
+        std::vector<int32_t> _class_ids;
+        std::vector<int> _order;
+        std::vector<int> _keep;
+        std::vector<uint8_t> _suppressed;
+    };
+
+} // namespace maix::nn
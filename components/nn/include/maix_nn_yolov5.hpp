@@ -404,18 +404,18 @@ namespace maix::nn
                     for (int x = 0; x < w; ++x)
                     {
                         float *p = data + a * anchor_stride + y * w + x + s4;
-                        float obj_score = _sigmoid(*p);
+                        float obj_score = F::sigmoid(*p);
                         if (obj_score <= _conf_th)
                             continue;
                         float *cls_scores = p + s;
-                        int class_id = _argmax(cls_scores, class_num, s);
-                        obj_score *= _sigmoid(cls_scores[class_id * s]);
+                        int class_id = F::argmax(cls_scores, class_num, s);
+                        obj_score *= F::sigmoid(cls_scores[class_id * s]);
                         if (obj_score <= _conf_th)
                             continue;
-                        float bbox_x = (_sigmoid(*(p - s4)) * 2 + x - 0.5) * scale_x;
-                        float bbox_y = (_sigmoid(*(p - s3)) * 2 + y - 0.5) * scale_y;
-                        float bbox_w = pow(_sigmoid(*(p - s2)) * 2, 2) * this->anchors[anchor_start + a * 2];
-                        float bbox_h = pow(_sigmoid(*(p - s)) * 2, 2) * this->anchors[anchor_start + a * 2 + 1];
+                        float bbox_x = (F::sigmoid(*(p - s4)) * 2 + x - 0.5) * scale_x;
+                        float bbox_y = (F::sigmoid(*(p - s3)) * 2 + y - 0.5) * scale_y;
+                        float bbox_w = pow(F::sigmoid(*(p - s2)) * 2, 2) * this->anchors[anchor_start + a * 2];
+                        float bbox_h = pow(F::sigmoid(*(p - s)) * 2, 2) * this->anchors[anchor_start + a * 2 + 1];
                         bbox_x -= bbox_w * 0.5; // center x to left top x
                         bbox_y -= bbox_h * 0.5; // center y to left top y
                         Object obj(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score);
@@ -439,7 +439,7 @@ namespace maix::nn
                 for(size_t j = i + 1; j < objs.size(); ++j)
                 {
                     nn::Object &b = objs.at(j);
-                    if(b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
+                    if(b.score != 0 && a.class_id == b.class_id && F::iou(a, b) > this->_iou_th)
                     {
                         b.score = 0;
                     }
@@ -563,35 +563,6 @@ namespace maix::nn
             }
         }
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
-        template <typename T>
-        static int _argmax(const T *data, size_t len, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = 1; i < len; i++)
-            {
-                int idx = i * stride;
-                if (data[maxIndex * stride] < data[idx])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -11,7 +11,10 @@
 #include "maix_image.hpp"
 #include "maix_nn_F.hpp"
 #include "maix_nn_object.hpp"
+#include "maix_nn_yolo_decoder.hpp"
+#include "maix_nn_pipeline.hpp"
 #include <math.h>
+#include <memory>
 
 namespace maix::nn
 {
@@ -23,19 +26,6 @@ namespace maix::nn
         OBB = 3
     };
 
-    class _KpInfo
-    {
-    public:
-        _KpInfo(int idx, int ax, int ay, float stride)
-            : idx(idx), anchor_x(ax), anchor_y(ay), stride(stride)
-        {
-        }
-        int idx;
-        int anchor_x;
-        int anchor_y;
-        float stride;
-    };
-
     /**
      * YOLOv8 class
      * @maixpy maix.nn.YOLOv8
@@ -226,6 +216,7 @@ namespace maix::nn
             std::vector<nn::LayerInfo> inputs = _model->inputs_info();
             _input_size = image::Size(inputs[0].shape[3], inputs[0].shape[2]);
             log::print("\tinput size: %dx%d\n\n", _input_size.width(), _input_size.height());
+            _resolve_outputs();
             return err::ERR_NONE;
         }
 
@@ -244,9 +235,9 @@ namespace maix::nn
          */
         nn::Objects *detect(image::Image &img, float conf_th = 0.5, float iou_th = 0.45, maix::image::Fit fit = maix::image::FIT_CONTAIN, float keypoint_th = 0.5, int sort = 0)
         {
-            this->_conf_th = conf_th;
-            this->_iou_th = iou_th;
-            this->_keypoint_th = keypoint_th;
+            _post.conf_th = conf_th;
+            _post.iou_th = iou_th;
+            _post.keypoint_th = keypoint_th;
             if (img.format() != _input_img_fmt)
             {
                 throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img.format()]);
@@ -257,7 +248,7 @@ namespace maix::nn
             {
                 return new nn::Objects();
             }
-            nn::Objects *res = _post_process(outputs, img.width(), img.height(), fit, sort);
+            nn::Objects *res = _post_process(_post, outputs, img.width(), img.height(), fit, sort);
             delete outputs;
             if(!res)
             {
@@ -266,6 +257,81 @@ namespace maix::nn
             return res;
         }
 
+        /**
+         * Detect objects from a batch of images, images are forwarded together if model input batch size > 1, see NN::forward_batch.
+         * @param imgs Images want to detect, if image's size not match model input's, will auto resize with fit method.
+         * @param conf_th Confidence threshold, default 0.5.
+         * @param iou_th IoU threshold, default 0.45.
+         * @param fit Resize method, default image.Fit.FIT_CONTAIN.
+         * @param keypoint_th keypoint threshold, default 0.5, only for pose model.
+         * @param sort sort result according to object size, default 0 means not sort, 1 means bigger in front, -1 means smaller in front.
+         * @throw If image format not match model input format or forward failed, will throw err::Exception.
+         * @return Object list of every image, same order as imgs. In C++, you should delete every element after use.
+         * @maixpy maix.nn.YOLOv8.detect_batch
+         */
+        std::vector<nn::Objects *> detect_batch(std::vector<image::Image *> imgs, float conf_th = 0.5, float iou_th = 0.45, maix::image::Fit fit = maix::image::FIT_CONTAIN, float keypoint_th = 0.5, int sort = 0)
+        {
+            _post.conf_th = conf_th;
+            _post.iou_th = iou_th;
+            _post.keypoint_th = keypoint_th;
+            for (auto img : imgs)
+            {
+                if (img->format() != _input_img_fmt)
+                {
+                    throw err::Exception("image format not match, input_type: " + image::fmt_names[_input_img_fmt] + ", image format: " + image::fmt_names[img->format()]);
+                }
+            }
+            std::vector<tensor::Tensors *> raw_outputs = _model->forward_batch(imgs, this->mean, this->scale, fit);
+            // owned until returned, post process may throw
+            std::vector<std::unique_ptr<tensor::Tensors>> outputs(raw_outputs.begin(), raw_outputs.end());
+            std::vector<std::unique_ptr<nn::Objects>> objs(imgs.size());
+            for (size_t i = 0; i < imgs.size(); ++i)
+            {
+                objs[i].reset(_post_process(_post, outputs[i].get(), imgs[i]->width(), imgs[i]->height(), fit, sort));
+                if (!objs[i])
+                    throw err::Exception("post process failed, please see log before");
+                outputs[i].reset();
+            }
+            std::vector<nn::Objects *> res;
+            res.reserve(objs.size());
+            for (auto &obj : objs)
+                res.push_back(obj.release());
+            return res;
+        }
+
+        /**
+         * Create asynchronous detect pipeline, preprocess, forward and post process of submitted images run in their own threads.
+         * Any image format can be submitted, YUV frames from camera are preprocessed without RGB conversion.
+         * Post process runs with its own decoder buffers and the thresholds given here, detect and detect_batch not affect it.
+         * @param depth max images in flight, see nn::Pipeline.
+         * @param conf_th Confidence threshold, default 0.5.
+         * @param iou_th IoU threshold, default 0.45.
+         * @param fit Resize method, default image.Fit.FIT_CONTAIN.
+         * @param keypoint_th keypoint threshold, default 0.5, only for pose model.
+         * @param sort sort result according to object size, default 0 means not sort.
+         * @return pipeline, result of every image is nn::Objects pointer, should delete it after use.
+         *         In C++, you should delete pipeline after use, and before delete this object.
+         * @maixcdk maix.nn.YOLOv8.pipeline
+         */
+        nn::Pipeline<nn::Objects *> *pipeline(int depth = 2, float conf_th = 0.5, float iou_th = 0.45, maix::image::Fit fit = maix::image::FIT_CONTAIN, float keypoint_th = 0.5, int sort = 0)
+        {
+            // post process runs in pipeline thread, not share decoder and output refs with detect
+            std::shared_ptr<_PostState> st = std::make_shared<_PostState>();
+            st->box_ref = _post.box_ref;
+            st->score_ref = _post.score_ref;
+            st->mask_ref = _post.mask_ref;
+            st->kp_ref = _post.kp_ref;
+            st->conf_th = conf_th;
+            st->iou_th = iou_th;
+            st->keypoint_th = keypoint_th;
+            return new nn::Pipeline<nn::Objects *>(_model, [this, st, fit, sort](tensor::Tensors &outputs, int img_w, int img_h) {
+                nn::Objects *res = _post_process(*st, &outputs, img_w, img_h, fit, sort);
+                if (!res)
+                    throw err::Exception("post process failed, please see log before");
+                return res;
+            }, this->mean, this->scale, fit, true, depth);
+        }
+
         /**
          * Get model input size
          * @return model input size
@@ -442,12 +508,23 @@ namespace maix::nn
         image::Format _input_img_fmt;
         nn::NN *_model;
         std::map<string, string> _extra_info;
-        float _conf_th = 0.5;
-        float _iou_th = 0.45;
-        float _keypoint_th = 0.5;
         YOLOv8_Type _type;
         bool _dual_buff;
 
+        // decoder buffers, output refs and thresholds of one post process thread
+        struct _PostState
+        {
+            nn::YOLOv8Decoder decoder; // keep buffers across calls
+            tensor::TensorRef box_ref;
+            tensor::TensorRef score_ref;
+            tensor::TensorRef mask_ref;
+            tensor::TensorRef kp_ref;
+            float conf_th = 0.5;
+            float iou_th = 0.45;
+            float keypoint_th = 0.5;
+        };
+        _PostState _post; // for detect and detect_batch, every pipeline has its own
+
     private:
         err::Err _load_labels_from_file(std::vector<std::string> &labels, const std::string &label_path)
         {
@@ -472,33 +549,26 @@ namespace maix::nn
             return err::ERR_NONE;
         }
 
-        nn::Objects *_post_process(tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit, int sort)
+        nn::Objects *_post_process(_PostState &st, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit, int sort)
         {
-            nn::Objects *objects = new nn::Objects();
             tensor::Tensor *kp_out = NULL;
             tensor::Tensor *mask_out = NULL;
             float scale_w = 1;
             float scale_h = 1;
 
-            if(!_decode_objs(*objects, outputs, _conf_th, _input_size.width(), _input_size.height(), &kp_out, &mask_out))
+            if(!_decode_objs(st, outputs, _input_size.width(), _input_size.height(), &kp_out, &mask_out))
             {
-                delete objects;
                 return NULL;
             }
-            if (objects->size() > 0)
+            nn::Objects *objects = _nms(st);
+            if (objects->size() > 0 && sort != 0)
             {
-                nn::Objects *objects_total = objects;
-                objects = _nms(*objects);
-                delete objects_total;
-                if(sort != 0)
-                {
-                    _sort_objects(*objects, sort);
-                }
+                _sort_objects(*objects, sort);
             }
             // decode keypoints
             if (_type == YOLOv8_Type::POSE)
             {
-                _decode_keypoints(*objects, kp_out);
+                _decode_keypoints(*objects, kp_out, st.keypoint_th);
             }
             else if (_type == YOLOv8_Type::SEG)
             {
@@ -511,39 +581,58 @@ namespace maix::nn
             return objects;
         }
 
-        bool _decode_objs(nn::Objects &objs, tensor::Tensors *outputs, float conf_thresh, int w, int h, tensor::Tensor **kp_out, tensor::Tensor **mask_out)
+        // outputs are found by name and shape once when model loaded, same rules as searching outputs in name order
+        void _resolve_outputs()
         {
-            float stride[3] = {8, 16, 32};
-            tensor::Tensor *score_out = NULL; // shape 1, 80, 8400, 1
-            tensor::Tensor *box_out = NULL;   // shape 1,  1,    4, 8400
-            for (auto i : *outputs)
+            std::vector<nn::LayerInfo> outputs = _model->outputs_info();
+            std::sort(outputs.begin(), outputs.end(), [](const nn::LayerInfo &a, const nn::LayerInfo &b) { return a.name < b.name; });
+            _post.box_ref = tensor::TensorRef();
+            _post.score_ref = tensor::TensorRef();
+            _post.mask_ref = tensor::TensorRef();
+            _post.kp_ref = tensor::TensorRef();
+            for (auto &layer : outputs)
             {
-                if (i.second->shape()[2] == 4 && !box_out)
+                if (layer.shape.size() > 2 && layer.shape[2] == 4 && !_post.box_ref.valid())
                 {
-                    box_out = i.second;
+                    _post.box_ref = tensor::TensorRef(layer.name);
                 }
-                else if (strstr(i.first.c_str(), "Sigmoid") != NULL && !score_out)
+                else if (layer.name.find("Sigmoid") != std::string::npos && !_post.score_ref.valid())
                 {
-                    score_out = i.second;
-                    if((size_t)score_out->shape()[1] != labels.size())
-                    {
-                        log::error("MUD labels(%d) must equal model's(%d)", score_out->shape()[1], labels.size());
-                        return false;
-                    }
+                    _post.score_ref = tensor::TensorRef(layer.name);
                 }
-                else if (strstr(i.first.c_str(), "output1") != NULL)
+                else if (layer.name.find("output1") != std::string::npos)
                 {
-                    *mask_out = i.second;
+                    _post.mask_ref = tensor::TensorRef(layer.name);
                 }
                 else
                 {
-                    *kp_out = i.second;
+                    _post.kp_ref = tensor::TensorRef(layer.name);
                 }
             }
+        }
+
+        bool _decode_objs(_PostState &st, tensor::Tensors *outputs, int w, int h, tensor::Tensor **kp_out, tensor::Tensor **mask_out)
+        {
+            float stride[3] = {8, 16, 32};
+            tensor::Tensor *score_out = st.score_ref.get(*outputs); // shape 1, 80, 8400, 1
+            tensor::Tensor *box_out = st.box_ref.get(*outputs);     // shape 1,  1,    4, 8400
+            if (st.mask_ref.valid())
+            {
+                *mask_out = st.mask_ref.get(*outputs);
+            }
+            if (st.kp_ref.valid())
+            {
+                *kp_out = st.kp_ref.get(*outputs);
+            }
             if (!score_out || !box_out)
             {
                 throw err::Exception(err::ERR_ARGS, "model output not valid");
             }
+            if((size_t)score_out->shape()[1] != labels.size())
+            {
+                log::error("MUD labels(%d) must equal model's(%d)", score_out->shape()[1], labels.size());
+                return false;
+            }
             int total_box_num = box_out->shape()[3];
             // int class_num = this->labels.size();
             int class_num = score_out->shape()[1];
@@ -553,7 +642,9 @@ namespace maix::nn
                 0,
                 (int)(h / stride[0] * w / stride[0]),
                 (int)(h / stride[0] * w / stride[0] + h / stride[1] * w / stride[1])};
-                        if (_type == YOLOv8_Type::OBB)
+            st.decoder.clear();
+            st.decoder.max_scores(scores_ptr, class_num, total_box_num, st.conf_th);
+            if (_type == YOLOv8_Type::OBB)
             {
                 float *angle_ptr = (float *)(*kp_out)->data();
                 for (int i = 0; i < 3; i++)
@@ -565,14 +656,12 @@ namespace maix::nn
                         for (int ax = 0; ax < nw; ++ax)
                         {
                             int offset = idx_start[i] + ay * nw + ax;
-                            int class_id = _argmax(scores_ptr + offset, class_num, total_box_num);
-                            // int max_idx = _argmax2(scores_ptr + offset, class_num * total_box_num - offset, total_box_num);
-                            // int class_id = (offset + max_idx) / total_box_num;
-                            float obj_score = scores_ptr[offset + class_id * total_box_num];
-                            if (obj_score <= conf_thresh)
+                            int class_id = st.decoder.class_id(offset);
+                            if (class_id < 0)
                             {
                                 continue;
                             }
+                            float obj_score = st.decoder.score(offset);
                             float angle = (angle_ptr[offset] - 0.25);
                             float angle_rad = angle * M_PI;
                             float cos_angle = cosf(angle_rad);
@@ -587,9 +676,7 @@ namespace maix::nn
                             float bbox_h = (lt_y + rb_y) * stride[i];
                             float bbox_x = ((xf * cos_angle - yf * sin_angle) + ax + 0.5) * stride[i] - bbox_w * 0.5;
                             float bbox_y = ((xf * sin_angle + yf * cos_angle) + ay + 0.5) * stride[i] - bbox_h * 0.5;
-                            _KpInfo *kp_info = new _KpInfo(offset, ax, ay, stride[i]);
-                            Object &obj = objs.add(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score, {}, angle);
-                            obj.temp = (void *)kp_info;
+                            st.decoder.add(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score, offset, ax, ay, stride[i], angle);
                         }
                     }
                 }
@@ -605,21 +692,17 @@ namespace maix::nn
                         for (int ax = 0; ax < nw; ++ax)
                         {
                             int offset = idx_start[i] + ay * nw + ax;
-                            int class_id = _argmax(scores_ptr + offset, class_num, total_box_num);
-                            // int max_idx = _argmax2(scores_ptr + offset, class_num * total_box_num - offset, total_box_num);
-                            // int class_id = (offset + max_idx) / total_box_num;
-                            float obj_score = scores_ptr[offset + class_id * total_box_num];
-                            if (obj_score <= conf_thresh)
+                            int class_id = st.decoder.class_id(offset);
+                            if (class_id < 0)
                             {
                                 continue;
                             }
+                            float obj_score = st.decoder.score(offset);
                             float bbox_x = (ax + 0.5 - dets_ptr[offset]) * stride[i];
                             float bbox_y = (ay + 0.5 - dets_ptr[offset + total_box_num]) * stride[i];
                             float bbox_w = (ax + 0.5 + dets_ptr[offset + total_box_num * 2]) * stride[i] - bbox_x;
                             float bbox_h = (ay + 0.5 + dets_ptr[offset + total_box_num * 3]) * stride[i] - bbox_y;
-                            _KpInfo *kp_info = new _KpInfo(offset, ax, ay, stride[i]);
-                            Object &obj = objs.add(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score);
-                            obj.temp = (void *)kp_info;
+                            st.decoder.add(bbox_x, bbox_y, bbox_w, bbox_h, class_id, obj_score, offset, ax, ay, stride[i]);
                         }
                     }
                 }
@@ -627,57 +710,33 @@ namespace maix::nn
             return true;
         }
 
-        nn::Objects *_nms(nn::Objects &objs)
+        nn::Objects *_nms(_PostState &st)
         {
             nn::Objects *result = new nn::Objects();
-            std::sort(objs.begin(), objs.end(), [](const nn::Object *a, const nn::Object *b)
-                      { return a->score > b->score; });
-            for (size_t i = 0; i < objs.size(); ++i)
+            const std::vector<int> &keep = st.decoder.nms(st.iou_th);
+            for (int k : keep)
             {
-                nn::Object &a = objs.at(i);
-                if (a.score == 0)
-                    continue;
-                for (size_t j = i + 1; j < objs.size(); ++j)
+                nn::YOLOCandidate &a = st.decoder.candidates[k];
+                Object &obj = result->add(a.x, a.y, a.w, a.h, a.class_id, a.score, {}, a.angle);
+                if (obj.x < 0)
                 {
-                    nn::Object &b = objs.at(j);
-                    {
-                        if (b.score != 0 && a.class_id == b.class_id && _calc_iou(a, b) > this->_iou_th)
-                        {
-                            b.score = 0;
-                        }
-                    }
+                    obj.w += obj.x;
+                    obj.x = 0;
                 }
-            }
-            for (nn::Object *a : objs)
-            {
-                if (a->score != 0)
+                if (obj.y < 0)
                 {
-                    Object &obj = result->add(a->x, a->y, a->w, a->h, a->class_id, a->score, a->points);
-                    if (obj.x < 0)
-                    {
-                        obj.w += obj.x;
-                        obj.x = 0;
-                    }
-                    if (obj.y < 0)
-                    {
-                        obj.h += obj.y;
-                        obj.y = 0;
-                    }
-                    if (obj.x + obj.w > _input_size.width())
-                    {
-                        obj.w = _input_size.width() - obj.x;
-                    }
-                    if (obj.y + obj.h > _input_size.height())
-                    {
-                        obj.h = _input_size.height() - obj.y;
-                    }
-                    obj.temp = a->temp;
+                    obj.h += obj.y;
+                    obj.y = 0;
                 }
-                else
+                if (obj.x + obj.w > _input_size.width())
                 {
-                    delete (_KpInfo *)a->temp;
-                    a->temp = NULL;
+                    obj.w = _input_size.width() - obj.x;
                 }
+                if (obj.y + obj.h > _input_size.height())
+                {
+                    obj.h = _input_size.height() - obj.y;
+                }
+                obj.temp = (void *)&a; // owned by st.decoder, valid till next post process
             }
             return result;
         }
@@ -692,7 +751,7 @@ namespace maix::nn
                       { return (a->w * a->h) < (b->w * b->h); });
         }
 
-        void _decode_keypoints(nn::Objects &objs, tensor::Tensor *kp_out)
+        void _decode_keypoints(nn::Objects &objs, tensor::Tensor *kp_out, float keypoint_th)
         {
             float *data = (float *)kp_out->data();
             int keypoint_num = kp_out->shape()[1] / 3; // 1, 51, 8400, 1
@@ -700,14 +759,14 @@ namespace maix::nn
             for (size_t i = 0; i < objs.size(); ++i)
             {
                 nn::Object &o = objs.at(i);
-                _KpInfo *kp_info = (_KpInfo *)o.temp;
+                nn::YOLOCandidate *kp_info = (nn::YOLOCandidate *)o.temp;
                 float *p = data + kp_info->idx;
                 for (int k = 0; k < keypoint_num; ++k)
                 {
-                    float score = _sigmoid(p[(k * 3 + 2) * total_box_num]);
+                    float score = F::sigmoid(p[(k * 3 + 2) * total_box_num]);
                     int x = -1;
                     int y = -1;
-                    if (score > _keypoint_th)
+                    if (score > keypoint_th)
                     {
                         x = (p[(k * 3) * total_box_num] * 2.0 + kp_info->anchor_x) * kp_info->stride;
                         y = (p[(k * 3 + 1) * total_box_num] * 2.0 + kp_info->anchor_y) * kp_info->stride;
@@ -715,7 +774,6 @@ namespace maix::nn
                     o.points.push_back(x);
                     o.points.push_back(y);
                 }
-                delete (_KpInfo *)o.temp;
                 o.temp = NULL;
             }
         }
@@ -737,7 +795,7 @@ namespace maix::nn
                 int mask_y = o.y * mask_h / _input_size.height();
                 int mask_x2 = (o.x + o.w) * mask_w / _input_size.width();
                 int mask_y2 = (o.y + o.h) * mask_h / _input_size.height();
-                _KpInfo *kp_info = (_KpInfo *)o.temp;
+                nn::YOLOCandidate *kp_info = (nn::YOLOCandidate *)o.temp;
                 float *p = data + kp_info->idx;
                 for (int k = 0; k < mask_num; ++k)
                 {
@@ -766,10 +824,9 @@ namespace maix::nn
                 {
                     for (int k = mask_x; k < mask_x2; ++k)
                     {
-                        *p_img_data++ = (uint8_t)(_sigmoid(mask_data[j * mask_w + k]) * 255);
+                        *p_img_data++ = (uint8_t)(F::sigmoid(mask_data[j * mask_w + k]) * 255);
                     }
                 }
-                delete (_KpInfo *)o.temp;
                 o.temp = NULL;
             }
         }
@@ -801,11 +858,7 @@ namespace maix::nn
 
             for (nn::Object *obj : objs)
             {
-                if (obj->temp)
-                {
-                    delete (_KpInfo *)obj->temp;
-                    obj->temp = NULL;
-                }
+                obj->temp = NULL;
             }
             if (img_w == _input_size.width() && img_h == _input_size.height())
             {
@@ -922,49 +975,6 @@ namespace maix::nn
             }
         }
 
-        inline static float _sigmoid(float x) { return 1.0 / (1 + expf(-x)); }
-
-        inline static float _calc_iou(Object &a, Object &b)
-        {
-            float area1 = a.w * a.h;
-            float area2 = b.w * b.h;
-            float wi = std::min((a.x + a.w), (b.x + b.w)) -
-                       std::max(a.x, b.x);
-            float hi = std::min((a.y + a.h), (b.y + b.h)) -
-                       std::max(a.y, b.y);
-            float area_i = std::max(wi, 0.0f) * std::max(hi, 0.0f);
-            return area_i / (area1 + area2 - area_i);
-        }
-
-        template <typename T>
-        static int _argmax(const T *data, size_t len, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = 1; i < len; i++)
-            {
-                int idx = i * stride;
-                if (data[maxIndex * stride] < data[idx])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
-        template <typename T>
-        static int _argmax2(const T *data, size_t end, size_t stride = 1)
-        {
-            int maxIndex = 0;
-            for (size_t i = stride; i < end; i += stride)
-            {
-                if (data[maxIndex] < data[i])
-                {
-                    maxIndex = i;
-                }
-            }
-            return maxIndex;
-        }
-
         static void split0(std::vector<std::string> &items, const std::string &s, const std::string &delimiter)
         {
             items.clear();
@@ -22,27 +22,37 @@ namespace PaddleOCR {
 
 class DBPostProcessor {
 public:
-  void GetContourArea(const std::vector<std::vector<float>> &box,
-                      float unclip_ratio, float &distance);
+  // text box of 4 points ordered top-left, top-right, bottom-right,
+  // bottom-left, score is mean probability of the box
+  struct TextBox {
+    cv::Point pts[4];
+    float score;
+  };
 
-  cv::RotatedRect UnClip(std::vector<std::vector<float>> box,
-                         const float &unclip_ratio);
+  void GetContourArea(const cv::Point2f box[4], float unclip_ratio,
+                      float &distance);
 
-  float **Mat2Vec(cv::Mat mat);
+  cv::RotatedRect UnClip(const cv::Point2f box[4], const cv::RotatedRect &rect,
+                         const float &unclip_ratio);
 
   std::vector<std::vector<int>>
   OrderPointsClockwise(std::vector<std::vector<int>> pts);
 
-  std::vector<std::vector<float>> GetMiniBoxes(cv::RotatedRect box,
-                                               float &ssid);
+  void GetMiniBoxes(const cv::RotatedRect &box, cv::Point2f pts[4],
+                    float &ssid);
 
-  float BoxScoreFast(std::vector<std::vector<float>> box_array, cv::Mat pred);
-  float PolygonScoreAcc(std::vector<cv::Point> contour, cv::Mat pred);
+  float BoxScoreFast(const cv::Point2f box[4], const cv::Mat &pred);
+  float PolygonScoreAcc(const std::vector<cv::Point> &contour,
+                        const cv::Mat &pred);
 
-  std::vector<std::vector<std::vector<int>>>
-  BoxesFromBitmap(const cv::Mat pred, const cv::Mat bitmap,
-                  const float &box_thresh, const float &det_db_unclip_ratio,
-                  const std::string &det_db_score_mode, std::vector<float> &scores);
+  // boxes is cleared and filled, contours and scan line buffers are kept
+  // by the object, reuse one object to avoid memory allocation every frame
+  void BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
+                       const float &box_thresh,
+                       const float &det_db_unclip_ratio,
+                       const std::string &det_db_score_mode,
+                       std::vector<TextBox> &boxes,
+                       int max_candidates = 1000);
 
   std::vector<std::vector<std::vector<int>>>
   FilterTagDetRes(std::vector<std::vector<std::vector<int>>> boxes,
@@ -51,9 +61,13 @@ public:
 private:
   static bool XsortInt(std::vector<int> a, std::vector<int> b);
 
-  static bool XsortFp32(std::vector<float> a, std::vector<float> b);
+  // mean of pred inside polygon(edges included) of n integer points
+  float PolygonMean(const cv::Point *pts, int n, const cv::Mat &pred);
 
-  std::vector<std::vector<float>> Mat2Vector(cv::Mat mat);
+  std::vector<std::vector<cv::Point>> contours_;
+  std::vector<cv::Vec4i> hierarchy_;
+  std::vector<float> crossings_;
+  std::vector<uint8_t> row_mask_;
 
   inline int _max(int a, int b) { return a >= b ? a : b; }
 
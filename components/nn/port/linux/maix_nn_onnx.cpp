@@ -0,0 +1,658 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add ONNX Runtime backend for Linux platform.
+ */
+
+#include "maix_nn_onnx.hpp"
+#include "maix_basic.hpp"
+#include "maix_image_yuv.hpp"
+#include "onnxruntime_cxx_api.h"
+
+namespace maix::nn
+{
+    class _ONNXLayer
+    {
+    public:
+        std::string name;
+        ONNXTensorElementDataType onnx_type;
+        tensor::DType dtype;
+        std::vector<int64_t> shape;  // dynamic dims are replaced by 1
+        bool dynamic;
+        size_t bytes;
+        void *buff;                  // preallocated buffer, bound to IoBinding, nullptr for dynamic outputs
+        bool bound_caller;           // dynamic input bound to caller's memory instead of buff
+    };
+
+    class _ONNXData
+    {
+    public:
+        _ONNXData()
+            : mem_info(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+        {
+            session = nullptr;
+            binding = nullptr;
+            has_dynamic_output = false;
+        }
+
+        Ort::Session *session;
+        Ort::IoBinding *binding;
+        Ort::MemoryInfo mem_info;
+        std::vector<_ONNXLayer> inputs;
+        std::vector<_ONNXLayer> outputs;
+        std::vector<Ort::Value> input_values;
+        std::vector<Ort::Value> output_values;
+        std::vector<Ort::Value> dynamic_values; // outputs allocated by ONNX Runtime, valid till next forward
+        tensor::Arena out_arena;                 // narrowed outputs when not copy result, valid till next forward
+        bool has_dynamic_output;
+    };
+
+    static Ort::Env &_ort_env()
+    {
+        // Env must outlive all sessions, share one for whole process
+        static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "maix_nn");
+        return env;
+    }
+
+    static bool _onnx_type_to_dtype(ONNXTensorElementDataType type, tensor::DType &dtype)
+    {
+        switch (type)
+        {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+            dtype = tensor::DType::UINT8;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+            dtype = tensor::DType::INT8;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+            dtype = tensor::DType::UINT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+            dtype = tensor::DType::INT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+            dtype = tensor::DType::UINT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+            dtype = tensor::DType::INT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64: // narrowed to int32 when output
+            dtype = tensor::DType::INT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+            dtype = tensor::DType::FLOAT16;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+            dtype = tensor::DType::FLOAT32;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+            dtype = tensor::DType::FLOAT64;
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+            dtype = tensor::DType::BOOL;
+            break;
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    static size_t _onnx_type_size(ONNXTensorElementDataType type, tensor::DType dtype)
+    {
+        if (type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64)
+            return 8;
+        return tensor::dtype_size[dtype];
+    }
+
+    static size_t _shape_elements(const std::vector<int64_t> &shape)
+    {
+        size_t n = 1;
+        for (auto i : shape)
+            n *= (size_t)i;
+        return n;
+    }
+
+    static int _parse_int_item(const MUD &mud, const std::string &key, int default_value)
+    {
+        auto section = mud.items.find("basic");
+        if (section == mud.items.end())
+            return default_value;
+        auto it = section->second.find(key);
+        if (it == section->second.end())
+            return default_value;
+        try
+        {
+            return std::stoi(it->second);
+        }
+        catch (std::exception &e)
+        {
+            log::warn("MUD [basic] %s value %s invalid, use default %d", key.c_str(), it->second.c_str(), default_value);
+        }
+        return default_value;
+    }
+
+    static err::Err _parse_layers(Ort::Session *session, bool is_input, std::vector<_ONNXLayer> &layers)
+    {
+        Ort::AllocatorWithDefaultOptions allocator;
+        size_t num = is_input ? session->GetInputCount() : session->GetOutputCount();
+        layers.clear();
+        layers.resize(num);
+        for (size_t i = 0; i < num; ++i)
+        {
+            _ONNXLayer &layer = layers[i];
+            Ort::AllocatedStringPtr name = is_input ? session->GetInputNameAllocated(i, allocator) : session->GetOutputNameAllocated(i, allocator);
+            Ort::TypeInfo type_info = is_input ? session->GetInputTypeInfo(i) : session->GetOutputTypeInfo(i);
+            auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+            layer.name = name.get();
+            layer.onnx_type = tensor_info.GetElementType();
+            layer.shape = tensor_info.GetShape();
+            layer.dynamic = false;
+            layer.buff = nullptr;
+            layer.bound_caller = false;
+            if (!_onnx_type_to_dtype(layer.onnx_type, layer.dtype))
+            {
+                log::error("layer %s data type %d not support", layer.name.c_str(), (int)layer.onnx_type);
+                return err::ERR_NOT_IMPL;
+            }
+            if (is_input && layer.onnx_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64)
+            {
+                log::error("input layer %s data type int64 not support", layer.name.c_str());
+                return err::ERR_NOT_IMPL;
+            }
+            for (auto &d : layer.shape)
+            {
+                if (d <= 0)
+                {
+                    d = 1;
+                    layer.dynamic = true;
+                }
+            }
+            layer.bytes = _shape_elements(layer.shape) * _onnx_type_size(layer.onnx_type, layer.dtype);
+        }
+        return err::ERR_NONE;
+    }
+
+    static void _free_layers(std::vector<_ONNXLayer> &layers)
+    {
+        for (auto &layer : layers)
+        {
+            if (layer.buff)
+            {
+                free(layer.buff);
+                layer.buff = nullptr;
+            }
+        }
+        layers.clear();
+    }
+
+    // bind input back to its own buffer after a forward bound caller's memory, throw Ort::Exception if failed
+    static void _bind_input_buff(_ONNXData *data, size_t i)
+    {
+        _ONNXLayer &layer = data->inputs[i];
+        data->input_values[i] = Ort::Value::CreateTensor(data->mem_info, layer.buff, layer.bytes, layer.shape.data(), layer.shape.size(), layer.onnx_type);
+        data->binding->BindInput(layer.name.c_str(), data->input_values[i]);
+        layer.bound_caller = false;
+    }
+
+    NN_ONNX::NN_ONNX(bool dual_buff)
+    {
+        _loaded = false;
+        _enable_dual_buff = dual_buff;
+        _data = nullptr;
+    }
+
+    NN_ONNX::~NN_ONNX()
+    {
+        unload();
+    }
+
+    err::Err NN_ONNX::load(const MUD &mud, const std::string &dir)
+    {
+        if (_loaded)
+        {
+            log::error("model already loaded");
+            return err::ERR_NOT_PERMIT;
+        }
+        if (mud.type != "onnx")
+        {
+            log::error("model type %s not support on this platform, only support onnx", mud.type.c_str());
+            return err::ERR_NOT_IMPL;
+        }
+        auto basic = mud.items.find("basic");
+        if (basic == mud.items.end() || basic->second.find("model") == basic->second.end())
+        {
+            log::error("MUD [basic] section no model key");
+            return err::ERR_ARGS;
+        }
+        std::string model_path = basic->second.at("model");
+        if (!fs::isabs(model_path))
+            model_path = dir + "/" + model_path;
+        if (!fs::exists(model_path))
+        {
+            log::error("model file %s not exists", model_path.c_str());
+            return err::ERR_ARGS;
+        }
+        int intra_op_threads = _parse_int_item(mud, "intra_op_threads", 0);
+        int inter_op_threads = _parse_int_item(mud, "inter_op_threads", 0);
+        GraphOptimizationLevel opt_level = GraphOptimizationLevel::ORT_ENABLE_ALL;
+        if (basic->second.find("optimize") != basic->second.end())
+        {
+            const std::string &opt = basic->second.at("optimize");
+            if (opt == "disable")
+                opt_level = GraphOptimizationLevel::ORT_DISABLE_ALL;
+            else if (opt == "basic")
+                opt_level = GraphOptimizationLevel::ORT_ENABLE_BASIC;
+            else if (opt == "extended")
+                opt_level = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+            else if (opt != "all")
+                log::warn("MUD [basic] optimize value %s invalid, use all", opt.c_str());
+        }
+
+        _ONNXData *data = new _ONNXData();
+        try
+        {
+            Ort::SessionOptions opts;
+            opts.SetIntraOpNumThreads(intra_op_threads);
+            opts.SetInterOpNumThreads(inter_op_threads);
+            opts.SetExecutionMode(inter_op_threads > 1 ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+            opts.SetGraphOptimizationLevel(opt_level);
+            data->session = new Ort::Session(_ort_env(), model_path.c_str(), opts);
+            err::Err e = _parse_layers(data->session, true, data->inputs);
+            if (e == err::ERR_NONE)
+                e = _parse_layers(data->session, false, data->outputs);
+            if (e != err::ERR_NONE)
+            {
+                delete data->session;
+                delete data;
+                return e;
+            }
+
+            // preallocate inputs and static outputs, bind once, reuse for every forward
+            data->binding = new Ort::IoBinding(*data->session);
+            for (auto &layer : data->inputs)
+            {
+                layer.buff = malloc(layer.bytes);
+                if (!layer.buff)
+                    throw err::Exception(err::ERR_NO_MEM, "alloc input buffer failed");
+                data->input_values.push_back(Ort::Value::CreateTensor(data->mem_info, layer.buff, layer.bytes, layer.shape.data(), layer.shape.size(), layer.onnx_type));
+                data->binding->BindInput(layer.name.c_str(), data->input_values.back());
+            }
+            for (auto &layer : data->outputs)
+            {
+                if (layer.dynamic)
+                {
+                    data->has_dynamic_output = true;
+                    data->binding->BindOutput(layer.name.c_str(), data->mem_info);
+                    continue;
+                }
+                layer.buff = malloc(layer.bytes);
+                if (!layer.buff)
+                    throw err::Exception(err::ERR_NO_MEM, "alloc output buffer failed");
+                data->output_values.push_back(Ort::Value::CreateTensor(data->mem_info, layer.buff, layer.bytes, layer.shape.data(), layer.shape.size(), layer.onnx_type));
+                data->binding->BindOutput(layer.name.c_str(), data->output_values.back());
+            }
+        }
+        catch (std::exception &e)
+        {
+            log::error("load onnx model %s failed: %s", model_path.c_str(), e.what());
+            _data = data;
+            _loaded = true;
+            unload();
+            return err::ERR_RUNTIME;
+        }
+        _data = data;
+        _loaded = true;
+        log::info("onnx model %s loaded, intra_op_threads: %d, inter_op_threads: %d", model_path.c_str(), intra_op_threads, inter_op_threads);
+        return err::ERR_NONE;
+    }
+
+    err::Err NN_ONNX::unload()
+    {
+        if (!_loaded)
+            return err::ERR_NONE;
+        _ONNXData *data = (_ONNXData *)_data;
+        data->dynamic_values.clear();
+        data->input_values.clear();
+        data->output_values.clear();
+        if (data->binding)
+            delete data->binding;
+        if (data->session)
+            delete data->session;
+        _free_layers(data->inputs);
+        _free_layers(data->outputs);
+        delete data;
+        _data = nullptr;
+        _loaded = false;
+        return err::ERR_NONE;
+    }
+
+    bool NN_ONNX::loaded()
+    {
+        return _loaded;
+    }
+
+    void NN_ONNX::set_dual_buff(bool enable)
+    {
+        _enable_dual_buff = enable;
+    }
+
+    static std::vector<LayerInfo> _layers_info(const std::vector<_ONNXLayer> &layers)
+    {
+        std::vector<LayerInfo> infos;
+        for (auto &layer : layers)
+        {
+            std::vector<int> shape(layer.shape.begin(), layer.shape.end());
+            infos.push_back(LayerInfo(layer.name, layer.dtype, shape));
+        }
+        return infos;
+    }
+
+    std::vector<LayerInfo> NN_ONNX::inputs_info()
+    {
+        if (!_loaded)
+            return std::vector<LayerInfo>();
+        return _layers_info(((_ONNXData *)_data)->inputs);
+    }
+
+    std::vector<LayerInfo> NN_ONNX::outputs_info()
+    {
+        if (!_loaded)
+            return std::vector<LayerInfo>();
+        return _layers_info(((_ONNXData *)_data)->outputs);
+    }
+
+    err::Err NN_ONNX::_run()
+    {
+        _ONNXData *data = (_ONNXData *)_data;
+        try
+        {
+            data->dynamic_values.clear();
+            data->session->Run(Ort::RunOptions{nullptr}, *data->binding);
+            if (data->has_dynamic_output)
+                data->dynamic_values = data->binding->GetOutputValues();
+        }
+        catch (std::exception &e)
+        {
+            log::error("onnx forward failed: %s", e.what());
+            return err::ERR_RUNTIME;
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err NN_ONNX::_collect_outputs(tensor::Tensors &outputs, bool copy_result)
+    {
+        _ONNXData *data = (_ONNXData *)_data;
+        // results not copied are only valid till next forward, memory of last round can be reused
+        data->out_arena.reset();
+        for (size_t i = 0; i < data->outputs.size(); ++i)
+        {
+            _ONNXLayer &layer = data->outputs[i];
+            void *src = layer.buff;
+            std::vector<int> shape(layer.shape.begin(), layer.shape.end());
+            if (layer.dynamic)
+            {
+                // GetOutputValues return values in bind order, same as outputs order
+                Ort::Value &v = data->dynamic_values[i];
+                std::vector<int64_t> real_shape = v.GetTensorTypeAndShapeInfo().GetShape();
+                shape.assign(real_shape.begin(), real_shape.end());
+                src = v.GetTensorMutableData<uint8_t>();
+            }
+            int num = 1;
+            for (auto d : shape)
+                num *= d;
+            auto it = outputs.tensors.find(layer.name);
+            tensor::Tensor *t = nullptr;
+            bool narrow = layer.onnx_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64;
+            if (it != outputs.tensors.end())
+            {
+                // caller allocated output tensor, copy result into it
+                t = it->second;
+                if (t->size_int() != num || t->dtype() != layer.dtype)
+                {
+                    log::error("output %s shape or dtype not match", layer.name.c_str());
+                    return err::ERR_ARGS;
+                }
+            }
+            else if (copy_result)
+            {
+                t = new tensor::Tensor(shape, layer.dtype);
+                outputs.add_tensor(layer.name, t, false, true);
+            }
+            else if (narrow)
+            {
+                t = new tensor::Tensor(shape, layer.dtype, data->out_arena);
+                outputs.add_tensor(layer.name, t, false, true);
+            }
+            else
+            {
+                t = new tensor::Tensor(shape, layer.dtype, src, false);
+                outputs.add_tensor(layer.name, t, false, true);
+                continue;
+            }
+            if (narrow)
+            {
+                int64_t *p = (int64_t *)src;
+                int32_t *dst = (int32_t *)t->data();
+                for (int j = 0; j < num; ++j)
+                    dst[j] = (int32_t)p[j];
+            }
+            else
+            {
+                memcpy(t->data(), src, num * tensor::dtype_size[layer.dtype]);
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err NN_ONNX::forward(tensor::Tensors &inputs, tensor::Tensors &outputs, bool copy_result, bool dual_buff_wait)
+    {
+        if (!_loaded)
+        {
+            log::error("model not loaded");
+            return err::ERR_NOT_READY;
+        }
+        _ONNXData *data = (_ONNXData *)_data;
+        for (size_t i = 0; i < data->inputs.size(); ++i)
+        {
+            _ONNXLayer &layer = data->inputs[i];
+            auto it = inputs.tensors.find(layer.name);
+            if (it == inputs.tensors.end())
+            {
+                // only one input, not care about the name
+                if (data->inputs.size() == 1 && inputs.size() == 1)
+                    it = inputs.tensors.begin();
+                else
+                {
+                    log::error("input %s not found", layer.name.c_str());
+                    return err::ERR_ARGS;
+                }
+            }
+            tensor::Tensor *t = it->second;
+            if (t->dtype() != layer.dtype)
+            {
+                log::error("input %s dtype %s not match, model need %s", layer.name.c_str(), tensor::dtype_name[t->dtype()].c_str(), tensor::dtype_name[layer.dtype].c_str());
+                return err::ERR_ARGS;
+            }
+            size_t bytes = (size_t)t->size_int() * tensor::dtype_size[layer.dtype];
+            if (bytes == layer.bytes)
+            {
+                if (layer.bound_caller)
+                {
+                    // binding still points to memory of previous caller, which may be freed now
+                    try
+                    {
+                        _bind_input_buff(data, i);
+                    }
+                    catch (std::exception &e)
+                    {
+                        log::error("bind input %s failed: %s", layer.name.c_str(), e.what());
+                        return err::ERR_RUNTIME;
+                    }
+                }
+                if (t->data() != layer.buff)
+                    memcpy(layer.buff, t->data(), bytes);
+                continue;
+            }
+            if (!layer.dynamic)
+            {
+                log::error("input %s size not match, model need %ld bytes, but got %ld", layer.name.c_str(), layer.bytes, bytes);
+                return err::ERR_ARGS;
+            }
+            // dynamic input with new shape, bind caller's memory directly
+            std::vector<int> t_shape = t->shape();
+            std::vector<int64_t> shape(t_shape.begin(), t_shape.end());
+            try
+            {
+                data->input_values[i] = Ort::Value::CreateTensor(data->mem_info, t->data(), bytes, shape.data(), shape.size(), layer.onnx_type);
+                data->binding->BindInput(layer.name.c_str(), data->input_values[i]);
+                layer.bound_caller = true;
+            }
+            catch (std::exception &e)
+            {
+                log::error("bind input %s failed: %s", layer.name.c_str(), e.what());
+                return err::ERR_ARGS;
+            }
+        }
+        err::Err e = _run();
+        if (e != err::ERR_NONE)
+            return e;
+        return _collect_outputs(outputs, copy_result);
+    }
+
+    tensor::Tensors *NN_ONNX::forward(tensor::Tensors &inputs, bool copy_result, bool dual_buff_wait)
+    {
+        tensor::Tensors *outputs = new tensor::Tensors();
+        err::Err e = forward(inputs, *outputs, copy_result, dual_buff_wait);
+        if (e != err::ERR_NONE)
+        {
+            delete outputs;
+            throw err::Exception(e, "forward failed");
+        }
+        return outputs;
+    }
+
+    template <typename T>
+    static void _fill_input(const uint8_t *src, T *dst, int w, int h, int c, const float *mean, const float *scale, bool chw)
+    {
+        int size = w * h;
+        if (chw)
+        {
+            for (int k = 0; k < c; ++k)
+            {
+                T *p = dst + k * size;
+                const uint8_t *s = src + k;
+                float m = mean[k], sc = scale[k];
+                for (int i = 0; i < size; ++i)
+                {
+                    p[i] = (T)(((float)s[0] - m) * sc);
+                    s += c;
+                }
+            }
+        }
+        else
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                for (int k = 0; k < c; ++k)
+                {
+                    dst[i * c + k] = (T)(((float)src[i * c + k] - mean[k]) * scale[k]);
+                }
+            }
+        }
+    }
+
+    tensor::Tensors *NN_ONNX::forward_image(image::Image &img, std::vector<float> mean, std::vector<float> scale, image::Fit fit, bool copy_result, bool dual_buff_wait, bool chw)
+    {
+        if (!_loaded)
+            throw err::Exception(err::ERR_NOT_READY, "model not loaded");
+        _ONNXData *data = (_ONNXData *)_data;
+        _ONNXLayer &layer = data->inputs[0];
+        if (layer.shape.size() != 4)
+            throw err::Exception(err::ERR_ARGS, "forward_image only support 4 dims input");
+        int c = chw ? layer.shape[1] : layer.shape[3];
+        int h = chw ? layer.shape[2] : layer.shape[1];
+        int w = chw ? layer.shape[3] : layer.shape[2];
+        if (c != 1 && c != 3)
+            throw err::Exception(err::ERR_ARGS, "forward_image only support 1 or 3 channels input");
+        if ((!mean.empty() && (int)mean.size() != c) || (!scale.empty() && (int)scale.size() != c))
+            throw err::Exception(err::ERR_ARGS, "mean and scale size must equal to input channels");
+        if (mean.empty())
+            mean.assign(c, 0);
+        if (scale.empty())
+            scale.assign(c, 1);
+
+        image::YUVLayout layout;
+        bool is_float = layer.onnx_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+        bool ok = true;
+        if (image::yuv_layout(img.format(), layout) && (is_float || layer.onnx_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8))
+        {
+            // camera YUV frame: resize, letterbox and convert to input tensor in one pass, no RGB image
+            err::Err e = image::preprocess_yuv(layout, (const uint8_t *)img.data(), img.width(), img.height(), 0, 0, img.width(), img.height(),
+                                               layer.buff, w, h, c == 3 ? image::FMT_RGB888 : image::FMT_GRAYSCALE, chw, is_float,
+                                               mean.data(), scale.data(), fit);
+            if (e != err::ERR_NONE)
+                throw err::Exception(e, "preprocess yuv image failed");
+        }
+        else
+        {
+            image::Image *in = &img;
+            image::Image *fmt_img = nullptr;
+            image::Image *resized = nullptr;
+            bool need_convert = c == 3 ? (img.format() != image::FMT_RGB888 && img.format() != image::FMT_BGR888)
+                                       : img.format() != image::FMT_GRAYSCALE;
+            if (need_convert)
+            {
+                fmt_img = img.to_format(c == 3 ? image::FMT_RGB888 : image::FMT_GRAYSCALE);
+                if (!fmt_img)
+                    throw err::Exception(err::ERR_ARGS, "image format " + image::fmt_names[img.format()] + " not support");
+                in = fmt_img;
+            }
+            if (in->width() != w || in->height() != h)
+            {
+                resized = in->resize(w, h, fit);
+                in = resized;
+            }
+            const uint8_t *src = (const uint8_t *)in->data();
+            switch (layer.onnx_type)
+            {
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+                _fill_input<float>(src, (float *)layer.buff, w, h, c, mean.data(), scale.data(), chw);
+                break;
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+                if (!chw || c == 1)
+                    memcpy(layer.buff, src, w * h * c);
+                else
+                    _fill_input<uint8_t>(src, (uint8_t *)layer.buff, w, h, c, std::vector<float>(c, 0).data(), std::vector<float>(c, 1).data(), chw);
+                break;
+            default:
+                ok = false;
+                break;
+            }
+            if (resized)
+                delete resized;
+            if (fmt_img)
+                delete fmt_img;
+        }
+        if (!ok)
+            throw err::Exception(err::ERR_NOT_IMPL, "forward_image input dtype " + tensor::dtype_name[layer.dtype] + " not support");
+        if (layer.bound_caller)
+        {
+            // previous forward bound caller's memory, bind back to own buffer
+            _bind_input_buff(data, 0);
+        }
+
+        err::Err e = _run();
+        if (e != err::ERR_NONE)
+            throw err::Exception(e, "forward failed");
+        tensor::Tensors *outputs = new tensor::Tensors();
+        e = _collect_outputs(*outputs, copy_result);
+        if (e != err::ERR_NONE)
+        {
+            delete outputs;
+            throw err::Exception(e, "get outputs failed");
+        }
+        return outputs;
+    }
+
+} // namespace maix::nn
@@ -0,0 +1,97 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add ONNX Runtime backend for Linux platform.
+ */
+
+#pragma once
+
+#include "maix_nn.hpp"
+#include "maix_image.hpp"
+
+namespace maix::nn
+{
+    /**
+     * NNBase implementation backed by ONNX Runtime(CPU execution provider).
+     * Selected by NN when MUD [basic] type is onnx, optional keys in [basic] section:
+     *   intra_op_threads: threads used inside one operator, default 0 means decided by ONNX Runtime.
+     *   inter_op_threads: threads used to run operators in parallel, default 0 means decided by ONNX Runtime.
+     *   optimize: graph optimize level, disable, basic, extended or all, default all.
+     */
+    class NN_ONNX : public NNBase
+    {
+    public:
+        NN_ONNX(bool dual_buff = false);
+        ~NN_ONNX();
+
+        /**
+         * Load model from file
+         * @param[in] mud simply parsed model describe object
+         * @param dir directory of model file, always absolute path
+         * @return error code, if load success, return err::ERR_NONE
+         */
+        virtual err::Err load(const MUD &mud, const std::string &dir) final;
+
+        /**
+         * Unload model
+         * @return error code, if unload success, return err::ERR_NONE
+         */
+        virtual err::Err unload() final;
+
+        /**
+         * Is model loaded
+         * @return true if model loaded, else false
+         */
+        virtual bool loaded() final;
+
+        /**
+         * Enable dual buff or disable dual buff, ONNX Runtime run synchronously, so this only record the value.
+         * @param enable true to enable, false to disable
+         */
+        virtual void set_dual_buff(bool enable);
+
+        /**
+         * Get model input layer info
+         * @return input layer info
+         */
+        std::vector<LayerInfo> inputs_info();
+
+        /**
+         * Get model output layer info
+         * @return output layer info
+         */
+        std::vector<LayerInfo> outputs_info();
+
+        /**
+         * forward run model, get output of model
+         * @param[in] input input tensor
+         * @param[out] output output tensor
+         * @return error code, if forward success, return err::ERR_NONE
+         */
+        virtual err::Err forward(tensor::Tensors &inputs, tensor::Tensors &outputs, bool copy_result = true, bool dual_buff_wait = false) final;
+
+        /**
+         * forward run model, get output of model,
+         * this is specially for MaixPy, not efficient, but easy to use in MaixPy
+         * @param[in] input input tensor
+         * @return output tensor
+         */
+        virtual tensor::Tensors *forward(tensor::Tensors &inputs, bool copy_result = true, bool dual_buff_wait = false) final;
+
+        /**
+         * forward model, param is image
+         * @param[in] img input image
+         * @return output tensor
+         */
+        virtual tensor::Tensors *forward_image(image::Image &img, std::vector<float> mean = std::vector<float>(), std::vector<float> scale = std::vector<float>(), image::Fit fit = image::Fit::FIT_CONTAIN, bool copy_result = true, bool dual_buff_wait = false, bool chw = true) final;
+
+    private:
+        bool _loaded;
+        bool _enable_dual_buff;
+        void *_data;
+        err::Err _run();
+        err::Err _collect_outputs(tensor::Tensors &outputs, bool copy_result);
+    };
+
+} // namespace maix::nn
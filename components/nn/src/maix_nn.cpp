@@ -10,10 +10,13 @@
 #include "maix_basic.hpp"
 #include "inifile.h"
 #include "maix_nn_self_learn_classifier.hpp"
+#include "maix_image_yuv.hpp"
 
 #if PLATFORM_MAIXCAM
     #include "maix_nn_maixcam.hpp"
     #include "speech/dr_wav.h"
+#elif PLATFORM_LINUX && CONFIG_NN_ONNXRUNTIME_BACKEND
+    #include "maix_nn_onnx.hpp"
 #endif
 
 
@@ -200,6 +203,8 @@ namespace maix::nn
         _impl = nullptr;
 #if PLATFORM_MAIXCAM
         _impl = new NN_MaixCam(dual_buff);
+#elif PLATFORM_LINUX && CONFIG_NN_ONNXRUNTIME_BACKEND
+        _impl = new NN_ONNX(dual_buff);
 #endif
         if(!_impl)
         {
@@ -246,11 +251,13 @@ namespace maix::nn
         {
             return e;
         }
+        _inputs = _impl->inputs_info();
         return err::ERR_NONE;
     }
 
     err::Err NN::unload()
     {
+        _inputs.clear();
         return _impl->unload();
     }
 
@@ -309,6 +316,183 @@ namespace maix::nn
         return _impl->forward_image(img, mean, scale, fit, copy_result, dual_buff_wait, chw);
     }
 
+    int NN::input_image_bytes()
+    {
+        if (_inputs.empty() || _inputs[0].shape.empty())
+            return 0;
+        int n = _inputs[0].shape_int() / std::max(_inputs[0].shape[0], 1);
+        return n * tensor::dtype_size[_inputs[0].dtype];
+    }
+
+    template <typename T>
+    static void _fill_image_input(const uint8_t *src, T *dst, int w, int h, int c, const float *mean, const float *scale, bool chw)
+    {
+        int size = w * h;
+        for (int k = 0; k < c; ++k)
+        {
+            float m = mean ? mean[k] : 0, sc = scale ? scale[k] : 1;
+            const uint8_t *s = src + k;
+            T *d = chw ? dst + k * size : dst + k;
+            int d_step = chw ? 1 : c;
+            for (int i = 0; i < size; ++i, s += c, d += d_step)
+                *d = (T)(((float)*s - m) * sc);
+        }
+    }
+
+    err::Err NN::preprocess_image(image::Image &img, void *dst, const std::vector<float> &mean, const std::vector<float> &scale, image::Fit fit, bool chw)
+    {
+        if (_inputs.empty() || _inputs[0].shape.size() != 4)
+        {
+            log::error("preprocess_image only support model with 4 dims input");
+            return err::ERR_ARGS;
+        }
+        const nn::LayerInfo &layer = _inputs[0];
+        int c = chw ? layer.shape[1] : layer.shape[3];
+        int h = chw ? layer.shape[2] : layer.shape[1];
+        int w = chw ? layer.shape[3] : layer.shape[2];
+        if (c != 1 && c != 3)
+        {
+            log::error("preprocess_image only support 1 or 3 channels input");
+            return err::ERR_ARGS;
+        }
+        if ((!mean.empty() && (int)mean.size() != c) || (!scale.empty() && (int)scale.size() != c))
+        {
+            log::error("mean and scale size must equal to input channels");
+            return err::ERR_ARGS;
+        }
+        bool is_float = layer.dtype == tensor::DType::FLOAT32;
+        if (!is_float && layer.dtype != tensor::DType::UINT8)
+        {
+            log::error("preprocess_image input dtype %s not support", tensor::dtype_name[layer.dtype].c_str());
+            return err::ERR_NOT_IMPL;
+        }
+        const float *m = mean.empty() ? nullptr : mean.data();
+        const float *sc = scale.empty() ? nullptr : scale.data();
+
+        image::YUVLayout layout;
+        if (image::yuv_layout(img.format(), layout))
+        {
+            return image::preprocess_yuv(layout, (const uint8_t *)img.data(), img.width(), img.height(), 0, 0, img.width(), img.height(),
+                                         dst, w, h, c == 3 ? image::FMT_RGB888 : image::FMT_GRAYSCALE, chw, is_float, m, sc, fit);
+        }
+        image::Image *in = &img;
+        image::Image *fmt_img = nullptr;
+        image::Image *resized = nullptr;
+        bool need_convert = c == 3 ? (img.format() != image::FMT_RGB888 && img.format() != image::FMT_BGR888)
+                                   : img.format() != image::FMT_GRAYSCALE;
+        if (need_convert)
+        {
+            fmt_img = img.to_format(c == 3 ? image::FMT_RGB888 : image::FMT_GRAYSCALE);
+            if (!fmt_img)
+            {
+                log::error("image format %s not support", image::fmt_names[img.format()].c_str());
+                return err::ERR_ARGS;
+            }
+            in = fmt_img;
+        }
+        if (in->width() != w || in->height() != h)
+        {
+            resized = in->resize(w, h, fit);
+            in = resized;
+        }
+        const uint8_t *src = (const uint8_t *)in->data();
+        if (is_float)
+            _fill_image_input<float>(src, (float *)dst, w, h, c, m, sc, chw);
+        else if (!chw || c == 1)
+            memcpy(dst, src, w * h * c);
+        else
+            _fill_image_input<uint8_t>(src, (uint8_t *)dst, w, h, c, nullptr, nullptr, chw);
+        if (resized)
+            delete resized;
+        if (fmt_img)
+            delete fmt_img;
+        return err::ERR_NONE;
+    }
+
+    std::vector<tensor::Tensors *> NN::forward_batch(std::vector<image::Image *> imgs, std::vector<float> mean, std::vector<float> scale, image::Fit fit, bool chw, int batch)
+    {
+        if (_inputs.empty() || _inputs[0].shape.empty())
+            throw err::Exception(err::ERR_NOT_READY, "model not loaded");
+        if (batch <= 0)
+            batch = std::max(_inputs[0].shape[0], 1);
+        std::vector<tensor::Tensors *> results;
+        results.reserve(imgs.size());
+        if (batch == 1)
+        {
+            try
+            {
+                for (image::Image *img : imgs)
+                {
+                    tensor::Tensors *out = _impl->forward_image(*img, mean, scale, fit, true, true, chw);
+                    if (!out)
+                        throw err::Exception(err::ERR_NOT_READY, "forward image failed");
+                    results.push_back(out);
+                }
+            }
+            catch (...)
+            {
+                for (auto r : results)
+                    delete r;
+                throw;
+            }
+            return results;
+        }
+
+        // one input tensor of batch images, reused by every batch
+        nn::LayerInfo layer = _inputs[0];
+        layer.shape[0] = batch;
+        int bytes = input_image_bytes();
+        tensor::Tensor input(layer.shape, layer.dtype);
+        uint8_t *input_data = (uint8_t *)input.data();
+        try
+        {
+            for (size_t start = 0; start < imgs.size(); start += batch)
+            {
+                int num = std::min((int)(imgs.size() - start), batch);
+                for (int i = 0; i < num; ++i)
+                {
+                    err::Err e = preprocess_image(*imgs[start + i], input_data + (size_t)i * bytes, mean, scale, fit, chw);
+                    if (e != err::ERR_NONE)
+                        throw err::Exception(e, "preprocess image failed");
+                }
+                if (num < batch)
+                    memset(input_data + (size_t)num * bytes, 0, (size_t)(batch - num) * bytes);
+                tensor::Tensors inputs;
+                inputs.add_tensor(layer.name, &input, false, false);
+                tensor::Tensors outputs;
+                err::Err e = _impl->forward(inputs, outputs, false, true);
+                if (e != err::ERR_NONE)
+                    throw err::Exception(e, "forward failed");
+                for (int i = 0; i < num; ++i)
+                    results.push_back(new tensor::Tensors());
+                for (auto &item : outputs)
+                {
+                    tensor::Tensor *t = item.second;
+                    const std::string &name = item.first;
+                    std::vector<int> shape = t->shape();
+                    if (shape.empty() || shape[0] != batch)
+                        throw err::Exception(err::ERR_NOT_IMPL, "output " + name + " first dimension not batch size, can not split");
+                    shape[0] = 1;
+                    size_t out_bytes = (size_t)t->size_int() / batch * tensor::dtype_size[t->dtype()];
+                    for (int i = 0; i < num; ++i)
+                    {
+                        tensor::Tensors *result = results[start + i];
+                        tensor::Tensor *one = new tensor::Tensor(shape, t->dtype());
+                        memcpy(one->data(), (uint8_t *)t->data() + i * out_bytes, out_bytes);
+                        result->add_tensor(name, one, false, true);
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            for (auto r : results)
+                delete r;
+            throw;
+        }
+        return results;
+    }
+
     int SelfLearnClassifier::learn()
     {
         #if PLATFORM_MAIXCAM
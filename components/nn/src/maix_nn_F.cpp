@@ -3,37 +3,635 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add NEON/RVV/SSE2 kernels.
  */
 
 
 #include "maix_nn_F.hpp"
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define NN_F_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    // needs RVV v1.0 intrinsics, not used on MaixCAM: C906 only has RVV 0.7.1(-march=rv64imafdcv0p7xthead)
+    // and its toolchain doesn't provide __riscv_v_intrinsic, so scalar path is built. Not tested on RVV 1.0 hardware.
+    #include <riscv_vector.h>
+    #define NN_F_RVV 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define NN_F_SSE 1
+#endif
+
 namespace maix::nn::F
 {
+    // exp polynomial, same as fast_exp
+    #define EXP_C0 1.9875691500e-4f
+    #define EXP_C1 1.3981999507e-3f
+    #define EXP_C2 8.3334519073e-3f
+    #define EXP_C3 4.1665795894e-2f
+    #define EXP_C4 1.6666665459e-1f
+    #define EXP_C5 5.0000001201e-1f
+    #define EXP_LN2_HI 0.693359375f
+    #define EXP_LN2_LO 2.12194440e-4f
+    #define EXP_LOG2E 1.44269504088896341f
+    #define EXP_MIN -87.3f
+    #define EXP_MAX 88.3f
+
+#if NN_F_NEON
+    static inline float32x4_t _exp4(float32x4_t x)
+    {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(EXP_MIN)), vdupq_n_f32(EXP_MAX));
+        float32x4_t t = vmlaq_n_f32(vdupq_n_f32(0.5f), x, EXP_LOG2E);
+        float32x4_t fn = vcvtq_f32_s32(vcvtq_s32_f32(t));
+        uint32x4_t m = vcgtq_f32(fn, t); // truncated up for negative value, floor it
+        fn = vsubq_f32(fn, vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(one))));
+        float32x4_t r = vmlsq_n_f32(x, fn, EXP_LN2_HI);
+        r = vmlaq_n_f32(r, fn, EXP_LN2_LO);
+        float32x4_t p = vdupq_n_f32(EXP_C0);
+        p = vmlaq_f32(vdupq_n_f32(EXP_C1), p, r);
+        p = vmlaq_f32(vdupq_n_f32(EXP_C2), p, r);
+        p = vmlaq_f32(vdupq_n_f32(EXP_C3), p, r);
+        p = vmlaq_f32(vdupq_n_f32(EXP_C4), p, r);
+        p = vmlaq_f32(vdupq_n_f32(EXP_C5), p, r);
+        p = vmlaq_f32(vaddq_f32(r, one), vmulq_f32(p, r), r);
+        int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(fn), vdupq_n_s32(127)), 23);
+        return vmulq_f32(p, vreinterpretq_f32_s32(e));
+    }
+
+    static inline float32x4_t _div4(float32x4_t a, float32x4_t b)
+    {
+#if defined(__aarch64__)
+        return vdivq_f32(a, b);
+#else
+        float32x4_t r = vrecpeq_f32(b);
+        r = vmulq_f32(r, vrecpsq_f32(b, r));
+        r = vmulq_f32(r, vrecpsq_f32(b, r));
+        return vmulq_f32(a, r);
+#endif
+    }
+
+    static inline float _hmax4(float32x4_t v)
+    {
+#if defined(__aarch64__)
+        return vmaxvq_f32(v);
+#else
+        float32x2_t m = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+        m = vpmax_f32(m, m);
+        return vget_lane_f32(m, 0);
+#endif
+    }
+
+    static inline float _hsum4(float32x4_t v)
+    {
+#if defined(__aarch64__)
+        return vaddvq_f32(v);
+#else
+        float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        s = vpadd_f32(s, s);
+        return vget_lane_f32(s, 0);
+#endif
+    }
+#elif NN_F_RVV
+    static inline vfloat32m2_t _exp_rvv(vfloat32m2_t x, size_t vl)
+    {
+        x = __riscv_vfmin_vf_f32m2(__riscv_vfmax_vf_f32m2(x, EXP_MIN, vl), EXP_MAX, vl);
+        vfloat32m2_t t = __riscv_vfmacc_vf_f32m2(__riscv_vfmv_v_f_f32m2(0.5f, vl), EXP_LOG2E, x, vl);
+        vfloat32m2_t fn = __riscv_vfcvt_f_x_v_f32m2(__riscv_vfcvt_rtz_x_f_v_i32m2(t, vl), vl);
+        vbool16_t m = __riscv_vmfgt_vv_f32m2_b16(fn, t, vl);
+        fn = __riscv_vfsub_vf_f32m2_mu(m, fn, fn, 1.0f, vl);
+        vfloat32m2_t r = __riscv_vfnmsac_vf_f32m2(x, EXP_LN2_HI, fn, vl);
+        r = __riscv_vfmacc_vf_f32m2(r, EXP_LN2_LO, fn, vl);
+        vfloat32m2_t p = __riscv_vfmv_v_f_f32m2(EXP_C0, vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfmv_v_f_f32m2(EXP_C1, vl), vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfmv_v_f_f32m2(EXP_C2, vl), vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfmv_v_f_f32m2(EXP_C3, vl), vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfmv_v_f_f32m2(EXP_C4, vl), vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfmv_v_f_f32m2(EXP_C5, vl), vl);
+        p = __riscv_vfmul_vv_f32m2(p, r, vl);
+        p = __riscv_vfmadd_vv_f32m2(p, r, __riscv_vfadd_vf_f32m2(r, 1.0f, vl), vl);
+        vint32m2_t e = __riscv_vfcvt_rtz_x_f_v_i32m2(fn, vl);
+        e = __riscv_vsll_vx_i32m2(__riscv_vadd_vx_i32m2(e, 127, vl), 23, vl);
+        return __riscv_vfmul_vv_f32m2(p, __riscv_vreinterpret_v_i32m2_f32m2(e), vl);
+    }
+#elif NN_F_SSE
+    static inline __m128 _exp4(__m128 x)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_MIN)), _mm_set1_ps(EXP_MAX));
+        __m128 t = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(EXP_LOG2E)), _mm_set1_ps(0.5f));
+        __m128 fn = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+        fn = _mm_sub_ps(fn, _mm_and_ps(_mm_cmpgt_ps(fn, t), one)); // truncated up for negative value, floor it
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(EXP_LN2_HI)));
+        r = _mm_add_ps(r, _mm_mul_ps(fn, _mm_set1_ps(EXP_LN2_LO)));
+        __m128 p = _mm_set1_ps(EXP_C0);
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXP_C1));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXP_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXP_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXP_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXP_C5));
+        p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r), r), r), one);
+        __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fn), _mm_set1_epi32(127)), 23);
+        return _mm_mul_ps(p, _mm_castsi128_ps(e));
+    }
+
+    static inline float _hmax4(__m128 v)
+    {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    }
+
+    static inline float _hsum4(__m128 v)
+    {
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    }
+#endif
+
+    const char *simd()
+    {
+#if NN_F_NEON
+        return "neon";
+#elif NN_F_RVV
+        return "rvv";
+#elif NN_F_SSE
+        return "sse2";
+#else
+        return "none";
+#endif
+    }
+
+    void fast_exp(const float *in, float *out, int n)
+    {
+        int i = 0;
+#if NN_F_NEON
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32(out + i, _exp4(vld1q_f32(in + i)));
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m2(n - i);
+            __riscv_vse32_v_f32m2(out + i, _exp_rvv(__riscv_vle32_v_f32m2(in + i, vl), vl), vl);
+        }
+#elif NN_F_SSE
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(out + i, _exp4(_mm_loadu_ps(in + i)));
+#endif
+        for (; i < n; ++i)
+            out[i] = fast_exp(in[i]);
+    }
+
+    void sigmoid(const float *in, float *out, int n)
+    {
+        int i = 0;
+#if NN_F_NEON
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t e = _exp4(vnegq_f32(vld1q_f32(in + i)));
+            vst1q_f32(out + i, _div4(one, vaddq_f32(one, e)));
+        }
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m2(n - i);
+            vfloat32m2_t e = _exp_rvv(__riscv_vfneg_v_f32m2(__riscv_vle32_v_f32m2(in + i, vl), vl), vl);
+            __riscv_vse32_v_f32m2(out + i, __riscv_vfrdiv_vf_f32m2(__riscv_vfadd_vf_f32m2(e, 1.0f, vl), 1.0f, vl), vl);
+        }
+#elif NN_F_SSE
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 e = _exp4(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(in + i)));
+            _mm_storeu_ps(out + i, _mm_div_ps(one, _mm_add_ps(one, e)));
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = sigmoid(in[i]);
+    }
 
-    static void _softmax(float *data, int n)
+    static float _max(const float *data, int n)
+    {
+        float max = data[0];
+        int i = 0;
+#if NN_F_NEON
+        if (n >= 4)
+        {
+            float32x4_t m = vld1q_f32(data);
+            for (i = 4; i + 4 <= n; i += 4)
+                m = vmaxq_f32(m, vld1q_f32(data + i));
+            max = _hmax4(m);
+        }
+#elif NN_F_RVV
+        vfloat32m1_t m = __riscv_vfmv_s_f_f32m1(max, 1);
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m4(n - i);
+            m = __riscv_vfredmax_vs_f32m4_f32m1(__riscv_vle32_v_f32m4(data + i, vl), m, vl);
+        }
+        max = __riscv_vfmv_f_s_f32m1_f32(m);
+#elif NN_F_SSE
+        if (n >= 4)
+        {
+            __m128 m = _mm_loadu_ps(data);
+            for (i = 4; i + 4 <= n; i += 4)
+                m = _mm_max_ps(m, _mm_loadu_ps(data + i));
+            max = _hmax4(m);
+        }
+#endif
+        for (; i < n; ++i)
+            max = data[i] > max ? data[i] : max;
+        return max;
+    }
+
+    /**
+     * out[i] = exp(data[i] - bias) if out not NULL, return sum of exp(data[i] - bias).
+     */
+    static float _exp_sum(const float *data, float *out, int n, float bias)
     {
-        int stride = 1;
-        int i;
-        // int diff;
-        // float e;
         float sum = 0;
-        float largest_i = data[0];
+        int i = 0;
+#if NN_F_NEON
+        float32x4_t b = vdupq_n_f32(bias);
+        float32x4_t s = vdupq_n_f32(0);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t e = _exp4(vsubq_f32(vld1q_f32(data + i), b));
+            if (out)
+                vst1q_f32(out + i, e);
+            s = vaddq_f32(s, e);
+        }
+        sum = _hsum4(s);
+#elif NN_F_RVV
+        vfloat32m1_t s = __riscv_vfmv_s_f_f32m1(0.0f, 1);
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m2(n - i);
+            vfloat32m2_t e = _exp_rvv(__riscv_vfsub_vf_f32m2(__riscv_vle32_v_f32m2(data + i, vl), bias, vl), vl);
+            if (out)
+                __riscv_vse32_v_f32m2(out + i, e, vl);
+            s = __riscv_vfredusum_vs_f32m2_f32m1(e, s, vl);
+        }
+        sum = __riscv_vfmv_f_s_f32m1_f32(s);
+#elif NN_F_SSE
+        __m128 b = _mm_set1_ps(bias);
+        __m128 s = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 e = _exp4(_mm_sub_ps(_mm_loadu_ps(data + i), b));
+            if (out)
+                _mm_storeu_ps(out + i, e);
+            s = _mm_add_ps(s, e);
+        }
+        sum = _hsum4(s);
+#endif
+        for (; i < n; ++i)
+        {
+            float e = fast_exp(data[i] - bias);
+            if (out)
+                out[i] = e;
+            sum += e;
+        }
+        return sum;
+    }
 
-        for (i = 1; i < n; ++i)
+    /**
+     * data[i] = data[i] * a + b
+     */
+    static void _scale(float *data, int n, float a, float b)
+    {
+        int i = 0;
+#if NN_F_NEON
+        float32x4_t va = vdupq_n_f32(a);
+        float32x4_t vb = vdupq_n_f32(b);
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32(data + i, vmlaq_f32(vb, vld1q_f32(data + i), va));
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m8(n - i);
+            vfloat32m8_t v = __riscv_vle32_v_f32m8(data + i, vl);
+            __riscv_vse32_v_f32m8(data + i, __riscv_vfadd_vf_f32m8(__riscv_vfmul_vf_f32m8(v, a, vl), b, vl), vl);
+        }
+#elif NN_F_SSE
+        __m128 va = _mm_set1_ps(a);
+        __m128 vb = _mm_set1_ps(b);
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(data + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(data + i), va), vb));
+#endif
+        for (; i < n; ++i)
+            data[i] = data[i] * a + b;
+    }
+
+    void softmax(float *data, int n, int stride)
+    {
+        if (n <= 0)
+            return;
+        if (stride == 1)
+        {
+            float sum = _exp_sum(data, data, n, _max(data, n));
+            _scale(data, n, 1.0f / sum, 0);
+            return;
+        }
+        float max = data[0];
+        for (int i = 1; i < n; ++i)
+            max = data[i * stride] > max ? data[i * stride] : max;
+        float sum = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            float e = fast_exp(data[i * stride] - max);
+            data[i * stride] = e;
+            sum += e;
+        }
+        float inv = 1.0f / sum;
+        for (int i = 0; i < n; ++i)
+            data[i * stride] *= inv;
+    }
+
+    void log_softmax(float *data, int n, int stride)
+    {
+        if (n <= 0)
+            return;
+        if (stride == 1)
+        {
+            float max = _max(data, n);
+            float lse = max + logf(_exp_sum(data, NULL, n, max));
+            _scale(data, n, 1.0f, -lse);
+            return;
+        }
+        float max = data[0];
+        for (int i = 1; i < n; ++i)
+            max = data[i * stride] > max ? data[i * stride] : max;
+        float sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += fast_exp(data[i * stride] - max);
+        float lse = max + logf(sum);
+        for (int i = 0; i < n; ++i)
+            data[i * stride] -= lse;
+    }
+
+    int argmax(const float *data, int n, int stride)
+    {
+        if (n <= 1)
+            return 0;
+        if (stride != 1)
+            return argmax<float>(data, n, stride);
+        // vectorized max, then the first index equal to it
+        float max = _max(data, n);
+        for (int i = 0; i < n; ++i)
+        {
+            if (data[i] == max)
+                return i;
+        }
+        return argmax<float>(data, n, 1); // NaN in data
+    }
+
+    void topk(const float *data, int n, int k, std::vector<std::pair<int, float>> &result, int stride)
+    {
+        // larger value first, equal value smaller index first
+        auto better = [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        };
+        result.clear();
+        if (n <= 0)
+            return;
+        if (k <= 0 || k >= n)
+        {
+            result.resize(n);
+            for (int i = 0; i < n; ++i)
+                result[i] = std::make_pair(i, data[i * stride]);
+            std::sort(result.begin(), result.end(), better);
+            return;
+        }
+        // heap top is the worst one of k best, most values only compare with it
+        result.reserve(k);
+        for (int i = 0; i < k; ++i)
+            result.push_back(std::make_pair(i, data[i * stride]));
+        std::make_heap(result.begin(), result.end(), better);
+        float worst = result.front().second;
+        for (int i = k; i < n; ++i)
+        {
+            float v = data[i * stride];
+            if (v <= worst)
+                continue;
+            std::pop_heap(result.begin(), result.end(), better);
+            result.back() = std::make_pair(i, v);
+            std::push_heap(result.begin(), result.end(), better);
+            worst = result.front().second;
+        }
+        std::sort_heap(result.begin(), result.end(), better);
+    }
+
+    void dequantize(const int8_t *in, float *out, int n, float scale, int zero_point)
+    {
+        int i = 0;
+        float bias = -zero_point * scale;
+#if NN_F_NEON
+        float32x4_t s = vdupq_n_f32(scale);
+        float32x4_t b = vdupq_n_f32(bias);
+        for (; i + 8 <= n; i += 8)
+        {
+            int16x8_t v = vmovl_s8(vld1_s8(in + i));
+            vst1q_f32(out + i, vmlaq_f32(b, vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), s));
+            vst1q_f32(out + i + 4, vmlaq_f32(b, vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), s));
+        }
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            vint32m4_t v = __riscv_vsext_vf4_i32m4(__riscv_vle8_v_i8m1(in + i, vl), vl);
+            vfloat32m4_t f = __riscv_vfcvt_f_x_v_f32m4(v, vl);
+            __riscv_vse32_v_f32m4(out + i, __riscv_vfadd_vf_f32m4(__riscv_vfmul_vf_f32m4(f, scale, vl), bias, vl), vl);
+        }
+#elif NN_F_SSE
+        __m128 s = _mm_set1_ps(scale);
+        __m128 b = _mm_set1_ps(bias);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+            // sign extend by unpack to high byte then arithmetic shift
+            __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+            __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+            __m128i w[4] = {_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+                            _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)};
+            for (int j = 0; j < 4; ++j)
+                _mm_storeu_ps(out + i + j * 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(w[j]), s), b));
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = in[i] * scale + bias;
+    }
+
+    void dequantize(const uint8_t *in, float *out, int n, float scale, int zero_point)
+    {
+        int i = 0;
+        float bias = -zero_point * scale;
+#if NN_F_NEON
+        float32x4_t s = vdupq_n_f32(scale);
+        float32x4_t b = vdupq_n_f32(bias);
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t v = vmovl_u8(vld1_u8(in + i));
+            vst1q_f32(out + i, vmlaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), s));
+            vst1q_f32(out + i + 4, vmlaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), s));
+        }
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            vuint32m4_t v = __riscv_vzext_vf4_u32m4(__riscv_vle8_v_u8m1(in + i, vl), vl);
+            vfloat32m4_t f = __riscv_vfcvt_f_xu_v_f32m4(v, vl);
+            __riscv_vse32_v_f32m4(out + i, __riscv_vfadd_vf_f32m4(__riscv_vfmul_vf_f32m4(f, scale, vl), bias, vl), vl);
+        }
+#elif NN_F_SSE
+        __m128 s = _mm_set1_ps(scale);
+        __m128 b = _mm_set1_ps(bias);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            __m128i w[4] = {_mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+            for (int j = 0; j < 4; ++j)
+                _mm_storeu_ps(out + i + j * 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(w[j]), s), b));
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = in[i] * scale + bias;
+    }
+
+    void bf16_to_float(const uint16_t *in, float *out, int n)
+    {
+        int i = 0;
+#if NN_F_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t v = vld1q_u16(in + i);
+            vst1q_f32(out + i, vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(v), 16)));
+            vst1q_f32(out + i + 4, vreinterpretq_f32_u32(vshll_n_u16(vget_high_u16(v), 16)));
+        }
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e16m2(n - i);
+            vuint32m4_t v = __riscv_vzext_vf2_u32m4(__riscv_vle16_v_u16m2(in + i, vl), vl);
+            __riscv_vse32_v_u32m4((uint32_t *)(out + i), __riscv_vsll_vx_u32m4(v, 16, vl), vl);
+        }
+#elif NN_F_SSE
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+            _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi16(zero, v));
+            _mm_storeu_si128((__m128i *)(out + i + 4), _mm_unpackhi_epi16(zero, v));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            uint32_t v = (uint32_t)in[i] << 16;
+            memcpy(out + i, &v, sizeof(v));
+        }
+    }
+
+    float l2_normalize(float *data, int n, float eps)
+    {
+        float sum = 0;
+        int i = 0;
+#if NN_F_NEON
+        float32x4_t s = vdupq_n_f32(0);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t v = vld1q_f32(data + i);
+            s = vmlaq_f32(s, v, v);
+        }
+        sum = _hsum4(s);
+#elif NN_F_RVV
+        vfloat32m1_t s = __riscv_vfmv_s_f_f32m1(0.0f, 1);
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m4(n - i);
+            vfloat32m4_t v = __riscv_vle32_v_f32m4(data + i, vl);
+            s = __riscv_vfredusum_vs_f32m4_f32m1(__riscv_vfmul_vv_f32m4(v, v, vl), s, vl);
+        }
+        sum = __riscv_vfmv_f_s_f32m1_f32(s);
+#elif NN_F_SSE
+        __m128 s = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(data + i);
+            s = _mm_add_ps(s, _mm_mul_ps(v, v));
+        }
+        sum = _hsum4(s);
+#endif
+        for (; i < n; ++i)
+            sum += data[i] * data[i];
+        float norm = sqrtf(sum);
+        if (norm >= eps)
+            _scale(data, n, 1.0f / norm, 0);
+        return norm;
+    }
+
+    void iou(const float box[4], const float *x, const float *y, const float *w, const float *h, int n, float *out)
+    {
+        float x1 = box[0], y1 = box[1], x2 = box[0] + box[2], y2 = box[1] + box[3];
+        float area = box[2] * box[3];
+        int i = 0;
+#if NN_F_NEON
+        float32x4_t vx1 = vdupq_n_f32(x1), vy1 = vdupq_n_f32(y1), vx2 = vdupq_n_f32(x2), vy2 = vdupq_n_f32(y2);
+        float32x4_t va = vdupq_n_f32(area), zero = vdupq_n_f32(0);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t bx = vld1q_f32(x + i), by = vld1q_f32(y + i), bw = vld1q_f32(w + i), bh = vld1q_f32(h + i);
+            float32x4_t wi = vsubq_f32(vminq_f32(vx2, vaddq_f32(bx, bw)), vmaxq_f32(vx1, bx));
+            float32x4_t hi = vsubq_f32(vminq_f32(vy2, vaddq_f32(by, bh)), vmaxq_f32(vy1, by));
+            float32x4_t inter = vmulq_f32(vmaxq_f32(wi, zero), vmaxq_f32(hi, zero));
+            float32x4_t uni = vsubq_f32(vmlaq_f32(va, bw, bh), inter);
+            uint32x4_t valid = vcgtq_f32(uni, zero);
+            float32x4_t r = _div4(inter, vbslq_f32(valid, uni, vdupq_n_f32(1.0f)));
+            vst1q_f32(out + i, vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(r))));
+        }
+#elif NN_F_RVV
+        for (size_t vl; i < n; i += vl)
         {
-            if (data[i * stride] > largest_i)
-                largest_i = data[i * stride];
+            vl = __riscv_vsetvl_e32m2(n - i);
+            vfloat32m2_t bx = __riscv_vle32_v_f32m2(x + i, vl), by = __riscv_vle32_v_f32m2(y + i, vl);
+            vfloat32m2_t bw = __riscv_vle32_v_f32m2(w + i, vl), bh = __riscv_vle32_v_f32m2(h + i, vl);
+            vfloat32m2_t wi = __riscv_vfsub_vv_f32m2(__riscv_vfmin_vf_f32m2(__riscv_vfadd_vv_f32m2(bx, bw, vl), x2, vl),
+                                                     __riscv_vfmax_vf_f32m2(bx, x1, vl), vl);
+            vfloat32m2_t hi = __riscv_vfsub_vv_f32m2(__riscv_vfmin_vf_f32m2(__riscv_vfadd_vv_f32m2(by, bh, vl), y2, vl),
+                                                     __riscv_vfmax_vf_f32m2(by, y1, vl), vl);
+            vfloat32m2_t inter = __riscv_vfmul_vv_f32m2(__riscv_vfmax_vf_f32m2(wi, 0.0f, vl), __riscv_vfmax_vf_f32m2(hi, 0.0f, vl), vl);
+            vfloat32m2_t uni = __riscv_vfsub_vv_f32m2(__riscv_vfadd_vf_f32m2(__riscv_vfmul_vv_f32m2(bw, bh, vl), area, vl), inter, vl);
+            vbool16_t valid = __riscv_vmfgt_vf_f32m2_b16(uni, 0.0f, vl);
+            vfloat32m2_t r = __riscv_vfdiv_vv_f32m2_mu(valid, __riscv_vfmv_v_f_f32m2(0.0f, vl), inter, uni, vl);
+            __riscv_vse32_v_f32m2(out + i, r, vl);
         }
-        for (i = 0; i < n; ++i)
+#elif NN_F_SSE
+        __m128 vx1 = _mm_set1_ps(x1), vy1 = _mm_set1_ps(y1), vx2 = _mm_set1_ps(x2), vy2 = _mm_set1_ps(y2);
+        __m128 va = _mm_set1_ps(area), zero = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4)
         {
-            float value = expf(data[i * stride] - largest_i);
-            sum += value;
-            data[i * stride] = value;
+            __m128 bx = _mm_loadu_ps(x + i), by = _mm_loadu_ps(y + i), bw = _mm_loadu_ps(w + i), bh = _mm_loadu_ps(h + i);
+            __m128 wi = _mm_sub_ps(_mm_min_ps(vx2, _mm_add_ps(bx, bw)), _mm_max_ps(vx1, bx));
+            __m128 hi = _mm_sub_ps(_mm_min_ps(vy2, _mm_add_ps(by, bh)), _mm_max_ps(vy1, by));
+            __m128 inter = _mm_mul_ps(_mm_max_ps(wi, zero), _mm_max_ps(hi, zero));
+            __m128 uni = _mm_sub_ps(_mm_add_ps(va, _mm_mul_ps(bw, bh)), inter);
+            __m128 valid = _mm_cmpgt_ps(uni, zero);
+            __m128 r = _mm_div_ps(inter, _mm_or_ps(_mm_and_ps(valid, uni), _mm_andnot_ps(valid, _mm_set1_ps(1.0f))));
+            _mm_storeu_ps(out + i, _mm_and_ps(valid, r));
         }
-        for (i = 0; i < n; ++i)
+#endif
+        for (; i < n; ++i)
         {
-            data[i * stride] /= sum;
+            float wi = std::min(x2, x[i] + w[i]) - std::max(x1, x[i]);
+            float hi = std::min(y2, y[i] + h[i]) - std::max(y1, y[i]);
+            float inter = std::max(wi, 0.0f) * std::max(hi, 0.0f);
+            float uni = area + w[i] * h[i] - inter;
+            out[i] = uni > 0 ? inter / uni : 0;
         }
     }
 
@@ -45,11 +643,11 @@ namespace maix::nn::F
         }
         if (replace)
         {
-            _softmax((float *)tensor->data(), tensor->size_int());
+            softmax((float *)tensor->data(), tensor->size_int());
             return tensor;
         }
         maix::tensor::Tensor *t = new maix::tensor::Tensor(tensor->shape(), tensor->dtype(), tensor->data(), true);
-        _softmax((float *)t->data(), t->size_int());
+        softmax((float *)t->data(), t->size_int());
         return t;
     }
 
@@ -0,0 +1,850 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add feature vector index for large face galleries.
+ */
+
+#include "maix_nn_feature_index.hpp"
+#include "maix_basic.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define FEA_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define FEA_RVV 1
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define FEA_AVX2 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define FEA_SSE2 1
+#endif
+
+namespace maix::nn
+{
+    #define FEA_INDEX_MAGIC "MAIXFIDX"
+    #define FEA_INDEX_VERSION 1
+    #define FEA_INDEX_ALIGN 64
+
+    /*
+     * File layout, little endian, every section aligned to 64 bytes:
+     *   header | rows | int8 scales | centroids | assign | list offsets | list ids | label offsets + label chars
+     */
+    typedef struct
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t dim;
+        uint32_t count;
+        uint32_t dtype;
+        uint32_t nlist;
+        uint32_t nprobe;
+        uint64_t rows_offset;
+        uint64_t scales_offset;      // 0 if dtype not int8
+        uint64_t centroids_offset;   // 0 if no IVF
+        uint64_t assign_offset;
+        uint64_t list_offset_offset;
+        uint64_t list_ids_offset;
+        uint64_t labels_offset;      // 0 if no labels, count + 1 uint32 offsets then chars
+        uint64_t labels_size;
+        uint64_t file_size;
+    } _index_header_t;
+
+    /*********************** fp16 ***********************/
+
+    static inline float _half_to_float(uint16_t h)
+    {
+        uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+        uint32_t exp = (h >> 10) & 0x1f;
+        uint32_t mant = h & 0x3ff;
+        uint32_t bits;
+        if (exp == 0)
+        {
+            if (mant == 0)
+                bits = sign;
+            else
+            {
+                // subnormal, normalize it
+                exp = 127 - 15 + 1;
+                while (!(mant & 0x400))
+                {
+                    mant <<= 1;
+                    --exp;
+                }
+                bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+            }
+        }
+        else if (exp == 0x1f)
+            bits = sign | 0x7f800000 | (mant << 13);
+        else
+            bits = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+        float f;
+        memcpy(&f, &bits, 4);
+        return f;
+    }
+
+    static inline uint16_t _float_to_half(float f)
+    {
+        uint32_t bits;
+        memcpy(&bits, &f, 4);
+        uint16_t sign = (bits >> 16) & 0x8000;
+        int exp = (int)((bits >> 23) & 0xff) - 127 + 15;
+        uint32_t mant = bits & 0x7fffff;
+        if (exp >= 0x1f)
+            return sign | 0x7c00;
+        if (exp <= 0)
+        {
+            if (exp < -10)
+                return sign;
+            mant |= 0x800000;
+            int shift = 14 - exp;
+            uint32_t half = mant >> shift;
+            // round to nearest even
+            uint32_t rem = mant & ((1u << shift) - 1);
+            uint32_t mid = 1u << (shift - 1);
+            if (rem > mid || (rem == mid && (half & 1)))
+                ++half;
+            return sign | (uint16_t)half;
+        }
+        uint16_t half = sign | (uint16_t)(exp << 10) | (uint16_t)(mant >> 13);
+        uint32_t rem = mant & 0x1fff;
+        if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+            ++half; // may carry to exponent, still correct
+        return half;
+    }
+
+    /*********************** dot product kernels ***********************/
+
+    static float _dot_f32(const float *a, const float *b, int n)
+    {
+        int i = 0;
+        float sum = 0;
+#if FEA_NEON
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        float32x4_t acc = vaddq_f32(acc0, acc1);
+        float32x2_t s2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+        sum = vget_lane_f32(vpadd_f32(s2, s2), 0);
+#elif FEA_RVV
+        size_t vlmax = __riscv_vsetvlmax_e32m4();
+        vfloat32m4_t acc = __riscv_vfmv_v_f_f32m4(0, vlmax);
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m4(n - i);
+            vfloat32m4_t va = __riscv_vle32_v_f32m4(a + i, vl);
+            vfloat32m4_t vb = __riscv_vle32_v_f32m4(b + i, vl);
+            acc = __riscv_vfmacc_vv_f32m4_tu(acc, va, vb, vl);
+        }
+        vfloat32m1_t s = __riscv_vfredusum_vs_f32m4_f32m1(acc, __riscv_vfmv_v_f_f32m1(0, 1), vlmax);
+        sum = __riscv_vfmv_f_s_f32m1_f32(s);
+#elif FEA_AVX2
+        __m256 acc = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        sum = _mm_cvtss_f32(s);
+#elif FEA_SSE2
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        sum = _mm_cvtss_f32(acc);
+#endif
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    static int32_t _dot_i8(const int8_t *a, const int8_t *b, int n)
+    {
+        int i = 0;
+        int32_t sum = 0;
+#if FEA_NEON
+        int32x4_t acc = vdupq_n_s32(0);
+        for (; i + 16 <= n; i += 16)
+        {
+            int8x16_t va = vld1q_s8(a + i);
+            int8x16_t vb = vld1q_s8(b + i);
+            int16x8_t p = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+            p = vmlal_s8(p, vget_high_s8(va), vget_high_s8(vb)); // 2 * 127 * 127 fits int16
+            acc = vpadalq_s16(acc, p);
+        }
+        int32x2_t s2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        sum = vget_lane_s32(vpadd_s32(s2, s2), 0);
+#elif FEA_RVV
+        vint32m1_t acc = __riscv_vmv_v_x_i32m1(0, 1);
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m2(n - i);
+            vint16m4_t p = __riscv_vwmul_vv_i16m4(__riscv_vle8_v_i8m2(a + i, vl), __riscv_vle8_v_i8m2(b + i, vl), vl);
+            acc = __riscv_vwredsum_vs_i16m4_i32m1(p, acc, vl);
+        }
+        sum = __riscv_vmv_x_s_i32m1_i32(acc);
+#elif FEA_AVX2
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+            __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+        sum = _mm_cvtsi128_si32(s);
+#elif FEA_SSE2
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+            // sign extend int8 to int16: unpack to high byte then arithmetic shift
+            __m128i a_lo = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+            __m128i a_hi = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+            __m128i b_lo = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+            __m128i b_hi = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(a_lo, b_lo));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(a_hi, b_hi));
+        }
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+        sum = _mm_cvtsi128_si32(acc);
+#endif
+        for (; i < n; ++i)
+            sum += (int32_t)a[i] * b[i];
+        return sum;
+    }
+
+    static float _dot_f16(const float *q, const uint16_t *h, int n)
+    {
+        int i = 0;
+        float sum = 0;
+#if FEA_NEON && defined(__aarch64__)
+        float32x4_t acc = vdupq_n_f32(0);
+        for (; i + 4 <= n; i += 4)
+            acc = vfmaq_f32(acc, vld1q_f32(q + i), vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(h + i))));
+        sum = vaddvq_f32(acc);
+#elif FEA_AVX2 && defined(__F16C__)
+        __m256 acc = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(q + i), _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(h + i)))));
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        sum = _mm_cvtss_f32(s);
+#endif
+        for (; i < n; ++i)
+            sum += q[i] * _half_to_float(h[i]);
+        return sum;
+    }
+
+    const char *FeatureIndex::simd()
+    {
+#if FEA_NEON
+        return "neon";
+#elif FEA_RVV
+        return "rvv";
+#elif FEA_AVX2
+        return "avx2";
+#elif FEA_SSE2
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    /*********************** helpers ***********************/
+
+    static void _normalize(const float *in, float *out, int n)
+    {
+        float norm = sqrtf(_dot_f32(in, in, n));
+        float k = norm > 1e-12f ? 1.0f / norm : 0;
+        for (int i = 0; i < n; ++i)
+            out[i] = in[i] * k;
+    }
+
+    // quantize normalized vector to int8, symmetric, return scale(value = q * scale)
+    static float _quant_i8(const float *in, int8_t *out, int n)
+    {
+        float max_v = 0;
+        for (int i = 0; i < n; ++i)
+            max_v = std::max(max_v, fabsf(in[i]));
+        float scale = max_v > 0 ? max_v / 127 : 1;
+        float k = 1 / scale;
+        for (int i = 0; i < n; ++i)
+            out[i] = (int8_t)lrintf(std::min(127.0f, std::max(-127.0f, in[i] * k)));
+        return scale;
+    }
+
+    static inline size_t _align(size_t v)
+    {
+        return (v + FEA_INDEX_ALIGN - 1) & ~(size_t)(FEA_INDEX_ALIGN - 1);
+    }
+
+    // keep k best (score descending, index ascending on tie), result is a min heap on best
+    class _TopK
+    {
+    public:
+        _TopK(int k, std::vector<std::pair<int, float>> &result) : _k(k), _r(result)
+        {
+            _r.clear();
+            _r.reserve(k);
+        }
+
+        static bool worse(const std::pair<int, float> &a, const std::pair<int, float> &b)
+        {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        }
+
+        inline void push(int idx, float score)
+        {
+            if ((int)_r.size() < _k)
+            {
+                _r.emplace_back(idx, score);
+                std::push_heap(_r.begin(), _r.end(), worse);
+            }
+            else if (score > _r.front().second)
+            {
+                std::pop_heap(_r.begin(), _r.end(), worse);
+                _r.back() = std::make_pair(idx, score);
+                std::push_heap(_r.begin(), _r.end(), worse);
+            }
+        }
+
+        void finish()
+        {
+            std::sort(_r.begin(), _r.end(), worse);
+        }
+
+    private:
+        int _k;
+        std::vector<std::pair<int, float>> &_r;
+    };
+
+    /*********************** FeatureIndex ***********************/
+
+    FeatureIndex::FeatureIndex(int dim, tensor::DType dtype)
+        : _map(nullptr), _map_size(0)
+    {
+        if (reset(dim, dtype) != err::ERR_NONE)
+            throw err::Exception(err::ERR_ARGS, "feature index dtype only support FLOAT32, FLOAT16 and INT8");
+    }
+
+    FeatureIndex::~FeatureIndex()
+    {
+        _unmap();
+    }
+
+    void FeatureIndex::_unmap()
+    {
+        if (_map)
+        {
+            munmap(_map, _map_size);
+            _map = nullptr;
+            _map_size = 0;
+        }
+    }
+
+    err::Err FeatureIndex::reset(int dim, tensor::DType dtype)
+    {
+        if (dtype != tensor::DType::FLOAT32 && dtype != tensor::DType::FLOAT16 && dtype != tensor::DType::INT8)
+            return err::ERR_ARGS;
+        _unmap();
+        _dim = dim < 0 ? 0 : dim;
+        _dtype = dtype;
+        _count = 0;
+        _row_bytes = _dim * tensor::dtype_size[dtype];
+        _data.clear();
+        _scales_buff.clear();
+        _rows = nullptr;
+        _scales = nullptr;
+        _nprobe = 8;
+        clear_ivf();
+        return err::ERR_NONE;
+    }
+
+    void FeatureIndex::clear_ivf()
+    {
+        _materialize();
+        _nlist = 0;
+        _centroids.clear();
+        _assign.clear();
+        _list_offset.clear();
+        _list_ids.clear();
+        _centroids_p = nullptr;
+        _assign_p = nullptr;
+        _list_offset_p = nullptr;
+        _list_ids_p = nullptr;
+    }
+
+    // copy mapped data to memory, so index can be modified
+    void FeatureIndex::_materialize()
+    {
+        if (!_map)
+            return;
+        _data.assign(_rows, _rows + (size_t)_count * _row_bytes);
+        _rows = _data.data();
+        if (_scales)
+        {
+            _scales_buff.assign(_scales, _scales + _count);
+            _scales = _scales_buff.data();
+        }
+        if (_nlist > 0)
+        {
+            _centroids.assign(_centroids_p, _centroids_p + (size_t)_nlist * _dim);
+            _assign.assign(_assign_p, _assign_p + _count);
+            _list_offset.assign(_list_offset_p, _list_offset_p + _nlist + 1);
+            _list_ids.assign(_list_ids_p, _list_ids_p + _count);
+            _centroids_p = _centroids.data();
+            _assign_p = _assign.data();
+            _list_offset_p = _list_offset.data();
+            _list_ids_p = _list_ids.data();
+        }
+        _unmap();
+    }
+
+    void FeatureIndex::_encode(const float *normed, uint8_t *row, float *scale) const
+    {
+        switch (_dtype)
+        {
+        case tensor::DType::INT8:
+            *scale = _quant_i8(normed, (int8_t *)row, _dim);
+            break;
+        case tensor::DType::FLOAT16:
+        {
+            uint16_t *h = (uint16_t *)row;
+            for (int i = 0; i < _dim; ++i)
+                h[i] = _float_to_half(normed[i]);
+            break;
+        }
+        default:
+            memcpy(row, normed, _row_bytes);
+            break;
+        }
+    }
+
+    float FeatureIndex::_dot(const float *q, const int8_t *q8, float q_scale, int idx) const
+    {
+        const uint8_t *row = _rows + (size_t)idx * _row_bytes;
+        switch (_dtype)
+        {
+        case tensor::DType::INT8:
+            return _dot_i8(q8, (const int8_t *)row, _dim) * q_scale * _scales[idx];
+        case tensor::DType::FLOAT16:
+            return _dot_f16(q, (const uint16_t *)row, _dim);
+        default:
+            return _dot_f32(q, (const float *)row, _dim);
+        }
+    }
+
+    int FeatureIndex::_nearest_centroid(const float *normed) const
+    {
+        int best = 0;
+        float best_score = -2;
+        for (int c = 0; c < _nlist; ++c)
+        {
+            float s = _dot_f32(normed, _centroids_p + (size_t)c * _dim, _dim);
+            if (s > best_score)
+            {
+                best_score = s;
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    // rebuild CSR lists of clusters from assign, called by every modify so search never modify index
+    void FeatureIndex::_build_lists()
+    {
+        _list_offset.assign(_nlist + 1, 0);
+        for (int i = 0; i < _count; ++i)
+            ++_list_offset[_assign_p[i] + 1];
+        for (int c = 0; c < _nlist; ++c)
+            _list_offset[c + 1] += _list_offset[c];
+        _list_ids.resize(_count);
+        std::vector<uint32_t> pos(_list_offset.begin(), _list_offset.end() - 1);
+        for (int i = 0; i < _count; ++i)
+            _list_ids[pos[_assign_p[i]]++] = i;
+        _list_offset_p = _list_offset.data();
+        _list_ids_p = _list_ids.data();
+    }
+
+    err::Err FeatureIndex::add(const float *feature, int dim)
+    {
+        if (!feature || dim <= 0 || (_dim > 0 && dim != _dim))
+        {
+            log::error("feature dim %d not match index dim %d", dim, _dim);
+            return err::ERR_ARGS;
+        }
+        _materialize();
+        if (_dim == 0)
+        {
+            _dim = dim;
+            _row_bytes = _dim * tensor::dtype_size[_dtype];
+        }
+        std::vector<float> normed(_dim);
+        _normalize(feature, normed.data(), _dim);
+        _data.resize((size_t)(_count + 1) * _row_bytes);
+        float scale = 1;
+        _encode(normed.data(), _data.data() + (size_t)_count * _row_bytes, &scale);
+        _rows = _data.data();
+        if (_dtype == tensor::DType::INT8)
+        {
+            _scales_buff.push_back(scale);
+            _scales = _scales_buff.data();
+        }
+        ++_count;
+        if (_nlist > 0)
+        {
+            _assign.push_back(_nearest_centroid(normed.data()));
+            _assign_p = _assign.data();
+            _build_lists();
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::remove(int idx)
+    {
+        if (idx < 0 || idx >= _count)
+            return err::ERR_ARGS;
+        _materialize();
+        _data.erase(_data.begin() + (size_t)idx * _row_bytes, _data.begin() + (size_t)(idx + 1) * _row_bytes);
+        _rows = _data.data();
+        if (_dtype == tensor::DType::INT8)
+        {
+            _scales_buff.erase(_scales_buff.begin() + idx);
+            _scales = _scales_buff.data();
+        }
+        --_count;
+        if (_nlist > 0)
+        {
+            _assign.erase(_assign.begin() + idx);
+            _assign_p = _assign.data();
+            _build_lists();
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::feature(int idx, float *out) const
+    {
+        if (idx < 0 || idx >= _count || !out)
+            return err::ERR_ARGS;
+        const uint8_t *row = _rows + (size_t)idx * _row_bytes;
+        for (int i = 0; i < _dim; ++i)
+        {
+            if (_dtype == tensor::DType::INT8)
+                out[i] = ((const int8_t *)row)[i] * _scales[idx];
+            else if (_dtype == tensor::DType::FLOAT16)
+                out[i] = _half_to_float(((const uint16_t *)row)[i]);
+            else
+                out[i] = ((const float *)row)[i];
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::search(const float *query, int dim, int k, std::vector<std::pair<int, float>> &result) const
+    {
+        result.clear();
+        if (!query || dim != _dim || k <= 0)
+        {
+            if (_count > 0)
+                log::error("query dim %d not match index dim %d", dim, _dim);
+            return _count > 0 ? err::ERR_ARGS : err::ERR_NONE;
+        }
+        std::vector<float> q(_dim);
+        _normalize(query, q.data(), _dim);
+        std::vector<int8_t> q8;
+        float q_scale = 1;
+        if (_dtype == tensor::DType::INT8)
+        {
+            q8.resize(_dim);
+            q_scale = _quant_i8(q.data(), q8.data(), _dim);
+        }
+        _TopK top(k, result);
+        if (_nlist == 0 || _nprobe >= _nlist)
+        {
+            for (int i = 0; i < _count; ++i)
+                top.push(i, _dot(q.data(), q8.data(), q_scale, i));
+            top.finish();
+            return err::ERR_NONE;
+        }
+        std::vector<std::pair<int, float>> probes;
+        {
+            _TopK top_c(_nprobe, probes);
+            for (int c = 0; c < _nlist; ++c)
+                top_c.push(c, _dot_f32(q.data(), _centroids_p + (size_t)c * _dim, _dim));
+        }
+        for (auto &p : probes)
+        {
+            for (uint32_t j = _list_offset_p[p.first]; j < _list_offset_p[p.first + 1]; ++j)
+            {
+                int idx = _list_ids_p[j];
+                top.push(idx, _dot(q.data(), q8.data(), q_scale, idx));
+            }
+        }
+        top.finish();
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::build_ivf(int nlist, int nprobe, int iters)
+    {
+        if (nlist <= 0)
+            nlist = (int)sqrtf((float)_count);
+        if (nlist < 2 || _count < nlist)
+        {
+            log::error("features not enough to build %d clusters, have %d", nlist, _count);
+            return err::ERR_NOT_READY;
+        }
+        clear_ivf();
+        _nlist = nlist;
+        set_nprobe(nprobe);
+        // spherical k-means, train on at most 64 samples every cluster, then assign all
+        int samples = std::min(_count, nlist * 64);
+        std::vector<float> train((size_t)samples * _dim);
+        for (int i = 0; i < samples; ++i)
+            feature((int)((int64_t)i * _count / samples), train.data() + (size_t)i * _dim);
+        _centroids.resize((size_t)nlist * _dim);
+        for (int c = 0; c < nlist; ++c)
+            memcpy(_centroids.data() + (size_t)c * _dim, train.data() + (size_t)((int64_t)c * samples / nlist) * _dim, _dim * sizeof(float));
+        _centroids_p = _centroids.data();
+        std::vector<int> label(samples);
+        std::vector<float> sum((size_t)nlist * _dim);
+        std::vector<int> num(nlist);
+        for (int it = 0; it < iters; ++it)
+        {
+            std::fill(sum.begin(), sum.end(), 0.0f);
+            std::fill(num.begin(), num.end(), 0);
+            for (int i = 0; i < samples; ++i)
+            {
+                const float *x = train.data() + (size_t)i * _dim;
+                int c = _nearest_centroid(x);
+                label[i] = c;
+                ++num[c];
+                float *s = sum.data() + (size_t)c * _dim;
+                for (int d = 0; d < _dim; ++d)
+                    s[d] += x[d];
+            }
+            for (int c = 0; c < nlist; ++c)
+            {
+                if (num[c] == 0) // empty cluster keep old centroid
+                    continue;
+                _normalize(sum.data() + (size_t)c * _dim, _centroids.data() + (size_t)c * _dim, _dim);
+            }
+        }
+        _assign.resize(_count);
+        std::vector<float> x(_dim);
+        for (int i = 0; i < _count; ++i)
+        {
+            feature(i, x.data());
+            _assign[i] = _nearest_centroid(x.data());
+        }
+        _assign_p = _assign.data();
+        _build_lists();
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::save(const std::string &path, const std::vector<std::string> &labels)
+    {
+        if (!labels.empty() && (int)labels.size() != _count)
+        {
+            log::error("labels size %d not match feature number %d", (int)labels.size(), _count);
+            return err::ERR_ARGS;
+        }
+        _index_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, FEA_INDEX_MAGIC, 8);
+        header.version = FEA_INDEX_VERSION;
+        header.dim = _dim;
+        header.count = _count;
+        header.dtype = _dtype;
+        header.nlist = _nlist;
+        header.nprobe = _nprobe;
+        size_t off = _align(sizeof(header));
+        header.rows_offset = off;
+        off = _align(off + (size_t)_count * _row_bytes);
+        if (_dtype == tensor::DType::INT8)
+        {
+            header.scales_offset = off;
+            off = _align(off + (size_t)_count * sizeof(float));
+        }
+        if (_nlist > 0)
+        {
+            header.centroids_offset = off;
+            off = _align(off + (size_t)_nlist * _dim * sizeof(float));
+            header.assign_offset = off;
+            off = _align(off + (size_t)_count * sizeof(int32_t));
+            header.list_offset_offset = off;
+            off = _align(off + (size_t)(_nlist + 1) * sizeof(uint32_t));
+            header.list_ids_offset = off;
+            off = _align(off + (size_t)_count * sizeof(int32_t));
+        }
+        std::vector<uint32_t> label_offsets;
+        if (!labels.empty())
+        {
+            label_offsets.push_back(0);
+            for (auto &l : labels)
+                label_offsets.push_back(label_offsets.back() + l.size());
+            header.labels_offset = off;
+            header.labels_size = label_offsets.size() * sizeof(uint32_t) + label_offsets.back();
+            off += header.labels_size;
+        }
+        header.file_size = off;
+
+        fs::File *f = fs::open(path, "wb");
+        if (!f)
+        {
+            log::error("open %s failed", path.c_str());
+            return err::ERR_IO;
+        }
+        bool ok = true;
+        auto write_at = [&](uint64_t offset, const void *data, size_t size) {
+            if (!ok || size == 0)
+                return;
+            ok = f->seek((int)offset, SEEK_SET) >= 0;
+            // write in chunks, File::write takes int size
+            const uint8_t *p = (const uint8_t *)data;
+            while (ok && size > 0)
+            {
+                int n = (int)std::min(size, (size_t)(64 << 20));
+                ok = f->write(p, n) == n;
+                p += n;
+                size -= n;
+            }
+        };
+        write_at(0, &header, sizeof(header));
+        write_at(header.rows_offset, _rows, (size_t)_count * _row_bytes);
+        if (header.scales_offset)
+            write_at(header.scales_offset, _scales, (size_t)_count * sizeof(float));
+        if (_nlist > 0)
+        {
+            write_at(header.centroids_offset, _centroids_p, (size_t)_nlist * _dim * sizeof(float));
+            write_at(header.assign_offset, _assign_p, (size_t)_count * sizeof(int32_t));
+            write_at(header.list_offset_offset, _list_offset_p, (size_t)(_nlist + 1) * sizeof(uint32_t));
+            write_at(header.list_ids_offset, _list_ids_p, (size_t)_count * sizeof(int32_t));
+        }
+        if (!labels.empty())
+        {
+            write_at(header.labels_offset, label_offsets.data(), label_offsets.size() * sizeof(uint32_t));
+            uint64_t p = header.labels_offset + label_offsets.size() * sizeof(uint32_t);
+            for (auto &l : labels)
+            {
+                write_at(p, l.data(), l.size());
+                p += l.size();
+            }
+        }
+        f->flush();
+        f->close();
+        delete f;
+        if (!ok)
+        {
+            log::error("write %s failed", path.c_str());
+            return err::ERR_IO;
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err FeatureIndex::load(const std::string &path, std::vector<std::string> *labels, bool use_mmap)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            log::error("open %s failed", path.c_str());
+            return err::ERR_IO;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(_index_header_t))
+        {
+            ::close(fd);
+            log::error("%s is not a feature index file", path.c_str());
+            return err::ERR_ARGS;
+        }
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+        {
+            log::error("mmap %s failed", path.c_str());
+            return err::ERR_IO;
+        }
+        const uint8_t *base = (const uint8_t *)map;
+        const _index_header_t *h = (const _index_header_t *)map;
+        size_t row_bytes = (size_t)h->dim * (h->dtype < tensor::DType::DTYPE_MAX ? tensor::dtype_size[h->dtype] : 0);
+        auto in_file = [&](uint64_t offset, uint64_t size) {
+            return offset + size <= (uint64_t)st.st_size && offset + size >= offset;
+        };
+        bool valid = memcmp(h->magic, FEA_INDEX_MAGIC, 8) == 0 && h->version == FEA_INDEX_VERSION && h->file_size == (uint64_t)st.st_size &&
+                     (h->dtype == tensor::DType::FLOAT32 || h->dtype == tensor::DType::FLOAT16 || h->dtype == tensor::DType::INT8) &&
+                     in_file(h->rows_offset, (uint64_t)h->count * row_bytes) &&
+                     (h->dtype != tensor::DType::INT8 || in_file(h->scales_offset, (uint64_t)h->count * 4));
+        if (valid && h->nlist > 0)
+        {
+            valid = in_file(h->centroids_offset, (uint64_t)h->nlist * h->dim * 4) && in_file(h->assign_offset, (uint64_t)h->count * 4) &&
+                    in_file(h->list_offset_offset, (uint64_t)(h->nlist + 1) * 4) && in_file(h->list_ids_offset, (uint64_t)h->count * 4);
+        }
+        if (valid && h->labels_offset)
+            valid = in_file(h->labels_offset, h->labels_size) && h->labels_size >= (uint64_t)(h->count + 1) * 4;
+        if (!valid)
+        {
+            munmap(map, st.st_size);
+            log::error("%s is not a valid feature index file", path.c_str());
+            return err::ERR_ARGS;
+        }
+
+        reset(h->dim, (tensor::DType)h->dtype);
+        _map = map;
+        _map_size = st.st_size;
+        _count = h->count;
+        _rows = base + h->rows_offset;
+        _scales = h->dtype == tensor::DType::INT8 ? (const float *)(base + h->scales_offset) : nullptr;
+        _nlist = h->nlist;
+        _nprobe = h->nprobe < 1 ? 1 : h->nprobe;
+        if (_nlist > 0)
+        {
+            _centroids_p = (const float *)(base + h->centroids_offset);
+            _assign_p = (const int32_t *)(base + h->assign_offset);
+            _list_offset_p = (const uint32_t *)(base + h->list_offset_offset);
+            _list_ids_p = (const int32_t *)(base + h->list_ids_offset);
+        }
+        if (labels)
+        {
+            labels->clear();
+            if (h->labels_offset)
+            {
+                const uint32_t *offsets = (const uint32_t *)(base + h->labels_offset);
+                const char *chars = (const char *)(offsets + _count + 1);
+                uint64_t chars_size = h->labels_size - (uint64_t)(_count + 1) * 4;
+                labels->reserve(_count);
+                for (int i = 0; i < _count; ++i)
+                {
+                    if (offsets[i] > offsets[i + 1] || offsets[i + 1] > chars_size)
+                    {
+                        reset(0, _dtype);
+                        labels->clear();
+                        log::error("%s labels broken", path.c_str());
+                        return err::ERR_ARGS;
+                    }
+                    labels->emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+                }
+            }
+        }
+        if (!use_mmap)
+            _materialize();
+        return err::ERR_NONE;
+    }
+
+} // namespace maix::nn
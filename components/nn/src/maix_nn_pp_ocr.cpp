@@ -1,5 +1,6 @@
 #include "maix_nn_pp_ocr.hpp"
 #include "pp_ocr_postprocess_op.h"
+#include <algorithm>
 
 namespace maix::nn
 {
@@ -34,221 +35,349 @@ namespace maix::nn
         h = h - y;
     }
 
-    nn::OCR_Objects *PP_OCR::_post_process(image::Image &img, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit)
+    // one model input width part of a text line
+    struct PP_OCR_Line
     {
-        nn::OCR_Objects *objects = new nn::OCR_Objects();
-        // int layer_num = outputs->size();
-        // int i = 0;
-        for (auto it = outputs->begin(); it != outputs->end(); it++)
+        nn::OCR_Object *obj;
+        float t[9]; // homography of model input pixel to source image pixel
+        int slice;  // index of part in text line
+        int width;  // content width, right is padding
+    };
+
+    // scratch memory kept between frames, so post process and recognize
+    // not allocate memory for every text box
+    struct PP_OCR_Priv
+    {
+        PaddleOCR::DBPostProcessor post_processor;
+        cv::Mat bit_map;
+        std::vector<PaddleOCR::DBPostProcessor::TextBox> boxes;
+        std::vector<nn::OCR_Object *> objs;
+        std::vector<PP_OCR_Line> lines;
+        tensor::Tensor *rec_input = nullptr;
+
+        ~PP_OCR_Priv()
         {
-        //     // log::info("output: %s, tensor: %s", it->first.c_str(), it->second->to_str().c_str());
-        //     _get_layer_objs(*objects, *it->second, i++, layer_num);
-            tensor::Tensor *out = it->second;
-            std::vector<int> shape = out->shape(); // 1, 1, h, w
-            image::Image *tmp_img = new image::Image(shape[3], shape[2], image::Format::FMT_GRAYSCALE);
-            float *data = (float*)out->data();
-            float *p_data = data;
-            uint8_t *img_data = (uint8_t*)tmp_img->data();
-            uint8_t *p_img_data = img_data;
-            cv::Mat bit_map(shape[2], shape[3], CV_8UC1);
-            uint8_t *p_binary_data = (uint8_t*)bit_map.data;
-            uint8_t _thresh_uint8 = (uint8_t)(_thresh * 255);
-            for(int i=0; i < shape[3] * shape[2]; ++i)
-            {
-                *p_img_data = (uint8_t)(*p_data * 255);
-                if(*p_img_data > _thresh_uint8)
-                    *p_binary_data = 1;
-                else
-                    *p_binary_data = 0;
-                ++p_data;
-                ++p_img_data;
-                ++p_binary_data;
-            }
+            delete rec_input;
+        }
+    };
 
-            // post process
-            PaddleOCR::DBPostProcessor post_processor;
-            cv::Mat cbuf_map(shape[2], shape[3], CV_8UC1, img_data);
-            cv::Mat pred_map(shape[2], shape[3], CV_32F, data);
-            if (_use_dilation) {
-                cv::Mat dila_ele = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
-                cv::dilate(bit_map, bit_map, dila_ele);
-            }
-            std::vector<float> scores;
-            std::vector<std::vector<std::vector<int>>> boxes = post_processor.BoxesFromBitmap(pred_map, bit_map, _box_thresh, _unclip_ratio, _score_mode, scores);
-            for(size_t i = 0; i < boxes.size(); ++i)
-            {
-                nn::OCR_Box box(boxes[i][0][0], boxes[i][0][1], boxes[i][1][0], boxes[i][1][1], boxes[i][2][0], boxes[i][2][1], boxes[i][3][0], boxes[i][3][1]);
-                std::vector<int> idxes;
-                std::vector<std::string> chars;
-                std::vector<int> char_pos;
-                objects->add(box, idxes, chars, scores[i], char_pos);
-            }
-            delete tmp_img;
+    static PP_OCR_Priv *_get_priv(void *&priv)
+    {
+        if (!priv)
+            priv = new PP_OCR_Priv();
+        return (PP_OCR_Priv *)priv;
+    }
 
-            // correct boxes
-            if(objects->size() > 0)
-                _correct_bbox(*objects, img_w, img_h, fit);
-            // recognize charactors
-            for(size_t i = 0; i < boxes.size(); ++i)
-            {
-                // int x, y, w, h;
-                // _get_external_box(boxes[i], x, y, w, h, shape[3], shape[2]);
-                std::vector<std::string> char_list;
-                nn::OCR_Object &obj = objects->at(i);
-                _recognize(img, obj.box, obj.idx_list, char_list, obj.char_pos, true);
-                obj.update_chars(char_list);
-            }
-            break;
+    void PP_OCR::_free_priv()
+    {
+        delete (PP_OCR_Priv *)_priv;
+        _priv = nullptr;
+    }
+
+    nn::OCR_Objects *PP_OCR::_post_process(image::Image &img, tensor::Tensors *outputs, int img_w, int img_h, maix::image::Fit fit, int rec_batch)
+    {
+        nn::OCR_Objects *objects = new nn::OCR_Objects();
+        if (outputs->size() == 0)
+            return objects;
+        PP_OCR_Priv *priv = _get_priv(_priv);
+        tensor::Tensor *out = outputs->begin()->second;
+        std::vector<int> shape = out->shape(); // 1, 1, h, w
+        int h = shape[2], w = shape[3];
+        float *data = (float *)out->data();
+
+        // binary map, same as (uint8_t)(prob * 255) > (uint8_t)(thresh * 255)
+        priv->bit_map.create(h, w, CV_8UC1);
+        uint8_t *p_binary_data = priv->bit_map.data;
+        float thresh = (uint8_t)(_thresh * 255) + 1;
+        for (int i = 0; i < w * h; ++i)
+            p_binary_data[i] = data[i] * 255 >= thresh ? 1 : 0;
+        if (_use_dilation)
+        {
+            cv::Mat dila_ele = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
+            cv::dilate(priv->bit_map, priv->bit_map, dila_ele);
         }
 
+        // boxes and scores from probability map
+        cv::Mat pred_map(h, w, CV_32F, data);
+        priv->post_processor.BoxesFromBitmap(pred_map, priv->bit_map, _box_thresh, _unclip_ratio, _score_mode, priv->boxes, _max_candidates);
+        std::vector<int> idxes;
+        std::vector<std::string> chars;
+        std::vector<int> char_pos;
+        for (auto &b : priv->boxes)
+        {
+            nn::OCR_Box box(b.pts[0].x, b.pts[0].y, b.pts[1].x, b.pts[1].y, b.pts[2].x, b.pts[2].y, b.pts[3].x, b.pts[3].y);
+            objects->add(box, idxes, chars, b.score, char_pos);
+        }
+        if (objects->size() == 0)
+            return objects;
+
+        // correct boxes
+        _correct_bbox(*objects, img_w, img_h, fit);
+
+        // recognize charactors of all boxes together
+        if (_rec_model)
+        {
+            priv->objs.clear();
+            for (nn::OCR_Object *obj : *objects)
+                priv->objs.push_back(obj);
+            _recognize_lines(img, priv->objs.data(), priv->objs.size(), true, rec_batch);
+        }
         return objects;
     }
 
-    static void _recognize_stdimg(nn::NN *_rec_model, image::Image &std_img, std::vector<float> &mean, std::vector<float> &scale, std::vector<int> &max_idxes, const int &_max_ch_num, const int &_prob_num)
+    // 3x3 matrix multiply, c = a * b
+    static void _mat3_mul(const double a[9], const double b[9], double c[9])
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                c[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] + a[i * 3 + 2] * b[6 + j];
+        }
+    }
+
+    // homography map unit square (0,0),(1,0),(1,1),(0,1) to quad q[4][2]
+    static void _square_to_quad(const float q[8], double m[9])
+    {
+        double x0 = q[0], y0 = q[1], x1 = q[2], y1 = q[3];
+        double x2 = q[4], y2 = q[5], x3 = q[6], y3 = q[7];
+        double sx = x0 - x1 + x2 - x3;
+        double sy = y0 - y1 + y2 - y3;
+        double g = 0, h = 0;
+        double dx1 = x1 - x2, dx2 = x3 - x2, dy1 = y1 - y2, dy2 = y3 - y2;
+        double den = dx1 * dy2 - dx2 * dy1;
+        if ((sx != 0 || sy != 0) && den != 0)
+        {
+            g = (sx * dy2 - dx2 * sy) / den;
+            h = (dx1 * sy - sx * dy1) / den;
+        }
+        m[0] = x1 - x0 + g * x1;
+        m[1] = x3 - x0 + h * x3;
+        m[2] = x0;
+        m[3] = y1 - y0 + g * y1;
+        m[4] = y3 - y0 + h * y3;
+        m[5] = y0;
+        m[6] = g;
+        m[7] = h;
+        m[8] = 1;
+    }
+
+    static void _add_lines(image::Image &img, nn::OCR_Object *obj, bool crop, int in_w, int in_h, std::vector<PP_OCR_Line> &lines)
     {
-        // foward image
-        tensor::Tensors *outputs;
-        outputs = _rec_model->forward_image(std_img, mean, scale, image::Fit::FIT_FILL, true);
-        if (!outputs) // not happen here
+        const nn::OCR_Box &box = obj->box;
+
+        // destination of crop(std image) to source image
+        int crop_w = img.width(), crop_h = img.height();
+        double hd[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        bool rotate = false;
+        if (crop)
+        {
+            crop_w = int(sqrt(pow(box.x1 - box.x2, 2) + pow(box.y1 - box.y2, 2)));
+            crop_h = int(sqrt(pow(box.x1 - box.x4, 2) + pow(box.y1 - box.y4, 2)));
+            if (crop_w <= 0 || crop_h <= 0)
+                return;
+            float q[8] = {(float)box.x1, (float)box.y1, (float)box.x2, (float)box.y2,
+                          (float)box.x3, (float)box.y3, (float)box.x4, (float)box.y4};
+            double m[9];
+            _square_to_quad(q, m);
+            double s[9] = {1.0 / crop_w, 0, 0, 0, 1.0 / crop_h, 0, 0, 0, 1};
+            _mat3_mul(m, s, hd);
+            // vertical text, rotate 90 degree counterclockwise
+            rotate = float(crop_h) >= float(crop_w) * 1.5;
+        }
+
+        // keep ratio resize std image's height to model input height,
+        // wider than model input width will be splitted to several lines
+        int std_w = rotate ? crop_h : crop_w;
+        int std_h = rotate ? crop_w : crop_h;
+        int resized_w = std::max(static_cast<int>(in_h * (float(std_w) / float(std_h))), 1);
+        double kx = double(std_w) / resized_w;
+        double ky = double(std_h) / in_h;
+        int slices = (resized_w + in_w - 1) / in_w;
+        for (int i = 0; i < slices; ++i)
         {
-            throw err::Exception(err::ERR_RUNTIME);
+            // model input pixel to std image pixel, same pixel center as cv::resize
+            double ox = kx * (i * in_w + 0.5) - 0.5;
+            double oy = ky * 0.5 - 0.5;
+            double a[9] = {kx, 0, ox, 0, ky, oy, 0, 0, 1};
+            if (rotate)
+            {
+                double r[9] = {0, -ky, crop_w - 1 - oy, kx, 0, ox, 0, 0, 1};
+                memcpy(a, r, sizeof(a));
+            }
+            PP_OCR_Line line;
+            double t[9];
+            _mat3_mul(hd, a, t);
+            for (int k = 0; k < 9; ++k)
+                line.t[k] = (float)t[k];
+            line.obj = obj;
+            line.slice = i;
+            line.width = std::min(in_w, resized_w - i * in_w);
+            lines.push_back(line);
         }
+    }
 
-        // rec postprocess, outputs shape: _max_ch_num x (_prob_num)
-        // get all max prob, totally _max_ch_num sections,
-        // then remove dumplicate and empty section, get charactors store in chars var.
-        for (auto it = outputs->begin(); it != outputs->end(); it++)
+    // warp one line from source image into model input(chw) with bilinear sampling,
+    // pixels out of line width are filled with black
+    template <typename T>
+    static void _warp_line(const uint8_t *src, int src_w, int src_h, const PP_OCR_Line &line, T *dst, int w, int h,
+                           const float *mean, const float *scale)
+    {
+        int size = w * h;
+        const float *t = line.t;
+        T pad[3];
+        for (int k = 0; k < 3; ++k)
+            pad[k] = mean ? (T)((0 - mean[k]) * scale[k]) : 0;
+        for (int v = 0; v < h; ++v)
         {
-            tensor::Tensor *out = it->second;
-            float *data = (float*)out->data();
-            float max_score;
-            for(int i = 0; i < _max_ch_num; ++i)
+            float bx = t[1] * v + t[2];
+            float by = t[4] * v + t[5];
+            float bz = t[7] * v + t[8];
+            T *d = dst + v * w;
+            for (int u = 0; u < line.width; ++u)
             {
-                max_score = 0;
-                for(int j = 0; j < _prob_num; ++j)
+                float z = bz + t[6] * u;
+                float x = (bx + t[0] * u) / z;
+                float y = (by + t[3] * u) / z;
+                float fx0 = floorf(x), fy0 = floorf(y);
+                float fx = x - fx0, fy = y - fy0;
+                int x0 = (int)fx0, y0 = (int)fy0;
+                int x1 = std::min(std::max(x0 + 1, 0), src_w - 1);
+                int y1 = std::min(std::max(y0 + 1, 0), src_h - 1);
+                x0 = std::min(std::max(x0, 0), src_w - 1);
+                y0 = std::min(std::max(y0, 0), src_h - 1);
+                const uint8_t *p00 = src + (y0 * src_w + x0) * 3;
+                const uint8_t *p01 = src + (y0 * src_w + x1) * 3;
+                const uint8_t *p10 = src + (y1 * src_w + x0) * 3;
+                const uint8_t *p11 = src + (y1 * src_w + x1) * 3;
+                float w00 = (1 - fx) * (1 - fy), w01 = fx * (1 - fy);
+                float w10 = (1 - fx) * fy, w11 = fx * fy;
+                for (int k = 0; k < 3; ++k)
                 {
-                    if(*data > max_score)
-                    {
-                        max_score = *data;
-                        max_idxes[i] = j;
-                    }
-                    ++data;
+                    float value = p00[k] * w00 + p01[k] * w01 + p10[k] * w10 + p11[k] * w11;
+                    if (mean)
+                        d[k * size + u] = (T)((value - mean[k]) * scale[k]);
+                    else
+                        d[k * size + u] = (T)(value + 0.5f);
                 }
             }
-            break;
+            for (int k = 0; k < 3; ++k)
+                std::fill(d + k * size + line.width, d + k * size + w, pad[k]);
         }
-        delete outputs;
     }
 
-    void PP_OCR::_recognize(image::Image &img, const nn::OCR_Box &box, std::vector<int> &idx_list, std::vector<std::string> &char_list, std::vector<int> &char_pos, bool crop)
+    void PP_OCR::_recognize_lines(image::Image &img, nn::OCR_Object **objs, int num, bool crop, int batch)
     {
-        idx_list.clear();
-        char_list.clear();
-        cv::Mat img_src(img.height(), img.width(), CV_8UC3, img.data());
-        cv::Mat *std_img = &img_src;
-        cv::Mat img_dst;
-        cv::Mat srcCopy;
-        if(crop)
+        if (!_rec_model)
         {
-            // crop and get std
-            cv::Point2f pts_std[4];
-            int img_crop_width = int(sqrt(pow(box.x1 - box.x2, 2) +
-                                    pow(box.y1 - box.y2, 2)));
-            int img_crop_height = int(sqrt(pow(box.x1 - box.x4, 2) +
-                                            pow(box.y1 - box.y4, 2)));
-            pts_std[0] = cv::Point2f(0., 0.);
-            pts_std[1] = cv::Point2f(img_crop_width, 0.);
-            pts_std[2] = cv::Point2f(img_crop_width, img_crop_height);
-            pts_std[3] = cv::Point2f(0.f, img_crop_height);
-            cv::Point2f pointsf[4];
-            pointsf[0] = cv::Point2f(box.x1, box.y1);
-            pointsf[1] = cv::Point2f(box.x2, box.y2);
-            pointsf[2] = cv::Point2f(box.x3, box.y3);
-            pointsf[3] = cv::Point2f(box.x4, box.y4);
-            cv::Mat M = cv::getPerspectiveTransform(pointsf, pts_std);
-            cv::warpPerspective(img_src, img_dst, M,
-                        cv::Size(img_crop_width, img_crop_height),
-                        cv::BORDER_REPLICATE);
-            std_img = &img_dst;
-            if (float(img_dst.rows) >= float(img_dst.cols) * 1.5) {
-                srcCopy = cv::Mat(img_dst.rows, img_dst.cols, img_dst.depth());
-                cv::transpose(img_dst, srcCopy);
-                cv::flip(srcCopy, srcCopy, 0);
-                std_img = &srcCopy;
-            }
+            throw err::Exception(err::ERR_NOT_READY, "rec model not loaded");
         }
+        if (img.format() != image::FMT_RGB888 && img.format() != image::FMT_BGR888)
+        {
+            throw err::Exception(err::ERR_ARGS, "recognize only support RGB888 or BGR888 image");
+        }
+        PP_OCR_Priv *priv = _get_priv(_priv);
 
-        // resize pad image to model input size(_rec_input_size) like 320x48
-        // keep ratio resize image's height to _rec_input_size.height(),
-        // if new image width > _rec_input_size.width()， resize new image width to _rec_input_size.width(), padding black color at bottom,
-        // else if new image width < _rec_input_size.width(), keep new image content at left, right padding black color.
-        // finally we got _rec_input_size image
-        float aspect_ratio = float(std_img->cols) / float(std_img->rows);
-        cv::Mat resized_img;
-        // Height is the limiting factor
-        cv::resize(*std_img, resized_img, cv::Size(static_cast<int>(_rec_input_size.height() * aspect_ratio),
-                    _rec_input_size.height()));
-        if (aspect_ratio > float(_rec_input_size.width()) / float(_rec_input_size.height())) {
-            // Width > input width
-            // slice and recognize
-            for(int i = 0; i < std::ceil((float)resized_img.cols / _rec_input_size.width()); ++i)
+        // split every text box to lines of model input size
+        priv->lines.clear();
+        for (int i = 0; i < num; ++i)
+        {
+            objs[i]->idx_list.clear();
+            objs[i]->char_pos.clear();
+            _add_lines(img, objs[i], crop, _rec_input_size.width(), _rec_input_size.height(), priv->lines);
+        }
+
+        // one input tensor of batch lines, kept between frames
+        nn::LayerInfo layer = _rec_model->inputs_info()[0];
+        if (batch <= 0)
+            batch = std::max(layer.shape[0], 1);
+        layer.shape[0] = batch;
+        if (layer.dtype != tensor::DType::FLOAT32 && layer.dtype != tensor::DType::UINT8)
+        {
+            throw err::Exception(err::ERR_NOT_IMPL, "rec model input dtype " + tensor::dtype_name[layer.dtype] + " not support");
+        }
+        if (!priv->rec_input || priv->rec_input->shape() != layer.shape || priv->rec_input->dtype() != layer.dtype)
+        {
+            delete priv->rec_input;
+            priv->rec_input = nullptr;
+            priv->rec_input = new tensor::Tensor(layer.shape, layer.dtype);
+        }
+        int w = _rec_input_size.width();
+        int h = _rec_input_size.height();
+        size_t line_size = (size_t)3 * w * h;
+        size_t line_bytes = line_size * tensor::dtype_size[layer.dtype];
+        uint8_t *input_data = (uint8_t *)priv->rec_input->data();
+        float mean[3], scale[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            mean[k] = this->rec_mean[k % this->rec_mean.size()];
+            scale[k] = this->rec_scale[k % this->rec_scale.size()];
+        }
+        const uint8_t *src = (const uint8_t *)img.data();
+
+        for (size_t start = 0; start < priv->lines.size(); start += batch)
+        {
+            int n = std::min((int)(priv->lines.size() - start), batch);
+            for (int i = 0; i < n; ++i)
             {
-                // crop
-                cv::Mat crop_img = resized_img(cv::Rect(i * _rec_input_size.width(), 0, std::min(_rec_input_size.width(), resized_img.cols - i * _rec_input_size.width()), resized_img.rows));
-                cv::Mat final_img;
-                if(crop_img.cols < _rec_input_size.width())
-                {
-                    cv::Mat padded_img(_rec_input_size.height(), _rec_input_size.width(), CV_8UC3, cv::Scalar(0, 0, 0));
-                    crop_img.copyTo(padded_img(cv::Rect(0, 0, crop_img.cols, crop_img.rows)));
-                    padded_img.copyTo(final_img);
-                }
+                const PP_OCR_Line &line = priv->lines[start + i];
+                if (layer.dtype == tensor::DType::FLOAT32)
+                    _warp_line<float>(src, img.width(), img.height(), line, (float *)input_data + i * line_size, w, h, mean, scale);
                 else
-                {
-                    crop_img.copyTo(final_img);
-                }
-                // show image on left-top
-                image::Image std_img(final_img.cols, final_img.rows, image::Format::FMT_BGR888, final_img.data, -1, false);
-                // if(i == 0)
-                //     img.draw_image(0, 0, std_img);
+                    _warp_line<uint8_t>(src, img.width(), img.height(), line, input_data + i * line_size, w, h, nullptr, nullptr);
+            }
+            if (n < batch)
+                memset(input_data + n * line_bytes, 0, (batch - n) * line_bytes);
 
-                std::vector<int> max_idxes(_max_ch_num);
-                _recognize_stdimg(_rec_model, std_img, this->rec_mean, this->rec_scale, max_idxes, _max_ch_num, _prob_num);
+            tensor::Tensors inputs;
+            inputs.add_tensor(layer.name, priv->rec_input, false, false);
+            tensor::Tensors outputs;
+            err::Err e = _rec_model->forward(inputs, outputs, false, true);
+            if (e != err::ERR_NONE)
+            {
+                throw err::Exception(e, "rec model forward failed");
+            }
+            if (outputs.size() == 0)
+            {
+                throw err::Exception(err::ERR_RUNTIME, "rec model no output");
+            }
+            tensor::Tensor *out = outputs.begin()->second;
+            if (out->shape()[0] < n)
+            {
+                throw err::Exception(err::ERR_NOT_IMPL, "rec model output first dimension not batch size");
+            }
 
+            // rec postprocess, outputs shape: batch x _max_ch_num x (_prob_num)
+            // get max prob of every section, then remove dumplicate and empty section.
+            // Sections after line's content are black padding, not decoded.
+            const float *out_data = (const float *)out->data();
+            for (int i = 0; i < n; ++i)
+            {
+                const PP_OCR_Line &line = priv->lines[start + i];
+                const float *data = out_data + (size_t)i * _max_ch_num * _prob_num;
+                int sections = std::min(_max_ch_num, (line.width + 7) / 8 + 2);
                 int last_idx = 0;
-                for(int j = 0; j < _max_ch_num; ++j)
+                for (int j = 0; j < sections; ++j, data += _prob_num)
                 {
-                    if((max_idxes[j] != last_idx) && (max_idxes[j] != 0))
+                    int idx = F::argmax(data, _prob_num);
+                    if (data[idx] <= 0)
+                        idx = 0;
+                    if (idx != last_idx && idx != 0)
                     {
-                        idx_list.push_back(max_idxes[j] - 1);
-                        char_list.push_back(labels[max_idxes[j] - 1]);
-                        char_pos.push_back(j + i * _max_ch_num);
+                        line.obj->idx_list.push_back(idx - 1);
+                        line.obj->char_pos.push_back(j + line.slice * _max_ch_num);
                     }
-                    last_idx = max_idxes[j];
+                    last_idx = idx;
                 }
             }
-        } else {
-            // pad
-            cv::Mat padded_img(_rec_input_size.height(), _rec_input_size.width(), CV_8UC3, cv::Scalar(0, 0, 0));
-            resized_img.copyTo(padded_img(cv::Rect(0, 0, resized_img.cols, resized_img.rows)));
-            image::Image pad_img(padded_img.cols, padded_img.rows, image::Format::FMT_BGR888, padded_img.data, -1, false);
-
-            // show image on left-top
-            // img.draw_image(0, 0, pad_img);
-
-            std::vector<int> max_idxes(_max_ch_num);
-            _recognize_stdimg(_rec_model, pad_img, this->rec_mean, this->rec_scale, max_idxes, _max_ch_num, _prob_num);
+        }
 
-            int last_idx = 0;
-            for(int i = 0; i < _max_ch_num; ++i)
-            {
-                if((max_idxes[i] != last_idx) && (max_idxes[i] != 0))
-                {
-                    idx_list.push_back(max_idxes[i] - 1);
-                    char_list.push_back(labels[max_idxes[i] - 1]);
-                    char_pos.push_back(i);
-                }
-                last_idx = max_idxes[i];
-            }
+        std::vector<std::string> char_list;
+        for (int i = 0; i < num; ++i)
+        {
+            char_list.clear();
+            for (int idx : objs[i]->idx_list)
+                char_list.push_back(labels[idx]);
+            objs[i]->update_chars(char_list);
         }
     }
 
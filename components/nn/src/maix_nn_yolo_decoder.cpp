@@ -0,0 +1,145 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add shared YOLOv8/YOLO11 decode and NMS engine.
+ */
+
+#include "maix_nn_yolo_decoder.hpp"
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define YOLO_DECODER_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define YOLO_DECODER_RVV 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define YOLO_DECODER_SSE 1
+#endif
+
+namespace maix::nn
+{
+    /**
+     * best[i] = max(best[i], plane[i]), ids[i] = class_id where plane[i] > best[i].
+     * Strict greater keeps the first max class, same as scanning classes of one anchor in order.
+     */
+    static void _max_plane(const float *plane, float *best, int32_t *ids, int n, int32_t class_id)
+    {
+        int i = 0;
+#if YOLO_DECODER_NEON
+        int32x4_t cls = vdupq_n_s32(class_id);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t s = vld1q_f32(plane + i);
+            float32x4_t b = vld1q_f32(best + i);
+            uint32x4_t m = vcgtq_f32(s, b);
+            vst1q_f32(best + i, vbslq_f32(m, s, b));
+            vst1q_s32(ids + i, vbslq_s32(m, cls, vld1q_s32(ids + i)));
+        }
+#elif YOLO_DECODER_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e32m4(n - i);
+            vfloat32m4_t s = __riscv_vle32_v_f32m4(plane + i, vl);
+            vfloat32m4_t b = __riscv_vle32_v_f32m4(best + i, vl);
+            vbool8_t m = __riscv_vmfgt_vv_f32m4_b8(s, b, vl);
+            __riscv_vse32_v_f32m4(best + i, __riscv_vmerge_vvm_f32m4(b, s, m, vl), vl);
+            vint32m4_t id = __riscv_vle32_v_i32m4(ids + i, vl);
+            __riscv_vse32_v_i32m4(ids + i, __riscv_vmerge_vxm_i32m4(id, class_id, m, vl), vl);
+        }
+#elif YOLO_DECODER_SSE
+        __m128i cls = _mm_set1_epi32(class_id);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 s = _mm_loadu_ps(plane + i);
+            __m128 b = _mm_loadu_ps(best + i);
+            __m128 m = _mm_cmpgt_ps(s, b);
+            _mm_storeu_ps(best + i, _mm_or_ps(_mm_and_ps(m, s), _mm_andnot_ps(m, b)));
+            __m128i mi = _mm_castps_si128(m);
+            __m128i id = _mm_loadu_si128((const __m128i *)(ids + i));
+            _mm_storeu_si128((__m128i *)(ids + i), _mm_or_si128(_mm_and_si128(mi, cls), _mm_andnot_si128(mi, id)));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            if (plane[i] > best[i])
+            {
+                best[i] = plane[i];
+                ids[i] = class_id;
+            }
+        }
+    }
+
+    void YOLOv8Decoder::max_scores(const float *scores, int class_num, int anchor_num, float conf_th)
+    {
+        // init best with conf_th, then only scores > conf_th can update class id,
+        // anchors keep -1 are rejected without extra compare.
+        _max_scores.assign(anchor_num, conf_th);
+        _class_ids.assign(anchor_num, -1);
+        float *best = _max_scores.data();
+        int32_t *ids = _class_ids.data();
+        for (int c = 0; c < class_num; ++c)
+        {
+            _max_plane(scores + (size_t)c * anchor_num, best, ids, anchor_num, c);
+        }
+    }
+
+    static inline float _iou(const YOLOCandidate &a, const YOLOCandidate &b)
+    {
+        float wi = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+        if (wi <= 0)
+            return 0;
+        float hi = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+        if (hi <= 0)
+            return 0;
+        float area_i = wi * hi;
+        return area_i / (a.w * a.h + b.w * b.h - area_i);
+    }
+
+    const std::vector<int> &YOLOv8Decoder::nms(float iou_th)
+    {
+        int n = (int)candidates.size();
+        const YOLOCandidate *c = candidates.data();
+        _keep.clear();
+        _order.resize(n);
+        _suppressed.assign(n, 0);
+        for (int i = 0; i < n; ++i)
+            _order[i] = i;
+        // bucket by class, score descending in every bucket
+        std::sort(_order.begin(), _order.end(), [c](int a, int b) {
+            if (c[a].class_id != c[b].class_id)
+                return c[a].class_id < c[b].class_id;
+            return c[a].score > c[b].score;
+        });
+        int start = 0;
+        while (start < n)
+        {
+            int cls = c[_order[start]].class_id;
+            int end = start + 1;
+            while (end < n && c[_order[end]].class_id == cls)
+                ++end;
+            for (int i = start; i < end; ++i)
+            {
+                if (_suppressed[i])
+                    continue;
+                const YOLOCandidate &a = c[_order[i]];
+                _keep.push_back(_order[i]);
+                for (int j = i + 1; j < end; ++j)
+                {
+                    if (!_suppressed[j] && _iou(a, c[_order[j]]) > iou_th)
+                        _suppressed[j] = 1;
+                }
+            }
+            start = end;
+        }
+        std::sort(_keep.begin(), _keep.end(), [c](int a, int b) {
+            if (c[a].score != c[b].score)
+                return c[a].score > c[b].score;
+            return a < b;
+        });
+        return _keep;
+    }
+
+} // namespace maix::nn
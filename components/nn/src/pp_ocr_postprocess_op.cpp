@@ -16,67 +16,39 @@
 
 namespace PaddleOCR {
 
-void DBPostProcessor::GetContourArea(const std::vector<std::vector<float>> &box,
+void DBPostProcessor::GetContourArea(const cv::Point2f box[4],
                                      float unclip_ratio, float &distance) {
   int pts_num = 4;
   float area = 0.0f;
   float dist = 0.0f;
   for (int i = 0; i < pts_num; i++) {
-    area += box[i][0] * box[(i + 1) % pts_num][1] -
-            box[i][1] * box[(i + 1) % pts_num][0];
-    dist += sqrtf((box[i][0] - box[(i + 1) % pts_num][0]) *
-                      (box[i][0] - box[(i + 1) % pts_num][0]) +
-                  (box[i][1] - box[(i + 1) % pts_num][1]) *
-                      (box[i][1] - box[(i + 1) % pts_num][1]));
+    const cv::Point2f &p0 = box[i];
+    const cv::Point2f &p1 = box[(i + 1) % pts_num];
+    area += p0.x * p1.y - p0.y * p1.x;
+    dist += sqrtf((p0.x - p1.x) * (p0.x - p1.x) + (p0.y - p1.y) * (p0.y - p1.y));
   }
   area = fabs(float(area / 2.0));
 
-  distance = area * unclip_ratio / dist;
+  distance = dist > 0 ? area * unclip_ratio / dist : 0;
 }
 
-cv::RotatedRect DBPostProcessor::UnClip(std::vector<std::vector<float>> box,
+cv::RotatedRect DBPostProcessor::UnClip(const cv::Point2f box[4],
+                                        const cv::RotatedRect &rect,
                                         const float &unclip_ratio) {
   float distance = 1.0;
 
   GetContourArea(box, unclip_ratio, distance);
 
-  Clipper2Lib::ClipperOffset offset;
-  Clipper2Lib::Path64 p;
-  p.push_back(Clipper2Lib::Point<int64_t>(int64_t(box[0][0]), int64_t(box[0][1])));
-  p.push_back(Clipper2Lib::Point<int64_t>(int64_t(box[1][0]), int64_t(box[1][1])));
-  p.push_back(Clipper2Lib::Point<int64_t>(int64_t(box[2][0]), int64_t(box[2][1])));
-  p.push_back(Clipper2Lib::Point<int64_t>(int64_t(box[3][0]), int64_t(box[3][1])));
-  offset.AddPath(p, Clipper2Lib::JoinType::Round, Clipper2Lib::EndType::Polygon);
-
-  Clipper2Lib::Paths64 soln;
-  offset.Execute(distance, soln);
-  std::vector<cv::Point2f> points;
-
-  for (size_t j = 0; j < soln.size(); j++) {
-    for (size_t i = 0; i < soln[soln.size() - 1].size(); i++) {
-      points.emplace_back(soln[j][i].x, soln[j][i].y);
-    }
-  }
-  cv::RotatedRect res;
-  if (points.size() <= 0) {
-    res = cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(1, 1), 0);
-  } else {
-    res = cv::minAreaRect(points);
-  }
-  return res;
-}
-
-float **DBPostProcessor::Mat2Vec(cv::Mat mat) {
-  auto **array = new float *[mat.rows];
-  for (int i = 0; i < mat.rows; ++i)
-    array[i] = new float[mat.cols];
-  for (int i = 0; i < mat.rows; ++i) {
-    for (int j = 0; j < mat.cols; ++j) {
-      array[i][j] = mat.at<float>(i, j);
-    }
-  }
-
-  return array;
+  // box is a rectangle, offset it with round join by distance get a rounded
+  // rectangle, min area rect of it is the rectangle expanded by distance
+  // at every side, same as clipper offset then minAreaRect, but no
+  // path or point memory allocated
+  if (rect.size.width <= 0 && rect.size.height <= 0)
+    return cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(1, 1), 0);
+  return cv::RotatedRect(rect.center,
+                         cv::Size2f(rect.size.width + 2 * distance,
+                                    rect.size.height + 2 * distance),
+                         rect.angle);
 }
 
 std::vector<std::vector<int>>
@@ -98,52 +70,36 @@ DBPostProcessor::OrderPointsClockwise(std::vector<std::vector<int>> pts) {
   return rect;
 }
 
-std::vector<std::vector<float>> DBPostProcessor::Mat2Vector(cv::Mat mat) {
-  std::vector<std::vector<float>> img_vec;
-  std::vector<float> tmp;
-
-  for (int i = 0; i < mat.rows; ++i) {
-    tmp.clear();
-    for (int j = 0; j < mat.cols; ++j) {
-      tmp.push_back(mat.at<float>(i, j));
-    }
-    img_vec.push_back(tmp);
-  }
-  return img_vec;
-}
-
-bool DBPostProcessor::XsortFp32(std::vector<float> a, std::vector<float> b) {
-  if (a[0] != b[0])
-    return a[0] < b[0];
-  return false;
-}
-
 bool DBPostProcessor::XsortInt(std::vector<int> a, std::vector<int> b) {
   if (a[0] != b[0])
     return a[0] < b[0];
   return false;
 }
 
-std::vector<std::vector<float>>
-DBPostProcessor::GetMiniBoxes(cv::RotatedRect box, float &ssid) {
+void DBPostProcessor::GetMiniBoxes(const cv::RotatedRect &box,
+                                   cv::Point2f pts[4], float &ssid) {
   ssid = std::max(box.size.width, box.size.height);
 
-  cv::Mat points;
-  cv::boxPoints(box, points);
-
-  auto array = Mat2Vector(points);
-  std::sort(array.begin(), array.end(), XsortFp32);
+  cv::Point2f array[4];
+  box.points(array);
+  // stable sort 4 points by x
+  for (int i = 1; i < 4; ++i) {
+    cv::Point2f p = array[i];
+    int j = i - 1;
+    for (; j >= 0 && array[j].x > p.x; --j)
+      array[j + 1] = array[j];
+    array[j + 1] = p;
+  }
 
-  std::vector<float> idx1 = array[0], idx2 = array[1], idx3 = array[2],
-                     idx4 = array[3];
-  if (array[3][1] <= array[2][1]) {
+  cv::Point2f idx1, idx2, idx3, idx4;
+  if (array[3].y <= array[2].y) {
     idx2 = array[3];
     idx3 = array[2];
   } else {
     idx2 = array[2];
     idx3 = array[3];
   }
-  if (array[1][1] <= array[0][1]) {
+  if (array[1].y <= array[0].y) {
     idx1 = array[1];
     idx4 = array[0];
   } else {
@@ -151,138 +107,139 @@ DBPostProcessor::GetMiniBoxes(cv::RotatedRect box, float &ssid) {
     idx4 = array[1];
   }
 
-  array[0] = idx1;
-  array[1] = idx2;
-  array[2] = idx3;
-  array[3] = idx4;
-
-  return array;
+  pts[0] = idx1;
+  pts[1] = idx2;
+  pts[2] = idx3;
+  pts[3] = idx4;
 }
 
-float DBPostProcessor::PolygonScoreAcc(std::vector<cv::Point> contour,
-                                       cv::Mat pred) {
+float DBPostProcessor::PolygonMean(const cv::Point *pts, int n,
+                                   const cv::Mat &pred) {
   int width = pred.cols;
   int height = pred.rows;
-  std::vector<float> box_x;
-  std::vector<float> box_y;
-  for (size_t i = 0; i < contour.size(); ++i) {
-    box_x.push_back(contour[i].x);
-    box_y.push_back(contour[i].y);
+  int xmin = pts[0].x, xmax = pts[0].x, ymin = pts[0].y, ymax = pts[0].y;
+  for (int i = 1; i < n; ++i) {
+    xmin = _min(xmin, pts[i].x);
+    xmax = _max(xmax, pts[i].x);
+    ymin = _min(ymin, pts[i].y);
+    ymax = _max(ymax, pts[i].y);
   }
-
-  int xmin =
-      clamp(int(std::floor(*(std::min_element(box_x.begin(), box_x.end())))), 0,
-            width - 1);
-  int xmax =
-      clamp(int(std::ceil(*(std::max_element(box_x.begin(), box_x.end())))), 0,
-            width - 1);
-  int ymin =
-      clamp(int(std::floor(*(std::min_element(box_y.begin(), box_y.end())))), 0,
-            height - 1);
-  int ymax =
-      clamp(int(std::ceil(*(std::max_element(box_y.begin(), box_y.end())))), 0,
-            height - 1);
-
-  cv::Mat mask;
-  mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
-
-  cv::Point *rook_point = new cv::Point[contour.size()];
-
-  for (size_t i = 0; i < contour.size(); ++i) {
-    rook_point[i] = cv::Point(int(box_x[i]) - xmin, int(box_y[i]) - ymin);
+  int x_start = clamp(xmin, 0, width - 1);
+  int x_end = clamp(xmax, 0, width - 1);
+  int y_start = clamp(ymin, 0, height - 1);
+  int y_end = clamp(ymax, 0, height - 1);
+  int span = x_end - x_start + 1;
+  if (row_mask_.size() < (size_t)span)
+    row_mask_.resize(span);
+  uint8_t *mask = row_mask_.data() - x_start;
+
+  // scan line fill: pixels between crossings of pixel center with edges
+  // (half open in y so vertices counted once), plus pixels the edges pass,
+  // same coverage as fillPoly draw polygon and its edges
+  double sum = 0;
+  int count = 0;
+  for (int y = y_start; y <= y_end; ++y) {
+    memset(mask + x_start, 0, span);
+    crossings_.clear();
+    for (int i = 0; i < n; ++i) {
+      const cv::Point &p0 = pts[i];
+      const cv::Point &p1 = pts[(i + 1) % n];
+      if (y < _min(p0.y, p1.y) || y > _max(p0.y, p1.y))
+        continue;
+      int xa, xb;
+      if (p0.y == p1.y) {
+        xa = _min(p0.x, p1.x);
+        xb = _max(p0.x, p1.x);
+      } else {
+        float k = float(p1.x - p0.x) / float(p1.y - p0.y);
+        float x = p0.x + (y - p0.y) * k;
+        if ((p0.y <= y && y < p1.y) || (p1.y <= y && y < p0.y))
+          crossings_.push_back(x);
+        if (std::abs(p1.x - p0.x) <= std::abs(p1.y - p0.y)) {
+          xa = xb = int(std::floor(x + 0.5f));
+        } else {
+          // shallow edge pass several pixels of this row
+          float ya = std::max(y - 0.5f, float(_min(p0.y, p1.y)));
+          float yb = std::min(y + 0.5f, float(_max(p0.y, p1.y)));
+          float x0 = p0.x + (ya - p0.y) * k;
+          float x1 = p0.x + (yb - p0.y) * k;
+          xa = int(std::ceil(std::min(x0, x1)));
+          xb = int(std::floor(std::max(x0, x1)));
+        }
+      }
+      xa = _max(xa, x_start);
+      xb = _min(xb, x_end);
+      if (xa <= xb)
+        memset(mask + xa, 1, xb - xa + 1);
+    }
+    std::sort(crossings_.begin(), crossings_.end());
+    for (size_t i = 0; i + 1 < crossings_.size(); i += 2) {
+      int xa = _max(int(std::ceil(crossings_[i])), x_start);
+      int xb = _min(int(std::floor(crossings_[i + 1])), x_end);
+      if (xa <= xb)
+        memset(mask + xa, 1, xb - xa + 1);
+    }
+    const float *row = pred.ptr<float>(y);
+    for (int x = x_start; x <= x_end; ++x) {
+      if (mask[x]) {
+        sum += row[x];
+        ++count;
+      }
+    }
   }
-  const cv::Point *ppt[1] = {rook_point};
-  int npt[] = {int(contour.size())};
-
-  cv::fillPoly(mask, ppt, npt, 1, cv::Scalar(1));
-
-  cv::Mat croppedImg;
-  pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1))
-      .copyTo(croppedImg);
-  float score = cv::mean(croppedImg, mask)[0];
-
-  delete[] rook_point;
-  return score;
+  return count > 0 ? float(sum / count) : 0;
 }
 
-float DBPostProcessor::BoxScoreFast(std::vector<std::vector<float>> box_array,
-                                    cv::Mat pred) {
-  auto array = box_array;
-  int width = pred.cols;
-  int height = pred.rows;
-
-  float box_x[4] = {array[0][0], array[1][0], array[2][0], array[3][0]};
-  float box_y[4] = {array[0][1], array[1][1], array[2][1], array[3][1]};
-
-  int xmin = clamp(int(std::floor(*(std::min_element(box_x, box_x + 4)))), 0,
-                   width - 1);
-  int xmax = clamp(int(std::ceil(*(std::max_element(box_x, box_x + 4)))), 0,
-                   width - 1);
-  int ymin = clamp(int(std::floor(*(std::min_element(box_y, box_y + 4)))), 0,
-                   height - 1);
-  int ymax = clamp(int(std::ceil(*(std::max_element(box_y, box_y + 4)))), 0,
-                   height - 1);
-
-  cv::Mat mask;
-  mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
+float DBPostProcessor::PolygonScoreAcc(const std::vector<cv::Point> &contour,
+                                       const cv::Mat &pred) {
+  return PolygonMean(contour.data(), int(contour.size()), pred);
+}
 
+float DBPostProcessor::BoxScoreFast(const cv::Point2f box[4],
+                                    const cv::Mat &pred) {
   cv::Point root_point[4];
-  root_point[0] = cv::Point(int(array[0][0]) - xmin, int(array[0][1]) - ymin);
-  root_point[1] = cv::Point(int(array[1][0]) - xmin, int(array[1][1]) - ymin);
-  root_point[2] = cv::Point(int(array[2][0]) - xmin, int(array[2][1]) - ymin);
-  root_point[3] = cv::Point(int(array[3][0]) - xmin, int(array[3][1]) - ymin);
-  const cv::Point *ppt[1] = {root_point};
-  int npt[] = {4};
-  cv::fillPoly(mask, ppt, npt, 1, cv::Scalar(1));
-
-  cv::Mat croppedImg;
-  pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1))
-      .copyTo(croppedImg);
-
-  auto score = cv::mean(croppedImg, mask)[0];
-  return score;
+  for (int i = 0; i < 4; ++i)
+    root_point[i] = cv::Point(int(box[i].x), int(box[i].y));
+  return PolygonMean(root_point, 4, pred);
 }
 
-std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
-    const cv::Mat pred, const cv::Mat bitmap, const float &box_thresh,
-    const float &det_db_unclip_ratio, const std::string &det_db_score_mode, std::vector<float> &scores) {
+void DBPostProcessor::BoxesFromBitmap(const cv::Mat &pred,
+                                      const cv::Mat &bitmap,
+                                      const float &box_thresh,
+                                      const float &det_db_unclip_ratio,
+                                      const std::string &det_db_score_mode,
+                                      std::vector<TextBox> &boxes,
+                                      int max_candidates) {
   const int min_size = 3;
-  const int max_candidates = 1000;
 
-  int width = bitmap.cols;
-  int height = bitmap.rows;
+  boxes.clear();
 
-  std::vector<std::vector<cv::Point>> contours;
-  std::vector<cv::Vec4i> hierarchy;
-
-  scores.clear();
-
-  cv::findContours(bitmap, contours, hierarchy, cv::RETR_LIST,
+  cv::findContours(bitmap, contours_, hierarchy_, cv::RETR_LIST,
                    cv::CHAIN_APPROX_SIMPLE);
 
-  int num_contours =
-      contours.size() >= max_candidates ? max_candidates : contours.size();
-
-  std::vector<std::vector<std::vector<int>>> boxes;
+  int num_contours = (int)contours_.size() >= max_candidates
+                         ? max_candidates
+                         : (int)contours_.size();
+  bool slow = det_db_score_mode == "slow";
+  int dest_width = pred.cols;
+  int dest_height = pred.rows;
 
   for (int _i = 0; _i < num_contours; _i++) {
-    if (contours[_i].size() <= 2) {
+    if (contours_[_i].size() <= 2) {
       continue;
     }
     float ssid;
-    cv::RotatedRect box = cv::minAreaRect(contours[_i]);
-    auto array = GetMiniBoxes(box, ssid);
-
-    auto box_for_unclip = array;
-    // end get_mini_box
+    cv::RotatedRect box = cv::minAreaRect(contours_[_i]);
+    cv::Point2f array[4];
+    GetMiniBoxes(box, array, ssid);
 
     if (ssid < min_size) {
       continue;
     }
     float score;
-    if (det_db_score_mode == "slow")
+    if (slow)
       /* compute using polygon*/
-      score = PolygonScoreAcc(contours[_i], pred);
+      score = PolygonScoreAcc(contours_[_i], pred);
     else
       score = BoxScoreFast(array, pred);
 
@@ -290,36 +247,29 @@ std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
       continue;
 
     // start for unclip
-    cv::RotatedRect points = UnClip(box_for_unclip, det_db_unclip_ratio);
+    cv::RotatedRect points = UnClip(array, box, det_db_unclip_ratio);
     if (points.size.height < 1.001 && points.size.width < 1.001) {
       continue;
     }
     // end for unclip
 
-    cv::RotatedRect clipbox = points;
-    auto cliparray = GetMiniBoxes(clipbox, ssid);
+    cv::Point2f cliparray[4];
+    GetMiniBoxes(points, cliparray, ssid);
 
     if (ssid < min_size + 2)
       continue;
 
-    int dest_width = pred.cols;
-    int dest_height = pred.rows;
-    std::vector<std::vector<int>> intcliparray;
-
+    TextBox text_box;
     for (int num_pt = 0; num_pt < 4; num_pt++) {
-      std::vector<int> a{int(clampf(roundf(cliparray[num_pt][0] / float(width) *
-                                           float(dest_width)),
-                                    0, float(dest_width))),
-                         int(clampf(roundf(cliparray[num_pt][1] /
-                                           float(height) * float(dest_height)),
-                                    0, float(dest_height)))};
-      intcliparray.push_back(a);
+      text_box.pts[num_pt].x =
+          int(clampf(roundf(cliparray[num_pt].x), 0, float(dest_width)));
+      text_box.pts[num_pt].y =
+          int(clampf(roundf(cliparray[num_pt].y), 0, float(dest_height)));
     }
-    boxes.push_back(intcliparray);
-    scores.push_back(score);
+    text_box.score = score;
+    boxes.push_back(text_box);
 
   } // end for
-  return boxes;
 }
 
 std::vector<std::vector<std::vector<int>>> DBPostProcessor::FilterTagDetRes(
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Event driven I/O thread with receive ring, send queue, low latency mode and frame callbacks.
  */
 
 #pragma once
@@ -153,17 +154,59 @@ namespace maix::peripheral::uart
         err::Err close();
 
         /**
-         * Set received callback function
-         * @param callback function to call when received data
+         * Set received callback function.
+         * Callback is called in UART I/O thread with all data received since last call,
+         * data is a view of internal receive buffer, only valid in callback.
+         * When callback is set, read() and available() return -err.ERR_BUSY.
+         * @param callback function to call when received data, None or nullptr to remove callback.
          * @maixpy maix.peripheral.uart.UART.set_received_callback
          */
         void set_received_callback(std::function<void(uart::UART&, Bytes&)> callback);
 
         /**
-         * Send data to device
+         * Set received callback of frames split by delimiter.
+         * data is a view of internal receive buffer, no memory is allocated for frames, only valid in callback.
+         * Data longer than max_len without delimiter is passed as a frame of max_len bytes.
+         * Callback is called in UART I/O thread, don't block it for long time.
+         * @param callback function to call with every frame, frame includes delimiter, nullptr to remove callback.
+         * @param delimiter frame delimiter, e.g. "\n" or "\r\n", can not be empty.
+         * @param max_len max frame length, range [1, 65536], default 4096.
+         * @return err::ERR_ARGS if args error.
+         * @maixcdk maix.peripheral.uart.UART.set_frame_callback
+         */
+        err::Err set_frame_callback(std::function<void(uart::UART&, const uint8_t*, int)> callback, const std::string &delimiter, int max_len = 4096);
+
+        /**
+         * Set received callback of fixed length frames.
+         * data is a view of internal receive buffer, only valid in callback.
+         * @param callback function to call with every frame, nullptr to remove callback.
+         * @param frame_len frame length, range [1, 65536].
+         * @return err::ERR_ARGS if args error.
+         * @maixcdk maix.peripheral.uart.UART.set_frame_callback
+         */
+        err::Err set_frame_callback(std::function<void(uart::UART&, const uint8_t*, int)> callback, int frame_len);
+
+        /**
+         * Set receive latency mode, can be set before or after open.
+         * By default every received byte wakes up the reader and serial driver setting is not changed.
+         * @param low_latency true: set ASYNC_LOW_LATENCY flag of serial driver to push received data at once, and wake up reader for every byte.
+         *                    false: clear ASYNC_LOW_LATENCY flag, and wake up reader only when batch bytes received (VMIN) or line idle for 8 bytes time,
+         *                    reduce CPU usage for continuous high speed data.
+         * @param batch bytes to receive in one wake up when low_latency is false, range [1, 255], default 64.
+         * @return err::ERR_ARGS if args error. Drivers not support ASYNC_LOW_LATENCY(e.g. pseudo terminal) don't return error.
+         * @maixpy maix.peripheral.uart.UART.set_low_latency
+         */
+        err::Err set_low_latency(bool low_latency, int batch = 64);
+
+        /**
+         * Send data to device.
+         * Data is written to device directly if send queue is empty, the rest is queued and sent by I/O thread,
+         * small writes queued are merged to one system call.
+         * Block only when send queue(64KiB) is full, return sent length if no data sent out in 1s (e.g. stopped by flow control).
+         * Can be called in received callbacks, data more than send queue is written directly by I/O thread then.
          * @param buff data buffer
          * @param len  data length need to send
-         * @return sent data length, < 0 means error, value is -err.Err.
+         * @return sent or queued data length, < 0 means error, value is -err.Err.
          * @maixcdk maix.peripheral.uart.UART.write
          */
         int write(const uint8_t *buff, int len);
@@ -266,10 +309,7 @@ namespace maix::peripheral::uart
         uart::STOP  _stopbits;
         uart::FLOW_CTRL  _flow_ctrl;
         int         _one_byte_time_us;
-        std::function<void(uart::UART&, Bytes&)> callback;
-        thread::Thread *_read_thread;
-        bool        _read_thread_need_exit;
-        bool        _read_thread_exit;
+        void        *_engine;
     };
 
     err::Err register_comm_callback(uart::UART *obj, std::function<void(uart::UART*)> callback);
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Event driven I/O thread with epoll, receive ring, send queue with writev, low latency mode and frame callbacks.
  */
 
 #include "maix_uart.hpp"
@@ -18,8 +19,17 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
 #include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <linux/serial.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
 
 namespace maix::peripheral::uart
 {
@@ -202,26 +212,476 @@ namespace maix::peripheral::uart
 		return 0;
 	}
 
-	static int _uart_read(int fd, void *buff, int len)
+	static err::Err _uart_set_low_latency(int fd, bool low_latency)
 	{
-		len = read(fd, buff, len);
-		return len;
+		struct serial_struct serial;
+		if (ioctl(fd, TIOCGSERIAL, &serial) < 0)
+		{
+			log::debug("uart not support TIOCGSERIAL: %d\n", errno);
+			return err::ERR_NONE;
+		}
+		if (low_latency)
+			serial.flags |= ASYNC_LOW_LATENCY;
+		else
+			serial.flags &= ~ASYNC_LOW_LATENCY;
+		if (ioctl(fd, TIOCSSERIAL, &serial) < 0)
+		{
+			log::debug("uart set ASYNC_LOW_LATENCY failed: %d\n", errno);
+		}
+		return err::ERR_NONE;
+	}
+
+	static int _uart_set_vmin(int fd, int vmin)
+	{
+		struct termios opt;
+		if (tcgetattr(fd, &opt) != 0)
+			return -1;
+		opt.c_cc[VMIN] = vmin;
+		opt.c_cc[VTIME] = 0;
+		return tcsetattr(fd, TCSANOW, &opt);
 	}
 
-	static int _uart_write(int fd, const void *buff, int len)
+	/**
+	 * Receive ring and send queue size, must be power of 2.
+	*/
+	#define UART_RX_SIZE (64 * 1024)
+	#define UART_TX_SIZE (64 * 1024)
+
+	/**
+	 * Private data of UART, one I/O thread waits tty fd and an eventfd with epoll:
+	 * - Received bytes are put to rx ring, lock-free single producer(I/O thread) single consumer(readers or callbacks),
+	 *   consumers are serialized by read_lock. When ring is full, tty is not read until space freed,
+	 *   the consumer signals eventfd if rx_paused set.
+	 * - write() writes directly if send queue is empty, or append to tx queue, I/O thread sends queue with writev.
+	 * - In batch mode VMIN is batch when data is coming so epoll wakes up only after batch bytes,
+	 *   an idle timer collects the tail, VMIN is set back to 1 when line is idle.
+	*/
+	struct _Engine
 	{
-		ssize_t bytes_written = write(fd, buff, len);
-		if (bytes_written < 0) {
-			log::error("uart write failed: %d", bytes_written);
-			return bytes_written;
+		UART *uart = nullptr;
+		int fd = -1;
+		int epoll_fd = -1;
+		int event_fd = -1;
+		int byte_us = 100;
+		std::thread thread;
+		std::atomic<bool> running{false};
+		std::atomic<bool> broken{false};
+		uint32_t events = 0;            // epoll events of fd, I/O thread only
+		int vmin = 1;                   // current VMIN, I/O thread only
+
+		// receive ring, second half is used to make wrapped data continuous for callbacks
+		uint8_t *rx = nullptr;
+		std::atomic<uint64_t> rx_head{0};
+		std::atomic<uint64_t> rx_tail{0};
+		std::atomic<bool> rx_paused{false};
+		std::atomic<int> rx_waiters{0};
+		std::mutex rx_lock;
+		std::condition_variable rx_cond;
+		std::recursive_mutex read_lock;
+
+		// send queue
+		std::mutex write_lock;
+		std::mutex tx_lock;
+		std::condition_variable tx_cond;
+		uint8_t *tx = nullptr;
+		uint64_t tx_head = 0;
+		uint64_t tx_tail = 0;
+
+		// callbacks, set under read_lock, I/O thread calls its own copies so callbacks can reset callbacks
+		std::function<void(UART&, Bytes&)> on_recv;
+		std::function<void(UART&, const uint8_t*, int)> on_frame;
+		std::string delimiter;
+		int frame_len = 0;
+		int max_len = 0;
+		uint32_t cb_gen = 0;
+		uint32_t io_gen = 0;
+		std::function<void(UART&, Bytes&)> io_on_recv;
+		std::function<void(UART&, const uint8_t*, int)> io_on_frame;
+		std::string io_delimiter;
+		int io_frame_len = 0;
+		int io_max_len = 0;
+		size_t scanned = 0;             // bytes from rx_tail already searched for delimiter
+
+		std::atomic<bool> low_latency{false};
+		bool latency_set = false;       // driver flag is changed only after set_low_latency called
+		std::atomic<bool> set_driver{false};
+		std::atomic<int> batch{1};
+
+		_Engine()
+		{
+			rx = new uint8_t[UART_RX_SIZE * 2];
+			tx = new uint8_t[UART_TX_SIZE];
 		}
 
-		// wait for data transmit completion
-		// if (tcdrain(fd) != 0) {
-		// 	log::error("uart wait write failed: %d", bytes_written);
-		// 	return -1;
-		// }
-		return bytes_written;
+		~_Engine()
+		{
+			delete[] rx;
+			delete[] tx;
+		}
+	};
+
+	static void _wake(_Engine *e)
+	{
+		if (e->event_fd >= 0)
+			eventfd_write(e->event_fd, 1);
+	}
+
+	static inline size_t _rx_avail(_Engine *e)
+	{
+		return (size_t)(e->rx_head.load() - e->rx_tail.load(std::memory_order_relaxed));
+	}
+
+	static inline bool _cb_active(_Engine *e)
+	{
+		return e->on_recv || e->on_frame;
+	}
+
+	// consumer, must hold read_lock
+	static int _rx_pop(_Engine *e, uint8_t *buff, int len)
+	{
+		uint64_t tail = e->rx_tail.load(std::memory_order_relaxed);
+		uint64_t head = e->rx_head.load(std::memory_order_acquire);
+		size_t n = std::min((size_t)(head - tail), (size_t)len);
+		size_t off = tail & (UART_RX_SIZE - 1);
+		size_t first = std::min(n, (size_t)UART_RX_SIZE - off);
+		memcpy(buff, e->rx + off, first);
+		memcpy(buff + first, e->rx, n - first);
+		e->rx_tail.store(tail + n);
+		if (n > 0 && e->rx_paused.load())
+			_wake(e);
+		return (int)n;
+	}
+
+	// wait until at least need bytes in rx ring, timeout_us < 0 means wait forever, return bytes in ring.
+	static size_t _rx_wait(_Engine *e, size_t need, int64_t timeout_us)
+	{
+		size_t avail = _rx_avail(e);
+		if (avail >= need || timeout_us == 0)
+			return avail;
+		uint64_t deadline = time::ticks_us() + timeout_us;
+		e->rx_waiters.fetch_add(1);
+		{
+			std::unique_lock<std::mutex> lock(e->rx_lock);
+			while ((avail = _rx_avail(e)) < need && e->running.load() && !e->broken.load() && !app::need_exit())
+			{
+				int64_t wait_us = 100000; // check app exit flag
+				if (timeout_us > 0)
+				{
+					int64_t left = (int64_t)(deadline - time::ticks_us());
+					if (left <= 0)
+						break;
+					wait_us = std::min(left, wait_us);
+				}
+				e->rx_cond.wait_for(lock, std::chrono::microseconds(wait_us));
+			}
+		}
+		e->rx_waiters.fetch_sub(1);
+		return avail;
+	}
+
+	static void _rx_notify(_Engine *e)
+	{
+		if (e->rx_waiters.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(e->rx_lock);
+			e->rx_cond.notify_all();
+		}
+	}
+
+	// producer, read tty until ring full or no data, return read bytes
+	static int _rx_fill(_Engine *e)
+	{
+		int total = 0;
+		while (1)
+		{
+			uint64_t head = e->rx_head.load(std::memory_order_relaxed);
+			size_t space = UART_RX_SIZE - (size_t)(head - e->rx_tail.load());
+			if (space == 0)
+			{
+				e->rx_paused.store(true);
+				if (UART_RX_SIZE - (size_t)(head - e->rx_tail.load()) == 0)
+					break;
+				continue;
+			}
+			e->rx_paused.store(false);
+			size_t off = head & (UART_RX_SIZE - 1);
+			size_t chunk = std::min(space, (size_t)UART_RX_SIZE - off);
+			ssize_t n = ::read(e->fd, e->rx + off, chunk);
+			if (n > 0)
+			{
+				e->rx_head.store(head + n);
+				total += n;
+				if ((size_t)n < chunk)
+					break;
+				continue;
+			}
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n < 0 && errno == EAGAIN)
+				break;
+			// 0 or EIO means hang up, e.g. USB serial unplugged or pty peer closed
+			if (n == 0 || errno == EIO)
+				log::error("uart %s hang up\n", e->uart->get_port().c_str());
+			else
+				log::error("uart %s read failed: %d\n", e->uart->get_port().c_str(), errno);
+			e->broken.store(true);
+			break;
+		}
+		return total;
+	}
+
+	// make ring data [tail, tail + n) continuous
+	static uint8_t *_rx_view(_Engine *e, uint64_t tail, size_t n)
+	{
+		size_t off = tail & (UART_RX_SIZE - 1);
+		if (off + n > UART_RX_SIZE)
+			memcpy(e->rx + UART_RX_SIZE, e->rx, off + n - UART_RX_SIZE);
+		return e->rx + off;
+	}
+
+	static void _dispatch(_Engine *e)
+	{
+		std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+		while (1)
+		{
+			if (e->io_gen != e->cb_gen)
+			{
+				e->io_gen = e->cb_gen;
+				e->io_on_recv = e->on_recv;
+				e->io_on_frame = e->on_frame;
+				e->io_delimiter = e->delimiter;
+				e->io_frame_len = e->frame_len;
+				e->io_max_len = e->max_len;
+				e->scanned = 0;
+			}
+			if (!e->io_on_recv && !e->io_on_frame)
+				return;
+			uint32_t gen = e->io_gen;
+			uint64_t tail = e->rx_tail.load(std::memory_order_relaxed);
+			size_t n = (size_t)(e->rx_head.load(std::memory_order_acquire) - tail);
+			if (n == 0)
+				return;
+			uint8_t *p = _rx_view(e, tail, n);
+			size_t used = 0;
+			if (e->io_on_recv)
+			{
+				Bytes data(p, n, false, false);
+				e->io_on_recv(*e->uart, data);
+				used = n;
+			}
+			else if (e->io_frame_len > 0)
+			{
+				size_t frame_len = e->io_frame_len;
+				while (n - used >= frame_len && e->cb_gen == gen)
+				{
+					e->io_on_frame(*e->uart, p + used, frame_len);
+					used += frame_len;
+				}
+			}
+			else
+			{
+				const std::string &delim = e->io_delimiter;
+				size_t max_len = e->io_max_len;
+				while (used < n && e->cb_gen == gen)
+				{
+					size_t from = used + e->scanned;
+					const uint8_t *found = (const uint8_t *)memmem(p + from, n - from, delim.data(), delim.size());
+					size_t frame;
+					if (found)
+						frame = found + delim.size() - (p + used);
+					else if (n - used >= max_len)
+						frame = max_len;
+					else
+					{
+						e->scanned = n - used >= delim.size() ? n - used - delim.size() + 1 : 0;
+						break;
+					}
+					if (frame > max_len)
+						frame = max_len;
+					e->scanned = 0;
+					e->io_on_frame(*e->uart, p + used, frame);
+					used += frame;
+				}
+			}
+			if (used > 0)
+				e->rx_tail.store(tail + used);
+			// callback changed in callback, pass the rest data to new callback
+			if (e->cb_gen == gen)
+				return;
+		}
+	}
+
+	// send queued data, return true if data left in queue
+	static bool _tx_flush(_Engine *e)
+	{
+		std::lock_guard<std::mutex> lock(e->tx_lock);
+		while (e->tx_head != e->tx_tail)
+		{
+			size_t n = e->tx_head - e->tx_tail;
+			size_t off = e->tx_tail & (UART_TX_SIZE - 1);
+			size_t first = std::min(n, (size_t)UART_TX_SIZE - off);
+			struct iovec iov[2] = {{e->tx + off, first}, {e->tx, n - first}};
+			ssize_t ret = writev(e->fd, iov, n > first ? 2 : 1);
+			if (ret > 0)
+			{
+				e->tx_tail += ret;
+				continue;
+			}
+			if (ret < 0 && errno == EINTR)
+				continue;
+			if (ret < 0 && errno == EAGAIN)
+				break;
+			log::error("uart write failed: %d\n", errno);
+			e->tx_tail = e->tx_head;
+		}
+		e->tx_cond.notify_all();
+		return e->tx_head != e->tx_tail;
+	}
+
+	static void _update_events(_Engine *e, bool tx_pending)
+	{
+		if (e->broken.load())
+		{
+			if (e->events)
+			{
+				epoll_ctl(e->epoll_fd, EPOLL_CTL_DEL, e->fd, NULL);
+				e->events = 0;
+			}
+			return;
+		}
+		uint32_t events = (e->rx_paused.load() ? 0 : EPOLLIN) | (tx_pending ? EPOLLOUT : 0);
+		if (events != e->events)
+		{
+			struct epoll_event ev = {};
+			ev.events = events;
+			ev.data.fd = e->fd;
+			epoll_ctl(e->epoll_fd, EPOLL_CTL_MOD, e->fd, &ev);
+			e->events = events;
+		}
+	}
+
+	static void _io_loop(_Engine *e)
+	{
+		struct epoll_event evs[4];
+		int timeout = -1;
+		while (e->running.load())
+		{
+			int n = epoll_wait(e->epoll_fd, evs, 4, timeout);
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				log::error("uart epoll_wait failed: %d\n", errno);
+				break;
+			}
+			bool readable = (n == 0), hangup = false;
+			for (int i = 0; i < n; ++i)
+			{
+				if (evs[i].data.fd == e->event_fd)
+				{
+					eventfd_t v;
+					eventfd_read(e->event_fd, &v);
+					continue;
+				}
+				readable |= (evs[i].events & EPOLLIN) != 0;
+				hangup |= (evs[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+			}
+			if (e->set_driver.exchange(false))
+				_uart_set_low_latency(e->fd, e->low_latency.load());
+			int got = 0;
+			if (!e->broken.load() && (readable || hangup || e->rx_paused.load()))
+			{
+				got = _rx_fill(e);
+				if (hangup && got == 0 && !e->broken.load())
+				{
+					log::error("uart %s hang up\n", e->uart->get_port().c_str());
+					e->broken.store(true);
+				}
+			}
+			// batch mode: wake up every batch bytes while data is coming, collect the tail after line idle
+			int batch = e->batch.load();
+			int vmin = e->vmin;
+			if (batch > 1 && got > 0)
+			{
+				vmin = batch;
+				timeout = std::max(1, e->byte_us * 8 / 1000);
+			}
+			else if (batch <= 1 || n == 0)
+			{
+				vmin = 1;
+				timeout = -1;
+			}
+			if (vmin != e->vmin && !e->broken.load())
+			{
+				_uart_set_vmin(e->fd, vmin);
+				e->vmin = vmin;
+			}
+			bool tx_pending = e->broken.load() ? false : _tx_flush(e);
+			_dispatch(e);
+			if (got > 0 || e->broken.load())
+				_rx_notify(e);
+			if (e->rx_paused.load() && _rx_avail(e) < UART_RX_SIZE)
+				e->rx_paused.store(false);
+			_update_events(e, tx_pending);
+		}
+		{
+			std::lock_guard<std::mutex> lock(e->tx_lock);
+			e->tx_cond.notify_all();
+		}
+		std::lock_guard<std::mutex> lock(e->rx_lock);
+		e->rx_cond.notify_all();
+	}
+
+	static void _engine_stop(_Engine *e)
+	{
+		if (e->thread.joinable())
+		{
+			e->running.store(false);
+			_wake(e);
+			e->thread.join();
+		}
+		if (e->epoll_fd >= 0)
+			::close(e->epoll_fd);
+		if (e->event_fd >= 0)
+			::close(e->event_fd);
+		e->epoll_fd = -1;
+		e->event_fd = -1;
+	}
+
+	static err::Err _engine_start(_Engine *e, int fd)
+	{
+		e->fd = fd;
+		e->rx_head.store(0);
+		e->rx_tail.store(0);
+		e->rx_paused.store(false);
+		e->broken.store(false);
+		e->tx_head = e->tx_tail = 0;
+		e->vmin = 1;
+		e->scanned = 0;
+		e->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		e->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (e->epoll_fd < 0 || e->event_fd < 0)
+		{
+			log::error("uart create epoll failed: %d\n", errno);
+			_engine_stop(e);
+			return err::ERR_IO;
+		}
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = e->event_fd;
+		epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, e->event_fd, &ev);
+		ev.data.fd = fd;
+		if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		{
+			log::error("uart add fd to epoll failed: %d\n", errno);
+			_engine_stop(e);
+			return err::ERR_IO;
+		}
+		e->events = EPOLLIN;
+		e->set_driver.store(e->latency_set);
+		e->running.store(true);
+		e->thread = std::thread(_io_loop, e);
+		return err::ERR_NONE;
 	}
 
 	UART::UART(const std::string &port, int baudrate, uart::BITS databits,
@@ -235,13 +695,17 @@ namespace maix::peripheral::uart
 		_parity = parity;
 		_stopbits = stopbits;
 		_flow_ctrl = flow_ctrl;
-		_read_thread = nullptr;
+		_one_byte_time_us = 100;
+		_Engine *e = new _Engine();
+		e->uart = this;
+		_engine = e;
 		if (!port.empty())
 		{
-			err::Err e = this->open();
-			if (e != err::ERR_NONE)
+			err::Err ret = this->open();
+			if (ret != err::ERR_NONE)
 			{
-				throw err::Exception(e, "open uart " + _uart_port + " failed");
+				delete (_Engine *)_engine;
+				throw err::Exception(ret, "open uart " + _uart_port + " failed");
 			}
 		}
 	}
@@ -249,6 +713,7 @@ namespace maix::peripheral::uart
 	UART::~UART()
 	{
 		this->close();
+		delete (_Engine *)_engine;
 	}
 
     static int set_pinmux(uint64_t addr, uint32_t value)
@@ -327,6 +792,16 @@ namespace maix::peripheral::uart
 		// self.oneByteTime = 1 / (self.com.baudrate / (self.com.bytesize + 2 + self.com.stopbits)) # 1 byte use time
 		_one_byte_time_us = 1000000.0 / (_baudrate / (_databits + 2 + (_stopbits == STOP_1_5 ? 1.5 : _stopbits)));
 		log::debug("one byte time: %d", _one_byte_time_us);
+
+		_Engine *e = (_Engine *)_engine;
+		e->byte_us = _one_byte_time_us;
+		err::Err ret = _engine_start(e, _fd);
+		if (ret != err::ERR_NONE)
+		{
+			_uart_deinit(_fd);
+			_fd = -1;
+			return ret;
+		}
 		return err::ERR_NONE;
 	}
 
@@ -339,24 +814,20 @@ namespace maix::peripheral::uart
 	{
 		if (_fd <= 0)
 			return err::ERR_NONE;
-		int ret = _uart_deinit(_fd);
-		_fd = -1;
-		if(_read_thread)
+		_Engine *e = (_Engine *)_engine;
 		{
-			_read_thread_need_exit = true;
-			uint64_t t = time::ticks_ms();
-			while(!_read_thread_exit)
-			{
-				time::sleep_ms(10);
-				if(time::ticks_ms() - t > 5000)
-				{
-					log::error("waiting uart read thread exit");
-					t = time::ticks_ms();
-				}
-			}
-			delete _read_thread;
-			_read_thread = nullptr;
+			// send out queued data
+			std::lock_guard<std::mutex> write_lock(e->write_lock);
+			std::unique_lock<std::mutex> lock(e->tx_lock);
+			int wait_ms = (int)((e->tx_head - e->tx_tail) * _one_byte_time_us / 1000) + 100;
+			e->tx_cond.wait_for(lock, std::chrono::milliseconds(wait_ms), [e]{
+				return e->tx_head == e->tx_tail || e->broken.load() || !e->running.load();
+			});
 		}
+		_engine_stop(e);
+		int ret = _uart_deinit(_fd);
+		_fd = -1;
+		e->fd = -1;
 		if (ret != 0)
 		{
 			log::error("uart close failed\r\n");
@@ -367,64 +838,131 @@ namespace maix::peripheral::uart
 
 	void UART::set_received_callback(std::function<void(uart::UART&, Bytes&)> callback)
 	{
-		if(!_read_thread)
-		{
-			_read_thread_need_exit = false;
-			_read_thread_exit = false;
-			_read_thread = new thread::Thread([callback](void *args){
-				UART *uart = (UART*)args;
-				while(!app::need_exit() && !uart->_read_thread_need_exit)
-				{
-					Bytes *data = NULL;
-					try
-					{
-						data = uart->read(-1, -1);
-					}
-					catch(const err::Exception& e)
-					{
-						log::error("read file failed");
-						break;
-					}
-					if(!data)
-					{
-						log::error("uart read data is null");
-						break;
-					}
-					callback(*uart, *data);
-					delete data;
-				}
-				uart->_read_thread_exit = true;
-			}, this);
-			_read_thread->detach();
-		}
-		this->callback = callback;
+		_Engine *e = (_Engine *)_engine;
+		std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+		e->on_recv = callback;
+		e->on_frame = nullptr;
+		++e->cb_gen;
+		_wake(e);
+	}
+
+	err::Err UART::set_frame_callback(std::function<void(uart::UART&, const uint8_t*, int)> callback, const std::string &delimiter, int max_len)
+	{
+		if (delimiter.empty() || max_len <= 0 || max_len > UART_RX_SIZE)
+			return err::ERR_ARGS;
+		_Engine *e = (_Engine *)_engine;
+		std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+		e->on_recv = nullptr;
+		e->on_frame = callback;
+		e->delimiter = delimiter;
+		e->frame_len = 0;
+		e->max_len = max_len;
+		++e->cb_gen;
+		_wake(e);
+		return err::ERR_NONE;
+	}
+
+	err::Err UART::set_frame_callback(std::function<void(uart::UART&, const uint8_t*, int)> callback, int frame_len)
+	{
+		if (frame_len <= 0 || frame_len > UART_RX_SIZE)
+			return err::ERR_ARGS;
+		_Engine *e = (_Engine *)_engine;
+		std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+		e->on_recv = nullptr;
+		e->on_frame = callback;
+		e->delimiter.clear();
+		e->frame_len = frame_len;
+		e->max_len = frame_len;
+		++e->cb_gen;
+		_wake(e);
+		return err::ERR_NONE;
+	}
+
+	err::Err UART::set_low_latency(bool low_latency, int batch)
+	{
+		if (batch < 1 || batch > 255)
+			return err::ERR_ARGS;
+		_Engine *e = (_Engine *)_engine;
+		e->low_latency.store(low_latency);
+		e->batch.store(low_latency ? 1 : batch);
+		e->latency_set = true;
+		e->set_driver.store(true);
+		_wake(e);
+		return err::ERR_NONE;
 	}
 
 	int UART::write(const uint8_t *buff, int len)
 	{
 		if (!is_open())
-			return err::ERR_NOT_OPEN;
-		int remain_len = len;
-		while (remain_len != 0)
+			return -err::ERR_NOT_OPEN;
+		if (len <= 0)
+			return 0;
+		_Engine *e = (_Engine *)_engine;
+		std::lock_guard<std::mutex> write_lock(e->write_lock);
+		std::unique_lock<std::mutex> lock(e->tx_lock);
+		if (e->broken.load())
+			return -err::ERR_IO;
+		int sent = 0;
+		if (e->tx_head == e->tx_tail)
 		{
-			const uint8_t *p = buff + len - remain_len;
-			int len = _uart_write(_fd, p, remain_len);
-			if (len < 0)
+			ssize_t n = ::write(_fd, buff, len);
+			if (n > 0)
+				sent = n;
+			else if (n < 0 && errno != EAGAIN && errno != EINTR)
 			{
-				log::error("uart write failed, fd: %d, ret: %d\r\n", _fd, len);
-				return err::ERR_IO;
+				log::error("uart write failed, fd: %d, errno: %d\r\n", _fd, errno);
+				return -err::ERR_IO;
 			}
-			else if (len == 0)
+		}
+		bool wake = false;
+		bool in_io_thread = std::this_thread::get_id() == e->thread.get_id();
+		while (sent < len)
+		{
+			size_t queued = e->tx_head - e->tx_tail;
+			if (queued == UART_TX_SIZE && in_io_thread)
 			{
-				break;
+				// called by callback, I/O thread won't send queue until callback returns, send it here
+				uint64_t tail = e->tx_tail;
+				lock.unlock();
+				if (_tx_flush(e))
+				{
+					struct pollfd pfd = {_fd, POLLOUT, 0};
+					if (poll(&pfd, 1, 1000) > 0)
+						_tx_flush(e);
+				}
+				lock.lock();
+				if (e->tx_tail == tail) // no data sent out in 1s, stopped by flow control
+					break;
+				continue;
 			}
-			remain_len -= len;
-			if (remain_len <= 0)
+			if (queued == UART_TX_SIZE)
 			{
-				break;
+				if (wake)
+				{
+					_wake(e);
+					wake = false;
+				}
+				uint64_t tail = e->tx_tail;
+				e->tx_cond.wait_for(lock, std::chrono::milliseconds(1000), [e, tail]{
+					return e->tx_tail != tail || !e->running.load();
+				});
+				if (e->tx_tail == tail) // no data sent out in 1s, stopped by flow control or closed
+					break;
+				continue;
 			}
+			if (queued == 0)
+				wake = true;
+			size_t n = std::min((size_t)(len - sent), (size_t)UART_TX_SIZE - queued);
+			size_t off = e->tx_head & (UART_TX_SIZE - 1);
+			size_t first = std::min(n, (size_t)UART_TX_SIZE - off);
+			memcpy(e->tx + off, buff + sent, first);
+			memcpy(e->tx, buff + sent + first, n - first);
+			e->tx_head += n;
+			sent += n;
 		}
-		return len - remain_len;
+		if (wake)
+			_wake(e);
+		return sent;
 	}
 
 	int UART::write(const char *buff, int len)
@@ -455,52 +993,17 @@ namespace maix::peripheral::uart
 	{
 		if (!is_open())
 			return -err::ERR_NOT_OPEN;
-		// TIOCINQ
-		int bytes = 0;
-		if (timeout == 0)
+		_Engine *e = (_Engine *)_engine;
 		{
-			if (ioctl(_fd, TIOCINQ, &bytes) < 0)
-			{
-				log::error("uart ioctl failed: %d\r\n", errno);
-				return -err::ERR_IO;
-			}
-			return bytes;
-		}
-		timespec timeout_ts;
-		timespec *p_timout = NULL;
-		if (timeout > 0)
-		{
-			timeout_ts.tv_sec = timeout / 1000;
-			timeout_ts.tv_nsec = (timeout % 1000) * 1000000;
-			p_timout = &timeout_ts;
+			std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+			if (_cb_active(e))
+				return -err::ERR_BUSY;
 		}
-		fd_set rfds;
-		FD_ZERO(&rfds);
-		FD_SET(_fd, &rfds);
-		int ret = pselect(_fd + 1, &rfds, NULL, NULL, p_timout, NULL);
-		if (ret < 0)
-		{
-			if (errno == EINTR)
-				return -err::ERR_CANCEL;
-			else
-			{
-				log::error("uart select failed: %d\r\n", errno);
-				return -err::ERR_IO;
-			}
-		}
-		else if (ret == 0)
-		{
-			return 0;
-		}
-		if (!FD_ISSET(_fd, &rfds)) // should not happen
-		{
-			throw err::Exception(err::ERR_IO, "uart fd not in select fds");
-		}
-		if (ioctl(_fd, TIOCINQ, &bytes) < 0)
-		{
-			log::error("uart ioctl failed: %d\r\n", errno);
+		int bytes = (int)_rx_wait(e, 1, timeout < 0 ? -1 : (int64_t)timeout * 1000);
+		if (bytes == 0 && e->broken.load())
 			return -err::ERR_IO;
-		}
+		if (bytes == 0 && timeout != 0 && app::need_exit())
+			return -err::ERR_CANCEL;
 		return bytes;
 	}
 
@@ -508,101 +1011,70 @@ namespace maix::peripheral::uart
 	{
 		if (!is_open())
 			return -err::ERR_NOT_OPEN;
-		uint64_t t = time::ticks_ms();
+		if (recv_len != -1 && recv_len <= 0)
+			throw err::Exception(err::ERR_ARGS, "recv_len must be -1 or > 0");
+		_Engine *e = (_Engine *)_engine;
+		int want = recv_len > 0 ? std::min(recv_len, buff_len) : buff_len;
+		uint64_t t = time::ticks_us();
 		int read_len = 0;
-		if (recv_len == -1)
+		while (read_len < want)
 		{
-			while (1)
 			{
-				int left_len = buff_len - read_len;
-				if(left_len <= 0)
-					break;
-				int len = _uart_read(_fd, buff + read_len, left_len);
-				if(len < 0)
-				{
-					if(errno != EAGAIN)
-					{
-						log::error("uart read failed: %d, %d\r\n", len, errno);
-						return -err::ERR_IO;
-					}
-				}
-				else
-				{
-					read_len += len;
-				}
-				if (timeout > 0 && (time::ticks_ms() - t) < (uint64_t)timeout)
-					time::sleep_ms(1);
-				else if (available(0) > 0)
-					continue;
-				else
-				{
-					int wait_time = _one_byte_time_us * 30; // system maybe use some time
-					time::sleep_us(wait_time > 50000 ? 50000: wait_time);
-					if (available(0) > 0)
-						continue;
-					if (timeout < 0 && read_len == 0) // block read
-					{
-						available(-1);
-						continue;
-					}
+				std::lock_guard<std::recursive_mutex> lock(e->read_lock);
+				if (_cb_active(e))
+					return read_len > 0 ? read_len : -err::ERR_BUSY;
+				read_len += _rx_pop(e, buff + read_len, want - read_len);
+			}
+			if (read_len >= want)
+				break;
+			if (recv_len == -1 && read_len > 0)
+			{
+				// read until line idle for 30 bytes time
+				int wait_time = _one_byte_time_us * 30; // system maybe use some time
+				if (_rx_wait(e, 1, wait_time > 50000 ? 50000 : wait_time) == 0)
 					break;
-				}
+				continue;
 			}
-			return read_len;
-		}
-		if (recv_len > 0)
-		{
-			int t_last = 0;
-			bool _available = false;
-			while(1)
+			int64_t left = -1;
+			if (timeout == 0)
+				break;
+			if (timeout > 0)
 			{
-				if(timeout > 0)
-				{
-					t_last = timeout - (time::ticks_ms() - t);
-					if(t_last < 0)
-						t_last = 0;
-					_available = available(t_last);
-				}
-				else
-					_available = available(timeout);
-				if (_available)
-				{
-					int len = _uart_read(_fd, buff + read_len, recv_len - read_len);
-					if (len < 0)
-					{
-						log::error("uart read failed\r\n");
-						return -err::ERR_IO;
-					}
-					read_len += len;
-				}
-				if(read_len >= recv_len || (timeout > 0 && (time::ticks_ms() - t) > (uint64_t)timeout))
+				left = (int64_t)timeout * 1000 - (int64_t)(time::ticks_us() - t);
+				if (left <= 0)
 					break;
-				int wait_time = _one_byte_time_us * 30; // system maybe use some time
-				time::sleep_us(wait_time > 50000 ? 50000: wait_time);
-				if(available(0) > 0)
-					continue;
-				if(timeout == 0)
+			}
+			if (_rx_wait(e, recv_len == -1 ? 1 : want - read_len, left) == 0)
+			{
+				if (e->broken.load())
+					return read_len > 0 ? read_len : -err::ERR_IO;
+				if (app::need_exit() || !e->running.load())
 					break;
 			}
-			return read_len;
 		}
-		throw err::Exception(err::ERR_ARGS, "recv_len must be -1 or > 0");
+		return read_len;
 	}
 
 	Bytes *UART::read(int len, int timeout)
 	{
-		int read_len = 0;
-		int buff_len = len > 0 ? len : 512;
+		if (len > 0)
+		{
+			Bytes *data = new Bytes(NULL, len);
+			int read_len = read(data->data, len, len, timeout);
+			if (read_len < 0)
+			{
+				delete data;
+				throw err::Exception(err::Err(-read_len), "read failed");
+			}
+			data->data_len = read_len;
+			return data;
+		}
+		int buff_len = 512;
 		Bytes *data = new Bytes(NULL, buff_len);
 		int received = 0;
-		uint64_t t = time::ticks_ms();
-		int t2;
 		while(1)
 		{
-			t2 = (int)(time::ticks_ms() - t);
-			if(timeout > 0 && t2 >= timeout)
-				break;
-			read_len = read(data->data + received, buff_len - received, len > 0 ? len - received : len, timeout > 0 ? t2 : timeout);
+			int read_len = read(data->data + received, buff_len - received, -1, received > 0 ? 0 : timeout);
 			if (read_len < 0)
 			{
 				delete data;
@@ -610,59 +1082,53 @@ namespace maix::peripheral::uart
 			}
 			received += read_len;
 			data->data_len = received;
-			if(len > 0 && received == len)
-			{
-				break;
-			}
-			if(timeout > 0 && (int)(time::ticks_ms() - t) >= timeout)
+			if(received < buff_len)
 				break;
-			else if(received == buff_len)
-			{
-				buff_len = data->data_len * 2;
-				Bytes *data2 = new Bytes(data->data, buff_len, true, true);
-				delete data;
-				data = data2;
-				continue;
-			}
-			break;
+			buff_len *= 2;
+			Bytes *data2 = new Bytes(NULL, buff_len);
+			memcpy(data2->data, data->data, received);
+			data2->data_len = received;
+			delete data;
+			data = data2;
 		}
 		return data;
 	}
 
 	Bytes *UART::readline(int timeout)
 	{
-		int read_len = 0;
-		int buff_len = 128;
 		if(timeout == 0)
 		{
 			throw err::Exception(err::ERR_ARGS, "timeout must be -1 or > 0");
 		}
-		Bytes *data = new Bytes(NULL, buff_len);
+		std::string line;
 		uint64_t t = time::ticks_ms();
-		do
+		while (1)
 		{
+			int left = -1;
+			if (timeout > 0)
+			{
+				left = timeout - (int)(time::ticks_ms() - t);
+				if (left <= 0)
+					break;
+			}
 			uint8_t chr;
-			int len = this->read(&chr, 1, 1, (timeout < 0 ? -1 : (int)(time::ticks_ms() - t)));
+			int len = this->read(&chr, 1, 1, left);
 			if(len < 0)
 			{
 				log::error("uart read failed: %d\n", - len);
 				break;
 			}
-			else if(len > 0)
+			if(len == 0)
 			{
-				data->data[read_len] = chr;
-				read_len += len;
-				if(chr == '\n')
+				if (app::need_exit() || !is_open())
 					break;
+				continue;
 			}
-			else
-			{
-				time::sleep_ms(1);
-			}
-		} while (timeout < 0 || (timeout > 0 && (time::ticks_ms() - t) < (uint64_t)timeout));
-
-		data->data_len = read_len;
-		return data;
+			line.push_back((char)chr);
+			if(chr == '\n')
+				break;
+		}
+		return new Bytes((uint8_t *)line.data(), line.size());
 	}
 
 	std::vector<std::string> list_devices()
@@ -110,6 +110,28 @@ namespace maix::camera
         */
         image::Image *read_raw();
 
+        /**
+         * Enable or disable zero copy read, only supported by V4L2 camera on Linux now.
+         * When enabled, if format no need convert and buff arg of read is nullptr(e.g. FMT_JPEG from MJPEG camera),
+         * read returns image referencing camera buffer directly, and the buffer is given back to camera when image object deleted.
+         * So delete image as soon as possible and before camera close, or camera will have no buffer to fill new frames.
+         * @param enable true to enable, false to disable, default disabled.
+         * @param drop_old if true, read always returns the newest frame and gives older frames in queue back to camera,
+         *                 so latency will not accumulate when app is slower than camera, queue depth is buff_num arg of open. default false.
+         * @return err::ERR_NONE if success, err::ERR_NOT_IMPL if not supported.
+         * @maixpy maix.camera.Camera.set_zero_copy
+        */
+        err::Err set_zero_copy(bool enable, bool drop_old = false);
+
+        /**
+         * Export camera buffer of zero copy image as DMABUF, to share frame with other devices(e.g. encoder, GPU) without copy.
+         * @param img image returned by read in zero copy mode.
+         * @return DMABUF fd, owned by camera, don't close it, valid until camera close.
+         *         -1 if img is not a zero copy image or driver not support DMABUF export.
+         * @maixpy maix.camera.Camera.get_dmabuf_fd
+        */
+        int get_dmabuf_fd(image::Image &img);
+
         /**
          * Clear buff to ensure the next read image is the latest image
          * @maixpy maix.camera.Camera.clear_buff
@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Add LABThresholds overloads of find_blobs, binary and get_regression.
  */
 
 #pragma once
@@ -14,8 +15,10 @@
 #include "maix_image_def.hpp"
 #include "maix_image_color.hpp"
 #include "maix_image_obj.hpp"
+#include "maix_image_threshold.hpp"
 #include "maix_type.hpp"
 #include <stdlib.h>
+#include <functional>
 
 /**
  * @brief maix.image module, image related definition and functions
@@ -107,6 +110,15 @@ namespace maix::image
 
         void operator=(const image::Image &img);
 
+        /**
+         * Set callback called when image data released(image deleted or updated),
+         * used by image borrowed data from others(copy is false), e.g. camera buffer, to give data back to owner.
+         * Callback is not copied when image copied, only this image gives data back.
+         * @param cb callback function, empty function to clear callback.
+         * @maixcdk maix.image.Image.set_release_cb
+         */
+        void set_release_cb(std::function<void()> cb) { _release_cb = cb; }
+
         //************************** get and set basic info **************************//
 
         /**
@@ -676,6 +688,13 @@ namespace maix::image
         */
         image::Image *binary(std::vector<std::vector<int>> thresholds = std::vector<std::vector<int>>(), bool invert = false, bool zero = false, image::Image *mask = nullptr, bool to_bitmap = false, bool copy = false);
 
+        /**
+         * @brief Same as binary with thresholds list, but use compiled thresholds, see image::LABThresholds.
+         * RGB565 and RGB888 images without mask are processed in one pass with SIMD table lookup.
+         * @maixcdk maix.image.Image.binary
+        */
+        image::Image *binary(const image::LABThresholds &thresholds, bool invert = false, bool zero = false, image::Image *mask = nullptr, bool to_bitmap = false, bool copy = false);
+
         /**
          * @brief Inverts the image in place.
          * @return Returns the image after the operation is completed
@@ -1177,6 +1196,12 @@ namespace maix::image
         */
         std::vector<image::Line> get_regression(std::vector<std::vector<int>> thresholds = std::vector<std::vector<int>>(), bool invert = false, std::vector<int> roi = std::vector<int>(), int x_stride = 2, int y_stride = 1, int area_threshold = 10, int pixels_threshold = 10, bool robust = false);
 
+        /**
+         * @brief Same as get_regression with thresholds list, but use compiled thresholds, see image::LABThresholds.
+         * @maixcdk maix.image.Image.get_regression
+        */
+        std::vector<image::Line> get_regression(const image::LABThresholds &thresholds, bool invert = false, std::vector<int> roi = std::vector<int>(), int x_stride = 2, int y_stride = 1, int area_threshold = 10, int pixels_threshold = 10, bool robust = false);
+
         //************************** image with filesystem **************************//
         /**
          * Save image to file
@@ -1297,6 +1322,13 @@ namespace maix::image
          */
         std::vector<image::Blob> find_blobs(std::vector<std::vector<int>> thresholds = std::vector<std::vector<int>>(), bool invert = false, std::vector<int> roi = std::vector<int>(), int x_stride = 2, int y_stride = 1, int area_threshold = 10, int pixels_threshold = 10, bool merge = false, int margin = 0, int x_hist_bins_max = 0, int y_hist_bins_max = 0);
 
+        /**
+         * Same as find_blobs with thresholds list, but use compiled thresholds, see image::LABThresholds.
+         * Compile thresholds once and reuse it to skip LAB conversion of every pixel.
+         * @maixcdk maix.image.Image.find_blobs
+         */
+        std::vector<image::Blob> find_blobs(const image::LABThresholds &thresholds, bool invert = false, std::vector<int> roi = std::vector<int>(), int x_stride = 2, int y_stride = 1, int area_threshold = 10, int pixels_threshold = 10, bool merge = false, int margin = 0, int x_hist_bins_max = 0, int y_hist_bins_max = 0);
+
         /**
          * Find lines in image
          *
@@ -1532,6 +1564,25 @@ namespace maix::image
         }
 
     private:
+        // release callback owned by the image it set to, copy of image get empty one, so data is not given back twice
+        class _ReleaseCb
+        {
+        public:
+            _ReleaseCb() {}
+            _ReleaseCb(const _ReleaseCb &) {}
+            _ReleaseCb &operator=(const _ReleaseCb &) { return *this; }
+            _ReleaseCb &operator=(std::function<void()> cb)
+            {
+                _cb = std::move(cb);
+                return *this;
+            }
+            explicit operator bool() const { return (bool)_cb; }
+            void operator()() { _cb(); }
+
+        private:
+            std::function<void()> _cb;
+        };
+
         void *_actual_data;
         void *_data;
         int _width;
@@ -1539,6 +1590,7 @@ namespace maix::image
         int _data_size;
         Format _format;
         bool _is_malloc;
+        _ReleaseCb _release_cb;
 
         int _get_cv_pixel_num(image::Format &format);
         std::vector<int> _get_available_roi(std::vector<int> roi, std::vector<int> other_roi = std::vector<int>());
@@ -1602,4 +1654,35 @@ namespace maix::image
      * @maixpy maix.image.string_size
      */
     image::Size string_size(std::string string, float scale = 1, int thickness = 1, const std::string &font = "");
+
+    /**
+     * Set default size of image algorithm memory arena.\n
+     * Every thread has its own arena(used by find_blobs, find_lines etc.), created on first use,
+     * this size is used by arenas created later, arenas already created are not affected.
+     * @param size arena size in bytes, default 1MB.
+     * @maixpy maix.image.set_arena_default_size
+     */
+    void set_arena_default_size(int size);
+
+    /**
+     * Resize image algorithm memory arena of current thread, data in arena will be discarded,
+     * so don't call this when image algorithm is running in current thread.
+     * @param size arena size in bytes.
+     * @maixpy maix.image.set_arena_size
+     */
+    void set_arena_size(int size);
+
+    /**
+     * Get image algorithm memory arena usage of current thread,
+     * you can use peak to decide arena size by set_arena_size.
+     * @return dict type, keys: size(arena size), used(bytes in use now), peak(max used bytes).
+     * @maixpy maix.image.arena_stats
+     */
+    std::map<std::string, int> arena_stats();
+
+    /**
+     * Reset peak usage of image algorithm memory arena of current thread to current used bytes.
+     * @maixpy maix.image.reset_arena_peak
+     */
+    void reset_arena_peak();
 } // namespace maix::image
@@ -0,0 +1,128 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add precompiled LAB thresholds, create this file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <memory>
+
+namespace maix::image
+{
+    /**
+     * Compiled LAB color thresholds.\n
+     * Every threshold is evaluated once for all 65536 RGB565 colors and stored as a membership bitmap(8KB),
+     * then testing a RGB565 or RGB888 pixel is one table lookup instead of LAB conversion and six compares,
+     * result is exactly the same as LAB thresholds, because RGB888 pixels are also converted to LAB through RGB565.\n
+     * Image::find_blobs, Image::binary and Image::get_regression compile thresholds and cache the recent ones automatically,
+     * create this object once and pass it to them explicitly to skip the compile and cache lookup.
+     * @maixcdk maix.image.LABThresholds
+     */
+    class LABThresholds
+    {
+    public:
+        /**
+         * Compile thresholds.
+         * @param thresholds same as thresholds of Image::find_blobs, {{Lmin, Lmax, Amin, Amax, Bmin, Bmax}, ...},
+         * missing values use full range, empty threshold is ignored.
+         * @maixcdk maix.image.LABThresholds.LABThresholds
+         */
+        explicit LABThresholds(const std::vector<std::vector<int>> &thresholds);
+
+        /**
+         * Get compiled thresholds from cache, compile and add to cache if not found.
+         * Cache keeps the recent 8 thresholds, and it's thread safe.
+         * @param thresholds LAB thresholds.
+         * @return compiled thresholds.
+         * @maixcdk maix.image.LABThresholds.get
+         */
+        static std::shared_ptr<LABThresholds> get(const std::vector<std::vector<int>> &thresholds);
+
+        /**
+         * Original thresholds.
+         * @maixcdk maix.image.LABThresholds.thresholds
+         */
+        const std::vector<std::vector<int>> &thresholds() const { return _thresholds; }
+
+        /**
+         * Number of compiled thresholds(empty thresholds are not counted).
+         * @maixcdk maix.image.LABThresholds.size
+         */
+        int size() const { return (int)_bounds.size() / 6; }
+
+        /**
+         * Clamped and ordered bounds of one threshold.
+         * @param idx threshold index.
+         * @return 6 values, Lmin, Lmax, Amin, Amax, Bmin, Bmax.
+         * @maixcdk maix.image.LABThresholds.bounds
+         */
+        const int *bounds(int idx) const { return &_bounds[idx * 6]; }
+
+        /**
+         * Membership bitmap of one threshold, bit (rgb565 & 7) of byte (rgb565 >> 3) is 1 if the color is in threshold.
+         * @param idx threshold index.
+         * @maixcdk maix.image.LABThresholds.bitmap
+         */
+        const uint8_t *bitmap(int idx) const { return &_lut[(size_t)idx * 8192]; }
+
+        /**
+         * Membership bitmap of Image::binary, color is in at least one threshold when invert is false,
+         * or out of at least one threshold when invert is true.
+         * @maixcdk maix.image.LABThresholds.binary_bitmap
+         */
+        const uint8_t *binary_bitmap(bool invert) const { return &_binary[invert ? 8192 : 0]; }
+
+        /**
+         * Is RGB565 color in threshold.
+         * @param idx threshold index.
+         * @param rgb565 RGB565 color.
+         * @maixcdk maix.image.LABThresholds.match
+         */
+        bool match(int idx, uint16_t rgb565) const { return (bitmap(idx)[rgb565 >> 3] >> (rgb565 & 7)) & 1; }
+
+        /**
+         * Get thresholds RGB565 color is in.
+         * @param rgb565 RGB565 color.
+         * @return bit i is 1 if color is in threshold i, only the first 32 thresholds.
+         * @maixcdk maix.image.LABThresholds.mask
+         */
+        uint32_t mask(uint16_t rgb565) const;
+
+        /**
+         * Classify one row of RGB888 pixels with binary_bitmap.
+         * Packs pixels to RGB565 keys with NEON, RVV or AVX2 kernels according to compile target, RVV also gathers bits with indexed load.
+         * @param rgb RGB888 pixels.
+         * @param out [out] 1 or 0 of every pixel.
+         * @param n pixel number.
+         * @param invert same as invert of Image::binary.
+         * @maixcdk maix.image.LABThresholds.classify_rgb888
+         */
+        void classify_rgb888(const uint8_t *rgb, uint8_t *out, int n, bool invert) const;
+
+        /**
+         * Classify one row of RGB565 pixels with binary_bitmap.
+         * @param rgb565 RGB565 pixels.
+         * @param out [out] 1 or 0 of every pixel.
+         * @param n pixel number.
+         * @param invert same as invert of Image::binary.
+         * @maixcdk maix.image.LABThresholds.classify_rgb565
+         */
+        void classify_rgb565(const uint16_t *rgb565, uint8_t *out, int n, bool invert) const;
+
+        /**
+         * SIMD kernel name used by classify_rgb888, "neon", "rvv", "avx2" or "scalar".
+         * @maixcdk maix.image.LABThresholds.simd
+         */
+        static const char *simd();
+
+    private:
+        std::vector<std::vector<int>> _thresholds;
+        std::vector<int> _bounds;
+        std::vector<uint8_t> _lut;      // 8192 bytes every threshold
+        std::vector<uint8_t> _binary;   // any in(invert false), any out(invert true)
+    };
+}
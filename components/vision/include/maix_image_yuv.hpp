@@ -0,0 +1,161 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add fixed-point YUV to RGB conversion, create this file.
+ * @update 2026.10.18: Add native planar YUV resize, fill and NN preprocess.
+ */
+
+#pragma once
+
+#include "maix_image_def.hpp"
+#include "maix_err.hpp"
+#include <stdint.h>
+
+namespace maix::image
+{
+    /**
+     * YUV memory layout
+     */
+    enum YUVLayout
+    {
+        YUV_YUYV = 0,   // YUYVYUYV..., packed 4:2:2, V4L2_PIX_FMT_YUYV
+        YUV_UYVY,       // UYVYUYVY..., packed 4:2:2, V4L2_PIX_FMT_UYVY
+        YUV_NV12,       // YYY...UVUV..., 4:2:0, image::FMT_YUV420SP
+        YUV_NV21,       // YYY...VUVU..., 4:2:0, image::FMT_YVU420SP
+        YUV_NV16,       // YYY...UVUV..., 4:2:2, image::FMT_YUV422SP
+        YUV_I420,       // YYY...UUU...VVV, 4:2:0, image::FMT_YUV420P
+        YUV_YV12,       // YYY...VVV...UUU, 4:2:0, image::FMT_YVU420P
+        YUV_I422,       // YYY...UUU...VVV, 4:2:2, image::FMT_YUV422P
+    };
+
+    /**
+     * YUV color matrix
+     */
+    enum YUVMatrix
+    {
+        YUV_BT601 = 0,
+        YUV_BT709,
+    };
+
+    /**
+     * YUV value range
+     */
+    enum YUVRange
+    {
+        YUV_RANGE_LIMITED = 0,  // Y [16, 235], UV [16, 240]
+        YUV_RANGE_FULL,         // Y UV [0, 255]
+    };
+
+    /**
+     * Get YUV layout of image format
+     * @param format image format
+     * @param layout [out] YUV layout
+     * @return true if format is a YUV format, else false
+     */
+    bool yuv_layout(image::Format format, YUVLayout &layout);
+
+    /**
+     * Convert YUV image to RGB888, BGR888, RGBA8888, BGRA8888 or GRAYSCALE.\n
+     * Use integer fixed-point coefficients, and NEON, RVV, AVX2 or SSE2 kernels according to compile target,
+     * GRAYSCALE output is Y channel, same as OpenCV.
+     * @param layout src YUV layout
+     * @param src src data, width * height image without row padding
+     * @param width image width
+     * @param height image height
+     * @param dst_format dst format, RGB888, BGR888, RGBA8888, BGRA8888 or GRAYSCALE
+     * @param dst dst buffer, at least width * height * image::fmt_size[dst_format] bytes
+     * @param matrix color matrix, default BT709
+     * @param range src value range, default limited range
+     * @param simd use SIMD kernels if compiled in, false to force scalar kernels, for test and benchmark
+     * @return err::ERR_NONE if success, err::ERR_ARGS if args error
+     */
+    err::Err convert_yuv(YUVLayout layout, const uint8_t *src, int width, int height, image::Format dst_format, uint8_t *dst,
+                         YUVMatrix matrix = YUV_BT709, YUVRange range = YUV_RANGE_LIMITED, bool simd = true);
+
+    /**
+     * Name of SIMD kernels compiled in convert_yuv
+     * @return "neon", "rvv", "avx2", "sse2" or "scalar"
+     */
+    const char *convert_yuv_simd();
+
+    /**
+     * Resize rect of planar or semi-planar YUV image to rect of another image with same layout.\n
+     * Work directly on Y plane and interleaved UV(or U and V) planes, no RGB round trip,
+     * if src and dst rect have same size, it's a crop(rows copy).\n
+     * For 4:2:0 layouts, rect x, y, w, h of dst should be even, odd src rect is aligned to chroma grid.
+     * @param layout YUV layout, NV12, NV21, NV16, I420, YV12 or I422, packed YUYV and UYVY not support
+     * @param src src data, src_w * src_h image without row padding
+     * @param src_w src image width
+     * @param src_h src image height
+     * @param sx src rect x
+     * @param sy src rect y
+     * @param sw src rect width
+     * @param sh src rect height
+     * @param dst dst data, dst_w * dst_h image without row padding, same layout as src
+     * @param dst_w dst image width
+     * @param dst_h dst image height
+     * @param dx dst rect x
+     * @param dy dst rect y
+     * @param dw dst rect width
+     * @param dh dst rect height
+     * @param method image::NEAREST or image::BILINEAR, other methods use BILINEAR
+     * @return err::ERR_NONE if success, err::ERR_ARGS if args error
+     */
+    err::Err resize_yuv(YUVLayout layout, const uint8_t *src, int src_w, int src_h, int sx, int sy, int sw, int sh,
+                        uint8_t *dst, int dst_w, int dst_h, int dx, int dy, int dw, int dh,
+                        image::ResizeMethod method = image::BILINEAR);
+
+    /**
+     * Fill rect of planar or semi-planar YUV image with one color.
+     * @param layout YUV layout, NV12, NV21, NV16, I420, YV12 or I422
+     * @param dst image data, width * height image without row padding
+     * @param width image width
+     * @param height image height
+     * @param x rect x
+     * @param y rect y
+     * @param w rect width
+     * @param h rect height
+     * @param y_val Y value, default 0, Y 0 and UV 128 is black for both limited and full range
+     * @param u_val U value, default 128
+     * @param v_val V value, default 128
+     * @return err::ERR_NONE if success, err::ERR_ARGS if args error
+     */
+    err::Err fill_yuv(YUVLayout layout, uint8_t *dst, int width, int height, int x, int y, int w, int h,
+                      uint8_t y_val = 0, uint8_t u_val = 128, uint8_t v_val = 128);
+
+    /**
+     * NN preprocess in one pass: crop rect of YUV image, resize(with object fit), letterbox, convert to RGB/BGR/GRAY,
+     * and write HWC or CHW, uint8 or float(value = (pixel - mean) * scale) tensor data.\n
+     * Only output size rows of Y and chroma are sampled, src frame is never converted to RGB.
+     * @param layout YUV layout, NV12, NV21, NV16, I420, YV12 or I422
+     * @param src src data, width * height image without row padding
+     * @param width src image width
+     * @param height src image height
+     * @param x crop rect x, use 0, 0, width, height for whole image
+     * @param y crop rect y
+     * @param w crop rect width
+     * @param h crop rect height
+     * @param dst dst data, dst_w * dst_h * channels elements, uint8_t or float
+     * @param dst_w dst width
+     * @param dst_h dst height
+     * @param dst_format image::FMT_RGB888, image::FMT_BGR888 or image::FMT_GRAYSCALE, decide channels and order
+     * @param chw true to write CHW(planar), false to write HWC(interleaved)
+     * @param to_float true to write float, else write uint8_t and mean scale are ignored
+     * @param mean mean of every dst channel, nullptr means 0
+     * @param scale scale of every dst channel, nullptr means 1
+     * @param fit image::FIT_FILL, image::FIT_CONTAIN(letterbox) or image::FIT_COVER
+     * @param method image::NEAREST or image::BILINEAR, other methods use BILINEAR
+     * @param pad letterbox pixel value of every channel, before mean and scale
+     * @param matrix color matrix, default BT601, same as image::Image::to_format
+     * @param range src value range, default limited range
+     * @param content [out] if not nullptr, 4 int x, y, w, h of image content in dst, used to map results back
+     * @return err::ERR_NONE if success, err::ERR_ARGS if args error
+     */
+    err::Err preprocess_yuv(YUVLayout layout, const uint8_t *src, int width, int height, int x, int y, int w, int h,
+                            void *dst, int dst_w, int dst_h, image::Format dst_format, bool chw, bool to_float,
+                            const float *mean = nullptr, const float *scale = nullptr,
+                            image::Fit fit = image::FIT_CONTAIN, image::ResizeMethod method = image::BILINEAR, uint8_t pad = 0,
+                            YUVMatrix matrix = YUV_BT601, YUVRange range = YUV_RANGE_LIMITED, int *content = nullptr);
+
+} // namespace maix::image
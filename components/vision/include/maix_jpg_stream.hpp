@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: One epoll event loop for all clients, frames shared by all clients.
  */
 
 #ifndef __MAIX_JPG_STREAM_HPP
@@ -18,7 +19,9 @@
 namespace maix::http
 {
     /**
-     * JpegStreamer class
+     * JpegStreamer class, MJPEG over HTTP server.
+     * All clients are served by one event loop thread, every frame is encoded once and shared by all clients,
+     * a slow client skips frames instead of blocking other clients or write.
      * @maixpy maix.http.JpegStreamer
      */
     class JpegStreamer
@@ -29,7 +32,7 @@ namespace maix::http
          * @note You can get the picture stream through http://host:port/stream, you can also get it through http://ip:port, and you can add personal style through set_html() at this time
          * @param host http host
          * @param port http port, default is 8000
-         * @param client_number the max number of client
+         * @param client_number the max number of client, more clients are rejected with 503
          * @maixpy maix.http.JpegStreamer.__init__
          * @maixcdk maix.http.JpegStreamer.JpegStreamer
          */
@@ -52,6 +55,7 @@ namespace maix::http
 
         /**
          * @brief Write data to http
+         * @note Image is encoded to jpeg only when there are stream clients, and new clients get the latest frame first.
          * @param img image object
          * @return error code, err::ERR_NONE means success, others means failed
          * @maixpy maix.http.JpegStreamer.write
@@ -90,9 +94,17 @@ namespace maix::http
         int port() {
             return _port;
         }
+
+        /**
+         * Get number of clients receiving stream
+         * @return clients number
+         * @maixpy maix.http.JpegStreamer.clients
+        */
+        int clients();
     private:
         std::string _host;
         int _port;
+        void *_priv;
     };
 } // namespace maix::http
 
@@ -1,76 +1,142 @@
-#pragma once
-
-#include "ByteTrack/STrack.h"
-#include "ByteTrack/lapjv.h"
-#include "ByteTrack/Object.h"
-
-#include <cstddef>
-#include <limits>
-#include <map>
-#include <memory>
-#include <vector>
-
-namespace byte_track
-{
-class BYTETracker
-{
-public:
-    using STrackPtr = std::shared_ptr<STrack>;
-
-    BYTETracker(const int& max_lost_buff_num = 60,
-                const float& track_thresh = 0.5,
-                const float& high_thresh = 0.6,
-                const float& match_thresh = 0.8,
-                const int& max_history = 20);
-    ~BYTETracker();
-
-    std::vector<STrackPtr> update(const std::vector<Object>& objects);
-
-private:
-    std::vector<STrackPtr> jointStracks(const std::vector<STrackPtr> &a_tlist,
-                                        const std::vector<STrackPtr> &b_tlist) const;
-
-    std::vector<STrackPtr> subStracks(const std::vector<STrackPtr> &a_tlist,
-                                      const std::vector<STrackPtr> &b_tlist) const;
-
-    void removeDuplicateStracks(const std::vector<STrackPtr> &a_stracks,
-                                const std::vector<STrackPtr> &b_stracks,
-                                std::vector<STrackPtr> &a_res,
-                                std::vector<STrackPtr> &b_res) const;
-
-    void linearAssignment(const std::vector<std::vector<float>> &cost_matrix,
-                          const int &cost_matrix_size,
-                          const int &cost_matrix_size_size,
-                          const float &thresh,
-                          std::vector<std::vector<int>> &matches,
-                          std::vector<int> &b_unmatched,
-                          std::vector<int> &a_unmatched) const;
-
-    std::vector<std::vector<float>> calcIouDistance(const std::vector<STrackPtr> &a_tracks,
-                                                    const std::vector<STrackPtr> &b_tracks) const;
-
-    std::vector<std::vector<float>> calcIous(const std::vector<Rect<float>> &a_rect,
-                                             const std::vector<Rect<float>> &b_rect) const;
-
-    double execLapjv(const std::vector<std::vector<float> > &cost,
-                     std::vector<int> &rowsol,
-                     std::vector<int> &colsol,
-                     bool extend_cost = false,
-                     float cost_limit = std::numeric_limits<float>::max(),
-                     bool return_cost = true) const;
-
-private:
-    const float track_thresh_;
-    const float high_thresh_;
-    const float match_thresh_;
-    const int max_history_;
-    const size_t max_time_lost_;
-
-    size_t frame_id_;
-    size_t track_id_count_;
-
-    std::vector<STrackPtr> tracked_stracks_;
-    std::vector<STrackPtr> lost_stracks_;
-    std::vector<STrackPtr> removed_stracks_;
-};
-}
\ No newline at end of file
+#pragma once
+
+#include "ByteTrack/Object.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace byte_track
+{
+enum class STrackState {
+    New = 0,
+    Tracked = 1,
+    Lost = 2,
+    Removed = 3,
+};
+
+/**
+ * ByteTrack tracker.
+ * Tracks live in a pool of slots with struct of arrays state, slots and all per frame buffers are reused,
+ * no heap allocation per frame once pool and buffers grew to the max object number.
+ * Kalman filter state is 4 independent (position, velocity) pairs, so covariance is 4 2x2 blocks instead of 8x8 matrix,
+ * result is same as the full matrix filter with diagonal noise.
+ * Association only computes IoU of overlapped boxes(sweep on sorted x), and solves assignment on every
+ * connected component of the sparse cost graph, large components fall back to greedy to bound latency.
+ */
+class BYTETracker
+{
+public:
+    BYTETracker(const int& max_lost_buff_num = 60,
+                const float& track_thresh = 0.5,
+                const float& high_thresh = 0.6,
+                const float& match_thresh = 0.8,
+                const int& max_history = 20);
+    ~BYTETracker();
+
+    /**
+     * Update tracks with detections of one frame.
+     * @return slot of output tracks, tracked tracks first, then lost tracks, valid until next update.
+     */
+    const std::vector<int> &update(const std::vector<Object>& objects);
+
+    // track attributes of slot returned by update
+    size_t getTrackId(int slot) const { return track_id_[slot]; }
+    float getScore(int slot) const { return score_[slot]; }
+    bool getLost(int slot) const { return lost_[slot] != 0; }
+    size_t getFrameId(int slot) const { return frame_id_[slot]; }
+    size_t getStartFrameId(int slot) const { return start_frame_id_[slot]; }
+    STrackState getSTrackState(int slot) const { return (STrackState)state_[slot]; }
+
+    /**
+     * Track position history, oldest first.
+     * @param slot track slot.
+     * @param idx index in history, [0, getHistorySize(slot)).
+     */
+    int getHistorySize(int slot) const { return hist_count_[slot]; }
+    const Object &getHistory(int slot, int idx) const
+    {
+        return history_[(size_t)slot * max_history_ + (hist_head_[slot] + idx) % max_history_];
+    }
+
+private:
+    struct Edge
+    {
+        int row;
+        int col;
+        float cost;
+    };
+
+    // track pool
+    int allocSlot();
+    void freeSlot(int slot);
+    void initiate(int slot, const float *rect, float score, int label);
+    void predict(const std::vector<int> &slots);
+    void update(int slot, const float *rect, float score, size_t frame_id);
+    void updateRect(int slot);
+
+    // association
+    void linearAssignment(const std::vector<int> &tracks, const float *b_rects, const int *b_idx, int b_num, const float &thresh,
+                          std::vector<std::pair<int, int>> &matches,
+                          std::vector<int> &a_unmatched,
+                          std::vector<int> &b_unmatched);
+    void calcEdges(const std::vector<int> &tracks, const float *b_rects, const int *b_idx, int b_num, float thresh);
+    void solveComponent(int begin, int end, float thresh);
+    void removeDuplicateStracks();
+
+private:
+    const float track_thresh_;
+    const float high_thresh_;
+    const float match_thresh_;
+    const int max_history_;
+    const size_t max_time_lost_;
+
+    size_t frame_count_;
+    size_t track_id_count_;
+
+    // pool, struct of arrays, index is slot
+    // Kalman mean: cx, cy, aspect ratio, height, then their velocity
+    std::vector<float> mean_[8];
+    // Kalman covariance of every (value, velocity) pair: var(value), cov, var(velocity)
+    std::vector<float> cov_[12];
+    std::vector<float> rect_[4]; // x, y, w, h of last update
+    std::vector<uint8_t> state_;
+    std::vector<uint8_t> activated_;
+    std::vector<uint8_t> lost_;
+    std::vector<float> score_;
+    std::vector<int> label_;
+    std::vector<size_t> track_id_;
+    std::vector<size_t> frame_id_;
+    std::vector<size_t> start_frame_id_;
+    std::vector<Object> history_;       // ring buffer of every slot, max_history_ items
+    std::vector<int> hist_head_;
+    std::vector<int> hist_count_;
+    std::vector<int> free_slots_;
+
+    std::vector<int> tracked_stracks_;
+    std::vector<int> lost_stracks_;
+
+    // per frame buffers, reused
+    std::vector<float> det_rects_;      // x, y, w, h of every detection
+    std::vector<int> det_high_, det_low_, remain_det_;
+    std::vector<int> active_, non_active_, pool_;
+    std::vector<int> current_tracked_, refind_, remain_tracked_, current_lost_, removed_;
+    std::vector<int> tmp_tracks_, tmp_idx_;
+    std::vector<float> tmp_rects_;
+    std::vector<int> output_;
+    std::vector<std::pair<int, int>> matches_;
+    std::vector<int> unmatch_a_, unmatch_b_;
+    std::vector<uint8_t> in_tracked_, drop_;
+
+    // assignment buffers
+    std::vector<int> order_;            // detections sorted by x
+    std::vector<Edge> edges_;
+    std::vector<int> parent_;           // union find of rows and cols
+    std::vector<int> comp_start_, comp_edges_;
+    std::vector<int> row_match_, col_match_;
+    std::vector<int> comp_rows_, comp_cols_, local_id_;
+    std::vector<double> cost_, u_, v_, minv_;
+    std::vector<int> p_, way_;
+    std::vector<uint8_t> used_;
+};
+}
@@ -13,5 +13,6 @@ namespace maix::image
     */
     extern void convert_to_imlib_image(image::Image *image, image_t *imlib_image);
     extern void _convert_to_lab_thresholds(std::vector<std::vector<int>> &in, list_t *out);
+    extern void _convert_to_lab_thresholds(const LABThresholds &in, list_t *out);
 }
 
@@ -26,9 +26,12 @@
 #include <assert.h>
 #include <sys/mman.h>
 #include <poll.h>
+#include <mutex>
+#include <memory>
 #include "maix_err.hpp"
 #include "maix_log.hpp"
 #include "maix_image.hpp"
+#include "maix_image_yuv.hpp"
 
 #ifndef V4L2_PIX_FMT_RGBA32
 #define V4L2_PIX_FMT_RGBA32 v4l2_fourcc('R', 'G', 'B', 'A') /* 32  RGBA-8-8-8-8    */
@@ -49,15 +52,54 @@ namespace maix::camera
         return r;
     }
 
+    static bool v4l2_yuv_layout(uint32_t raw_format, image::YUVLayout &layout)
+    {
+        switch (raw_format)
+        {
+        case V4L2_PIX_FMT_YUYV:
+            layout = image::YUV_YUYV;
+            return true;
+        case V4L2_PIX_FMT_UYVY:
+            layout = image::YUV_UYVY;
+            return true;
+        case V4L2_PIX_FMT_NV12:
+            layout = image::YUV_NV12;
+            return true;
+        case V4L2_PIX_FMT_NV21:
+            layout = image::YUV_NV21;
+            return true;
+        case V4L2_PIX_FMT_YUV420:
+            layout = image::YUV_I420;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool is_v4l2_jpeg(uint32_t raw_format)
+    {
+        return raw_format == V4L2_PIX_FMT_MJPEG || raw_format == V4L2_PIX_FMT_JPEG;
+    }
+
     static int choose_format(int target, const std::vector<uint32_t> &formats)
     {
-        int final = 0;
+        int final = -1;
+        int jpeg = -1;
+        image::YUVLayout layout;
         if (!(target == image::FMT_RGB888 || target == image::FMT_RGBA8888 ||
-              target == image::FMT_BGR888 || target == image::FMT_BGRA8888))
+              target == image::FMT_BGR888 || target == image::FMT_BGRA8888 || target == image::FMT_JPEG))
             throw std::runtime_error("format not support");
 
-        for (size_t i = 1; i < formats.size(); i++)
+        for (size_t i = 0; i < formats.size(); i++)
         {
+            if (is_v4l2_jpeg(formats[i]))
+            {
+                if (jpeg < 0)
+                    jpeg = i;
+                continue;
+            }
+            if (target == image::FMT_JPEG)
+                continue;
             if (target == image::FMT_RGB888 && formats[i] == V4L2_PIX_FMT_RGB24)
             {
                 log::debug("raw choose RGB888 mode\n");
@@ -83,6 +125,23 @@ namespace maix::camera
                 //     if(target == image::FMT_YUV422)
                 //         break;
             }
+            else if (final < 0 && v4l2_yuv_layout(formats[i], layout))
+            {
+                log::debug("raw choose YUV format 0x%x\n", formats[i]);
+                final = i;
+            }
+        }
+        // JPEG is passthrough for FMT_JPEG, and decoded only if camera has no other formats
+        if ((target == image::FMT_JPEG || final < 0) && jpeg >= 0)
+        {
+            log::debug("raw choose MJPEG mode\n");
+            final = jpeg;
+        }
+        if (final < 0)
+        {
+            if (target == image::FMT_JPEG)
+                throw std::runtime_error("camera not support MJPEG");
+            final = 0;
         }
         return final;
     }
@@ -90,408 +149,94 @@ namespace maix::camera
     static bool need_convert_format(uint32_t raw_format, int target_format)
     {
         if (!(target_format == image::FMT_RGB888 || target_format == image::FMT_RGBA8888 ||
-              target_format == image::FMT_BGR888 || target_format == image::FMT_BGRA8888))
+              target_format == image::FMT_BGR888 || target_format == image::FMT_BGRA8888 || target_format == image::FMT_JPEG))
             throw std::runtime_error("format not support");
         return !((target_format == image::FMT_RGB888 && raw_format == V4L2_PIX_FMT_RGB24) ||
                  (target_format == image::FMT_RGBA8888 && raw_format == V4L2_PIX_FMT_RGBA32) ||
                  (target_format == image::FMT_BGR888 && raw_format == V4L2_PIX_FMT_BGR24) ||
-                 (target_format == image::FMT_BGRA8888 && raw_format == V4L2_PIX_FMT_BGRA32));
+                 (target_format == image::FMT_BGRA8888 && raw_format == V4L2_PIX_FMT_BGRA32) ||
+                 (target_format == image::FMT_JPEG && is_v4l2_jpeg(raw_format)));
     }
 
-    static void *alloc_buffer(int width, int height, int format)
+    static int convert_format(void *raw_buff, int raw_size, void *buff, uint32_t raw_format, int format, int width, int height,
+                              image::YUVMatrix matrix, image::YUVRange range)
     {
-        if (!(format == image::FMT_RGB888 || format == image::FMT_RGBA8888 ||
-              format == image::FMT_BGR888 || format == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
-        if (format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888)
-            return malloc(width * height * 4);
-        // if (format == image::FMT_YUV422)
-        //     return malloc(width * height * 2);
-        return malloc(width * height * 3);
-    }
+        image::YUVLayout layout;
 
-    static void yuyv422_to_rgb888(void *src, void *dst, int width, int height)
-    {
-        uint8_t *rgb = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
+        if (!(format == image::FMT_RGB888 || format == image::FMT_BGR888 ||
+              format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888))
+            throw std::runtime_error("format not support");
+        if (is_v4l2_jpeg(raw_format))
         {
-            for (int x = 0; x < width;)
+            // decoded size is known after decode, so decode to new image and check before copy
+            image::Image *img = NULL;
+            try
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.79271 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[0] = (uint8_t)r;
-                rgb[1] = (uint8_t)g;
-                rgb[2] = (uint8_t)b;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.79271 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[3] = (uint8_t)r;
-                rgb[4] = (uint8_t)g;
-                rgb[5] = (uint8_t)b;
-                yuyv += 4;
-                rgb += 6;
-                x += 2;
+                image::Image jpg(width, height, image::FMT_JPEG, (uint8_t *)raw_buff, raw_size, false);
+                img = jpg.to_format((image::Format)format);
             }
-        }
-    }
-
-    static void yuyv422_to_bgr888(void *src, void *dst, int width, int height)
-    {
-        uint8_t *rgb = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width;)
+            catch (std::exception &e)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                r = y0 + 1.402 * (v - 128);
-                g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.79271 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[0] = (uint8_t)b;
-                rgb[1] = (uint8_t)g;
-                rgb[2] = (uint8_t)r;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                r = y1 + 1.402 * (v - 128);
-                g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.79271 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.532909 * (v - 128) - 0.213249 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.112402 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgb[3] = (uint8_t)b;
-                rgb[4] = (uint8_t)g;
-                rgb[5] = (uint8_t)r;
-                yuyv += 4;
-                rgb += 6;
-                x += 2;
+                log::error("decode MJPEG frame failed: %s\n", e.what());
+                return EINVAL;
             }
-        }
-    }
-
-    // V4L2_PIX_FMT_YUYV to RGBA8888
-    static void yuyv422_to_rgba8888(void *src, void *dst, int width, int height)
-    {
-        uint8_t *rgba = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width;)
+            if (img->width() != width || img->height() != height)
             {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgba[0] = (uint8_t)r;
-                rgba[1] = (uint8_t)g;
-                rgba[2] = (uint8_t)b;
-                rgba[3] = 255;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-                rgba[4] = (uint8_t)r;
-                rgba[5] = (uint8_t)g;
-                rgba[6] = (uint8_t)b;
-                rgba[7] = 255;
-                yuyv += 4;
-                rgba += 8;
-                x += 2;
+                log::error("MJPEG frame size %dx%d not match %dx%d\n", img->width(), img->height(), width, height);
+                delete img;
+                return EINVAL;
             }
+            memcpy(buff, img->data(), img->data_size());
+            delete img;
+            return 0;
         }
+        if (!v4l2_yuv_layout(raw_format, layout))
+            throw std::runtime_error("raw format not support");
+
+        if (image::convert_yuv(layout, (const uint8_t *)raw_buff, width, height, (image::Format)format, (uint8_t *)buff,
+                               matrix, range) != err::ERR_NONE)
+            return EINVAL;
+        return 0;
     }
 
-    // V4L2_PIX_FMT_YUYV to RGBA8888
-    static void yuyv422_to_bgra8888(void *src, void *dst, int width, int height)
+    static int queue_buffer(int fd, int index)
     {
-        uint8_t *rgba = (uint8_t *)dst;
-        uint8_t *yuyv = (uint8_t *)src;
-        uint8_t y0, u, y1, v;
-        float r, g, b;
-
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width;)
-            {
-                y0 = yuyv[0];
-                u = yuyv[1];
-                y1 = yuyv[2];
-                v = yuyv[3];
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.402 * (v - 128);
-                // g = y0 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y0 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y0 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y0 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y0 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.5748 * (v - 128);
-                // g = y0 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y0 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y0 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y0 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y0 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y0 + 1.4746 * (v - 128)
-                // g = y0 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y0 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-
-                rgba[0] = (uint8_t)b;
-                rgba[1] = (uint8_t)g;
-                rgba[2] = (uint8_t)r;
-                rgba[3] = 255;
-
-                // BT601 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.596 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.813 * (v - 128) - 0.391 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.018 * (u - 128);
-                // BT601 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.402 * (v - 128);
-                // g = y1 - 0.344 * (u - 128) - 0.714 * (v - 128);
-                // b = y1 + 1.772 * (u - 128);
-                // BT709 YUV data is limited range, to RGB[0, 255]
-                r = 1.164384 * (y1 - 16) + 1.793 * (v - 128);
-                g = 1.164384 * (y1 - 16) - 0.534 * (v - 128) - 0.213 * (u - 128);
-                b = 1.164384 * (y1 - 16) + 2.115 * (u - 128);
-                // BT709 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.5748 * (v - 128);
-                // g = y1 - 0.1873 * (u - 128) - 0.4681 * (v - 128);
-                // b = y1 + 1.8556 * (u - 128);
-                // BT2020 YUV data is limited range, to RGB[0, 255]
-                // r = 1.164384 * (y1 - 16) + 1.67867 * (v - 128);
-                // g = 1.164384 * (y1 - 16) - 0.65042 * (v - 128) - 0.187326 * (u - 128);
-                // b = 1.164384 * (y1 - 16) + 2.14177 * (u - 128);
-                // BT2020 YUV data is full range, to RGB[0, 255]
-                // r = y1 + 1.4746 * (v - 128)
-                // g = y1 - 0.164553 * (u - 128) - 0.571353 * (u - 128)
-                // b = y1 + 1.8814 * (u - 128)
-
-                r = r > 255 ? 255 : (r < 0 ? 0 : r);
-                g = g > 255 ? 255 : (g < 0 ? 0 : g);
-                b = b > 255 ? 255 : (b < 0 ? 0 : b);
-
-                rgba[4] = (uint8_t)b;
-                rgba[5] = (uint8_t)g;
-                rgba[6] = (uint8_t)r;
-                rgba[7] = 255;
-                yuyv += 4;
-                rgba += 8;
-                x += 2;
-            }
-        }
+        struct v4l2_buffer buffer;
+        memset(&buffer, 0, sizeof(struct v4l2_buffer));
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = index;
+        return ioctl(fd, VIDIOC_QBUF, &buffer);
     }
 
-    static int convert_format(void *raw_buff, void *buff, uint32_t raw_format, int format, int width, int height)
+    static int dequeue_buffer(int fd, struct v4l2_buffer &buffer)
     {
-        int ret = 0;
-
-        if (!(format == image::FMT_RGB888 || format == image::FMT_BGR888 ||
-              format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888))
-            throw std::runtime_error("format not support");
-        if (raw_format != V4L2_PIX_FMT_YUYV)
-            throw std::runtime_error("raw format not support");
+        memset(&buffer, 0, sizeof(struct v4l2_buffer));
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        return ioctl(fd, VIDIOC_DQBUF, &buffer);
+    }
 
-        if (raw_format == V4L2_PIX_FMT_YUYV)
+    /**
+     * Camera buffers state shared with zero copy images,
+     * image may be deleted in other thread or after camera closed.
+     * Buffers are unmapped when camera closed and all images lent are deleted.
+     */
+    class V4L2Lend
+    {
+    public:
+        ~V4L2Lend()
         {
-            switch (format)
-            {
-            case image::FMT_RGB888:
-                yuyv422_to_rgb888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_BGR888:
-                yuyv422_to_bgr888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_RGBA8888:
-                yuyv422_to_rgba8888(raw_buff, buff, width, height);
-                break;
-            case image::FMT_BGRA8888:
-                yuyv422_to_bgra8888(raw_buff, buff, width, height);
-                break;
-            default:
-                ret = EINVAL;
-                break;
-            }
+            for (size_t i = 0; i < buffers.size(); ++i)
+                munmap(buffers[i], buffers_len[i]);
         }
 
-        return ret;
-    }
+        std::mutex lock;
+        int fd;                    // -1 after camera closed, then buffers will not be queued back
+        std::vector<uint8_t> lent; // buffer is held by image
+        std::vector<void *> buffers;
+        std::vector<int> buffers_len;
+    };
 
     static bool set_regs_flag = false;
 
@@ -511,9 +256,10 @@ namespace maix::camera
                 buffers_len.push_back(0);
             }
             fd = -1;
-            queue_id = -1;
-            buff = NULL;
-            buff_alloc = false;
+            zero_copy = false;
+            drop_old = false;
+            yuv_matrix = image::YUV_BT709;
+            yuv_range = image::YUV_RANGE_LIMITED;
         }
 
         CameraV4L2(const std::string device, int ch, int width, int height, image::Format format, int buff_num)
@@ -548,6 +294,9 @@ namespace maix::camera
             this->width = width > 0 ? width : this->width;
             this->height = height > 0 ? height : this->height;
             this->buffer_num = buff_num;
+            buffers.assign(buff_num, NULL);
+            buffers_len.assign(buff_num, 0);
+            dmabuf_fds.assign(buff_num, -1);
 
             fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK, 0);
             if (fd == -1)
@@ -758,6 +507,9 @@ namespace maix::camera
                            width, height, raw_format, fmt.fmt.pix.width, fmt.fmt.pix.height, fmt.fmt.pix.pixelformat);
                 return err::ERR_ARGS;
             }
+            // YUV encoding reported by driver, BT709 limited range if driver not tell
+            yuv_matrix = fmt.fmt.pix.ycbcr_enc == V4L2_YCBCR_ENC_601 ? image::YUV_BT601 : image::YUV_BT709;
+            yuv_range = fmt.fmt.pix.quantization == V4L2_QUANTIZATION_FULL_RANGE ? image::YUV_RANGE_FULL : image::YUV_RANGE_LIMITED;
 
             // set buffer
             struct v4l2_requestbuffers req = {0};
@@ -814,6 +566,11 @@ namespace maix::camera
                 }
                 log::debug("buffer %d: %p, len: %d, offset: %u\n", i, buffers[i], buffers_len[i], v4l2_buffer.m.offset);
             }
+            lend = std::make_shared<V4L2Lend>();
+            lend->fd = fd;
+            lend->lent.assign(buffer_num, 0);
+            lend->buffers = buffers;
+            lend->buffers_len = buffers_len;
             for (i = 0; i < buffer_num; i++)
             {
                 memset(&v4l2_buffer, 0, sizeof(struct v4l2_buffer));
@@ -843,82 +600,95 @@ namespace maix::camera
         // read
         image::Image *read(void *buff = NULL, size_t buff_size = 0)
         {
-            struct v4l2_buffer v4l2_buf;
-            if (!buff)
-                buff = this->buff;
+            struct v4l2_buffer buffer;
             if (fd < 0)
             {
                 log::error("Camera not open\n");
                 return NULL;
             }
-            //
-            if (queue_id >= 0)
+            if (dequeue(buffer) < 0)
+            {
+                log::error("ERR(%s):VIDIOC_DQBUF failed, dropped frame\n", __func__);
+                return NULL;
+            }
+
+            uint8_t *data = (uint8_t *)buffers[buffer.index];
+            int data_size = format == image::FMT_JPEG ? (int)buffer.bytesused : -1;
+            size_t size = format == image::FMT_JPEG ? buffer.bytesused : width * height * image::fmt_size[format];
+            image::Image *img = NULL;
+            if (buff && buff_size < size)
+            {
+                log::error("buffer size not enough, need %d, but %d\n", (int)size, (int)buff_size);
+            }
+            else if (need_convert_format(raw_format, format))
             {
-                memset(&v4l2_buf, 0, sizeof(struct v4l2_buffer));
-                v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                v4l2_buf.memory = V4L2_MEMORY_MMAP;
-                v4l2_buf.index = queue_id;
-                if (ioctl(fd, VIDIOC_QBUF, &v4l2_buf) < 0)
+                // convert to user buffer or new image directly, no extra copy
+                if (buff)
+                    img = new image::Image(width, height, format, (uint8_t *)buff, -1, false);
+                else
+                    img = new image::Image(width, height, format);
+                if (convert_format(data, buffer.bytesused, img->data(), raw_format, format, width, height, yuv_matrix, yuv_range) != 0)
                 {
-                    log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
-                    queue_id = -1;
-                    return NULL;
+                    delete img;
+                    img = NULL;
                 }
-                queue_id = -1;
+            }
+            else if (buff)
+            {
+                memcpy(buff, data, size);
+                img = new image::Image(width, height, format, (uint8_t *)buff, data_size, false);
+            }
+            else if (zero_copy)
+            {
+                // buffer is queued back when image deleted
+                img = new image::Image(width, height, format, data, data_size, false);
+                lend_buffer(img, buffer.index);
+                return img;
+            }
+            else
+            {
+                img = new image::Image(width, height, format, data, data_size, true);
             }
 
-            struct pollfd poll_fds[1];
-
-            poll_fds[0].fd = fd;
-            poll_fds[0].events = POLLIN; // 等待可读
-
-            poll(poll_fds, 1, 10000);
-
-            struct v4l2_buffer buffer = {0};
-
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_MMAP;
-
-            if (ioctl(fd, VIDIOC_DQBUF, &buffer) < 0)
+            if (queue_buffer(fd, buffer.index) < 0)
             {
-                log::error("ERR(%s):VIDIOC_DQBUF failed, dropped frame\n", __func__);
-                return NULL;
+                log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
             }
+            return img;
+        } // read
+
+        void set_zero_copy(bool enable, bool drop_old)
+        {
+            this->zero_copy = enable;
+            this->drop_old = drop_old;
+        }
 
-            if (need_convert_format(raw_format, format))
+        int dmabuf_fd(void *data)
+        {
+            if (fd < 0)
+                return -1;
+            for (int i = 0; i < (int)buffers.size(); ++i)
             {
-                if (!buff)
+                if (buffers[i] != data)
+                    continue;
+                if (dmabuf_fds[i] < 0)
                 {
-                    buff = alloc_buffer(width, height, format);
-                    if (!buff)
+                    struct v4l2_exportbuffer expbuf;
+                    memset(&expbuf, 0, sizeof(expbuf));
+                    expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                    expbuf.index = i;
+                    expbuf.flags = O_RDONLY | O_CLOEXEC;
+                    if (xioctl(fd, VIDIOC_EXPBUF, &expbuf) < 0)
                     {
-                        log::error("alloc buffer failed\n");
-                        return NULL;
+                        log::warn("VIDIOC_EXPBUF failed, driver may not support DMABUF export, errno: %d\n", errno);
+                        return -1;
                     }
-                    this->buff = buff;
-                    buff_alloc = true;
+                    dmabuf_fds[i] = expbuf.fd;
                 }
-                convert_format(buffers[buffer.index], buff, raw_format, format, width, height);
-
-                // release buffer
-                memset(&v4l2_buf, 0, sizeof(struct v4l2_buffer));
-                v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                v4l2_buf.memory = V4L2_MEMORY_MMAP;
-                v4l2_buf.index = buffer.index;
-
-                if (ioctl(fd, VIDIOC_QBUF, &v4l2_buf) < 0)
-                {
-                    log::error("ERR(%s):VIDIOC_QBUF 2 failed\n", __func__);
-                    return NULL;
-                }
-                return new image::Image(width, height, format, (uint8_t *)buff, -1, true);
+                return dmabuf_fds[i];
             }
-            else
-            {
-                queue_id = buffer.index;
-                return new image::Image(width, height, format, (uint8_t *)buffers[buffer.index], -1, true);
-            }
-        } // read
+            return -1;
+        }
 
         void close()
         {
@@ -930,16 +700,29 @@ namespace maix::camera
                     log::error("ERR(%s):VIDIOC_STREAMOFF failed\n", __func__);
                     return;
                 }
+                if (lend)
+                {
+                    std::lock_guard<std::mutex> guard(lend->lock);
+                    int lent_num = 0;
+                    for (uint8_t lent : lend->lent)
+                        lent_num += lent;
+                    if (lent_num > 0)
+                        log::warn("%d zero copy images not deleted before camera close, camera buffers are kept until they deleted\n", lent_num);
+                    lend->fd = -1;
+                }
+                // buffers are unmapped by the last owner of lend
+                lend = nullptr;
+                for (int i = 0; i < (int)dmabuf_fds.size(); ++i)
+                {
+                    if (dmabuf_fds[i] >= 0)
+                        ::close(dmabuf_fds[i]);
+                    dmabuf_fds[i] = -1;
+                }
                 for (int i = 0; i < buffer_num; ++i)
-                    munmap(buffers[i], buffers_len[i]);
+                    buffers[i] = NULL;
                 ::close(fd);
                 fd = -1;
             }
-            if (buff_alloc)
-            {
-                free(buff);
-                buff = NULL;
-            }
         }
 
         camera::CameraV4L2 *add_channel(int width, int height, image::Format forma, int buff_num)
@@ -949,24 +732,11 @@ namespace maix::camera
 
         void clear_buff()
         {
-            // VIDIOC_DQBUF all buffer
+            // VIDIOC_DQBUF all filled buffer and VIDIOC_QBUF back
             struct v4l2_buffer buffer;
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_MMAP;
-            while (ioctl(fd, VIDIOC_DQBUF, &buffer) >= 0)
-            {
-                memset(&buffer, 0, sizeof(struct v4l2_buffer));
-                buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                buffer.memory = V4L2_MEMORY_MMAP;
-            }
-            // VIDIOC_QBUF all buffer
-            for (int i = 0; i < buffer_num; ++i)
+            while (dequeue_buffer(fd, buffer) >= 0)
             {
-                memset(&buffer, 0, sizeof(struct v4l2_buffer));
-                buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                buffer.memory = V4L2_MEMORY_MMAP;
-                buffer.index = i;
-                if (ioctl(fd, VIDIOC_QBUF, &buffer) < 0)
+                if (queue_buffer(fd, buffer.index) < 0)
                 {
                     log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
                     return;
@@ -1054,14 +824,60 @@ namespace maix::camera
         image::Format format;
         int fd;
         uint32_t raw_format;
+        image::YUVMatrix yuv_matrix;
+        image::YUVRange yuv_range;
         std::vector<void *> buffers;
         std::vector<int> buffers_len;
         int buffer_num;
-        int queue_id; // user directly used buffer id
+        std::vector<int> dmabuf_fds;
+        std::shared_ptr<V4L2Lend> lend;
+        bool zero_copy;
+        bool drop_old;
         int width;
         int height;
-        void *buff;
-        bool buff_alloc;
+
+        /**
+         * Wait and dequeue one filled buffer, if drop_old, dequeue all filled buffers,
+         * queue older ones back and keep the newest.
+         */
+        int dequeue(struct v4l2_buffer &buffer)
+        {
+            struct pollfd poll_fds[1];
+
+            poll_fds[0].fd = fd;
+            poll_fds[0].events = POLLIN; // 等待可读
+
+            poll(poll_fds, 1, 10000);
+
+            if (dequeue_buffer(fd, buffer) < 0)
+                return -1;
+            if (!drop_old)
+                return 0;
+            // fd is non-blocking, fails when no more filled buffer
+            struct v4l2_buffer newer;
+            while (dequeue_buffer(fd, newer) >= 0)
+            {
+                if (queue_buffer(fd, buffer.index) < 0)
+                    log::error("ERR(%s):VIDIOC_QBUF failed\n", __func__);
+                buffer = newer;
+            }
+            return 0;
+        }
+
+        void lend_buffer(image::Image *img, int index)
+        {
+            std::shared_ptr<V4L2Lend> lend = this->lend;
+            {
+                std::lock_guard<std::mutex> guard(lend->lock);
+                lend->lent[index] = 1;
+            }
+            img->set_release_cb([lend, index]() {
+                std::lock_guard<std::mutex> guard(lend->lock);
+                lend->lent[index] = 0;
+                if (lend->fd >= 0 && queue_buffer(lend->fd, index) < 0)
+                    log::error("queue camera buffer %d back failed\n", index);
+            });
+        }
     };
 
     std::vector<std::string> list_devices()
@@ -1178,6 +994,8 @@ namespace maix::camera
         _buff_num = buff_num;
         _show_colorbar = false;
         _open_set_regs = set_regs_flag;
+        _is_opened = false;
+        _last_read_us = 0;
 
         _fps = (fps == -1) ? 30 : fps;
         if (device ) {
@@ -1222,7 +1040,7 @@ namespace maix::camera
     bool Camera::_check_format(image::Format format) {
         if (format == image::FMT_RGB888 || format == image::FMT_BGR888
         || format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888
-        || format == image::FMT_YVU420SP || format == image::FMT_GRAYSCALE) {
+        || format == image::FMT_YVU420SP || format == image::FMT_GRAYSCALE || format == image::FMT_JPEG) {
             return true;
         } else {
             return false;
@@ -1275,13 +1093,32 @@ namespace maix::camera
                 return err::ERR_ARGS;
         }
 
-        return _impl->open(_width, _height, _format_impl, _buff_num);;
+        err::Err e = _impl->open(_width, _height, _format_impl, _buff_num);
+        _is_opened = e == err::ERR_NONE;
+        return e;
     }
 
     void Camera::close()
     {
         if (this->is_closed())
             return;
+        _impl->close();
+        _is_opened = false;
+    }
+
+    err::Err Camera::set_zero_copy(bool enable, bool drop_old)
+    {
+        if (_impl == NULL)
+            return err::ERR_NOT_INIT;
+        _impl->set_zero_copy(enable, drop_old);
+        return err::ERR_NONE;
+    }
+
+    int Camera::get_dmabuf_fd(image::Image &img)
+    {
+        if (_impl == NULL)
+            return -1;
+        return _impl->dmabuf_fd(img.data());
     }
 
     camera::Camera *Camera::add_channel(int width, int height, image::Format format, double fps, int buff_num, bool open)
@@ -1298,7 +1135,7 @@ namespace maix::camera
     {
         (void)block_ms;
         if (!this->is_opened()) {
-            err::Err e = open(_width, _height, _format, _buff_num);
+            err::Err e = open(_width, _height, _format, _fps, _buff_num);
             err::check_raise(e, "open camera failed");
         }
 
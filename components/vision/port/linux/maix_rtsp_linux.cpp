@@ -3,97 +3,1545 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Implement a software RTSP server with one epoll event loop, RTP over UDP and TCP interleaved,
+ *                     H.264/H.265 packetization, shared GOP cache and region overlays composited before encoding.
  */
 
-
 #include "maix_rtsp.hpp"
 #include "maix_err.hpp"
-#include <dirent.h>
-#include <pthread.h>
+#include "maix_basic.hpp"
+#include "maix_video.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <ifaddrs.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define EPOLL_EVENTS_NUM 64
+#define MAX_REQUEST_SIZE 8192
+#define RTP_PAYLOAD_MAX 1400                    // keep RTP packets in one ethernet frame
+#define RTP_PAYLOAD_TYPE 96
+#define RTP_UDP_PORT_BASE 6970
+#define RTCP_INTERVAL_MS 5000
+#define SESSION_TIMEOUT_S 60
+#define GOP_CACHE_MAX 300                       // frames, give up caching if IDR interval is longer
+#define CLIENT_QUEUE_MAX (4 * 1024 * 1024)      // bytes, slow client skips to next key frame if more are queued
+#define REGION_MAX 16
 
 namespace maix::rtsp
 {
+    /**
+     * One access unit packetized to RTP packets, immutable after created, shared by all sessions.
+     * Sequence numbers are allocated when packetized, so a client replaying the GOP cache and then live frames
+     * sees continuous sequence numbers.
+     */
+    class _Frame
+    {
+    public:
+        std::vector<uint8_t> data;          // RTP packets one by one
+        std::vector<uint32_t> offsets;      // start of every packet in data, and data.size() at the end
+        uint32_t timestamp = 0;
+        uint16_t first_seq = 0;
+        bool key = false;
+
+        size_t packets() const
+        {
+            return offsets.size() - 1;
+        }
+
+        const uint8_t *packet(size_t idx) const
+        {
+            return data.data() + offsets[idx];
+        }
+
+        size_t packet_size(size_t idx) const
+        {
+            return offsets[idx + 1] - offsets[idx];
+        }
+    };
+
+    typedef std::shared_ptr<const _Frame> _FramePtr;
+
+    class _Client
+    {
+    public:
+        int fd;
+        std::string in;
+        std::string out;                    // RTSP responses, only sent between two RTP packets over TCP
+        size_t out_pos = 0;
+        bool close_after = false;
+        struct sockaddr_in peer;
+
+        // session
+        std::string session;
+        bool setup = false;
+        bool playing = false;
+        bool tcp = false;
+        int rtp_channel = 0;
+        int rtcp_channel = 1;
+        struct sockaddr_in rtp_addr;
+        struct sockaddr_in rtcp_addr;
+        uint64_t active_ms = 0;
+
+        // frames to send
+        std::deque<_FramePtr> frames;
+        size_t queued = 0;                  // bytes of frames
+        size_t packet_idx = 0;              // packet sending of frames.front()
+        size_t packet_pos = 0;              // sent bytes of packet, include 4 bytes interleaved header
+        bool wait_key = false;
+
+        // sender report
+        uint32_t packet_count = 0;
+        uint32_t octet_count = 0;
+        uint64_t last_sr_ms = 0;
+    };
+
+    static std::string _base64(const std::string &in)
+    {
+        static const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        out.reserve((in.size() + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 2 < in.size(); i += 3)
+        {
+            uint32_t v = ((uint8_t)in[i] << 16) | ((uint8_t)in[i + 1] << 8) | (uint8_t)in[i + 2];
+            out.push_back(table[(v >> 18) & 0x3f]);
+            out.push_back(table[(v >> 12) & 0x3f]);
+            out.push_back(table[(v >> 6) & 0x3f]);
+            out.push_back(table[v & 0x3f]);
+        }
+        if (i < in.size())
+        {
+            uint32_t v = (uint8_t)in[i] << 16;
+            if (i + 1 < in.size())
+                v |= (uint8_t)in[i + 1] << 8;
+            out.push_back(table[(v >> 18) & 0x3f]);
+            out.push_back(table[(v >> 12) & 0x3f]);
+            out.push_back(i + 1 < in.size() ? table[(v >> 6) & 0x3f] : '=');
+            out.push_back('=');
+        }
+        return out;
+    }
+
+    // next NAL unit of annex-b stream from pos, return false if no more
+    static bool _next_nal(const uint8_t *data, size_t size, size_t &pos, const uint8_t **nal, size_t *nal_size)
+    {
+        size_t i = pos;
+        while (i + 3 <= size && !(data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1))
+            ++i;
+        if (i + 3 > size)
+            return false;
+        size_t start = i + 3;
+        size_t end = start;
+        while (end + 3 <= size && !(data[end] == 0 && data[end + 1] == 0 && data[end + 2] == 1))
+            ++end;
+        if (end + 3 > size)
+            end = size;
+        pos = end;
+        while (end > start && data[end - 1] == 0) // trailing zero of next 4 bytes start code
+            --end;
+        *nal = data + start;
+        *nal_size = end - start;
+        return end > start;
+    }
+
+    static std::string _header(const std::string &request, const char *name)
+    {
+        size_t name_len = strlen(name);
+        size_t pos = 0;
+        while ((pos = request.find("\r\n", pos)) != std::string::npos)
+        {
+            pos += 2;
+            if (strncasecmp(request.c_str() + pos, name, name_len) == 0 && request[pos + name_len] == ':')
+            {
+                size_t start = request.find_first_not_of(' ', pos + name_len + 1);
+                size_t end = request.find("\r\n", pos);
+                if (start == std::string::npos || (end != std::string::npos && start > end))
+                    return "";
+                return request.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            }
+        }
+        return "";
+    }
+
+    class _Server
+    {
+    public:
+        int listen_fd = -1;
+        int epoll_fd = -1;
+        int event_fd = -1;
+        int rtp_fd = -1;
+        int rtcp_fd = -1;
+        int rtp_port = 0;
+        bool h265 = false;
+        uint32_t ssrc = 0;
+        std::thread thread;
+        bool running = false;
+        std::atomic<bool> exit{false};
+        std::atomic<int> playing{0};
+
+        // used by push threads
+        std::mutex push_lock;
+        uint16_t seq = 0;
+        std::string vps, sps, pps;
+
+        // shared with push threads
+        std::mutex lock;
+        std::vector<_FramePtr> pending;
+
+        // used only in loop thread
+        std::unordered_map<int, _Client *> clients;
+        std::vector<_FramePtr> gop;
+        uint32_t session_id = 0;
+
+        void notify()
+        {
+            uint64_t v = 1;
+            ssize_t res = ::write(event_fd, &v, sizeof(v));
+            (void)res;
+        }
+
+        static uint32_t timestamp_now()
+        {
+            return (uint32_t)(time::ticks_ms() * 90);
+        }
+
+        /**
+         * Packetize one access unit(annex-b, one frame) and queue it to the loop thread.
+         * Thread safe, called by camera push thread or Rtsp::write.
+         */
+        void push(const uint8_t *data, size_t size)
+        {
+            std::vector<std::pair<const uint8_t *, size_t>> nals;
+            bool key = false, has_params = false;
+            size_t pos = 0;
+            const uint8_t *nal;
+            size_t nal_size;
+            std::lock_guard<std::mutex> guard(push_lock);
+            while (_next_nal(data, size, pos, &nal, &nal_size))
+            {
+                int type = h265 ? (nal[0] >> 1) & 0x3f : nal[0] & 0x1f;
+                if (h265)
+                {
+                    if (type == 35) // AUD
+                        continue;
+                    if (type == 32)
+                        vps.assign((const char *)nal, nal_size);
+                    else if (type == 33)
+                        sps.assign((const char *)nal, nal_size);
+                    else if (type == 34)
+                        pps.assign((const char *)nal, nal_size);
+                    has_params |= type >= 32 && type <= 34;
+                    key |= type >= 16 && type <= 21;
+                }
+                else
+                {
+                    if (type == 9) // AUD
+                        continue;
+                    if (type == 7)
+                        sps.assign((const char *)nal, nal_size);
+                    else if (type == 8)
+                        pps.assign((const char *)nal, nal_size);
+                    has_params |= type == 7 || type == 8;
+                    key |= type == 5;
+                }
+                nals.push_back({nal, nal_size});
+            }
+            if (nals.empty())
+                return;
+            // clients start from key frame, it must carry parameter sets for decoders ignore SDP
+            if (key && !has_params)
+            {
+                std::vector<std::pair<const uint8_t *, size_t>> params;
+                if (h265 && !vps.empty())
+                    params.push_back({(const uint8_t *)vps.data(), vps.size()});
+                if (!sps.empty())
+                    params.push_back({(const uint8_t *)sps.data(), sps.size()});
+                if (!pps.empty())
+                    params.push_back({(const uint8_t *)pps.data(), pps.size()});
+                nals.insert(nals.begin(), params.begin(), params.end());
+            }
+
+            auto frame = std::make_shared<_Frame>();
+            frame->timestamp = timestamp_now();
+            frame->first_seq = seq;
+            frame->key = key;
+            frame->data.reserve(size + (size / RTP_PAYLOAD_MAX + nals.size()) * 16);
+            auto add_packet = [&](bool marker, const uint8_t *head, size_t head_size, const uint8_t *payload, size_t payload_size) {
+                frame->offsets.push_back(frame->data.size());
+                uint8_t rtp[12];
+                rtp[0] = 0x80;
+                rtp[1] = (marker ? 0x80 : 0) | RTP_PAYLOAD_TYPE;
+                rtp[2] = seq >> 8;
+                rtp[3] = seq & 0xff;
+                rtp[4] = frame->timestamp >> 24;
+                rtp[5] = frame->timestamp >> 16;
+                rtp[6] = frame->timestamp >> 8;
+                rtp[7] = frame->timestamp;
+                rtp[8] = ssrc >> 24;
+                rtp[9] = ssrc >> 16;
+                rtp[10] = ssrc >> 8;
+                rtp[11] = ssrc;
+                ++seq;
+                frame->data.insert(frame->data.end(), rtp, rtp + 12);
+                frame->data.insert(frame->data.end(), head, head + head_size);
+                frame->data.insert(frame->data.end(), payload, payload + payload_size);
+            };
+            for (size_t i = 0; i < nals.size(); ++i)
+            {
+                const uint8_t *p = nals[i].first;
+                size_t n = nals[i].second;
+                bool last = i == nals.size() - 1;
+                if (n <= RTP_PAYLOAD_MAX)
+                {
+                    add_packet(last, NULL, 0, p, n);
+                    continue;
+                }
+                // fragmentation unit, FU-A of RFC 6184 or FU of RFC 7798
+                uint8_t head[3];
+                size_t nal_head_size = h265 ? 2 : 1;
+                size_t head_size = nal_head_size + 1;
+                uint8_t type;
+                if (h265)
+                {
+                    type = (p[0] >> 1) & 0x3f;
+                    head[0] = (p[0] & 0x81) | (49 << 1);
+                    head[1] = p[1];
+                }
+                else
+                {
+                    type = p[0] & 0x1f;
+                    head[0] = (p[0] & 0xe0) | 28;
+                }
+                size_t offset = nal_head_size;
+                while (offset < n)
+                {
+                    size_t len = std::min(n - offset, (size_t)RTP_PAYLOAD_MAX - head_size);
+                    bool end = offset + len == n;
+                    head[head_size - 1] = (offset == nal_head_size ? 0x80 : 0) | (end ? 0x40 : 0) | type;
+                    add_packet(last && end, head, head_size, p + offset, len);
+                    offset += len;
+                }
+            }
+            frame->offsets.push_back(frame->data.size());
+            {
+                std::lock_guard<std::mutex> guard2(lock);
+                pending.push_back(std::move(frame));
+            }
+            notify();
+        }
+
+        void loop()
+        {
+            struct epoll_event events[EPOLL_EVENTS_NUM];
+            while (!exit)
+            {
+                int n = epoll_wait(epoll_fd, events, EPOLL_EVENTS_NUM, 1000);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    log::error("epoll_wait failed: %s", strerror(errno));
+                    break;
+                }
+                for (int i = 0; i < n && !exit; ++i)
+                {
+                    int fd = events[i].data.fd;
+                    if (fd == listen_fd)
+                        on_accept();
+                    else if (fd == event_fd)
+                    {
+                        uint64_t v;
+                        ssize_t res = ::read(event_fd, &v, sizeof(v));
+                        (void)res;
+                        on_frames();
+                    }
+                    else if (fd == rtcp_fd)
+                        on_rtcp();
+                    else
+                    {
+                        auto it = clients.find(fd);
+                        if (it == clients.end())
+                            continue;
+                        _Client *c = it->second;
+                        uint32_t ev = events[i].events;
+                        bool ok = !(ev & EPOLLERR);
+                        if (ok && (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+                            ok = on_read(c);
+                        if (ok)
+                            ok = flush(c);
+                        if (!ok)
+                            close_client(c);
+                    }
+                }
+                on_timer();
+            }
+            while (!clients.empty())
+                close_client(clients.begin()->second);
+        }
+
+        void on_accept()
+        {
+            while (1)
+            {
+                struct sockaddr_in addr;
+                socklen_t addr_len = sizeof(addr);
+                int fd = accept4(listen_fd, (struct sockaddr *)&addr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                        log::error("accept failed: %s", strerror(errno));
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                int opt = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+                _Client *c = new _Client();
+                c->fd = fd;
+                c->peer = addr;
+                c->active_ms = time::ticks_ms();
+                struct epoll_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                ev.data.fd = fd;
+                if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+                {
+                    log::error("epoll add client failed: %s", strerror(errno));
+                    ::close(fd);
+                    delete c;
+                    continue;
+                }
+                clients[fd] = c;
+            }
+        }
+
+        void close_client(_Client *c)
+        {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+            ::close(c->fd);
+            clients.erase(c->fd);
+            if (c->playing)
+                --playing;
+            delete c;
+        }
+
+        void enqueue(_Client *c, const _FramePtr &frame)
+        {
+            if (c->wait_key && !frame->key)
+                return;
+            c->wait_key = false;
+            c->frames.push_back(frame);
+            c->queued += frame->data.size();
+            if (c->queued <= CLIENT_QUEUE_MAX || !c->tcp)
+                return;
+            // slow client, keep the frame sending and restart from next key frame, decoder never sees a broken GOP
+            log::warn("rtsp client %s too slow, skip to next key frame", inet_ntoa(c->peer.sin_addr));
+            bool sending = c->packet_idx > 0 || c->packet_pos > 0;
+            while (c->frames.size() > (sending ? 1u : 0u))
+            {
+                c->queued -= c->frames.back()->data.size();
+                c->frames.pop_back();
+            }
+            c->wait_key = true;
+        }
+
+        // new frames pushed, update GOP cache and give them to every playing client
+        void on_frames()
+        {
+            std::vector<_FramePtr> frames;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                frames.swap(pending);
+            }
+            std::vector<_Client *> closed;
+            for (auto &frame : frames)
+            {
+                if (frame->key)
+                    gop.clear();
+                if (!gop.empty() || frame->key)
+                {
+                    if (gop.size() < GOP_CACHE_MAX)
+                        gop.push_back(frame);
+                    else
+                        gop.clear();
+                }
+                for (auto &it : clients)
+                {
+                    if (it.second->playing)
+                        enqueue(it.second, frame);
+                }
+            }
+            for (auto &it : clients)
+            {
+                if (it.second->playing && !flush(it.second))
+                    closed.push_back(it.second);
+            }
+            for (auto c : closed)
+                close_client(c);
+        }
+
+        // receiver reports of UDP sessions, only used as keepalive
+        void on_rtcp()
+        {
+            uint8_t buff[1500];
+            while (1)
+            {
+                struct sockaddr_in addr;
+                socklen_t addr_len = sizeof(addr);
+                ssize_t n = recvfrom(rtcp_fd, buff, sizeof(buff), 0, (struct sockaddr *)&addr, &addr_len);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                for (auto &it : clients)
+                {
+                    _Client *c = it.second;
+                    if (!c->tcp && c->setup && c->rtcp_addr.sin_addr.s_addr == addr.sin_addr.s_addr && c->rtcp_addr.sin_port == addr.sin_port)
+                        c->active_ms = time::ticks_ms();
+                }
+            }
+        }
+
+        void on_timer()
+        {
+            uint64_t now = time::ticks_ms();
+            std::vector<_Client *> closed;
+            for (auto &it : clients)
+            {
+                _Client *c = it.second;
+                // TCP sessions live with the connection, UDP sessions need RTCP or RTSP keepalive
+                if (c->setup && !c->tcp && now - c->active_ms > SESSION_TIMEOUT_S * 1000)
+                {
+                    log::info("rtsp session %s timeout", c->session.c_str());
+                    closed.push_back(c);
+                    continue;
+                }
+                if (c->playing && c->packet_count > 0 && now - c->last_sr_ms >= RTCP_INTERVAL_MS)
+                {
+                    send_sr(c, now);
+                    if (c->tcp && !flush(c))
+                        closed.push_back(c);
+                }
+            }
+            for (auto c : closed)
+                close_client(c);
+        }
+
+        void send_sr(_Client *c, uint64_t now)
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            uint32_t ntp_sec = (uint32_t)(ts.tv_sec + 2208988800u);
+            uint32_t ntp_frac = (uint32_t)(((uint64_t)ts.tv_nsec << 32) / 1000000000);
+            uint32_t rtp_ts = timestamp_now();
+            uint32_t words[6] = {ssrc, ntp_sec, ntp_frac, rtp_ts, c->packet_count, c->octet_count};
+            uint8_t sr[28];
+            sr[0] = 0x80;
+            sr[1] = 200;
+            sr[2] = 0;
+            sr[3] = 6;
+            for (int i = 0; i < 6; ++i)
+            {
+                uint32_t w = htonl(words[i]);
+                memcpy(sr + 4 + i * 4, &w, 4);
+            }
+            c->last_sr_ms = now;
+            if (c->tcp)
+            {
+                char head[4] = {'$', (char)c->rtcp_channel, 0, (char)sizeof(sr)};
+                // RTP packet may be half sent, flush sends SR after it
+                c->out.append(head, 4);
+                c->out.append((const char *)sr, sizeof(sr));
+            }
+            else
+            {
+                ssize_t res = sendto(rtcp_fd, sr, sizeof(sr), MSG_DONTWAIT, (struct sockaddr *)&c->rtcp_addr, sizeof(c->rtcp_addr));
+                (void)res;
+            }
+        }
+
+        // read until EAGAIN, return false if client should be closed
+        bool on_read(_Client *c)
+        {
+            char buff[2048];
+            while (1)
+            {
+                ssize_t n = recv(c->fd, buff, sizeof(buff), 0);
+                if (n == 0)
+                    return false;
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                c->in.append(buff, n);
+                if (!on_request(c))
+                    return false;
+                if (c->in.size() > MAX_REQUEST_SIZE)
+                    return false;
+            }
+        }
+
+        // parse all complete requests and interleaved RTCP packets in input buffer
+        bool on_request(_Client *c)
+        {
+            while (!c->in.empty())
+            {
+                if (c->in[0] == '$')
+                {
+                    if (c->in.size() < 4)
+                        return true;
+                    size_t len = ((uint8_t)c->in[2] << 8) | (uint8_t)c->in[3];
+                    if (c->in.size() < 4 + len)
+                        return true;
+                    c->in.erase(0, 4 + len);
+                    c->active_ms = time::ticks_ms();
+                    continue;
+                }
+                size_t end = c->in.find("\r\n\r\n");
+                if (end == std::string::npos)
+                    return true;
+                std::string request = c->in.substr(0, end + 2);
+                size_t content_len = atoi(_header(request, "Content-Length").c_str());
+                if (c->in.size() < end + 4 + content_len)
+                    return true;
+                c->in.erase(0, end + 4 + content_len);
+                c->active_ms = time::ticks_ms();
+                if (!handle(c, request))
+                    return false;
+            }
+            return true;
+        }
+
+        std::string sdp(_Client *c)
+        {
+            struct sockaddr_in local;
+            socklen_t len = sizeof(local);
+            char ip[INET_ADDRSTRLEN] = "0.0.0.0";
+            if (getsockname(c->fd, (struct sockaddr *)&local, &len) == 0)
+                inet_ntop(AF_INET, &local.sin_addr, ip, sizeof(ip));
+            std::string vps_, sps_, pps_;
+            {
+                std::lock_guard<std::mutex> guard(push_lock);
+                vps_ = vps;
+                sps_ = sps;
+                pps_ = pps;
+            }
+            std::string fmtp;
+            if (h265)
+            {
+                if (!vps_.empty() && !sps_.empty() && !pps_.empty())
+                    fmtp = "a=fmtp:96 sprop-vps=" + _base64(vps_) + ";sprop-sps=" + _base64(sps_) + ";sprop-pps=" + _base64(pps_) + "\r\n";
+            }
+            else
+            {
+                fmtp = "a=fmtp:96 packetization-mode=1";
+                if (sps_.size() >= 4)
+                {
+                    char profile[16];
+                    snprintf(profile, sizeof(profile), "%02X%02X%02X", (uint8_t)sps_[1], (uint8_t)sps_[2], (uint8_t)sps_[3]);
+                    fmtp += std::string(";profile-level-id=") + profile;
+                }
+                if (!sps_.empty() && !pps_.empty())
+                    fmtp += ";sprop-parameter-sets=" + _base64(sps_) + "," + _base64(pps_);
+                fmtp += "\r\n";
+            }
+            return std::string("v=0\r\n") +
+                   "o=- " + std::to_string(ssrc) + " 1 IN IP4 " + ip + "\r\n"
+                   "s=MaixCDK\r\n"
+                   "c=IN IP4 0.0.0.0\r\n"
+                   "t=0 0\r\n"
+                   "a=control:*\r\n"
+                   "a=range:npt=0-\r\n"
+                   "m=video 0 RTP/AVP 96\r\n"
+                   "a=rtpmap:96 " + (h265 ? "H265" : "H264") + "/90000\r\n" +
+                   fmtp +
+                   "a=control:track0\r\n";
+        }
+
+        void reply(_Client *c, const char *status, const std::string &cseq, const std::string &headers = "", const std::string &body = "")
+        {
+            c->out += std::string("RTSP/1.0 ") + status + "\r\nCSeq: " + cseq + "\r\nServer: MaixCDK\r\n" + headers;
+            if (!body.empty())
+                c->out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+            c->out += "\r\n" + body;
+        }
+
+        bool setup(_Client *c, const std::string &cseq, const std::string &transport)
+        {
+            char ssrc_str[16];
+            snprintf(ssrc_str, sizeof(ssrc_str), "%08X", ssrc);
+            int a = 0, b = 0;
+            size_t pos;
+            if (transport.find("multicast") != std::string::npos)
+            {
+                reply(c, "461 Unsupported Transport", cseq);
+                return true;
+            }
+            if (transport.find("RTP/AVP/TCP") != std::string::npos)
+            {
+                a = 0, b = 1;
+                if ((pos = transport.find("interleaved=")) != std::string::npos)
+                    sscanf(transport.c_str() + pos, "interleaved=%d-%d", &a, &b);
+                c->tcp = true;
+                c->rtp_channel = a;
+                c->rtcp_channel = b;
+            }
+            else if ((pos = transport.find("client_port=")) != std::string::npos && rtp_fd >= 0)
+            {
+                if (sscanf(transport.c_str() + pos, "client_port=%d-%d", &a, &b) < 1)
+                {
+                    reply(c, "461 Unsupported Transport", cseq);
+                    return true;
+                }
+                if (b == 0)
+                    b = a + 1;
+                c->tcp = false;
+                c->rtp_addr = c->peer;
+                c->rtp_addr.sin_port = htons(a);
+                c->rtcp_addr = c->peer;
+                c->rtcp_addr.sin_port = htons(b);
+            }
+            else
+            {
+                reply(c, "461 Unsupported Transport", cseq);
+                return true;
+            }
+            if (c->session.empty())
+            {
+                char session[16];
+                snprintf(session, sizeof(session), "%08X", ssrc ^ (++session_id * 0x9e3779b9u));
+                c->session = session;
+            }
+            c->setup = true;
+            std::string t = c->tcp ? "RTP/AVP/TCP;unicast;interleaved=" + std::to_string(a) + "-" + std::to_string(b)
+                                   : "RTP/AVP;unicast;client_port=" + std::to_string(a) + "-" + std::to_string(b) +
+                                     ";server_port=" + std::to_string(rtp_port) + "-" + std::to_string(rtp_port + 1);
+            reply(c, "200 OK", cseq, "Transport: " + t + ";ssrc=" + ssrc_str + "\r\nSession: " + c->session + ";timeout=" + std::to_string(SESSION_TIMEOUT_S) + "\r\n");
+            return true;
+        }
+
+        void play(_Client *c, const std::string &cseq, const std::string &url)
+        {
+            c->frames.clear();
+            c->queued = 0;
+            c->packet_idx = 0;
+            c->packet_pos = 0;
+            c->wait_key = false;
+            // start from the last IDR, so client shows picture at once instead of waiting next one
+            if (!gop.empty())
+            {
+                for (auto &frame : gop)
+                    enqueue(c, frame);
+            }
+            else
+            {
+                c->wait_key = true;
+            }
+            std::string info;
+            if (!c->frames.empty())
+            {
+                std::string base = url;
+                if (!base.empty() && base.back() == '/')
+                    base.pop_back();
+                if (base.size() < 7 || base.compare(base.size() - 7, 7, "/track0") != 0)
+                    base += "/track0";
+                info = "RTP-Info: url=" + base + ";seq=" + std::to_string(c->frames.front()->first_seq) + ";rtptime=" + std::to_string(c->frames.front()->timestamp) + "\r\n";
+            }
+            if (!c->playing)
+                ++playing;
+            c->playing = true;
+            c->last_sr_ms = 0;
+            reply(c, "200 OK", cseq, "Range: npt=0.000-\r\nSession: " + c->session + "\r\n" + info);
+        }
+
+        // handle one request, return false if client should be closed
+        bool handle(_Client *c, const std::string &request)
+        {
+            char method[32] = {0}, url[1024] = {0};
+            if (sscanf(request.c_str(), "%31s %1023s RTSP/", method, url) != 2)
+                return false;
+            std::string cseq = _header(request, "CSeq");
+            std::string path = url;
+            if (path.compare(0, 7, "rtsp://") == 0)
+            {
+                size_t slash = path.find('/', 7);
+                path = slash == std::string::npos ? "/" : path.substr(slash);
+            }
+            if (!strcmp(method, "OPTIONS"))
+            {
+                reply(c, "200 OK", cseq, "Public: OPTIONS, DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER\r\n");
+            }
+            else if (!strcmp(method, "DESCRIBE"))
+            {
+                if (path.compare(0, 5, "/live") != 0)
+                {
+                    reply(c, "404 Not Found", cseq);
+                    return true;
+                }
+                std::string base = url;
+                if (base.empty() || base.back() != '/')
+                    base += "/";
+                reply(c, "200 OK", cseq, "Content-Base: " + base + "\r\nContent-Type: application/sdp\r\n", sdp(c));
+            }
+            else if (!strcmp(method, "SETUP"))
+            {
+                if (c->playing)
+                {
+                    reply(c, "455 Method Not Valid in This State", cseq);
+                    return true;
+                }
+                return setup(c, cseq, _header(request, "Transport"));
+            }
+            else if (!strcmp(method, "PLAY"))
+            {
+                if (!c->setup)
+                    reply(c, "455 Method Not Valid in This State", cseq);
+                else
+                    play(c, cseq, url);
+            }
+            else if (!strcmp(method, "PAUSE"))
+            {
+                if (c->playing)
+                    --playing;
+                c->playing = false;
+                reply(c, "200 OK", cseq, "Session: " + c->session + "\r\n");
+            }
+            else if (!strcmp(method, "TEARDOWN"))
+            {
+                if (c->playing)
+                    --playing;
+                c->playing = false;
+                c->setup = false;
+                c->close_after = true;
+                reply(c, "200 OK", cseq, "Session: " + c->session + "\r\n");
+            }
+            else if (!strcmp(method, "GET_PARAMETER") || !strcmp(method, "SET_PARAMETER"))
+            {
+                reply(c, "200 OK", cseq, c->session.empty() ? "" : "Session: " + c->session + "\r\n");
+            }
+            else
+            {
+                reply(c, "405 Method Not Allowed", cseq, "Allow: OPTIONS, DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER\r\n");
+            }
+            return true;
+        }
+
+        // UDP has no back pressure, send whole frames, packets lost in kernel are lost as on network
+        void flush_udp(_Client *c)
+        {
+            struct mmsghdr msgs[64];
+            struct iovec iovs[64];
+            while (!c->frames.empty())
+            {
+                const _Frame *f = c->frames.front().get();
+                while (c->packet_idx < f->packets())
+                {
+                    int num = 0;
+                    for (size_t i = c->packet_idx; i < f->packets() && num < 64; ++i, ++num)
+                    {
+                        iovs[num].iov_base = (void *)f->packet(i);
+                        iovs[num].iov_len = f->packet_size(i);
+                        memset(&msgs[num], 0, sizeof(msgs[num]));
+                        msgs[num].msg_hdr.msg_name = &c->rtp_addr;
+                        msgs[num].msg_hdr.msg_namelen = sizeof(c->rtp_addr);
+                        msgs[num].msg_hdr.msg_iov = &iovs[num];
+                        msgs[num].msg_hdr.msg_iovlen = 1;
+                    }
+                    int sent = sendmmsg(rtp_fd, msgs, num, MSG_DONTWAIT);
+                    if (sent < 0 && errno == EINTR)
+                        continue;
+                    if (sent <= 0)
+                        sent = num; // drop, network is lossy anyway
+                    for (int i = 0; i < sent; ++i)
+                        c->octet_count += f->packet_size(c->packet_idx + i) - 12;
+                    c->packet_count += sent;
+                    c->packet_idx += sent;
+                }
+                c->queued -= f->data.size();
+                c->frames.pop_front();
+                c->packet_idx = 0;
+            }
+        }
+
+        // send pending data until EAGAIN or nothing to send, return false if client should be closed
+        bool flush(_Client *c)
+        {
+            while (1)
+            {
+                // responses never split an interleaved RTP packet
+                if (c->out_pos < c->out.size() && c->packet_pos == 0)
+                {
+                    ssize_t n = send(c->fd, c->out.data() + c->out_pos, c->out.size() - c->out_pos, MSG_NOSIGNAL);
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        return errno == EAGAIN || errno == EWOULDBLOCK;
+                    }
+                    c->out_pos += n;
+                    if (c->out_pos < c->out.size())
+                        continue;
+                    c->out.clear();
+                    c->out_pos = 0;
+                    if (c->close_after)
+                        return false;
+                }
+                if (!c->playing || c->frames.empty())
+                    return true;
+                if (!c->tcp)
+                {
+                    flush_udp(c);
+                    continue;
+                }
+                // many packets with their interleaved headers in one call
+                struct iovec iov[64];
+                uint8_t heads[32][4];
+                int iov_num = 0;
+                size_t pos = c->packet_pos;
+                size_t idx = c->packet_idx;
+                for (size_t fi = 0; fi < c->frames.size() && iov_num < 63; ++fi)
+                {
+                    const _Frame *f = c->frames[fi].get();
+                    for (; idx < f->packets() && iov_num < 63; ++idx)
+                    {
+                        size_t size = f->packet_size(idx);
+                        uint8_t *head = heads[iov_num / 2];
+                        head[0] = '$';
+                        head[1] = c->rtp_channel;
+                        head[2] = size >> 8;
+                        head[3] = size & 0xff;
+                        if (pos < 4)
+                        {
+                            iov[iov_num].iov_base = head + pos;
+                            iov[iov_num].iov_len = 4 - pos;
+                            ++iov_num;
+                            pos = 0;
+                        }
+                        else
+                        {
+                            pos -= 4;
+                        }
+                        iov[iov_num].iov_base = (void *)(f->packet(idx) + pos);
+                        iov[iov_num].iov_len = size - pos;
+                        ++iov_num;
+                        pos = 0;
+                    }
+                    idx = 0;
+                }
+                struct msghdr msg;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = iov;
+                msg.msg_iovlen = iov_num;
+                ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                // advance packets sent
+                size_t left = n;
+                while (left > 0 && !c->frames.empty())
+                {
+                    const _Frame *f = c->frames.front().get();
+                    size_t size = f->packet_size(c->packet_idx);
+                    size_t remain = 4 + size - c->packet_pos;
+                    if (left < remain)
+                    {
+                        c->packet_pos += left;
+                        break;
+                    }
+                    left -= remain;
+                    c->packet_pos = 0;
+                    c->packet_count += 1;
+                    c->octet_count += size - 12;
+                    if (++c->packet_idx == f->packets())
+                    {
+                        c->queued -= f->data.size();
+                        c->frames.pop_front();
+                        c->packet_idx = 0;
+                    }
+                }
+            }
+        }
+
+        bool open_udp()
+        {
+            for (int port = RTP_UDP_PORT_BASE; port < RTP_UDP_PORT_BASE + 200; port += 2)
+            {
+                int fds[2] = {-1, -1};
+                bool ok = true;
+                for (int i = 0; i < 2 && ok; ++i)
+                {
+                    fds[i] = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                    struct sockaddr_in addr;
+                    memset(&addr, 0, sizeof(addr));
+                    addr.sin_family = AF_INET;
+                    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+                    addr.sin_port = htons(port + i);
+                    ok = fds[i] >= 0 && bind(fds[i], (struct sockaddr *)&addr, sizeof(addr)) == 0;
+                }
+                if (ok)
+                {
+                    int buff_size = 2 * 1024 * 1024;
+                    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &buff_size, sizeof(buff_size));
+                    rtp_fd = fds[0];
+                    rtcp_fd = fds[1];
+                    rtp_port = port;
+                    return true;
+                }
+                for (int i = 0; i < 2; ++i)
+                {
+                    if (fds[i] >= 0)
+                        ::close(fds[i]);
+                }
+            }
+            return false;
+        }
+
+        err::Err start(const std::string &ip, int port)
+        {
+            listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listen_fd < 0)
+            {
+                log::error("create socket failed: %s", strerror(errno));
+                return err::ERR_IO;
+            }
+            int opt = 1;
+            setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1)
+                addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 16) < 0)
+            {
+                log::error("rtsp bind port %d failed: %s", port, strerror(errno));
+                return err::ERR_IO;
+            }
+            if (!open_udp())
+                log::warn("no free udp port, rtsp only support tcp transport");
+            epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (epoll_fd < 0 || event_fd < 0)
+            {
+                log::error("create epoll failed: %s", strerror(errno));
+                return err::ERR_IO;
+            }
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            bool ok = true;
+            int fds[3] = {listen_fd, event_fd, rtcp_fd};
+            for (int i = 0; i < 3 && ok; ++i)
+            {
+                if (fds[i] < 0)
+                    continue;
+                ev.data.fd = fds[i];
+                ok = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) == 0;
+            }
+            if (!ok)
+            {
+                log::error("epoll add failed: %s", strerror(errno));
+                return err::ERR_IO;
+            }
+            ssrc = (uint32_t)time::ticks_us() ^ ((uint32_t)getpid() << 16);
+            seq = (uint16_t)ssrc;
+            exit = false;
+            running = true;
+            thread = std::thread(&_Server::loop, this);
+            return err::ERR_NONE;
+        }
+
+        ~_Server()
+        {
+            if (running)
+            {
+                exit = true;
+                notify();
+                thread.join();
+            }
+            int fds[5] = {listen_fd, epoll_fd, event_fd, rtp_fd, rtcp_fd};
+            for (int i = 0; i < 5; ++i)
+            {
+                if (fds[i] >= 0)
+                    ::close(fds[i]);
+            }
+        }
+    };
+
+    typedef struct {
+        bool used;
+        bool visible;                   // update_canvas called at least once
+        camera::Camera *camera;
+        int x, y, width, height;
+        std::vector<uint8_t> pixels;    // BGRA8888 committed by update_canvas
+    } region_slot_t;
+
+    static std::mutex _region_lock;
+    static region_slot_t _region_slots[REGION_MAX];
+
+    // alpha blend visible regions of camera to image, RGB888, BGR888, RGBA8888 and BGRA8888 supported
+    static void _draw_regions(camera::Camera *camera, image::Image *img)
+    {
+        image::Format fmt = img->format();
+        int ch = fmt == image::FMT_RGB888 || fmt == image::FMT_BGR888 ? 3 : 4;
+        bool rgb = fmt == image::FMT_RGB888 || fmt == image::FMT_RGBA8888;
+        int img_w = img->width(), img_h = img->height();
+        uint8_t *dst = (uint8_t *)img->data();
+        std::lock_guard<std::mutex> guard(_region_lock);
+        for (int i = 0; i < REGION_MAX; ++i)
+        {
+            region_slot_t &s = _region_slots[i];
+            if (!s.used || !s.visible || s.camera != camera)
+                continue;
+            int x0 = std::max(s.x, 0), y0 = std::max(s.y, 0);
+            int x1 = std::min(s.x + s.width, img_w), y1 = std::min(s.y + s.height, img_h);
+            for (int y = y0; y < y1; ++y)
+            {
+                const uint8_t *src = s.pixels.data() + ((size_t)(y - s.y) * s.width + (x0 - s.x)) * 4;
+                uint8_t *d = dst + ((size_t)y * img_w + x0) * ch;
+                for (int x = x0; x < x1; ++x, src += 4, d += ch)
+                {
+                    uint32_t a = src[3];
+                    if (a == 0)
+                        continue;
+                    uint8_t b = src[0], g = src[1], r = src[2];
+                    uint8_t c0 = rgb ? r : b, c2 = rgb ? b : r;
+                    if (a == 255)
+                    {
+                        d[0] = c0;
+                        d[1] = g;
+                        d[2] = c2;
+                        continue;
+                    }
+                    d[0] = (c0 * a + d[0] * (255 - a) + 127) / 255;
+                    d[1] = (g * a + d[1] * (255 - a) + 127) / 255;
+                    d[2] = (c2 * a + d[2] * (255 - a) + 127) / 255;
+                }
+            }
+        }
+    }
+
+    static bool _camera_has_region(camera::Camera *camera)
+    {
+        std::lock_guard<std::mutex> guard(_region_lock);
+        for (int i = 0; i < REGION_MAX; ++i)
+        {
+            if (_region_slots[i].used && _region_slots[i].visible && _region_slots[i].camera == camera)
+                return true;
+        }
+        return false;
+    }
+
     Region::Region(int x, int y, int width, int height, image::Format format, camera::Camera *camera)
     {
-        (void)x;
-        (void)y;
-        (void)width;
-        (void)height;
-        (void)format;
-        (void)camera;
+        if (format != image::Format::FMT_BGRA8888) {
+            err::check_raise(err::ERR_RUNTIME, "region support FMT_BGRA8888 only!");
+        }
+
+        if (camera == NULL) {
+            err::check_raise(err::ERR_RUNTIME, "region bind a NULL camera!");
+        }
+
+        int rgn_id = -1;
+        {
+            std::lock_guard<std::mutex> guard(_region_lock);
+            for (int i = 0; i < REGION_MAX; i ++) {
+                if (!_region_slots[i].used) {
+                    region_slot_t &s = _region_slots[i];
+                    s.used = true;
+                    s.visible = false;
+                    s.camera = camera;
+                    s.x = x;
+                    s.y = y;
+                    s.width = width;
+                    s.height = height;
+                    s.pixels.assign((size_t)width * height * 4, 0);
+                    rgn_id = i;
+                    break;
+                }
+            }
+        }
+        if (rgn_id < 0) {
+            err::check_raise(err::ERR_RUNTIME, "no more region id!");
+        }
+
+        this->_id = rgn_id;
+        this->_width = width;
+        this->_height = height;
+        this->_x = x;
+        this->_y = y;
+        this->_format = format;
+        this->_camera = camera;
+        this->_flip = false;
+        this->_mirror = false;
+        this->_image = new image::Image(width, height, format);
+        memset(this->_image->data(), 0, this->_image->data_size());
     }
 
     Region::~Region() {
-
+        {
+            std::lock_guard<std::mutex> guard(_region_lock);
+            region_slot_t &s = _region_slots[this->_id];
+            s.used = false;
+            s.visible = false;
+            s.camera = NULL;
+            std::vector<uint8_t>().swap(s.pixels);
+        }
+        delete this->_image;
     }
 
     image::Image *Region::get_canvas() {
-        return NULL;
+        memset(this->_image->data(), 0, this->_image->data_size());
+        return this->_image;
     }
 
     err::Err Region::update_canvas() {
-        return err::ERR_NOT_IMPL;
+        image::Image *img = this->_image;
+        if (img->format() != image::Format::FMT_BGRA8888) {
+            log::error("support FMT_BGRA888 only!\r\n");
+            return err::ERR_RUNTIME;
+        }
+
+        // canvas is copied, drawing next content never tears the frame being encoded
+        std::lock_guard<std::mutex> guard(_region_lock);
+        region_slot_t &s = _region_slots[this->_id];
+        memcpy(s.pixels.data(), img->data(), s.pixels.size());
+        s.visible = true;
+        return err::ERR_NONE;
     }
 
+    enum RtspStatus{
+        RTSP_IDLE = 0,
+        RTSP_RUNNING,
+        RTSP_STOP,
+    };
+
+    typedef struct {
+        _Server *rtsp_server;
+        enum RtspStatus status;
+        camera::Camera *camera;
+        video::Encoder *encoder;
+        audio::Recorder *audio_recorder;
+        bool bind_camera;
+        bool bind_audio_recorder;
+        bool h265;
+        int encoder_bitrate;
+        int fps;
+    } rtsp_param_t;
+
     Rtsp::Rtsp(std::string ip, int port, int fps, rtsp::RtspStreamType stream_type, int bitrate) {
-        (void)ip;
-        (void)port;
-        (void)fps;
-        (void)stream_type;
-        (void)bitrate;
+        rtsp_param_t *param = (rtsp_param_t *)malloc(sizeof(rtsp_param_t));
+        err::check_null_raise(param, "malloc failed!");
+        memset(param, 0, sizeof(rtsp_param_t));
+
+        this->_ip = ip;
+        this->_port = port;
+        this->_fps = fps;
+        this->_stream_type = stream_type;
+        this->_is_start = false;
+        this->_thread = NULL;
+        this->_param = param;
+        this->_region_max_number = REGION_MAX;
+        for (int i = 0; i < this->_region_max_number; i ++) {
+            this->_region_list.push_back(NULL);
+            this->_region_type_list.push_back(0);
+            this->_region_used_list.push_back(false);
+        }
+
+        if (_ip.size() == 0) {
+            _ip = "0.0.0.0";
+        }
+
+        this->_timestamp = 0;
+        this->_last_ms = 0;
+
+        param->status = RTSP_IDLE;
+        param->encoder_bitrate = bitrate;
+        param->fps = fps > 0 ? fps : 30;
+        param->h265 = stream_type == rtsp::RtspStreamType::RTSP_STREAM_H265;
     }
 
     Rtsp::~Rtsp() {
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (param) {
+            if (param->status != RTSP_IDLE) {
+                this->stop();
+            }
+            free(_param);
+            _param = nullptr;
+        }
+
+        for (auto &region : this->_region_list) {
+            delete region;
+        }
+    }
+
+    static void _camera_push_thread(void *args) {
+        rtsp_param_t *param = (rtsp_param_t *)args;
+        uint64_t last_ms = time::ticks_ms();
+
+        // encode even no client is playing, GOP cache is always ready for new clients
+        while (param->status == RTSP_RUNNING && !app::need_exit()) {
+            while ((time::ticks_ms() - last_ms) * param->fps < 1000) {
+                time::sleep_ms(1);
+            }
+            last_ms = time::ticks_ms();
+
+            image::Image *img = param->camera->read();
+            if (!img) {
+                log::error("read camera image failed!\r\n");
+                time::sleep_ms(10);
+                continue;
+            }
+
+            if (_camera_has_region(param->camera)) {
+                image::Format fmt = img->format();
+                if (fmt != image::FMT_RGB888 && fmt != image::FMT_BGR888 && fmt != image::FMT_RGBA8888 && fmt != image::FMT_BGRA8888) {
+                    image::Image *rgb = img->to_format(image::FMT_RGB888);
+                    delete img;
+                    img = rgb;
+                }
+                _draw_regions(param->camera, img);
+            }
+
+            video::Frame *frame = param->encoder->encode(img);
+            delete img;
+            void *data = NULL;
+            int len = 0;
+            frame->get(&data, &len);
+            if (data && len > 0) {
+                param->rtsp_server->push((const uint8_t *)data, len);
+            }
+            delete frame;
+        }
     }
 
     err::Err Rtsp::start() {
-        err::Err err = err::ERR_NOT_IMPL;
-        return err;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param) {
+            return err::ERR_RUNTIME;
+        }
+
+        if (param->status != RTSP_IDLE) {
+            return err::ERR_BUSY;
+        }
+
+        if (param->bind_audio_recorder) {
+            log::warn("audio is not streamed by rtsp on linux yet, only video is sent");
+        }
+
+        // create rtsp server
+        _Server *server = new _Server();
+        server->h265 = param->h265;
+        err::Err err = server->start(_ip, _port);
+        if (err != err::ERR_NONE) {
+            delete server;
+            return err;
+        }
+        param->rtsp_server = server;
+
+        // without camera, stream is written by write()
+        if (param->bind_camera && param->camera) {
+            if (param->encoder) {
+                delete param->encoder;
+                param->encoder = nullptr;
+            }
+            // encoder convert camera format itself, regions are blended to RGB before
+            image::Format fmt = param->camera->format();
+            if (fmt != image::FMT_RGB888 && fmt != image::FMT_BGR888 && fmt != image::FMT_RGBA8888 && fmt != image::FMT_BGRA8888) {
+                fmt = image::FMT_RGB888;
+            }
+            video::VideoType type = param->h265 ? video::VIDEO_H265 : video::VIDEO_H264;
+            param->encoder = new video::Encoder("", param->camera->width(), param->camera->height(), fmt, type, param->fps, param->fps * 2, param->encoder_bitrate);
+            err::check_null_raise(param->encoder, "Create video encoder failed!");
+
+            param->status = RTSP_RUNNING;
+            _thread = new thread::Thread(_camera_push_thread, param);
+            if (_thread == NULL) {
+                log::error("create camera thread failed!\r\n");
+                return err::ERR_RUNTIME;
+            }
+        } else {
+            param->status = RTSP_RUNNING;
+        }
+        _is_start = true;
+        return err::ERR_NONE;
     }
 
     err::Err Rtsp::stop() {
-        err::Err err = err::ERR_NOT_IMPL;
-        return err;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (param->status != RTSP_RUNNING) {
+            return err::ERR_NONE;
+        }
+
+        param->status = RTSP_STOP;
+        if (_thread) {
+            _thread->join();
+            delete _thread;
+            _thread = nullptr;
+        }
+
+        if (param->encoder) {
+            delete param->encoder;
+            param->encoder = nullptr;
+        }
+
+        if (param->rtsp_server) {
+            delete param->rtsp_server;
+            param->rtsp_server = nullptr;
+        }
+
+        param->status = RTSP_IDLE;
+        _is_start = false;
+        return err::ERR_NONE;
     }
 
     err::Err Rtsp::bind_camera(camera::Camera *camera) {
-        err::Err err = err::ERR_NOT_IMPL;
-        (void)camera;
-        return err;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param) {
+            return err::ERR_RUNTIME;
+        }
+
+        if (camera->format() == image::Format::FMT_JPEG) {
+            err::check_raise(err::ERR_RUNTIME, "bind camera failed! jpeg camera is not supported!\r\n");
+            return err::ERR_RUNTIME;
+        }
+
+        param->camera = camera;
+        param->bind_camera = true;
+        return err::ERR_NONE;
     }
 
     err::Err Rtsp::bind_audio_recorder(audio::Recorder *recorder) {
-        err::Err err = err::ERR_NOT_IMPL;
-        (void)recorder;
-        return err;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param) {
+            return err::ERR_RUNTIME;
+        }
+
+        param->audio_recorder = recorder;
+        param->bind_audio_recorder = true;
+        return err::ERR_NONE;
     }
 
-    err::Err Rtsp::write(video::Frame &stream) {
-        err::Err err = err::ERR_NOT_IMPL;
-        (void)stream;
-        return err;
+    err::Err Rtsp::write(video::Frame &frame) {
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param || param->status != RTSP_RUNNING || !param->rtsp_server) {
+            return err::ERR_NOT_READY;
+        }
+
+        void *data = NULL;
+        int len = 0;
+        frame.get(&data, &len);
+        if (!data || len <= 0) {
+            return err::ERR_ARGS;
+        }
+        param->rtsp_server->push((const uint8_t *)data, len);
+        return err::ERR_NONE;
     }
 
     camera::Camera *Rtsp::to_camera() {
-        err::check_null_raise(NULL, "The camera object is NULL");
-        return NULL;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        err::check_null_raise(param->camera, "camera is null!");
+        return param->camera;
     }
 
     std::string Rtsp::get_url() {
-        return "not supported";
+        return "rtsp://" + _ip + ":" + std::to_string(_port) + "/live";
+    }
+
+    static std::vector<std::string> rtsp_get_server_urls(std::string ip, int port)
+    {
+        std::vector<std::string> ip_list;
+
+        if (strcmp("0.0.0.0", ip.c_str())) {
+            ip_list.push_back("rtsp://" + ip + ":" + std::to_string(port) + "/live");
+            return ip_list;
+        }
+
+        // all IPv4 interfaces, desktop interface names are not fixed as eth0 or wlan0
+        struct ifaddrs *ifaddr, *ifa;
+        if (getifaddrs(&ifaddr) == -1) {
+            log::error("getifaddrs failed: %s", strerror(errno));
+            return ip_list;
+        }
+        for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
+            if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET) {
+                continue;
+            }
+            char host[NI_MAXHOST];
+            if (getnameinfo(ifa->ifa_addr, sizeof(struct sockaddr_in), host, NI_MAXHOST, NULL, 0, NI_NUMERICHOST) != 0) {
+                continue;
+            }
+            ip_list.push_back("rtsp://" + std::string(host) + ":" + std::to_string(port) + "/live");
+        }
+        freeifaddrs(ifaddr);
+        return ip_list;
     }
 
-    std::vector<std::string> Rtsp::get_urls() {
-        return std::vector<std::string>();
+    std::vector<std::string> Rtsp::get_urls()
+    {
+        return rtsp_get_server_urls(_ip, _port);
     }
 
     rtsp::Region *Rtsp::add_region(int x, int y, int width, int height, image::Format format) {
-        (void)x;
-        (void)y;
-        (void)width;
-        (void)height;
-        (void)format;
-        return NULL;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param) {
+            return nullptr;
+        }
+
+        if (format != image::Format::FMT_BGRA8888) {
+            log::error("region support FMT_BGRA8888 only!\r\n");
+            return NULL;
+        }
+
+        if (!param->bind_camera) {
+            log::error("You must use bind camera firstly!\r\n");
+            return NULL;
+        }
+
+        // Find unused idx
+        int unused_idx = -1;
+        for (int i = 0; i < this->_region_max_number; i ++) {
+            if (this->_region_used_list[i] == false) {
+                unused_idx = i;
+                break;
+            }
+        }
+        err::check_bool_raise(unused_idx != -1, "Unused region not found");
+
+        // Create region
+        rtsp::Region *region = new rtsp::Region(x, y, width, height, format, param->camera);
+        err::check_null_raise(region, "Create region failed!");
+        this->_region_list[unused_idx] = region;
+        this->_region_used_list[unused_idx] = true;
+        this->_region_type_list[unused_idx] = 0;
+
+        return region;
     }
 
     err::Err Rtsp::update_region(rtsp::Region &region) {
@@ -103,15 +1551,87 @@ namespace maix::rtsp
     err::Err Rtsp::del_region(rtsp::Region *region) {
         err::check_null_raise(region, "The region object is NULL");
 
-        return err::ERR_NOT_IMPL;
+        for (int i = 0; i < this->_region_max_number; i ++) {
+            if (this->_region_list[i] == region) {
+                this->_region_list[i] = NULL;
+                this->_region_used_list[i] = false;
+                this->_region_type_list[i] = 0;
+                delete region;
+                return err::ERR_NONE;
+            }
+        }
+
+        return err::ERR_NONE;
+    }
+
+    // replace region of id with a new one drawn by draw, used by draw_rect and draw_string
+    static err::Err _draw_region(Rtsp *rtsp, std::vector<rtsp::Region *> &region_list, std::vector<bool> &used_list, std::vector<int> &type_list,
+                                 int id, int type, int x, int y, int width, int height, const std::function<void(image::Image *)> &draw)
+    {
+        if (id < 0 || id >= (int)region_list.size()) {
+            log::error("region id is invalid! range is [0, %d)", (int)region_list.size());
+            err::check_raise(err::ERR_RUNTIME, "invalid parameter");
+        }
+
+        if (used_list[id] && type_list[id] != type) {
+            log::error("region %d is used for other functions(%d)", id, type_list[id]);
+            err::check_raise(err::ERR_RUNTIME, "invalid parameter");
+        }
+
+        if (used_list[id]) {
+            delete region_list[id];
+            region_list[id] = NULL;
+            used_list[id] = false;
+        }
+
+        if (width <= 0 || height <= 0) {
+            return err::ERR_NONE;
+        }
+
+        rtsp::Region *region = rtsp->add_region(x, y, width, height);
+        err::check_null_raise(region, "Create region failed!");
+        // add_region uses the first unused index, move it to id
+        for (size_t i = 0; i < region_list.size(); i ++) {
+            if (region_list[i] == region) {
+                region_list[i] = NULL;
+                used_list[i] = false;
+                type_list[i] = 0;
+            }
+        }
+        region_list[id] = region;
+        used_list[id] = true;
+        type_list[id] = type;
+
+        image::Image *img = region->get_canvas();
+        err::check_null_raise(img, "Get canvas image failed!");
+        draw(img);
+        return region->update_canvas();
     }
 
-    err::Err Rtsp::draw_rect(int id, int x, int y, int width, int height, image::Color color, int thickness) {
-        return err::ERR_NOT_IMPL;
+    err::Err Rtsp::draw_rect(int id, int x, int y, int width, int height, image::Color color, int thickness)
+    {
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param || !param->camera) {
+            return err::ERR_RUNTIME;
+        }
+
+        // one transparent region is enough, not four like hardware regions
+        return _draw_region(this, _region_list, _region_used_list, _region_type_list, id, 2, x, y, width, height, [&](image::Image *img) {
+            img->draw_rect(0, 0, width, height, color, thickness);
+        });
     }
 
     err::Err Rtsp::draw_string(int id, int x, int y, const char *str, image::Color color, int size, int thickness)
     {
-        return err::ERR_NOT_IMPL;
+        rtsp_param_t *param = (rtsp_param_t *)_param;
+        if (!param || !param->camera || !str) {
+            return err::ERR_RUNTIME;
+        }
+
+        float scale = size > 0 ? size : 1;
+        image::Size text_size = image::string_size(str, scale, thickness);
+        return _draw_region(this, _region_list, _region_used_list, _region_type_list, id, 1, x, y, text_size.width(), text_size.height(), [&](image::Image *img) {
+            img->draw_string(0, 0, str, color, scale, thickness);
+        });
     }
 }
@@ -3,14 +3,40 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Implement Encoder, Decoder and VideoRecorder with FFmpeg software codecs.
  */
 
+#if MAIX_VIDEO_FFMPEG
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
+}
+#endif
+
 #include <stdint.h>
 #include "maix_err.hpp"
 #include "maix_log.hpp"
 #include "maix_image.hpp"
 #include "maix_time.hpp"
 #include "maix_video.hpp"
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <string.h>
+#include <climits>
+#include <algorithm>
+
+#if MAIX_VIDEO_FFMPEG
+// FFmpeg 5.1 replaced channels and channel_layout with ch_layout
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+    #define VIDEO_CH_LAYOUT 1
+#endif
+#endif
 
 namespace maix::video
 {
@@ -32,36 +58,1045 @@ namespace maix::video
         return value * 1000 / ((double)timebase[1] / timebase[0]);
     }
 
+#if MAIX_VIDEO_FFMPEG
+    static void custom_log_callback(void* ptr, int level, const char* fmt, va_list vargs) {
+        if (level > AV_LOG_ERROR) {
+            return;
+        }
+        char line[256];
+        vsnprintf(line, sizeof(line), fmt, vargs);
+        line[strcspn(line, "\n")] = 0;
+        log::error("[ffmpeg] %s", line);
+    }
+
+    // Reuse AVPacket objects, av_packet_alloc/av_packet_free per frame is avoided.
+    class PacketPool
+    {
+    public:
+        ~PacketPool() {
+            for (auto p : _free) {
+                av_packet_free(&p);
+            }
+        }
+
+        AVPacket *get() {
+            if (_free.empty()) {
+                AVPacket *p = av_packet_alloc();
+                err::check_null_raise(p, "av_packet_alloc failed");
+                return p;
+            }
+            AVPacket *p = _free.back();
+            _free.pop_back();
+            return p;
+        }
+
+        void put(AVPacket *p) {
+            if (!p) return;
+            av_packet_unref(p);
+            _free.push_back(p);
+        }
+    private:
+        std::vector<AVPacket *> _free;
+    };
+
+    static video::VideoType _get_video_type(const char *filename, video::VideoType type) {
+        video::VideoType video_type = type;
+        const char *suffix = strrchr(filename, '.');
+        if (!suffix) {
+            return type;
+        }
+
+        if (!strcmp(suffix, ".h264")) {
+            video_type = video::VIDEO_H264;
+        } else if (!strcmp(suffix, ".h265")) {
+            video_type = video::VIDEO_H265;
+        } else if (!strcmp(suffix, ".mp4")) {
+            switch (type) {
+            case video::VIDEO_H264:         // fall through
+            case video::VIDEO_H264_MP4:     // fall through
+            case video::VIDEO_H264_FLV:
+                video_type = video::VIDEO_H264_MP4;
+                break;
+            case video::VIDEO_H265:         // fall through
+            case video::VIDEO_H265_MP4:
+                video_type = video::VIDEO_H265_MP4;
+                break;
+            default:
+                err::check_raise(err::ERR_RUNTIME, "Unsupported video type!");
+                break;
+            }
+        } else if (!strcmp(suffix, ".flv")) {
+            switch (type) {
+            case video::VIDEO_H264:         // fall through
+            case video::VIDEO_H264_MP4:     // fall through
+            case video::VIDEO_H264_FLV:
+                video_type = video::VIDEO_H264_FLV;
+                break;
+            default:
+                err::check_raise(err::ERR_RUNTIME, "Unsupported video type!");
+                break;
+            }
+        }
+        return video_type;
+    }
+
+    static enum AVCodecID _video_type_to_ffmpeg(VideoType video_type) {
+        enum AVCodecID codec_id = AV_CODEC_ID_NONE;
+        switch (video_type) {
+            case VIDEO_H264:
+            case VIDEO_H264_MP4:
+            case VIDEO_H264_FLV:
+                codec_id = AV_CODEC_ID_H264;
+               break;
+            case VIDEO_H265:
+            case VIDEO_H265_MP4:
+                codec_id = AV_CODEC_ID_HEVC;
+                break;
+            default:
+                err::check_raise(err::ERR_RUNTIME, "Unsupported video type!");
+        }
+        return codec_id;
+    }
+
+    static enum AVPixelFormat _image_format_to_ffmpeg(image::Format format) {
+        switch (format) {
+            case image::Format::FMT_RGB888:     return AV_PIX_FMT_RGB24;
+            case image::Format::FMT_BGR888:     return AV_PIX_FMT_BGR24;
+            case image::Format::FMT_RGBA8888:   return AV_PIX_FMT_RGBA;
+            case image::Format::FMT_BGRA8888:   return AV_PIX_FMT_BGRA;
+            case image::Format::FMT_RGB565:     return AV_PIX_FMT_RGB565LE;
+            case image::Format::FMT_BGR565:     return AV_PIX_FMT_BGR565LE;
+            case image::Format::FMT_YUV422SP:   return AV_PIX_FMT_NV16;
+            case image::Format::FMT_YUV422P:    return AV_PIX_FMT_YUV422P;
+            case image::Format::FMT_YVU420SP:   return AV_PIX_FMT_NV21;
+            case image::Format::FMT_YUV420SP:   return AV_PIX_FMT_NV12;
+            case image::Format::FMT_YUV420P:    return AV_PIX_FMT_YUV420P;
+            case image::Format::FMT_GRAYSCALE:  return AV_PIX_FMT_GRAY8;
+            default:
+                err::check_raise(err::ERR_RUNTIME, "Unsupported image format: " + std::string(image::fmt_names[format]));
+        }
+        return AV_PIX_FMT_NONE;
+    }
+
+    static audio::Format _audio_format_from_alsa(enum AVSampleFormat format) {
+        switch (format) {
+            case AV_SAMPLE_FMT_NONE: return audio::FMT_NONE;
+            case AV_SAMPLE_FMT_U8: return audio::FMT_S8;
+            case AV_SAMPLE_FMT_S16: return audio::FMT_S16_LE;
+            case AV_SAMPLE_FMT_S32: return audio::FMT_S32_LE;
+            default: {
+                log::error("Not support format %s", av_get_sample_fmt_name(format));
+                err::check_raise(err::ERR_NOT_IMPL);
+            }
+        }
+        return audio::FMT_NONE;
+    }
+
+    static int _codec_channels(const AVCodecContext *ctx) {
+#if VIDEO_CH_LAYOUT
+        return ctx->ch_layout.nb_channels;
+#else
+        return ctx->channels;
+#endif
+    }
+
+    static void _codec_set_channels(AVCodecContext *ctx, int channels) {
+#if VIDEO_CH_LAYOUT
+        av_channel_layout_uninit(&ctx->ch_layout);
+        av_channel_layout_default(&ctx->ch_layout, channels);
+#else
+        ctx->channels = channels;
+        ctx->channel_layout = av_get_default_channel_layout(channels);
+#endif
+    }
+
+    static void _frame_set_channels(AVFrame *frame, int channels) {
+#if VIDEO_CH_LAYOUT
+        av_channel_layout_uninit(&frame->ch_layout);
+        av_channel_layout_default(&frame->ch_layout, channels);
+#else
+        frame->channels = channels;
+        frame->channel_layout = av_get_default_channel_layout(channels);
+#endif
+    }
+
+    // channels are kept, only sample rate and sample format are converted
+    static SwrContext *_swr_create(int channels, int in_rate, enum AVSampleFormat in_fmt, int out_rate, enum AVSampleFormat out_fmt) {
+        SwrContext *swr = NULL;
+#if VIDEO_CH_LAYOUT
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, channels);
+        if (swr_alloc_set_opts2(&swr, &layout, out_fmt, out_rate, &layout, in_fmt, in_rate, 0, NULL) < 0) {
+            return NULL;
+        }
+#else
+        int64_t layout = av_get_default_channel_layout(channels);
+        swr = swr_alloc_set_opts(NULL, layout, out_fmt, out_rate, layout, in_fmt, in_rate, 0, NULL);
+        if (!swr) {
+            return NULL;
+        }
+#endif
+        if (swr_init(swr) < 0) {
+            swr_free(&swr);
+            return NULL;
+        }
+        return swr;
+    }
+
+    static int64_t _frame_duration(const AVFrame *frame) {
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(58, 2, 100)
+        return frame->duration;
+#else
+        return frame->pkt_duration;
+#endif
+    }
+
+    // Prefer external software encoders, they are faster and have better quality than FFmpeg native ones.
+    static const AVCodec *_find_video_encoder(enum AVCodecID codec_id) {
+        static const char *h264_names[] = {"libx264", "libopenh264", NULL};
+        static const char *h265_names[] = {"libx265", NULL};
+        const char **names = codec_id == AV_CODEC_ID_HEVC ? h265_names : h264_names;
+        for (int i = 0; names[i]; i ++) {
+            const AVCodec *codec = avcodec_find_encoder_by_name(names[i]);
+            if (codec) {
+                return codec;
+            }
+        }
+        return avcodec_find_encoder(codec_id);
+    }
+
+    // Convert image to frame, the scaler is created again only when source size or format changed.
+    typedef struct {
+        SwsContext *ctx;
+        int src_w, src_h;
+        enum AVPixelFormat src_fmt;
+        int dst_w, dst_h;
+        enum AVPixelFormat dst_fmt;
+    } scaler_t;
+
+    static int _scale(scaler_t *scaler, const uint8_t *src, int src_w, int src_h, enum AVPixelFormat src_fmt,
+                      uint8_t *const dst[], const int dst_linesize[], int dst_w, int dst_h, enum AVPixelFormat dst_fmt) {
+        if (!scaler->ctx || scaler->src_w != src_w || scaler->src_h != src_h || scaler->src_fmt != src_fmt
+            || scaler->dst_w != dst_w || scaler->dst_h != dst_h || scaler->dst_fmt != dst_fmt) {
+            sws_freeContext(scaler->ctx);
+            // only format converting in most cases, SWS_FAST_BILINEAR is enough and fastest
+            scaler->ctx = sws_getContext(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+            if (!scaler->ctx) {
+                return -1;
+            }
+            scaler->src_w = src_w;
+            scaler->src_h = src_h;
+            scaler->src_fmt = src_fmt;
+            scaler->dst_w = dst_w;
+            scaler->dst_h = dst_h;
+            scaler->dst_fmt = dst_fmt;
+        }
+        uint8_t *src_data[4];
+        int src_linesize[4];
+        av_image_fill_arrays(src_data, src_linesize, src, src_fmt, src_w, src_h, 1);
+        return sws_scale(scaler->ctx, src_data, src_linesize, 0, src_h, dst, dst_linesize) > 0 ? 0 : -1;
+    }
+
+    typedef struct {
+        video::VideoType video_type;
+        AVCodecContext *codec_ctx;
+        AVFrame *frame;
+        scaler_t scaler;
+        PacketPool *packet_pool;
+        int64_t last_pts;
+        uint64_t last_encode_ms;
+
+        // muxer, NULL if encode to raw stream
+        AVFormatContext *outputFormatContext;
+        AVStream *outputStream;
+
+        // audio, pcm is S16 48000Hz mono, encoded to AAC
+        AVStream *audio_stream;
+        AVCodecContext *audio_codec_ctx;
+        AVFrame *audio_frame;
+        SwrContext *swr_ctx;
+        AVAudioFifo *audio_fifo;
+        int64_t audio_last_pts;
+        int audio_sample_rate;
+        int audio_channels;
+        enum AVSampleFormat audio_format;
+
+        bool header_written;
+    } encoder_param_t;
+
+    static err::Err _encoder_audio_init(encoder_param_t *param) {
+        const AVCodec *audio_codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+        if (!audio_codec) {
+            log::warn("Could not find aac encoder, audio will be ignored");
+            return err::ERR_NOT_FOUND;
+        }
+        param->audio_sample_rate = 48000;
+        param->audio_channels = 1;
+        param->audio_format = AV_SAMPLE_FMT_S16;
+
+        // owned by param once allocated, freed by _encoder_param_free if any step below raises
+        AVCodecContext *ctx = avcodec_alloc_context3(audio_codec);
+        err::check_null_raise(ctx, "Could not allocate audio codec context");
+        param->audio_codec_ctx = ctx;
+        ctx->codec_type = AVMEDIA_TYPE_AUDIO;
+        ctx->sample_rate = param->audio_sample_rate;
+        _codec_set_channels(ctx, param->audio_channels);
+        ctx->sample_fmt = AV_SAMPLE_FMT_FLTP;  // native aac encoder only accepts float planar
+        ctx->time_base = (AVRational){1, param->audio_sample_rate};
+        ctx->bit_rate = 128000;
+        if (param->outputFormatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        err::check_bool_raise(avcodec_open2(ctx, audio_codec, NULL) >= 0, "audio codec open failed");
+
+        AVStream *stream = avformat_new_stream(param->outputFormatContext, NULL);
+        err::check_null_raise(stream, "Could not allocate audio stream");
+        param->audio_stream = stream;
+        stream->time_base = ctx->time_base;
+        err::check_bool_raise(avcodec_parameters_from_context(stream->codecpar, ctx) >= 0, "avcodec_parameters_from_context failed");
+
+        AVFrame *frame = av_frame_alloc();
+        err::check_null_raise(frame, "av_frame_alloc failed");
+        param->audio_frame = frame;
+        frame->nb_samples = ctx->frame_size;
+        frame->format = ctx->sample_fmt;
+        frame->sample_rate = ctx->sample_rate;
+        _frame_set_channels(frame, param->audio_channels);
+        err::check_bool_raise(av_frame_get_buffer(frame, 0) >= 0, "av_frame_get_buffer failed");
+
+        param->swr_ctx = _swr_create(param->audio_channels, param->audio_sample_rate, param->audio_format, ctx->sample_rate, ctx->sample_fmt);
+        err::check_null_raise(param->swr_ctx, "create resampler failed");
+        param->audio_fifo = av_audio_fifo_alloc(ctx->sample_fmt, param->audio_channels, ctx->frame_size * 4);
+        err::check_null_raise(param->audio_fifo, "av_audio_fifo_alloc failed");
+        param->audio_last_pts = 0;
+        return err::ERR_NONE;
+    }
+
+    // Send one frame(NULL to flush) and write all available packets, if out is not NULL, append encoded data to it.
+    static int _encoder_write(encoder_param_t *param, AVCodecContext *ctx, AVStream *stream, AVFrame *frame, std::vector<uint8_t> *out) {
+        int ret = avcodec_send_frame(ctx, frame);
+        if (ret < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+        AVPacket *pkt = param->packet_pool->get();
+        while ((ret = avcodec_receive_packet(ctx, pkt)) == 0) {
+            if (out) {
+                out->insert(out->end(), pkt->data, pkt->data + pkt->size);
+            }
+            if (param->outputFormatContext) {
+                pkt->stream_index = stream->index;
+                av_packet_rescale_ts(pkt, ctx->time_base, stream->time_base);
+                if (av_interleaved_write_frame(param->outputFormatContext, pkt) < 0) {
+                    log::error("av_interleaved_write_frame failed");
+                }
+            }
+            av_packet_unref(pkt);
+        }
+        param->packet_pool->put(pkt);
+        return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : ret;
+    }
+
+    static void _encoder_write_pcm(encoder_param_t *param, Bytes *pcm) {
+        AVCodecContext *ctx = param->audio_codec_ctx;
+        int in_samples = pcm->data_len / (param->audio_channels * av_get_bytes_per_sample(param->audio_format));
+        if (!ctx || in_samples <= 0) {
+            return;
+        }
+
+        uint8_t **converted = NULL;
+        int out_samples = swr_get_out_samples(param->swr_ctx, in_samples);
+        if (av_samples_alloc_array_and_samples(&converted, NULL, param->audio_channels, out_samples, ctx->sample_fmt, 0) < 0) {
+            log::error("alloc audio samples failed");
+            return;
+        }
+        const uint8_t *in[] = {pcm->data};
+        int n = swr_convert(param->swr_ctx, converted, out_samples, in, in_samples);
+        if (n > 0) {
+            av_audio_fifo_write(param->audio_fifo, (void **)converted, n);
+        }
+        av_freep(&converted[0]);
+        av_freep(&converted);
+
+        AVFrame *frame = param->audio_frame;
+        while (av_audio_fifo_size(param->audio_fifo) >= ctx->frame_size) {
+            if (av_frame_make_writable(frame) < 0) {
+                break;
+            }
+            av_audio_fifo_read(param->audio_fifo, (void **)frame->data, ctx->frame_size);
+            frame->pts = param->audio_last_pts;
+            param->audio_last_pts += ctx->frame_size;
+            if (_encoder_write(param, ctx, param->audio_stream, frame, NULL) < 0) {
+                log::error("encode audio failed");
+                break;
+            }
+        }
+    }
+
+    // Free param and all its members, members not created yet are NULL,
+    // so it's also used to clean up a partially initialized param when Encoder constructor raises.
+    static void _encoder_param_free(encoder_param_t *param) {
+        if (param->outputFormatContext) {
+            if (param->header_written) {
+                // drain frames delayed by frame threads, then the rest audio samples
+                _encoder_write(param, param->codec_ctx, param->outputStream, NULL, NULL);
+                if (param->audio_codec_ctx) {
+                    _encoder_write(param, param->audio_codec_ctx, param->audio_stream, NULL, NULL);
+                }
+                av_write_trailer(param->outputFormatContext);
+            }
+            if (!(param->outputFormatContext->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&param->outputFormatContext->pb);
+            }
+            avformat_free_context(param->outputFormatContext);
+        }
+        if (param->audio_fifo) {
+            av_audio_fifo_free(param->audio_fifo);
+        }
+        av_frame_free(&param->audio_frame);
+        swr_free(&param->swr_ctx);
+        avcodec_free_context(&param->audio_codec_ctx);
+        av_frame_free(&param->frame);
+        avcodec_free_context(&param->codec_ctx);
+        sws_freeContext(param->scaler.ctx);
+        delete param->packet_pool;
+        free(param);
+    }
+
     Encoder::Encoder(std::string path, int width, int height, image::Format format, VideoType type, int framerate, int gop, int bitrate, int time_base, bool capture, bool block) {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        _path = path;
+        _width = width;
+        _height = height;
+        _format = format;
+        _type = type;
+        _framerate = framerate;
+        _gop = gop;
+        _bitrate = bitrate;
+        _time_base = time_base;
+        _need_capture = capture;
+        _capture_image = NULL;
+        _camera = NULL;
+        _bind_camera = false;
+        _pts = 0;
+        _dts = 0;
+        _start_encode_ms = 0;
+        _encode_started = false;
+        _block = block;
+        _param = NULL;
+
+        av_log_set_callback(custom_log_callback);
+        (void)_image_format_to_ffmpeg(format);
+        video::VideoType video_type = _get_video_type(path.c_str(), type);
+        enum AVCodecID codec_id = _video_type_to_ffmpeg(video_type);
+        const AVCodec *codec = _find_video_encoder(codec_id);
+        err::check_bool_raise(codec != NULL, "Could not find video encoder");
+
+        encoder_param_t *param = (encoder_param_t *)calloc(1, sizeof(encoder_param_t));
+        err::check_null_raise(param, "malloc failed!");
+        param->video_type = video_type;
+        param->last_pts = -1;
+        param->last_encode_ms = time::ticks_ms();
+
+        // destructor is not called if constructor raises, free the partially initialized param before raising
+        try {
+            param->packet_pool = new PacketPool();
+
+            if (_path.size() > 0) {
+                if (avformat_alloc_output_context2(&param->outputFormatContext, NULL, NULL, _path.c_str()) < 0 || !param->outputFormatContext) {
+                    log::error("Count not open file: %s", _path.c_str());
+                    err::check_raise(err::ERR_RUNTIME, "Could not open file");
+                }
+            }
+
+            AVCodecContext *ctx = avcodec_alloc_context3(codec);
+            err::check_null_raise(ctx, "Could not allocate video codec context");
+            param->codec_ctx = ctx;
+            ctx->width = _width;
+            ctx->height = _height;
+            ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+            if (codec->pix_fmts) {
+                ctx->pix_fmt = codec->pix_fmts[0];
+                for (int i = 0; codec->pix_fmts[i] != AV_PIX_FMT_NONE; i ++) {
+                    if (codec->pix_fmts[i] == AV_PIX_FMT_YUV420P) {
+                        ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+                        break;
+                    }
+                }
+            }
+            // pts unit is time_base us, same as get_pts()
+            av_reduce(&ctx->time_base.num, &ctx->time_base.den, _time_base, 1000000, INT_MAX);
+            ctx->framerate = (AVRational){_framerate, 1};
+            ctx->gop_size = _gop;
+            ctx->max_b_frames = 0;                  // pts is always equal to dts
+            ctx->bit_rate = _bitrate;
+            ctx->thread_count = 0;                  // auto, one thread per core
+            if (param->outputFormatContext) {
+                // file has no latency limit, frame threads give the best throughput
+                ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+                if (param->outputFormatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+                    ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+                }
+                av_opt_set(ctx->priv_data, "preset", "veryfast", 0);
+            } else {
+                // raw stream is returned by every encode(), frame threads would delay output, use slice threads only
+                ctx->thread_type = FF_THREAD_SLICE;
+                av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+                av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+            }
+            if (avcodec_open2(ctx, codec, NULL) < 0) {
+                err::check_raise(err::ERR_RUNTIME, std::string("open encoder failed: ") + codec->name);
+            }
+            log::info("video encoder: %s, %d threads", codec->name, ctx->thread_count);
+
+            param->frame = av_frame_alloc();
+            err::check_null_raise(param->frame, "av_frame_alloc failed");
+            param->frame->format = ctx->pix_fmt;
+            param->frame->width = ctx->width;
+            param->frame->height = ctx->height;
+            err::check_bool_raise(av_frame_get_buffer(param->frame, 0) >= 0, "av_frame_get_buffer failed");
+
+            if (param->outputFormatContext) {
+                AVFormatContext *outputFormatContext = param->outputFormatContext;
+                AVStream *outputStream = avformat_new_stream(outputFormatContext, NULL);
+                err::check_null_raise(outputStream, "create new stream failed");
+                outputStream->time_base = ctx->time_base;
+                err::check_bool_raise(avcodec_parameters_from_context(outputStream->codecpar, ctx) >= 0, "avcodec_parameters_from_context failed");
+                param->outputStream = outputStream;
+
+                _encoder_audio_init(param);
+
+                if (!(outputFormatContext->oformat->flags & AVFMT_NOFILE)) {
+                    if (avio_open(&outputFormatContext->pb, _path.c_str(), AVIO_FLAG_WRITE) < 0) {
+                        log::error("Count not open file: %s", _path.c_str());
+                        err::check_raise(err::ERR_RUNTIME, "Could not open file");
+                    }
+                }
+                err::check_bool_raise(avformat_write_header(outputFormatContext, NULL) >= 0, "avformat_write_header failed!");
+                param->header_written = true;
+            }
+        } catch (...) {
+            _encoder_param_free(param);
+            throw;
+        }
+        _param = param;
+    }
+
+    Encoder::~Encoder() {
+        encoder_param_t *param = (encoder_param_t *)_param;
+        if (param) {
+            _encoder_param_free(param);
+            _param = NULL;
+        }
+
+        if (_capture_image) {
+            delete _capture_image;
+            _capture_image = nullptr;
+        }
+    }
+
+    err::Err Encoder::bind_camera(camera::Camera *camera) {
+        this->_camera = camera;
+        this->_bind_camera = camera != NULL;
+        return camera ? err::ERR_NONE : err::ERR_ARGS;
+    }
+
+    video::Frame *Encoder::encode(image::Image *img, Bytes *pcm) {
+        encoder_param_t *param = (encoder_param_t *)_param;
+        AVCodecContext *ctx = param->codec_ctx;
+        std::vector<uint8_t> stream;
+        image::Image *camera_img = NULL;
+        uint64_t pts = 0, dts = 0;
+
+        if (!img || !img->data()) {
+            if (!_bind_camera) {
+                log::warn("You need use bind_camera() function to bind the camera!\r\n");
+                return new video::Frame(NULL, 0, pts, dts, 0, true, false);
+            }
+            camera_img = _camera->read();
+            if (!camera_img) {
+                log::error("read camera image failed!\r\n");
+                return new video::Frame(NULL, 0, pts, dts, 0, true, false);
+            }
+            img = camera_img;
+        }
+
+        if (!_block) {
+            while ((time::ticks_ms() - param->last_encode_ms) * _framerate < 1000) {
+                time::sleep_us(500);
+            }
+        }
+        param->last_encode_ms = time::ticks_ms();
+
+        uint64_t curr_ms = time::ticks_ms();
+        if (!_encode_started) {
+            _encode_started = true;
+            _start_encode_ms = curr_ms;
+        }
+        pts = get_pts(curr_ms - _start_encode_ms);
+        if ((int64_t)pts <= param->last_pts) {
+            pts = param->last_pts + 1;
+        }
+        dts = pts;
+        param->last_pts = pts;
+        _pts = pts;
+        _dts = dts;
+
+        if (_need_capture) {
+            if (_capture_image) {
+                delete _capture_image;
+            }
+            _capture_image = img->copy();
+        }
+
+        // encoder may still hold the last frame with frame threads, get a new buffer in that case
+        AVFrame *frame = param->frame;
+        if (av_frame_make_writable(frame) < 0
+            || _scale(&param->scaler, (const uint8_t *)img->data(), img->width(), img->height(), _image_format_to_ffmpeg(img->format()),
+                      frame->data, frame->linesize, ctx->width, ctx->height, ctx->pix_fmt) < 0) {
+            log::error("convert image to encoder frame failed");
+        } else {
+            frame->pts = pts;
+            if (_encoder_write(param, ctx, param->outputStream, frame, &stream) < 0) {
+                log::error("encode video failed");
+            }
+        }
+
+        if (pcm && pcm->data_len > 0 && param->audio_codec_ctx) {
+            _encoder_write_pcm(param, pcm);
+        }
+
+        if (camera_img) {
+            delete camera_img;
+        }
+
+        uint8_t *stream_buffer = NULL;
+        if (stream.size() > 0) {
+            stream_buffer = (uint8_t *)malloc(stream.size());
+            err::check_null_raise(stream_buffer, "malloc failed!");
+            memcpy(stream_buffer, stream.data(), stream.size());
+        }
+        return new video::Frame(stream_buffer, stream.size(), pts, dts, 0, true, false);
+    }
+
+    typedef struct {
+        AVFormatContext *pFormatContext;
+        PacketPool *packet_pool;
+        bool eof;
+
+        // video
+        int video_stream_index;
+        AVCodecContext *codec_ctx;
+        AVFrame *frame;
+        scaler_t scaler;
+        int64_t seek_pts;               // drop frames before this pts after seek, unit: video stream time base
+        int64_t next_pts;
+
+        // audio, output is S16 48000Hz with the channels of stream
+        int audio_stream_index;
+        AVCodecContext *audio_codec_ctx;
+        AVFrame *audio_frame;
+        SwrContext *swr_ctx;
+        int64_t audio_seek_pts;         // unit: audio stream time base
+        int resample_channels;
+        int resample_sample_rate;
+        enum AVSampleFormat resample_sample_format;
+    } decoder_param_t;
+
+    static AVCodecContext *_open_decoder(AVStream *stream, bool threads) {
+        const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!codec) {
+            log::error("Could not find decoder of %s", avcodec_get_name(stream->codecpar->codec_id));
+            return NULL;
+        }
+        AVCodecContext *ctx = avcodec_alloc_context3(codec);
+        err::check_null_raise(ctx, "Could not allocate a decoding context");
+        if (avcodec_parameters_to_context(ctx, stream->codecpar) < 0) {
+            avcodec_free_context(&ctx);
+            return NULL;
+        }
+        ctx->pkt_timebase = stream->time_base;
+        if (threads) {
+            ctx->thread_count = 0;
+            ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+        if (avcodec_open2(ctx, codec, NULL) < 0) {
+            avcodec_free_context(&ctx);
+            return NULL;
+        }
+        return ctx;
+    }
+
+    // Free param and all its members, members not created yet are NULL,
+    // so it's also used to clean up a partially initialized param when Decoder constructor raises.
+    static void _decoder_param_free(decoder_param_t *param) {
+        avcodec_free_context(&param->codec_ctx);
+        av_frame_free(&param->frame);
+        sws_freeContext(param->scaler.ctx);
+        avcodec_free_context(&param->audio_codec_ctx);
+        av_frame_free(&param->audio_frame);
+        swr_free(&param->swr_ctx);
+        avformat_close_input(&param->pFormatContext);
+        delete param->packet_pool;
+        free(param);
+    }
+
+    Decoder::Decoder(std::string path, image::Format format) {
+        av_log_set_callback(custom_log_callback);
+        (void)_image_format_to_ffmpeg(format);
+        _path = path;
+        _format_out = format;
+        _width = 0;
+        _height = 0;
+        _bitrate = 0;
+        _fps = 0;
+        _has_audio = false;
+        _has_video = false;
+        _last_pts = 0;
+        _audio_sample_rate = 0;
+        _audio_format = audio::FMT_NONE;
+        _audio_channels = 0;
+
+        AVFormatContext *pFormatContext = NULL;
+        if (avformat_open_input(&pFormatContext, _path.c_str(), NULL, NULL) < 0) {
+            log::error("Could not open file: %s", _path.c_str());
+            err::check_raise(err::ERR_RUNTIME, "Could not open file");
+        }
+        if (avformat_find_stream_info(pFormatContext, NULL) < 0) {
+            avformat_close_input(&pFormatContext);
+            err::check_raise(err::ERR_RUNTIME, "Could not find stream information");
+        }
+
+        decoder_param_t *param = (decoder_param_t *)calloc(1, sizeof(decoder_param_t));
+        if (!param) {
+            avformat_close_input(&pFormatContext);
+            err::check_raise(err::ERR_NO_MEM, "malloc failed!");
+        }
+        param->pFormatContext = pFormatContext;
+        param->seek_pts = AV_NOPTS_VALUE;
+        param->audio_seek_pts = AV_NOPTS_VALUE;
+
+        // destructor is not called if constructor raises, free the partially initialized param before raising
+        try {
+            param->packet_pool = new PacketPool();
+
+            int video_stream_index = av_find_best_stream(pFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+            param->video_stream_index = video_stream_index;
+            if (video_stream_index >= 0) {
+                AVStream *video_stream = pFormatContext->streams[video_stream_index];
+                param->codec_ctx = _open_decoder(video_stream, true);
+                err::check_null_raise(param->codec_ctx, "open video decoder failed");
+                param->frame = av_frame_alloc();
+                err::check_null_raise(param->frame, "av_frame_alloc failed");
+                _has_video = true;
+                _width = video_stream->codecpar->width;
+                _height = video_stream->codecpar->height;
+                _bitrate = video_stream->codecpar->bit_rate ? video_stream->codecpar->bit_rate : pFormatContext->bit_rate;
+                _fps = av_q2d(av_guess_frame_rate(pFormatContext, video_stream, NULL));
+                _timebase = {video_stream->time_base.num, video_stream->time_base.den};
+                param->next_pts = video_stream->start_time != AV_NOPTS_VALUE ? video_stream->start_time : 0;
+            }
+
+            int audio_stream_index = av_find_best_stream(pFormatContext, AVMEDIA_TYPE_AUDIO, -1, -1, NULL, 0);
+            param->audio_stream_index = audio_stream_index;
+            if (audio_stream_index >= 0) {
+                AVCodecContext *audio_codec_ctx = _open_decoder(pFormatContext->streams[audio_stream_index], false);
+                if (audio_codec_ctx) {
+                    param->audio_codec_ctx = audio_codec_ctx;
+                    param->resample_channels = _codec_channels(audio_codec_ctx);
+                    param->resample_sample_rate = 48000;
+                    param->resample_sample_format = AV_SAMPLE_FMT_S16;
+                    param->swr_ctx = _swr_create(param->resample_channels, audio_codec_ctx->sample_rate, audio_codec_ctx->sample_fmt,
+                                                 param->resample_sample_rate, param->resample_sample_format);
+                    err::check_null_raise(param->swr_ctx, "Could not allocate resampler context");
+                    param->audio_frame = av_frame_alloc();
+                    err::check_null_raise(param->audio_frame, "Could not allocate audio frame");
+                    _has_audio = true;
+                    _audio_channels = param->resample_channels;
+                    _audio_sample_rate = param->resample_sample_rate;
+                    _audio_format = _audio_format_from_alsa(param->resample_sample_format);
+                } else {
+                    param->audio_stream_index = -1;
+                }
+            }
+            err::check_bool_raise(_has_video || _has_audio, "No video or audio stream found");
+        } catch (...) {
+            _decoder_param_free(param);
+            throw;
+        }
+        _param = param;
+    }
+
+    Decoder::~Decoder() {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (param) {
+            _decoder_param_free(param);
+            _param = NULL;
+        }
+    }
+
+    static image::Image *_frame_to_image(decoder_param_t *param, AVFrame *frame, image::Format format_out) {
+        image::Image *img = new image::Image(frame->width, frame->height, format_out);
+        err::check_null_raise(img, "create image failed");
+        enum AVPixelFormat dst_fmt = _image_format_to_ffmpeg(format_out);
+        if (format_out == image::Format::FMT_GRAYSCALE
+            && (frame->format == AV_PIX_FMT_YUV420P || frame->format == AV_PIX_FMT_YUVJ420P || frame->format == AV_PIX_FMT_NV12)) {
+            // Y plane is the grayscale image
+            uint8_t *dst = (uint8_t *)img->data();
+            for (int h = 0; h < frame->height; h ++) {
+                memcpy(dst + h * frame->width, frame->data[0] + h * frame->linesize[0], frame->width);
+            }
+            return img;
+        }
+        uint8_t *dst_data[4];
+        int dst_linesize[4];
+        av_image_fill_arrays(dst_data, dst_linesize, (uint8_t *)img->data(), dst_fmt, frame->width, frame->height, 1);
+        if (!param->scaler.ctx || param->scaler.src_w != frame->width || param->scaler.src_h != frame->height
+            || param->scaler.src_fmt != frame->format || param->scaler.dst_fmt != dst_fmt) {
+            sws_freeContext(param->scaler.ctx);
+            param->scaler.ctx = sws_getContext(frame->width, frame->height, (enum AVPixelFormat)frame->format,
+                                               frame->width, frame->height, dst_fmt, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+            err::check_null_raise(param->scaler.ctx, "sws_getContext failed");
+            param->scaler.src_w = param->scaler.dst_w = frame->width;
+            param->scaler.src_h = param->scaler.dst_h = frame->height;
+            param->scaler.src_fmt = (enum AVPixelFormat)frame->format;
+            param->scaler.dst_fmt = dst_fmt;
+        }
+        sws_scale(param->scaler.ctx, frame->data, frame->linesize, 0, frame->height, dst_data, dst_linesize);
+        return img;
+    }
+
+    // Receive one decoded video frame, frames before seek target are dropped.
+    // Return 0 if got frame, AVERROR(EAGAIN) if need more packets, AVERROR_EOF if end.
+    static int _receive_video(decoder_param_t *param) {
+        int ret;
+        while ((ret = avcodec_receive_frame(param->codec_ctx, param->frame)) == 0) {
+            int64_t pts = param->frame->best_effort_timestamp;
+            if (param->seek_pts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE && pts + std::max<int64_t>(_frame_duration(param->frame), 1) <= param->seek_pts) {
+                av_frame_unref(param->frame);
+                continue;
+            }
+            param->seek_pts = AV_NOPTS_VALUE;
+            return 0;
+        }
+        return ret;
+    }
+
+    static video::Context *_video_context(decoder_param_t *param, image::Format format_out, uint64_t *last_pts) {
+        AVFrame *frame = param->frame;
+        AVStream *stream = param->pFormatContext->streams[param->video_stream_index];
+        int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : param->next_pts;
+        int64_t duration = _frame_duration(frame);
+        if (duration <= 0) {
+            AVRational frame_rate = av_guess_frame_rate(param->pFormatContext, stream, NULL);
+            duration = frame_rate.num ? av_rescale_q(1, av_inv_q(frame_rate), stream->time_base) : 0;
+        }
+        image::Image *img = _frame_to_image(param, frame, format_out);
+        av_frame_unref(frame);
+
+        video::Context *context = new video::Context(MEDIA_TYPE_VIDEO, {stream->time_base.num, stream->time_base.den});
+        context->set_image(img, duration, pts, *last_pts);
+        *last_pts = pts;
+        param->next_pts = pts + duration;
+        return context;
+    }
+
+    static video::Context *_decode_audio_packet(decoder_param_t *param, AVPacket *pkt) {
+        AVCodecContext *ctx = param->audio_codec_ctx;
+        AVFrame *frame = param->audio_frame;
+        AVStream *stream = param->pFormatContext->streams[param->audio_stream_index];
+        if (avcodec_send_packet(ctx, pkt) < 0) {
+            return NULL;
+        }
+
+        std::vector<uint8_t> pcm;
+        int64_t first_pts = AV_NOPTS_VALUE;
+        int bytes_per_sample = param->resample_channels * av_get_bytes_per_sample(param->resample_sample_format);
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            int64_t pts = frame->best_effort_timestamp;
+            if (param->audio_seek_pts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE
+                && pts + av_rescale_q(frame->nb_samples, (AVRational){1, ctx->sample_rate}, stream->time_base) <= param->audio_seek_pts) {
+                av_frame_unref(frame);
+                continue;
+            }
+            param->audio_seek_pts = AV_NOPTS_VALUE;
+            if (first_pts == AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE) {
+                first_pts = av_rescale_q(pts, stream->time_base, (AVRational){1, param->resample_sample_rate});
+            }
+            int out_samples = swr_get_out_samples(param->swr_ctx, frame->nb_samples);
+            size_t offset = pcm.size();
+            pcm.resize(offset + (size_t)out_samples * bytes_per_sample);
+            uint8_t *out[] = {pcm.data() + offset};
+            int converted = swr_convert(param->swr_ctx, out, out_samples, (const uint8_t **)frame->extended_data, frame->nb_samples);
+            pcm.resize(offset + (size_t)(converted > 0 ? converted : 0) * bytes_per_sample);
+            av_frame_unref(frame);
+        }
+        if (pcm.empty()) {
+            return NULL;
+        }
+
+        std::vector<int> timebase = {1, param->resample_sample_rate};
+        video::Context *context = new video::Context(MEDIA_TYPE_AUDIO, timebase, param->resample_sample_rate,
+                                                     _audio_format_from_alsa(param->resample_sample_format), param->resample_channels);
+        Bytes data(pcm.data(), pcm.size());
+        context->set_pcm(&data, pcm.size() / bytes_per_sample, first_pts == AV_NOPTS_VALUE ? 0 : first_pts);
+        return context;
+    }
+
+    // Read packets until a context of wanted media is ready.
+    static video::Context *_decode(decoder_param_t *param, bool want_video, bool want_audio, bool block, image::Format format_out, uint64_t *last_pts) {
+        while (true) {
+            if (want_video && param->codec_ctx) {
+                int ret = _receive_video(param);
+                if (ret == 0) {
+                    return _video_context(param, format_out, last_pts);
+                } else if (ret == AVERROR_EOF) {
+                    if (!want_audio || param->eof) {
+                        return NULL;
+                    }
+                } else if (ret != AVERROR(EAGAIN)) {
+                    log::error("decode video failed, ret:%d", ret);
+                    return NULL;
+                }
+            }
+            if (param->eof) {
+                return NULL;
+            }
+
+            AVPacket *pkt = param->packet_pool->get();
+            int ret = av_read_frame(param->pFormatContext, pkt);
+            if (ret < 0) {
+                // send flush packet, the rest frames in decoder will be received at next loop
+                param->eof = true;
+                param->packet_pool->put(pkt);
+                if (param->codec_ctx) {
+                    avcodec_send_packet(param->codec_ctx, NULL);
+                }
+                if (!want_video) {
+                    return NULL;
+                }
+                continue;
+            }
+
+            video::Context *context = NULL;
+            bool sent_video = false;
+            if (pkt->stream_index == param->video_stream_index && param->codec_ctx) {
+                if (want_video) {
+                    if (avcodec_send_packet(param->codec_ctx, pkt) < 0) {
+                        log::warn("send video packet failed");
+                    }
+                    sent_video = true;
+                }
+            } else if (pkt->stream_index == param->audio_stream_index && want_audio) {
+                context = _decode_audio_packet(param, pkt);
+            }
+            param->packet_pool->put(pkt);
+            if (context) {
+                return context;
+            }
+            if (sent_video && !block) {
+                int ret = _receive_video(param);
+                if (ret == 0) {
+                    return _video_context(param, format_out, last_pts);
+                }
+                std::vector<int> timebase = {param->pFormatContext->streams[param->video_stream_index]->time_base.num,
+                                             param->pFormatContext->streams[param->video_stream_index]->time_base.den};
+                return new video::Context(MEDIA_TYPE_UNKNOWN, timebase);
+            }
+        }
+    }
+
+    video::Context *Decoder::decode_video(bool block) {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (!param->codec_ctx) {
+            return NULL;
+        }
+        return _decode(param, true, false, block, _format_out, &_last_pts);
+    }
+
+    video::Context *Decoder::decode_audio() {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        if (!param->audio_codec_ctx) {
+            return NULL;
+        }
+        return _decode(param, false, true, true, _format_out, &_last_pts);
+    }
+
+    video::Context *Decoder::decode(bool block) {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        return _decode(param, param->codec_ctx != NULL, param->audio_codec_ctx != NULL, block, _format_out, &_last_pts);
+    }
+
+    double Decoder::seek(double time) {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        AVFormatContext *pFormatContext = param->pFormatContext;
+        int stream_index = param->video_stream_index >= 0 ? param->video_stream_index : param->audio_stream_index;
+        AVStream *stream = pFormatContext->streams[stream_index];
+        int64_t start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+        if (time < 0) {
+            return (param->next_pts - start_time) * av_q2d(stream->time_base);
+        }
+
+        // seek to the key frame before target, then decode and drop frames until target, so the position is frame accurate
+        int64_t seek_target = av_rescale_q((int64_t)(time * AV_TIME_BASE), AV_TIME_BASE_Q, stream->time_base) + start_time;
+        int ret = av_seek_frame(pFormatContext, stream_index, seek_target, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            log::error("av_seek_frame failed, ret:%d", ret);
+            return -1;
+        }
+        if (param->codec_ctx) {
+            avcodec_flush_buffers(param->codec_ctx);
+            param->seek_pts = seek_target;
+            param->next_pts = seek_target;
+        }
+        if (param->audio_codec_ctx) {
+            avcodec_flush_buffers(param->audio_codec_ctx);
+            param->audio_seek_pts = av_rescale_q(seek_target, stream->time_base, pFormatContext->streams[param->audio_stream_index]->time_base);
+            if (!param->codec_ctx) {
+                param->next_pts = seek_target;
+            }
+        }
+        param->eof = false;
+        _last_pts = 0;
+        return time;
+    }
+
+    double Decoder::duration() {
+        decoder_param_t *param = (decoder_param_t *)_param;
+        AVFormatContext *pFormatContext = param->pFormatContext;
+        if (pFormatContext->duration == AV_NOPTS_VALUE || pFormatContext->duration < 0) {
+            return 0;
+        }
+        return (double)pFormatContext->duration / AV_TIME_BASE;
+    }
+#else
+    // built without FFmpeg(not found on host), see components/3rd_party/FFmpeg/CMakeLists.txt
+    Encoder::Encoder(std::string path, int width, int height, image::Format format, VideoType type, int framerate, int gop, int bitrate, int time_base, bool capture, bool block) {
+        throw err::Exception(err::ERR_NOT_IMPL, "video encoder needs FFmpeg, install libavcodec-dev libavformat-dev libswscale-dev libswresample-dev and rebuild");
     }
 
     Encoder::~Encoder() {
-        throw err::Exception(err::ERR_NOT_IMPL);
     }
 
     err::Err Encoder::bind_camera(camera::Camera *camera) {
         (void)camera;
-        throw err::Exception(err::ERR_NOT_IMPL);
         return err::ERR_NOT_IMPL;
     }
 
     video::Frame *Encoder::encode(image::Image *img, Bytes *pcm) {
         (void)img;
         (void)pcm;
-        throw err::Exception(err::ERR_NOT_IMPL);
         return nullptr;
     }
 
     Decoder::Decoder(std::string path, image::Format format) {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        throw err::Exception(err::ERR_NOT_IMPL, "video decoder needs FFmpeg, install libavcodec-dev libavformat-dev libswscale-dev libswresample-dev and rebuild");
     }
 
     Decoder::~Decoder() {
-        throw err::Exception(err::ERR_NOT_IMPL);
     }
 
     video::Context *Decoder::decode_video(bool block) {
+        (void)block;
         return NULL;
     }
 
@@ -75,14 +1110,14 @@ namespace maix::video
     }
 
     double Decoder::seek(double time) {
-        throw err::Exception(err::ERR_NOT_IMPL);
+        (void)time;
         return 0;
     }
 
     double Decoder::duration() {
-        throw err::Exception(err::ERR_NOT_IMPL);
         return 0;
     }
+#endif
 
     Video::Video(std::string path, int width, int height, image::Format format, int time_base, int framerate, bool capture, bool open)
     {
@@ -138,159 +1173,514 @@ namespace maix::video
         return err::ERR_NOT_IMPL;
     }
 
+    class rect_info {
+    public:
+        int x;
+        int y;
+        int w;
+        int h;
+        image::Color color = image::Color(255);
+        int thickness;
+        bool show = false;
+    };
+
+    typedef struct {
+        std::recursive_timed_mutex lock;
+        std::thread *thread;
+        bool thread_exit_flag;
+        std::string path;
+        bool snapshot_en;
+        std::vector<int> snapshot_res;
+        image::Format snapshot_fmt;
+        image::Image *last_img;         // last camera image, for snapshot
+        Encoder *encoder;               // not NULL if recording
+        uint64_t record_start_ms;
+        int64_t seek_ms;
+
+        struct {
+            int fps;
+            int bitrate;
+            std::vector<int> resolution;
+        } venc;
+
+        camera::Camera *camera;
+
+        struct {
+            display::Display *obj;
+            image::Fit fit;
+        } display;
+
+        struct {
+            audio::Recorder *obj;
+            bool mute;
+        } audio;
+
+        std::vector<rect_info> rect;
+    } video_recoder_param_t;
+
+    static void _video_recoder_config_default(video_recoder_param_t *param)
+    {
+        param->venc.bitrate = 3000000;
+        param->venc.fps = 30;
+        param->venc.resolution.clear();
+        param->seek_ms = 0;
+        param->snapshot_en = false;
+        param->snapshot_res.clear();
+        param->snapshot_fmt = image::Format::FMT_YVU420SP;
+        param->audio.mute = false;
+        param->rect.clear();
+        param->rect.resize(16);
+    }
+
+    static void _record_thread_handle(VideoRecorder *me, video_recoder_param_t *param)
+    {
+        while (!app::need_exit()) {
+            me->lock();
+            if (param->thread_exit_flag) {
+                me->unlock();
+                break;
+            }
+            camera::Camera *cam = param->camera;
+            me->unlock();
+
+            if (!cam) {
+                time::sleep_ms(10);
+                continue;
+            }
+            // read out of lock, api won't be blocked by camera
+            image::Image *img = NULL;
+            try {
+                img = cam->read();
+            } catch (std::exception &e) {
+                log::error("read camera failed: %s", e.what());
+            }
+            if (!img) {
+                time::sleep_ms(10);
+                continue;
+            }
+
+            me->lock();
+            for (auto &r : param->rect) {
+                if (r.show) {
+                    img->draw_rect(r.x, r.y, r.w, r.h, r.color, r.thickness);
+                }
+            }
+            if (param->encoder) {
+                Bytes *pcm = NULL;
+                if (param->audio.obj) {
+                    pcm = param->audio.obj->record();
+                    if (pcm && param->audio.mute) {
+                        memset(pcm->data, 0, pcm->data_len);
+                    }
+                }
+                video::Frame *frame = param->encoder->encode(img, pcm);
+                delete frame;
+                if (pcm) {
+                    delete pcm;
+                }
+                param->seek_ms = time::ticks_ms() - param->record_start_ms;
+            }
+            display::Display *disp = param->display.obj;
+            image::Fit fit = param->display.fit;
+            if (disp) {
+                disp->show(*img, fit);
+            }
+            if (param->snapshot_en) {
+                std::swap(param->last_img, img);
+            }
+            me->unlock();
+            if (img) {
+                delete img;
+            }
+        }
+    }
+
     VideoRecorder::VideoRecorder(bool open)
     {
-        (void)open;
+        video_recoder_param_t *param = new video_recoder_param_t();
+        err::check_null_raise(param, "malloc param failed");
+        param->thread = NULL;
+        param->last_img = NULL;
+        param->encoder = NULL;
+        param->camera = NULL;
+        param->display.obj = NULL;
+        param->display.fit = image::FIT_COVER;
+        param->audio.obj = NULL;
+        _video_recoder_config_default(param);
+
+        _is_opened = false;
+        _param = param;
+
+        if (open) {
+            this->open();
+        }
     }
 
     VideoRecorder::~VideoRecorder()
     {
+        close();
+
+        if (_param) {
+            video_recoder_param_t *param = (video_recoder_param_t *)_param;
+            delete param;
+            _param = nullptr;
+        }
     }
 
     err::Err VideoRecorder::open()
     {
-        return err::ERR_NOT_IMPL;
+        if (_is_opened)
+            return err::ERR_NONE;
+
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->thread_exit_flag = false;
+        param->thread = new std::thread(_record_thread_handle, this, param);
+        _is_opened = true;
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::close()
     {
-        return err::ERR_NOT_IMPL;
+        if (!_is_opened)
+            return err::ERR_NONE;
+
+        reset();
+
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        lock();
+        param->thread_exit_flag = true;
+        unlock();
+
+        param->thread->join();
+        delete param->thread;
+        param->thread = NULL;
+        if (param->last_img) {
+            delete param->last_img;
+            param->last_img = NULL;
+        }
+        _is_opened = false;
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::lock(int64_t timeout)
     {
-        (void)timeout;
-        return err::ERR_NOT_IMPL;
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (timeout < 0) {
+            param->lock.lock();
+            return err::ERR_NONE;
+        }
+        return param->lock.try_lock_for(std::chrono::milliseconds(timeout)) ? err::ERR_NONE : err::ERR_TIMEOUT;
     }
 
     err::Err VideoRecorder::unlock()
     {
-        return err::ERR_NOT_IMPL;
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->lock.unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::bind_display(display::Display *display, image::Fit fit)
     {
-        (void)display;
-        (void)fit;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->display.obj = display;
+        param->display.fit = fit;
+        unlock();
+        return display ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_camera(camera::Camera *camera)
     {
-        (void)camera;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->camera = camera;
+        unlock();
+        return camera ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_audio(audio::Recorder *audio)
     {
-        (void)audio;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        param->audio.obj = audio;
+        unlock();
+        return audio ? err::ERR_NONE : err::ERR_ARGS;
     }
 
     err::Err VideoRecorder::bind_imu(void *imu)
     {
         (void)imu;
+        err::check_raise(err::Err::ERR_NOT_IMPL, "Not supported");
         return err::ERR_NOT_IMPL;
     }
 
     err::Err VideoRecorder::reset()
     {
-        return err::ERR_NOT_IMPL;
+        record_finish();
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        _video_recoder_config_default(param);
+        unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::config_path(std::string path)
     {
-        (void)path;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->path = path;
+        unlock();
+        return err::ERR_NONE;
     }
 
     std::string VideoRecorder::get_path()
     {
-        return "";
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        std::string path = param->path;
+        unlock();
+        return path;
     }
 
     err::Err VideoRecorder::config_snapshot(bool enable, std::vector<int> resolution, image::Format format)
     {
-        (void)enable;
-        (void)resolution;
-        (void)format;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->snapshot_en = enable;
+        param->snapshot_res = resolution;
+        param->snapshot_fmt = format;
+        if (!enable && param->last_img) {
+            delete param->last_img;
+            param->last_img = NULL;
+        }
+        unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::config_resolution(std::vector<int> resolution)
     {
-        (void)resolution;
-        return err::ERR_NOT_IMPL;
+        if (resolution.size() < 2) return err::ERR_ARGS;
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        camera::Camera *cam = param->camera;
+        if (!cam) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+
+        cam->set_resolution(resolution[0], resolution[1]);
+        param->venc.resolution = resolution;
+        unlock();
+        return err::ERR_NONE;
     }
 
     std::vector<int> VideoRecorder::get_resolution()
     {
-        return {};
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        std::vector<int> resolution = param->venc.resolution;
+        if (resolution.size() == 0 && param->camera) {
+            resolution = {param->camera->width(), param->camera->height()};
+        }
+        unlock();
+
+        err::check_bool_raise(resolution.size() == 2, "You need config resolution!");
+        return resolution;
     }
 
     err::Err VideoRecorder::config_fps(int fps)
     {
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->venc.fps = fps;
+        unlock();
+        return err::ERR_NONE;
     }
 
     int VideoRecorder::get_fps()
     {
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int fps = param->venc.fps;
+        unlock();
+        return fps;
     }
 
     err::Err VideoRecorder::config_bitrate(int bitrate)
     {
-        (void)bitrate;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+
+        param->venc.bitrate = bitrate;
+        unlock();
+        return err::ERR_NONE;
     }
 
     int VideoRecorder::get_bitrate()
     {
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int bitrate = param->venc.bitrate;
+        unlock();
+        return bitrate;
     }
 
     int VideoRecorder::mute(int data)
     {
-        (void)data;
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (data >= 0) {
+            param->audio.mute = data != 0;
+        }
+        int current_mute = param->audio.mute;
+        unlock();
+
+        return current_mute;
     }
 
     int VideoRecorder::volume(int data)
     {
-        (void)data;
-        return 0;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        int current_volume = 0;
+        if (param->audio.obj) {
+            if (data >= 0) {
+                data = data >= 100 ? 100 : data;
+            }
+            current_volume = param->audio.obj->volume(data);
+        }
+        unlock();
+
+        return current_volume;
     }
 
     int64_t VideoRecorder::seek()
     {
-        return 0;
+        // Only read param, so don't lock
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        return param->seek_ms;
     }
 
     err::Err VideoRecorder::record_start()
     {
-        return err::ERR_NOT_IMPL;
+        auto resolution = this->get_resolution();
+
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            unlock();
+            return err::ERR_BUSY;
+        }
+        if (!param->camera) {
+            unlock();
+            log::error("You must use the bind_camera interface to bind a Camera object.");
+            return err::ERR_RUNTIME;
+        }
+        if (param->path.size() == 0) {
+            unlock();
+            log::error("You must use the config_path interface to config the path of video.");
+            return err::ERR_ARGS;
+        }
+
+        try {
+            int fps = param->venc.fps;
+            param->encoder = new Encoder(param->path, resolution[0], resolution[1], param->camera->format(), VIDEO_H264,
+                                         fps, fps * 2, param->venc.bitrate, 1000, false, true);
+        } catch (std::exception &e) {
+            unlock();
+            log::error("create encoder failed: %s", e.what());
+            return err::ERR_RUNTIME;
+        }
+        if (param->audio.obj) {
+            param->audio.obj->reset(true);
+        }
+        param->record_start_ms = time::ticks_ms();
+        param->seek_ms = 0;
+        unlock();
+        return err::ERR_NONE;
     }
 
     image::Image *VideoRecorder::snapshot()
     {
-        return NULL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        image::Image *new_image = NULL;
+        if (param->snapshot_en && param->last_img) {
+            image::Image *img = param->last_img;
+            if (param->snapshot_res.size() >= 2
+                && (param->snapshot_res[0] != img->width() || param->snapshot_res[1] != img->height())) {
+                new_image = img->resize(param->snapshot_res[0], param->snapshot_res[1]);
+            } else {
+                new_image = img->copy();
+            }
+            if (new_image->format() != param->snapshot_fmt) {
+                image::Image *tmp = new_image->to_format(param->snapshot_fmt);
+                delete new_image;
+                new_image = tmp;
+            }
+        }
+        unlock();
+        return new_image;
     }
 
     err::Err VideoRecorder::record_finish()
     {
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (param->encoder) {
+            // destructor drains encoder and writes trailer
+            delete param->encoder;
+            param->encoder = NULL;
+        }
+        unlock();
+        return err::ERR_NONE;
     }
 
     err::Err VideoRecorder::draw_rect(int id, int x, int y, int w, int h, image::Color color, int thickness, bool hidden)
     {
-        (void)id;
-        (void)x;
-        (void)y;
-        (void)w;
-        (void)h;
-        (void)color;
-        (void)thickness;
-        (void)hidden;
-        return err::ERR_NOT_IMPL;
+        lock();
+        video_recoder_param_t *param = (video_recoder_param_t *)_param;
+        if (id < 0 || id >= (int)param->rect.size()) {
+            unlock();
+            log::error("draw_rect id %d out of range", id);
+            return err::ERR_ARGS;
+        }
+
+        param->rect[id].x = x;
+        param->rect[id].y = y;
+        param->rect[id].w = w;
+        param->rect[id].h = h;
+        param->rect[id].color = color;
+        param->rect[id].thickness = thickness;
+        param->rect[id].show = !hidden;
+        unlock();
+        return err::ERR_NONE;
     }
 } // namespace maix::video
@@ -0,0 +1,589 @@
+/**
+ * @author lxowalle@sipeed
+ * @copyright Sipeed Ltd 2023-
+ * @license Apache 2.0
+ * @update 2024.5.17: Add framework, create this file.
+ * @update 2026.10.18: Rewrite with one epoll event loop, shared refcounted frames, used by all linux platforms.
+ */
+
+#include "maix_jpg_stream.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define BOUNDARY "frame"
+#define MAX_REQUEST_SIZE 8192
+#define EPOLL_EVENTS_NUM 64
+
+namespace maix::http
+{
+    static const char *default_index_str =
+    "<html>\n"
+    "<body>\n"
+    "<h1>JPG Stream</h1>\n"
+    "<img src='/stream'>\n"
+    "</body>\n"
+    "</html>";
+
+    static const char *stream_header_str =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=" BOUNDARY "\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+    static const char *busy_str =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+    /**
+     * One encoded frame, immutable after created, shared by all clients.
+     * part = header + jpeg + "\r\n"
+     */
+    class _Frame
+    {
+    public:
+        _Frame(image::Image *jpg, bool owned)
+        {
+            if (owned)
+            {
+                _jpg = jpg;
+                data = (const uint8_t *)jpg->data();
+            }
+            else
+            {
+                _copy.assign((const uint8_t *)jpg->data(), (const uint8_t *)jpg->data() + jpg->data_size());
+                data = _copy.data();
+            }
+            size = jpg->data_size();
+            header_len = snprintf(header, sizeof(header), "--" BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %d\r\n\r\n", (int)size);
+        }
+
+        ~_Frame()
+        {
+            delete _jpg;
+        }
+
+        size_t total() const
+        {
+            return header_len + size + 2;
+        }
+
+        char header[96];
+        int header_len;
+        const uint8_t *data;
+        size_t size;
+
+    private:
+        image::Image *_jpg = nullptr;
+        std::vector<uint8_t> _copy;
+    };
+
+    typedef std::shared_ptr<const _Frame> _FramePtr;
+
+    enum _ClientState
+    {
+        CLIENT_REQUEST = 0, // reading request
+        CLIENT_RESPONSE,    // sending page, then read next request
+        CLIENT_STREAM,      // sending frames
+    };
+
+    class _Client
+    {
+    public:
+        int fd;
+        _ClientState state = CLIENT_REQUEST;
+        std::string in;
+        std::string out;      // response or stream header not sent
+        size_t out_pos = 0;
+        bool close_after = false;
+        _FramePtr cur;        // frame sending
+        size_t cur_pos = 0;   // sent bytes of cur->total()
+        _FramePtr next;       // latest frame waiting, replaced if client is slow
+    };
+
+    class _Server
+    {
+    public:
+        int listen_fd = -1;
+        int epoll_fd = -1;
+        int event_fd = -1;
+        int max_clients;
+        std::thread thread;
+        bool running = false;
+        std::atomic<bool> exit{false};
+        std::atomic<int> streaming{0};
+        uint64_t dropped = 0;
+
+        // shared with write thread
+        std::mutex lock;
+        _FramePtr latest;
+        uint64_t latest_seq = 0;
+        std::string html = default_index_str;
+
+        // used only in loop thread
+        std::unordered_map<int, _Client *> clients;
+        uint64_t sent_seq = 0;
+
+        void notify()
+        {
+            uint64_t v = 1;
+            ssize_t res = ::write(event_fd, &v, sizeof(v));
+            (void)res;
+        }
+
+        void loop()
+        {
+            struct epoll_event events[EPOLL_EVENTS_NUM];
+            while (!exit)
+            {
+                int n = epoll_wait(epoll_fd, events, EPOLL_EVENTS_NUM, 1000);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    log::error("epoll_wait failed: %s", strerror(errno));
+                    break;
+                }
+                for (int i = 0; i < n && !exit; ++i)
+                {
+                    int fd = events[i].data.fd;
+                    if (fd == listen_fd)
+                        on_accept();
+                    else if (fd == event_fd)
+                    {
+                        uint64_t v;
+                        ssize_t res = ::read(event_fd, &v, sizeof(v));
+                        (void)res;
+                        on_frame();
+                    }
+                    else
+                    {
+                        auto it = clients.find(fd);
+                        if (it == clients.end())
+                            continue;
+                        _Client *c = it->second;
+                        uint32_t ev = events[i].events;
+                        bool ok = !(ev & EPOLLERR);
+                        if (ok && (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+                            ok = on_read(c);
+                        if (ok)
+                            ok = flush(c);
+                        if (!ok)
+                            close_client(c);
+                    }
+                }
+            }
+            while (!clients.empty())
+                close_client(clients.begin()->second);
+        }
+
+        void on_accept()
+        {
+            while (1)
+            {
+                int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                        log::error("accept failed: %s", strerror(errno));
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                if ((int)clients.size() >= max_clients)
+                {
+                    log::warn("can not accept more client, max: %d", max_clients);
+                    ssize_t res = send(fd, busy_str, strlen(busy_str), MSG_NOSIGNAL | MSG_DONTWAIT);
+                    (void)res;
+                    ::close(fd);
+                    continue;
+                }
+                _Client *c = new _Client();
+                c->fd = fd;
+                struct epoll_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                ev.data.fd = fd;
+                if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+                {
+                    log::error("epoll add client failed: %s", strerror(errno));
+                    ::close(fd);
+                    delete c;
+                    continue;
+                }
+                clients[fd] = c;
+            }
+        }
+
+        void close_client(_Client *c)
+        {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+            ::close(c->fd);
+            clients.erase(c->fd);
+            if (c->state == CLIENT_STREAM && --streaming == 0)
+            {
+                // write() stops encoding, drop old frame so next client not get a stale one
+                std::lock_guard<std::mutex> guard(lock);
+                latest.reset();
+            }
+            delete c;
+        }
+
+        // new frame written, give it to every stream client, slow clients keep only the latest one
+        void on_frame()
+        {
+            _FramePtr frame;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (latest_seq == sent_seq)
+                    return;
+                sent_seq = latest_seq;
+                frame = latest;
+            }
+            if (!frame)
+                return;
+            std::vector<_Client *> closed;
+            for (auto &it : clients)
+            {
+                _Client *c = it.second;
+                if (c->state != CLIENT_STREAM)
+                    continue;
+                if (c->cur)
+                {
+                    if (c->next)
+                        ++dropped;
+                    c->next = frame;
+                    continue;
+                }
+                c->cur = frame;
+                c->cur_pos = 0;
+                if (!flush(c))
+                    closed.push_back(c);
+            }
+            for (auto c : closed)
+                close_client(c);
+        }
+
+        // read until EAGAIN, return false if client should be closed
+        bool on_read(_Client *c)
+        {
+            char buff[1024];
+            while (1)
+            {
+                ssize_t n = recv(c->fd, buff, sizeof(buff), 0);
+                if (n == 0)
+                    return false;
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                if (c->state == CLIENT_STREAM)
+                    continue; // not expect more request
+                c->in.append(buff, n);
+                if (c->in.size() > MAX_REQUEST_SIZE)
+                    return false;
+                if (c->state == CLIENT_REQUEST && !on_request(c))
+                    return false;
+            }
+        }
+
+        bool on_request(_Client *c)
+        {
+            size_t end = c->in.find("\r\n\r\n");
+            if (end == std::string::npos)
+                return true;
+            std::string request = c->in.substr(0, end);
+            c->in.erase(0, end + 4);
+            if (request.compare(0, 11, "GET /stream") == 0)
+            {
+                c->out = stream_header_str;
+                c->out_pos = 0;
+                c->state = CLIENT_STREAM;
+                c->in.clear();
+                ++streaming;
+                std::lock_guard<std::mutex> guard(lock);
+                c->cur = latest;
+                c->cur_pos = 0;
+            }
+            else if (request.compare(0, 4, "GET ") == 0)
+            {
+                std::string body;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    body = html;
+                }
+                c->out = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+                c->out_pos = 0;
+                c->state = CLIENT_RESPONSE;
+            }
+            else
+            {
+                c->out = "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                c->out_pos = 0;
+                c->state = CLIENT_RESPONSE;
+                c->close_after = true;
+            }
+            return true;
+        }
+
+        // send pending data until EAGAIN or nothing to send, return false if client should be closed
+        bool flush(_Client *c)
+        {
+            while (1)
+            {
+                if (c->out_pos < c->out.size())
+                {
+                    ssize_t n = send(c->fd, c->out.data() + c->out_pos, c->out.size() - c->out_pos, MSG_NOSIGNAL);
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        return errno == EAGAIN || errno == EWOULDBLOCK;
+                    }
+                    c->out_pos += n;
+                    continue;
+                }
+                if (c->state == CLIENT_RESPONSE)
+                {
+                    if (c->close_after)
+                        return false;
+                    c->out.clear();
+                    c->out_pos = 0;
+                    c->state = CLIENT_REQUEST;
+                    if (!on_request(c)) // pipelined request
+                        return false;
+                    if (c->state == CLIENT_REQUEST)
+                        return true;
+                    continue;
+                }
+                if (c->state != CLIENT_STREAM || !c->cur)
+                    return true;
+                // header, jpeg and trailer in one call, no copy
+                const _Frame *f = c->cur.get();
+                struct iovec iov[3];
+                int iov_num = 0;
+                size_t pos = c->cur_pos;
+                const void *parts[3] = {f->header, f->data, "\r\n"};
+                size_t sizes[3] = {(size_t)f->header_len, f->size, 2};
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (pos >= sizes[i])
+                    {
+                        pos -= sizes[i];
+                        continue;
+                    }
+                    iov[iov_num].iov_base = (uint8_t *)parts[i] + pos;
+                    iov[iov_num].iov_len = sizes[i] - pos;
+                    ++iov_num;
+                    pos = 0;
+                }
+                struct msghdr msg;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = iov;
+                msg.msg_iovlen = iov_num;
+                ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                c->cur_pos += n;
+                if (c->cur_pos >= f->total())
+                {
+                    c->cur = std::move(c->next);
+                    c->next.reset();
+                    c->cur_pos = 0;
+                }
+            }
+        }
+    };
+
+    static int _create_listen_socket(const std::string &host, int port)
+    {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (host.empty() || host == "0.0.0.0")
+            address.sin_addr.s_addr = INADDR_ANY;
+        else if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        {
+            struct addrinfo hints, *res;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            int status = getaddrinfo(host.c_str(), NULL, &hints, &res);
+            if (status != 0)
+            {
+                log::error("can not parse ip: %s, %s", host.c_str(), gai_strerror(status));
+                return -1;
+            }
+            address.sin_addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+            freeaddrinfo(res);
+        }
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            log::error("create socket failed: %s", strerror(errno));
+            return -1;
+        }
+        int opt = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+        {
+            log::error("bind %s:%d failed: %s", host.c_str(), port, strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+        if (listen(fd, 128) < 0)
+        {
+            log::error("listen failed: %s", strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    JpegStreamer::JpegStreamer(std::string host, int port, int client_number)
+    {
+        if (host.size() == 0)
+        {
+            host = "0.0.0.0";
+        }
+        _host = host;
+        _port = port;
+
+        _Server *server = new _Server();
+        server->max_clients = client_number > 0 ? client_number : 1;
+        server->listen_fd = _create_listen_socket(host, port);
+        server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        server->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        bool ok = server->listen_fd >= 0 && server->epoll_fd >= 0 && server->event_fd >= 0;
+        if (ok)
+        {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.fd = server->listen_fd;
+            ok = epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &ev) == 0;
+            ev.data.fd = server->event_fd;
+            ok = ok && epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->event_fd, &ev) == 0;
+        }
+        if (!ok)
+        {
+            if (server->listen_fd >= 0) ::close(server->listen_fd);
+            if (server->epoll_fd >= 0) ::close(server->epoll_fd);
+            if (server->event_fd >= 0) ::close(server->event_fd);
+            delete server;
+            err::check_raise(err::ERR_RUNTIME, "http_jpeg_server_create failed!");
+        }
+        _priv = server;
+    }
+
+    JpegStreamer::~JpegStreamer()
+    {
+        _Server *server = (_Server *)_priv;
+        stop();
+        ::close(server->listen_fd);
+        ::close(server->epoll_fd);
+        ::close(server->event_fd);
+        delete server;
+    }
+
+    err::Err JpegStreamer::start()
+    {
+        _Server *server = (_Server *)_priv;
+        if (server->running)
+            return err::ERR_NONE;
+        server->exit = false;
+        server->thread = std::thread(&_Server::loop, server);
+        server->running = true;
+        return err::ERR_NONE;
+    }
+
+    err::Err JpegStreamer::stop()
+    {
+        _Server *server = (_Server *)_priv;
+        if (!server->running)
+            return err::ERR_NONE;
+        server->exit = true;
+        server->notify();
+        server->thread.join();
+        server->running = false;
+        std::lock_guard<std::mutex> guard(server->lock);
+        server->latest.reset();
+        return err::ERR_NONE;
+    }
+
+    err::Err JpegStreamer::write(image::Image *img)
+    {
+        _Server *server = (_Server *)_priv;
+        if (!img)
+            return err::ERR_ARGS;
+        // no one watching, skip encode
+        if (!server->running || server->streaming == 0)
+            return err::ERR_NONE;
+
+        _FramePtr frame;
+        if (img->format() != image::Format::FMT_JPEG)
+        {
+            image::Image *jpg = img->to_jpeg();
+            if (jpg == NULL)
+            {
+                log::error("invert to jpeg failed!\r\n");
+                return err::ERR_RUNTIME;
+            }
+            frame = std::make_shared<const _Frame>(jpg, true);
+        }
+        else
+        {
+            frame = std::make_shared<const _Frame>(img, false);
+        }
+        {
+            std::lock_guard<std::mutex> guard(server->lock);
+            server->latest = frame;
+            ++server->latest_seq;
+        }
+        server->notify();
+        return err::ERR_NONE;
+    }
+
+    err::Err JpegStreamer::set_html(std::string data)
+    {
+        _Server *server = (_Server *)_priv;
+        if (data.size() == 0)
+        {
+            log::error("html code is none!\r\n");
+            return err::ERR_RUNTIME;
+        }
+        std::lock_guard<std::mutex> guard(server->lock);
+        server->html = data;
+        return err::ERR_NONE;
+    }
+
+    int JpegStreamer::clients()
+    {
+        return ((_Server *)_priv)->streaming;
+    }
+} // namespace maix::http
@@ -570,6 +570,19 @@ namespace maix::camera
         return err::ERR_NONE;
     }
 
+    err::Err Camera::set_zero_copy(bool enable, bool drop_old)
+    {
+        (void)enable;
+        (void)drop_old;
+        return err::ERR_NOT_IMPL;
+    }
+
+    int Camera::get_dmabuf_fd(image::Image &img)
+    {
+        (void)img;
+        return -1;
+    }
+
     void Camera::clear_buff()
     {
         log::warn("This operation is not supported!");
@@ -1,597 +1,724 @@
-#include "ByteTrack/BYTETracker.h"
-
-#include <cstddef>
-#include <limits>
-#include <map>
-#include <memory>
-#include <stdexcept>
-#include <utility>
-#include <vector>
-
-byte_track::BYTETracker::BYTETracker(const int& max_lost_buff_num,
-                                     const float& track_thresh,  // 持续跟踪
-                                     const float& high_thresh,   // 增加新 id
-                                     const float& match_thresh,  // 
-                                     const int& max_history) :
-    track_thresh_(track_thresh),
-    high_thresh_(high_thresh),
-    match_thresh_(match_thresh),
-    max_history_(max_history),
-    max_time_lost_(static_cast<size_t>(max_lost_buff_num)),
-    frame_id_(0),
-    track_id_count_(0)
-{
-}
-
-byte_track::BYTETracker::~BYTETracker()
-{
-}
-
-std::vector<byte_track::BYTETracker::STrackPtr> byte_track::BYTETracker::update(const std::vector<Object>& objects)
-{
-    ////////////////// Step 1: Get detections //////////////////
-    frame_id_++;
-
-    // Create new STracks using the result of object detection
-    std::vector<STrackPtr> det_stracks;
-    std::vector<STrackPtr> det_low_stracks;
-
-    for (const auto &object : objects)
-    {
-        const auto strack = std::make_shared<STrack>(object.rect, object.prob, object.label, max_history_);
-        if (object.prob >= track_thresh_)
-        {
-            det_stracks.push_back(strack);
-        }
-        else
-        {
-            det_low_stracks.push_back(strack);
-        }
-    }
-
-    // Create lists of existing STrack
-    std::vector<STrackPtr> active_stracks;
-    std::vector<STrackPtr> non_active_stracks;
-    std::vector<STrackPtr> strack_pool;
-
-    for (const auto& tracked_strack : tracked_stracks_)
-    {
-        if (!tracked_strack->isActivated())
-        {
-            non_active_stracks.push_back(tracked_strack);
-        }
-        else
-        {
-            active_stracks.push_back(tracked_strack);
-        }
-    }
-
-    strack_pool = jointStracks(active_stracks, lost_stracks_);
-
-    // Predict current pose by KF
-    for (auto &strack : strack_pool)
-    {
-        strack->predict();
-    }
-
-    ////////////////// Step 2: First association, with IoU //////////////////
-    std::vector<STrackPtr> current_tracked_stracks;
-    std::vector<STrackPtr> remain_tracked_stracks;
-    std::vector<STrackPtr> remain_det_stracks;
-    std::vector<STrackPtr> refind_stracks;
-
-    {
-        std::vector<std::vector<int>> matches_idx;
-        std::vector<int> unmatch_detection_idx, unmatch_track_idx;
-
-        const auto dists = calcIouDistance(strack_pool, det_stracks);
-        linearAssignment(dists, strack_pool.size(), det_stracks.size(), match_thresh_,
-                         matches_idx, unmatch_track_idx, unmatch_detection_idx);
-
-        for (const auto &match_idx : matches_idx)
-        {
-            const auto track = strack_pool[match_idx[0]];
-            const auto det = det_stracks[match_idx[1]];
-            if (track->getSTrackState() == STrackState::Tracked)
-            {
-                track->update(*det, frame_id_);
-                current_tracked_stracks.push_back(track);
-            }
-            else
-            {
-                track->reActivate(*det, frame_id_);
-                refind_stracks.push_back(track);
-            }
-        }
-
-        for (const auto &unmatch_idx : unmatch_detection_idx)
-        {
-            remain_det_stracks.push_back(det_stracks[unmatch_idx]);
-        }
-
-        for (const auto &unmatch_idx : unmatch_track_idx)
-        {
-            if (strack_pool[unmatch_idx]->getSTrackState() == STrackState::Tracked)
-            {
-                remain_tracked_stracks.push_back(strack_pool[unmatch_idx]);
-            }
-        }
-    }
-
-    ////////////////// Step 3: Second association, using low score dets //////////////////
-    std::vector<STrackPtr> current_lost_stracks;
-
-    {
-        std::vector<std::vector<int>> matches_idx;
-        std::vector<int> unmatch_track_idx, unmatch_detection_idx;
-
-        const auto dists = calcIouDistance(remain_tracked_stracks, det_low_stracks);
-        linearAssignment(dists, remain_tracked_stracks.size(), det_low_stracks.size(), 0.5,
-                         matches_idx, unmatch_track_idx, unmatch_detection_idx);
-
-        for (const auto &match_idx : matches_idx)
-        {
-            const auto track = remain_tracked_stracks[match_idx[0]];
-            const auto det = det_low_stracks[match_idx[1]];
-            if (track->getSTrackState() == STrackState::Tracked)
-            {
-                track->update(*det, frame_id_);
-                current_tracked_stracks.push_back(track);
-            }
-            else
-            {
-                track->reActivate(*det, frame_id_);
-                refind_stracks.push_back(track);
-            }
-        }
-
-        for (const auto &unmatch_track : unmatch_track_idx)
-        {
-            const auto track = remain_tracked_stracks[unmatch_track];
-            if (track->getSTrackState() != STrackState::Lost)
-            {
-                track->markAsLost();
-                current_lost_stracks.push_back(track);
-            }
-        }
-    }
-
-    ////////////////// Step 4: Init new stracks //////////////////
-    std::vector<STrackPtr> current_removed_stracks;
-
-    {
-        std::vector<int> unmatch_detection_idx;
-        std::vector<int> unmatch_unconfirmed_idx;
-        std::vector<std::vector<int>> matches_idx;
-
-        // Deal with unconfirmed tracks, usually tracks with only one beginning frame
-        const auto dists = calcIouDistance(non_active_stracks, remain_det_stracks);
-        linearAssignment(dists, non_active_stracks.size(), remain_det_stracks.size(), 0.7,
-                         matches_idx, unmatch_unconfirmed_idx, unmatch_detection_idx);
-
-        for (const auto &match_idx : matches_idx)
-        {
-            non_active_stracks[match_idx[0]]->update(*remain_det_stracks[match_idx[1]], frame_id_);
-            current_tracked_stracks.push_back(non_active_stracks[match_idx[0]]);
-        }
-
-        for (const auto &unmatch_idx : unmatch_unconfirmed_idx)
-        {
-            const auto track = non_active_stracks[unmatch_idx];
-            track->markAsRemoved();
-            current_removed_stracks.push_back(track);
-        }
-
-        // Add new stracks
-        for (const auto &unmatch_idx : unmatch_detection_idx)
-        {
-            const auto track = remain_det_stracks[unmatch_idx];
-            if (track->getScore() < high_thresh_)
-            {
-                continue;
-            }
-            track_id_count_++;
-            track->activate(frame_id_, track_id_count_);
-            current_tracked_stracks.push_back(track);
-        }
-    }
-
-    ////////////////// Step 5: Update state //////////////////
-    for (const auto &lost_strack : lost_stracks_)
-    {
-        if (frame_id_ - lost_strack->getFrameId() > max_time_lost_)
-        {
-            lost_strack->markAsRemoved();
-            current_removed_stracks.push_back(lost_strack);
-        }
-    }
-
-    tracked_stracks_ = jointStracks(current_tracked_stracks, refind_stracks);
-    lost_stracks_ = subStracks(jointStracks(subStracks(lost_stracks_, tracked_stracks_), current_lost_stracks), current_removed_stracks);
-    // lost_stracks_ = subStracks(jointStracks(subStracks(lost_stracks_, tracked_stracks_), current_lost_stracks), removed_stracks_);
-    // removed_stracks_ = jointStracks(removed_stracks_, current_removed_stracks);
-
-    std::vector<STrackPtr> tracked_stracks_out, lost_stracks_out;
-    removeDuplicateStracks(tracked_stracks_, lost_stracks_, tracked_stracks_out, lost_stracks_out);
-    tracked_stracks_ = tracked_stracks_out;
-    lost_stracks_ = lost_stracks_out;
-
-    std::vector<STrackPtr> output_stracks;
-    for (const auto &track : tracked_stracks_)
-    {
-        if (track->isActivated())
-        {
-            track->setLost(false);
-            output_stracks.push_back(track);
-        }
-    }
-    for (const auto &track : lost_stracks_)
-    {
-        if (track->isActivated())
-        {
-            track->setLost(true);
-            output_stracks.push_back(track);
-        }
-    }
-    return output_stracks;
-}
-std::vector<byte_track::BYTETracker::STrackPtr> byte_track::BYTETracker::jointStracks(const std::vector<STrackPtr> &a_tlist,
-                                                                                      const std::vector<STrackPtr> &b_tlist) const
-{
-    std::map<int, int> exists;
-    std::vector<STrackPtr> res;
-    for (size_t i = 0; i < a_tlist.size(); i++)
-    {
-        exists.emplace(a_tlist[i]->getTrackId(), 1);
-        res.push_back(a_tlist[i]);
-    }
-    for (size_t i = 0; i < b_tlist.size(); i++)
-    {
-        const int &tid = b_tlist[i]->getTrackId();
-        if (!exists[tid] || exists.count(tid) == 0)
-        {
-            exists[tid] = 1;
-            res.push_back(b_tlist[i]);
-        }
-    }
-    return res;
-}
-
-std::vector<byte_track::BYTETracker::STrackPtr> byte_track::BYTETracker::subStracks(const std::vector<STrackPtr> &a_tlist,
-                                                                                    const std::vector<STrackPtr> &b_tlist) const
-{
-    std::map<int, STrackPtr> stracks;
-    for (size_t i = 0; i < a_tlist.size(); i++)
-    {
-        stracks.emplace(a_tlist[i]->getTrackId(), a_tlist[i]);
-    }
-
-    for (size_t i = 0; i < b_tlist.size(); i++)
-    {
-        const int &tid = b_tlist[i]->getTrackId();
-        if (stracks.count(tid) != 0)
-        {
-            stracks.erase(tid);
-        }
-    }
-
-    std::vector<STrackPtr> res;
-    std::map<int, STrackPtr>::iterator it;
-    for (it = stracks.begin(); it != stracks.end(); ++it)
-    {
-        res.push_back(it->second);
-    }
-
-    return res;
-}
-
-void byte_track::BYTETracker::removeDuplicateStracks(const std::vector<STrackPtr> &a_stracks,
-                                                     const std::vector<STrackPtr> &b_stracks,
-                                                     std::vector<STrackPtr> &a_res,
-                                                     std::vector<STrackPtr> &b_res) const
-{
-    const auto ious = calcIouDistance(a_stracks, b_stracks);
-
-    std::vector<std::pair<size_t, size_t>> overlapping_combinations;
-    for (size_t i = 0; i < ious.size(); i++)
-    {
-        for (size_t j = 0; j < ious[i].size(); j++)
-        {
-            if (ious[i][j] < 0.15)
-            {
-                overlapping_combinations.emplace_back(i, j);
-            }
-        }
-    }
-
-    std::vector<bool> a_overlapping(a_stracks.size(), false), b_overlapping(b_stracks.size(), false);
-    for (const auto &[a_idx, b_idx] : overlapping_combinations)
-    {
-        const int timep = a_stracks[a_idx]->getFrameId() - a_stracks[a_idx]->getStartFrameId();
-        const int timeq = b_stracks[b_idx]->getFrameId() - b_stracks[b_idx]->getStartFrameId();
-        if (timep > timeq)
-        {
-            b_overlapping[b_idx] = true;
-        }
-        else
-        {
-            a_overlapping[a_idx] = true;
-        }
-    }
-
-    for (size_t ai = 0; ai < a_stracks.size(); ai++)
-    {
-        if (!a_overlapping[ai])
-        {
-            a_res.push_back(a_stracks[ai]);
-        }
-    }
-
-    for (size_t bi = 0; bi < b_stracks.size(); bi++)
-    {
-        if (!b_overlapping[bi])
-        {
-            b_res.push_back(b_stracks[bi]);
-        }
-    }
-}
-
-void byte_track::BYTETracker::linearAssignment(const std::vector<std::vector<float>> &cost_matrix,
-                                               const int &cost_matrix_size,
-                                               const int &cost_matrix_size_size,
-                                               const float &thresh,
-                                               std::vector<std::vector<int>> &matches,
-                                               std::vector<int> &a_unmatched,
-                                               std::vector<int> &b_unmatched) const
-{
-    if (cost_matrix.size() == 0)
-    {
-        for (int i = 0; i < cost_matrix_size; i++)
-        {
-            a_unmatched.push_back(i);
-        }
-        for (int i = 0; i < cost_matrix_size_size; i++)
-        {
-            b_unmatched.push_back(i);
-        }
-        return;
-    }
-
-    std::vector<int> rowsol; std::vector<int> colsol;
-    execLapjv(cost_matrix, rowsol, colsol, true, thresh);
-    for (size_t i = 0; i < rowsol.size(); i++)
-    {
-        if (rowsol[i] >= 0)
-        {
-            std::vector<int> match;
-            match.push_back(i);
-            match.push_back(rowsol[i]);
-            matches.push_back(match);
-        }
-        else
-        {
-            a_unmatched.push_back(i);
-        }
-    }
-
-    for (size_t i = 0; i < colsol.size(); i++)
-    {
-        if (colsol[i] < 0)
-        {
-            b_unmatched.push_back(i);
-        }
-    }
-}
-
-std::vector<std::vector<float>> byte_track::BYTETracker::calcIous(const std::vector<Rect<float>> &a_rect,
-                                                                  const std::vector<Rect<float>> &b_rect) const
-{
-    std::vector<std::vector<float>> ious;
-    if (a_rect.size() * b_rect.size() == 0)
-    {
-        return ious;
-    }
-
-    ious.resize(a_rect.size());
-    for (size_t i = 0; i < ious.size(); i++)
-    {
-        ious[i].resize(b_rect.size());
-    }
-
-    for (size_t bi = 0; bi < b_rect.size(); bi++)
-    {
-        for (size_t ai = 0; ai < a_rect.size(); ai++)
-        {
-            ious[ai][bi] = b_rect[bi].calcIoU(a_rect[ai]);
-        }
-    }
-    return ious;
-}
-
-std::vector<std::vector<float> > byte_track::BYTETracker::calcIouDistance(const std::vector<STrackPtr> &a_tracks,
-                                                                          const std::vector<STrackPtr> &b_tracks) const
-{
-    std::vector<byte_track::Rect<float>> a_rects, b_rects;
-    for (size_t i = 0; i < a_tracks.size(); i++)
-    {
-        a_rects.push_back(a_tracks[i]->getRect());
-    }
-
-    for (size_t i = 0; i < b_tracks.size(); i++)
-    {
-        b_rects.push_back(b_tracks[i]->getRect());
-    }
-
-    const auto ious = calcIous(a_rects, b_rects);
-
-    std::vector<std::vector<float>> cost_matrix;
-    for (size_t i = 0; i < ious.size(); i++)
-    {
-        std::vector<float> iou;
-        for (size_t j = 0; j < ious[i].size(); j++)
-        {
-            iou.push_back(1 - ious[i][j]);
-        }
-        cost_matrix.push_back(iou);
-    }
-
-    return cost_matrix;
-}
-
-double byte_track::BYTETracker::execLapjv(const std::vector<std::vector<float>> &cost,
-                                          std::vector<int> &rowsol,
-                                          std::vector<int> &colsol,
-                                          bool extend_cost,
-                                          float cost_limit,
-                                          bool return_cost) const
-{
-    std::vector<std::vector<float> > cost_c;
-    cost_c.assign(cost.begin(), cost.end());
-
-    std::vector<std::vector<float> > cost_c_extended;
-
-    int n_rows = cost.size();
-    int n_cols = cost[0].size();
-    rowsol.resize(n_rows);
-    colsol.resize(n_cols);
-
-    int n = 0;
-    if (n_rows == n_cols)
-    {
-        n = n_rows;
-    }
-    else
-    {
-        if (!extend_cost)
-        {
-            throw std::runtime_error("The `extend_cost` variable should set True");
-        }
-    }
-
-    if (extend_cost || cost_limit < std::numeric_limits<float>::max())
-    {
-        n = n_rows + n_cols;
-        cost_c_extended.resize(n);
-        for (size_t i = 0; i < cost_c_extended.size(); i++)
-            cost_c_extended[i].resize(n);
-
-        if (cost_limit < std::numeric_limits<float>::max())
-        {
-            for (size_t i = 0; i < cost_c_extended.size(); i++)
-            {
-                for (size_t j = 0; j < cost_c_extended[i].size(); j++)
-                {
-                    cost_c_extended[i][j] = cost_limit / 2.0;
-                }
-            }
-        }
-        else
-        {
-            float cost_max = -1;
-            for (size_t i = 0; i < cost_c.size(); i++)
-            {
-                for (size_t j = 0; j < cost_c[i].size(); j++)
-                {
-                    if (cost_c[i][j] > cost_max)
-                        cost_max = cost_c[i][j];
-                }
-            }
-            for (size_t i = 0; i < cost_c_extended.size(); i++)
-            {
-                for (size_t j = 0; j < cost_c_extended[i].size(); j++)
-                {
-                    cost_c_extended[i][j] = cost_max + 1;
-                }
-            }
-        }
-
-        for (size_t i = n_rows; i < cost_c_extended.size(); i++)
-        {
-            for (size_t j = n_cols; j < cost_c_extended[i].size(); j++)
-            {
-                cost_c_extended[i][j] = 0;
-            }
-        }
-        for (int i = 0; i < n_rows; i++)
-        {
-            for (int j = 0; j < n_cols; j++)
-            {
-                cost_c_extended[i][j] = cost_c[i][j];
-            }
-        }
-
-        cost_c.clear();
-        cost_c.assign(cost_c_extended.begin(), cost_c_extended.end());
-    }
-
-    double **cost_ptr;
-    cost_ptr = new double *[sizeof(double *) * n];
-    for (int i = 0; i < n; i++)
-        cost_ptr[i] = new double[sizeof(double) * n];
-
-    for (int i = 0; i < n; i++)
-    {
-        for (int j = 0; j < n; j++)
-        {
-            cost_ptr[i][j] = cost_c[i][j];
-        }
-    }
-
-    int* x_c = new int[sizeof(int) * n];
-    int *y_c = new int[sizeof(int) * n];
-
-    int ret = lapjv_internal(n, cost_ptr, x_c, y_c);
-    if (ret != 0)
-    {
-        throw std::runtime_error("The result of lapjv_internal() is invalid.");
-    }
-
-    double opt = 0.0;
-
-    if (n != n_rows)
-    {
-        for (int i = 0; i < n; i++)
-        {
-            if (x_c[i] >= n_cols)
-                x_c[i] = -1;
-            if (y_c[i] >= n_rows)
-                y_c[i] = -1;
-        }
-        for (int i = 0; i < n_rows; i++)
-        {
-            rowsol[i] = x_c[i];
-        }
-        for (int i = 0; i < n_cols; i++)
-        {
-            colsol[i] = y_c[i];
-        }
-
-        if (return_cost)
-        {
-            for (size_t i = 0; i < rowsol.size(); i++)
-            {
-                if (rowsol[i] != -1)
-                {
-                    opt += cost_ptr[i][rowsol[i]];
-                }
-            }
-        }
-    }
-    else if (return_cost)
-    {
-        for (size_t i = 0; i < rowsol.size(); i++)
-        {
-            opt += cost_ptr[i][rowsol[i]];
-        }
-    }
-
-    for (int i = 0; i < n; i++)
-    {
-        delete[]cost_ptr[i];
-    }
-    delete[]cost_ptr;
-    delete[]x_c;
-    delete[]y_c;
-
-    return opt;
-}
+#include "ByteTrack/BYTETracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Kalman filter noise weights
+#define STD_WEIGHT_POSITION (1.f / 20)
+#define STD_WEIGHT_VELOCITY (1.f / 160)
+
+// components larger than this (rows + cols) use greedy assignment, O(n^3) exact solver is too slow
+#define DENSE_ASSIGN_MAX 128
+
+byte_track::BYTETracker::BYTETracker(const int& max_lost_buff_num,
+                                     const float& track_thresh,  // 持续跟踪
+                                     const float& high_thresh,   // 增加新 id
+                                     const float& match_thresh,  //
+                                     const int& max_history) :
+    track_thresh_(track_thresh),
+    high_thresh_(high_thresh),
+    match_thresh_(match_thresh),
+    max_history_(max_history > 0 ? max_history : 0),
+    max_time_lost_(static_cast<size_t>(max_lost_buff_num)),
+    frame_count_(0),
+    track_id_count_(0)
+{
+}
+
+byte_track::BYTETracker::~BYTETracker()
+{
+}
+
+////////////////// Track pool //////////////////
+
+int byte_track::BYTETracker::allocSlot()
+{
+    if (!free_slots_.empty())
+    {
+        const int slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+    const int slot = state_.size();
+    for (auto &v : mean_) v.push_back(0);
+    for (auto &v : cov_) v.push_back(0);
+    for (auto &v : rect_) v.push_back(0);
+    state_.push_back(0);
+    activated_.push_back(0);
+    lost_.push_back(0);
+    score_.push_back(0);
+    label_.push_back(0);
+    track_id_.push_back(0);
+    frame_id_.push_back(0);
+    start_frame_id_.push_back(0);
+    hist_head_.push_back(0);
+    hist_count_.push_back(0);
+    history_.resize(history_.size() + max_history_, Object(Rect<float>(0, 0, 0, 0), 0, 0));
+    in_tracked_.push_back(0);
+    drop_.push_back(0);
+    return slot;
+}
+
+void byte_track::BYTETracker::freeSlot(int slot)
+{
+    state_[slot] = (uint8_t)STrackState::Removed;
+    free_slots_.push_back(slot);
+}
+
+void byte_track::BYTETracker::initiate(int slot, const float *rect, float score, int label)
+{
+    const float h = rect[3];
+    mean_[0][slot] = rect[0] + rect[2] / 2;
+    mean_[1][slot] = rect[1] + rect[3] / 2;
+    mean_[2][slot] = rect[2] / rect[3];
+    mean_[3][slot] = h;
+    const float std_pos = 2 * STD_WEIGHT_POSITION * h;
+    const float std_vel = 10 * STD_WEIGHT_VELOCITY * h;
+    for (int i = 0; i < 4; i++)
+    {
+        mean_[4 + i][slot] = 0;
+        cov_[i * 3][slot] = i == 2 ? 1e-2f * 1e-2f : std_pos * std_pos;
+        cov_[i * 3 + 1][slot] = 0;
+        cov_[i * 3 + 2][slot] = i == 2 ? 1e-5f * 1e-5f : std_vel * std_vel;
+    }
+    score_[slot] = score;
+    label_[slot] = label;
+    lost_[slot] = 0;
+    hist_head_[slot] = 0;
+    hist_count_[slot] = 0;
+    updateRect(slot);
+}
+
+void byte_track::BYTETracker::predict(const std::vector<int> &slots)
+{
+    for (const int slot : slots)
+    {
+        if (state_[slot] != (uint8_t)STrackState::Tracked)
+        {
+            mean_[7][slot] = 0;
+        }
+        const float h = mean_[3][slot];
+        const float q_pos = STD_WEIGHT_POSITION * h * STD_WEIGHT_POSITION * h;
+        const float q_vel = STD_WEIGHT_VELOCITY * h * STD_WEIGHT_VELOCITY * h;
+        // x' = x + v, P' = F P F^T + Q of every (x, v) pair
+        for (int i = 0; i < 4; i++)
+        {
+            float &p00 = cov_[i * 3][slot];
+            float &p01 = cov_[i * 3 + 1][slot];
+            float &p11 = cov_[i * 3 + 2][slot];
+            mean_[i][slot] += mean_[4 + i][slot];
+            p00 += 2 * p01 + p11 + (i == 2 ? 1e-2f * 1e-2f : q_pos);
+            p01 += p11;
+            p11 += i == 2 ? 1e-5f * 1e-5f : q_vel;
+        }
+    }
+}
+
+void byte_track::BYTETracker::update(int slot, const float *rect, float score, size_t frame_id)
+{
+    const float z[4] = {rect[0] + rect[2] / 2, rect[1] + rect[3] / 2, rect[2] / rect[3], rect[3]};
+    const float h = mean_[3][slot];
+    const float r_pos = STD_WEIGHT_POSITION * h * STD_WEIGHT_POSITION * h;
+    // measurement only observe x, so every pair is a scalar update with innovation covariance S = p00 + R
+    for (int i = 0; i < 4; i++)
+    {
+        float &p00 = cov_[i * 3][slot];
+        float &p01 = cov_[i * 3 + 1][slot];
+        float &p11 = cov_[i * 3 + 2][slot];
+        const float s = p00 + (i == 2 ? 1e-1f * 1e-1f : r_pos);
+        const float k0 = p00 / s;
+        const float k1 = p01 / s;
+        const float innovation = z[i] - mean_[i][slot];
+        mean_[i][slot] += k0 * innovation;
+        mean_[4 + i][slot] += k1 * innovation;
+        p11 -= k1 * p01;
+        p01 -= k0 * p01;
+        p00 -= k0 * p00;
+    }
+
+    updateRect(slot);
+
+    state_[slot] = (uint8_t)STrackState::Tracked;
+    activated_[slot] = 1;
+    score_[slot] = score;
+    frame_id_[slot] = frame_id;
+}
+
+void byte_track::BYTETracker::updateRect(int slot)
+{
+    const float w = mean_[2][slot] * mean_[3][slot];
+    const float h = mean_[3][slot];
+    rect_[0][slot] = mean_[0][slot] - w / 2;
+    rect_[1][slot] = mean_[1][slot] - h / 2;
+    rect_[2][slot] = w;
+    rect_[3][slot] = h;
+    if (max_history_ == 0)
+    {
+        return;
+    }
+    int idx;
+    if (hist_count_[slot] < max_history_)
+    {
+        idx = (hist_head_[slot] + hist_count_[slot]++) % max_history_;
+    }
+    else
+    {
+        idx = hist_head_[slot];
+        hist_head_[slot] = (hist_head_[slot] + 1) % max_history_;
+    }
+    Object &obj = history_[(size_t)slot * max_history_ + idx];
+    obj.rect.x() = rect_[0][slot];
+    obj.rect.y() = rect_[1][slot];
+    obj.rect.width() = w;
+    obj.rect.height() = h;
+    obj.label = label_[slot];
+    obj.prob = score_[slot];
+}
+
+////////////////// Update //////////////////
+
+const std::vector<int> &byte_track::BYTETracker::update(const std::vector<Object>& objects)
+{
+    ////////////////// Step 1: Get detections //////////////////
+    frame_count_++;
+
+    det_rects_.resize(objects.size() * 4);
+    det_high_.clear();
+    det_low_.clear();
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const auto &object = objects[i];
+        det_rects_[i * 4] = object.rect.x();
+        det_rects_[i * 4 + 1] = object.rect.y();
+        det_rects_[i * 4 + 2] = object.rect.width();
+        det_rects_[i * 4 + 3] = object.rect.height();
+        if (object.prob >= track_thresh_)
+        {
+            det_high_.push_back(i);
+        }
+        else
+        {
+            det_low_.push_back(i);
+        }
+    }
+
+    // Split existing tracks
+    active_.clear();
+    non_active_.clear();
+    for (const int slot : tracked_stracks_)
+    {
+        if (!activated_[slot])
+        {
+            non_active_.push_back(slot);
+        }
+        else
+        {
+            active_.push_back(slot);
+        }
+    }
+    pool_.assign(active_.begin(), active_.end());
+    pool_.insert(pool_.end(), lost_stracks_.begin(), lost_stracks_.end());
+
+    // Predict current pose by KF
+    predict(pool_);
+
+    ////////////////// Step 2: First association, with IoU //////////////////
+    current_tracked_.clear();
+    refind_.clear();
+    remain_tracked_.clear();
+    remain_det_.clear();
+
+    linearAssignment(pool_, det_rects_.data(), det_high_.data(), det_high_.size(), match_thresh_,
+                     matches_, unmatch_a_, unmatch_b_);
+    for (const auto &match : matches_)
+    {
+        const int slot = pool_[match.first];
+        const int det = det_high_[match.second];
+        const bool tracked = state_[slot] == (uint8_t)STrackState::Tracked;
+        update(slot, &det_rects_[det * 4], objects[det].prob, frame_count_);
+        (tracked ? current_tracked_ : refind_).push_back(slot);
+    }
+    for (const int idx : unmatch_b_)
+    {
+        remain_det_.push_back(det_high_[idx]);
+    }
+    for (const int idx : unmatch_a_)
+    {
+        if (state_[pool_[idx]] == (uint8_t)STrackState::Tracked)
+        {
+            remain_tracked_.push_back(pool_[idx]);
+        }
+    }
+
+    ////////////////// Step 3: Second association, using low score dets //////////////////
+    current_lost_.clear();
+
+    linearAssignment(remain_tracked_, det_rects_.data(), det_low_.data(), det_low_.size(), 0.5,
+                     matches_, unmatch_a_, unmatch_b_);
+    for (const auto &match : matches_)
+    {
+        const int slot = remain_tracked_[match.first];
+        const int det = det_low_[match.second];
+        const bool tracked = state_[slot] == (uint8_t)STrackState::Tracked;
+        update(slot, &det_rects_[det * 4], objects[det].prob, frame_count_);
+        (tracked ? current_tracked_ : refind_).push_back(slot);
+    }
+    for (const int idx : unmatch_a_)
+    {
+        const int slot = remain_tracked_[idx];
+        if (state_[slot] != (uint8_t)STrackState::Lost)
+        {
+            state_[slot] = (uint8_t)STrackState::Lost;
+            current_lost_.push_back(slot);
+        }
+    }
+
+    ////////////////// Step 4: Init new stracks //////////////////
+    removed_.clear();
+
+    // Deal with unconfirmed tracks, usually tracks with only one beginning frame
+    linearAssignment(non_active_, det_rects_.data(), remain_det_.data(), remain_det_.size(), 0.7,
+                     matches_, unmatch_a_, unmatch_b_);
+    for (const auto &match : matches_)
+    {
+        const int slot = non_active_[match.first];
+        const int det = remain_det_[match.second];
+        update(slot, &det_rects_[det * 4], objects[det].prob, frame_count_);
+        current_tracked_.push_back(slot);
+    }
+    for (const int idx : unmatch_a_)
+    {
+        const int slot = non_active_[idx];
+        state_[slot] = (uint8_t)STrackState::Removed;
+        removed_.push_back(slot);
+    }
+
+    // Add new stracks
+    for (const int idx : unmatch_b_)
+    {
+        const int det = remain_det_[idx];
+        if (objects[det].prob < high_thresh_)
+        {
+            continue;
+        }
+        const int slot = allocSlot();
+        initiate(slot, &det_rects_[det * 4], objects[det].prob, objects[det].label);
+        state_[slot] = (uint8_t)STrackState::Tracked;
+        activated_[slot] = frame_count_ == 1;
+        track_id_[slot] = ++track_id_count_;
+        frame_id_[slot] = frame_count_;
+        start_frame_id_[slot] = frame_count_;
+        current_tracked_.push_back(slot);
+    }
+
+    ////////////////// Step 5: Update state //////////////////
+    for (const int slot : lost_stracks_)
+    {
+        if (state_[slot] == (uint8_t)STrackState::Lost && frame_count_ - frame_id_[slot] > max_time_lost_)
+        {
+            state_[slot] = (uint8_t)STrackState::Removed;
+            removed_.push_back(slot);
+        }
+    }
+
+    // tracked = current tracked + refind
+    tracked_stracks_.assign(current_tracked_.begin(), current_tracked_.end());
+    tracked_stracks_.insert(tracked_stracks_.end(), refind_.begin(), refind_.end());
+    for (const int slot : tracked_stracks_)
+    {
+        in_tracked_[slot] = 1;
+    }
+
+    // lost = (lost - tracked + current lost - removed), ordered by track id
+    tmp_tracks_.clear();
+    for (const int slot : lost_stracks_)
+    {
+        if (!in_tracked_[slot] && state_[slot] != (uint8_t)STrackState::Removed)
+        {
+            tmp_tracks_.push_back(slot);
+        }
+    }
+    tmp_tracks_.insert(tmp_tracks_.end(), current_lost_.begin(), current_lost_.end());
+    std::sort(tmp_tracks_.begin(), tmp_tracks_.end(), [this](int a, int b) { return track_id_[a] < track_id_[b]; });
+    lost_stracks_.swap(tmp_tracks_);
+    for (const int slot : tracked_stracks_)
+    {
+        in_tracked_[slot] = 0;
+    }
+
+    removeDuplicateStracks();
+
+    output_.clear();
+    for (const int slot : tracked_stracks_)
+    {
+        if (activated_[slot])
+        {
+            lost_[slot] = 0;
+            output_.push_back(slot);
+        }
+    }
+    for (const int slot : lost_stracks_)
+    {
+        if (activated_[slot])
+        {
+            lost_[slot] = 1;
+            output_.push_back(slot);
+        }
+    }
+
+    for (const int slot : removed_)
+    {
+        freeSlot(slot);
+    }
+    return output_;
+}
+
+void byte_track::BYTETracker::removeDuplicateStracks()
+{
+    if (tracked_stracks_.empty() || lost_stracks_.empty())
+    {
+        return;
+    }
+    tmp_rects_.resize(lost_stracks_.size() * 4);
+    tmp_idx_.resize(lost_stracks_.size());
+    for (size_t i = 0; i < lost_stracks_.size(); i++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            tmp_rects_[i * 4 + k] = rect_[k][lost_stracks_[i]];
+        }
+        tmp_idx_[i] = i;
+    }
+    calcEdges(tracked_stracks_, tmp_rects_.data(), tmp_idx_.data(), tmp_idx_.size(), 0.15);
+    if (edges_.empty())
+    {
+        return;
+    }
+
+    for (const auto &edge : edges_)
+    {
+        const int a = tracked_stracks_[edge.row];
+        const int b = lost_stracks_[edge.col];
+        const int timep = frame_id_[a] - start_frame_id_[a];
+        const int timeq = frame_id_[b] - start_frame_id_[b];
+        if (timep > timeq)
+        {
+            drop_[b] = 1;
+        }
+        else
+        {
+            drop_[a] = 1;
+        }
+    }
+
+    for (auto *list : {&tracked_stracks_, &lost_stracks_})
+    {
+        size_t n = 0;
+        for (const int slot : *list)
+        {
+            if (drop_[slot])
+            {
+                drop_[slot] = 0;
+                state_[slot] = (uint8_t)STrackState::Removed;
+                removed_.push_back(slot);
+            }
+            else
+            {
+                (*list)[n++] = slot;
+            }
+        }
+        list->resize(n);
+    }
+}
+
+////////////////// Association //////////////////
+
+// IoU distance of tracks and boxes, only keep pairs with cost < thresh
+void byte_track::BYTETracker::calcEdges(const std::vector<int> &tracks, const float *b_rects, const int *b_idx, int b_num, float thresh)
+{
+    edges_.clear();
+    if (tracks.empty() || b_num == 0)
+    {
+        return;
+    }
+
+    // sort boxes by x, every track only visits boxes overlapped in x
+    order_.resize(b_num);
+    float max_w = 0;
+    for (int i = 0; i < b_num; i++)
+    {
+        order_[i] = i;
+        max_w = std::max(max_w, b_rects[b_idx[i] * 4 + 2]);
+    }
+    std::sort(order_.begin(), order_.end(), [&](int a, int b) { return b_rects[b_idx[a] * 4] < b_rects[b_idx[b] * 4]; });
+
+    for (size_t row = 0; row < tracks.size(); row++)
+    {
+        const int slot = tracks[row];
+        const float ax = rect_[0][slot], ay = rect_[1][slot], aw = rect_[2][slot], ah = rect_[3][slot];
+        const float a_area = (aw + 1) * (ah + 1);
+        // overlap needs b.x + b.w + 1 > a.x and b.x < a.x + a.w + 1
+        const float x_min = ax - max_w - 1;
+        auto it = std::lower_bound(order_.begin(), order_.end(), x_min,
+                                   [&](int i, float x) { return b_rects[b_idx[i] * 4] < x; });
+        for (; it != order_.end(); ++it)
+        {
+            const float *b = &b_rects[b_idx[*it] * 4];
+            const float iw = std::min(b[0] + b[2], ax + aw) - std::max(b[0], ax) + 1;
+            if (b[0] >= ax + aw + 1)
+            {
+                break;
+            }
+            if (iw <= 0)
+            {
+                continue;
+            }
+            const float ih = std::min(b[1] + b[3], ay + ah) - std::max(b[1], ay) + 1;
+            if (ih <= 0)
+            {
+                continue;
+            }
+            const float ua = (b[2] + 1) * (b[3] + 1) + a_area - iw * ih;
+            const float cost = 1 - iw * ih / ua;
+            if (cost < thresh)
+            {
+                edges_.push_back({(int)row, *it, cost});
+            }
+        }
+    }
+}
+
+/*
+ * Assignment minimize sum of matched cost, every unmatched track or box costs thresh / 2,
+ * same as lapjv on cost matrix extended with thresh / 2, so only pairs with cost < thresh can be matched,
+ * and independent connected components of these pairs can be solved separately.
+ */
+void byte_track::BYTETracker::linearAssignment(const std::vector<int> &tracks, const float *b_rects, const int *b_idx, int b_num,
+                                               const float &thresh,
+                                               std::vector<std::pair<int, int>> &matches,
+                                               std::vector<int> &a_unmatched,
+                                               std::vector<int> &b_unmatched)
+{
+    matches.clear();
+    a_unmatched.clear();
+    b_unmatched.clear();
+    const int rows = tracks.size();
+    row_match_.assign(rows, -1);
+    col_match_.assign(b_num, -1);
+
+    calcEdges(tracks, b_rects, b_idx, b_num, thresh);
+    if (!edges_.empty())
+    {
+        // union find, node rows + col is col
+        parent_.resize(rows + b_num);
+        std::iota(parent_.begin(), parent_.end(), 0);
+        auto find = [this](int x) {
+            while (parent_[x] != x)
+            {
+                parent_[x] = parent_[parent_[x]];
+                x = parent_[x];
+            }
+            return x;
+        };
+        for (const auto &edge : edges_)
+        {
+            const int a = find(edge.row), b = find(rows + edge.col);
+            if (a != b)
+            {
+                parent_[std::max(a, b)] = std::min(a, b);
+            }
+        }
+
+        // group edges by component, counting sort by root
+        comp_start_.assign(rows + b_num + 1, 0);
+        for (const auto &edge : edges_)
+        {
+            comp_start_[find(edge.row) + 1]++;
+        }
+        for (int i = 0; i < rows + b_num; i++)
+        {
+            comp_start_[i + 1] += comp_start_[i];
+        }
+        comp_edges_.resize(edges_.size());
+        for (size_t i = 0; i < edges_.size(); i++)
+        {
+            comp_edges_[comp_start_[find(edges_[i].row)]++] = i;
+        }
+        // comp_start_[root] is end of component now, component begins at comp_start_[root - 1]
+        int begin = 0;
+        for (int root = 0; root < rows + b_num; root++)
+        {
+            const int end = comp_start_[root];
+            const int n = end - begin;
+            if (n == 1)
+            {
+                const Edge &edge = edges_[comp_edges_[begin]];
+                row_match_[edge.row] = edge.col;
+                col_match_[edge.col] = edge.row;
+            }
+            else if (n > 1)
+            {
+                solveComponent(begin, end, thresh);
+            }
+            begin = end;
+        }
+    }
+
+    for (int i = 0; i < rows; i++)
+    {
+        if (row_match_[i] >= 0)
+        {
+            matches.emplace_back(i, row_match_[i]);
+        }
+        else
+        {
+            a_unmatched.push_back(i);
+        }
+    }
+    for (int i = 0; i < b_num; i++)
+    {
+        if (col_match_[i] < 0)
+        {
+            b_unmatched.push_back(i);
+        }
+    }
+}
+
+// solve one component of edges comp_edges_[begin, end)
+void byte_track::BYTETracker::solveComponent(int begin, int end, float thresh)
+{
+    comp_rows_.clear();
+    comp_cols_.clear();
+    local_id_.resize(row_match_.size() + col_match_.size());
+    const int rows = row_match_.size();
+    for (int k = begin; k < end; k++)
+    {
+        const Edge &edge = edges_[comp_edges_[k]];
+        local_id_[edge.row] = -1;
+        local_id_[rows + edge.col] = -1;
+    }
+    for (int k = begin; k < end; k++)
+    {
+        const Edge &edge = edges_[comp_edges_[k]];
+        if (local_id_[edge.row] < 0)
+        {
+            local_id_[edge.row] = comp_rows_.size();
+            comp_rows_.push_back(edge.row);
+        }
+        if (local_id_[rows + edge.col] < 0)
+        {
+            local_id_[rows + edge.col] = comp_cols_.size();
+            comp_cols_.push_back(edge.col);
+        }
+    }
+    const int r = comp_rows_.size();
+    const int c = comp_cols_.size();
+    const int n = r + c;
+
+    if (n > DENSE_ASSIGN_MAX)
+    {
+        // greedy, lowest cost first
+        std::sort(comp_edges_.begin() + begin, comp_edges_.begin() + end,
+                  [this](int a, int b) { return edges_[a].cost < edges_[b].cost; });
+        for (int k = begin; k < end; k++)
+        {
+            const Edge &edge = edges_[comp_edges_[k]];
+            if (row_match_[edge.row] < 0 && col_match_[edge.col] < 0)
+            {
+                row_match_[edge.row] = edge.col;
+                col_match_[edge.col] = edge.row;
+            }
+        }
+        return;
+    }
+
+    // extended square matrix, [r x c] costs, [r x r] and [c x c] thresh / 2 for unmatched, [c x r] 0
+    const double half = thresh / 2.0;
+    const double no_edge = thresh + 1;
+    cost_.resize((size_t)n * n);
+    for (int i = 0; i < n; i++)
+    {
+        double *row = &cost_[(size_t)i * n];
+        for (int j = 0; j < n; j++)
+        {
+            row[j] = (i < r) == (j < c) ? (i < r ? no_edge : 0) : half;
+        }
+    }
+    for (int k = begin; k < end; k++)
+    {
+        const Edge &edge = edges_[comp_edges_[k]];
+        cost_[(size_t)local_id_[edge.row] * n + local_id_[rows + edge.col]] = edge.cost;
+    }
+
+    // Hungarian algorithm with potentials, O(n^3), 1-indexed
+    const double inf = std::numeric_limits<double>::max();
+    u_.assign(n + 1, 0);
+    v_.assign(n + 1, 0);
+    p_.assign(n + 1, 0);
+    way_.assign(n + 1, 0);
+    for (int i = 1; i <= n; i++)
+    {
+        p_[0] = i;
+        int j0 = 0;
+        minv_.assign(n + 1, inf);
+        used_.assign(n + 1, 0);
+        do
+        {
+            used_[j0] = 1;
+            const int i0 = p_[j0];
+            const double *row = &cost_[(size_t)(i0 - 1) * n];
+            double delta = inf;
+            int j1 = 0;
+            for (int j = 1; j <= n; j++)
+            {
+                if (!used_[j])
+                {
+                    const double cur = row[j - 1] - u_[i0] - v_[j];
+                    if (cur < minv_[j])
+                    {
+                        minv_[j] = cur;
+                        way_[j] = j0;
+                    }
+                    if (minv_[j] < delta)
+                    {
+                        delta = minv_[j];
+                        j1 = j;
+                    }
+                }
+            }
+            for (int j = 0; j <= n; j++)
+            {
+                if (used_[j])
+                {
+                    u_[p_[j]] += delta;
+                    v_[j] -= delta;
+                }
+                else
+                {
+                    minv_[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p_[j0] != 0);
+        do
+        {
+            const int j1 = way_[j0];
+            p_[j0] = p_[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    for (int j = 1; j <= c; j++)
+    {
+        const int i = p_[j] - 1;
+        if (i < r && cost_[(size_t)i * n + j - 1] < thresh)
+        {
+            row_match_[comp_rows_[i]] = comp_cols_[j - 1];
+            col_match_[comp_cols_[j - 1]] = comp_rows_[i];
+        }
+    }
+}
@@ -25,20 +25,24 @@ namespace maix::tracker
         byte_track::BYTETracker *bytetracker = (byte_track::BYTETracker*)_data;
         std::vector<tracker::Track> res;
         std::vector<byte_track::Object> objs2;
+        objs2.reserve(objs.size());
         for(const auto &obj : objs)
         {
             byte_track::Rect<float> rect(obj.x, obj.y, obj.w, obj.h);
             objs2.push_back(byte_track::Object(rect, obj.class_id, obj.score));
         }
-        const auto &res0 = bytetracker->update(objs2);
-        for (const auto &r : res0)
+        const std::vector<int> &res0 = bytetracker->update(objs2);
+        res.reserve(res0.size());
+        for (const int slot : res0)
         {
-            res.push_back(tracker::Track(r->getTrackId(), r->getScore(), r->getLost(), r->getStartFrameId(), r->getFrameId()));
+            res.push_back(tracker::Track(bytetracker->getTrackId(slot), bytetracker->getScore(slot), bytetracker->getLost(slot),
+                                         bytetracker->getStartFrameId(slot), bytetracker->getFrameId(slot)));
             tracker::Track &track = res.back();
-            const std::deque<byte_track::Object> &history = r->get_rect_history();
-            for(const auto &i : history)
+            int history_size = bytetracker->getHistorySize(slot);
+            for (int i = 0; i < history_size; ++i)
             {
-                track.history.push_back(tracker::Object(i.rect.x(), i.rect.y(), i.rect.width(), i.rect.height(), i.label, i.prob));
+                const byte_track::Object &h = bytetracker->getHistory(slot, i);
+                track.history.push_back(tracker::Object(h.rect.x(), h.rect.y(), h.rect.width(), h.rect.height(), h.label, h.prob));
             }
         }
         return res;
@@ -6,6 +6,7 @@
  */
 
 #include "maix_image.hpp"
+#include "maix_image_yuv.hpp"
 #include "opencv2/opencv.hpp"
 #include "opencv2/freetype.hpp"
 #include <map>
@@ -425,6 +426,8 @@ namespace maix::image
 
     Image::~Image()
     {
+        if (_release_cb)
+            _release_cb();
         if (_is_malloc)
         {
             // log::debug("free image data\n");
@@ -436,6 +439,11 @@ namespace maix::image
 
     err::Err Image::update(int width, int height, image::Format format, uint8_t *data, int data_size, bool copy)
     {
+        if (_release_cb)
+        {
+            _release_cb();
+            _release_cb = nullptr;
+        }
         if (_actual_data && _is_malloc)
         {
             // log::debug("free image data\n");
@@ -793,6 +801,23 @@ namespace maix::image
             throw err::Exception(err::ERR_ARGS, "not wupport format");
         }
 
+        // YUV to RGB BGR RGBA BGRA GRAYSCALE, BT601 limited range same as OpenCV
+        image::YUVLayout layout;
+        if (image::yuv_layout(_format, layout) &&
+            (format == image::FMT_RGB888 || format == image::FMT_BGR888 ||
+             format == image::FMT_RGBA8888 || format == image::FMT_BGRA8888 || format == image::FMT_GRAYSCALE))
+        {
+            image::Image *img = _new_image(_width, _height, format, buff, buff_size);
+            err::Err e = image::convert_yuv(layout, (const uint8_t *)_data, _width, _height, format, (uint8_t *)img->data(),
+                                            image::YUV_BT601, image::YUV_RANGE_LIMITED);
+            if (e != err::ERR_NONE)
+            {
+                delete img;
+                throw err::Exception(e, "convert yuv format failed");
+            }
+            return img;
+        }
+
         // RGB BGR BGRA RGBA GRAYSCALE YUV transform
         switch (_format)
         {
@@ -907,20 +932,6 @@ namespace maix::image
                 throw err::Exception(err::ERR_NOT_IMPL, "not support format");
             }
             break;
-        case image::FMT_YVU420SP:
-            switch (format)
-            {
-            case image::FMT_GRAYSCALE:
-            {
-                auto img = new image::Image(_width, _height, image::FMT_GRAYSCALE);
-                memcpy(img->data(), _data, _width * _height);
-                return img;
-            }
-            break;
-            default:
-                throw err::Exception(err::ERR_NOT_IMPL, "not support format");
-            }
-            break;
         default:
             throw err::Exception(err::ERR_NOT_IMPL, "not support format");
         }
@@ -1435,8 +1446,74 @@ namespace maix::image
         return this;
     }
 
+    /**
+     * Resize planar or semi-planar YUV image on Y and UV planes directly, no RGB round trip.
+     * Content rect is aligned to 2 to keep chroma grid.
+     */
+    static void _resize_yuv(image::Image *src, image::Image *dst, image::YUVLayout layout, image::Fit object_fit, image::ResizeMethod method)
+    {
+        int sw = src->width(), sh = src->height();
+        int dw = dst->width(), dh = dst->height();
+        int sx = 0, sy = 0, dx = 0, dy = 0;
+        int cw = dw, ch = dh;
+        if (object_fit == image::Fit::FIT_CONTAIN)
+        {
+            float scale = std::min((float)dw / sw, (float)dh / sh);
+            cw = std::min(dw, std::max(2, (int)(sw * scale + 0.5f) & ~1));
+            ch = std::min(dh, std::max(2, (int)(sh * scale + 0.5f) & ~1));
+            dx = ((dw - cw) / 2) & ~1;
+            dy = ((dh - ch) / 2) & ~1;
+            image::fill_yuv(layout, (uint8_t *)dst->data(), dw, dh, 0, 0, dw, dh);
+        }
+        else if (object_fit == image::Fit::FIT_COVER)
+        {
+            float scale = std::max((float)dw / sw, (float)dh / sh);
+            int w = std::min(sw, std::max(2, (int)(dw / scale + 0.5f) & ~1));
+            int h = std::min(sh, std::max(2, (int)(dh / scale + 0.5f) & ~1));
+            sx = ((sw - w) / 2) & ~1;
+            sy = ((sh - h) / 2) & ~1;
+            sw = w;
+            sh = h;
+        }
+        else if (object_fit != image::Fit::FIT_FILL)
+        {
+            throw std::runtime_error("not support object fit");
+        }
+        err::Err e = image::resize_yuv(layout, (const uint8_t *)src->data(), src->width(), src->height(), sx, sy, sw, sh,
+                                       (uint8_t *)dst->data(), dw, dh, dx, dy, cw, ch, method);
+        if (e != err::ERR_NONE)
+            throw err::Exception(e, "resize yuv image failed");
+    }
+
+    static inline bool _yuv_chroma_aligned(image::YUVLayout layout, int width, int height)
+    {
+        bool v_sub = layout != image::YUV_NV16 && layout != image::YUV_I422;
+        return width % 2 == 0 && (!v_sub || height % 2 == 0);
+    }
+
     image::Image *Image::resize(int width, int height, image::Fit object_fit, image::ResizeMethod method)
     {
+        image::YUVLayout layout;
+        if (image::yuv_layout(_format, layout))
+        {
+            if (width == -1)
+                width = height * _width / _height;
+            else if (height == -1)
+                height = width * _height / _width;
+            if (!_yuv_chroma_aligned(layout, width, height))
+                throw std::runtime_error("yuv image width and height must be even");
+            image::Image *ret = new image::Image(width, height, _format);
+            try
+            {
+                _resize_yuv(this, ret, layout, object_fit, method);
+            }
+            catch (...)
+            {
+                delete ret;
+                throw;
+            }
+            return ret;
+        }
         int pixel_num = 0;
         int cv_h = 0;
         int cv_dst_h = 0;
@@ -1465,11 +1542,6 @@ namespace maix::image
             cv_h = _height;
             cv_dst_h = height;
             break;
-        case image::FMT_YVU420SP:
-            pixel_num = CV_8UC1;
-            cv_h = _height + _height / 2;
-            cv_dst_h = height + height / 2;
-            break;
         default:
             throw std::runtime_error("not support format");
             break;
@@ -1490,19 +1562,8 @@ namespace maix::image
         cv::InterpolationFlags inter_method = (cv::InterpolationFlags)method;
         if (object_fit == image::Fit::FIT_FILL)
         {
-            if (_format == image::FMT_YVU420SP)
-            {
-                cv::Mat rgb, resize_rgb;
-                cv::cvtColor(img, rgb, cv::COLOR_YUV2RGB_NV21);
-                cv::resize(rgb, resize_rgb, cv::Size(width, height), 0, 0, inter_method);
-                dst = cv::Mat(cv_dst_h, width, pixel_num, ret->data());
-                _cv_rgb_nv21(resize_rgb, dst, width, height);
-            }
-            else
-            {
-                dst = cv::Mat(height, width, pixel_num, ret->data());
-                cv::resize(img, dst, cv::Size(width, height), 0, 0, inter_method);
-            }
+            dst = cv::Mat(height, width, pixel_num, ret->data());
+            cv::resize(img, dst, cv::Size(width, height), 0, 0, inter_method);
         }
         else if (object_fit == image::Fit::FIT_CONTAIN)
         {
@@ -1654,6 +1715,22 @@ namespace maix::image
 
     image::Image *Image::crop(int x, int y, int w, int h)
     {
+        image::YUVLayout layout;
+        if (image::yuv_layout(_format, layout))
+        {
+            // align to chroma grid, crop is copy of Y and UV rows
+            if (!_yuv_chroma_aligned(layout, x, y) || !_yuv_chroma_aligned(layout, w, h))
+                throw std::runtime_error("yuv image crop x, y, w, h must be even");
+            image::Image *ret = new image::Image(w, h, _format);
+            err::Err e = image::resize_yuv(layout, (const uint8_t *)_data, _width, _height, x, y, w, h,
+                                           (uint8_t *)ret->data(), w, h, 0, 0, w, h, image::NEAREST);
+            if (e != err::ERR_NONE)
+            {
+                delete ret;
+                throw err::Exception(e, "crop yuv image failed");
+            }
+            return ret;
+        }
         image::Image *ret = new image::Image(w, h, _format);
         ;
         int pixel_num = _get_cv_pixel_num(_format);
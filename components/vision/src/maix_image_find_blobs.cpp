@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Use precompiled LAB thresholds.
  */
 
 #include "maix_image.hpp"
@@ -46,6 +47,7 @@ namespace maix::image
                 lnk_data.AMax = std::max(lnk_data_tmp.AMin, lnk_data_tmp.AMax);
                 lnk_data.BMin = std::min(lnk_data_tmp.BMin, lnk_data_tmp.BMax);
                 lnk_data.BMax = std::max(lnk_data_tmp.BMin, lnk_data_tmp.BMax);
+                lnk_data.lut = NULL;
                 list_push_back(out, &lnk_data);
             }
         }
@@ -54,6 +56,12 @@ namespace maix::image
     std::vector<image::Blob> Image::find_blobs(std::vector<std::vector<int>> thresholds, bool invert, std::vector<int> roi, int x_stride, int y_stride, int area_threshold, int pixels_threshold, bool merge, int margin, int x_hist_bins_max, int y_hist_bins_max)
     {
         err::check_bool_raise(thresholds.size() != 0, "You need to set thresholds");
+        return find_blobs(*LABThresholds::get(thresholds), invert, roi, x_stride, y_stride, area_threshold, pixels_threshold, merge, margin, x_hist_bins_max, y_hist_bins_max);
+    }
+
+    std::vector<image::Blob> Image::find_blobs(const image::LABThresholds &thresholds, bool invert, std::vector<int> roi, int x_stride, int y_stride, int area_threshold, int pixels_threshold, bool merge, int margin, int x_hist_bins_max, int y_hist_bins_max)
+    {
+        err::check_bool_raise(thresholds.thresholds().size() != 0, "You need to set thresholds");
         image_t src_img;
         convert_to_imlib_image(this, &src_img);
 
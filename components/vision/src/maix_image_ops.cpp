@@ -3,6 +3,7 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Use precompiled LAB thresholds in binary and get_regression.
  */
 
 #include "maix_image.hpp"
@@ -229,13 +230,51 @@ namespace maix::image {
 
     image::Image *Image::binary(std::vector<std::vector<int>> thresholds, bool invert, bool zero, image::Image *mask, bool to_bitmap, bool copy) {
         err::check_bool_raise(thresholds.size() != 0, "You need to set thresholds");
-        err::check_bool_raise(to_bitmap == false, "Parameter to_bitmap is not supported");
+        return binary(*LABThresholds::get(thresholds), invert, zero, mask, to_bitmap, copy);
+    }
 
-        list_t thresholds_list;
-        list_init(&thresholds_list, sizeof(color_thresholds_list_lnk_data_t));
-        _convert_to_lab_thresholds(thresholds, &thresholds_list);
+    // one pass of RGB565 and RGB888 without mask, same result as imlib_binary
+    static void _binary_lut(image::Image *src, image::Image *dst, const image::LABThresholds &thresholds, bool invert, bool zero) {
+        int w = src->width(), h = src->height();
+        std::vector<uint8_t> bits(w);
+        if (src->format() == image::FMT_RGB565) {
+            uint16_t white = COLOR_BINARY_TO_RGB565(1), black = COLOR_BINARY_TO_RGB565(0);
+            for (int y = 0; y < h; y++) {
+                const uint16_t *src_row = (const uint16_t *)src->data() + y * w;
+                uint16_t *dst_row = (uint16_t *)dst->data() + y * w;
+                thresholds.classify_rgb565(src_row, bits.data(), w, invert);
+                for (int x = 0; x < w; x++) {
+                    dst_row[x] = zero ? (bits[x] ? 0 : src_row[x]) : (bits[x] ? white : black);
+                }
+            }
+        } else {
+            pixel_rgb_t white = COLOR_BINARY_TO_RGB888(1), black = COLOR_BINARY_TO_RGB888(0);
+            for (int y = 0; y < h; y++) {
+                const uint8_t *src_row = (const uint8_t *)src->data() + y * w * 3;
+                uint8_t *dst_row = (uint8_t *)dst->data() + y * w * 3;
+                thresholds.classify_rgb888(src_row, bits.data(), w, invert);
+                for (int x = 0; x < w; x++) {
+                    const uint8_t *s = src_row + x * 3;
+                    uint8_t *d = dst_row + x * 3;
+                    if (zero) {
+                        d[0] = bits[x] ? 0 : s[0];
+                        d[1] = bits[x] ? 0 : s[1];
+                        d[2] = bits[x] ? 0 : s[2];
+                    } else {
+                        const pixel_rgb_t &c = bits[x] ? white : black;
+                        d[0] = c.r;
+                        d[1] = c.g;
+                        d[2] = c.b;
+                    }
+                }
+            }
+        }
+    }
+
+    image::Image *Image::binary(const image::LABThresholds &thresholds, bool invert, bool zero, image::Image *mask, bool to_bitmap, bool copy) {
+        err::check_bool_raise(thresholds.thresholds().size() != 0, "You need to set thresholds");
+        err::check_bool_raise(to_bitmap == false, "Parameter to_bitmap is not supported");
 
-        image_t src_img, mask_img, out_img;
         image::Image *dst = nullptr;
         if (copy) {
             dst = new image::Image(_width, _height, _format);
@@ -243,6 +282,17 @@ namespace maix::image {
             dst = this;
         }
 
+        if (!mask && (_format == image::FMT_RGB565 || _format == image::FMT_RGB888 || _format == image::FMT_BGR888)) {
+            _binary_lut(this, dst, thresholds, invert, zero);
+            return dst;
+        }
+
+        list_t thresholds_list;
+        list_init(&thresholds_list, sizeof(color_thresholds_list_lnk_data_t));
+        _convert_to_lab_thresholds(thresholds, &thresholds_list);
+
+        image_t src_img, mask_img, out_img;
+
         convert_to_imlib_image(this, &src_img);
         convert_to_imlib_image(dst, &out_img);
         if (mask) {
@@ -1156,6 +1206,10 @@ namespace maix::image {
     }
 
     std::vector<image::Line> Image::get_regression(std::vector<std::vector<int>> thresholds, bool invert, std::vector<int> roi, int x_stride, int y_stride, int area_threshold, int pixels_threshold, bool robust) {
+        return get_regression(*LABThresholds::get(thresholds), invert, roi, x_stride, y_stride, area_threshold, pixels_threshold, robust);
+    }
+
+    std::vector<image::Line> Image::get_regression(const image::LABThresholds &thresholds, bool invert, std::vector<int> roi, int x_stride, int y_stride, int area_threshold, int pixels_threshold, bool robust) {
         std::vector<image::Line> lines = std::vector<image::Line>();
         image_t src_img;
         if (_format != image::FMT_GRAYSCALE && _format != image::FMT_RGB888 && _format != image::FMT_RGB565) {
@@ -1298,4 +1352,27 @@ namespace maix::image {
         }
         return this;
     }
-}
\ No newline at end of file
+
+    void set_arena_default_size(int size) {
+        err::check_bool_raise(size > 0, "arena size must be greater than 0");
+        fb_alloc_set_default_size(size);
+    }
+
+    void set_arena_size(int size) {
+        err::check_bool_raise(size > 0, "arena size must be greater than 0");
+        fb_realloc_init1(size);
+        fb_alloc_stats_t stats;
+        fb_alloc_get_stats(&stats);
+        err::check_bool_raise(stats.size == (uint32_t)size, "alloc arena failed");
+    }
+
+    std::map<std::string, int> arena_stats() {
+        fb_alloc_stats_t stats;
+        fb_alloc_get_stats(&stats);
+        return std::map<std::string, int>{{"size", (int)stats.size}, {"used", (int)stats.used}, {"peak", (int)stats.peak}};
+    }
+
+    void reset_arena_peak() {
+        fb_alloc_reset_peak();
+    }
+}
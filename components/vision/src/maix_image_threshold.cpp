@@ -0,0 +1,217 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add precompiled LAB thresholds, create this file.
+ */
+
+#include "maix_image_threshold.hpp"
+#include "maix_image_util.hpp"
+#include <list>
+#include <mutex>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define TH_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define TH_RVV 1
+#elif defined(__AVX2__)
+    // SSE2 has no gather and no 3 channels deinterleave, so only AVX2 on x86
+    #include <immintrin.h>
+    #define TH_AVX2 1
+#endif
+
+namespace maix::image
+{
+    #define TH_CACHE_MAX 8
+
+    LABThresholds::LABThresholds(const std::vector<std::vector<int>> &thresholds)
+        : _thresholds(thresholds)
+    {
+        list_t list;
+        list_init(&list, sizeof(color_thresholds_list_lnk_data_t));
+        _convert_to_lab_thresholds(_thresholds, &list);
+        int n = list_size(&list);
+        _bounds.reserve(n * 6);
+        _lut.assign((size_t)n * 8192, 0);
+        _binary.assign(8192 * 2, 0);
+        uint8_t *bits = _lut.data();
+        for (list_lnk_t *it = iterator_start_from_head(&list); it; it = iterator_next(it), bits += 8192)
+        {
+            color_thresholds_list_lnk_data_t lnk_data;
+            iterator_get(&list, it, &lnk_data);
+            _bounds.insert(_bounds.end(), {lnk_data.LMin, lnk_data.LMax, lnk_data.AMin, lnk_data.AMax, lnk_data.BMin, lnk_data.BMax});
+            // same test as imlib, so the bitmap never differs from LAB compares
+            for (int key = 0; key < 65536; ++key)
+            {
+                if (COLOR_THRESHOLD_RGB565((uint16_t)key, &lnk_data, false))
+                    bits[key >> 3] |= 1 << (key & 7);
+            }
+        }
+        list_free(&list);
+
+        // Image::binary sets pixel if (in threshold ^ invert) for any threshold
+        uint8_t *any_in = _binary.data();
+        uint8_t *any_out = any_in + 8192;
+        for (int i = 0; i < 8192; ++i)
+        {
+            uint8_t in = 0, all_in = n > 0 ? 0xff : 0;
+            for (int j = 0; j < n; ++j)
+            {
+                in |= _lut[(size_t)j * 8192 + i];
+                all_in &= _lut[(size_t)j * 8192 + i];
+            }
+            any_in[i] = in;
+            any_out[i] = n > 0 ? ~all_in : 0;
+        }
+    }
+
+    std::shared_ptr<LABThresholds> LABThresholds::get(const std::vector<std::vector<int>> &thresholds)
+    {
+        static std::mutex lock;
+        static std::list<std::shared_ptr<LABThresholds>> cache;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto it = cache.begin(); it != cache.end(); ++it)
+            {
+                if ((*it)->_thresholds == thresholds)
+                {
+                    cache.splice(cache.begin(), cache, it);
+                    return cache.front();
+                }
+            }
+        }
+        // compile out of lock, other threads can use cache meanwhile
+        auto compiled = std::make_shared<LABThresholds>(thresholds);
+        std::lock_guard<std::mutex> guard(lock);
+        cache.push_front(compiled);
+        if (cache.size() > TH_CACHE_MAX)
+            cache.pop_back();
+        return compiled;
+    }
+
+    uint32_t LABThresholds::mask(uint16_t rgb565) const
+    {
+        uint32_t res = 0;
+        for (int i = 0, n = std::min(size(), 32); i < n; ++i)
+            res |= (uint32_t)match(i, rgb565) << i;
+        return res;
+    }
+
+#if TH_AVX2
+    // RGB565 keys of 8 pixels(24 bytes) as int32
+    static inline __m256i _rgb888_keys8(const uint8_t *p)
+    {
+        const __m128i sh_lo = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i sh_hi = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+        __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), sh_lo);
+        __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 8)), sh_hi);
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        __m256i key = _mm256_slli_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0xf8)), 8);
+        key = _mm256_or_si256(key, _mm256_and_si256(_mm256_srli_epi32(v, 5), _mm256_set1_epi32(0x7e0)));
+        return _mm256_or_si256(key, _mm256_and_si256(_mm256_srli_epi32(v, 19), _mm256_set1_epi32(0x1f)));
+    }
+#endif
+
+    void LABThresholds::classify_rgb888(const uint8_t *rgb, uint8_t *out, int n, bool invert) const
+    {
+        const uint8_t *bits = binary_bitmap(invert);
+        int i = 0;
+#if TH_NEON
+        uint16_t keys[16];
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16x3_t px = vld3q_u8(rgb + i * 3);
+            uint8x16_t r = vandq_u8(px.val[0], vdupq_n_u8(0xf8));
+            uint8x16_t g = vandq_u8(px.val[1], vdupq_n_u8(0xfc));
+            uint8x16_t b = vshrq_n_u8(px.val[2], 3);
+            uint16x8_t lo = vorrq_u16(vorrq_u16(vshll_n_u8(vget_low_u8(r), 8), vshll_n_u8(vget_low_u8(g), 3)), vmovl_u8(vget_low_u8(b)));
+            uint16x8_t hi = vorrq_u16(vorrq_u16(vshll_n_u8(vget_high_u8(r), 8), vshll_n_u8(vget_high_u8(g), 3)), vmovl_u8(vget_high_u8(b)));
+            vst1q_u16(keys, lo);
+            vst1q_u16(keys + 8, hi);
+            // no gather on NEON, bitmap is 8KB and stays in L1
+            for (int j = 0; j < 16; ++j)
+                out[i + j] = COLOR_THRESHOLD_LUT_GET(bits, keys[j]);
+        }
+#elif TH_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            const uint8_t *p = rgb + i * 3;
+            vuint8m1_t r = __riscv_vand_vx_u8m1(__riscv_vlse8_v_u8m1(p, 3, vl), 0xf8, vl);
+            vuint8m1_t g = __riscv_vand_vx_u8m1(__riscv_vlse8_v_u8m1(p + 1, 3, vl), 0xfc, vl);
+            vuint8m1_t b = __riscv_vsrl_vx_u8m1(__riscv_vlse8_v_u8m1(p + 2, 3, vl), 3, vl);
+            vuint16m2_t key = __riscv_vsll_vx_u16m2(__riscv_vzext_vf2_u16m2(r, vl), 8, vl);
+            key = __riscv_vor_vv_u16m2(key, __riscv_vsll_vx_u16m2(__riscv_vzext_vf2_u16m2(g, vl), 3, vl), vl);
+            key = __riscv_vor_vv_u16m2(key, __riscv_vzext_vf2_u16m2(b, vl), vl);
+            vuint8m1_t v = __riscv_vluxei16_v_u8m1(bits, __riscv_vsrl_vx_u16m2(key, 3, vl), vl);
+            vuint8m1_t shift = __riscv_vncvt_x_x_w_u8m1(__riscv_vand_vx_u16m2(key, 7, vl), vl);
+            __riscv_vse8_v_u8m1(out + i, __riscv_vand_vx_u8m1(__riscv_vsrl_vv_u8m1(v, shift, vl), 1, vl), vl);
+        }
+#elif TH_AVX2
+        // vpgatherdd is slower than scalar loads from the 8KB bitmap, so only keys are computed with SIMD
+        alignas(32) uint16_t keys[16];
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i k = _mm256_packus_epi32(_rgb888_keys8(rgb + i * 3), _rgb888_keys8(rgb + i * 3 + 24));
+            _mm256_store_si256((__m256i *)keys, _mm256_permute4x64_epi64(k, 0xd8));
+            for (int j = 0; j < 16; ++j)
+                out[i + j] = COLOR_THRESHOLD_LUT_GET(bits, keys[j]);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const uint8_t *p = rgb + i * 3;
+            uint16_t key = COLOR_R8_G8_B8_TO_RGB565(p[0], p[1], p[2]);
+            out[i] = COLOR_THRESHOLD_LUT_GET(bits, key);
+        }
+    }
+
+    void LABThresholds::classify_rgb565(const uint16_t *rgb565, uint8_t *out, int n, bool invert) const
+    {
+        const uint8_t *bits = binary_bitmap(invert);
+        int i = 0;
+#if TH_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            vuint16m2_t key = __riscv_vle16_v_u16m2(rgb565 + i, vl);
+            vuint8m1_t v = __riscv_vluxei16_v_u8m1(bits, __riscv_vsrl_vx_u16m2(key, 3, vl), vl);
+            vuint8m1_t shift = __riscv_vncvt_x_x_w_u8m1(__riscv_vand_vx_u16m2(key, 7, vl), vl);
+            __riscv_vse8_v_u8m1(out + i, __riscv_vand_vx_u8m1(__riscv_vsrl_vv_u8m1(v, shift, vl), 1, vl), vl);
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = COLOR_THRESHOLD_LUT_GET(bits, rgb565[i]);
+    }
+
+    const char *LABThresholds::simd()
+    {
+#if TH_NEON
+        return "neon";
+#elif TH_RVV
+        return "rvv";
+#elif TH_AVX2
+        return "avx2";
+#else
+        return "scalar";
+#endif
+    }
+
+    void _convert_to_lab_thresholds(const LABThresholds &in, list_t *out)
+    {
+        for (int i = 0; i < in.size(); i ++) {
+            const int *bounds = in.bounds(i);
+            color_thresholds_list_lnk_data_t lnk_data;
+            lnk_data.LMin = bounds[0];
+            lnk_data.LMax = bounds[1];
+            lnk_data.AMin = bounds[2];
+            lnk_data.AMax = bounds[3];
+            lnk_data.BMin = bounds[4];
+            lnk_data.BMax = bounds[5];
+            lnk_data.lut = in.bitmap(i);
+            list_push_back(out, &lnk_data);
+        }
+    }
+} // namespace maix::image
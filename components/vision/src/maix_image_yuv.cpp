@@ -0,0 +1,1034 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Add fixed-point YUV to RGB conversion, create this file.
+ */
+
+#include "maix_image_yuv.hpp"
+#include "maix_log.hpp"
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define YUV_NEON 1
+#elif defined(__riscv_vector) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 11000
+    #include <riscv_vector.h>
+    #define YUV_RVV 1
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define YUV_AVX2 1
+    #define YUV_SSE2 1
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define YUV_SSE2 1
+#endif
+
+namespace maix::image
+{
+    /*
+     * Fixed-point coefficients, Q13, every coefficient fits int16 so SSE2 madd and NEON mull can be used:
+     *   r = (yc * (y - y_off) + crv * (v - 128) + round) >> 13
+     *   g = (yc * (y - y_off) - cgu * (u - 128) - cgv * (v - 128) + round) >> 13
+     *   b = (yc * (y - y_off) + cbu * (u - 128) + round) >> 13
+     * then saturate to [0, 255].
+     */
+    #define YUV_SHIFT 13
+    #define YUV_ROUND (1 << (YUV_SHIFT - 1))
+
+    typedef struct
+    {
+        int16_t y_off;
+        int16_t yc;
+        int16_t crv;
+        int16_t cgu;
+        int16_t cgv;
+        int16_t cbu;
+    } _yuv_coef_t;
+
+    static _yuv_coef_t _yuv_coef(YUVMatrix matrix, YUVRange range)
+    {
+        double kr = matrix == YUV_BT709 ? 0.2126 : 0.299;
+        double kb = matrix == YUV_BT709 ? 0.0722 : 0.114;
+        double kg = 1 - kr - kb;
+        double ys = 1, cs = 1;
+        _yuv_coef_t coef;
+        coef.y_off = 0;
+        if (range == YUV_RANGE_LIMITED)
+        {
+            ys = 255.0 / 219;
+            cs = 255.0 / 224;
+            coef.y_off = 16;
+        }
+        double q = 1 << YUV_SHIFT;
+        coef.yc = (int16_t)(ys * q + 0.5);
+        coef.crv = (int16_t)(2 * (1 - kr) * cs * q + 0.5);
+        coef.cgu = (int16_t)(2 * (1 - kb) * kb / kg * cs * q + 0.5);
+        coef.cgv = (int16_t)(2 * (1 - kr) * kr / kg * cs * q + 0.5);
+        coef.cbu = (int16_t)(2 * (1 - kb) * cs * q + 0.5);
+        return coef;
+    }
+
+    // two int16 packed to int32, lo at low address, for SSE2 and AVX2 madd
+    static inline int32_t _pair(int lo, int hi)
+    {
+        return (int32_t)(((uint32_t)(uint16_t)hi << 16) | (uint16_t)lo);
+    }
+
+    static inline uint8_t _clamp_u8(int v)
+    {
+        return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    /**
+     * y, u, v(full width, chroma already upsampled) to planar r, g, b.
+     */
+    static void _yuv_to_rgb_scalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                   uint8_t *r, uint8_t *g, uint8_t *b, int n, const _yuv_coef_t &c)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            int yy = c.yc * (y[i] - c.y_off) + YUV_ROUND;
+            int uu = u[i] - 128;
+            int vv = v[i] - 128;
+            r[i] = _clamp_u8((yy + c.crv * vv) >> YUV_SHIFT);
+            g[i] = _clamp_u8((yy - c.cgu * uu - c.cgv * vv) >> YUV_SHIFT);
+            b[i] = _clamp_u8((yy + c.cbu * uu) >> YUV_SHIFT);
+        }
+    }
+
+#if YUV_NEON
+    static inline uint8x8_t _neon_ch(int16x8_t y, int16x8_t c0, int16_t yc, int16_t k0)
+    {
+        int32x4_t lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(y), yc), vget_low_s16(c0), k0);
+        int32x4_t hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(y), yc), vget_high_s16(c0), k0);
+        return vqmovn_u16(vcombine_u16(vqrshrun_n_s32(lo, YUV_SHIFT), vqrshrun_n_s32(hi, YUV_SHIFT)));
+    }
+
+    static inline uint8x8_t _neon_g(int16x8_t y, int16x8_t u, int16x8_t v, const _yuv_coef_t &c)
+    {
+        int32x4_t lo = vmull_n_s16(vget_low_s16(y), c.yc);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(y), c.yc);
+        lo = vmlsl_n_s16(vmlsl_n_s16(lo, vget_low_s16(u), c.cgu), vget_low_s16(v), c.cgv);
+        hi = vmlsl_n_s16(vmlsl_n_s16(hi, vget_high_s16(u), c.cgu), vget_high_s16(v), c.cgv);
+        return vqmovn_u16(vcombine_u16(vqrshrun_n_s32(lo, YUV_SHIFT), vqrshrun_n_s32(hi, YUV_SHIFT)));
+    }
+
+    static int _yuv_to_rgb_simd(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *r, uint8_t *g, uint8_t *b, int n, const _yuv_coef_t &c)
+    {
+        uint8x8_t y_off = vdup_n_u8((uint8_t)c.y_off);
+        uint8x8_t c_off = vdup_n_u8(128);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t y8 = vld1q_u8(y + i);
+            uint8x16_t u8 = vld1q_u8(u + i);
+            uint8x16_t v8 = vld1q_u8(v + i);
+            for (int h = 0; h < 2; ++h)
+            {
+                uint8x8_t yh = h ? vget_high_u8(y8) : vget_low_u8(y8);
+                uint8x8_t uh = h ? vget_high_u8(u8) : vget_low_u8(u8);
+                uint8x8_t vh = h ? vget_high_u8(v8) : vget_low_u8(v8);
+                int16x8_t y16 = vreinterpretq_s16_u16(vsubl_u8(yh, y_off));
+                int16x8_t u16 = vreinterpretq_s16_u16(vsubl_u8(uh, c_off));
+                int16x8_t v16 = vreinterpretq_s16_u16(vsubl_u8(vh, c_off));
+                vst1_u8(r + i + h * 8, _neon_ch(y16, v16, c.yc, c.crv));
+                vst1_u8(g + i + h * 8, _neon_g(y16, u16, v16, c));
+                vst1_u8(b + i + h * 8, _neon_ch(y16, u16, c.yc, c.cbu));
+            }
+        }
+        return i;
+    }
+
+    static int _pack_simd(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *dst, int n, int ch, bool bgr)
+    {
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t c0 = vld1q_u8((bgr ? b : r) + i);
+            uint8x16_t c1 = vld1q_u8(g + i);
+            uint8x16_t c2 = vld1q_u8((bgr ? r : b) + i);
+            if (ch == 3)
+            {
+                uint8x16x3_t px = {{c0, c1, c2}};
+                vst3q_u8(dst + i * 3, px);
+            }
+            else
+            {
+                uint8x16x4_t px = {{c0, c1, c2, vdupq_n_u8(255)}};
+                vst4q_u8(dst + i * 4, px);
+            }
+        }
+        return i;
+    }
+#elif YUV_RVV
+    static inline vuint8m1_t _rvv_narrow(vint32m4_t acc, size_t vl)
+    {
+        acc = __riscv_vadd_vx_i32m4(acc, YUV_ROUND, vl);
+        acc = __riscv_vmax_vx_i32m4(acc, 0, vl);
+        acc = __riscv_vmin_vx_i32m4(acc, 255 << YUV_SHIFT, vl);
+        vuint16m2_t x = __riscv_vnsrl_wx_u16m2(__riscv_vreinterpret_v_i32m4_u32m4(acc), YUV_SHIFT, vl);
+        return __riscv_vncvt_x_x_w_u8m1(x, vl);
+    }
+
+    static int _yuv_to_rgb_simd(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *r, uint8_t *g, uint8_t *b, int n, const _yuv_coef_t &c)
+    {
+        int i = 0;
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            vint16m2_t y16 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vwsubu_vx_u16m2(__riscv_vle8_v_u8m1(y + i, vl), (uint8_t)c.y_off, vl));
+            vint16m2_t u16 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vwsubu_vx_u16m2(__riscv_vle8_v_u8m1(u + i, vl), 128, vl));
+            vint16m2_t v16 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vwsubu_vx_u16m2(__riscv_vle8_v_u8m1(v + i, vl), 128, vl));
+            vint32m4_t yy = __riscv_vwmul_vx_i32m4(y16, c.yc, vl);
+            __riscv_vse8_v_u8m1(r + i, _rvv_narrow(__riscv_vwmacc_vx_i32m4(yy, c.crv, v16, vl), vl), vl);
+            vint32m4_t gg = __riscv_vwmacc_vx_i32m4(yy, (int16_t)-c.cgu, u16, vl);
+            __riscv_vse8_v_u8m1(g + i, _rvv_narrow(__riscv_vwmacc_vx_i32m4(gg, (int16_t)-c.cgv, v16, vl), vl), vl);
+            __riscv_vse8_v_u8m1(b + i, _rvv_narrow(__riscv_vwmacc_vx_i32m4(yy, c.cbu, u16, vl), vl), vl);
+        }
+        return i;
+    }
+
+    static int _pack_simd(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *dst, int n, int ch, bool bgr)
+    {
+        const uint8_t *c0 = bgr ? b : r;
+        const uint8_t *c2 = bgr ? r : b;
+        int i = 0;
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e8m1(n - i);
+            uint8_t *p = dst + i * ch;
+            __riscv_vsse8_v_u8m1(p, ch, __riscv_vle8_v_u8m1(c0 + i, vl), vl);
+            __riscv_vsse8_v_u8m1(p + 1, ch, __riscv_vle8_v_u8m1(g + i, vl), vl);
+            __riscv_vsse8_v_u8m1(p + 2, ch, __riscv_vle8_v_u8m1(c2 + i, vl), vl);
+            if (ch == 4)
+                __riscv_vsse8_v_u8m1(p + 3, ch, __riscv_vmv_v_x_u8m1(255, vl), vl);
+        }
+        return i;
+    }
+#elif YUV_AVX2
+    static inline __m256i _avx2_ch(__m256i y_c0_lo, __m256i y_c0_hi, __m256i k, __m256i round)
+    {
+        __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(y_c0_lo, k), round), YUV_SHIFT);
+        __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(y_c0_hi, k), round), YUV_SHIFT);
+        return _mm256_packs_epi32(lo, hi);
+    }
+
+    // 16 pixels every 128 bits lane, return int16 r g b, same lane order as input
+    static inline void _avx2_16(__m256i y16, __m256i u16, __m256i v16, __m256i &r, __m256i &g, __m256i &b, const _yuv_coef_t &c)
+    {
+        const __m256i k_r = _mm256_set1_epi32(_pair(c.yc, c.crv));
+        const __m256i k_gu = _mm256_set1_epi32(_pair(c.yc, -c.cgu));
+        const __m256i k_gv = _mm256_set1_epi32(_pair(-c.cgv, YUV_ROUND));
+        const __m256i k_b = _mm256_set1_epi32(_pair(c.yc, c.cbu));
+        const __m256i round = _mm256_set1_epi32(YUV_ROUND);
+        const __m256i one = _mm256_set1_epi16(1);
+        __m256i yu_lo = _mm256_unpacklo_epi16(y16, u16);
+        __m256i yu_hi = _mm256_unpackhi_epi16(y16, u16);
+        r = _avx2_ch(_mm256_unpacklo_epi16(y16, v16), _mm256_unpackhi_epi16(y16, v16), k_r, round);
+        b = _avx2_ch(yu_lo, yu_hi, k_b, round);
+        __m256i g_lo = _mm256_add_epi32(_mm256_madd_epi16(yu_lo, k_gu), _mm256_madd_epi16(_mm256_unpacklo_epi16(v16, one), k_gv));
+        __m256i g_hi = _mm256_add_epi32(_mm256_madd_epi16(yu_hi, k_gu), _mm256_madd_epi16(_mm256_unpackhi_epi16(v16, one), k_gv));
+        g = _mm256_packs_epi32(_mm256_srai_epi32(g_lo, YUV_SHIFT), _mm256_srai_epi32(g_hi, YUV_SHIFT));
+    }
+
+    static int _yuv_to_rgb_simd(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *r, uint8_t *g, uint8_t *b, int n, const _yuv_coef_t &c)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i y_off = _mm256_set1_epi16(c.y_off);
+        const __m256i c_off = _mm256_set1_epi16(128);
+        int i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i y8 = _mm256_loadu_si256((const __m256i *)(y + i));
+            __m256i u8 = _mm256_loadu_si256((const __m256i *)(u + i));
+            __m256i v8 = _mm256_loadu_si256((const __m256i *)(v + i));
+            __m256i r0, g0, b0, r1, g1, b1;
+            // unpack and pack are both in 128 bits lane, so pixels order is kept
+            _avx2_16(_mm256_sub_epi16(_mm256_unpacklo_epi8(y8, zero), y_off),
+                     _mm256_sub_epi16(_mm256_unpacklo_epi8(u8, zero), c_off),
+                     _mm256_sub_epi16(_mm256_unpacklo_epi8(v8, zero), c_off), r0, g0, b0, c);
+            _avx2_16(_mm256_sub_epi16(_mm256_unpackhi_epi8(y8, zero), y_off),
+                     _mm256_sub_epi16(_mm256_unpackhi_epi8(u8, zero), c_off),
+                     _mm256_sub_epi16(_mm256_unpackhi_epi8(v8, zero), c_off), r1, g1, b1, c);
+            _mm256_storeu_si256((__m256i *)(r + i), _mm256_packus_epi16(r0, r1));
+            _mm256_storeu_si256((__m256i *)(g + i), _mm256_packus_epi16(g0, g1));
+            _mm256_storeu_si256((__m256i *)(b + i), _mm256_packus_epi16(b0, b1));
+        }
+        return i;
+    }
+#elif YUV_SSE2
+    static inline __m128i _sse2_ch(__m128i y_c0_lo, __m128i y_c0_hi, __m128i k, __m128i round)
+    {
+        __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(y_c0_lo, k), round), YUV_SHIFT);
+        __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(y_c0_hi, k), round), YUV_SHIFT);
+        return _mm_packs_epi32(lo, hi);
+    }
+
+    // 8 pixels, return int16 r g b
+    static inline void _sse2_8(__m128i y16, __m128i u16, __m128i v16, __m128i &r, __m128i &g, __m128i &b, const _yuv_coef_t &c)
+    {
+        const __m128i k_r = _mm_set1_epi32(_pair(c.yc, c.crv));
+        const __m128i k_gu = _mm_set1_epi32(_pair(c.yc, -c.cgu));
+        const __m128i k_gv = _mm_set1_epi32(_pair(-c.cgv, YUV_ROUND));
+        const __m128i k_b = _mm_set1_epi32(_pair(c.yc, c.cbu));
+        const __m128i round = _mm_set1_epi32(YUV_ROUND);
+        const __m128i one = _mm_set1_epi16(1);
+        __m128i yu_lo = _mm_unpacklo_epi16(y16, u16);
+        __m128i yu_hi = _mm_unpackhi_epi16(y16, u16);
+        r = _sse2_ch(_mm_unpacklo_epi16(y16, v16), _mm_unpackhi_epi16(y16, v16), k_r, round);
+        b = _sse2_ch(yu_lo, yu_hi, k_b, round);
+        // round is in the high half of k_gv and multiplied by 1
+        __m128i g_lo = _mm_add_epi32(_mm_madd_epi16(yu_lo, k_gu), _mm_madd_epi16(_mm_unpacklo_epi16(v16, one), k_gv));
+        __m128i g_hi = _mm_add_epi32(_mm_madd_epi16(yu_hi, k_gu), _mm_madd_epi16(_mm_unpackhi_epi16(v16, one), k_gv));
+        g = _mm_packs_epi32(_mm_srai_epi32(g_lo, YUV_SHIFT), _mm_srai_epi32(g_hi, YUV_SHIFT));
+    }
+
+    static int _yuv_to_rgb_simd(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *r, uint8_t *g, uint8_t *b, int n, const _yuv_coef_t &c)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i y_off = _mm_set1_epi16(c.y_off);
+        const __m128i c_off = _mm_set1_epi16(128);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i y8 = _mm_loadu_si128((const __m128i *)(y + i));
+            __m128i u8 = _mm_loadu_si128((const __m128i *)(u + i));
+            __m128i v8 = _mm_loadu_si128((const __m128i *)(v + i));
+            __m128i r0, g0, b0, r1, g1, b1;
+            _sse2_8(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), y_off),
+                    _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), c_off),
+                    _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), c_off), r0, g0, b0, c);
+            _sse2_8(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), y_off),
+                    _mm_sub_epi16(_mm_unpackhi_epi8(u8, zero), c_off),
+                    _mm_sub_epi16(_mm_unpackhi_epi8(v8, zero), c_off), r1, g1, b1, c);
+            _mm_storeu_si128((__m128i *)(r + i), _mm_packus_epi16(r0, r1));
+            _mm_storeu_si128((__m128i *)(g + i), _mm_packus_epi16(g0, g1));
+            _mm_storeu_si128((__m128i *)(b + i), _mm_packus_epi16(b0, b1));
+        }
+        return i;
+    }
+#endif
+
+#if YUV_SSE2
+    // x86 has no 3 channels interleave store, only 4 channels use SIMD
+    static int _pack_simd(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *dst, int n, int ch, bool bgr)
+    {
+        if (ch != 4)
+            return 0;
+        const __m128i alpha = _mm_set1_epi8((char)255);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i c0 = _mm_loadu_si128((const __m128i *)((bgr ? b : r) + i));
+            __m128i c1 = _mm_loadu_si128((const __m128i *)(g + i));
+            __m128i c2 = _mm_loadu_si128((const __m128i *)((bgr ? r : b) + i));
+            __m128i c01_lo = _mm_unpacklo_epi8(c0, c1);
+            __m128i c01_hi = _mm_unpackhi_epi8(c0, c1);
+            __m128i c23_lo = _mm_unpacklo_epi8(c2, alpha);
+            __m128i c23_hi = _mm_unpackhi_epi8(c2, alpha);
+            __m128i *p = (__m128i *)(dst + i * 4);
+            _mm_storeu_si128(p, _mm_unpacklo_epi16(c01_lo, c23_lo));
+            _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(c01_lo, c23_lo));
+            _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(c01_hi, c23_hi));
+            _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(c01_hi, c23_hi));
+        }
+        return i;
+    }
+#endif
+
+    static void _pack_scalar(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *dst, int n, int ch, bool bgr)
+    {
+        const uint8_t *c0 = bgr ? b : r;
+        const uint8_t *c2 = bgr ? r : b;
+        if (ch == 3)
+        {
+            for (int i = 0; i < n; ++i, dst += 3)
+            {
+                dst[0] = c0[i];
+                dst[1] = g[i];
+                dst[2] = c2[i];
+            }
+        }
+        else
+        {
+            for (int i = 0; i < n; ++i, dst += 4)
+            {
+                dst[0] = c0[i];
+                dst[1] = g[i];
+                dst[2] = c2[i];
+                dst[3] = 255;
+            }
+        }
+    }
+
+    /**
+     * Get Y of row, and U V of row upsampled to full width.
+     * Planar Y is returned directly, packed Y is unpacked to y_buff.
+     */
+    static const uint8_t *_unpack_row(YUVLayout layout, const uint8_t *src, int width, int height, int row,
+                                      uint8_t *y_buff, uint8_t *u, uint8_t *v)
+    {
+        int cw = (width + 1) / 2;
+        const uint8_t *y = src + (size_t)row * width;
+        const uint8_t *cu = NULL, *cv = NULL;
+        int c_step = 1;
+        switch (layout)
+        {
+        case YUV_YUYV:
+        case YUV_UYVY:
+        {
+            const uint8_t *p = src + (size_t)row * width * 2;
+            int yi = layout == YUV_YUYV ? 0 : 1;
+            int ui = layout == YUV_YUYV ? 1 : 0;
+            for (int i = 0; i < width; ++i)
+                y_buff[i] = p[i * 2 + yi];
+            for (int i = 0; i < width; ++i)
+            {
+                u[i] = p[(i >> 1) * 4 + ui];
+                v[i] = p[(i >> 1) * 4 + ui + 2];
+            }
+            return y_buff;
+        }
+        case YUV_NV12:
+        case YUV_NV21:
+        case YUV_NV16:
+        {
+            int c_row = layout == YUV_NV16 ? row : row / 2;
+            const uint8_t *uv = src + (size_t)width * height + (size_t)c_row * cw * 2;
+            cu = layout == YUV_NV21 ? uv + 1 : uv;
+            cv = layout == YUV_NV21 ? uv : uv + 1;
+            c_step = 2;
+            break;
+        }
+        case YUV_I420:
+        case YUV_YV12:
+        case YUV_I422:
+        {
+            int c_h = layout == YUV_I422 ? height : (height + 1) / 2;
+            int c_row = layout == YUV_I422 ? row : row / 2;
+            const uint8_t *p0 = src + (size_t)width * height + (size_t)c_row * cw;
+            const uint8_t *p1 = p0 + (size_t)cw * c_h;
+            cu = layout == YUV_YV12 ? p1 : p0;
+            cv = layout == YUV_YV12 ? p0 : p1;
+            break;
+        }
+        default:
+            return NULL;
+        }
+        for (int i = 0; i < width; ++i)
+        {
+            u[i] = cu[(i >> 1) * c_step];
+            v[i] = cv[(i >> 1) * c_step];
+        }
+        return y;
+    }
+
+    bool yuv_layout(image::Format format, YUVLayout &layout)
+    {
+        switch (format)
+        {
+        case image::FMT_YUV420SP:
+            layout = YUV_NV12;
+            return true;
+        case image::FMT_YVU420SP:
+            layout = YUV_NV21;
+            return true;
+        case image::FMT_YUV422SP:
+            layout = YUV_NV16;
+            return true;
+        case image::FMT_YUV420P:
+            layout = YUV_I420;
+            return true;
+        case image::FMT_YVU420P:
+            layout = YUV_YV12;
+            return true;
+        case image::FMT_YUV422P:
+            layout = YUV_I422;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    err::Err convert_yuv(YUVLayout layout, const uint8_t *src, int width, int height, image::Format dst_format, uint8_t *dst,
+                         YUVMatrix matrix, YUVRange range, bool simd)
+    {
+        int ch;
+        bool bgr = dst_format == image::FMT_BGR888 || dst_format == image::FMT_BGRA8888;
+        switch (dst_format)
+        {
+        case image::FMT_RGB888:
+        case image::FMT_BGR888:
+            ch = 3;
+            break;
+        case image::FMT_RGBA8888:
+        case image::FMT_BGRA8888:
+            ch = 4;
+            break;
+        case image::FMT_GRAYSCALE:
+            ch = 1;
+            break;
+        default:
+            log::error("convert yuv not support dst format %d\n", dst_format);
+            return err::ERR_ARGS;
+        }
+        if (!src || !dst || width <= 0 || height <= 0 || layout > YUV_I422)
+            return err::ERR_ARGS;
+        bool planar_y = layout != YUV_YUYV && layout != YUV_UYVY;
+        if (ch == 1 && planar_y)
+        {
+            memcpy(dst, src, (size_t)width * height);
+            return err::ERR_NONE;
+        }
+
+        _yuv_coef_t coef = _yuv_coef(matrix, range);
+        // y, u, v, r, g, b rows
+        std::vector<uint8_t> rows((size_t)width * 6);
+        uint8_t *y_buff = rows.data();
+        uint8_t *u = y_buff + width;
+        uint8_t *v = u + width;
+        uint8_t *r = v + width;
+        uint8_t *g = r + width;
+        uint8_t *b = g + width;
+        for (int row = 0; row < height; ++row)
+        {
+            uint8_t *d = dst + (size_t)row * width * ch;
+            if (ch == 1)
+            {
+                _unpack_row(layout, src, width, height, row, d, u, v);
+                continue;
+            }
+            const uint8_t *y = _unpack_row(layout, src, width, height, row, y_buff, u, v);
+            int done = 0;
+#if YUV_NEON || YUV_RVV || YUV_SSE2
+            if (simd)
+                done = _yuv_to_rgb_simd(y, u, v, r, g, b, width, coef);
+#endif
+            _yuv_to_rgb_scalar(y + done, u + done, v + done, r + done, g + done, b + done, width - done, coef);
+            done = 0;
+#if YUV_NEON || YUV_RVV || YUV_SSE2
+            if (simd)
+                done = _pack_simd(r, g, b, d, width, ch, bgr);
+#endif
+            _pack_scalar(r + done, g + done, b + done, d + done * ch, width - done, ch, bgr);
+        }
+        return err::ERR_NONE;
+    }
+
+    const char *convert_yuv_simd()
+    {
+#if YUV_NEON
+        return "neon";
+#elif YUV_RVV
+        return "rvv";
+#elif YUV_AVX2
+        return "avx2";
+#elif YUV_SSE2
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    /**
+     * Y, U, V planes of planar or semi-planar image, U and V point to same plane with step 2 for semi-planar.
+     */
+    typedef struct
+    {
+        uint8_t *y;
+        uint8_t *u;
+        uint8_t *v;
+        uint8_t *uv;    // first byte of interleaved chroma plane, NULL for planar layouts
+        int c_w;        // chroma plane width in pixels
+        int c_h;        // chroma plane height
+        int c_step;     // 2 for semi-planar, 1 for planar
+        int c_shift_y;  // 1 for 4:2:0, 0 for 4:2:2
+    } _yuv_planes_t;
+
+    static bool _yuv_planes(YUVLayout layout, const uint8_t *src, int width, int height, _yuv_planes_t &p)
+    {
+        uint8_t *data = (uint8_t *)src;
+        p.y = data;
+        p.c_w = (width + 1) / 2;
+        p.c_shift_y = (layout == YUV_NV16 || layout == YUV_I422) ? 0 : 1;
+        p.c_h = p.c_shift_y ? (height + 1) / 2 : height;
+        uint8_t *c = data + (size_t)width * height;
+        switch (layout)
+        {
+        case YUV_NV12:
+        case YUV_NV21:
+        case YUV_NV16:
+            p.uv = c;
+            p.u = layout == YUV_NV21 ? c + 1 : c;
+            p.v = layout == YUV_NV21 ? c : c + 1;
+            p.c_step = 2;
+            return true;
+        case YUV_I420:
+        case YUV_YV12:
+        case YUV_I422:
+            p.uv = NULL;
+            p.u = layout == YUV_YV12 ? c + (size_t)p.c_w * p.c_h : c;
+            p.v = layout == YUV_YV12 ? c : c + (size_t)p.c_w * p.c_h;
+            p.c_step = 1;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    #define RESIZE_SHIFT 7
+    #define RESIZE_ONE (1 << RESIZE_SHIFT)
+
+    /**
+     * dst[i] = (h0[i] * (128 - wy) + h1[i] * wy + round) >> 14,
+     * h0 h1 are horizontal results of two src rows with Q7 weights, so <= 255 * 128 fits int16.
+     */
+    static void _blend_rows(const uint16_t *h0, const uint16_t *h1, int wy, uint8_t *dst, int n)
+    {
+        int i = 0;
+        int w0 = RESIZE_ONE - wy;
+#if YUV_NEON
+        uint16x4_t k0 = vdup_n_u16((uint16_t)w0);
+        uint16x4_t k1 = vdup_n_u16((uint16_t)wy);
+        for (; i + 8 <= n; i += 8)
+        {
+            uint16x8_t a = vld1q_u16(h0 + i);
+            uint16x8_t b = vld1q_u16(h1 + i);
+            uint32x4_t lo = vmlal_u16(vmull_u16(vget_low_u16(a), k0), vget_low_u16(b), k1);
+            uint32x4_t hi = vmlal_u16(vmull_u16(vget_high_u16(a), k0), vget_high_u16(b), k1);
+            uint16x8_t r = vcombine_u16(vrshrn_n_u32(lo, RESIZE_SHIFT * 2), vrshrn_n_u32(hi, RESIZE_SHIFT * 2));
+            vst1_u8(dst + i, vmovn_u16(r));
+        }
+#elif YUV_RVV
+        for (size_t vl; i < n; i += vl)
+        {
+            vl = __riscv_vsetvl_e16m2(n - i);
+            vuint16m2_t a = __riscv_vle16_v_u16m2(h0 + i, vl);
+            vuint16m2_t b = __riscv_vle16_v_u16m2(h1 + i, vl);
+            vuint32m4_t acc = __riscv_vwmulu_vx_u32m4(a, (uint16_t)w0, vl);
+            acc = __riscv_vwmaccu_vx_u32m4(acc, (uint16_t)wy, b, vl);
+            acc = __riscv_vadd_vx_u32m4(acc, 1 << (RESIZE_SHIFT * 2 - 1), vl);
+            vuint16m2_t r = __riscv_vnsrl_wx_u16m2(acc, RESIZE_SHIFT * 2, vl);
+            __riscv_vse8_v_u8m1(dst + i, __riscv_vnsrl_wx_u8m1(r, 0, vl), vl);
+        }
+#elif YUV_SSE2
+        __m128i k = _mm_set1_epi32(_pair(w0, wy));
+        __m128i round = _mm_set1_epi32(1 << (RESIZE_SHIFT * 2 - 1));
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)(h0 + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(h1 + i));
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k);
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k);
+            lo = _mm_srai_epi32(_mm_add_epi32(lo, round), RESIZE_SHIFT * 2);
+            hi = _mm_srai_epi32(_mm_add_epi32(hi, round), RESIZE_SHIFT * 2);
+            __m128i p = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(p, p));
+        }
+#endif
+        for (; i < n; ++i)
+            dst[i] = (uint8_t)((h0[i] * w0 + h1[i] * wy + (1 << (RESIZE_SHIFT * 2 - 1))) >> (RESIZE_SHIFT * 2));
+    }
+
+    /**
+     * Resize rect of one 8-bit plane with 1 or 2 interleaved channels row by row,
+     * pixel center aligned same as OpenCV, horizontal results of two src rows are cached,
+     * so every src row is interpolated horizontally only once when down scaling or up scaling.
+     */
+    class _PlaneResizer
+    {
+    public:
+        _PlaneResizer(const uint8_t *src, int stride, int sx, int sy, int sw, int sh, int dw, int dh, int cn, bool bilinear)
+            : _src(src), _stride(stride), _sx(sx), _sy(sy), _sw(sw), _sh(sh), _dw(dw), _dh(dh), _cn(cn), _bilinear(bilinear)
+        {
+            _copy = sw == dw && sh == dh;
+            if (_copy)
+                return;
+            _x0.resize(dw);
+            if (!bilinear)
+            {
+                for (int i = 0; i < dw; ++i)
+                    _x0[i] = (sx + std::min((int)((int64_t)i * sw / dw), sw - 1)) * cn;
+                return;
+            }
+            _x1.resize(dw);
+            _wx.resize(dw);
+            for (int i = 0; i < dw; ++i)
+            {
+                int x0, wx;
+                _coord(i, sw, dw, x0, wx);
+                _x0[i] = (sx + x0) * cn;
+                _x1[i] = (sx + std::min(x0 + 1, sw - 1)) * cn;
+                _wx[i] = (int16_t)wx;
+            }
+            _h[0].resize((size_t)dw * cn);
+            _h[1].resize((size_t)dw * cn);
+            _h_row[0] = _h_row[1] = -1;
+        }
+
+        /**
+         * Write dst row dy, dw * cn bytes.
+         */
+        void row(int dy, uint8_t *dst)
+        {
+            if (_copy)
+            {
+                memcpy(dst, _src + (size_t)(_sy + dy) * _stride + (size_t)_sx * _cn, (size_t)_dw * _cn);
+                return;
+            }
+            if (!_bilinear)
+            {
+                const uint8_t *s = _src + (size_t)(_sy + std::min((int)((int64_t)dy * _sh / _dh), _sh - 1)) * _stride;
+                if (_cn == 1)
+                {
+                    for (int i = 0; i < _dw; ++i)
+                        dst[i] = s[_x0[i]];
+                }
+                else
+                {
+                    for (int i = 0; i < _dw; ++i, dst += 2)
+                    {
+                        dst[0] = s[_x0[i]];
+                        dst[1] = s[_x0[i] + 1];
+                    }
+                }
+                return;
+            }
+            int y0, wy;
+            _coord(dy, _sh, _dh, y0, wy);
+            int y1 = std::min(y0 + 1, _sh - 1);
+            const uint16_t *h0 = _horizontal(y0);
+            const uint16_t *h1 = wy ? _horizontal(y1) : h0;
+            _blend_rows(h0, h1, wy, dst, _dw * _cn);
+        }
+
+    private:
+        // src coordinate of dst index i, integer part and Q7 fraction, clamped to [0, s - 1]
+        static void _coord(int i, int s, int d, int &i0, int &w)
+        {
+            float f = (i + 0.5f) * s / d - 0.5f;
+            i0 = (int)floorf(f);
+            w = (int)((f - i0) * RESIZE_ONE + 0.5f);
+            if (w == RESIZE_ONE)
+            {
+                ++i0;
+                w = 0;
+            }
+            if (i0 < 0)
+            {
+                i0 = 0;
+                w = 0;
+            }
+            else if (i0 >= s - 1)
+            {
+                i0 = s - 1;
+                w = 0;
+            }
+        }
+
+        const uint16_t *_horizontal(int y)
+        {
+            if (_h_row[0] == y)
+                return _h[0].data();
+            if (_h_row[1] == y)
+                return _h[1].data();
+            // replace the row farther from the next request, rows go down monotonically
+            int slot = _h_row[0] < _h_row[1] ? 0 : 1;
+            _h_row[slot] = y;
+            uint16_t *h = _h[slot].data();
+            const uint8_t *s = _src + (size_t)(_sy + y) * _stride;
+            if (_cn == 1)
+            {
+                for (int i = 0; i < _dw; ++i)
+                    h[i] = (uint16_t)(s[_x0[i]] * (RESIZE_ONE - _wx[i]) + s[_x1[i]] * _wx[i]);
+            }
+            else
+            {
+                for (int i = 0; i < _dw; ++i, h += 2)
+                {
+                    int w1 = _wx[i], w0 = RESIZE_ONE - w1;
+                    h[0] = (uint16_t)(s[_x0[i]] * w0 + s[_x1[i]] * w1);
+                    h[1] = (uint16_t)(s[_x0[i] + 1] * w0 + s[_x1[i] + 1] * w1);
+                }
+            }
+            return _h[slot].data();
+        }
+
+        const uint8_t *_src;
+        int _stride, _sx, _sy, _sw, _sh, _dw, _dh, _cn;
+        bool _bilinear;
+        bool _copy;
+        std::vector<int> _x0;
+        std::vector<int> _x1;
+        std::vector<int16_t> _wx;
+        std::vector<uint16_t> _h[2];
+        int _h_row[2];
+    };
+
+    // chroma rect of luma rect, covers all chroma samples touched by luma rect
+    static inline void _chroma_rect(int x, int y, int w, int h, int shift_y, int &cx, int &cy, int &cw, int &ch)
+    {
+        cx = x >> 1;
+        cw = ((x + w + 1) >> 1) - cx;
+        cy = y >> shift_y;
+        ch = ((y + h + shift_y) >> shift_y) - cy;
+    }
+
+    static inline bool _rect_valid(int width, int height, int x, int y, int w, int h)
+    {
+        return x >= 0 && y >= 0 && w > 0 && h > 0 && x + w <= width && y + h <= height;
+    }
+
+    err::Err resize_yuv(YUVLayout layout, const uint8_t *src, int src_w, int src_h, int sx, int sy, int sw, int sh,
+                        uint8_t *dst, int dst_w, int dst_h, int dx, int dy, int dw, int dh,
+                        image::ResizeMethod method)
+    {
+        _yuv_planes_t sp, dp;
+        if (!src || !dst || !_yuv_planes(layout, src, src_w, src_h, sp) || !_yuv_planes(layout, dst, dst_w, dst_h, dp))
+            return err::ERR_ARGS;
+        if (!_rect_valid(src_w, src_h, sx, sy, sw, sh) || !_rect_valid(dst_w, dst_h, dx, dy, dw, dh))
+            return err::ERR_ARGS;
+        bool bilinear = method != image::NEAREST;
+        {
+            _PlaneResizer r(sp.y, src_w, sx, sy, sw, sh, dw, dh, 1, bilinear);
+            for (int i = 0; i < dh; ++i)
+                r.row(i, dp.y + (size_t)(dy + i) * dst_w + dx);
+        }
+        int scx, scy, scw, sch, dcx, dcy, dcw, dch;
+        _chroma_rect(sx, sy, sw, sh, sp.c_shift_y, scx, scy, scw, sch);
+        _chroma_rect(dx, dy, dw, dh, dp.c_shift_y, dcx, dcy, dcw, dch);
+        if (sp.uv)
+        {
+            int stride = sp.c_w * 2;
+            _PlaneResizer r(sp.uv, stride, scx, scy, scw, sch, dcw, dch, 2, bilinear);
+            for (int i = 0; i < dch; ++i)
+                r.row(i, dp.uv + (size_t)(dcy + i) * dp.c_w * 2 + dcx * 2);
+            return err::ERR_NONE;
+        }
+        const uint8_t *s_planes[2] = {sp.u, sp.v};
+        uint8_t *d_planes[2] = {dp.u, dp.v};
+        for (int c = 0; c < 2; ++c)
+        {
+            _PlaneResizer r(s_planes[c], sp.c_w, scx, scy, scw, sch, dcw, dch, 1, bilinear);
+            for (int i = 0; i < dch; ++i)
+                r.row(i, d_planes[c] + (size_t)(dcy + i) * dp.c_w + dcx);
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err fill_yuv(YUVLayout layout, uint8_t *dst, int width, int height, int x, int y, int w, int h,
+                      uint8_t y_val, uint8_t u_val, uint8_t v_val)
+    {
+        _yuv_planes_t p;
+        if (!dst || !_yuv_planes(layout, dst, width, height, p) || !_rect_valid(width, height, x, y, w, h))
+            return err::ERR_ARGS;
+        for (int i = 0; i < h; ++i)
+            memset(p.y + (size_t)(y + i) * width + x, y_val, w);
+        int cx, cy, cw, ch;
+        _chroma_rect(x, y, w, h, p.c_shift_y, cx, cy, cw, ch);
+        int stride = p.c_w * p.c_step;
+        for (int i = 0; i < ch; ++i)
+        {
+            uint8_t *u = p.u + (size_t)(cy + i) * stride + cx * p.c_step;
+            uint8_t *v = p.v + (size_t)(cy + i) * stride + cx * p.c_step;
+            if (p.c_step == 1)
+            {
+                memset(u, u_val, cw);
+                memset(v, v_val, cw);
+                continue;
+            }
+            for (int j = 0; j < cw; ++j)
+            {
+                u[j * 2] = u_val;
+                v[j * 2] = v_val;
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+    err::Err preprocess_yuv(YUVLayout layout, const uint8_t *src, int width, int height, int x, int y, int w, int h,
+                            void *dst, int dst_w, int dst_h, image::Format dst_format, bool chw, bool to_float,
+                            const float *mean, const float *scale,
+                            image::Fit fit, image::ResizeMethod method, uint8_t pad,
+                            YUVMatrix matrix, YUVRange range, int *content)
+    {
+        int ch;
+        bool bgr = dst_format == image::FMT_BGR888;
+        if (dst_format == image::FMT_RGB888 || dst_format == image::FMT_BGR888)
+            ch = 3;
+        else if (dst_format == image::FMT_GRAYSCALE)
+            ch = 1;
+        else
+        {
+            log::error("preprocess yuv not support dst format %d\n", dst_format);
+            return err::ERR_ARGS;
+        }
+        _yuv_planes_t p;
+        if (!src || !dst || dst_w <= 0 || dst_h <= 0 || !_yuv_planes(layout, src, width, height, p))
+            return err::ERR_ARGS;
+        if (!_rect_valid(width, height, x, y, w, h))
+            return err::ERR_ARGS;
+
+        // content rect in dst and src rect mapped to it
+        int ox = 0, oy = 0, ow = dst_w, oh = dst_h;
+        if (fit == image::FIT_CONTAIN)
+        {
+            float s = std::min((float)dst_w / w, (float)dst_h / h);
+            ow = std::max(1, std::min(dst_w, (int)(w * s + 0.5f)));
+            oh = std::max(1, std::min(dst_h, (int)(h * s + 0.5f)));
+            ox = (dst_w - ow) / 2;
+            oy = (dst_h - oh) / 2;
+        }
+        else if (fit == image::FIT_COVER)
+        {
+            float s = std::max((float)dst_w / w, (float)dst_h / h);
+            int cw = std::max(1, std::min(w, (int)(dst_w / s + 0.5f)));
+            int chh = std::max(1, std::min(h, (int)(dst_h / s + 0.5f)));
+            x += (w - cw) / 2;
+            y += (h - chh) / 2;
+            w = cw;
+            h = chh;
+        }
+        if (content)
+        {
+            content[0] = ox;
+            content[1] = oy;
+            content[2] = ow;
+            content[3] = oh;
+        }
+
+        // value of every channel lookup table, float output only need 256 * ch multiply
+        std::vector<float> lut;
+        if (to_float)
+        {
+            lut.resize(256 * ch);
+            for (int c = 0; c < ch; ++c)
+            {
+                float m = mean ? mean[c] : 0;
+                float k = scale ? scale[c] : 1;
+                for (int i = 0; i < 256; ++i)
+                    lut[c * 256 + i] = (i - m) * k;
+            }
+        }
+        size_t plane = (size_t)dst_w * dst_h;
+        if (ox > 0 || oy > 0 || ow < dst_w || oh < dst_h)
+        {
+            if (!to_float)
+                memset(dst, pad, plane * ch);
+            else if (chw)
+            {
+                for (int c = 0; c < ch; ++c)
+                    std::fill((float *)dst + plane * c, (float *)dst + plane * (c + 1), lut[c * 256 + pad]);
+            }
+            else
+            {
+                float *d = (float *)dst;
+                for (size_t i = 0; i < plane; ++i)
+                    for (int c = 0; c < ch; ++c)
+                        *d++ = lut[c * 256 + pad];
+            }
+        }
+
+        bool bilinear = method != image::NEAREST;
+        _yuv_coef_t coef = _yuv_coef(matrix, range);
+        // y, u, v, r, g, b and interleaved uv rows
+        std::vector<uint8_t> rows((size_t)ow * 8);
+        uint8_t *yr = rows.data();
+        uint8_t *u = yr + ow;
+        uint8_t *v = u + ow;
+        uint8_t *r = v + ow;
+        uint8_t *g = r + ow;
+        uint8_t *b = g + ow;
+        uint8_t *uv = b + ow;
+        // chroma rect is resized to luma content size directly, so chroma is upsampled in the same pass
+        int cx, cy, cw, chh;
+        _chroma_rect(x, y, w, h, p.c_shift_y, cx, cy, cw, chh);
+        int c_stride = p.c_w * p.c_step;
+        // GRAYSCALE only need Y, semi-planar chroma only need one resizer, unused resizers get 1x1 rect
+        bool need_v = ch == 3 && !p.uv;
+        _PlaneResizer ry(p.y, width, x, y, w, h, ow, oh, 1, bilinear);
+        _PlaneResizer ruv(p.uv ? p.uv : p.u, c_stride, cx, cy, ch == 3 ? cw : 1, ch == 3 ? chh : 1, ch == 3 ? ow : 1, ch == 3 ? oh : 1, p.uv ? 2 : 1, bilinear);
+        _PlaneResizer rv(p.v, c_stride, cx, cy, need_v ? cw : 1, need_v ? chh : 1, need_v ? ow : 1, need_v ? oh : 1, 1, bilinear);
+        const uint8_t *out[3] = {bgr ? b : r, g, bgr ? r : b};
+        for (int i = 0; i < oh; ++i)
+        {
+            ry.row(i, yr);
+            if (ch == 3)
+            {
+                if (p.uv)
+                {
+                    ruv.row(i, uv);
+                    uint8_t *cu = p.u < p.v ? u : v;
+                    uint8_t *cv = p.u < p.v ? v : u;
+                    for (int j = 0; j < ow; ++j)
+                    {
+                        cu[j] = uv[j * 2];
+                        cv[j] = uv[j * 2 + 1];
+                    }
+                }
+                else
+                {
+                    ruv.row(i, u);
+                    rv.row(i, v);
+                }
+                int done = 0;
+#if YUV_NEON || YUV_RVV || YUV_SSE2
+                done = _yuv_to_rgb_simd(yr, u, v, r, g, b, ow, coef);
+#endif
+                _yuv_to_rgb_scalar(yr + done, u + done, v + done, r + done, g + done, b + done, ow - done, coef);
+            }
+            else
+            {
+                out[0] = yr;
+            }
+            size_t row_off = (size_t)(oy + i) * dst_w + ox;
+            if (!to_float)
+            {
+                uint8_t *d = (uint8_t *)dst;
+                if (chw || ch == 1)
+                {
+                    for (int c = 0; c < ch; ++c)
+                        memcpy(d + plane * c + row_off, out[c], ow);
+                }
+                else
+                {
+                    int done = 0;
+#if YUV_NEON || YUV_RVV || YUV_SSE2
+                    done = _pack_simd(r, g, b, d + row_off * 3, ow, 3, bgr);
+#endif
+                    _pack_scalar(r + done, g + done, b + done, d + (row_off + done) * 3, ow - done, 3, bgr);
+                }
+                continue;
+            }
+            float *d = (float *)dst;
+            if (chw)
+            {
+                for (int c = 0; c < ch; ++c)
+                {
+                    const float *l = lut.data() + c * 256;
+                    const uint8_t *s = out[c];
+                    float *dc = d + plane * c + row_off;
+                    for (int j = 0; j < ow; ++j)
+                        dc[j] = l[s[j]];
+                }
+            }
+            else
+            {
+                float *dc = d + row_off * ch;
+                for (int j = 0; j < ow; ++j)
+                    for (int c = 0; c < ch; ++c)
+                        *dc++ = lut[c * 256 + out[c][j]];
+            }
+        }
+        return err::ERR_NONE;
+    }
+
+} // namespace maix::image
@@ -0,0 +1,422 @@
+/**
+ * @author neucrack@sipeed
+ * @copyright Sipeed Ltd 2026-
+ * @license Apache 2.0
+ * @update 2026.10.18: Sample format and rate conversion, capture ring for Linux audio, create this file.
+ */
+
+#pragma once
+
+#include "maix_audio.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIO_CVT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_CVT_SSE2 1
+#endif
+
+namespace maix::audio::priv
+{
+    /**
+     * Bytes of one sample of format, 0 if format invalid.
+     */
+    static inline int sample_bytes(audio::Format format)
+    {
+        switch (format)
+        {
+        case FMT_S8:
+        case FMT_U8:
+            return 1;
+        case FMT_S16_LE:
+        case FMT_S16_BE:
+        case FMT_U16_LE:
+        case FMT_U16_BE:
+            return 2;
+        case FMT_S32_LE:
+        case FMT_S32_BE:
+        case FMT_U32_LE:
+        case FMT_U32_BE:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    static inline uint16_t _load16(const uint8_t *p, bool be)
+    {
+        return be ? (uint16_t)((p[0] << 8) | p[1]) : (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    static inline uint32_t _load32(const uint8_t *p, bool be)
+    {
+        return be ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]
+                  : p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    /**
+     * Convert samples to signed 32 bits host order, value is left aligned(S16 0x1234 -> 0x12340000).
+     */
+    static inline void to_s32(const void *src, audio::Format format, int32_t *dst, size_t n)
+    {
+        const uint8_t *s = (const uint8_t *)src;
+        size_t i = 0;
+        switch (format)
+        {
+        case FMT_S16_LE:
+        {
+            const int16_t *s16 = (const int16_t *)src;
+#if AUDIO_CVT_NEON
+            for (; i + 8 <= n; i += 8)
+            {
+                int16x8_t v = vld1q_s16(s16 + i);
+                vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(v), 16));
+                vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(v), 16));
+            }
+#elif AUDIO_CVT_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= n; i += 8)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(s16 + i));
+                _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(zero, v));
+                _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(zero, v));
+            }
+#endif
+            for (; i < n; ++i)
+                dst[i] = (int32_t)((uint32_t)(uint16_t)s16[i] << 16);
+            break;
+        }
+        case FMT_S32_LE:
+            memcpy(dst, src, n * 4);
+            break;
+        case FMT_S8:
+            for (; i < n; ++i)
+                dst[i] = (int32_t)((uint32_t)s[i] << 24);
+            break;
+        case FMT_U8:
+            for (; i < n; ++i)
+                dst[i] = (int32_t)((uint32_t)(s[i] ^ 0x80) << 24);
+            break;
+        case FMT_S16_BE:
+        case FMT_U16_LE:
+        case FMT_U16_BE:
+        {
+            bool be = format == FMT_S16_BE || format == FMT_U16_BE;
+            uint16_t flip = format == FMT_S16_BE ? 0 : 0x8000;
+            for (; i < n; ++i)
+                dst[i] = (int32_t)((uint32_t)(_load16(s + i * 2, be) ^ flip) << 16);
+            break;
+        }
+        case FMT_S32_BE:
+        case FMT_U32_LE:
+        case FMT_U32_BE:
+        {
+            bool be = format == FMT_S32_BE || format == FMT_U32_BE;
+            uint32_t flip = format == FMT_S32_BE ? 0 : 0x80000000u;
+            for (; i < n; ++i)
+                dst[i] = (int32_t)(_load32(s + i * 4, be) ^ flip);
+            break;
+        }
+        default:
+            memset(dst, 0, n * 4);
+            break;
+        }
+    }
+
+    /**
+     * Convert signed 32 bits left aligned samples to format, lower bits are truncated.
+     */
+    static inline void from_s32(const int32_t *src, audio::Format format, void *dst, size_t n)
+    {
+        uint8_t *d = (uint8_t *)dst;
+        size_t i = 0;
+        switch (format)
+        {
+        case FMT_S16_LE:
+        {
+            int16_t *d16 = (int16_t *)dst;
+#if AUDIO_CVT_NEON
+            for (; i + 8 <= n; i += 8)
+            {
+                int16x4_t lo = vshrn_n_s32(vld1q_s32(src + i), 16);
+                int16x4_t hi = vshrn_n_s32(vld1q_s32(src + i + 4), 16);
+                vst1q_s16(d16 + i, vcombine_s16(lo, hi));
+            }
+#elif AUDIO_CVT_SSE2
+            for (; i + 8 <= n; i += 8)
+            {
+                __m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(src + i)), 16);
+                __m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(src + i + 4)), 16);
+                _mm_storeu_si128((__m128i *)(d16 + i), _mm_packs_epi32(lo, hi));
+            }
+#endif
+            for (; i < n; ++i)
+                d16[i] = (int16_t)(src[i] >> 16);
+            break;
+        }
+        case FMT_S32_LE:
+            memcpy(dst, src, n * 4);
+            break;
+        case FMT_S8:
+            for (; i < n; ++i)
+                d[i] = (uint8_t)(src[i] >> 24);
+            break;
+        case FMT_U8:
+            for (; i < n; ++i)
+                d[i] = (uint8_t)(src[i] >> 24) ^ 0x80;
+            break;
+        case FMT_S16_BE:
+        case FMT_U16_LE:
+        case FMT_U16_BE:
+        {
+            bool be = format == FMT_S16_BE || format == FMT_U16_BE;
+            uint16_t flip = format == FMT_S16_BE ? 0 : 0x8000;
+            for (; i < n; ++i)
+            {
+                uint16_t v = (uint16_t)((uint32_t)src[i] >> 16) ^ flip;
+                d[i * 2 + (be ? 1 : 0)] = v & 0xff;
+                d[i * 2 + (be ? 0 : 1)] = v >> 8;
+            }
+            break;
+        }
+        case FMT_S32_BE:
+        case FMT_U32_LE:
+        case FMT_U32_BE:
+        {
+            bool be = format == FMT_S32_BE || format == FMT_U32_BE;
+            uint32_t flip = format == FMT_S32_BE ? 0 : 0x80000000u;
+            for (; i < n; ++i)
+            {
+                uint32_t v = (uint32_t)src[i] ^ flip;
+                uint8_t *p = d + i * 4;
+                if (be)
+                {
+                    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+                }
+                else
+                {
+                    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    /**
+     * Linear interpolation sample rate converter of interleaved S32 frames, keeps state between calls.
+     */
+    class Resampler
+    {
+    public:
+        Resampler(int in_rate, int out_rate, int channels)
+            : _channels(channels), _prev(channels, 0)
+        {
+            _step = ((uint64_t)in_rate << 32) / (uint64_t)out_rate;
+            _pos = 0;
+        }
+
+        /**
+         * Max output frames of in_frames input frames.
+         */
+        size_t max_out(size_t in_frames) const
+        {
+            return (size_t)((((uint64_t)in_frames << 32) + _step - 1) / _step) + 1;
+        }
+
+        /**
+         * Convert in_frames frames, return output frames.
+         */
+        size_t process(const int32_t *in, size_t in_frames, int32_t *out)
+        {
+            if (in_frames == 0)
+                return 0;
+            size_t out_frames = 0;
+            const int ch = _channels;
+            while (true)
+            {
+                size_t idx = (size_t)(_pos >> 32);
+                if (idx >= in_frames)
+                    break;
+                int64_t frac = (int64_t)(_pos & 0xffffffffu);
+                const int32_t *a = idx == 0 ? _prev.data() : in + (idx - 1) * ch;
+                const int32_t *b = in + idx * ch;
+                for (int c = 0; c < ch; ++c)
+                    out[c] = (int32_t)(a[c] + ((((int64_t)b[c] - a[c]) * frac) >> 32));
+                out += ch;
+                ++out_frames;
+                _pos += _step;
+            }
+            _pos -= (uint64_t)in_frames << 32;
+            memcpy(_prev.data(), in + (in_frames - 1) * ch, ch * sizeof(int32_t));
+            return out_frames;
+        }
+
+    private:
+        int _channels;
+        std::vector<int32_t> _prev;
+        uint64_t _step;
+        uint64_t _pos;
+    };
+
+    /**
+     * Converter between two sample formats and rates, interleaved frames.
+     */
+    class Converter
+    {
+    public:
+        Converter(audio::Format in_format, int in_rate, audio::Format out_format, int out_rate, int channels)
+            : _in_format(in_format), _out_format(out_format), _channels(channels),
+              _resampler(in_rate != out_rate ? new Resampler(in_rate, out_rate, channels) : nullptr)
+        {
+            _in_frame = sample_bytes(in_format) * channels;
+            _out_frame = sample_bytes(out_format) * channels;
+        }
+
+        ~Converter()
+        {
+            delete _resampler;
+        }
+
+        Converter(const Converter &) = delete;
+        Converter &operator=(const Converter &) = delete;
+
+        bool passthrough() const
+        {
+            return !_resampler && _in_format == _out_format;
+        }
+
+        size_t max_out(size_t in_frames) const
+        {
+            return _resampler ? _resampler->max_out(in_frames) : in_frames;
+        }
+
+        int in_frame_bytes() const { return _in_frame; }
+        int out_frame_bytes() const { return _out_frame; }
+
+        /**
+         * Convert frames, out must have max_out(in_frames) frames space, return output frames.
+         */
+        size_t process(const void *in, size_t in_frames, void *out)
+        {
+            if (passthrough())
+            {
+                memcpy(out, in, in_frames * _in_frame);
+                return in_frames;
+            }
+            size_t n = in_frames * _channels;
+            if (_tmp.size() < n)
+                _tmp.resize(n);
+            to_s32(in, _in_format, _tmp.data(), n);
+            const int32_t *s32 = _tmp.data();
+            size_t out_frames = in_frames;
+            if (_resampler)
+            {
+                size_t max = _resampler->max_out(in_frames) * _channels;
+                if (_tmp2.size() < max)
+                    _tmp2.resize(max);
+                out_frames = _resampler->process(_tmp.data(), in_frames, _tmp2.data());
+                s32 = _tmp2.data();
+            }
+            from_s32(s32, _out_format, out, out_frames * _channels);
+            return out_frames;
+        }
+
+    private:
+        audio::Format _in_format;
+        audio::Format _out_format;
+        int _channels;
+        int _in_frame;
+        int _out_frame;
+        Resampler *_resampler;
+        std::vector<int32_t> _tmp;
+        std::vector<int32_t> _tmp2;
+    };
+
+    /**
+     * Lock-free single producer single consumer byte ring, size is power of 2.
+     * Producer never waits, data not fit is dropped.
+     */
+    class Ring
+    {
+    public:
+        explicit Ring(size_t size)
+        {
+            size_t s = 1;
+            while (s < size)
+                s <<= 1;
+            _size = s;
+            _buff = new uint8_t[s];
+        }
+
+        ~Ring()
+        {
+            delete[] _buff;
+        }
+
+        Ring(const Ring &) = delete;
+        Ring &operator=(const Ring &) = delete;
+
+        size_t size() const { return _size; }
+
+        size_t used() const
+        {
+            return (size_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+        }
+
+        /**
+         * Producer, push at most len bytes aligned to align, return pushed bytes.
+         */
+        size_t push(const void *data, size_t len, size_t align = 1)
+        {
+            uint64_t head = _head.load(std::memory_order_relaxed);
+            size_t space = _size - (size_t)(head - _tail.load(std::memory_order_acquire));
+            if (len > space)
+                len = space / align * align;
+            size_t off = head & (_size - 1);
+            size_t first = len < _size - off ? len : _size - off;
+            memcpy(_buff + off, data, first);
+            memcpy(_buff, (const uint8_t *)data + first, len - first);
+            _head.store(head + len, std::memory_order_release);
+            return len;
+        }
+
+        /**
+         * Consumer, pop at most len bytes, return popped bytes.
+         */
+        size_t pop(void *data, size_t len)
+        {
+            uint64_t tail = _tail.load(std::memory_order_relaxed);
+            size_t used = (size_t)(_head.load(std::memory_order_acquire) - tail);
+            if (len > used)
+                len = used;
+            size_t off = tail & (_size - 1);
+            size_t first = len < _size - off ? len : _size - off;
+            memcpy(data, _buff + off, first);
+            memcpy((uint8_t *)data + first, _buff, len - first);
+            _tail.store(tail + len, std::memory_order_release);
+            return len;
+        }
+
+        /**
+         * Consumer, drop all data.
+         */
+        void clear()
+        {
+            _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+    private:
+        uint8_t *_buff;
+        size_t _size;
+        std::atomic<uint64_t> _head{0};
+        std::atomic<uint64_t> _tail{0};
+    };
+}
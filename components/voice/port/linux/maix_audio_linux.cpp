@@ -3,24 +3,918 @@
  * @copyright Sipeed Ltd 2023-
  * @license Apache 2.0
  * @update 2023.9.8: Add framework, create this file.
+ * @update 2026.10.18: Implement Recorder and Player with ALSA mmap access, capture ring and format/rate conversion.
  */
 
 #include <stdint.h>
 #include "maix_basic.hpp"
 #include "maix_err.hpp"
 #include "maix_audio.hpp"
+#if MAIX_AUDIO_ALSA
+#include "maix_audio_convert.hpp"
+#include <alsa/asoundlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 using namespace maix;
 
 namespace maix::audio
 {
+#if MAIX_AUDIO_ALSA
+    typedef struct {
+        int file_size;  // pcm + 44
+        int channel;
+        int sample_rate;
+        int sample_bit;
+        int bitrate;
+        int data_size;  // size of pcm
+    } wav_header_t;
+
+    static int _create_wav_header(wav_header_t *header, uint8_t *data, size_t size)
+    {
+        if (size < 44) return -1;
+
+        auto put32 = [](uint8_t *p, uint32_t v) {
+            p[0] = v & 0xff;
+            p[1] = (v >> 8) & 0xff;
+            p[2] = (v >> 16) & 0xff;
+            p[3] = (v >> 24) & 0xff;
+        };
+        memcpy(data, "RIFF", 4);
+        put32(data + 4, header->file_size - 8);
+        memcpy(data + 8, "WAVEfmt ", 8);
+        put32(data + 16, 16);
+        data[20] = 1;   // pcm
+        data[21] = 0;
+        data[22] = (uint8_t)header->channel;
+        data[23] = 0;
+        put32(data + 24, header->sample_rate);
+        put32(data + 28, header->bitrate);
+        data[32] = (uint8_t)(header->channel * header->sample_bit / 8);
+        data[33] = 0;
+        data[34] = (uint8_t)header->sample_bit;
+        data[35] = 0;
+        memcpy(data + 36, "data", 4);
+        put32(data + 40, header->data_size);
+        return 0;
+    }
+
+    static int _read_wav_header(wav_header_t *header, uint8_t *data, size_t size)
+    {
+        if (size < 44) return -1;
+        auto get16 = [](const uint8_t *p) { return (int)(p[0] | (p[1] << 8)); };
+        auto get32 = [](const uint8_t *p) { return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24)); };
+
+        if (memcmp(data, "RIFF", 4) != 0) {
+            log::error("RIFF not found in wav header!");
+            return -1;
+        }
+        if (memcmp(data + 8, "WAVE", 4) != 0) {
+            log::error("WAVE not found in wav header!");
+            return -2;
+        }
+        if (get16(data + 20) != 1) {
+            log::error("audio format is not pcm!");
+            return -3;
+        }
+        header->channel = get16(data + 22);
+        header->sample_rate = get32(data + 24);
+        header->bitrate = get32(data + 28);
+        header->sample_bit = get16(data + 34);
+        header->data_size = get32(data + 40);
+        header->file_size = get32(data + 4) + 8;
+        return 0;
+    }
+
+    typedef struct {
+        std::string path;
+        std::string device;
+        snd_pcm_stream_t stream;
+        snd_pcm_t *pcm = nullptr;
+        FILE *file = nullptr;
+        wav_header_t wav_header;
+        bool block;
+
+        // format of user data
+        audio::Format format;
+        int sample_rate;
+        int channel;
+
+        // format of device
+        audio::Format hw_format;
+        unsigned int hw_rate;
+        snd_pcm_uframes_t period_size;
+        unsigned int period_count;
+        snd_pcm_uframes_t buffer_size;
+        bool mmap;
+        priv::Converter *cvt = nullptr;
+        std::vector<uint8_t> scratch;
+
+        // capture
+        priv::Ring *ring = nullptr;
+        std::thread *thread = nullptr;
+        std::atomic<bool> running{false};
+        std::atomic<int> waiters{0};
+        std::atomic<uint64_t> dropped{0};
+        std::mutex lock;
+        std::condition_variable cond;
+    } audio_param_t;
+
+    static snd_pcm_format_t _to_alsa_format(audio::Format format)
+    {
+        switch (format)
+        {
+        case FMT_S8: return SND_PCM_FORMAT_S8;
+        case FMT_S16_LE: return SND_PCM_FORMAT_S16_LE;
+        case FMT_S32_LE: return SND_PCM_FORMAT_S32_LE;
+        case FMT_S16_BE: return SND_PCM_FORMAT_S16_BE;
+        case FMT_S32_BE: return SND_PCM_FORMAT_S32_BE;
+        case FMT_U8: return SND_PCM_FORMAT_U8;
+        case FMT_U16_LE: return SND_PCM_FORMAT_U16_LE;
+        case FMT_U32_LE: return SND_PCM_FORMAT_U32_LE;
+        case FMT_U16_BE: return SND_PCM_FORMAT_U16_BE;
+        case FMT_U32_BE: return SND_PCM_FORMAT_U32_BE;
+        default: return SND_PCM_FORMAT_UNKNOWN;
+        }
+    }
+
+    static audio::Format _wav_sample_bit_to_format(int sample_bit)
+    {
+        switch (sample_bit) {
+        case 8: return FMT_U8;  // 8 bits wav is unsigned
+        case 16: return FMT_S16_LE;
+        case 32: return FMT_S32_LE;
+        default:
+            err::check_raise(err::ERR_ARGS, "not support sample bit(" + std::to_string(sample_bit) + ")");
+        }
+        return FMT_NONE;
+    }
+
+    static std::string _env_device(const char *name)
+    {
+        const char *dev = getenv(name);
+        return dev && dev[0] ? dev : "default";
+    }
+
+    static void _close_pcm(audio_param_t *param)
+    {
+        if (param->pcm) {
+            snd_pcm_close(param->pcm);
+            param->pcm = nullptr;
+        }
+        delete param->cvt;
+        param->cvt = nullptr;
+    }
+
+    /**
+     * Open pcm with param->period_size and param->period_count,
+     * user format and rate are converted if device not support them.
+     */
+    static void _open_pcm(audio_param_t *param)
+    {
+        snd_pcm_t *pcm = nullptr;
+        int res = snd_pcm_open(&pcm, param->device.c_str(), param->stream, param->block ? 0 : SND_PCM_NONBLOCK);
+        if (res < 0)
+            err::check_raise(err::ERR_RUNTIME, "open pcm " + param->device + " failed: " + snd_strerror(res));
+
+        snd_pcm_hw_params_t *hw;
+        snd_pcm_hw_params_alloca(&hw);
+        snd_pcm_hw_params_any(pcm, hw);
+        param->mmap = snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+        if (!param->mmap && (res = snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
+            goto _error;
+
+        param->hw_format = FMT_NONE;
+        for (audio::Format f : {param->format, FMT_S16_LE, FMT_S32_LE}) {
+            if (snd_pcm_hw_params_set_format(pcm, hw, _to_alsa_format(f)) == 0) {
+                param->hw_format = f;
+                break;
+            }
+        }
+        if (param->hw_format == FMT_NONE) {
+            res = -EINVAL;
+            goto _error;
+        }
+        if ((res = snd_pcm_hw_params_set_channels(pcm, hw, param->channel)) < 0)
+            goto _error;
+        param->hw_rate = param->sample_rate;
+        if ((res = snd_pcm_hw_params_set_rate_near(pcm, hw, &param->hw_rate, nullptr)) < 0)
+            goto _error;
+        if ((res = snd_pcm_hw_params_set_period_size_near(pcm, hw, &param->period_size, nullptr)) < 0)
+            goto _error;
+        if ((res = snd_pcm_hw_params_set_periods_near(pcm, hw, &param->period_count, nullptr)) < 0)
+            goto _error;
+        if ((res = snd_pcm_hw_params(pcm, hw)) < 0)
+            goto _error;
+        snd_pcm_hw_params_get_period_size(hw, &param->period_size, nullptr);
+        snd_pcm_hw_params_get_periods(hw, &param->period_count, nullptr);
+        snd_pcm_hw_params_get_buffer_size(hw, &param->buffer_size);
+
+        {
+            snd_pcm_sw_params_t *sw;
+            snd_pcm_sw_params_alloca(&sw);
+            snd_pcm_sw_params_current(pcm, sw);
+            snd_pcm_sw_params_set_avail_min(pcm, sw, param->period_size);
+            snd_pcm_sw_params_set_start_threshold(pcm, sw, param->stream == SND_PCM_STREAM_CAPTURE ? 1 : param->period_size);
+            if ((res = snd_pcm_sw_params(pcm, sw)) < 0)
+                goto _error;
+        }
+        if ((res = snd_pcm_prepare(pcm)) < 0)
+            goto _error;
+
+        if (param->hw_format != param->format || (int)param->hw_rate != param->sample_rate)
+            log::info("[audio] %s: device format %d rate %u, convert to format %d rate %d",
+                      param->device.c_str(), param->hw_format, param->hw_rate, param->format, param->sample_rate);
+        if (param->stream == SND_PCM_STREAM_CAPTURE)
+            param->cvt = new priv::Converter(param->hw_format, param->hw_rate, param->format, param->sample_rate, param->channel);
+        else
+            param->cvt = new priv::Converter(param->format, param->sample_rate, param->hw_format, param->hw_rate, param->channel);
+        param->pcm = pcm;
+        return;
+_error:
+        snd_pcm_close(pcm);
+        err::check_raise(err::ERR_RUNTIME, "set pcm " + param->device + " params failed: " + snd_strerror(res));
+    }
+
+    static int _recover(audio_param_t *param, int res)
+    {
+        if (res == -EAGAIN)
+            return 0;
+        if (res == -EPIPE)
+            log::warn("[audio] %s xrun", param->device.c_str());
+        res = snd_pcm_recover(param->pcm, res, 1);
+        if (res < 0) {
+            log::error("[audio] %s recover failed: %s", param->device.c_str(), snd_strerror(res));
+            return res;
+        }
+        if (param->stream == SND_PCM_STREAM_CAPTURE)
+            snd_pcm_start(param->pcm);
+        return 0;
+    }
+
+    static void _capture_push(audio_param_t *param, const uint8_t *src, size_t frames)
+    {
+        priv::Converter *cvt = param->cvt;
+        size_t fb = cvt->out_frame_bytes();
+        size_t bytes = frames * fb;
+        if (!cvt->passthrough()) {
+            size_t need = cvt->max_out(frames) * fb;
+            if (param->scratch.size() < need)
+                param->scratch.resize(need);
+            bytes = cvt->process(src, frames, param->scratch.data()) * fb;
+            src = param->scratch.data();
+        }
+        size_t pushed = param->ring->push(src, bytes, fb);
+        if (pushed < bytes)
+            param->dropped.fetch_add(bytes - pushed, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (param->waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(param->lock);
+            param->cond.notify_all();
+        }
+    }
+
+    /**
+     * Device thread of Recorder, move data from device buffer to ring, never wait for user.
+     */
+    static void _capture_loop(audio_param_t *param)
+    {
+        snd_pcm_t *pcm = param->pcm;
+        snd_pcm_start(pcm);
+        size_t hw_fb = param->cvt->in_frame_bytes();
+        std::vector<uint8_t> rw_buff(param->mmap ? 0 : param->period_size * hw_fb);
+        while (param->running.load(std::memory_order_relaxed)) {
+            snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+            if (avail < 0) {
+                if (_recover(param, (int)avail) < 0)
+                    break;
+                continue;
+            }
+            if ((snd_pcm_uframes_t)avail < param->period_size) {
+                int res = snd_pcm_wait(pcm, 100);
+                if (res < 0 && _recover(param, res) < 0)
+                    break;
+                continue;
+            }
+            if (param->mmap) {
+                const snd_pcm_channel_area_t *areas;
+                snd_pcm_uframes_t offset, frames = avail;
+                int res = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+                if (res < 0) {
+                    if (_recover(param, res) < 0)
+                        break;
+                    continue;
+                }
+                const uint8_t *src = (const uint8_t *)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+                _capture_push(param, src, frames);
+                snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, frames);
+                if (committed < 0 && _recover(param, (int)committed) < 0)
+                    break;
+            } else {
+                snd_pcm_sframes_t n = snd_pcm_readi(pcm, rw_buff.data(), param->period_size);
+                if (n < 0) {
+                    if (_recover(param, (int)n) < 0)
+                        break;
+                    continue;
+                }
+                _capture_push(param, rw_buff.data(), n);
+            }
+        }
+        param->running.store(false);
+        std::lock_guard<std::mutex> lock(param->lock);
+        param->cond.notify_all();
+    }
+
+    static void _capture_start(audio_param_t *param)
+    {
+        if (param->thread)
+            return;
+        param->running.store(true);
+        param->thread = new std::thread(_capture_loop, param);
+    }
+
+    static void _capture_stop(audio_param_t *param)
+    {
+        if (!param->thread)
+            return;
+        param->running.store(false);
+        param->thread->join();
+        delete param->thread;
+        param->thread = nullptr;
+        snd_pcm_drop(param->pcm);
+        snd_pcm_prepare(param->pcm);
+    }
+
+    static void _capture_create_ring(audio_param_t *param)
+    {
+        // at least two device buffers after conversion, so the device thread never overruns the ring in one period
+        size_t bytes = (size_t)param->buffer_size * param->cvt->out_frame_bytes() * 2;
+        bytes = bytes * param->sample_rate / param->hw_rate + 1;
+        delete param->ring;
+        param->ring = new priv::Ring(bytes < 64 * 1024 ? 64 * 1024 : bytes);
+    }
+
+    static void _reopen(audio_param_t *param, snd_pcm_uframes_t period_size, unsigned int period_count)
+    {
+        bool running = param->thread != nullptr;
+        if (param->stream == SND_PCM_STREAM_CAPTURE)
+            _capture_stop(param);
+        _close_pcm(param);
+        param->period_size = period_size;
+        param->period_count = period_count;
+        _open_pcm(param);
+        if (param->stream == SND_PCM_STREAM_CAPTURE) {
+            _capture_create_ring(param);
+            if (running)
+                _capture_start(param);
+        }
+    }
+
+    /**
+     * Find the first mixer element with playback or capture volume, mixer can be set by env MAIX_AUDIO_MIXER.
+     */
+    static snd_mixer_elem_t *_mixer_find(snd_mixer_t **mixer, bool capture, bool need_switch)
+    {
+        *mixer = nullptr;
+        std::string card = _env_device("MAIX_AUDIO_MIXER");
+        if (snd_mixer_open(mixer, 0) < 0)
+            return nullptr;
+        if (snd_mixer_attach(*mixer, card.c_str()) < 0
+            || snd_mixer_selem_register(*mixer, nullptr, nullptr) < 0
+            || snd_mixer_load(*mixer) < 0) {
+            snd_mixer_close(*mixer);
+            *mixer = nullptr;
+            return nullptr;
+        }
+        for (snd_mixer_elem_t *elem = snd_mixer_first_elem(*mixer); elem; elem = snd_mixer_elem_next(elem)) {
+            if (!snd_mixer_selem_is_active(elem))
+                continue;
+            bool ok = need_switch ? (capture ? snd_mixer_selem_has_capture_switch(elem) : snd_mixer_selem_has_playback_switch(elem))
+                                  : (capture ? snd_mixer_selem_has_capture_volume(elem) : snd_mixer_selem_has_playback_volume(elem));
+            if (ok)
+                return elem;
+        }
+        return nullptr;
+    }
+
+    static int _mixer_volume(bool capture, int value)
+    {
+        snd_mixer_t *mixer;
+        snd_mixer_elem_t *elem = _mixer_find(&mixer, capture, false);
+        if (!elem) {
+            if (mixer)
+                snd_mixer_close(mixer);
+            err::check_raise(err::ERR_RUNTIME, "Get mixer volume ctl failed");
+        }
+        long min = 0, max = 0, curr = 0;
+        if (capture)
+            snd_mixer_selem_get_capture_volume_range(elem, &min, &max);
+        else
+            snd_mixer_selem_get_playback_volume_range(elem, &min, &max);
+        if (value >= 0) {
+            long v = min + (max - min) * (value > 100 ? 100 : value) / 100;
+            int res = capture ? snd_mixer_selem_set_capture_volume_all(elem, v) : snd_mixer_selem_set_playback_volume_all(elem, v);
+            if (res < 0) {
+                snd_mixer_close(mixer);
+                err::check_raise(err::ERR_RUNTIME, std::string("Set mixer volume ctl failed: ") + snd_strerror(res));
+            }
+        }
+        if (capture)
+            snd_mixer_selem_get_capture_volume(elem, SND_MIXER_SCHN_FRONT_LEFT, &curr);
+        else
+            snd_mixer_selem_get_playback_volume(elem, SND_MIXER_SCHN_FRONT_LEFT, &curr);
+        snd_mixer_close(mixer);
+        return max > min ? (int)((curr - min) * 100 / (max - min)) : 0;
+    }
+
     Recorder::Recorder(std::string path, int sample_rate, audio::Format format, int channel, bool block) {
+        if (path.size() > 0) {
+            if (fs::splitext(path)[1] != ".wav"
+                && fs::splitext(path)[1] != ".pcm") {
+                err::check_raise(err::ERR_RUNTIME, "Only files with the `.pcm` and `.wav` extensions are supported.");
+            }
+        }
+        if (priv::sample_bytes(format) == 0)
+            err::check_raise(err::ERR_ARGS, "not support audio format(" + std::to_string(format) + ")");
+        if (channel <= 0 || sample_rate <= 0)
+            err::check_raise(err::ERR_ARGS, "invalid channel or sample rate");
 
-        err::check_raise(err::ERR_NOT_IMPL, "not support this function");
+        audio_param_t *param = new audio_param_t();
+        param->path = path;
+        param->device = _env_device("MAIX_AUDIO_RECORD_DEVICE");
+        param->stream = SND_PCM_STREAM_CAPTURE;
+        param->block = block;
+        param->format = format;
+        param->sample_rate = sample_rate;
+        param->channel = channel;
+        param->period_size = 1024;
+        param->period_count = 4;
+        try {
+            _open_pcm(param);
+        } catch (...) {
+            delete param;
+            throw;
+        }
+        _capture_create_ring(param);
+        _param = param;
+    }
+
+    Recorder::~Recorder() {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (param) {
+            _capture_stop(param);
+            finish();
+            _close_pcm(param);
+            delete param->ring;
+            delete param;
+            _param = nullptr;
+        }
+    }
+
+    int Recorder::volume(int value) {
+        return _mixer_volume(true, value);
+    }
+
+    bool Recorder::mute(int data) {
+        snd_mixer_t *mixer;
+        snd_mixer_elem_t *elem = _mixer_find(&mixer, true, true);
+        if (!elem) {
+            if (mixer)
+                snd_mixer_close(mixer);
+            err::check_raise(err::ERR_RUNTIME, "Get mixer mute ctl failed");
+        }
+        if (data >= 0) {
+            int res = snd_mixer_selem_set_capture_switch_all(elem, data ? 0 : 1);
+            if (res < 0) {
+                snd_mixer_close(mixer);
+                err::check_raise(err::ERR_RUNTIME, std::string("Set mixer mute ctl failed: ") + snd_strerror(res));
+            }
+        }
+        int on = 1;
+        snd_mixer_selem_get_capture_switch(elem, SND_MIXER_SCHN_FRONT_LEFT, &on);
+        snd_mixer_close(mixer);
+        return on == 0;
+    }
+
+    void Recorder::reset(bool start) {
+        audio_param_t *param = (audio_param_t *)_param;
+        _capture_stop(param);
+        param->ring->clear();
+        if (start)
+            _capture_start(param);
+    }
+
+    maix::Bytes *Recorder::record(int record_ms) {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (record_ms < 0)
+            return record_bytes(record_ms);
+        int frames = (int)((int64_t)record_ms * param->sample_rate / 1000);
+        return record_bytes(frame_size(frames));
+    }
+
+    int Recorder::frame_size(int frame_count) {
+        audio_param_t *param = (audio_param_t *)_param;
+        frame_count = frame_count <= 0 ? 1 : frame_count;
+        return frame_count * priv::sample_bytes(param->format) * param->channel;
+    }
+
+    int Recorder::get_remaining_frames() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return (int)(param->ring->used() / frame_size(1));
+    }
+
+    int Recorder::period_size(int period_size) {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (period_size > 0)
+            _reopen(param, period_size, param->period_count);
+        return (int)param->period_size;
+    }
+
+    int Recorder::period_count(int period_count) {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (period_count > 0)
+            _reopen(param, param->period_size, period_count);
+        return (int)param->period_count;
+    }
+
+    maix::Bytes *Recorder::record_bytes(int record_size) {
+        audio_param_t *param = (audio_param_t *)_param;
+
+        if (param->file == nullptr && param->path.size() > 0) {
+            param->file = fopen(param->path.c_str(), "w+");
+            err::check_null_raise(param->file, "Open file failed!");
+
+            if (fs::splitext(param->path)[1] == ".wav") {
+                int sample_bit = priv::sample_bytes(param->format) * 8;
+                wav_header_t header = {
+                    .file_size = 44,
+                    .channel = param->channel,
+                    .sample_rate = param->sample_rate,
+                    .sample_bit = sample_bit,
+                    .bitrate = param->channel * param->sample_rate * sample_bit / 8,
+                    .data_size = 0,
+                };
+
+                uint8_t buffer[44];
+                if (0 != _create_wav_header(&header, buffer, sizeof(buffer))) {
+                    err::check_raise(err::ERR_RUNTIME, "create wav failed!");
+                }
+
+                if (sizeof(buffer) != fwrite(buffer, 1, sizeof(buffer), param->file)) {
+                    err::check_raise(err::ERR_RUNTIME, "write wav header failed!");
+                }
+            }
+        }
+
+        // block mode start capture at the first record, non-block mode need reset() to start
+        if (param->block)
+            _capture_start(param);
+
+        priv::Ring *ring = param->ring;
+        int fb = frame_size(1);
+        size_t want;
+        if (record_size < 0) {
+            // all cached data, block mode wait at least one period
+            if (param->block && ring->used() == 0) {
+                size_t period = param->period_size * param->sample_rate / param->hw_rate * fb;
+                want = period < ring->size() ? period : ring->size();
+                std::unique_lock<std::mutex> lock(param->lock);
+                param->waiters.fetch_add(1);
+                while (ring->used() < want && param->running.load() && !app::need_exit())
+                    param->cond.wait_for(lock, std::chrono::milliseconds(100));
+                param->waiters.fetch_sub(1);
+            }
+            want = ring->used();
+        } else {
+            want = record_size;
+            if (!param->block && want > ring->used())
+                want = ring->used();
+        }
+        want = want / fb * fb;
+        if (want == 0)
+            return new Bytes();
+
+        auto out_bytes = new Bytes(nullptr, want);
+        err::check_null_raise(out_bytes, "Create new bytes failed!");
+        size_t got = ring->pop(out_bytes->data, want);
+        while (got < want && param->running.load() && !app::need_exit()) {
+            {
+                std::unique_lock<std::mutex> lock(param->lock);
+                param->waiters.fetch_add(1);
+                size_t need = want - got < ring->size() ? want - got : ring->size();
+                param->cond.wait_for(lock, std::chrono::milliseconds(100), [&] {
+                    return ring->used() >= need || !param->running.load();
+                });
+                param->waiters.fetch_sub(1);
+            }
+            got += ring->pop(out_bytes->data + got, want - got);
+        }
+        out_bytes->data_len = got / fb * fb;
+
+        if (param->file)
+            fwrite(out_bytes->data, 1, out_bytes->data_len, param->file);
+
+        return out_bytes;
+    }
+
+    err::Err Recorder::finish() {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (param->file) {
+            if (fs::splitext(param->path)[1] == ".wav") {
+                int file_size = ftell(param->file);
+                int pcm_size = file_size - 44;
+                uint8_t buffer[4];
+                buffer[0] = (uint8_t)((file_size - 8) & 0xff);
+                buffer[1] = (uint8_t)(((file_size - 8) >> 8) & 0xff);
+                buffer[2] = (uint8_t)(((file_size - 8) >> 16) & 0xff);
+                buffer[3] = (uint8_t)(((file_size - 8) >> 24) & 0xff);
+
+                fseek(param->file, 4, SEEK_SET);
+                if (sizeof(buffer) != fwrite(buffer, 1, sizeof(buffer), param->file)) {
+                    err::check_raise(err::ERR_RUNTIME, "write wav file size failed!");
+                }
+
+                buffer[0] = (uint8_t)((pcm_size) & 0xff);
+                buffer[1] = (uint8_t)(((pcm_size) >> 8) & 0xff);
+                buffer[2] = (uint8_t)(((pcm_size) >> 16) & 0xff);
+                buffer[3] = (uint8_t)(((pcm_size) >> 24) & 0xff);
+                fseek(param->file, 40, SEEK_SET);
+                if (sizeof(buffer) != fwrite(buffer, 1, sizeof(buffer), param->file)) {
+                    err::check_raise(err::ERR_RUNTIME, "write wav data size failed!");
+                }
+            }
+
+            fflush(param->file);
+            fclose(param->file);
+            param->file = NULL;
+        }
+
+        uint64_t dropped = param->dropped.exchange(0);
+        if (dropped)
+            log::warn("[audio] record too slow, %llu bytes dropped", (unsigned long long)dropped);
+        return err::ERR_NONE;
+    }
+
+    int Recorder::sample_rate() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->sample_rate;
+    }
+
+    audio::Format Recorder::format() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->format;
+    }
+
+    int Recorder::channel() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->channel;
+    }
+
+    maix::Bytes *Player::NoneBytes = new maix::Bytes();
+
+    /**
+     * Write device format frames, start device when start threshold reached.
+     */
+    static err::Err _playback_write(audio_param_t *param, const uint8_t *src, size_t frames)
+    {
+        snd_pcm_t *pcm = param->pcm;
+        size_t fb = param->cvt->out_frame_bytes();
+        while (frames > 0 && !app::need_exit()) {
+            snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+            if (avail < 0) {
+                if (_recover(param, (int)avail) < 0)
+                    return err::ERR_IO;
+                continue;
+            }
+            if (avail == 0) {
+                if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+                    snd_pcm_start(pcm);
+                } else {
+                    int res = snd_pcm_wait(pcm, 100);
+                    if (res < 0 && _recover(param, res) < 0)
+                        return err::ERR_IO;
+                }
+                continue;
+            }
+            snd_pcm_uframes_t n = (snd_pcm_uframes_t)avail < frames ? avail : frames;
+            if (param->mmap) {
+                const snd_pcm_channel_area_t *areas;
+                snd_pcm_uframes_t offset;
+                int res = snd_pcm_mmap_begin(pcm, &areas, &offset, &n);
+                if (res < 0) {
+                    if (_recover(param, res) < 0)
+                        return err::ERR_IO;
+                    continue;
+                }
+                uint8_t *dst = (uint8_t *)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+                memcpy(dst, src, n * fb);
+                snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, n);
+                if (committed < 0) {
+                    if (_recover(param, (int)committed) < 0)
+                        return err::ERR_IO;
+                    continue;
+                }
+                n = committed;
+                if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED
+                    && param->buffer_size - snd_pcm_avail_update(pcm) >= param->period_size)
+                    snd_pcm_start(pcm);
+            } else {
+                snd_pcm_sframes_t written = snd_pcm_writei(pcm, src, n);
+                if (written < 0) {
+                    if (_recover(param, (int)written) < 0)
+                        return err::ERR_IO;
+                    continue;
+                }
+                n = written;
+            }
+            src += n * fb;
+            frames -= n;
+        }
+        return err::ERR_NONE;
+    }
+
+    static err::Err _playback_frames(audio_param_t *param, const uint8_t *data, size_t frames)
+    {
+        priv::Converter *cvt = param->cvt;
+        size_t fb = cvt->in_frame_bytes();
+        while (frames > 0 && !app::need_exit()) {
+            size_t n = frames < param->period_size ? frames : param->period_size;
+            err::Err e;
+            if (cvt->passthrough()) {
+                e = _playback_write(param, data, n);
+            } else {
+                size_t need = cvt->max_out(n) * cvt->out_frame_bytes();
+                if (param->scratch.size() < need)
+                    param->scratch.resize(need);
+                size_t out = cvt->process(data, n, param->scratch.data());
+                e = _playback_write(param, param->scratch.data(), out);
+            }
+            if (e != err::ERR_NONE)
+                return e;
+            data += n * fb;
+            frames -= n;
+        }
+        return err::ERR_NONE;
+    }
+
+    Player::Player(std::string path, int sample_rate, audio::Format format, int channel, bool block) {
+        if (path.size() > 0) {
+            if (fs::splitext(path)[1] != ".wav"
+                && fs::splitext(path)[1] != ".pcm") {
+                err::check_raise(err::ERR_RUNTIME, "Only files with the `.pcm` and `.wav` extensions are supported.");
+            }
+        }
+        FILE *new_file = nullptr;
+        wav_header_t wav_header = {};
+        if (path.size() > 0) {
+            new_file = fopen(path.c_str(), "rb");
+            err::check_null_raise(new_file, "Open file failed!");
+
+            if (fs::splitext(path)[1] == ".wav") {
+                uint8_t buffer[44];
+                if (sizeof(buffer) != fread(buffer, 1, sizeof(buffer), new_file)
+                    || 0 != _read_wav_header(&wav_header, buffer, sizeof(buffer))) {
+                    fclose(new_file);
+                    err::check_raise(err::ERR_RUNTIME, "parse wav header failed!");
+                }
+                sample_rate = wav_header.sample_rate;
+                channel = wav_header.channel;
+                format = _wav_sample_bit_to_format(wav_header.sample_bit);
+            }
+        }
+        if (priv::sample_bytes(format) == 0 || channel <= 0 || sample_rate <= 0) {
+            if (new_file)
+                fclose(new_file);
+            err::check_raise(err::ERR_ARGS, "not support audio format(" + std::to_string(format) + ")");
+        }
+
+        audio_param_t *param = new audio_param_t();
+        param->path = path;
+        param->device = _env_device("MAIX_AUDIO_PLAY_DEVICE");
+        param->stream = SND_PCM_STREAM_PLAYBACK;
+        param->file = new_file;
+        param->wav_header = wav_header;
+        param->block = block;
+        param->format = format;
+        param->sample_rate = sample_rate;
+        param->channel = channel;
+        param->period_size = 1024;
+        param->period_count = 4;
+        try {
+            _open_pcm(param);
+        } catch (...) {
+            if (new_file)
+                fclose(new_file);
+            delete param;
+            throw;
+        }
+        _param = param;
+    }
+
+    Player::~Player() {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (param) {
+            if (param->pcm && param->block && !app::need_exit()) {
+                snd_pcm_nonblock(param->pcm, 0);
+                snd_pcm_drain(param->pcm);
+            }
+            _close_pcm(param);
+            if (param->file) {
+                fclose(param->file);
+                param->file = nullptr;
+            }
+            delete param;
+            _param = nullptr;
+        }
+    }
+
+    int Player::volume(int value) {
+        return _mixer_volume(false, value);
+    }
+
+    err::Err Player::play(maix::Bytes *data) {
+        audio_param_t *param = (audio_param_t *)_param;
+        size_t fb = frame_size(1);
+
+        if (data && data->data && data->size())
+            return _playback_frames(param, data->data, data->data_len / fb);
+
+        if (!param->file)
+            return err::ERR_NONE;
+        fseek(param->file, fs::splitext(param->path)[1] == ".wav" ? 44 : 0, SEEK_SET);
+        std::vector<uint8_t> buffer(fb * param->period_size);
+        size_t read_len;
+        while ((read_len = fread(buffer.data(), 1, buffer.size(), param->file)) > 0 && !app::need_exit()) {
+            err::Err e = _playback_frames(param, buffer.data(), read_len / fb);
+            if (e != err::ERR_NONE)
+                return e;
+        }
+        return err::ERR_NONE;
+    }
+
+    int Player::frame_size(int frame_count) {
+        audio_param_t *param = (audio_param_t *)_param;
+        frame_count = frame_count <= 0 ? 1 : frame_count;
+        return frame_count * priv::sample_bytes(param->format) * param->channel;
+    }
+
+    int Player::get_remaining_frames() {
+        audio_param_t *param = (audio_param_t *)_param;
+        snd_pcm_sframes_t avail = snd_pcm_avail(param->pcm);
+        if (avail < 0) {
+            _recover(param, (int)avail);
+            avail = param->buffer_size;
+        }
+        return (int)((int64_t)avail * param->sample_rate / param->hw_rate);
+    }
+
+    int Player::period_size(int period_size) {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (period_size > 0)
+            _reopen(param, period_size, param->period_count);
+        return (int)param->period_size;
+    }
+
+    int Player::period_count(int period_count) {
+        audio_param_t *param = (audio_param_t *)_param;
+        if (period_count > 0)
+            _reopen(param, param->period_size, period_count);
+        return (int)param->period_count;
+    }
+
+    void Player::reset(bool start) {
+        audio_param_t *param = (audio_param_t *)_param;
+        snd_pcm_drop(param->pcm);
+        snd_pcm_prepare(param->pcm);
+        if (start)
+            snd_pcm_start(param->pcm);
+    }
+
+    int Player::sample_rate() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->sample_rate;
+    }
+
+    audio::Format Player::format() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->format;
+    }
+
+    int Player::channel() {
+        audio_param_t *param = (audio_param_t *)_param;
+        return param->channel;
+    }
+#else
+    // built without libasound(not found on host), see components/voice/CMakeLists.txt
+    Recorder::Recorder(std::string path, int sample_rate, audio::Format format, int channel, bool block) {
+        err::check_raise(err::ERR_NOT_IMPL, "audio needs libasound, install libasound2-dev and rebuild");
     }
 
     Recorder::~Recorder() {
-        err::check_raise(err::ERR_NOT_IMPL, "not support this function");
     }
 
     int Recorder::volume(int value) {
@@ -98,11 +992,10 @@ namespace maix::audio
         (void)format;
         (void)channel;
         (void)block;
-        err::check_raise(err::ERR_NOT_IMPL, "not support this function");
+        err::check_raise(err::ERR_NOT_IMPL, "audio needs libasound, install libasound2-dev and rebuild");
     }
 
     Player::~Player() {
-        err::check_raise(err::ERR_NOT_IMPL, "not support this function");
     }
 
     int Player::volume(int value) {
@@ -152,4 +1045,5 @@ namespace maix::audio
     int Player::channel() {
         return 0;
     }
-} // namespace maix::audio
\ No newline at end of file
+#endif
+} // namespace maix::audio
@@ -30,6 +30,7 @@ int _main(int argc, char *argv[])
     float iou_threshold = 0.45;
     float conf_threshold2 = 0.8;
     bool landmarks_rel = true; // draw relative landmarks on image
+    int track_interval = 5;    // camera mode, detect palm every 5 frames, track hands by landmarks between
 
     nn::HandLandmarks detector("");
     e = detector.load(model_path);
@@ -76,7 +77,7 @@ int _main(int argc, char *argv[])
             maix::image::Image *img = cam.read();
             err::check_null_raise(img, "read camera failed");
             uint64_t t2 = time::ticks_ms();
-            nn::Objects *result = detector.detect(*img, conf_threshold, iou_threshold, conf_threshold2, landmarks_rel);
+            nn::Objects *result = detector.detect(*img, conf_threshold, iou_threshold, conf_threshold2, landmarks_rel, track_interval);
             uint64_t t3 = time::ticks_ms();
             for (auto &r : *result)
             {
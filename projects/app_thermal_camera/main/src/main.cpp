@@ -115,6 +115,7 @@ int _main(int argc, char **argv)
         while (!app::need_exit()) {
             if (g_cmap != prev_cmap) {
                 prev_cmap = g_cmap;
+                g_mlx_c.reset();    // stop acquisition thread of old one first
                 g_mlx_c.reset(new MLXC(5, FPS::FPS_32, prev_cmap, temp_min, 50));
             }
 
@@ -125,7 +126,7 @@ int _main(int argc, char **argv)
             std::vector<uint8_t> mix_data;
             if (g_fusion_mode) {
                 if (!_fuf) {
-                    g_mlx_c.release();
+                    g_mlx_c.reset();
                     g_mlx_c.reset(new MLXC(5, FPS::FPS_32, prev_cmap, 5.0f, 45.0f));
                     _fuf = true;
                     continue;
@@ -166,7 +167,8 @@ int _main(int argc, char **argv)
                 img.reset(new Image(32, 24, FMT_RGB888, mix_data.data(), mix_data.size(), false));
                 // img.reset(Image(32, 24, FMT_RGB888, mix_data.data(), mix_data.size(), false).resize(640, 480, FIT_FILL, BILINEAR));
             } else {
-                img.reset(g_mlx_c->image_from(matrix));
+                /* interpolate temperature instead of scaling 32x24 pseudo color image */
+                img.reset(g_mlx_c->image_from(matrix, 32*10, 24*10));
                 _fuf = false;
             }
 
@@ -40,14 +40,11 @@ std::vector<uint8_t> mix(const uint8_t* gray, const uint8_t* rgb, const uint32_t
 {
     using namespace maix::ext_dev::cmap;
     using namespace maix::image;
-    const CmapArray* cmaparray = get(Cmap::JET);
-    float c = (static_cast<float>(cmaparray->size()) / 255);
+    const uint8_t* table = lut(Cmap::JET);
 
     std::vector<uint8_t> thermal(pixel_num*3);
     for (uint32_t i = 0; i < pixel_num; ++i) {
-            thermal[i*3+0] = std::get<0>((*cmaparray)[static_cast<size_t>(gray[i]*c)]);
-            thermal[i*3+1] = std::get<1>((*cmaparray)[static_cast<size_t>(gray[i]*c)]);
-            thermal[i*3+2] = std::get<2>((*cmaparray)[static_cast<size_t>(gray[i]*c)]);
+        ::memcpy(&thermal[i*3], table + gray[i]*3, 3);
     }
 
     cv::Mat thermal_image = cv::Mat(50, 50, CV_8UC3, thermal.data());
@@ -0,0 +1,130 @@
+#include "maix_basic.hpp"
+#include "maix_bytetrack.hpp"
+#include "main.h"
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace maix;
+
+typedef std::vector<std::vector<tracker::Object>> Frames;
+
+// MOT challenge det.txt: frame, id, x, y, w, h, score, ...
+static bool load_mot(const char *path, Frames &frames)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+    std::map<int, std::vector<tracker::Object>> dets;
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        int frame, id;
+        float x, y, w, h, score;
+        if (sscanf(line, "%d,%d,%f,%f,%f,%f,%f", &frame, &id, &x, &y, &w, &h, &score) != 7)
+            continue;
+        dets[frame].push_back(tracker::Object(x, y, w, h, 0, score));
+    }
+    fclose(f);
+    int last = dets.empty() ? 0 : dets.rbegin()->first;
+    frames.assign(last, std::vector<tracker::Object>());
+    for (auto &it : dets)
+        if (it.first >= 1)
+            frames[it.first - 1] = it.second;
+    return true;
+}
+
+// objects walk in 1920x1080 with detection jitter, misses and false positives
+static void gen_crowd(int num, int frame_num, Frames &frames)
+{
+    srand(1);
+    auto rnd = [](float a, float b) { return a + (b - a) * (rand() / (float)RAND_MAX); };
+    std::vector<std::vector<float>> objs(num);
+    for (auto &o : objs)
+        o = {rnd(0, 1850), rnd(0, 1000), rnd(20, 60), rnd(40, 120), rnd(-3, 3), rnd(-3, 3)};
+    frames.resize(frame_num);
+    for (auto &dets : frames)
+    {
+        for (auto &o : objs)
+        {
+            o[0] += o[4];
+            o[1] += o[5];
+            if (o[0] < 0 || o[0] > 1850)
+                o[4] = -o[4];
+            if (o[1] < 0 || o[1] > 1000)
+                o[5] = -o[5];
+            if (rnd(0, 1) < 0.05f)
+                continue;
+            dets.push_back(tracker::Object(o[0] + rnd(-1, 1), o[1] + rnd(-1, 1), o[2], o[3], 0, rnd(0.2, 1.0)));
+        }
+        for (int i = 0; i < num / 20; ++i)
+            dets.push_back(tracker::Object(rnd(0, 1800), rnd(0, 1000), rnd(20, 60), rnd(40, 120), 0, rnd(0.1, 0.7)));
+    }
+}
+
+int _main(int argc, char *argv[])
+{
+    if (argc > 1 && !strcmp(argv[1], "-h"))
+    {
+        log::info("./bench_bytetrack [det.txt | object_num] [loop]");
+        log::info("det.txt is MOT challenge detection file, default generate 250 objects 300 frames");
+        return 0;
+    }
+    Frames frames;
+    int loop = argc > 2 ? atoi(argv[2]) : 3;
+    if (argc > 1 && atoi(argv[1]) == 0)
+    {
+        if (!load_mot(argv[1], frames))
+        {
+            log::error("load %s failed", argv[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        gen_crowd(argc > 1 ? atoi(argv[1]) : 250, 300, frames);
+    }
+    size_t det_num = 0;
+    for (auto &dets : frames)
+        det_num += dets.size();
+    log::info("frames: %d, avg detections: %.1f, loop: %d", (int)frames.size(), frames.empty() ? 0.0 : (double)det_num / frames.size(), loop);
+
+    std::vector<uint64_t> used;
+    size_t track_num = 0;
+    for (int l = 0; l < loop && !app::need_exit(); ++l)
+    {
+        tracker::ByteTracker byte_tracker(30, 0.4, 0.6, 0.8, 20);
+        track_num = 0;
+        for (auto &dets : frames)
+        {
+            uint64_t t = time::ticks_us();
+            std::vector<tracker::Track> tracks = byte_tracker.update(dets);
+            used.push_back(time::ticks_us() - t);
+            track_num += tracks.size();
+        }
+    }
+    if (used.empty())
+        return 0;
+    uint64_t sum = 0;
+    for (auto t : used)
+        sum += t;
+    std::sort(used.begin(), used.end());
+    printf("update avg: %.3f ms, p50: %.3f ms, p99: %.3f ms, max: %.3f ms, avg tracks: %.1f\n",
+           sum / 1000.0 / used.size(), used[used.size() / 2] / 1000.0, used[used.size() * 99 / 100] / 1000.0,
+           used.back() / 1000.0, frames.empty() ? 0.0 : (double)track_num / frames.size());
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}
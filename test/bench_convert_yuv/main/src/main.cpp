@@ -0,0 +1,69 @@
+
+#include "maix_basic.hpp"
+#include "maix_image_yuv.hpp"
+#include "main.h"
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace maix;
+
+static const char *layout_names[] = {"YUYV", "UYVY", "NV12", "NV21", "NV16", "I420", "YV12", "I422"};
+
+static double bench(image::YUVLayout layout, const uint8_t *src, int w, int h, image::Format fmt, uint8_t *dst, int loop, bool simd)
+{
+    // warm up
+    image::convert_yuv(layout, src, w, h, fmt, dst, image::YUV_BT709, image::YUV_RANGE_LIMITED, simd);
+    uint64_t t = time::ticks_us();
+    for (int i = 0; i < loop; ++i)
+        image::convert_yuv(layout, src, w, h, fmt, dst, image::YUV_BT709, image::YUV_RANGE_LIMITED, simd);
+    uint64_t used = time::ticks_us() - t;
+    return (double)w * h * loop / (used ? used : 1);
+}
+
+int _main(int argc, char *argv[])
+{
+    int w = argc > 1 ? atoi(argv[1]) : 1920;
+    int h = argc > 2 ? atoi(argv[2]) : 1080;
+    int loop = argc > 3 ? atoi(argv[3]) : 20;
+    image::Format fmts[] = {image::FMT_RGB888, image::FMT_BGR888, image::FMT_RGBA8888, image::FMT_BGRA8888, image::FMT_GRAYSCALE};
+
+    std::vector<uint8_t> src((size_t)w * h * 2);
+    std::vector<uint8_t> dst((size_t)w * h * 4);
+    std::vector<uint8_t> dst_ref((size_t)w * h * 4);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = rand() & 0xff;
+
+    log::info("convert_yuv %dx%d, loop %d, simd: %s", w, h, loop, image::convert_yuv_simd());
+    printf("%-6s %-10s %14s %14s %8s\n", "src", "dst", "simd MPix/s", "scalar MPix/s", "speedup");
+    int err_count = 0;
+    for (int l = image::YUV_YUYV; l <= image::YUV_I422 && !app::need_exit(); ++l)
+    {
+        image::YUVLayout layout = (image::YUVLayout)l;
+        for (image::Format fmt : fmts)
+        {
+            double simd = bench(layout, src.data(), w, h, fmt, dst.data(), loop, true);
+            double scalar = bench(layout, src.data(), w, h, fmt, dst_ref.data(), loop, false);
+            size_t size = (size_t)w * h * (size_t)image::fmt_size[fmt];
+            bool same = memcmp(dst.data(), dst_ref.data(), size) == 0;
+            if (!same)
+                ++err_count;
+            printf("%-6s %-10s %14.1f %14.1f %7.2fx%s\n", layout_names[l], image::fmt_names[fmt].c_str(), simd, scalar, simd / scalar,
+                   same ? "" : "  MISMATCH");
+        }
+    }
+    if (err_count)
+        log::error("%d kernels result not same as scalar", err_count);
+    return err_count ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}
@@ -0,0 +1,212 @@
+
+#include "maix_basic.hpp"
+#include "maix_nn_F.hpp"
+#include "main.h"
+#include <vector>
+#include <functional>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+using namespace maix;
+
+// reference kernels, same as model wrappers did before
+static void ref_softmax(float *data, int n)
+{
+    float max = data[0];
+    for (int i = 1; i < n; ++i)
+        max = data[i] > max ? data[i] : max;
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        data[i] = expf(data[i] - max);
+        sum += data[i];
+    }
+    for (int i = 0; i < n; ++i)
+        data[i] /= sum;
+}
+
+static void ref_log_softmax(float *data, int n)
+{
+    float max = data[0];
+    for (int i = 1; i < n; ++i)
+        max = data[i] > max ? data[i] : max;
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += expf(data[i] - max);
+    float lse = max + logf(sum);
+    for (int i = 0; i < n; ++i)
+        data[i] -= lse;
+}
+
+static void ref_topk(const float *data, int n, int k, std::vector<std::pair<int, float>> &result)
+{
+    result.resize(n);
+    for (int i = 0; i < n; ++i)
+        result[i] = std::make_pair(i, data[i]);
+    std::sort(result.begin(), result.end(), [](const std::pair<int, float> &a, const std::pair<int, float> &b)
+              { return a.second > b.second; });
+    result.resize(k);
+}
+
+static double bench(std::function<void()> fn, int loop)
+{
+    fn(); // warm up
+    uint64_t t = time::ticks_us();
+    for (int i = 0; i < loop; ++i)
+        fn();
+    uint64_t used = time::ticks_us() - t;
+    return (double)(used ? used : 1) / loop;
+}
+
+static double max_diff(const float *a, const float *b, int n, bool relative = false)
+{
+    double diff = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        double d = fabs((double)a[i] - b[i]);
+        if (relative)
+            d /= fabs((double)b[i]) + 1e-30;
+        diff = d > diff ? d : diff;
+    }
+    return diff;
+}
+
+static void report(const char *name, double fast_us, double ref_us, double err)
+{
+    printf("%-14s %12.2f %12.2f %8.2fx %12.3g\n", name, fast_us, ref_us, ref_us / fast_us, err);
+}
+
+int _main(int argc, char *argv[])
+{
+    if (argc > 1 && !strcmp(argv[1], "-h"))
+    {
+        log::info("./bench_nn_F [n] [loop] [k]");
+        log::info("n is element count, default 8400(YOLOv8 640x640 anchors), k of topk default 5");
+        return 0;
+    }
+    int n = argc > 1 ? atoi(argv[1]) : 8400;
+    int loop = argc > 2 ? atoi(argv[2]) : 200;
+    int k = argc > 3 ? atoi(argv[3]) : 5;
+    if (n <= 0 || loop <= 0 || k <= 0)
+    {
+        log::error("args error");
+        return 1;
+    }
+
+    srand(1);
+    std::vector<float> src(n), a(n), b(n);
+    for (auto &v : src)
+        v = (rand() / (float)RAND_MAX - 0.5f) * 40;
+
+    log::info("nn::F kernels, n: %d, loop: %d, simd: %s", n, loop, nn::F::simd());
+    printf("%-14s %12s %12s %9s %12s\n", "kernel", "nn::F us", "ref us", "speedup", "max error");
+    int err_count = 0;
+    auto check = [&err_count](double err, double th) {
+        if (!(err <= th))
+            ++err_count;
+        return err;
+    };
+
+    // exp
+    double t1 = bench([&] { nn::F::fast_exp(src.data(), a.data(), n); }, loop);
+    double t2 = bench([&] { for (int i = 0; i < n; ++i) b[i] = expf(src[i]); }, loop);
+    report("exp", t1, t2, check(max_diff(a.data(), b.data(), n, true), 1e-6));
+
+    // sigmoid
+    t1 = bench([&] { nn::F::sigmoid(src.data(), a.data(), n); }, loop);
+    t2 = bench([&] { for (int i = 0; i < n; ++i) b[i] = 1.0 / (1 + expf(-src[i])); }, loop);
+    report("sigmoid", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-6));
+
+    // softmax
+    t1 = bench([&] { memcpy(a.data(), src.data(), n * sizeof(float)); nn::F::softmax(a.data(), n); }, loop);
+    t2 = bench([&] { memcpy(b.data(), src.data(), n * sizeof(float)); ref_softmax(b.data(), n); }, loop);
+    report("softmax", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-6));
+
+    // log_softmax
+    t1 = bench([&] { memcpy(a.data(), src.data(), n * sizeof(float)); nn::F::log_softmax(a.data(), n); }, loop);
+    t2 = bench([&] { memcpy(b.data(), src.data(), n * sizeof(float)); ref_log_softmax(b.data(), n); }, loop);
+    report("log_softmax", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-4));
+
+    // argmax
+    int idx1 = 0, idx2 = 0;
+    t1 = bench([&] { idx1 = nn::F::argmax(src.data(), n); }, loop);
+    t2 = bench([&] { idx2 = nn::F::argmax<float>(src.data(), n); }, loop);
+    report("argmax", t1, t2, check(idx1 != idx2, 0));
+
+    // topk
+    std::vector<std::pair<int, float>> r1, r2;
+    t1 = bench([&] { nn::F::topk(src.data(), n, k, r1); }, loop);
+    t2 = bench([&] { ref_topk(src.data(), n, k, r2); }, loop);
+    int topk_diff = 0;
+    for (int i = 0; i < k && i < n; ++i)
+        topk_diff += r1[i].second != r2[i].second;
+    report("topk", t1, t2, check(topk_diff, 0));
+
+    // dequantize
+    std::vector<int8_t> q8(n);
+    std::vector<uint8_t> u8(n);
+    std::vector<uint16_t> bf(n);
+    for (int i = 0; i < n; ++i)
+    {
+        q8[i] = (int8_t)(rand() & 0xff);
+        u8[i] = (uint8_t)(rand() & 0xff);
+        uint32_t v;
+        memcpy(&v, &src[i], sizeof(v));
+        bf[i] = v >> 16;
+    }
+    t1 = bench([&] { nn::F::dequantize(q8.data(), a.data(), n, 0.05f, 3); }, loop);
+    t2 = bench([&] { for (int i = 0; i < n; ++i) b[i] = (q8[i] - 3) * 0.05f; }, loop);
+    report("dequant int8", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-5));
+    t1 = bench([&] { nn::F::dequantize(u8.data(), a.data(), n, 0.05f, 128); }, loop);
+    t2 = bench([&] { for (int i = 0; i < n; ++i) b[i] = (u8[i] - 128) * 0.05f; }, loop);
+    report("dequant uint8", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-5));
+    t1 = bench([&] { nn::F::bf16_to_float(bf.data(), a.data(), n); }, loop);
+    t2 = bench([&] { for (int i = 0; i < n; ++i) { uint32_t v = (uint32_t)bf[i] << 16; memcpy(&b[i], &v, 4); } }, loop);
+    report("bf16", t1, t2, check(max_diff(a.data(), b.data(), n), 0));
+
+    // l2 normalize
+    t1 = bench([&] { memcpy(a.data(), src.data(), n * sizeof(float)); nn::F::l2_normalize(a.data(), n); }, loop);
+    t2 = bench([&] {
+        memcpy(b.data(), src.data(), n * sizeof(float));
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += b[i] * b[i];
+        float norm = sqrt(sum);
+        for (int i = 0; i < n; ++i)
+            b[i] /= norm;
+    }, loop);
+    report("l2_normalize", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-6));
+
+    // iou of one box with n boxes
+    std::vector<float> x(n), y(n), w(n), h(n);
+    std::vector<nn::Object> objs(n);
+    for (int i = 0; i < n; ++i)
+    {
+        objs[i] = nn::Object(rand() % 600, rand() % 600, rand() % 100 + 1, rand() % 100 + 1);
+        x[i] = objs[i].x;
+        y[i] = objs[i].y;
+        w[i] = objs[i].w;
+        h[i] = objs[i].h;
+    }
+    float box[4] = {300, 300, 80, 60};
+    nn::Object obj(300, 300, 80, 60);
+    t1 = bench([&] { nn::F::iou(box, x.data(), y.data(), w.data(), h.data(), n, a.data()); }, loop);
+    t2 = bench([&] { for (int i = 0; i < n; ++i) b[i] = nn::F::iou(obj, objs[i]); }, loop);
+    report("iou", t1, t2, check(max_diff(a.data(), b.data(), n), 1e-6));
+
+    if (err_count)
+        log::error("%d kernels result not same as reference", err_count);
+    return err_count ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}
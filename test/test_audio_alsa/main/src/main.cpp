@@ -0,0 +1,164 @@
+
+#include "maix_basic.hpp"
+#include "maix_audio.hpp"
+#include "main.h"
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace maix;
+
+static int failed = 0;
+static bool null_pcm = true;    // null PCM records silence
+static std::string wav_path = "/tmp/test_audio_alsa.wav";
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            log::error("%s:%d check failed: %s", __FILE__, __LINE__, #cond); \
+            ++failed; \
+        } \
+    } while (0)
+
+static bool silence(const Bytes *data, audio::Format fmt)
+{
+    uint8_t value = fmt == audio::FMT_U8 ? 0x80 : 0;
+    for (size_t i = 0; i < data->data_len; ++i)
+    {
+        if (data->data[i] != value)
+            return false;
+    }
+    return true;
+}
+
+static void record_play(audio::Format fmt, int rate, int channel, bool block)
+{
+    {
+        audio::Recorder r("", rate, fmt, channel, block);
+        CHECK(r.sample_rate() == rate);
+        CHECK(r.channel() == channel);
+        CHECK(r.format() == fmt);
+        if (!block)
+            r.reset(true);
+        int frame = r.frame_size(1);
+        Bytes *data = r.record(100);
+        CHECK(data->data_len % frame == 0);
+        if (block)
+            CHECK(data->data_len == (size_t)(rate / 10 * frame));
+        if (null_pcm)
+            CHECK(silence(data, fmt));
+        delete data;
+        CHECK(r.period_size(512) == 512);
+        delete r.record(20);
+        CHECK(r.period_count(2) == 2);
+        CHECK(r.finish() == err::ERR_NONE);
+    }
+    {
+        audio::Player p("", rate, fmt, channel, block);
+        Bytes data(nullptr, rate / 10 * p.frame_size(1));
+        memset(data.data, fmt == audio::FMT_U8 ? 0x80 : 0, data.data_len);
+        CHECK(p.play(&data) == err::ERR_NONE);
+        CHECK(p.period_size(256) == 256);
+        CHECK(p.play(&data) == err::ERR_NONE);
+    }
+}
+
+static void test_s16_48k_mono()
+{
+    record_play(audio::FMT_S16_LE, 48000, 1, true);
+}
+
+static void test_s16_16k_stereo()
+{
+    record_play(audio::FMT_S16_LE, 16000, 2, true);
+}
+
+static void test_s32_44k_nonblock()
+{
+    record_play(audio::FMT_S32_LE, 44100, 1, false);
+}
+
+static void test_u8_8k()
+{
+    record_play(audio::FMT_U8, 8000, 1, true);
+}
+
+static void test_wav()
+{
+    {
+        audio::Recorder r(wav_path, 16000, audio::FMT_S16_LE, 1, true);
+        delete r.record(200);
+    }
+    CHECK(fs::getsize(wav_path) == 44 + 16000 / 5 * 2);
+    audio::Player p(wav_path, 0, audio::FMT_NONE, 0, true);
+    CHECK(p.sample_rate() == 16000);
+    CHECK(p.channel() == 1);
+    CHECK(p.play() == err::ERR_NONE);
+    fs::remove(wav_path);
+}
+
+static void test_bad_device()
+{
+    std::string dev = getenv("MAIX_AUDIO_PLAY_DEVICE");
+    setenv("MAIX_AUDIO_PLAY_DEVICE", "hw:99", 1);
+    bool raised = false;
+    try
+    {
+        audio::Player p("", 16000, audio::FMT_S16_LE, 1, true);
+    }
+    catch (err::Exception &e)
+    {
+        raised = true;
+    }
+    CHECK(raised);
+    setenv("MAIX_AUDIO_PLAY_DEVICE", dev.c_str(), 1);
+}
+
+int _main(int argc, char *argv[])
+{
+    // ALSA PCM to test, null needs no sound card
+    std::string device = argc > 1 ? argv[1] : "null";
+    null_pcm = device == "null";
+    setenv("MAIX_AUDIO_RECORD_DEVICE", device.c_str(), 1);
+    setenv("MAIX_AUDIO_PLAY_DEVICE", device.c_str(), 1);
+    log::info("ALSA PCM: %s", device.c_str());
+
+    struct {
+        const char *name;
+        void (*func)();
+    } cases[] = {
+        {"S16 48k mono", test_s16_48k_mono},
+        {"S16 16k stereo", test_s16_16k_stereo},
+        {"S32 44.1k non-block", test_s32_44k_nonblock},
+        {"U8 8k", test_u8_8k},
+        {"wav file", test_wav},
+        {"bad device", test_bad_device},
+    };
+    for (auto &c : cases)
+    {
+        int before = failed;
+        try
+        {
+            c.func();
+        }
+        catch (err::Exception &e)
+        {
+            log::error("%s", e.what());
+            ++failed;
+        }
+        log::info("%-22s %s", c.name, failed == before ? "ok" : "FAILED");
+    }
+    if (failed)
+        log::error("%d checks failed", failed);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}
@@ -0,0 +1,365 @@
+
+#include "maix_basic.hpp"
+#include "maix_comm_socket.hpp"
+#include "main.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace maix;
+using namespace maix::comm;
+
+static int port_base = 56780;
+static const char *unix_path = "/tmp/test_comm_socket.sock";
+
+static int failed = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            log::error("%s:%d check failed: %s", __FILE__, __LINE__, #cond); \
+            ++failed; \
+        } \
+    } while (0)
+
+static void pattern(std::vector<uint8_t> &data, int seed)
+{
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 7 + seed + i / 251);
+}
+
+static std::string local_addr(int fd)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (struct sockaddr *)&addr, &len);
+    char ip[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+static struct sockaddr_in loopback(int port)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static int tcp_connect(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = loopback(port);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int unix_connect(const char *path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool client_write(int fd, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0)
+    {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// read len bytes, return data read if no data in timeout_ms
+static std::string client_read(int fd, size_t len, int timeout_ms)
+{
+    std::string data;
+    while (data.size() < len)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            break;
+        char buff[4096];
+        ssize_t n = ::recv(fd, buff, std::min(sizeof(buff), len - data.size()), 0);
+        if (n <= 0)
+            break;
+        data.append(buff, n);
+    }
+    return data;
+}
+
+static bool wait_peers(SocketComm &server, size_t num, int timeout_ms)
+{
+    uint64_t t = time::ticks_ms();
+    while (server.peers().size() != num && time::ticks_ms() - t < (uint64_t)timeout_ms)
+        time::sleep_ms(1);
+    return server.peers().size() == num;
+}
+
+// read data of all peers until total bytes received
+static std::map<int, std::string> server_read(SocketComm &server, size_t total, int timeout_ms)
+{
+    std::map<int, std::string> recv;
+    size_t got = 0;
+    uint64_t t = time::ticks_ms();
+    while (got < total && time::ticks_ms() - t < (uint64_t)timeout_ms)
+    {
+        int peer = server.wait_peer(100);
+        if (peer < 0)
+            continue;
+        uint8_t buff[4096];
+        int n = server.read_peer(peer, buff, sizeof(buff), 0);
+        if (n > 0)
+        {
+            recv[peer].append((char *)buff, n);
+            got += n;
+        }
+    }
+    return recv;
+}
+
+static void test_tcp_multi_peer()
+{
+    const int num = 3;
+    SocketComm server(SOCKET_TCP_SERVER, "127.0.0.1:" + std::to_string(port_base), 256 * 1024, 1000);
+    CHECK(server.open() == err::ERR_NONE);
+    int clients[num];
+    for (int i = 0; i < num; ++i)
+    {
+        clients[i] = tcp_connect(port_base);
+        CHECK(clients[i] >= 0);
+    }
+    CHECK(wait_peers(server, num, 2000));
+
+    // peer id of every client
+    int ids[num];
+    std::vector<int> peers = server.peers();
+    for (int i = 0; i < num; ++i)
+    {
+        ids[i] = -1;
+        for (int id : peers)
+        {
+            if (server.peer_addr(id) == local_addr(clients[i]))
+                ids[i] = id;
+        }
+        CHECK(ids[i] >= 0);
+    }
+
+    // data of every client is received by its own peer
+    std::vector<uint8_t> data[num];
+    for (int i = 0; i < num; ++i)
+    {
+        data[i].resize(20000 + i * 1000);
+        pattern(data[i], i);
+    }
+    std::vector<std::thread> senders;
+    size_t total = 0;
+    for (int i = 0; i < num; ++i)
+    {
+        total += data[i].size();
+        senders.emplace_back([&, i] { client_write(clients[i], data[i].data(), data[i].size()); });
+    }
+    std::map<int, std::string> recv = server_read(server, total, 3000);
+    for (auto &t : senders)
+        t.join();
+    for (int i = 0; i < num; ++i)
+        CHECK(recv[ids[i]] == std::string(data[i].begin(), data[i].end()));
+
+    // write sends to all peers
+    CHECK(server.write((const uint8_t *)"hello all", 9) == 9);
+    for (int i = 0; i < num; ++i)
+        CHECK(client_read(clients[i], 9, 1000) == "hello all");
+
+    // write_peer sends to one peer only
+    CHECK(server.write_peer(ids[1], (const uint8_t *)"only 1", 6) == 6);
+    CHECK(client_read(clients[1], 6, 1000) == "only 1");
+    CHECK(client_read(clients[0], 1, 100).empty());
+    CHECK(client_read(clients[2], 1, 100).empty());
+
+    // disconnected peer is removed, others still work
+    ::close(clients[2]);
+    CHECK(wait_peers(server, num - 1, 2000));
+    CHECK(!server.peer_alive(ids[2]));
+    CHECK(server.write_peer(ids[2], (const uint8_t *)"x", 1) == -err::ERR_NOT_FOUND);
+    CHECK(server.write((const uint8_t *)"bye", 3) == 3);
+    CHECK(client_read(clients[0], 3, 1000) == "bye");
+    CHECK(client_read(clients[1], 3, 1000) == "bye");
+    ::close(clients[0]);
+    ::close(clients[1]);
+    server.close();
+}
+
+static void test_unix_multi_peer()
+{
+    SocketComm server(SOCKET_UNIX, unix_path, 256 * 1024, 1000);
+    CHECK(server.open() == err::ERR_NONE);
+    int clients[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        clients[i] = unix_connect(unix_path);
+        CHECK(clients[i] >= 0);
+    }
+    CHECK(wait_peers(server, 2, 2000));
+    std::string lines[2] = {"unix client 0\n", "unix client 1 longer\n"};
+    for (int i = 0; i < 2; ++i)
+        CHECK(client_write(clients[i], lines[i].data(), lines[i].size()));
+    std::map<int, std::string> recv = server_read(server, lines[0].size() + lines[1].size(), 2000);
+    CHECK(recv.size() == 2);
+    // echo back to the peer, every client gets its own line
+    for (auto &it : recv)
+        CHECK(server.write_peer(it.first, (const uint8_t *)it.second.data(), it.second.size()) == (int)it.second.size());
+    for (int i = 0; i < 2; ++i)
+    {
+        CHECK(client_read(clients[i], lines[i].size(), 1000) == lines[i]);
+        ::close(clients[i]);
+    }
+    server.close();
+    CHECK(access(unix_path, F_OK) != 0);
+}
+
+static void test_udp_multi_peer()
+{
+    int port = port_base + 1;
+    SocketComm server(SOCKET_UDP, "127.0.0.1:" + std::to_string(port), 256 * 1024, 1000);
+    CHECK(server.open() == err::ERR_NONE);
+    struct sockaddr_in addr = loopback(port);
+    int clients[2];
+    std::string msgs[2] = {"udp 0", "udp 1 datagram"};
+    for (int i = 0; i < 2; ++i)
+    {
+        clients[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        // bind to loopback so local address is the one server sees
+        struct sockaddr_in local = loopback(0);
+        CHECK(bind(clients[i], (struct sockaddr *)&local, sizeof(local)) == 0);
+        CHECK(sendto(clients[i], msgs[i].data(), msgs[i].size(), 0, (struct sockaddr *)&addr, sizeof(addr)) == (ssize_t)msgs[i].size());
+    }
+    std::map<int, std::string> recv = server_read(server, msgs[0].size() + msgs[1].size(), 2000);
+    CHECK(recv.size() == 2);
+    for (auto &it : recv)
+    {
+        int i = it.second == msgs[0] ? 0 : 1;
+        CHECK(it.second == msgs[i]);
+        CHECK(server.peer_addr(it.first) == local_addr(clients[i]));
+        CHECK(server.write_peer(it.first, (const uint8_t *)"ack", 3) == 3);
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        CHECK(client_read(clients[i], 3, 1000) == "ack");
+        ::close(clients[i]);
+    }
+    server.close();
+}
+
+static void test_close_while_busy()
+{
+    // close() in one thread while others write and read must not touch freed socket
+    int port = port_base + 2;
+    for (int round = 0; round < 20; ++round)
+    {
+        SocketComm server(SOCKET_TCP_SERVER, "127.0.0.1:" + std::to_string(port), 16 * 1024, 10);
+        CHECK(server.open() == err::ERR_NONE);
+        int client = tcp_connect(port);
+        CHECK(client >= 0);
+        CHECK(wait_peers(server, 1, 2000));
+        int id = server.peers().empty() ? -1 : server.peers()[0];
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        threads.emplace_back([&] {
+            uint8_t buff[512] = {0};
+            while (!stop)
+                server.write(buff, sizeof(buff));
+        });
+        threads.emplace_back([&] {
+            uint8_t buff[512] = {0};
+            while (!stop)
+                server.write_peer(id, buff, sizeof(buff));
+        });
+        threads.emplace_back([&] {
+            uint8_t buff[512];
+            while (!stop)
+                server.read(buff, sizeof(buff), -1, 5);
+        });
+        threads.emplace_back([&] {
+            while (!stop)
+            {
+                client_write(client, "ping", 4);
+                client_read(client, 4096, 1);
+            }
+        });
+        time::sleep_ms(20 + round);
+        CHECK(server.close() == err::ERR_NONE);
+        CHECK(!server.is_open());
+        uint8_t byte = 0;
+        CHECK(server.write(&byte, 1) == -err::ERR_NOT_OPEN);
+        CHECK(server.write_peer(id, &byte, 1) == -err::ERR_NOT_OPEN);
+        stop = true;
+        for (auto &t : threads)
+            t.join();
+        ::close(client);
+    }
+}
+
+int _main(int argc, char *argv[])
+{
+    if (argc > 1)
+        port_base = atoi(argv[1]);
+    log::info("TCP and UDP port: %d ~ %d, Unix socket: %s", port_base, port_base + 2, unix_path);
+
+    struct {
+        const char *name;
+        void (*func)();
+    } cases[] = {
+        {"tcp multi peer", test_tcp_multi_peer},
+        {"unix multi peer", test_unix_multi_peer},
+        {"udp multi peer", test_udp_multi_peer},
+        {"close while busy", test_close_while_busy},
+    };
+    for (auto &c : cases)
+    {
+        int before = failed;
+        c.func();
+        log::info("%-22s %s", c.name, failed == before ? "ok" : "FAILED");
+    }
+    if (failed)
+        log::error("%d checks failed", failed);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}
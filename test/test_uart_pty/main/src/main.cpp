@@ -0,0 +1,251 @@
+
+#include "maix_basic.hpp"
+#include "maix_uart.hpp"
+#include "main.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+
+using namespace maix;
+using namespace maix::peripheral;
+
+// master side of pseudo terminal pair acts as the device connected to uart
+static int open_pty(std::string &slave)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0)
+        return -1;
+    struct termios opt;
+    tcgetattr(fd, &opt);
+    cfmakeraw(&opt);
+    tcsetattr(fd, TCSANOW, &opt);
+    slave = ptsname(fd);
+    return fd;
+}
+
+static void pattern(std::vector<uint8_t> &data, int seed)
+{
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 7 + seed + i / 251);
+}
+
+static bool peer_write(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0)
+            return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// read len bytes from peer, return bytes read if no data in timeout_ms
+static size_t peer_read(int fd, uint8_t *data, size_t len, int timeout_ms)
+{
+    size_t got = 0;
+    while (got < len)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            break;
+        ssize_t n = ::read(fd, data + got, len - got);
+        if (n <= 0)
+            break;
+        got += n;
+    }
+    return got;
+}
+
+static int failed = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            log::error("%s:%d check failed: %s", __FILE__, __LINE__, #cond); \
+            ++failed; \
+        } \
+    } while (0)
+
+static void test_rx_burst(uart::UART &serial, int peer)
+{
+    std::vector<uint8_t> data(4000), buff(4000);
+    pattern(data, 1);
+    CHECK(peer_write(peer, data.data(), data.size()));
+    int n = serial.read(buff.data(), buff.size(), buff.size(), 2000);
+    CHECK(n == (int)data.size());
+    CHECK(buff == data);
+    CHECK(serial.available() == 0);
+}
+
+static void test_readline(uart::UART &serial, int peer)
+{
+    const char *lines = "hello\nworld\r\n";
+    CHECK(peer_write(peer, (const uint8_t *)lines, strlen(lines)));
+    Bytes *line = serial.readline(1000);
+    CHECK(std::string((char *)line->data, line->size()) == "hello\n");
+    delete line;
+    line = serial.readline(1000);
+    CHECK(std::string((char *)line->data, line->size()) == "world\r\n");
+    delete line;
+
+    // line longer than 128 bytes
+    std::string long_line(1000, 'a');
+    long_line += "\n";
+    CHECK(peer_write(peer, (const uint8_t *)long_line.data(), long_line.size()));
+    line = serial.readline(1000);
+    CHECK(std::string((char *)line->data, line->size()) == long_line);
+    delete line;
+}
+
+static void test_tx_large(uart::UART &serial, int peer)
+{
+    // more than send queue, peer reads slowly to make backpressure
+    std::vector<uint8_t> data(300 * 1024), recv(data.size());
+    pattern(data, 2);
+    size_t got = 0;
+    std::thread reader([&] {
+        while (got < recv.size())
+        {
+            size_t n = peer_read(peer, recv.data() + got, std::min((size_t)4096, recv.size() - got), 2000);
+            if (n == 0)
+                break;
+            got += n;
+            if (got < 64 * 1024)
+                time::sleep_ms(1);
+        }
+    });
+    int n = serial.write(data.data(), data.size());
+    reader.join();
+    CHECK(n == (int)data.size());
+    CHECK(got == recv.size());
+    CHECK(recv == data);
+}
+
+static void test_frame_callback(uart::UART &serial, int peer)
+{
+    std::atomic<int> frames{0};
+    std::atomic<int> bad{0};
+    err::Err e = serial.set_frame_callback([&](uart::UART &, const uint8_t *data, int len) {
+        std::string expect = "line " + std::to_string(frames.load()) + "\n";
+        if (std::string((const char *)data, len) != expect)
+            ++bad;
+        ++frames;
+    }, "\n", 64);
+    CHECK(e == err::ERR_NONE);
+    std::string lines;
+    for (int i = 0; i < 100; ++i)
+        lines += "line " + std::to_string(i) + "\n";
+    CHECK(peer_write(peer, (const uint8_t *)lines.data(), lines.size()));
+    uint64_t t = time::ticks_ms();
+    while (frames.load() < 100 && time::ticks_ms() - t < 2000)
+        time::sleep_ms(1);
+    CHECK(frames.load() == 100);
+    CHECK(bad.load() == 0);
+
+    // fixed length frames
+    frames = 0;
+    e = serial.set_frame_callback([&](uart::UART &, const uint8_t *data, int len) {
+        if (len != 10 || data[0] != (uint8_t)frames.load())
+            ++bad;
+        ++frames;
+    }, 10);
+    CHECK(e == err::ERR_NONE);
+    std::vector<uint8_t> data(10 * 50);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i / 10);
+    CHECK(peer_write(peer, data.data(), data.size()));
+    t = time::ticks_ms();
+    while (frames.load() < 50 && time::ticks_ms() - t < 2000)
+        time::sleep_ms(1);
+    CHECK(frames.load() == 50);
+    CHECK(bad.load() == 0);
+    serial.set_frame_callback(nullptr, 10);
+}
+
+static void test_callback_write_large(uart::UART &serial, int peer)
+{
+    // callback runs in I/O thread, data more than send queue must not wait I/O thread itself
+    std::vector<uint8_t> data(200 * 1024), recv(data.size());
+    pattern(data, 3);
+    std::atomic<int> ret{0};
+    serial.set_received_callback([&](uart::UART &s, Bytes &) {
+        ret = s.write(data.data(), data.size());
+    });
+    size_t got = 0;
+    std::thread reader([&] {
+        got = peer_read(peer, recv.data(), recv.size(), 3000);
+    });
+    uint64_t t = time::ticks_ms();
+    CHECK(peer_write(peer, (const uint8_t *)"go", 2));
+    reader.join();
+    uint64_t used = time::ticks_ms() - t;
+    serial.set_received_callback(nullptr);
+    CHECK(ret.load() == (int)data.size());
+    CHECK(got == recv.size());
+    CHECK(recv == data);
+    CHECK(used < 900);
+    log::info("callback wrote %d bytes in %d ms", (int)got, (int)used);
+}
+
+static void test_hang_up(uart::UART &serial, int peer)
+{
+    ::close(peer);
+    uint8_t buff[16];
+    int n = serial.read(buff, sizeof(buff), sizeof(buff), 1000);
+    CHECK(n == -err::ERR_IO);
+}
+
+int _main(int argc, char *argv[])
+{
+    std::string slave;
+    int peer = open_pty(slave);
+    if (peer < 0)
+    {
+        log::error("open pseudo terminal failed");
+        return 1;
+    }
+    log::info("uart: %s", slave.c_str());
+    uart::UART serial(slave, 115200);
+
+    struct {
+        const char *name;
+        void (*func)(uart::UART &, int);
+    } cases[] = {
+        {"rx burst", test_rx_burst},
+        {"readline", test_readline},
+        {"tx large", test_tx_large},
+        {"frame callback", test_frame_callback},
+        {"callback write large", test_callback_write_large},
+        {"hang up", test_hang_up},
+    };
+    for (auto &c : cases)
+    {
+        int before = failed;
+        c.func(serial, peer);
+        log::info("%-22s %s", c.name, failed == before ? "ok" : "FAILED");
+    }
+    serial.close();
+    if (failed)
+        log::error("%d checks failed", failed);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Catch signal and process
+    sys::register_default_signal_handle();
+
+    // Use CATCH_EXCEPTION_RUN_RETURN to catch exception,
+    // if we don't catch exception, when program throw exception, the objects will not be destructed.
+    // So we catch exception here to let resources be released(call objects' destructor) before exit.
+    CATCH_EXCEPTION_RUN_RETURN(_main, -1, argc, argv);
+}